@@ -6,7 +6,8 @@
 
 #include <DX3D/Particles/ParticleSystem.h>
 #include <DX3D/Particles/ParticleEmitter.h>
-#include <DX3D/Particles/Particle.h>
+#include <DX3D/Particles/ParticlePool.h>
+#include <DX3D/Particles/ParticleEffect.h>
 #include <DX3D/Particles/ParticleEffects/SnowParticle.h>
 
 #include <DX3D/Graphics/Primitives/AGameObject.h>
@@ -1,21 +1,29 @@
 #pragma once
 #include <DX3D/Graphics/Primitives/Model.h>
 #include <DX3D/Graphics/GraphicsResource.h>
+#include <DX3D/Assets/ModelAsset.h>
+#include <DX3D/Assets/AssetStreamer.h>
+#include <DX3D/Assets/AssetUploader.h>
+#include <atomic>
 #include <memory>
-#include <future>
 #include <string>
 #include <unordered_map>
 #include <mutex>
 
 namespace dx3d
 {
+    // Loads model files once and hands out instances that share their meshes and materials.
+    // Loads go through an AssetStreamer: files are read and decoded on its workers and their GPU
+    // resources are created by update() within a per-frame budget. Requests for a file that is
+    // already loading, from any thread, join that load instead of starting another one.
     class AssetManager
     {
     public:
         struct LoadingTask
         {
-            std::future<std::shared_ptr<Model>> future;
+            std::shared_ptr<Model> model;
             float progress = 0.0f;
+            float priority = 0.0f;
             bool isComplete = false;
             bool hasError = false;
             std::string errorMessage;
@@ -28,21 +36,36 @@ namespace dx3d
             return instance;
         }
 
-        // Synchronous loading
+        // Replaces the uploader, and the streamer around it, that the first load would otherwise
+        // create on the device it is given. For running without a device; call before any load.
+        void setAssetUploader(std::unique_ptr<AssetUploader> uploader, const AssetStreamerDesc& desc = {});
+
+        // Synchronous loading. Returns a new instance on every call, or the default cube if the
+        // file cannot be loaded.
         std::shared_ptr<Model> loadModelSync(
             const std::string& filePath,
             const GraphicsResourceDesc& resourceDesc
         );
 
-        // Asynchronous loading
+        // Asynchronous loading, completed by update(). Lower priorities load first, such as the
+        // distance from the camera.
         std::string loadModelAsync(
             const std::string& filePath,
-            const GraphicsResourceDesc& resourceDesc
+            const GraphicsResourceDesc& resourceDesc,
+            float priority = 0.0f
         );
 
+        // Without a device, once setAssetUploader() has been called; throws otherwise
+        std::string loadModelAsync(const std::string& filePath, float priority);
+
+        // A file loading for several tasks goes at the lowest priority among them, and is only
+        // cancelled once all of them are
+        void setLoadingPriority(const std::string& taskId, float priority);
+        void cancelLoading(const std::string& taskId);
+
         // Check loading progress
         bool isLoadingComplete(const std::string& taskId);
-        float getLoadingProgress(const std::string& taskId);
+        float getLoadingProgress(const std::string& taskId); // 0 to 100
         std::shared_ptr<Model> getLoadedModel(const std::string& taskId);
         bool hasLoadingError(const std::string& taskId);
         std::string getLoadingError(const std::string& taskId);
@@ -51,14 +74,26 @@ namespace dx3d
         void cleanupTask(const std::string& taskId);
         void cleanupCompletedTasks();
 
+        // Shared data of a file; nullptr if it cannot be loaded. Blocks until it is decoded and
+        // uploads it on the calling thread unless it is cached.
+        std::shared_ptr<const ModelAsset> loadModelAsset(
+            const std::string& filePath,
+            const GraphicsResourceDesc& resourceDesc
+        );
+        std::shared_ptr<const ModelAsset> loadModelAsset(const std::string& filePath);
+
         // Model caching
-        void cacheModel(const std::string& filePath, std::shared_ptr<Model> model);
-        std::shared_ptr<Model> getCachedModel(const std::string& filePath);
+        std::shared_ptr<const ModelAsset> getCachedModel(const std::string& filePath);
         bool isModelCached(const std::string& filePath);
+        size_t getCachedModelCount();
+
+        // Drops cached files that no model uses any more
+        void releaseUnusedModels();
         void clearCache();
 
-        // Update method (call from main thread)
-        void update();
+        // Creates GPU resources for streamed models for up to budgetMilliseconds, then completes
+        // finished tasks. Call once per frame from the thread that owns the device.
+        void update(float budgetMilliseconds = 2.0f);
 
     private:
         AssetManager() = default;
@@ -66,21 +101,42 @@ namespace dx3d
         AssetManager(const AssetManager&) = delete;
         AssetManager& operator=(const AssetManager&) = delete;
 
+        // A file being streamed and how many tasks and synchronous loads are waiting for it
+        struct PendingLoad
+        {
+            AssetStreamer::RequestId request = 0;
+            ui32 waiterCount = 0;
+        };
+
         // Generate unique task ID
         std::string generateTaskId();
 
-        // Async loading worker
-        static std::shared_ptr<Model> loadModelWorker(
-            const std::string& filePath,
-            GraphicsResourceDesc resourceDesc,
-            std::shared_ptr<std::atomic<float>> progressPtr
-        );
+        // resourceDesc is null for the loads without a device
+        std::string startLoad(const std::string& filePath, const GraphicsResourceDesc* resourceDesc, float priority);
+        std::shared_ptr<const ModelAsset> waitForLoad(const std::string& filePath, const GraphicsResourceDesc* resourceDesc);
+
+        // The rest need m_cacheMutex held
+        AssetStreamer& getStreamer(const GraphicsResourceDesc* resourceDesc);
+        AssetStreamer::RequestId addWaiter(const std::string& filePath, const GraphicsResourceDesc* resourceDesc, float priority);
+
+        // Caches the pending load of a file if it is complete and retires it once it is done
+        void retirePendingLoad(const std::string& filePath);
+
+        // Streams a file at the lowest priority among the tasks waiting for it; needs both locks
+        void applyTaskPriority(const std::string& filePath);
 
     private:
         std::unordered_map<std::string, LoadingTask> m_loadingTasks;
-        std::unordered_map<std::string, std::shared_ptr<Model>> m_modelCache;
+        std::unordered_map<std::string, std::shared_ptr<const ModelAsset>> m_modelCache;
+        std::unordered_map<std::string, PendingLoad> m_pendingLoads;
+
+        // Declared after the uploader so it is destroyed first
+        std::unique_ptr<AssetUploader> m_uploader;
+        std::unique_ptr<AssetStreamer> m_streamer;
+
+        // Lock order: tasks, then cache
         std::mutex m_tasksMutex;
         std::mutex m_cacheMutex;
         std::atomic<uint32_t> m_taskCounter{ 0 };
     };
-}
\ No newline at end of file
+}
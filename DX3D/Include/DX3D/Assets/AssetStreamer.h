@@ -0,0 +1,114 @@
+#pragma once
+#include <DX3D/Core/Core.h>
+#include <DX3D/Assets/ModelAsset.h>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace dx3d
+{
+    class AssetUploader;
+
+    enum class StreamState : ui32
+    {
+        Queued = 0,         // waiting for a read slot
+        Reading,
+        WaitingForDecode,   // read, no current cooked file, waiting for a decode slot
+        Decoding,
+        WaitingForUpload,
+        Uploading,          // some of its materials and meshes are created
+        Complete,
+        Failed,
+        Cancelled
+    };
+
+    struct AssetStreamerDesc
+    {
+        ui32 workerCount = 2;           // at least one
+        ui32 maxConcurrentReads = 1;    // more rarely help on a single disk
+        ui32 maxConcurrentDecodes = 1;  // each import already spreads over the job system
+    };
+
+    // Streams models in three stages. Worker threads read files (mapping their cooked version when
+    // current) and decode the rest, each stage under its own concurrency limit; the thread owning
+    // the uploader then creates their materials and meshes a step at a time within a per-frame
+    // budget. Every stage picks the waiting request with the lowest priority value first, so
+    // callers can order loads by camera distance and re-order them as the camera moves.
+    class AssetStreamer
+    {
+    public:
+        using RequestId = ui64;
+
+        AssetStreamer(AssetUploader& uploader, const AssetStreamerDesc& desc = {});
+        ~AssetStreamer();
+
+        AssetStreamer(const AssetStreamer&) = delete;
+        AssetStreamer& operator=(const AssetStreamer&) = delete;
+
+        // Lower values load first
+        RequestId requestModel(const std::string& filePath, float priority = 0.0f);
+        void setPriority(RequestId request, float priority);
+
+        // Drops the request's queued work at once. A stage already running finishes first, after
+        // which nothing else is done for it.
+        void cancel(RequestId request);
+
+        // Cancels the request if it is unfinished and forgets it
+        void release(RequestId request);
+
+        // Unknown requests read as Cancelled
+        StreamState getState(RequestId request) const;
+
+        // 0 to 1 across reading, decoding and each upload step
+        float getProgress(RequestId request) const;
+
+        // Null unless Complete
+        std::shared_ptr<const ModelAsset> getAsset(RequestId request) const;
+
+        // Runs upload steps in priority order until the budget is used up or nothing is waiting,
+        // always at least one if anything is. Call on the thread that owns the uploader. Returns
+        // the number of steps run.
+        ui32 processUploads(float budgetMilliseconds);
+
+        // Blocks until the request is read and decoded, moving it to the front of both queues,
+        // then uploads it on the calling thread. Returns the asset, or null if it failed or was
+        // cancelled.
+        std::shared_ptr<const ModelAsset> finish(RequestId request);
+
+    private:
+        struct Request;
+
+        void workerLoop();
+
+        // Both with the lock held; the lock is released while the stage runs
+        void runWorkerStage(std::unique_lock<std::mutex>& lock, Request& request);
+        void runUploadStep(std::unique_lock<std::mutex>& lock, Request& request);
+
+        std::shared_ptr<Request> pickWorkerStage();
+        std::shared_ptr<Request> pickUpload();
+        std::shared_ptr<Request> findRequest(RequestId request) const;
+
+        // Moves a request to Cancelled, Failed or Complete and drops its intermediate data
+        void retire(Request& request, StreamState state);
+
+    private:
+        AssetUploader& m_uploader;
+        AssetStreamerDesc m_desc;
+
+        std::unordered_map<RequestId, std::shared_ptr<Request>> m_requests;
+        RequestId m_nextRequest = 1;
+        ui32 m_readsInFlight = 0;
+        ui32 m_decodesInFlight = 0;
+        bool m_stopping = false;
+
+        mutable std::mutex m_mutex;
+        std::condition_variable m_workAvailable;   // workers wait on this
+        std::condition_variable m_requestChanged;  // finish waits on this
+
+        std::vector<std::thread> m_workers;
+    };
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <DX3D/Core/Core.h>
+#include <memory>
+#include <string>
+
+namespace dx3d
+{
+    class Mesh;
+    class Texture2D;
+    struct MeshData;
+
+    // The device work of loading a model, kept apart from reading and decoding so those can run on
+    // any thread and the device calls can be spread over frames on the thread that owns them.
+    // D3D11AssetUploader creates the resources; RecordingAssetUploader logs the calls for tests.
+    class AssetUploader
+    {
+    public:
+        virtual ~AssetUploader() = default;
+
+        // Texture from an image file; null if it cannot be loaded. May be a placeholder that fills
+        // in once the file is decoded.
+        virtual std::shared_ptr<Texture2D> createTexture(const std::string& filePath) = 0;
+
+        // Vertex and index buffers (all LODs) for a mesh. Throws if they cannot be created.
+        virtual void createMeshResources(Mesh& mesh, const MeshData& data) = 0;
+    };
+}
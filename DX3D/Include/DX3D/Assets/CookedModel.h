@@ -0,0 +1,48 @@
+#pragma once
+#include <DX3D/Assets/ModelImporter.h>
+#include <DX3D/Core/MappedFile.h>
+#include <string>
+#include <vector>
+
+namespace dx3d
+{
+    // Bump whenever the layout below or the import pipeline's output changes; older files are
+    // then re-cooked instead of loaded
+    constexpr ui32 COOKED_MODEL_VERSION = 1;
+
+    // Cooked files sit next to their source with this appended to the file name
+    constexpr const char* COOKED_MODEL_EXTENSION = ".dxmodel";
+
+    // 64-bit hash of a source file's contents that cooked files are keyed by
+    ui64 hashSourceData(const void* data, size_t size);
+
+    std::string getCookedModelPath(const std::string& sourcePath);
+
+    // Writes an imported model as a cooked file: a header, mesh and material tables, then the
+    // vertex, index and string blobs, each 16-byte aligned. The file is written to a temporary
+    // name and renamed, so a crash never leaves a truncated file behind.
+    bool writeCookedModel(const std::string& path, const ImportedModel& model, ui64 sourceHash);
+
+    // A cooked file mapped into memory. Opening validates the header and tables but never
+    // copies geometry: getMeshData() points straight into the mapped pages for uploading.
+    class CookedModel
+    {
+    public:
+        // False if the file is missing, truncated, from another version or not cooked from a
+        // source with this hash
+        bool open(const std::string& path, ui64 sourceHash);
+        void close();
+
+        ui32 getMeshCount() const { return static_cast<ui32>(m_meshes.size()); }
+        const MeshData& getMeshData(ui32 mesh) const { return m_meshes[mesh]; }
+
+        const std::vector<ImportedMaterial>& getMaterials() const { return m_materials; }
+
+        size_t getFileSize() const { return m_file.getSize(); }
+
+    private:
+        MappedFile m_file;
+        std::vector<MeshData> m_meshes;
+        std::vector<ImportedMaterial> m_materials;
+    };
+}
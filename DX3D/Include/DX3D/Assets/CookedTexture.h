@@ -0,0 +1,84 @@
+#pragma once
+#include <DX3D/Assets/ImageDecoder.h>
+#include <DX3D/Core/MappedFile.h>
+#include <string>
+#include <vector>
+
+namespace dx3d
+{
+    // Bump whenever the layout below or the mip filter's output changes; older files are then
+    // re-cooked instead of loaded
+    constexpr ui32 COOKED_TEXTURE_VERSION = 1;
+
+    // Cooked files sit next to their source with this appended to the file name
+    constexpr const char* COOKED_TEXTURE_EXTENSION = ".dxtex";
+
+    // How a texture's RGB values are encoded. Mips of sRGB textures are filtered in linear light
+    // so they keep the brightness of the full-size image; alpha is always linear.
+    enum class TextureColorSpace : ui32
+    {
+        Linear = 0,
+        Srgb = 1
+    };
+
+    // One mip level of 8-bit RGBA, rows tightly packed
+    struct TextureMip
+    {
+        ui32 width = 0;
+        ui32 height = 0;
+        const unsigned char* pixels = nullptr;
+    };
+
+    // Guessed from the file name: normal, height, specular, roughness, metalness and occlusion
+    // maps hold data rather than colour and are linear; everything else is sRGB
+    TextureColorSpace getTextureColorSpace(const std::string& sourcePath);
+
+    std::string getCookedTexturePath(const std::string& sourcePath);
+
+    // Levels from the full image down to 1x1, each half the size of the one before (rounded
+    // down, never below 1). The base is moved into the first level.
+    std::vector<DecodedImage> generateMipChain(DecodedImage&& image, TextureColorSpace colorSpace);
+
+    // Writes a mip chain as a cooked file: a header, the mip table, then each level's pixels
+    // 16-byte aligned. Written to a temporary name and renamed like cooked models.
+    bool writeCookedTexture(const std::string& path, const std::vector<DecodedImage>& mips,
+        TextureColorSpace colorSpace, ui64 sourceHash);
+
+    // A cooked file mapped into memory. Opening validates the header and mip table; the mips
+    // point straight into the mapped pages for uploading.
+    class CookedTexture
+    {
+    public:
+        // False if the file is missing, truncated, from another version or not cooked from a
+        // source with this hash
+        bool open(const std::string& path, ui64 sourceHash);
+        void close();
+
+        ui32 getMipCount() const { return static_cast<ui32>(m_mips.size()); }
+        const TextureMip& getMip(ui32 mip) const { return m_mips[mip]; }
+        TextureColorSpace getColorSpace() const { return m_colorSpace; }
+
+        size_t getFileSize() const { return m_file.getSize(); }
+
+    private:
+        MappedFile m_file;
+        std::vector<TextureMip> m_mips;
+        TextureColorSpace m_colorSpace = TextureColorSpace::Srgb;
+    };
+
+    // A texture ready to upload: the mips of its current cooked file, or of its source decoded
+    // and cooked just now
+    struct TextureData
+    {
+        CookedTexture cooked;
+        std::vector<DecodedImage> decoded;
+        std::vector<TextureMip> mips;
+        TextureColorSpace colorSpace = TextureColorSpace::Srgb;
+        bool isCooked = false;
+    };
+
+    // Maps the cooked file of sourcePath if its hash matches the source, otherwise decodes the
+    // source, builds its mips and writes the cooked file for next time. A cooked file that cannot
+    // be written is not an error. Safe to call from any thread.
+    bool loadTextureData(const std::string& sourcePath, TextureData& data, std::string& error);
+}
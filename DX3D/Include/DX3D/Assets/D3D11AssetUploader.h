@@ -0,0 +1,19 @@
+#pragma once
+#include <DX3D/Assets/AssetUploader.h>
+#include <DX3D/Graphics/GraphicsResource.h>
+
+namespace dx3d
+{
+    // Creates model resources on a D3D11 device
+    class D3D11AssetUploader final : public AssetUploader
+    {
+    public:
+        explicit D3D11AssetUploader(const GraphicsResourceDesc& desc) : m_desc(desc) {}
+
+        std::shared_ptr<Texture2D> createTexture(const std::string& filePath) override;
+        void createMeshResources(Mesh& mesh, const MeshData& data) override;
+
+    private:
+        GraphicsResourceDesc m_desc;
+    };
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <DX3D/Core/Core.h>
+#include <string>
+#include <vector>
+
+namespace dx3d
+{
+    // 8-bit RGBA pixels, rows top to bottom without padding
+    struct DecodedImage
+    {
+        ui32 width = 0;
+        ui32 height = 0;
+        std::vector<unsigned char> pixels;
+    };
+
+    // Decodes PNG (every colour type and bit depth, interlaced or not) and JPEG (baseline and
+    // progressive Huffman, greyscale or YCbCr at any subsampling) without a platform codec, so it
+    // runs on any thread of any OS. False with the reason in error if the data is something else
+    // or corrupt.
+    bool decodeImage(const void* data, size_t size, DecodedImage& image, std::string& error);
+
+    // Maps and decodes a file, handing formats the decoder above does not read (BMP, GIF, TIFF,
+    // arithmetic-coded JPEG) to the platform's codec
+    bool decodeImageFile(const std::string& path, DecodedImage& image, std::string& error);
+
+    // The platform's codec, safe to call from any thread
+    bool decodePlatformImageFile(const std::string& path, DecodedImage& image, std::string& error);
+}
@@ -0,0 +1,16 @@
+#pragma once
+#include <DX3D/Graphics/Mesh.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace dx3d
+{
+    // Geometry and materials loaded from one model file. Shared read-only by every Model spawned
+    // from that file, so GPU buffers and materials exist once per file rather than once per instance.
+    struct ModelAsset
+    {
+        std::string filePath;
+        std::vector<std::shared_ptr<const Mesh>> meshes;
+    };
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <DX3D/Graphics/Vertex.h>
+#include <DX3D/Graphics/MeshLod.h>
+#include <DX3D/Math/Bounds.h>
+#include <string>
+#include <vector>
+
+namespace dx3d
+{
+    // Material properties as the source file states them; textures stay unresolved file names.
+    // Defaults are Material's with a grey diffuse, used when a file has no materials.
+    struct ImportedMaterial
+    {
+        std::string name = "Default";
+        Vector4 diffuseColor = Vector4(0.7f, 0.7f, 0.7f, 1.0f);
+        Vector4 ambientColor = Vector4(0.2f, 0.2f, 0.2f, 1.0f);
+        Vector4 specularColor = Vector4(1.0f, 1.0f, 1.0f, 1.0f);
+        Vector4 emissiveColor = Vector4(0.0f, 0.0f, 0.0f, 1.0f);
+        float specularPower = 32.0f;
+        float opacity = 1.0f;
+        std::string diffuseTexture;
+    };
+
+    // Geometry of one mesh without any GPU resources. Points either into an ImportedMesh or into
+    // a mapped cooked file, so both can be uploaded the same way.
+    struct MeshData
+    {
+        const Vertex* vertices = nullptr;
+        ui32 vertexCount = 0;
+        const ui32* indices = nullptr; // every LOD back to back
+        ui32 indexCount = 0;
+        const MeshLod* lods = nullptr;
+        ui32 lodCount = 0;
+        ui32 materialIndex = 0;
+        AABB bounds;
+    };
+
+    struct ImportedMesh
+    {
+        std::vector<Vertex> vertices;
+        MeshLodChain lodChain;
+        ui32 materialIndex = 0;
+        AABB bounds;
+
+        // Import statistics for the load report
+        ui32 cornerCount = 0; // vertices before welding, one per face corner
+        float cacheMissRatioBefore = 0.0f;
+        float cacheMissRatioAfter = 0.0f;
+
+        MeshData getData() const;
+    };
+
+    struct ImportedModel
+    {
+        std::vector<ImportedMesh> meshes;
+        std::vector<ImportedMaterial> materials;
+
+        float parseMilliseconds = 0.0f;
+        float geometryMilliseconds = 0.0f;
+    };
+
+    // Parses an OBJ file and turns every shape into a ready-to-upload mesh: corners are welded
+    // into shared vertices, the LOD chain is built and each level is ordered for the vertex
+    // caches. Needs no device, so tools can run it offline. Shapes whose geometry fails are
+    // reported and skipped; returns false if the file cannot be parsed or has no shapes.
+    bool importOBJ(const std::string& path, ImportedModel& model);
+}
@@ -1,41 +1,105 @@
 #pragma once
 #include <DX3D/Graphics/Primitives/Model.h>
 #include <DX3D/Graphics/GraphicsResource.h>
+#include <DX3D/Assets/ModelAsset.h>
+#include <DX3D/Assets/ModelImporter.h>
+#include <DX3D/Assets/CookedModel.h>
 #include <string>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
+#include <vector>
 #include <sstream>
 
 namespace dx3d
 {
+    class AssetUploader;
+
+    // A model file's data before any of it reaches the device: geometry from its cooked file or a
+    // fresh import, materials, and the texture file each material resolved to. Built without a
+    // device, so it can be read and decoded on any thread.
+    struct DecodedModel
+    {
+        std::string filePath;       // as requested
+        std::string fullPath;       // where it was found
+        std::string baseDirectory;
+        ui64 sourceHash = 0;
+        bool isDecoded = false;     // meshes and materials are filled in
+
+        CookedModel cooked;
+        ImportedModel imported;
+
+        // Point into cooked or imported
+        std::vector<MeshData> meshes;
+        std::vector<ImportedMaterial> materials;
+        std::vector<std::string> texturePaths; // per material, empty if it has none or none was found
+    };
+
+    // Turns a decoded model into a ModelAsset through an uploader, one material or mesh per step,
+    // so a load can be spread over frames. Steps run on the thread that owns the uploader.
+    class ModelAssetBuilder
+    {
+    public:
+        ModelAssetBuilder(std::shared_ptr<const DecodedModel> model, AssetUploader& uploader);
+
+        // Runs the next step; true once the asset is complete
+        bool step();
+
+        bool isComplete() const { return m_nextStep >= getStepCount(); }
+        ui32 getStepCount() const;
+        float getProgress() const;
+
+        // Null until complete
+        std::shared_ptr<const ModelAsset> getAsset() const;
+
+    private:
+        void createMaterial(ui32 material);
+        void createMesh(ui32 mesh);
+
+    private:
+        std::shared_ptr<const DecodedModel> m_model;
+        AssetUploader& m_uploader;
+        std::shared_ptr<ModelAsset> m_asset;
+        std::vector<std::shared_ptr<Material>> m_materials;
+        ui32 m_nextStep = 0;
+        ui32 m_lodTriangles[MAX_MESH_LODS] = {};
+    };
+
     class ModelLoader
     {
     public:
         // Static loading methods
-        static std::shared_ptr<Model> LoadModel(
+
+        // The I/O half of decoding: finds the file, hashes it and maps its cooked file if that is
+        // current, which leaves the model decoded. False if the file cannot be read.
+        static bool ReadModel(const std::string& filePath, DecodedModel& model);
+
+        // The CPU half: imports the source if ReadModel found no current cooked file, and cooks it
+        // for next time. False if it cannot be imported.
+        static bool DecodeModel(DecodedModel& model);
+
+        // Loads a file's meshes and materials on the calling thread; nullptr if it could not be
+        // loaded. Does not cache, callers that may load a file more than once go through AssetManager.
+        static std::shared_ptr<const ModelAsset> LoadModelAsset(
             const std::string& filePath,
             const GraphicsResourceDesc& resourceDesc
         );
 
-        // Async loading support (for future implementation)
-        struct LoadingProgress
-        {
-            float percentage = 0.0f;
-            bool isComplete = false;
-            bool hasError = false;
-            std::string errorMessage;
-        };
+        // Unit cube shown in place of models that failed to load, created on first use
+        static std::shared_ptr<const ModelAsset> GetDefaultModelAsset(const GraphicsResourceDesc& resourceDesc);
+
+        // Standalone instance of a file, or of the default cube if it fails to load
+        static std::shared_ptr<Model> LoadModel(
+            const std::string& filePath,
+            const GraphicsResourceDesc& resourceDesc
+        );
 
     private:
         // Private constructor - static class only
         ModelLoader() = delete;
 
         // Helper methods
-        static bool loadOBJ(
-            const std::string& filePath,
-            std::shared_ptr<Model>& model,
-            const GraphicsResourceDesc& resourceDesc
-        );
+        static void resolveTexturePaths(DecodedModel& model);
 
         static std::shared_ptr<Material> loadMaterial(
             const std::string& materialName,
@@ -46,9 +110,11 @@ namespace dx3d
 
         static std::string getDirectory(const std::string& filePath);
         static std::string getAssetPath(const std::string& relativePath);
-        static std::shared_ptr<Model> createDefaultModel(const GraphicsResourceDesc& resourceDesc);
 
         // Material cache to avoid loading the same material multiple times
         static std::unordered_map<std::string, std::shared_ptr<Material>> s_materialCache;
+
+        static std::shared_ptr<const ModelAsset> s_defaultAsset;
+        static std::mutex s_defaultAssetMutex;
     };
 }
\ No newline at end of file
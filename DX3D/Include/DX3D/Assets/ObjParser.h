@@ -0,0 +1,25 @@
+#pragma once
+#include <DX3D/Core/Core.h>
+#include <DX3D/Assets/tiny_obj_loader.h>
+#include <string>
+#include <vector>
+
+namespace dx3d
+{
+    // Parsed OBJ in tinyobj's structures, so code written against tinyobj::ObjReader keeps working
+    struct ObjModel
+    {
+        tinyobj::attrib_t attrib;
+        std::vector<tinyobj::shape_t> shapes;
+        std::vector<tinyobj::material_t> materials;
+        std::string warning;
+        std::string error;
+    };
+
+    // Parallel replacement for tinyobj::ObjReader::ParseFromFile with its default config
+    // (triangulation and vertex colours on), producing the same output. The file is mapped and
+    // split into chunks at line boundaries; chunks parse their attributes and faces concurrently
+    // and are stitched together with prefix sums, after which the few lines that change state
+    // (usemtl, g, o, s, l, p, mtllib) are replayed in order. Tag lines ('t') are ignored.
+    bool parseOBJ(const std::string& path, ObjModel& model);
+}
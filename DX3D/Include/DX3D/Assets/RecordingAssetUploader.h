@@ -0,0 +1,52 @@
+#pragma once
+#include <DX3D/Assets/AssetUploader.h>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace dx3d
+{
+    enum class UploadType : ui32
+    {
+        Texture = 0,
+        Mesh
+    };
+
+    // One recorded upload: the texture's file or the mesh's name, with the mesh's vertex and
+    // index counts (all LODs)
+    struct UploadRecord
+    {
+        UploadType type = UploadType::Texture;
+        std::string name;
+        ui32 vertexCount = 0;
+        ui32 indexCount = 0;
+    };
+
+    // Uploader without a device. Textures come back null and meshes get no buffers, so models load
+    // their CPU data and materials but never become ready for rendering. Each call can be made to
+    // take a fixed time to exercise upload budgets.
+    class RecordingAssetUploader final : public AssetUploader
+    {
+    public:
+        explicit RecordingAssetUploader(float millisecondsPerUpload = 0.0f) : m_millisecondsPerUpload(millisecondsPerUpload) {}
+
+        std::shared_ptr<Texture2D> createTexture(const std::string& filePath) override;
+        void createMeshResources(Mesh& mesh, const MeshData& data) override;
+
+        void clear();
+
+        std::vector<UploadRecord> getRecords() const;
+
+        // Meshes whose name contains this throw like a failed buffer creation, to exercise errors
+        void setFailingMeshName(const std::string& name);
+
+    private:
+        void record(const UploadRecord& upload);
+
+    private:
+        float m_millisecondsPerUpload = 0.0f;
+        std::string m_failingMeshName;
+        std::vector<UploadRecord> m_records;
+        mutable std::mutex m_mutex;
+    };
+}
@@ -27,6 +27,7 @@ namespace dx3d
 
     using i32 = int;
     using ui32 = unsigned int;
+    using ui64 = unsigned long long;
     using f32 = float;
     using d64 = double;
 
@@ -0,0 +1,70 @@
+#pragma once
+#include <DX3D/Core/Core.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dx3d
+{
+    // Fixed pool of worker threads for fork/join data-parallel work.
+    // The calling thread always takes part in its own parallelFor, so nested calls
+    // from inside a job cannot deadlock and a pool with zero workers runs everything inline.
+    class JobSystem
+    {
+    public:
+        static JobSystem& getInstance()
+        {
+            static JobSystem instance;
+            return instance;
+        }
+
+        // Runs job(i) for every i in [0, count) and returns once all of them finished.
+        // The first exception thrown by a job is rethrown on the calling thread.
+        void parallelFor(ui32 count, const std::function<void(ui32)>& job);
+
+        ui32 getWorkerCount() const { return static_cast<ui32>(m_workers.size()); }
+
+        // Restarts the pool with the given number of background workers (0 = run inline).
+        // Must not be called while a parallelFor is in flight.
+        void setWorkerCount(ui32 count);
+
+    private:
+        JobSystem();
+        ~JobSystem();
+        JobSystem(const JobSystem&) = delete;
+        JobSystem& operator=(const JobSystem&) = delete;
+
+        struct Batch
+        {
+            const std::function<void(ui32)>* job = nullptr;
+            ui32 count = 0;
+            std::atomic<ui32> next{ 0 };
+            std::atomic<ui32> finished{ 0 };
+
+            std::mutex mutex;
+            std::condition_variable done;
+            std::exception_ptr error;
+        };
+
+        void startWorkers(ui32 count);
+        void stopWorkers();
+        void workerLoop();
+
+        // Claims and runs indices of the batch until none are left
+        static void runBatch(Batch& batch);
+
+    private:
+        std::vector<std::thread> m_workers;
+
+        std::mutex m_queueMutex;
+        std::condition_variable m_queueCondition;
+        std::deque<std::shared_ptr<Batch>> m_queue;
+        bool m_stopping = false;
+    };
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <DX3D/Core/Core.h>
+#include <string>
+
+namespace dx3d
+{
+    // Read-only view of a whole file mapped into memory. Pages are loaded by the OS as they are
+    // touched, so opening is cheap regardless of the file's size.
+    class MappedFile
+    {
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+
+        // Replaces any file already open; false if the file is missing, empty or cannot be mapped
+        bool open(const std::string& path);
+        void close();
+
+        bool isOpen() const { return m_data != nullptr; }
+        const void* getData() const { return m_data; }
+        size_t getSize() const { return m_size; }
+
+    private:
+        const void* m_data = nullptr;
+        size_t m_size = 0;
+        void* m_file = nullptr;
+        void* m_mapping = nullptr;
+    };
+}
@@ -0,0 +1,107 @@
+#pragma once
+#include <DX3D/ECS/Entity.h>
+#include <utility>
+#include <vector>
+
+namespace dx3d
+{
+    class IComponentArray
+    {
+    public:
+        virtual ~IComponentArray() = default;
+        virtual void removeEntity(EntityID entity) = 0;
+    };
+
+    // Sparse-set storage: components live packed in m_dense (so begin()/end() walk
+    // contiguous memory) and m_sparse maps an EntityID straight to its dense slot.
+    // Removal swaps the last element into the hole, so pointers returned by
+    // getComponent are only valid until the next add/remove on the same array.
+    template<typename T>
+    class ComponentArray : public IComponentArray
+    {
+    public:
+        using Entry = std::pair<EntityID, T>;
+
+        static constexpr ui32 INVALID_INDEX = ~0u;
+
+        void addComponent(EntityID entity, T component)
+        {
+            if (entity >= m_sparse.size())
+            {
+                m_sparse.resize(static_cast<size_t>(entity) + 1, INVALID_INDEX);
+            }
+
+            ui32 index = m_sparse[entity];
+            if (index != INVALID_INDEX)
+            {
+                m_dense[index].second = std::move(component);
+                return;
+            }
+
+            m_sparse[entity] = static_cast<ui32>(m_dense.size());
+            m_dense.emplace_back(entity, std::move(component));
+        }
+
+        void removeComponent(EntityID entity)
+        {
+            if (!hasComponent(entity))
+                return;
+
+            ui32 index = m_sparse[entity];
+            ui32 lastIndex = static_cast<ui32>(m_dense.size() - 1);
+
+            if (index != lastIndex)
+            {
+                m_dense[index] = std::move(m_dense[lastIndex]);
+                m_sparse[m_dense[index].first] = index;
+            }
+
+            m_dense.pop_back();
+            m_sparse[entity] = INVALID_INDEX;
+        }
+
+        T* getComponent(EntityID entity)
+        {
+            ui32 index = indexOf(entity);
+            return (index != INVALID_INDEX) ? &m_dense[index].second : nullptr;
+        }
+
+        const T* getComponent(EntityID entity) const
+        {
+            ui32 index = indexOf(entity);
+            return (index != INVALID_INDEX) ? &m_dense[index].second : nullptr;
+        }
+
+        bool hasComponent(EntityID entity) const
+        {
+            return indexOf(entity) != INVALID_INDEX;
+        }
+
+        void removeEntity(EntityID entity) override
+        {
+            removeComponent(entity);
+        }
+
+        size_t size() const { return m_dense.size(); }
+        bool empty() const { return m_dense.empty(); }
+
+        void reserve(size_t count) { m_dense.reserve(count); }
+
+        // Iteration yields Entry (pair.first = entity, pair.second = component), same as the map it replaced
+        auto begin() { return m_dense.begin(); }
+        auto end() { return m_dense.end(); }
+
+        auto begin() const { return m_dense.begin(); }
+        auto end() const { return m_dense.end(); }
+
+    private:
+        ui32 indexOf(EntityID entity) const
+        {
+            return (entity < m_sparse.size()) ? m_sparse[entity] : INVALID_INDEX;
+        }
+
+    private:
+        std::vector<Entry> m_dense;
+        std::vector<ui32> m_sparse;
+    };
+}
@@ -1,65 +1,28 @@
 #pragma once
 #include <DX3D/ECS/Entity.h>
-#include <unordered_map>
+#include <DX3D/ECS/ComponentArray.h>
+#include <DX3D/ECS/ComponentView.h>
 #include <memory>
-#include <typeindex>
+#include <vector>
 
 namespace dx3d
 {
-    class IComponentArray
+    namespace detail
     {
-    public:
-        virtual ~IComponentArray() = default;
-        virtual void removeEntity(EntityID entity) = 0;
-    };
-
-    template<typename T>
-    class ComponentArray : public IComponentArray
-    {
-    public:
-        void addComponent(EntityID entity, T component)
-        {
-            m_components[entity] = std::move(component);
-        }
-
-        void removeComponent(EntityID entity)
-        {
-            m_components.erase(entity);
-        }
-
-        T* getComponent(EntityID entity)
-        {
-            auto it = m_components.find(entity);
-            return (it != m_components.end()) ? &it->second : nullptr;
-        }
-
-        // FIX: Add const version
-        const T* getComponent(EntityID entity) const
+        inline ui32 nextComponentTypeID()
         {
-            auto it = m_components.find(entity);
-            return (it != m_components.end()) ? &it->second : nullptr;
+            static ui32 s_nextID = 0;
+            return s_nextID++;
         }
 
-        bool hasComponent(EntityID entity) const
-        {
-            return m_components.find(entity) != m_components.end();
-        }
-
-        void removeEntity(EntityID entity) override
+        // Dense per-type id so ComponentManager can index its pools directly instead of hashing type_index
+        template<typename T>
+        ui32 getComponentTypeID()
         {
-            removeComponent(entity);
+            static const ui32 s_id = nextComponentTypeID();
+            return s_id;
         }
-
-        auto begin() { return m_components.begin(); }
-        auto end() { return m_components.end(); }
-
-        // FIX: Add const versions
-        auto begin() const { return m_components.begin(); }
-        auto end() const { return m_components.end(); }
-
-    private:
-        std::unordered_map<EntityID, T> m_components;
-    };
+    }
 
     class ComponentManager
     {
@@ -73,8 +36,12 @@ namespace dx3d
         template<typename T>
         void registerComponent()
         {
-            std::type_index typeIndex = std::type_index(typeid(T));
-            m_componentArrays[typeIndex] = std::make_unique<ComponentArray<T>>();
+            ui32 typeID = detail::getComponentTypeID<T>();
+            if (typeID >= m_componentArrays.size())
+            {
+                m_componentArrays.resize(static_cast<size_t>(typeID) + 1);
+            }
+            m_componentArrays[typeID] = std::make_unique<ComponentArray<T>>();
         }
 
         template<typename T>
@@ -95,7 +62,6 @@ namespace dx3d
             return getComponentArray<T>()->getComponent(entity);
         }
 
-        // FIX: Add const version
         template<typename T>
         const T* getComponent(EntityID entity) const
         {
@@ -112,11 +78,10 @@ namespace dx3d
         template<typename T>
         ComponentArray<T>* getComponentArray()
         {
-            std::type_index typeIndex = std::type_index(typeid(T));
-            auto it = m_componentArrays.find(typeIndex);
-            if (it != m_componentArrays.end())
+            ui32 typeID = detail::getComponentTypeID<T>();
+            if (typeID < m_componentArrays.size() && m_componentArrays[typeID])
             {
-                return static_cast<ComponentArray<T>*>(it->second.get());
+                return static_cast<ComponentArray<T>*>(m_componentArrays[typeID].get());
             }
             return nullptr;
         }
@@ -124,24 +89,45 @@ namespace dx3d
         template<typename T>
         const ComponentArray<T>* getComponentArray() const
         {
-            std::type_index typeIndex = std::type_index(typeid(T));
-            auto it = m_componentArrays.find(typeIndex);
-            if (it != m_componentArrays.end())
+            ui32 typeID = detail::getComponentTypeID<T>();
+            if (typeID < m_componentArrays.size() && m_componentArrays[typeID])
             {
-                return static_cast<const ComponentArray<T>*>(it->second.get());
+                return static_cast<const ComponentArray<T>*>(m_componentArrays[typeID].get());
             }
             return nullptr;
         }
 
+        // Entities owning every listed component, e.g. view<TransformComponent, PhysicsComponent>()
+        template<typename... Components>
+        ComponentView<Exclude<>, Components...> view()
+        {
+            return ComponentView<Exclude<>, Components...>(
+                std::make_tuple(getComponentArray<Components>()...),
+                std::tuple<>());
+        }
+
+        // Same as view() but skips entities that own any of the excluded components,
+        // e.g. view<TransformComponent>(exclude<PhysicsComponent>)
+        template<typename... Components, typename... Excluded>
+        ComponentView<Exclude<Excluded...>, Components...> view(Exclude<Excluded...>)
+        {
+            return ComponentView<Exclude<Excluded...>, Components...>(
+                std::make_tuple(getComponentArray<Components>()...),
+                std::make_tuple(static_cast<const ComponentArray<Excluded>*>(getComponentArray<Excluded>())...));
+        }
+
         void removeEntity(EntityID entity)
         {
-            for (auto& pair : m_componentArrays)
+            for (auto& array : m_componentArrays)
             {
-                pair.second->removeEntity(entity);
+                if (array)
+                {
+                    array->removeEntity(entity);
+                }
             }
         }
 
     private:
-        std::unordered_map<std::type_index, std::unique_ptr<IComponentArray>> m_componentArrays;
+        std::vector<std::unique_ptr<IComponentArray>> m_componentArrays;
     };
-}
\ No newline at end of file
+}
@@ -0,0 +1,138 @@
+#pragma once
+#include <DX3D/ECS/ComponentArray.h>
+#include <cstddef>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace dx3d
+{
+    // Tag listing component types an entity must NOT have to be visited by a view
+    template<typename... Excluded>
+    struct Exclude {};
+
+    template<typename... Excluded>
+    inline constexpr Exclude<Excluded...> exclude{};
+
+    template<typename ExcludeList, typename... Components>
+    class ComponentView;
+
+    // Joins several component pools: iteration is driven by the smallest included pool
+    // and every other pool is probed through its sparse table, so a miss costs two
+    // array reads. Do not add or remove components of the viewed types inside each().
+    template<typename... Excluded, typename... Components>
+    class ComponentView<Exclude<Excluded...>, Components...>
+    {
+        static_assert(sizeof...(Components) > 0, "ComponentView needs at least one component type");
+
+    public:
+        ComponentView(std::tuple<ComponentArray<Components>*...> pools,
+            std::tuple<const ComponentArray<Excluded>*...> excludedPools)
+            : m_pools(pools), m_excludedPools(excludedPools)
+        {
+        }
+
+        // Calls func(EntityID, Components&...) or func(Components&...) for every match
+        template<typename Func>
+        void each(Func&& func)
+        {
+            if (!allPoolsPresent())
+                return;
+
+            size_t driver = smallestPoolIndex(std::index_sequence_for<Components...>{});
+            eachFrom(driver, func, std::index_sequence_for<Components...>{});
+        }
+
+        bool contains(EntityID entity) const
+        {
+            if (!allPoolsPresent())
+                return false;
+
+            return std::apply([entity](auto*... pools) { return (pools->hasComponent(entity) && ...); }, m_pools)
+                && !isExcluded(entity);
+        }
+
+        template<typename T>
+        T* get(EntityID entity)
+        {
+            auto* pool = std::get<ComponentArray<T>*>(m_pools);
+            return pool ? pool->getComponent(entity) : nullptr;
+        }
+
+        // Upper bound on the number of matches (size of the driving pool)
+        size_t sizeHint() const
+        {
+            if (!allPoolsPresent())
+                return 0;
+
+            size_t result = std::numeric_limits<size_t>::max();
+            std::apply([&result](auto*... pools) { ((result = pools->size() < result ? pools->size() : result), ...); }, m_pools);
+            return result;
+        }
+
+    private:
+        bool allPoolsPresent() const
+        {
+            return std::apply([](auto*... pools) { return ((pools != nullptr) && ...); }, m_pools);
+        }
+
+        bool isExcluded(EntityID entity) const
+        {
+            return std::apply([entity](auto*... pools) {
+                return ((pools && pools->hasComponent(entity)) || ...);
+                }, m_excludedPools);
+        }
+
+        template<size_t... I>
+        size_t smallestPoolIndex(std::index_sequence<I...>) const
+        {
+            size_t best = 0;
+            size_t bestSize = std::numeric_limits<size_t>::max();
+            ((std::get<I>(m_pools)->size() < bestSize
+                ? (bestSize = std::get<I>(m_pools)->size(), best = I)
+                : best), ...);
+            return best;
+        }
+
+        template<typename Func, size_t... I>
+        void eachFrom(size_t driver, Func& func, std::index_sequence<I...>)
+        {
+            ((driver == I ? walkPool<I>(func) : void()), ...);
+        }
+
+        template<size_t Driver, typename Func>
+        void walkPool(Func& func)
+        {
+            auto* driverPool = std::get<Driver>(m_pools);
+
+            for (auto& entry : *driverPool)
+            {
+                EntityID entity = entry.first;
+
+                bool matches = std::apply([entity](auto*... pools) { return (pools->hasComponent(entity) && ...); }, m_pools);
+                if (!matches || isExcluded(entity))
+                    continue;
+
+                invoke(func, entity, std::get<ComponentArray<Components>*>(m_pools)->getComponent(entity)...);
+            }
+        }
+
+        template<typename Func>
+        static void invoke(Func& func, EntityID entity, Components*... components)
+        {
+            if constexpr (std::is_invocable_v<Func&, EntityID, Components&...>)
+            {
+                func(entity, *components...);
+            }
+            else
+            {
+                func(*components...);
+            }
+        }
+
+    private:
+        std::tuple<ComponentArray<Components>*...> m_pools;
+        std::tuple<const ComponentArray<Excluded>*...> m_excludedPools;
+    };
+}
@@ -9,6 +9,9 @@ namespace dx3d
         Vector3 rotation{ 0.0f, 0.0f, 0.0f }; // Euler angles in radians
         Vector3 scale{ 1.0f, 1.0f, 1.0f };
 
+        // Bumped by every writer so cached matrices can tell whether the transform changed
+        ui32 version = 0;
+
         Matrix4x4 getWorldMatrix() const
         {
             Matrix4x4 scaleMatrix = Matrix4x4::CreateScale(scale);
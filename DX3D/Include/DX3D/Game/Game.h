@@ -2,12 +2,19 @@
 #include <DX3D/Core/Base.h>
 #include <DX3D/Core/Core.h>
 #include <DX3D/Math/Math.h>
+#include <DX3D/Math/Frustum.h>
+#include <DX3D/Graphics/ShadowCascades.h>
+#include <DX3D/Graphics/RenderQueue.h>
+#include <DX3D/Graphics/RenderScene.h>
+#include <DX3D/Graphics/RenderView.h>
+#include <DX3D/Graphics/LightClusterGrid.h>
 #include <DX3D/Scene/Scene.h>
 #include <chrono>
 #include <memory>
 #include <vector>
 #include <typeinfo>
 #include <d3d11.h> 
+#include <wrl.h>
 #include "imgui.h"
 #include "imgui_impl_win32.h"
 #include "imgui_impl_dx11.h"
@@ -21,6 +28,8 @@ namespace dx3d
 {
     class VertexBuffer;
     class IndexBuffer;
+    class DeviceContext;
+    class D3D11RenderBackend;
     class ConstantBuffer;
     class VertexShader;
     class PixelShader;
@@ -53,13 +62,6 @@ namespace dx3d
 }
 
 namespace dx3d {
-    struct LightTransformMatrices
-    {
-        Matrix4x4 light_view;
-        Matrix4x4 light_projection;
-        Matrix4x4 world;
-    };
-
     struct FogDesc
     {
         bool enabled = true;
@@ -111,9 +113,36 @@ namespace dx3d
         std::vector<std::string> getLoadedTextures() const;
 
     private:
+        // Everything a record job touches, so jobs can record on separate threads: a deferred
+        // context, the backend drawing through it, and the job's light clusters, culling output and queue
+        struct RenderViewContext
+        {
+            std::shared_ptr<DeviceContext> deviceContext;
+            std::unique_ptr<D3D11RenderBackend> renderBackend;
+            LightClusterGrid lightClusters;
+            RenderViewState state;
+            Microsoft::WRL::ComPtr<ID3D11CommandList> commandList;
+            RenderStats stats;
+        };
+
+        // Camera state a scene view records with, captured on the main thread before recording starts
+        struct SceneViewDesc
+        {
+            Matrix4x4 viewMatrix;
+            Matrix4x4 projMatrix;
+            Vector3 cameraPosition;
+            float nearPlane = 0.1f;
+            float farPlane = 100.0f;
+            RenderTexture* renderTarget = nullptr;
+        };
+
         void render();
-        void renderScene(SceneCamera& camera, const Matrix4x4& projMatrix, RenderTexture* renderTarget = nullptr);
-        void renderShadowMapPass();
+        void recordViews(const SceneViewDesc& sceneView, const SceneViewDesc& gameView);
+        void recordScene(RenderViewContext& view, const SceneViewDesc& desc);
+        void recordShadowMap(RenderViewContext& view, ui32 cascadeIndex);
+        void prepareLighting(const SceneViewDesc& shadowView, const SceneViewDesc* coveredView);
+        void gatherRenderScene();
+        bool getPrimitiveDraw(RenderableType type, RenderSceneDraw& draw) const;
         void PrintMatrix(const char* name, const Matrix4x4& mat);
         void createRenderingResources();
         void update();
@@ -140,7 +169,6 @@ namespace dx3d
         std::string getCurrentTimeAndDate();
         std::string getObjectIcon(std::shared_ptr<AGameObject> object);
         std::shared_ptr<AGameObject> createObjectCopy(std::shared_ptr<AGameObject> original);
-        void setupMaterialForObject(std::shared_ptr<AGameObject> gameObject, DeviceContext& deviceContext);
 
         void saveScene();
         void loadScene(const std::string& filename);
@@ -176,6 +204,15 @@ namespace dx3d
         std::vector<std::shared_ptr<AGameObject>> m_gameObjects;
         std::vector<Vector3> m_objectRotationDeltas;
 
+        // Bounds, matrices and draws of m_gameObjects (same indexing), gathered once per frame
+        // and only read while the views record
+        RenderScene m_renderScene;
+
+        // One per record job (see getRecordJobView), and the counts and timings of the last finished
+        // frame per view (shown in the UI)
+        RenderViewContext m_recordJobs[RENDER_RECORD_JOB_COUNT];
+        FrameRenderStats m_lastFrameRenderStats;
+
         std::shared_ptr<VertexBuffer> m_cubeVertexBuffer;
         std::shared_ptr<IndexBuffer> m_cubeIndexBuffer;
 
@@ -191,6 +228,9 @@ namespace dx3d
         std::shared_ptr<VertexBuffer> m_capsuleVertexBuffer;
         std::shared_ptr<IndexBuffer> m_capsuleIndexBuffer;
 
+        // The single level of each primitive, indexed by RenderableType
+        MeshLod m_primitiveLods[static_cast<ui32>(RenderableType::Model)];
+
         std::shared_ptr<VertexBuffer> m_cameraGizmoVertexBuffer;
         std::shared_ptr<IndexBuffer> m_cameraGizmoIndexBuffer;
 
@@ -205,15 +245,10 @@ namespace dx3d
         std::shared_ptr<ConstantBuffer> m_fogConstantBuffer;
 
         std::shared_ptr<ConstantBuffer> m_materialConstantBuffer;
-        std::shared_ptr<ConstantBuffer> m_modelMaterialConstantBuffer;
-
-        std::shared_ptr<VertexShader> m_modelVertexShader;
-        std::shared_ptr<PixelShader> m_modelPixelShader;
 
         SnowConfig m_snowConfig;
         FogDesc m_fogDesc;
 
-        std::shared_ptr<ConstantBuffer> m_transformConstantBuffer;
         std::shared_ptr<DepthBuffer> m_depthBuffer;
 
         ID3D11DepthStencilState* m_solidDepthState = nullptr;
@@ -225,15 +260,20 @@ namespace dx3d
         float m_deltaTime{ 0.0f };
 
         std::vector<std::shared_ptr<LightObject>> m_lights;
-        std::shared_ptr<ConstantBuffer> m_lightConstantBuffer;
         Vector4 m_ambientColor = { 0.2f, 0.2f, 0.2f, 1.0f };
 
         std::shared_ptr<ShadowMap> m_shadowMap;
-        std::shared_ptr<VertexShader> m_depthVertexShader;
-        std::shared_ptr<ConstantBuffer> m_lightTransformConstantBuffer;
 
-        Matrix4x4 m_lightViewMatrix;
-        Matrix4x4 m_lightProjectionMatrix;
+        // Directional lights get cascades fitted to the active camera; spot lights a single perspective one
+        ShadowCascadeSettings m_shadowCascadeSettings;
+        ShadowCascade m_shadowCascades[MAX_SHADOW_CASCADES];
+        ui32 m_shadowCascadeCount = 0;
+        LightConstantBuffer m_lightConstants{}; // shared by the scene views; each sets its camera and clusters
+
+        // This frame's lights as the shader reads them (directional first), and world bounds of the
+        // rest, in the same order, for the scene views to bin into their clusters
+        std::vector<Light> m_frameLights;
+        std::vector<BoundingSphere> m_frameLightBounds;
         ID3D11SamplerState* m_shadowSamplerState = nullptr;
         int m_shadowCastingLightIndex = -1;
     };
@@ -1,6 +1,9 @@
 #pragma once
 #include <DX3D/Core/Core.h>
 #include <DX3D/Math/Math.h>
+#include <DX3D/Math/Ray.h>
+#include <DX3D/Math/BoundingVolumeHierarchy.h>
+#include <DX3D/ECS/Entity.h>
 #include <memory>
 #include <vector>
 
@@ -24,11 +27,27 @@ namespace dx3d
             float mouseX, float mouseY,
             ui32 viewportWidth, ui32 viewportHeight);
 
+        // Closest object hit by a world-space ray; hitDistance is in units of the ray direction
+        std::shared_ptr<AGameObject> raycast(
+            const std::vector<std::shared_ptr<AGameObject>>& objects,
+            const Ray& ray,
+            float* hitDistance = nullptr);
+
+        // Keeps the picking BVH in step with the scene: rebuilt when the object list changes or
+        // refits have loosened it, otherwise only the objects whose world matrix changed are refit
+        void updateSceneBounds(const std::vector<std::shared_ptr<AGameObject>>& objects);
+
+        static Ray createPickRay(const SceneCamera& camera, float mouseX, float mouseY,
+            ui32 viewportWidth, ui32 viewportHeight);
+
     private:
-        bool rayIntersectsAABB(const Vector3& rayOrigin, const Vector3& rayDir,
-            const Vector3& aabbMin, const Vector3& aabbMax, float& t);
+        void rebuildSceneBounds(const std::vector<std::shared_ptr<AGameObject>>& objects);
 
     private:
         std::shared_ptr<AGameObject> m_selectedObject;
+
+        BoundingVolumeHierarchy m_sceneBVH;
+        std::vector<EntityID> m_trackedEntities;   // objects the BVH was built from, by index
+        std::vector<ui32> m_trackedWorldVersions;
     };
-}
\ No newline at end of file
+}
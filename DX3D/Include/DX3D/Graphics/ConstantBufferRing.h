@@ -0,0 +1,41 @@
+#pragma once
+#include <DX3D/Graphics/GraphicsResource.h>
+
+namespace dx3d
+{
+    class DeviceContext;
+
+    // One large dynamic constant buffer that per-view constants are suballocated from and bound
+    // by offset (*SetConstantBuffers1). Allocations append with WRITE_NO_OVERWRITE; the first one
+    // of a frame, and any that no longer fits, discard and start again from the front.
+    class ConstantBufferRing final : public GraphicsResource
+    {
+    public:
+        // A constant range is addressed in 16-byte constants, in multiples of 16 (256 bytes)
+        struct Allocation
+        {
+            ID3D11Buffer* buffer = nullptr;
+            ui32 firstConstant = 0;
+            ui32 constantCount = 0;
+        };
+
+        ConstantBufferRing(ui32 sizeInBytes, const GraphicsResourceDesc& desc);
+        ~ConstantBufferRing();
+
+        void beginFrame() { m_discardNext = true; m_frameMapCount = 0; }
+
+        // Copies data into the ring; returns an empty allocation if it could not be mapped
+        Allocation allocate(DeviceContext& deviceContext, const void* data, ui32 size);
+
+        // Maps issued since the last beginFrame
+        ui32 getFrameMapCount() const { return m_frameMapCount; }
+
+    private:
+        Microsoft::WRL::ComPtr<ID3D11Buffer> m_buffer{};
+        ui32 m_size = 0;
+        ui32 m_offset = 0;
+        ui32 m_frameMapCount = 0;
+        bool m_discardNext = true;
+        bool m_canMapNoOverwrite = false;
+    };
+}
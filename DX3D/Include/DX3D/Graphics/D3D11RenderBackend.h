@@ -0,0 +1,68 @@
+#pragma once
+#include <DX3D/Graphics/RenderBackend.h>
+#include <DX3D/Graphics/GraphicsResource.h>
+#include <DX3D/Graphics/ConstantBufferRing.h>
+#include <memory>
+
+namespace dx3d
+{
+    class DeviceContext;
+    class InstanceBuffer;
+    class StructuredBuffer;
+    class LightClusterGrid;
+    struct Light;
+    class VertexShader;
+    class PixelShader;
+    class ShadowMap;
+
+    // Draws render queues through a D3D11 device context. Owns the model and depth pipelines,
+    // the constant ring that scene (PS b2) and view (VS b0) constants are suballocated from, and
+    // the instance stream (vertex slot 1) and the clustered light buffers (PS t2-t4).
+    class D3D11RenderBackend final : public RenderBackend
+    {
+    public:
+        D3D11RenderBackend(DeviceContext& deviceContext, const GraphicsResourceDesc& desc);
+        // Records on another context with its own ring and instance stream, reusing the shaders
+        // (and shadow map) of an existing backend instead of compiling them again
+        D3D11RenderBackend(DeviceContext& deviceContext, const D3D11RenderBackend& shaderSource, const GraphicsResourceDesc& desc);
+        ~D3D11RenderBackend() override;
+
+        // Shadow map the model shader samples (t1/s1)
+        void setShadowMap(const ShadowMap* shadowMap, ID3D11SamplerState* shadowSampler);
+
+        // Lights the model shader reads (t2) and the view's clusters indexing them (t3 ranges, t4 indices)
+        void setClusteredLights(const Light* lights, ui32 lightCount, const LightClusterGrid& clusters);
+
+        void beginFrame() override;
+        void setSceneConstants(const void* data, ui32 size) override;
+        void setViewConstants(const ModelViewConstants& constants) override;
+        ModelInstanceData* beginInstances(ui32 instanceCount) override;
+        void endInstances() override;
+        void setShader(RenderShader shader) override;
+        void setGeometry(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer) override;
+        void setTexture(const Texture2D* texture) override;
+        void drawIndexedInstanced(ui32 indexCount, ui32 instanceCount, ui32 firstIndex, ui32 firstInstance) override;
+
+    private:
+        void createLightBuffers(const GraphicsResourceDesc& desc);
+
+    private:
+        DeviceContext& m_deviceContext;
+
+        std::shared_ptr<VertexShader> m_modelVertexShader;
+        std::shared_ptr<PixelShader> m_modelPixelShader;
+        std::shared_ptr<VertexShader> m_depthVertexShader;
+        std::shared_ptr<ConstantBufferRing> m_constantRing;
+        std::shared_ptr<InstanceBuffer> m_instanceBuffer;
+        std::shared_ptr<StructuredBuffer> m_lightBuffer;
+        std::shared_ptr<StructuredBuffer> m_clusterRangeBuffer;
+        std::shared_ptr<StructuredBuffer> m_clusterLightIndexBuffer;
+
+        ConstantBufferRing::Allocation m_sceneConstants;
+        ConstantBufferRing::Allocation m_viewConstants;
+        ui32 m_firstInstance = 0; // where the current queue's instances start in the stream
+
+        const ShadowMap* m_shadowMap = nullptr;
+        ID3D11SamplerState* m_shadowSampler = nullptr;
+    };
+}
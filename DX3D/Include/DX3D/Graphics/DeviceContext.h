@@ -1,13 +1,14 @@
 #pragma once
 #include <DX3D/Graphics/GraphicsResource.h>
 #include <DX3D/Graphics/Vertex.h>
-#include <d3d11.h>
+#include <d3d11_1.h>
 #include <wrl.h>
 
 namespace dx3d
 {
     class VertexBuffer;
     class IndexBuffer;
+    class InstanceBuffer;
     class SwapChain;
     class DepthBuffer;  // Add forward declaration
 
@@ -23,20 +24,33 @@ namespace dx3d
         void setRenderTargetsWithDepth(SwapChain& swapChain, DepthBuffer& depthBuffer);
 
         void setVertexBuffer(const VertexBuffer& vertexBuffer);
+        // Vertices in slot 0, per-instance data in slot 1
+        void setVertexBuffers(const VertexBuffer& vertexBuffer, const InstanceBuffer& instanceBuffer);
         void setIndexBuffer(const IndexBuffer& indexBuffer);
         void setViewportSize(ui32 width, ui32 height);
         void setVertexShader(ID3D11VertexShader* vertexShader);
         void setPixelShader(ID3D11PixelShader* pixelShader);
         void setInputLayout(ID3D11InputLayout* inputLayout);
+        // Binds a 16-constant-aligned range of a constant buffer (D3D11.1 offset binding)
+        void setVertexConstantBufferRange(ui32 slot, ID3D11Buffer* buffer, ui32 firstConstant, ui32 constantCount);
+        void setPixelConstantBufferRange(ui32 slot, ID3D11Buffer* buffer, ui32 firstConstant, ui32 constantCount);
         void setRenderTargets(SwapChain& swapChain);
         void drawTriangleList(ui32 vertexCount, ui32 startVertexIndex);
         void drawTriangleStrip(ui32 vertexCount, ui32 startVertexIndex);
         void drawIndexed(ui32 indexCount, ui32 startIndexLocation, i32 baseVertexLocation);
+        void drawIndexedInstanced(ui32 indexCount, ui32 instanceCount, ui32 startIndexLocation,
+            i32 baseVertexLocation, ui32 startInstanceLocation);
         void present(SwapChain& swapChain);
 
+        // Deferred contexts: closes what was recorded so far into a command list and starts a new one
+        Microsoft::WRL::ComPtr<ID3D11CommandList> finishCommandList();
+        // Immediate context: plays back a command list recorded on a deferred context
+        void executeCommandList(ID3D11CommandList* commandList);
+
         ID3D11DeviceContext* getDeviceContext();
 
     private:
         Microsoft::WRL::ComPtr<ID3D11DeviceContext> m_deviceContext;
+        Microsoft::WRL::ComPtr<ID3D11DeviceContext1> m_deviceContext1;
     };
 }
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+#include <DX3D/Graphics/GraphicsResource.h>
+
+namespace dx3d
+{
+    class DeviceContext;
+
+    // Dynamic per-instance vertex stream shared by every view of a frame. Each map appends after
+    // the previous one with WRITE_NO_OVERWRITE; the first map of a frame, and any that no longer
+    // fits, discard and start again from the front.
+    class InstanceBuffer final : public GraphicsResource
+    {
+    public:
+        InstanceBuffer(ui32 instanceSize, ui32 instanceCapacity, const GraphicsResourceDesc& gDesc);
+
+        void beginFrame() { m_discardNext = true; }
+
+        // Maps room for instanceCount instances, growing by half again when they cannot fit.
+        // firstInstance receives where they start, for the draw's StartInstanceLocation.
+        // Returns null if the map failed.
+        void* map(DeviceContext& deviceContext, ui32 instanceCount, ui32& firstInstance);
+        void unmap(DeviceContext& deviceContext);
+
+        ui32 getInstanceSize() const noexcept { return m_instanceSize; }
+        ui32 getCapacity() const noexcept { return m_capacity; }
+        ID3D11Buffer* getBuffer() const noexcept { return m_buffer.Get(); }
+
+    private:
+        void createBuffer();
+
+    private:
+        Microsoft::WRL::ComPtr<ID3D11Buffer> m_buffer{};
+        ui32 m_instanceSize = 0;
+        ui32 m_capacity = 0;
+        ui32 m_used = 0;
+        bool m_discardNext = true;
+    };
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <DX3D/Core/Core.h>
+#include <DX3D/Math/Math.h>
+
+namespace dx3d
+{
+    class Material;
+
+    // Material constants for models, streamed per instance (MATERIAL0-4)
+    struct ModelMaterialConstants
+    {
+        Vector4 diffuseColor;
+        Vector4 ambientColor;
+        Vector4 specularColor;
+        Vector4 emissiveColor;
+        float specularPower;
+        float opacity;
+        float hasTexture;
+        float padding;
+    };
+
+    // View constants shared by every instance of a view (b0); both matrices transposed
+    struct ModelViewConstants
+    {
+        Matrix4x4 view;
+        Matrix4x4 projection;
+    };
+
+    // One element of the instance stream (vertex slot 1). The world matrix is stored untransposed
+    // because the shaders rebuild it from rows; the depth shader only reads the world rows.
+    struct ModelInstanceData
+    {
+        Matrix4x4 world;
+        ModelMaterialConstants material;
+    };
+
+    // Constants for a material, or the engine defaults when material is null
+    ModelMaterialConstants makeMaterialConstants(const Material* material);
+}
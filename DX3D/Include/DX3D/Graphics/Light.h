@@ -1,5 +1,6 @@
 #pragma once
 #include <DX3D/Math/Math.h>
+#include <DX3D/Graphics/ShadowCascades.h>
 
 namespace dx3d
 {
@@ -24,16 +25,25 @@ namespace dx3d
         float padding;
     };
 
-#define MAX_LIGHTS_SUPPORTED 16
+    // Lights themselves live in a structured buffer (t2), directional ones first. Those light
+    // every pixel; the rest are looked up through the view's light clusters (t3/t4).
     __declspec(align(16)) struct LightConstantBuffer
     {
         Vector4 camera_position;
         Vector4 ambient_color;
-        UINT num_lights;
-        int shadow_casting_light_index = -1;
+        UINT num_directional_lights;
+        int shadow_casting_light_index = -1; // index into the light buffer
         Vector2 padding;
-        Light lights[MAX_LIGHTS_SUPPORTED];
-        Matrix4x4 light_view;
-        Matrix4x4 light_projection;
+        Vector4 cluster_view_z;  // dot with a world position (w = 1) gives its view depth
+        Vector4 cluster_scale;   // tiles per pixel (xy), depth slice scale (z) and bias (w)
+        UINT cluster_tiles_x;
+        UINT cluster_tiles_y;
+        UINT cluster_depth_slices;
+        UINT cluster_padding;
+        Matrix4x4 shadow_view_projection[MAX_SHADOW_CASCADES]; // transposed, sharpest cascade first
+        Vector4 shadow_atlas_rects[MAX_SHADOW_CASCADES];
+        UINT shadow_cascade_count;
+        float shadow_texel_size; // uv size of one shadow map texel
+        Vector2 shadow_padding;
     };
 }
\ No newline at end of file
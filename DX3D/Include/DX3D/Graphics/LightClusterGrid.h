@@ -0,0 +1,113 @@
+#pragma once
+#include <DX3D/Core/Core.h>
+#include <DX3D/Math/Math.h>
+#include <DX3D/Math/Bounds.h>
+#include <vector>
+
+namespace dx3d
+{
+    struct LightClusterGridDesc
+    {
+        ui32 tilesX = 16;
+        ui32 tilesY = 9;
+        ui32 depthSlices = 24;
+    };
+
+    // View-space froxel grid that lists, per cluster, the lights whose bounds reach into it.
+    // Screen tiles run left to right and top to bottom like pixel coordinates; depth slices are
+    // spaced logarithmically between the near and far plane, so a pixel finds its cluster from
+    // its position and view depth alone:
+    //   slice = floor(log(viewZ) * getSliceScale() + getSliceBias())
+    // Clusters are numbered (slice * tilesY + tileY) * tilesX + tileX.
+    class LightClusterGrid
+    {
+    public:
+        // Range of getLightIndices() holding one cluster's lights; matches the shader's uint2
+        struct ClusterRange
+        {
+            ui32 offset = 0;
+            ui32 count = 0;
+        };
+
+        explicit LightClusterGrid(const LightClusterGridDesc& desc = LightClusterGridDesc());
+
+        // Bins world-space light bounds into the clusters of a perspective (LH, row-vector) camera.
+        // Light i is stored as index firstLightIndex + i, so the indices can point past lights
+        // that are not binned (directional ones) in the buffer the shader reads.
+        void build(const Matrix4x4& viewMatrix, const Matrix4x4& projMatrix, float nearPlane, float farPlane,
+            const std::vector<BoundingSphere>& lightBounds, ui32 firstLightIndex);
+
+        ui32 getClusterIndex(ui32 tileX, ui32 tileY, ui32 slice) const { return (slice * m_desc.tilesY + tileY) * m_desc.tilesX + tileX; }
+        ui32 getDepthSlice(float viewDepth) const;
+        float getSliceNear(ui32 slice) const;
+        float getSliceScale() const { return m_sliceScale; }
+        float getSliceBias() const { return m_sliceBias; }
+
+        const LightClusterGridDesc& getDesc() const { return m_desc; }
+        ui32 getClusterCount() const { return m_desc.tilesX * m_desc.tilesY * m_desc.depthSlices; }
+        const std::vector<ClusterRange>& getClusterRanges() const { return m_clusterRanges; }
+        const std::vector<ui32>& getLightIndices() const { return m_lightIndices; }
+
+        // Sphere around a spot light's cone, tighter than one around its whole range
+        static BoundingSphere getSpotLightBounds(const Vector3& position, const Vector3& direction, float range, float halfAngle);
+
+    private:
+        // A light's view-space sphere and the block of clusters its screen rect and depth can touch
+        struct LightExtent
+        {
+            ui32 firstSlice = 1;
+            ui32 lastSlice = 0; // firstSlice > lastSlice: the light misses the view
+            ui32 firstTileX = 0;
+            ui32 lastTileX = 0;
+            ui32 firstTileY = 0;
+            ui32 lastTileY = 0;
+        };
+
+        struct ClusterEntry
+        {
+            ui32 cluster; // within the slice
+            ui32 light;
+        };
+
+        void updateClusterBounds(const Matrix4x4& projMatrix, float nearPlane, float farPlane);
+        void computeLightExtents(const Matrix4x4& viewMatrix, const std::vector<BoundingSphere>& lightBounds);
+        void binSlice(ui32 slice);
+
+    private:
+        LightClusterGridDesc m_desc;
+
+        // Projection the cluster boxes were built for; they only change with it
+        Matrix4x4 m_boundsProjection;
+        float m_boundsNear = 0.0f;
+        float m_boundsFar = 0.0f;
+        bool m_boundsValid = false;
+
+        float m_nearPlane = 0.1f;
+        float m_farPlane = 100.0f;
+        float m_sliceScale = 0.0f;
+        float m_sliceBias = 0.0f;
+
+        // View-space cluster boxes (centre and half size), in cluster order
+        std::vector<float> m_clusterCenterX;
+        std::vector<float> m_clusterCenterY;
+        std::vector<float> m_clusterCenterZ;
+        std::vector<float> m_clusterExtentX;
+        std::vector<float> m_clusterExtentY;
+        std::vector<float> m_clusterExtentZ;
+
+        // Per light: view-space sphere and cluster block
+        std::vector<float> m_lightX;
+        std::vector<float> m_lightY;
+        std::vector<float> m_lightZ;
+        std::vector<float> m_lightRadius;
+        std::vector<LightExtent> m_lightExtents;
+        ui32 m_firstLightIndex = 0;
+
+        // Per slice: (cluster, light) hits in light order, and their counts per cluster
+        std::vector<std::vector<ClusterEntry>> m_sliceEntries;
+        std::vector<std::vector<ui32>> m_sliceCounts;
+
+        std::vector<ClusterRange> m_clusterRanges;
+        std::vector<ui32> m_lightIndices;
+    };
+}
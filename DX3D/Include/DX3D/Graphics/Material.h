@@ -1,12 +1,13 @@
 #pragma once
 #include <DX3D/Core/Core.h>
 #include <DX3D/Math/Math.h>
-#include <DX3D/Graphics/Texture2D.h>
 #include <memory>
 #include <string>
 
 namespace dx3d
 {
+    class Texture2D;
+
     class Material
     {
     public:
@@ -41,6 +42,9 @@ namespace dx3d
         void setName(const std::string& name) { m_name = name; }
         const std::string& getName() const { return m_name; }
 
+        // Small process-unique id the render queue folds into its sort keys; 0 is the default material
+        ui32 getSortId() const { return m_sortId; }
+
     private:
         std::string m_name;
 
@@ -56,5 +60,7 @@ namespace dx3d
         // Material properties
         float m_specularPower;
         float m_opacity;
+
+        ui32 m_sortId;
     };
 }
\ No newline at end of file
@@ -3,6 +3,10 @@
 #include <DX3D/Graphics/IndexBuffer.h>
 #include <DX3D/Graphics/Material.h>
 #include <DX3D/Graphics/Vertex.h>
+#include <DX3D/Graphics/MeshLod.h>
+#include <DX3D/Math/Bounds.h>
+#include <DX3D/Math/BoundingVolumeHierarchy.h>
+#include <DX3D/Math/Ray.h>
 #include <memory>
 #include <vector>
 #include <string>
@@ -15,10 +19,21 @@ namespace dx3d
         Mesh(const std::string& name = "");
         ~Mesh() = default;
 
-        // Create rendering resources from vertex/index data
+        // Create rendering resources from vertex/index data. indices may hold several LODs back
+        // to back, described by lods; without lods all indices form LOD 0.
         void createRenderingResources(
             const std::vector<Vertex>& vertices,
             const std::vector<ui32>& indices,
+            const GraphicsResourceDesc& resourceDesc,
+            const std::vector<MeshLod>& lods = {}
+        );
+
+        // Same from geometry owned elsewhere, such as a mapped cooked file; it is uploaded
+        // straight from there and only LOD 0 is copied for picking
+        void createRenderingResources(
+            const Vertex* vertices, ui32 vertexCount,
+            const ui32* indices, ui32 indexCount,
+            const MeshLod* lods, ui32 lodCount,
             const GraphicsResourceDesc& resourceDesc
         );
 
@@ -28,8 +43,16 @@ namespace dx3d
         std::shared_ptr<Material> getMaterial() const { return m_material; }
 
         ui32 getIndexCount() const { return m_indexCount; }
+
+        // Levels share the vertex and index buffers; lod is clamped to the last level
+        ui32 getLodCount() const { return static_cast<ui32>(m_lods.size()); }
+        const MeshLod& getLod(ui32 lod) const { return m_lods[std::min(lod, getLodCount() - 1)]; }
+        const AABB& getBounds() const { return m_bounds; }
         const std::string& getName() const { return m_name; }
 
+        // Small process-unique id the render queue folds into its sort keys
+        ui32 getSortId() const { return m_sortId; }
+
         // Setters
         void setMaterial(std::shared_ptr<Material> material) { m_material = material; }
         void setName(const std::string& name) { m_name = name; }
@@ -37,11 +60,23 @@ namespace dx3d
         // Check if mesh is ready for rendering
         bool isReadyForRendering() const;
 
+        // Closest triangle hit of a mesh-space ray closer than maxT, which is lowered to the hit.
+        // Builds a triangle BVH on first use so meshes that are never picked pay nothing.
+        bool raycast(const Ray& ray, float& maxT) const;
+
     private:
         std::string m_name;
         std::shared_ptr<VertexBuffer> m_vertexBuffer;
         std::shared_ptr<IndexBuffer> m_indexBuffer;
         std::shared_ptr<Material> m_material;
-        ui32 m_indexCount;
+        ui32 m_indexCount; // LOD 0
+        ui32 m_sortId;
+        std::vector<MeshLod> m_lods;
+        AABB m_bounds;
+
+        // CPU copy of the LOD 0 geometry for picking
+        std::vector<Vector3> m_positions;
+        std::vector<ui32> m_indices;
+        mutable BoundingVolumeHierarchy m_triangleBVH;
     };
 }
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+#include <DX3D/Core/Core.h>
+#include <DX3D/Graphics/Vertex.h>
+#include <vector>
+
+namespace dx3d
+{
+    // LOD 0 is the source mesh; the rest are simplified versions of it
+    constexpr ui32 MAX_MESH_LODS = 5;
+
+    // Fraction of the screen height an object's bounding sphere covers below which LOD i + 1
+    // takes over from LOD i
+    constexpr float MESH_LOD_SCREEN_SIZES[MAX_MESH_LODS - 1] = { 0.5f, 0.25f, 0.125f, 0.0625f };
+
+    // Relative margin around each threshold that an object has to cross before its LOD changes
+    constexpr float MESH_LOD_HYSTERESIS = 0.1f;
+
+    // One level's range of a mesh's index buffer. All levels index the same vertices.
+    struct MeshLod
+    {
+        ui32 firstIndex = 0;
+        ui32 indexCount = 0;
+        float error = 0.0f; // largest quadric error accepted while simplifying, in mesh units
+    };
+
+    struct MeshLodSettings
+    {
+        ui32 lodCount = 4;          // levels including LOD 0, clamped to [1, MAX_MESH_LODS]
+        float reduction = 0.5f;     // triangles each level keeps of the one before
+        float maxError = 0.05f;     // give up on a level past this error, relative to the mesh's size
+    };
+
+    // Index buffer holding every level back to back, LOD 0 first
+    struct MeshLodChain
+    {
+        std::vector<ui32> indices;
+        std::vector<MeshLod> lods;
+    };
+
+    // Simplifies a triangle list by quadric error metric edge collapses (Garland and Heckbert).
+    // Vertices are welded by position for the topology; collapses only move a vertex onto a
+    // neighbour, so every level indexes the original vertices and shares their buffer. Levels
+    // stop early when a mesh cannot be reduced further within settings.maxError.
+    MeshLodChain buildMeshLodChain(const std::vector<Vertex>& vertices, const std::vector<ui32>& indices,
+        const MeshLodSettings& settings);
+
+    // Projected size of a bounding sphere as a fraction of the screen height, for a row-vector
+    // projection matrix; viewDepth is ignored for orthographic projections
+    float getProjectedScreenSize(float radius, float viewDepth, const Matrix4x4& projection);
+
+    // Level for an object covering screenSize of the screen. With a currentLod below lodCount the
+    // switch only happens once the size is MESH_LOD_HYSTERESIS past the threshold, so objects
+    // resting near a threshold do not flicker between levels.
+    ui32 selectMeshLod(float screenSize, ui32 lodCount, ui32 currentLod = MAX_MESH_LODS);
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <DX3D/Core/Core.h>
+#include <DX3D/Graphics/Vertex.h>
+#include <vector>
+
+namespace dx3d
+{
+    // Post-transform cache size the orderings target; small enough to suit every GPU generation
+    constexpr ui32 VERTEX_CACHE_SIZE = 16;
+
+    // Reorders the triangles of an index range so consecutive triangles reuse recently
+    // transformed vertices ("Tipsify", Sander, Nehab and Barczak 2007). Runs in linear time.
+    void optimizeVertexCache(ui32* indices, ui32 indexCount, ui32 vertexCount, ui32 cacheSize = VERTEX_CACHE_SIZE);
+
+    // Renumbers vertices in the order the indices first use them, so the vertex fetch walks
+    // memory forwards. Vertices no index refers to are dropped.
+    void optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<ui32>& indices);
+
+    // Average number of vertices transformed per triangle with a FIFO cache of cacheSize
+    // entries (average cache miss ratio); 3 is the worst case, about 0.6 the best for grids
+    float computeAverageCacheMissRatio(const ui32* indices, ui32 indexCount, ui32 vertexCount,
+        ui32 cacheSize = VERTEX_CACHE_SIZE);
+}
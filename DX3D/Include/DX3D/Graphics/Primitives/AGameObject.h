@@ -2,6 +2,8 @@
 #include <DX3D/Graphics/VertexBuffer.h>
 #include <DX3D/Graphics/IndexBuffer.h>
 #include <DX3D/Math/Math.h>
+#include <DX3D/Math/Bounds.h>
+#include <DX3D/Math/Ray.h>
 #include <DX3D/ECS/Entity.h>
 #include <DX3D/ECS/Components/TransformComponent.h>
 #include <DX3D/ECS/Components/PhysicsComponent.h>
@@ -15,6 +17,18 @@
 
 namespace dx3d
 {
+    // What the renderer draws for an object, so render passes can dispatch without dynamic casts
+    enum class RenderableType : ui32
+    {
+        None = 0,
+        Cube,
+        Plane,
+        Sphere,
+        Cylinder,
+        Capsule,
+        Model
+    };
+
     class AGameObject : public std::enable_shared_from_this<AGameObject>
     {
     public:
@@ -48,8 +62,20 @@ namespace dx3d
         Vector3 getWorldRotation() const;
         Vector3 getWorldScale() const;
 
-        Matrix4x4 getWorldMatrix() const;
-        Matrix4x4 getLocalMatrix() const { return m_transform.getLocalMatrix(); }
+        // Cached; only rebuilt after this object or one of its ancestors moved
+        const Matrix4x4& getWorldMatrix() const;
+        const Matrix4x4& getLocalMatrix() const;
+
+        // Object-space bounds of what the object draws; unit cube (±0.5) unless overridden
+        virtual AABB getLocalBounds() const;
+        const AABB& getWorldBounds() const;
+
+        // Exact test of an object-space ray (world ray times the inverse world matrix) for picking;
+        // lowers maxT to the hit distance. Defaults to the local bounds box.
+        virtual bool intersectLocalRay(const Ray& localRay, float& maxT) const;
+
+        // Changes whenever the cached world matrix is rebuilt, so spatial structures can skip unmoved objects
+        ui32 getWorldVersion() const { getWorldMatrix(); return m_worldVersion; }
 
         void rotate(const Vector3& deltaRotation);
         void translate(const Vector3& deltaPosition);
@@ -75,6 +101,7 @@ namespace dx3d
 
         virtual void update(float deltaTime) {}
         virtual void render() {}
+        virtual RenderableType getRenderableType() const { return RenderableType::None; }
 
         std::string getObjectType();
 
@@ -107,6 +134,9 @@ namespace dx3d
         void syncTransformToECS();
         void updateChildrenTransforms();
 
+        // Call when getLocalBounds() would return something different (e.g. meshes added)
+        void invalidateBounds() { m_dirtyFlags |= BoundsDirty; }
+
     protected:
         Transform m_transform;
         Entity m_entity;
@@ -118,7 +148,25 @@ namespace dx3d
         std::vector<std::weak_ptr<AGameObject>> m_children;
 
     private:
+        enum DirtyFlags : ui32
+        {
+            LocalDirty = 1 << 0,
+            WorldDirty = 1 << 1,
+            BoundsDirty = 1 << 2,
+            AllDirty = LocalDirty | WorldDirty | BoundsDirty
+        };
+
         static EntityID s_nextEntityID;
         Matrix4x4 getParentWorldMatrix() const;
+
+        // Lazily rebuilt on the calling thread, so query from one thread at a time
+        mutable Matrix4x4 m_localMatrix;
+        mutable Matrix4x4 m_worldMatrix;
+        mutable AABB m_worldBounds;
+        mutable ui32 m_dirtyFlags = AllDirty;
+        mutable ui32 m_worldVersion = 0;
+        mutable ui32 m_parentWorldVersion = 0;
+        mutable bool m_worldIncludesParent = false; // m_worldMatrix was built from a parent's
+        ui32 m_transformVersion = 0; // TransformComponent::version m_transform was last synced with
     };
 }
\ No newline at end of file
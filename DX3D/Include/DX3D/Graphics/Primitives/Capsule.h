@@ -30,6 +30,12 @@ namespace dx3d
 
         // Override virtual methods from base class if needed
         virtual void update(float deltaTime) override;
+        virtual RenderableType getRenderableType() const override { return RenderableType::Capsule; }
+        virtual AABB getLocalBounds() const override
+        {
+            // Radius 0.5 hemispheres on a 0.5 tall body
+            return AABB(Vector3(-0.5f, -0.75f, -0.5f), Vector3(0.5f, 0.75f, 0.5f));
+        }
 
     protected:
         virtual CollisionShapeType getCollisionShapeType() const override
@@ -24,6 +24,7 @@ namespace dx3d
 
         // Override virtual methods from base class if needed
         virtual void update(float deltaTime) override;
+        virtual RenderableType getRenderableType() const override { return RenderableType::Cube; }
 
     protected:
         virtual CollisionShapeType getCollisionShapeType() const override
@@ -29,6 +29,7 @@ namespace dx3d
 
         // Override virtual methods from base class if needed
         virtual void update(float deltaTime) override;
+        virtual RenderableType getRenderableType() const override { return RenderableType::Cylinder; }
 
     protected:
         virtual CollisionShapeType getCollisionShapeType() const override
@@ -1,6 +1,7 @@
 #pragma once
 #include <DX3D/Graphics/Primitives/AGameObject.h>
 #include <DX3D/Graphics/Mesh.h>
+#include <DX3D/Assets/ModelAsset.h>
 #include <memory>
 #include <vector>
 #include <string>
@@ -14,14 +15,19 @@ namespace dx3d
         Model(const Vector3& position, const Vector3& rotation = Vector3(0, 0, 0), const Vector3& scale = Vector3(1, 1, 1));
         virtual ~Model() = default;
 
-        // Mesh management
-        void addMesh(std::shared_ptr<Mesh> mesh);
+        // Mesh management. Meshes may be shared with other models and are never modified through one.
+        void addMesh(std::shared_ptr<const Mesh> mesh);
         void removeMesh(size_t index);
         void clearMeshes();
 
-        std::shared_ptr<Mesh> getMesh(size_t index) const;
+        std::shared_ptr<const Mesh> getMesh(size_t index) const;
         size_t getMeshCount() const { return m_meshes.size(); }
-        const std::vector<std::shared_ptr<Mesh>>& getMeshes() const { return m_meshes; }
+        const std::vector<std::shared_ptr<const Mesh>>& getMeshes() const { return m_meshes; }
+
+        // Makes this model an instance of a loaded file: takes its meshes, path and name.
+        // The asset stays alive as long as any instance refers to it.
+        void setAsset(std::shared_ptr<const ModelAsset> asset);
+        const std::shared_ptr<const ModelAsset>& getAsset() const { return m_asset; }
 
         // Model properties
         void setFilePath(const std::string& filePath) { m_filePath = filePath; }
@@ -35,8 +41,12 @@ namespace dx3d
 
         // Override virtual methods from base class
         virtual void update(float deltaTime) override;
+        virtual RenderableType getRenderableType() const override { return RenderableType::Model; }
+        virtual AABB getLocalBounds() const override;
+        virtual bool intersectLocalRay(const Ray& localRay, float& maxT) const override;
 
-        // Static factory method for loading models
+        // New instance of a model file. Files are loaded once through the AssetManager cache and
+        // their meshes shared, so spawning the same file again costs no parsing or GPU memory.
         static std::shared_ptr<Model> LoadFromFile(
             const std::string& filePath,
             const GraphicsResourceDesc& resourceDesc
@@ -45,7 +55,8 @@ namespace dx3d
     private:
         std::string m_name;
         std::string m_filePath;
-        std::vector<std::shared_ptr<Mesh>> m_meshes;
+        std::vector<std::shared_ptr<const Mesh>> m_meshes;
+        std::shared_ptr<const ModelAsset> m_asset;
 
     protected:
         virtual CollisionShapeType getCollisionShapeType() const override;
@@ -30,6 +30,11 @@ namespace dx3d
 
         // Override virtual methods from base class if needed
         virtual void update(float deltaTime) override;
+        virtual RenderableType getRenderableType() const override { return RenderableType::Plane; }
+        virtual AABB getLocalBounds() const override
+        {
+            return AABB(Vector3(-0.5f, 0.0f, -0.5f), Vector3(0.5f, 0.0f, 0.5f));
+        }
 
     protected:
         virtual CollisionShapeType getCollisionShapeType() const override
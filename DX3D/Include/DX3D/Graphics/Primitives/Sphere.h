@@ -25,6 +25,7 @@ namespace dx3d
         virtual ~Sphere() = default;
 
         virtual void update(float deltaTime) override;
+        virtual RenderableType getRenderableType() const override { return RenderableType::Sphere; }
 
     protected:
         virtual CollisionShapeType getCollisionShapeType() const override
@@ -0,0 +1,67 @@
+#pragma once
+#include <DX3D/Graphics/RenderBackend.h>
+#include <string>
+#include <vector>
+
+namespace dx3d
+{
+    enum class RenderCommandType : ui32
+    {
+        BeginFrame = 0,
+        SetSceneConstants,
+        SetViewConstants,
+        SetShader,
+        SetGeometry,
+        SetTexture,
+        DrawIndexedInstanced
+    };
+
+    // One recorded backend call. resource is the bound vertex buffer or texture; args hold the
+    // byte size for SetSceneConstants, the shader for SetShader, and indexCount, instanceCount,
+    // firstInstance, firstIndex for draws.
+    struct RenderCommand
+    {
+        RenderCommandType type = RenderCommandType::BeginFrame;
+        const void* resource = nullptr;
+        ui32 args[4] = {};
+    };
+
+    // Backend without a device. Recording keeps every command plus the last instance stream and
+    // scene/view constants; with recording off it is a null backend that only provides instance storage.
+    class RecordingRenderBackend final : public RenderBackend
+    {
+    public:
+        explicit RecordingRenderBackend(bool recordCommands = true) : m_recordCommands(recordCommands) {}
+
+        void beginFrame() override;
+        void setSceneConstants(const void* data, ui32 size) override;
+        void setViewConstants(const ModelViewConstants& constants) override;
+        ModelInstanceData* beginInstances(ui32 instanceCount) override;
+        void endInstances() override {}
+        void setShader(RenderShader shader) override;
+        void setGeometry(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer) override;
+        void setTexture(const Texture2D* texture) override;
+        void drawIndexedInstanced(ui32 indexCount, ui32 instanceCount, ui32 firstIndex, ui32 firstInstance) override;
+
+        void clear();
+
+        const std::vector<RenderCommand>& getCommands() const { return m_commands; }
+        const std::vector<ModelInstanceData>& getInstances() const { return m_instances; }
+        const std::vector<unsigned char>& getSceneConstants() const { return m_sceneConstants; }
+        const ModelViewConstants& getViewConstants() const { return m_viewConstants; }
+
+        // One line per command. Resources are numbered in order of first use rather than printed
+        // as addresses, so equal command streams give equal text across runs.
+        std::string toString() const;
+
+    private:
+        void record(RenderCommandType type, const void* resource = nullptr, ui32 arg0 = 0, ui32 arg1 = 0, ui32 arg2 = 0, ui32 arg3 = 0);
+
+    private:
+        bool m_recordCommands = true;
+        std::vector<RenderCommand> m_commands;
+        std::vector<ModelInstanceData> m_instances;
+        std::vector<unsigned char> m_sceneConstants;
+        ModelViewConstants m_viewConstants{};
+    };
+}
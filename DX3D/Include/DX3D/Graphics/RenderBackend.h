@@ -0,0 +1,38 @@
+#pragma once
+#include <DX3D/Core/Core.h>
+#include <DX3D/Graphics/RenderQueue.h>
+#include <DX3D/Graphics/InstanceData.h>
+
+namespace dx3d
+{
+    class VertexBuffer;
+    class IndexBuffer;
+    class Texture2D;
+
+    // The commands RenderQueue::submit issues, kept free of any graphics API so the whole
+    // queue path can run without a device. D3D11RenderBackend draws them;
+    // RecordingRenderBackend logs them (or drops them) for benchmarks and tests.
+    class RenderBackend
+    {
+    public:
+        virtual ~RenderBackend() = default;
+
+        // Per-frame transient storage (constants, instances) is recycled from here on
+        virtual void beginFrame() = 0;
+
+        // Scene-wide pixel constants (lights, shadow matrices) for the views that follow
+        virtual void setSceneConstants(const void* data, ui32 size) = 0;
+        virtual void setViewConstants(const ModelViewConstants& constants) = 0;
+
+        // Storage for the instances of the queue being submitted, valid until endInstances.
+        // Returns null if none could be provided, in which case nothing is drawn.
+        virtual ModelInstanceData* beginInstances(ui32 instanceCount) = 0;
+        virtual void endInstances() = 0;
+
+        // Binding a shader also binds whatever view-wide state it reads
+        virtual void setShader(RenderShader shader) = 0;
+        virtual void setGeometry(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer) = 0;
+        virtual void setTexture(const Texture2D* texture) = 0;
+        virtual void drawIndexedInstanced(ui32 indexCount, ui32 instanceCount, ui32 firstIndex, ui32 firstInstance) = 0;
+    };
+}
@@ -0,0 +1,128 @@
+#pragma once
+#include <DX3D/Core/Core.h>
+#include <DX3D/Math/Math.h>
+#include <vector>
+
+namespace dx3d
+{
+    class VertexBuffer;
+    class IndexBuffer;
+    class Material;
+    class Texture2D;
+    class RenderBackend;
+
+    // Passes in submission order; the pass sits in the top bits of the sort key
+    enum class RenderPass : ui32
+    {
+        Shadow = 0,
+        Opaque,
+        Count
+    };
+
+    // Shader programs a packet can be drawn with
+    enum class RenderShader : ui32
+    {
+        Depth = 0,
+        Model,
+        Count
+    };
+
+    // One indexed draw: geometry, material and the object whose world matrix it uses.
+    // Pointers are borrowed for the frame; the queue never owns resources.
+    struct DrawPacket
+    {
+        ui64 sortKey = 0;
+        RenderShader shader = RenderShader::Model;
+        const VertexBuffer* vertexBuffer = nullptr;
+        const IndexBuffer* indexBuffer = nullptr;
+        ui32 firstIndex = 0; // start of the mesh LOD's range in the index buffer
+        ui32 indexCount = 0;
+        const Material* material = nullptr; // null draws with the default material
+        const Texture2D* texture = nullptr; // material's diffuse texture, the only part bound per draw
+        ui32 objectIndex = 0;
+    };
+
+    // Consecutive packets drawn by one instanced call; instance i of the batch is packet firstPacket + i
+    struct InstanceBatch
+    {
+        ui32 firstPacket = 0;
+        ui32 instanceCount = 0;
+    };
+
+    struct RenderStats
+    {
+        ui32 drawCalls = 0;
+        ui32 instances = 0;
+        ui32 triangles = 0;
+        ui32 shaderChanges = 0;
+        ui32 meshChanges = 0;
+        ui32 materialChanges = 0;
+        f32 cpuMilliseconds = 0.0f; // culling, queue building and command recording
+
+        ui32 getStateChanges() const { return shaderChanges + meshChanges + materialChanges; }
+
+        RenderStats& operator+=(const RenderStats& other)
+        {
+            drawCalls += other.drawCalls;
+            instances += other.instances;
+            triangles += other.triangles;
+            shaderChanges += other.shaderChanges;
+            meshChanges += other.meshChanges;
+            materialChanges += other.materialChanges;
+            cpuMilliseconds += other.cpuMilliseconds;
+            return *this;
+        }
+    };
+
+    // Draw packets for one view, sorted by a 64-bit key so consecutive packets share as much
+    // state as possible. Key layout from the most significant bit:
+    //   pass (4) | shader (8) | mesh (16) | material (16) | depth (20)
+    // Mesh and material ids only need to be stable for the frame; collisions cost extra state
+    // changes, never wrong output, because submission compares the actual pointers.
+    // After sorting, runs of packets that only differ in per-instance data (world matrix and
+    // material constants) are grouped into instance batches.
+    class RenderQueue
+    {
+    public:
+        static constexpr ui32 DEPTH_BITS = 20;
+
+        // depth01 is the view depth normalized to [0, 1]; nearer packets sort first
+        static ui64 makeSortKey(RenderPass pass, RenderShader shader, ui32 meshId, ui32 materialId, float depth01);
+
+        void clear() { m_packets.clear(); m_batches.clear(); }
+        void reserve(ui32 count) { m_packets.reserve(count); }
+        void push(const DrawPacket& packet) { m_packets.push_back(packet); }
+
+        // Stable LSD radix sort on sortKey; byte positions where every key agrees are skipped
+        void sort();
+
+        // Splits the packets, in their current order, into runs that can share one instanced draw
+        void buildBatches();
+
+        // True when b can be drawn as another instance of a's draw call
+        static bool canShareBatch(const DrawPacket& a, const DrawPacket& b);
+
+        // Writes one instance per packet, in queue order, then draws the batches binding only the
+        // state that changes between them. worldMatrices is indexed by DrawPacket::objectIndex.
+        RenderStats submit(RenderBackend& backend, const std::vector<Matrix4x4>& worldMatrices,
+            const Matrix4x4& viewMatrix, const Matrix4x4& projMatrix) const;
+
+        ui32 size() const { return static_cast<ui32>(m_packets.size()); }
+        bool isEmpty() const { return m_packets.empty(); }
+        const std::vector<DrawPacket>& getPackets() const { return m_packets; }
+        const std::vector<InstanceBatch>& getBatches() const { return m_batches; }
+
+    private:
+        struct SortEntry
+        {
+            ui64 key;
+            ui32 index;
+        };
+
+        std::vector<DrawPacket> m_packets;
+        std::vector<InstanceBatch> m_batches;
+        std::vector<DrawPacket> m_scratch;
+        std::vector<SortEntry> m_sortEntries;
+        std::vector<SortEntry> m_sortScratch;
+    };
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <DX3D/Core/Core.h>
+#include <DX3D/Math/Math.h>
+#include <DX3D/Math/Bounds.h>
+#include <DX3D/Math/Frustum.h>
+#include <DX3D/Graphics/MeshLod.h>
+#include <DX3D/Graphics/RenderQueue.h>
+#include <vector>
+
+namespace dx3d
+{
+    struct ShadowCascade;
+
+    // One mesh an object draws. Pointers are borrowed for the frame, like DrawPacket's.
+    struct RenderSceneDraw
+    {
+        const VertexBuffer* vertexBuffer = nullptr;
+        const IndexBuffer* indexBuffer = nullptr;
+        const MeshLod* lods = nullptr; // at least one level
+        ui32 lodCount = 0;
+        ui32 meshId = 0; // Mesh::getSortId, or the RenderableType of a built-in primitive
+        const Material* material = nullptr;
+        const Texture2D* texture = nullptr;
+    };
+
+    // What the views draw, gathered from the scene objects once per frame on the main thread and
+    // only read while the views record, so they can record on separate threads. Objects keep the
+    // indices of the scene's object list; null, disabled and not yet loaded ones get bounds but no draws.
+    class RenderScene
+    {
+    public:
+        void clear();
+        void reserve(ui32 objectCount);
+
+        // Appends the next object; draws added after it belong to it. Casters grow getCasterBounds.
+        void addObject(const AABB& worldBounds, const Matrix4x4& worldMatrix, bool castsShadow);
+        void addDraw(const RenderSceneDraw& draw);
+
+        ui32 getObjectCount() const { return static_cast<ui32>(m_worldMatrices.size()); }
+        const CullingBounds& getBounds() const { return m_bounds; }
+        const std::vector<Matrix4x4>& getWorldMatrices() const { return m_worldMatrices; }
+        const AABB& getCasterBounds() const { return m_casterBounds; }
+
+        const RenderSceneDraw* getDraws(ui32 objectIndex) const { return m_draws.data() + m_firstDraw[objectIndex]; }
+        ui32 getDrawCount(ui32 objectIndex) const { return m_firstDraw[objectIndex + 1] - m_firstDraw[objectIndex]; }
+
+    private:
+        CullingBounds m_bounds;
+        std::vector<Matrix4x4> m_worldMatrices;
+        AABB m_casterBounds;
+        std::vector<RenderSceneDraw> m_draws;
+        std::vector<ui32> m_firstDraw{ 0 }; // object i draws m_draws[m_firstDraw[i]] up to m_firstDraw[i + 1]
+    };
+
+    // A view's culling output and queue, reused from frame to frame
+    struct RenderViewState
+    {
+        std::vector<ui32> visibleObjects;
+        std::vector<ui32> objectLods; // mesh LOD each object drew with last frame, for hysteresis
+        RenderQueue renderQueue;
+    };
+
+    // One packet per draw of each visible object, then sorted and batched. All draws of an object
+    // use one LOD picked from its projected size; the opaque pass applies hysteresis through
+    // view.objectLods, while the shadow pass picks afresh because cascades see objects at
+    // different sizes. The shadow pass draws with the depth shader and no material.
+    void buildRenderQueue(const RenderScene& scene, RenderViewState& view, RenderPass pass,
+        const Matrix4x4& viewMatrix, const Matrix4x4& projMatrix, float farPlane);
+
+    // Culls against the camera and submits the opaque pass
+    RenderStats recordSceneView(const RenderScene& scene, RenderViewState& view, RenderBackend& backend,
+        const Matrix4x4& viewMatrix, const Matrix4x4& projMatrix, float farPlane);
+
+    // Submits the shadow pass of the casters reaching into the cascade's box
+    RenderStats recordShadowCascade(const RenderScene& scene, RenderViewState& view, RenderBackend& backend,
+        const ShadowCascade& cascade);
+}
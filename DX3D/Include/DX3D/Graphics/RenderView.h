@@ -0,0 +1,60 @@
+#pragma once
+#include <DX3D/Core/Core.h>
+#include <DX3D/Graphics/RenderQueue.h>
+#include <DX3D/Graphics/ShadowCascades.h>
+
+namespace dx3d
+{
+    // Views recorded every frame, in the order their command lists are executed.
+    // Later views sample what earlier ones rendered (the scene views read the shadow map).
+    enum class RenderViewType : ui32
+    {
+        Shadow = 0,
+        Scene,
+        Game,
+        Count
+    };
+
+    constexpr ui32 RENDER_VIEW_COUNT = static_cast<ui32>(RenderViewType::Count);
+
+    inline const char* getRenderViewName(RenderViewType type)
+    {
+        switch (type)
+        {
+        case RenderViewType::Shadow: return "Shadow";
+        case RenderViewType::Scene: return "Scene";
+        case RenderViewType::Game: return "Game";
+        default: return "Unknown";
+        }
+    }
+
+    // Recording is split finer than the views so a frame has more independent jobs than cores to
+    // spread over: the shadow view records one job per cascade tile, the scene views one each.
+    // Jobs are executed in index order, so every cascade is drawn before the views sampling it.
+    constexpr ui32 RENDER_RECORD_JOB_COUNT = MAX_SHADOW_CASCADES + RENDER_VIEW_COUNT - 1;
+
+    inline RenderViewType getRecordJobView(ui32 job)
+    {
+        return job < MAX_SHADOW_CASCADES ? RenderViewType::Shadow : static_cast<RenderViewType>(job - MAX_SHADOW_CASCADES + 1);
+    }
+
+    // Draw counts and CPU timings of one frame, per view and for the whole frame
+    struct FrameRenderStats
+    {
+        RenderStats views[RENDER_VIEW_COUNT];
+        f32 recordMilliseconds = 0.0f;  // wall time from starting the view jobs until all had recorded
+        f32 executeMilliseconds = 0.0f; // main thread executing the recorded command lists
+
+        const RenderStats& getView(RenderViewType type) const { return views[static_cast<ui32>(type)]; }
+
+        RenderStats getTotal() const
+        {
+            RenderStats total;
+            for (const auto& view : views)
+            {
+                total += view;
+            }
+            return total;
+        }
+    };
+}
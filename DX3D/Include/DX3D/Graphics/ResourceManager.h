@@ -3,13 +3,23 @@
 #include <DX3D/Graphics/Material.h>
 #include <DX3D/Graphics/GraphicsResource.h>
 #include <DX3D/Core/Logger.h>
+#include <condition_variable>
+#include <deque>
 #include <memory>
 #include <unordered_map>
 #include <string>
 #include <mutex>
+#include <thread>
+#include <vector>
 
 namespace dx3d
 {
+    struct TextureData;
+
+    // Loads each texture file once, whichever name or search path reaches it. The first request
+    // for a file returns a placeholder straight away and queues the file on a pool of worker
+    // threads, which map its cooked mip chain or decode and cook it; update() then uploads the
+    // mips into that same texture, so whoever holds it sees the real image from the next frame on.
     class ResourceManager
     {
     public:
@@ -25,7 +35,7 @@ namespace dx3d
         // Shutdown and clear all cached resources
         void shutdown();
 
-        // Texture loading methods
+        // Texture loading methods. Safe from any thread; a file that is not found gives nullptr.
         std::shared_ptr<Texture2D> loadTexture(const std::string& fileName);
         std::shared_ptr<Texture2D> getTexture(const std::string& fileName) const;
         bool isTextureLoaded(const std::string& fileName) const;
@@ -33,32 +43,64 @@ namespace dx3d
         // Material creation methods
         std::shared_ptr<Material> createMaterial(const std::string& name = "");
 
+        // Uploads decoded textures for up to budgetMilliseconds. Call once per frame from the
+        // thread that owns the device.
+        void update(float budgetMilliseconds = 2.0f);
+
+        // Waits for every queued texture to load and uploads them all
+        void finishLoading();
+        size_t getPendingTextureCount() const;
+
         // Cache management
         void clearTextureCache();
         void removeTexture(const std::string& fileName);
 
         // Statistics and debugging
-        size_t getTextureCount() const { return m_textureCache.size(); }
+        size_t getTextureCount() const;
         std::vector<std::string> getLoadedTextureNames() const;
 
         // Check if initialized
         bool isInitialized() const { return m_initialized; }
 
     private:
-        ResourceManager() = default;
-        ~ResourceManager() = default;
+        ResourceManager();
+        ~ResourceManager();
         ResourceManager(const ResourceManager&) = delete;
         ResourceManager& operator=(const ResourceManager&) = delete;
 
         // Try multiple paths to find texture files
         std::string findTexturePath(const std::string& fileName) const;
 
+        // A placeholder waiting for its file to be loaded, and then for its upload
+        struct TextureJob
+        {
+            std::shared_ptr<Texture2D> texture;
+            std::string fullPath;
+            std::unique_ptr<TextureData> data;
+            std::string error;
+        };
+
+        void startWorkers();
+        void stopWorkers();
+        void workerLoop();
+        void uploadJob(TextureJob& job);
+
     private:
         std::unique_ptr<GraphicsResourceDesc> m_resourceDesc;
-        std::unordered_map<std::string, std::shared_ptr<Texture2D>> m_textureCache;
+        std::unordered_map<std::string, std::shared_ptr<Texture2D>> m_textureCache; // by canonical path
         mutable std::mutex m_textureMutex;
         bool m_initialized = false;
 
+        // Decoding, guarded by m_jobMutex. Never held together with m_textureMutex.
+        std::vector<std::thread> m_workers;
+        std::deque<TextureJob> m_decodeQueue;
+        std::deque<TextureJob> m_uploadQueue;
+        size_t m_decodingCount = 0;
+        bool m_stopping = false;
+        mutable std::mutex m_jobMutex;
+        std::condition_variable m_jobAvailable;
+        std::condition_variable m_jobLoaded;
+
         // Common texture search paths
         static const std::vector<std::string> s_texturePaths;
     };
@@ -9,19 +9,25 @@ namespace dx3d
         static const char* GetVertexShaderCode()
         {
             return R"(
-                cbuffer LightTransformBuffer : register(b0)
+                cbuffer LightViewBuffer : register(b0)
                 {
                     matrix light_view;
                     matrix light_projection;
-                    matrix world;
                 };
 
                 struct VS_INPUT {
                     float3 position : POSITION;
+
+                    // Per instance: world matrix rows (the rest of the instance is material data)
+                    float4 world0 : WORLD0;
+                    float4 world1 : WORLD1;
+                    float4 world2 : WORLD2;
+                    float4 world3 : WORLD3;
                 };
 
                 float4 main(VS_INPUT input) : SV_POSITION
                 {
+                    float4x4 world = float4x4(input.world0, input.world1, input.world2, input.world3);
                     float4 world_pos = mul(float4(input.position, 1.0f), world);
                     float4 view_pos = mul(world_pos, light_view);
                     float4 clip_pos = mul(view_pos, light_projection);
@@ -1,6 +1,6 @@
 #pragma once
 #include <DX3D/Graphics/Shaders/Shaders.h>
-#include <DX3D/Math/Math.h>
+#include <DX3D/Graphics/InstanceData.h>
 
 
 namespace dx3d
@@ -11,9 +11,8 @@ namespace dx3d
         static const char* GetVertexShaderCode()
         {
             return R"(
-                cbuffer TransformBuffer : register(b0)
+                cbuffer ViewBuffer : register(b0)
                 {
-                    matrix world;
                     matrix view;
                     matrix projection;
                 };
@@ -23,6 +22,17 @@ namespace dx3d
                     float4 color : COLOR;
                     float3 normal : NORMAL;
                     float2 texCoord : TEXCOORD;
+
+                    // Per instance: world matrix rows and material constants
+                    float4 world0 : WORLD0;
+                    float4 world1 : WORLD1;
+                    float4 world2 : WORLD2;
+                    float4 world3 : WORLD3;
+                    float4 diffuseColor : MATERIAL0;
+                    float4 ambientColor : MATERIAL1;
+                    float4 specularColor : MATERIAL2;
+                    float4 emissiveColor : MATERIAL3;
+                    float4 materialParams : MATERIAL4;
                 };
 
                 struct VS_OUTPUT {
@@ -31,11 +41,19 @@ namespace dx3d
                     float3 normal : NORMAL;
                     float2 texCoord : TEXCOORD0;
                     float3 worldPos : TEXCOORD1;
+                    nointerpolation float4 diffuseColor : MATERIAL0;
+                    nointerpolation float4 ambientColor : MATERIAL1;
+                    nointerpolation float4 specularColor : MATERIAL2;
+                    nointerpolation float4 emissiveColor : MATERIAL3;
+                    nointerpolation float4 materialParams : MATERIAL4;
                 };
 
                 VS_OUTPUT main(VS_INPUT input) {
                     VS_OUTPUT output;
 
+                    // Instance rows arrive as stored on the CPU, so no transpose is needed
+                    float4x4 world = float4x4(input.world0, input.world1, input.world2, input.world3);
+
                     // Transform position to world space
                     float4 worldPosition = mul(float4(input.position, 1.0f), world);
                     output.worldPos = worldPosition.xyz;
@@ -53,6 +71,12 @@ namespace dx3d
                     output.color = input.color;
                     output.texCoord = input.texCoord;
 
+                    output.diffuseColor = input.diffuseColor;
+                    output.ambientColor = input.ambientColor;
+                    output.specularColor = input.specularColor;
+                    output.emissiveColor = input.emissiveColor;
+                    output.materialParams = input.materialParams;
+
                     return output;
                 }
             )";
@@ -83,24 +107,20 @@ namespace dx3d
                 {
                     float4 camera_position;
                     float4 ambient_color;
-                    uint   num_lights;
+                    uint   num_directional_lights;
                     int    shadow_casting_light_index;
                     float2 padding;
-                    Light  lights[16];
-                    matrix light_view;
-                    matrix light_projection;
-                };
-        
-                cbuffer MaterialBuffer : register(b1)
-                {
-                    float4 diffuseColor;
-                    float4 ambientColor;
-                    float4 specularColor;
-                    float4 emissiveColor;
-                    float  specularPower;
-                    float  opacity;
-                    float  hasTexture;
-                    float  padding_mat;
+                    float4 cluster_view_z;
+                    float4 cluster_scale; // tiles per pixel (xy), depth slice scale (z) and bias (w)
+                    uint   cluster_tiles_x;
+                    uint   cluster_tiles_y;
+                    uint   cluster_depth_slices;
+                    uint   cluster_padding;
+                    matrix shadow_view_projection[4];
+                    float4 shadow_atlas_rects[4]; // uv scale (xy) and offset (zw) of each cascade's tile
+                    uint   shadow_cascade_count;
+                    float  shadow_texel_size;
+                    float2 shadow_padding;
                 };
 
                 Texture2D shadowMap : register(t1);
@@ -108,15 +128,55 @@ namespace dx3d
                 Texture2D diffuseTexture : register(t0);
                 SamplerState textureSampler : register(s0);
 
+                // Directional lights first, then the ones the clusters index
+                StructuredBuffer<Light> lightBuffer : register(t2);
+                StructuredBuffer<uint2> clusterRanges : register(t3); // offset and count into clusterLightIndices
+                StructuredBuffer<uint> clusterLightIndices : register(t4);
+
                 struct PS_INPUT {
                     float4 position     : SV_POSITION;
                     float4 color        : COLOR;
                     float3 normal       : NORMAL;
                     float2 texCoord     : TEXCOORD0;
                     float3 worldPos     : TEXCOORD1;
+                    nointerpolation float4 diffuseColor   : MATERIAL0;
+                    nointerpolation float4 ambientColor   : MATERIAL1;
+                    nointerpolation float4 specularColor  : MATERIAL2;
+                    nointerpolation float4 emissiveColor  : MATERIAL3;
+                    nointerpolation float4 materialParams : MATERIAL4; // specularPower, opacity, hasTexture
                 };
 
-                float3 calculateLight(Light light, float3 pixel_world_pos, float3 normal, float3 view_dir, float shadow_factor)
+                // Cascades are ordered sharpest first, so the first tile that holds the pixel wins.
+                // The margin keeps the comparison filter from reading the neighbouring tile.
+                float sampleShadow(float3 world_pos)
+                {
+                    for (uint c = 0; c < shadow_cascade_count; c++)
+                    {
+                        float4 light_clip_pos = mul(float4(world_pos, 1.0f), shadow_view_projection[c]);
+                        float3 light_ndc = light_clip_pos.xyz / light_clip_pos.w;
+                        float2 tile_coord = float2(0.5f * light_ndc.x + 0.5f, 0.5f - 0.5f * light_ndc.y);
+                        float margin = shadow_texel_size / shadow_atlas_rects[c].x;
+
+                        if (all(tile_coord >= margin) && all(tile_coord <= 1.0f - margin) && light_ndc.z <= 1.0f)
+                        {
+                            float2 shadow_tex_coord = tile_coord * shadow_atlas_rects[c].xy + shadow_atlas_rects[c].zw;
+                            return shadowMap.SampleCmpLevelZero(shadowSampler, shadow_tex_coord, light_ndc.z - 0.0005f);
+                        }
+                    }
+                    return 1.0f;
+                }
+
+                // Froxel holding the pixel: screen tile from its position, depth slice from log(view depth)
+                uint getClusterIndex(float2 screen_pos, float3 world_pos)
+                {
+                    float view_z = max(dot(float4(world_pos, 1.0f), cluster_view_z), 1e-4f);
+                    uint2 tile = min(uint2(screen_pos * cluster_scale.xy), uint2(cluster_tiles_x, cluster_tiles_y) - 1);
+                    uint slice = (uint)clamp(floor(log(view_z) * cluster_scale.z + cluster_scale.w), 0.0f, cluster_depth_slices - 1.0f);
+                    return (slice * cluster_tiles_y + tile.y) * cluster_tiles_x + tile.x;
+                }
+
+                float3 calculateLight(Light light, float3 pixel_world_pos, float3 normal, float3 view_dir, float shadow_factor,
+                    float4 diffuseColor, float4 specularColor, float specularPower)
                 {
                     float3 light_dir;
                     float attenuation = 1.0f;
@@ -154,48 +214,39 @@ namespace dx3d
 
                 float4 main(PS_INPUT input) : SV_TARGET 
                 {
-                    // --- Shadow Calculation (same as before) ---
-                    float4 light_clip_pos = mul(float4(input.worldPos, 1.0f), light_view);
-                    light_clip_pos = mul(light_clip_pos, light_projection);
-                    float2 shadow_tex_coord = 0.5f * light_clip_pos.xy / light_clip_pos.w + 0.5f;
-                    shadow_tex_coord.y = 1.0f - shadow_tex_coord.y;
-                    float depth_from_light = light_clip_pos.z / light_clip_pos.w;
-                    float shadow_value = shadowMap.SampleCmp(shadowSampler, shadow_tex_coord, depth_from_light - 0.0005f);
+                    float shadow_value = sampleShadow(input.worldPos);
 
                     float3 normal = normalize(input.normal);
                     float3 view_dir = normalize(camera_position.xyz - input.worldPos);
             
-                    float4 finalColor = ambientColor * ambient_color;
+                    float4 finalColor = input.ambientColor * ambient_color;
 
-                    for (uint i = 0; i < num_lights; i++)
+                    for (uint i = 0; i < num_directional_lights; i++)
                     {
                         float shadow_factor_for_this_light = (i == shadow_casting_light_index) ? shadow_value : 1.0f;
-                        finalColor.rgb += calculateLight(lights[i], input.worldPos, normal, view_dir, shadow_factor_for_this_light);
+                        finalColor.rgb += calculateLight(lightBuffer[i], input.worldPos, normal, view_dir, shadow_factor_for_this_light,
+                            input.diffuseColor, input.specularColor, input.materialParams.x);
+                    }
+
+                    uint2 cluster = clusterRanges[getClusterIndex(input.position.xy, input.worldPos)];
+                    for (uint j = 0; j < cluster.y; j++)
+                    {
+                        uint light_index = clusterLightIndices[cluster.x + j];
+                        float shadow_factor_for_this_light = (light_index == shadow_casting_light_index) ? shadow_value : 1.0f;
+                        finalColor.rgb += calculateLight(lightBuffer[light_index], input.worldPos, normal, view_dir, shadow_factor_for_this_light,
+                            input.diffuseColor, input.specularColor, input.materialParams.x);
                     }
 
-                    finalColor.rgb += emissiveColor.rgb;
+                    finalColor.rgb += input.emissiveColor.rgb;
 
-                    if (hasTexture > 0.5f) {
+                    if (input.materialParams.z > 0.5f) {
                         finalColor.rgb *= diffuseTexture.Sample(textureSampler, input.texCoord).rgb;
                     }
 
-                    finalColor.a = diffuseColor.a * opacity;
+                    finalColor.a = input.diffuseColor.a * input.materialParams.y;
                     return finalColor;
                 }
             )";
         }
     };
-
-    // Material constant buffer structure for models
-    struct ModelMaterialConstants
-    {
-        Vector4 diffuseColor;
-        Vector4 ambientColor;
-        Vector4 specularColor;
-        Vector4 emissiveColor;
-        float specularPower;
-        float opacity;
-        float hasTexture;
-        float padding;
-    };
 }
\ No newline at end of file
@@ -5,5 +5,7 @@ namespace dx3d {
     class VertexShader;
     struct GraphicsResourceDesc;
 
+    // Both read the vertex in slot 0 and a ModelInstanceData stream in slot 1
     std::shared_ptr<VertexShader> createModelVertexShader(const GraphicsResourceDesc& desc);
+    std::shared_ptr<VertexShader> createDepthVertexShader(const GraphicsResourceDesc& desc);
 }
\ No newline at end of file
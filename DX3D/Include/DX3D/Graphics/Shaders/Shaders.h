@@ -27,6 +27,9 @@ namespace dx3d
     {
     public:
         VertexShader(const GraphicsResourceDesc& desc, const char* shaderCode);
+        // Custom input layout, e.g. one with a per-instance stream
+        VertexShader(const GraphicsResourceDesc& desc, const char* shaderCode,
+            const D3D11_INPUT_ELEMENT_DESC* layout, ui32 layoutElementCount);
         ~VertexShader();
 
         virtual ID3D11VertexShader* getShader() const;
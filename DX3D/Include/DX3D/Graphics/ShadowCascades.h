@@ -0,0 +1,75 @@
+#pragma once
+#include <DX3D/Core/Core.h>
+#include <DX3D/Math/Math.h>
+#include <DX3D/Math/Bounds.h>
+#include <DX3D/Math/Frustum.h>
+#include <vector>
+
+namespace dx3d
+{
+    constexpr ui32 MAX_SHADOW_CASCADES = 4;
+
+    // One slice of a light's shadow, rendered into its own tile of the shadow map. The cascades
+    // of a directional light share the view's rotation, so they all snap to the same texel grid.
+    struct ShadowCascade
+    {
+        Matrix4x4 view;
+        Matrix4x4 projection;
+        Vector4 atlasRect;      // uv scale (xy) and offset (zw) of the cascade's tile in the shadow map
+        float farPlane = 0.0f;  // light view depth of the far plane; the near plane is at 0
+        float splitNear = 0.0f; // camera view depths the cascade was fitted to
+        float splitFar = 0.0f;
+
+        Matrix4x4 getViewProjection() const { return view * projection; }
+    };
+
+    struct ShadowCascadeSettings
+    {
+        ui32 cascadeCount = 4;
+        float splitLambda = 0.75f;          // 0 = uniform splits, 1 = logarithmic
+        float maxShadowDistance = 60.0f;    // cascades stop here even when the camera sees further
+    };
+
+    // cascadeCount + 1 view depths from nearPlane to farPlane, blending logarithmic and uniform
+    // splits ("practical split scheme")
+    void computeCascadeSplits(float nearPlane, float farPlane, ui32 cascadeCount, float lambda, float* splits);
+
+    // Tile of the shadow map a cascade renders to: a single cascade uses the whole map,
+    // more share a 2x2 grid
+    Vector4 getCascadeAtlasRect(ui32 cascade, ui32 cascadeCount);
+
+    // World-space corners of the part of a camera frustum between view depths splitNear and
+    // splitFar; the camera's clip depth must run from nearPlane (0) to farPlane (1).
+    // Corners 0-3 lie on the near slice, 4-7 on the far one.
+    void getFrustumSliceCorners(const Matrix4x4& cameraViewProjection, float nearPlane, float farPlane,
+        float splitNear, float splitFar, Vector3 corners[8]);
+
+    // Rotation into the light's space, looking along lightDirection
+    Matrix4x4 createShadowLightView(const Vector3& lightDirection);
+
+    // Fits a cascade around the bounding sphere of the corners of one or more frustum slices.
+    // The sphere keeps the cascade's size fixed as the camera turns, and its centre is snapped
+    // to whole texels of a resolution-sized tile so the shadow edges do not shimmer as the camera
+    // moves. The near plane is pulled back to casterBounds, so casters between the light and the
+    // slice still land in the map.
+    ShadowCascade fitShadowCascade(const Vector3* corners, ui32 cornerCount, const Matrix4x4& lightView,
+        ui32 resolution, const AABB& casterBounds);
+
+    // Fits settings.cascadeCount (clamped to [1, MAX_SHADOW_CASCADES]) cascades to a camera and
+    // returns how many were written. mapResolution is the size of the whole shadow map.
+    ui32 fitShadowCascades(const Matrix4x4& cameraViewProjection, float nearPlane, float farPlane,
+        const Vector3& lightDirection, ui32 mapResolution, const AABB& casterBounds,
+        const ShadowCascadeSettings& settings, ShadowCascade* cascades);
+
+    // Same, for a map that a second camera samples too, such as the game view while the cascades
+    // follow the editor camera. The last cascade, which the shader falls back to for pixels outside
+    // the sharper ones, is widened over the second camera's range up to the shadow distance, so
+    // that view keeps its shadows at the last cascade's resolution.
+    ui32 fitShadowCascades(const Matrix4x4& cameraViewProjection, float nearPlane, float farPlane,
+        const Matrix4x4& coveredViewProjection, float coveredNearPlane, float coveredFarPlane,
+        const Vector3& lightDirection, ui32 mapResolution, const AABB& casterBounds,
+        const ShadowCascadeSettings& settings, ShadowCascade* cascades);
+
+    // Appends the casters whose bounds reach into the cascade's light-space box to `visible`
+    void cullShadowCasters(const ShadowCascade& cascade, const CullingBounds& bounds, std::vector<ui32>& visible);
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include <DX3D/Graphics/GraphicsResource.h>
+#include <DX3D/Math/Math.h>
 
 namespace dx3d
 {
@@ -13,6 +14,11 @@ namespace dx3d
 
         void clear(DeviceContext& deviceContext);
         void setAsRenderTarget(DeviceContext& deviceContext);
+        // Restricts drawing to one tile of the map; atlasRect is the tile's uv scale (xy) and offset (zw)
+        void setTileViewport(DeviceContext& deviceContext, const Vector4& atlasRect);
+
+        ui32 getWidth() const { return m_width; }
+        ui32 getHeight() const { return m_height; }
 
         ID3D11DepthStencilView* getDepthView() const { return m_depthStencilView.Get(); }
         ID3D11ShaderResourceView* getShaderResourceView() const { return m_shaderResourceView.Get(); }
@@ -0,0 +1,31 @@
+#pragma once
+#include <DX3D/Graphics/GraphicsResource.h>
+
+namespace dx3d
+{
+    class DeviceContext;
+
+    // Dynamic StructuredBuffer<T> read by shaders through an SRV. Every update discards and
+    // rewrites the whole contents, growing by half again when the elements no longer fit.
+    class StructuredBuffer final : public GraphicsResource
+    {
+    public:
+        StructuredBuffer(ui32 elementSize, ui32 elementCapacity, const GraphicsResourceDesc& gDesc);
+
+        // An empty update keeps the buffer bound-able; shaders just see no valid elements
+        void update(DeviceContext& deviceContext, const void* data, ui32 elementCount);
+
+        ui32 getElementSize() const noexcept { return m_elementSize; }
+        ui32 getCapacity() const noexcept { return m_capacity; }
+        ID3D11ShaderResourceView* getShaderResourceView() const noexcept { return m_shaderResourceView.Get(); }
+
+    private:
+        void createBuffer();
+
+    private:
+        Microsoft::WRL::ComPtr<ID3D11Buffer> m_buffer{};
+        Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> m_shaderResourceView{};
+        ui32 m_elementSize = 0;
+        ui32 m_capacity = 0;
+    };
+}
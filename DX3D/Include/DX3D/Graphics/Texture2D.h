@@ -4,22 +4,38 @@
 
 namespace dx3d
 {
+    struct DecodedImage;
+    struct TextureMip;
+
     class Texture2D final : public GraphicsResource
     {
     public:
+        // Loads the file's cooked mip chain, cooking it first if needed, and uploads it on the
+        // calling thread; a 1x1 white texture if it is missing or cannot be decoded
         Texture2D(const std::string& filePath, const GraphicsResourceDesc& desc);
+
+        // Uploads pixels decoded elsewhere, or a 1x1 white placeholder if there are none yet
+        Texture2D(const std::string& filePath, const DecodedImage* image, const GraphicsResourceDesc& desc);
         ~Texture2D();
 
+        // Replaces the contents in place, so materials holding this texture pick up the new
+        // pixels without being told. Call from the thread that owns the device.
+        void upload(const DecodedImage& image);
+        void upload(const TextureMip* mips, ui32 mipCount);
+
         ID3D11ShaderResourceView* getShaderResourceView() const { return m_shaderResourceView.Get(); }
         ID3D11SamplerState* getSamplerState() const { return m_samplerState.Get(); }
 
         ui32 getWidth() const { return m_width; }
         ui32 getHeight() const { return m_height; }
+        ui32 getMipCount() const { return m_mipCount; }
+        bool isPlaceholder() const { return m_isPlaceholder; }
 
         const std::string& getFilePath() const { return m_filePath; }
 
     private:
         void loadFromFile(const std::string& filePath);
+        void createPlaceholder();
         void createSamplerState();
 
     private:
@@ -30,5 +46,7 @@ namespace dx3d
         std::string m_filePath;
         ui32 m_width;
         ui32 m_height;
+        ui32 m_mipCount = 0;
+        bool m_isPlaceholder = false;
     };
 }
\ No newline at end of file
@@ -0,0 +1,130 @@
+#pragma once
+#include <DX3D/Core/Core.h>
+#include <DX3D/Math/Bounds.h>
+#include <DX3D/Math/Ray.h>
+#include <vector>
+
+namespace dx3d
+{
+    // Binary AABB tree over items identified by their index in the bounds array passed to build().
+    // Built top-down with a binned SAH. Moved items can be refit in place, which keeps the topology
+    // and only redoes the boxes above them; the tree gets looser as items drift, so callers should
+    // rebuild once refits pile up (see getRefitCount()).
+    class BoundingVolumeHierarchy
+    {
+    public:
+        static constexpr ui32 MAX_LEAF_ITEMS = 4;
+        static constexpr ui32 MAX_DEPTH = 64;
+
+        void build(const std::vector<AABB>& itemBounds);
+        void clear();
+
+        // Replace one item's box and update the boxes above it
+        void refit(ui32 item, const AABB& bounds);
+
+        bool isEmpty() const { return m_nodes.empty(); }
+        ui32 getItemCount() const { return static_cast<ui32>(m_itemBounds.size()); }
+        ui32 getNodeCount() const { return static_cast<ui32>(m_nodes.size()); }
+        ui32 getRefitCount() const { return m_refitCount; }
+        const AABB& getItemBounds(ui32 item) const { return m_itemBounds[item]; }
+
+        // Walks the nodes the ray enters, nearest child first. hitItem(item, maxT) is called for every
+        // item whose box the ray enters before maxT; it returns true and lowers maxT when the item
+        // itself is hit closer. Returns whether any item was hit.
+        template<typename HitItem>
+        bool raycast(const Ray& ray, float& maxT, HitItem&& hitItem) const;
+
+    private:
+        struct Node
+        {
+            AABB bounds;
+            ui32 firstChildOrItem = 0; // first child for inner nodes (second is +1), first item for leaves
+            ui32 itemCount = 0;        // 0 for inner nodes
+            ui32 parent = INVALID_NODE;
+        };
+
+        static constexpr ui32 INVALID_NODE = 0xFFFFFFFFu;
+
+        void subdivide(ui32 nodeIndex, const std::vector<Vector3>& centroids, ui32 depth);
+        AABB computeLeafBounds(const Node& node) const;
+
+    private:
+        std::vector<Node> m_nodes;
+        std::vector<ui32> m_items;        // item indices, grouped by leaf
+        std::vector<ui32> m_itemLeaf;     // item -> leaf node
+        std::vector<AABB> m_itemBounds;
+        ui32 m_refitCount = 0;
+    };
+
+    template<typename HitItem>
+    bool BoundingVolumeHierarchy::raycast(const Ray& ray, float& maxT, HitItem&& hitItem) const
+    {
+        if (m_nodes.empty())
+            return false;
+
+        Vector3 inverseDirection = getInverseDirection(ray);
+        float entry = 0.0f;
+        if (!intersectRayAABB(ray, inverseDirection, m_nodes[0].bounds, maxT, entry))
+            return false;
+
+        // A depth-first walk never holds more than one pending sibling per level
+        struct StackEntry { ui32 node; float entry; };
+        StackEntry stack[MAX_DEPTH + 1];
+        ui32 stackSize = 0;
+        stack[stackSize++] = { 0, entry };
+
+        bool hit = false;
+        while (stackSize > 0)
+        {
+            StackEntry current = stack[--stackSize];
+            if (current.entry > maxT)
+                continue;
+
+            const Node& node = m_nodes[current.node];
+            if (node.itemCount > 0)
+            {
+                for (ui32 i = 0; i < node.itemCount; ++i)
+                {
+                    ui32 item = m_items[node.firstChildOrItem + i];
+                    float itemEntry = 0.0f;
+                    if (intersectRayAABB(ray, inverseDirection, m_itemBounds[item], maxT, itemEntry) && hitItem(item, maxT))
+                    {
+                        hit = true;
+                    }
+                }
+                continue;
+            }
+
+            ui32 first = node.firstChildOrItem;
+            float entryA = 0.0f;
+            float entryB = 0.0f;
+            bool hitA = intersectRayAABB(ray, inverseDirection, m_nodes[first].bounds, maxT, entryA);
+            bool hitB = intersectRayAABB(ray, inverseDirection, m_nodes[first + 1].bounds, maxT, entryB);
+
+            // Push the farther child first so the nearer one is visited first and shrinks maxT
+            if (hitA && hitB)
+            {
+                if (entryA < entryB)
+                {
+                    stack[stackSize++] = { first + 1, entryB };
+                    stack[stackSize++] = { first, entryA };
+                }
+                else
+                {
+                    stack[stackSize++] = { first, entryA };
+                    stack[stackSize++] = { first + 1, entryB };
+                }
+            }
+            else if (hitA)
+            {
+                stack[stackSize++] = { first, entryA };
+            }
+            else if (hitB)
+            {
+                stack[stackSize++] = { first + 1, entryB };
+            }
+        }
+
+        return hit;
+    }
+}
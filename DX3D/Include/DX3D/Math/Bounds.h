@@ -0,0 +1,74 @@
+#pragma once
+#include <DX3D/Math/Math.h>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace dx3d
+{
+    struct AABB
+    {
+        Vector3 min;
+        Vector3 max;
+
+        // Default-constructed boxes are empty, so expand() can start from them
+        AABB() : min(FLT_MAX, FLT_MAX, FLT_MAX), max(-FLT_MAX, -FLT_MAX, -FLT_MAX) {}
+        AABB(const Vector3& min, const Vector3& max) : min(min), max(max) {}
+
+        bool isValid() const { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+
+        Vector3 getCenter() const { return Vector3((min.x + max.x) * 0.5f, (min.y + max.y) * 0.5f, (min.z + max.z) * 0.5f); }
+        Vector3 getExtents() const { return Vector3((max.x - min.x) * 0.5f, (max.y - min.y) * 0.5f, (max.z - min.z) * 0.5f); }
+
+        void expand(const Vector3& point)
+        {
+            min = Vector3(std::min(min.x, point.x), std::min(min.y, point.y), std::min(min.z, point.z));
+            max = Vector3(std::max(max.x, point.x), std::max(max.y, point.y), std::max(max.z, point.z));
+        }
+
+        void expand(const AABB& other)
+        {
+            if (!other.isValid())
+                return;
+            expand(other.min);
+            expand(other.max);
+        }
+
+        // Box enclosing this one after transformation by a row-vector matrix (v * M)
+        AABB transformed(const Matrix4x4& matrix) const
+        {
+            if (!isValid())
+                return *this;
+
+            Vector3 center = getCenter();
+            Vector3 extents = getExtents();
+
+            Vector3 newCenter(
+                center.x * matrix.m[0][0] + center.y * matrix.m[1][0] + center.z * matrix.m[2][0] + matrix.m[3][0],
+                center.x * matrix.m[0][1] + center.y * matrix.m[1][1] + center.z * matrix.m[2][1] + matrix.m[3][1],
+                center.x * matrix.m[0][2] + center.y * matrix.m[1][2] + center.z * matrix.m[2][2] + matrix.m[3][2]);
+
+            Vector3 newExtents(
+                extents.x * std::fabs(matrix.m[0][0]) + extents.y * std::fabs(matrix.m[1][0]) + extents.z * std::fabs(matrix.m[2][0]),
+                extents.x * std::fabs(matrix.m[0][1]) + extents.y * std::fabs(matrix.m[1][1]) + extents.z * std::fabs(matrix.m[2][1]),
+                extents.x * std::fabs(matrix.m[0][2]) + extents.y * std::fabs(matrix.m[1][2]) + extents.z * std::fabs(matrix.m[2][2]));
+
+            return AABB(newCenter - newExtents, newCenter + newExtents);
+        }
+    };
+
+    struct BoundingSphere
+    {
+        Vector3 center;
+        float radius = 0.0f;
+
+        BoundingSphere() = default;
+        BoundingSphere(const Vector3& center, float radius) : center(center), radius(radius) {}
+
+        static BoundingSphere fromAABB(const AABB& box)
+        {
+            Vector3 extents = box.getExtents();
+            return BoundingSphere(box.getCenter(), std::sqrt(Vector3::Dot(extents, extents)));
+        }
+    };
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <DX3D/Math/Math.h>
+#include <DX3D/Math/Bounds.h>
+#include <vector>
+
+namespace dx3d
+{
+    // Six normalized planes (a, b, c, d) with normals pointing inwards: a point p is
+    // inside a plane when a*p.x + b*p.y + c*p.z + d >= 0.
+    struct Frustum
+    {
+        enum PlaneIndex
+        {
+            Left = 0,
+            Right,
+            Bottom,
+            Top,
+            Near,
+            Far,
+            PlaneCount
+        };
+
+        Vector4 planes[PlaneCount];
+
+        // Extracts the planes of a D3D-style (0 <= z <= w) view * projection matrix, e.g.
+        // camera.getViewMatrix() * projection or the light's view * projection
+        static Frustum fromViewProjection(const Matrix4x4& viewProjection);
+
+        bool intersects(const AABB& box) const;
+        bool intersects(const BoundingSphere& sphere) const;
+    };
+
+    // World-space bounds in structure-of-arrays form so the culling loops can test
+    // four volumes per instruction. Boxes are stored as centre + half extents; the
+    // radius is the enclosing sphere's. Empty boxes are stored as a point outside every
+    // frustum, so they keep their index but are always culled.
+    struct CullingBounds
+    {
+        std::vector<float> centerX, centerY, centerZ;
+        std::vector<float> extentX, extentY, extentZ;
+        std::vector<float> radius;
+
+        void clear();
+        void reserve(ui32 count);
+        ui32 size() const { return static_cast<ui32>(centerX.size()); }
+
+        void add(const AABB& box);
+        void add(const BoundingSphere& sphere);
+    };
+
+    // Append the indices of the bounds that intersect the frustum to `visible`, in order
+    void cullBoxes(const Frustum& frustum, const CullingBounds& bounds, std::vector<ui32>& visible);
+    void cullSpheres(const Frustum& frustum, const CullingBounds& bounds, std::vector<ui32>& visible);
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <DX3D/Math/Math.h>
+#include <DX3D/Math/Bounds.h>
+#include <cmath>
+#include <limits>
+
+namespace dx3d
+{
+    struct Ray
+    {
+        Vector3 origin;
+        Vector3 direction;
+
+        Ray() = default;
+        Ray(const Vector3& origin, const Vector3& direction) : origin(origin), direction(direction) {}
+
+        Vector3 getPoint(float t) const { return origin + direction * t; }
+
+        // Ray in the space of a row-vector matrix (v * M). The direction is not renormalized,
+        // so a hit distance t means the same point before and after the transform.
+        Ray transformed(const Matrix4x4& matrix) const
+        {
+            const auto& m = matrix.m;
+            return Ray(
+                Vector3(
+                    origin.x * m[0][0] + origin.y * m[1][0] + origin.z * m[2][0] + m[3][0],
+                    origin.x * m[0][1] + origin.y * m[1][1] + origin.z * m[2][1] + m[3][1],
+                    origin.x * m[0][2] + origin.y * m[1][2] + origin.z * m[2][2] + m[3][2]),
+                Vector3(
+                    direction.x * m[0][0] + direction.y * m[1][0] + direction.z * m[2][0],
+                    direction.x * m[0][1] + direction.y * m[1][1] + direction.z * m[2][1],
+                    direction.x * m[0][2] + direction.y * m[1][2] + direction.z * m[2][2]));
+        }
+    };
+
+    // 1 / direction per axis; zero components become +-inf so the slab test needs no special case
+    inline Vector3 getInverseDirection(const Ray& ray)
+    {
+        return Vector3(1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z);
+    }
+
+    // Slab test against [0, maxT]; tNear is the entry distance (0 when the origin is inside)
+    inline bool intersectRayAABB(const Ray& ray, const Vector3& inverseDirection, const AABB& box, float maxT, float& tNear)
+    {
+        float tx1 = (box.min.x - ray.origin.x) * inverseDirection.x;
+        float tx2 = (box.max.x - ray.origin.x) * inverseDirection.x;
+        float tmin = std::fmin(tx1, tx2);
+        float tmax = std::fmax(tx1, tx2);
+
+        float ty1 = (box.min.y - ray.origin.y) * inverseDirection.y;
+        float ty2 = (box.max.y - ray.origin.y) * inverseDirection.y;
+        tmin = std::fmax(tmin, std::fmin(ty1, ty2));
+        tmax = std::fmin(tmax, std::fmax(ty1, ty2));
+
+        float tz1 = (box.min.z - ray.origin.z) * inverseDirection.z;
+        float tz2 = (box.max.z - ray.origin.z) * inverseDirection.z;
+        tmin = std::fmax(tmin, std::fmin(tz1, tz2));
+        tmax = std::fmin(tmax, std::fmax(tz1, tz2));
+
+        tmin = std::fmax(tmin, 0.0f);
+        if (tmin > tmax || tmin > maxT)
+            return false;
+
+        tNear = tmin;
+        return true;
+    }
+
+    inline bool intersectRayAABB(const Ray& ray, const AABB& box, float& tNear)
+    {
+        return intersectRayAABB(ray, getInverseDirection(ray), box, std::numeric_limits<float>::max(), tNear);
+    }
+
+    // Möller-Trumbore, double-sided; hits closer than 0 are rejected
+    inline bool intersectRayTriangle(const Ray& ray, const Vector3& v0, const Vector3& v1, const Vector3& v2, float& t)
+    {
+        Vector3 edge1 = v1 - v0;
+        Vector3 edge2 = v2 - v0;
+        Vector3 p = Vector3::Cross(ray.direction, edge2);
+        float determinant = Vector3::Dot(edge1, p);
+        if (std::fabs(determinant) < 1e-12f)
+            return false;
+
+        float inverseDeterminant = 1.0f / determinant;
+        Vector3 s = ray.origin - v0;
+        float u = Vector3::Dot(s, p) * inverseDeterminant;
+        if (u < 0.0f || u > 1.0f)
+            return false;
+
+        Vector3 q = Vector3::Cross(s, edge1);
+        float v = Vector3::Dot(ray.direction, q) * inverseDeterminant;
+        if (v < 0.0f || u + v > 1.0f)
+            return false;
+
+        float hit = Vector3::Dot(edge2, q) * inverseDeterminant;
+        if (hit < 0.0f)
+            return false;
+
+        t = hit;
+        return true;
+    }
+}
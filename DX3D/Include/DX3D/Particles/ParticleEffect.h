@@ -0,0 +1,26 @@
+#pragma once
+#include <DX3D/Core/Core.h>
+#include <DX3D/Math/Math.h>
+#include <DX3D/Particles/ParticlePool.h>
+#include <DX3D/Particles/ParticleRandom.h>
+
+namespace dx3d
+{
+    // Per-effect particle behaviour expressed as batch kernels over a ParticlePool.
+    // The base class is plain ballistic motion; effects override the kernels.
+    // One effect may be shared by several emitters and its kernels run on worker threads
+    // for disjoint ranges, so effects must not keep mutable state of their own.
+    class ParticleEffect
+    {
+    public:
+        virtual ~ParticleEffect() = default;
+
+        // Called once for freshly emitted particles [first, first + count), after the
+        // emitter has filled position, velocity, colour, size, age and lifetime.
+        // All randomness must come from `random` to keep emission reproducible.
+        virtual void initialize(ParticlePool& pool, ui32 first, ui32 count, ParticleRandom& random);
+
+        // Integrates live particles [begin, end); ageing and expiry are handled by the emitter
+        virtual void update(ParticlePool& pool, ui32 begin, ui32 end, const Vector3& acceleration, float deltaTime);
+    };
+}
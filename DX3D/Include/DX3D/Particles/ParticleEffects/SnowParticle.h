@@ -1,24 +1,26 @@
 #pragma once
-#include <DX3D/Particles/Particle.h>
+#include <DX3D/Particles/ParticleEffect.h>
+#include <memory>
 
 namespace dx3d
 {
-    class SnowParticle : public Particle
+    class SnowParticleEffect : public ParticleEffect
     {
     public:
-        SnowParticle();
-        virtual ~SnowParticle() = default;
+        // ParticlePool::effectData channels used by snow
+        enum Channel : ui32
+        {
+            SwayAmount = 0,
+            SwaySpeed,
+            SwayPhase,
+            FallSpeedMultiplier
+        };
 
-        virtual void initialize(const Vector3& position, const Vector3& velocity) override;
+        virtual ~SnowParticleEffect() = default;
 
-        virtual bool update(float deltaTime) override;
-
-    private:
-        float m_swayAmount;      
-        float m_swaySpeed;       
-        float m_swayPhase;       
-        float m_fallSpeedMultiplier; 
+        virtual void initialize(ParticlePool& pool, ui32 first, ui32 count, ParticleRandom& random) override;
+        virtual void update(ParticlePool& pool, ui32 begin, ui32 end, const Vector3& acceleration, float deltaTime) override;
     };
 
-    std::unique_ptr<Particle> createSnowParticle();
-}
\ No newline at end of file
+    std::shared_ptr<ParticleEffect> createSnowParticleEffect();
+}
@@ -1,16 +1,15 @@
 #pragma once
 #include <DX3D/Core/Core.h>
 #include <DX3D/Math/Math.h>
-#include <DX3D/Particles/Particle.h>
+#include <DX3D/Particles/ParticlePool.h>
+#include <DX3D/Particles/ParticleEffect.h>
+#include <DX3D/Particles/ParticleRandom.h>
 #include <memory>
+#include <span>
 #include <vector>
-#include <functional>
 
 namespace dx3d
 {
-    // Forward declaration to resolve compiler errors
-    class SceneCamera;
-
     // Structure to hold per-instance data for rendering
     struct ParticleInstanceData
     {
@@ -43,42 +42,56 @@ namespace dx3d
             bool loop = true;           // Continuous emission
         };
 
-        using ParticleFactory = std::function<std::unique_ptr<Particle>()>;
+        // Large emitters are updated and spawned in chunks of this many particles, which may
+        // run on different threads. Kept a multiple of the widest SIMD kernel.
+        static constexpr ui32 CHUNK_SIZE = 8192;
 
-        ParticleEmitter(const EmitterConfig& config, ParticleFactory factory);
+        // A null effect falls back to plain ballistic motion. Emitters with the same seed and
+        // inputs produce identical particles regardless of how many worker threads are used.
+        ParticleEmitter(const EmitterConfig& config, std::shared_ptr<ParticleEffect> effect, ui32 seed = 0);
         ~ParticleEmitter();
 
         // Update all particles and spawn new ones
         void update(float deltaTime);
 
-        // Get instance data for rendering
-        void fillInstanceData(std::vector<ParticleInstanceData>& instanceData, const SceneCamera& camera);
+        // Writes one instance per live particle to the front of `destination` (typically mapped
+        // GPU memory) and returns how many were written; at most getActiveParticleCount()
+        ui32 writeInstanceData(std::span<ParticleInstanceData> destination) const;
 
         // Control methods
         void start() { m_active = true; }
         void stop() { m_active = false; }
         void reset();
 
+        // Spawns up to `count` particles at once (clamped to the free slots); returns how many were spawned
+        ui32 emitBurst(ui32 count);
+
         // Setters
         void setPosition(const Vector3& position) { m_config.position = position; }
         void setEmissionRate(float rate) { m_config.emissionRate = rate; }
 
         // Getters
         const Vector3& getPosition() const { return m_config.position; }
-        ui32 getActiveParticleCount() const { return m_activeParticleCount; }
+        ui32 getActiveParticleCount() const { return m_pool.aliveCount; }
+        const ParticlePool& getPool() const { return m_pool; }
         bool isActive() const { return m_active; }
 
     private:
-        void spawnParticle();
-        Vector3 randomizeVector(const Vector3& base, const Vector3& variance);
-        float randomFloat(float min, float max);
+        void killExpiredParticles(float deltaTime);
+        void integrate(ui32 begin, ui32 end, float deltaTime);
+        ui32 spawnParticles(ui32 count);
+        void initializeParticles(ui32 begin, ui32 end, ParticleRandom& random);
+        static Vector3 randomizeVector(ParticleRandom& random, const Vector3& base, const Vector3& variance);
 
     private:
         EmitterConfig m_config;
-        ParticleFactory m_particleFactory;
-        std::vector<std::unique_ptr<Particle>> m_particles;
-        ui32 m_activeParticleCount;
+        std::shared_ptr<ParticleEffect> m_effect;
+        ParticlePool m_pool;
         float m_emissionAccumulator;
         bool m_active;
+
+        // Every spawn batch seeds its chunk generators from (seed, batch index, chunk index)
+        ui32 m_seed;
+        ui32 m_spawnBatch;
     };
 }
\ No newline at end of file
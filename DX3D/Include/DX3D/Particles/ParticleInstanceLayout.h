@@ -0,0 +1,32 @@
+#pragma once
+#include <DX3D/Core/Core.h>
+#include <DX3D/Particles/ParticleEmitter.h>
+#include <span>
+#include <vector>
+
+namespace dx3d
+{
+    // Where each emitter's particles go in one frame's instance buffer: emitter i writes from
+    // getOffset(i) up to getOffset(i + 1), the prefix sum of the active counts before it. Built once
+    // per frame, between updating the emitters and writing, so the buffer is sized and filled
+    // from the same counts.
+    class ParticleInstanceLayout
+    {
+    public:
+        void clear();
+        void add(const ParticleEmitter& emitter);
+
+        ui32 getEmitterCount() const { return static_cast<ui32>(m_emitters.size()); }
+        ui32 getOffset(ui32 emitterIndex) const { return m_offsets[emitterIndex]; }
+        ui32 getInstanceCount() const { return m_offsets.back(); }
+
+        // Writes every emitter's instances at its offset, emitters in parallel on the JobSystem,
+        // and returns how many were written: the instance count, cut off at destination.size().
+        // destination is typically mapped GPU memory, but any CPU memory works.
+        ui32 write(std::span<ParticleInstanceData> destination) const;
+
+    private:
+        std::vector<const ParticleEmitter*> m_emitters;
+        std::vector<ui32> m_offsets{ 0 };
+    };
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <DX3D/Core/Core.h>
+#include <DX3D/Math/Math.h>
+#include <DX3D/Particles/ParticlePool.h>
+
+namespace dx3d
+{
+    enum class ParticleSimdLevel
+    {
+        Scalar,
+        SSE2,   // 4 particles per instruction
+        AVX2    // 8 particles per instruction
+    };
+
+    // Batch kernels over the particle range [begin, end) of a pool.
+    // Every level runs the same arithmetic in the same order (including the polynomial
+    // sin/cos used for sway), so all levels produce bit-identical results. That relies on the
+    // compiler not contracting multiply-adds into FMA, which MSVC only does under /fp:contract.
+    struct ParticleKernelTable
+    {
+        ParticleSimdLevel level;
+
+        // vel += acc * dt, pos += vel * dt, rotation += rotationSpeed * dt (wrapped to [0, 2π])
+        void (*integrateBallistic)(ParticlePool& pool, ui32 begin, ui32 end, const Vector3& acceleration, float deltaTime);
+
+        // Snow sway and scaled fall; expects the SnowParticleEffect channel layout in effectData
+        void (*integrateSnow)(ParticlePool& pool, ui32 begin, ui32 end, const Vector3& acceleration, float deltaTime);
+
+        // Colour and size lerp by age / lifetime
+        void (*applyLifetimeGradients)(ParticlePool& pool, ui32 begin, ui32 end,
+            const Vector4& startColor, const Vector4& endColor, float startSize, float endSize);
+    };
+
+    // Best level supported by the CPU, detected once via CPUID
+    ParticleSimdLevel getSupportedParticleSimdLevel();
+
+    // Kernels for the best supported level
+    const ParticleKernelTable& getParticleKernels();
+
+    // Kernels for a specific level, clamped to what the CPU supports
+    const ParticleKernelTable& getParticleKernels(ParticleSimdLevel level);
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <DX3D/Core/Core.h>
+#include <DX3D/Math/Math.h>
+#include <vector>
+
+namespace dx3d
+{
+    // Structure-of-arrays storage for one emitter's particles.
+    // Live particles always occupy [0, aliveCount); killing a particle moves the last
+    // live one into its slot, so kernels never have to skip dead entries.
+    struct ParticlePool
+    {
+        // Per-particle scratch channels an effect can interpret however it likes
+        // (e.g. SnowParticleEffect stores sway amount/speed/phase and fall multiplier)
+        static constexpr ui32 MAX_EFFECT_CHANNELS = 4;
+
+        std::vector<float> positionX, positionY, positionZ;
+        std::vector<float> velocityX, velocityY, velocityZ;
+        std::vector<float> colorR, colorG, colorB, colorA;
+        std::vector<float> size;
+        std::vector<float> rotation;
+        std::vector<float> rotationSpeed;
+        std::vector<float> age;
+        std::vector<float> lifetime;
+        std::vector<float> effectData[MAX_EFFECT_CHANNELS];
+
+        ui32 aliveCount = 0;
+
+        void allocate(ui32 capacity);
+        ui32 capacity() const { return static_cast<ui32>(age.size()); }
+
+        // Reserves `count` slots at the end of the alive range and returns the first one.
+        // The caller is expected to initialize every channel of the returned slots.
+        ui32 emplace(ui32 count);
+
+        // Swap-and-pop removal; invalidates the index of the previously last particle
+        void kill(ui32 index);
+        void clear() { aliveCount = 0; }
+
+        Vector3 getPosition(ui32 index) const { return Vector3(positionX[index], positionY[index], positionZ[index]); }
+        Vector4 getColor(ui32 index) const { return Vector4(colorR[index], colorG[index], colorB[index], colorA[index]); }
+    };
+}
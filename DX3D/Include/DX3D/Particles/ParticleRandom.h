@@ -0,0 +1,48 @@
+#pragma once
+#include <DX3D/Core/Core.h>
+#include <cstdint>
+
+namespace dx3d
+{
+    // PCG32 generator used for particle spawning. Unlike std::mt19937 plus a standard
+    // distribution it produces the same floats on every compiler, and it is small enough
+    // to give every spawn chunk its own instance (seed + stream), which keeps emission
+    // deterministic no matter how many threads process the chunks.
+    class ParticleRandom
+    {
+    public:
+        explicit ParticleRandom(std::uint64_t seed = 0, std::uint64_t stream = 0)
+            : m_state(0)
+            , m_increment((stream << 1u) | 1u)
+        {
+            nextUInt();
+            m_state += seed;
+            nextUInt();
+        }
+
+        ui32 nextUInt()
+        {
+            std::uint64_t oldState = m_state;
+            m_state = oldState * 6364136223846793005ULL + m_increment;
+            ui32 xorShifted = static_cast<ui32>(((oldState >> 18u) ^ oldState) >> 27u);
+            ui32 rotation = static_cast<ui32>(oldState >> 59u);
+            return (xorShifted >> rotation) | (xorShifted << ((32u - rotation) & 31u));
+        }
+
+        // Uniform in [0, 1)
+        float nextFloat()
+        {
+            return static_cast<float>(nextUInt() >> 8) * (1.0f / 16777216.0f);
+        }
+
+        // Uniform in [min, max)
+        float range(float min, float max)
+        {
+            return min + (max - min) * nextFloat();
+        }
+
+    private:
+        std::uint64_t m_state;
+        std::uint64_t m_increment;
+    };
+}
@@ -1,15 +1,12 @@
 #pragma once
 #include <DX3D/Core/Core.h>
 #include <DX3D/Particles/ParticleEmitter.h>
-#include <DX3D/Graphics/VertexBuffer.h>
-#include <DX3D/Graphics/IndexBuffer.h>
-#include <DX3D/Graphics/ConstantBuffer.h>
-#include <DX3D/Graphics/Shaders/Shaders.h>
+#include <DX3D/Particles/ParticleInstanceLayout.h>
 #include <memory>
+#include <span>
 #include <vector>
 #include <string>
 #include <unordered_map>
-#include <wrl.h>
 
 namespace dx3d
 {
@@ -28,20 +25,32 @@ namespace dx3d
 
         void initialize(GraphicsEngine& graphicsEngine);
         void shutdown();
-        // Update all emitters
+        // Update all emitters; independent emitters run in parallel on the JobSystem
         void update(float deltaTime);
         // Render all particles
         void render(DeviceContext& deviceContext, const SceneCamera& camera, const Matrix4x4& projectionMatrix);
 
+        // CPU half of render(), usable without a device. buildInstanceLayout() places the emitters'
+        // particles back to back, once per frame after update() (render() calls it); the count and
+        // the write both read that layout, so they agree even if the emitters change in between.
+        const ParticleInstanceLayout& buildInstanceLayout();
+        ui32 getInstanceCount() const { return m_instanceLayout.getInstanceCount(); }
+        ui32 writeInstanceData(std::span<ParticleInstanceData> destination) const { return m_instanceLayout.write(destination); }
+
         // Create and manage emitters
         std::shared_ptr<ParticleEmitter> createEmitter(
             const std::string& name,
             const ParticleEmitter::EmitterConfig& config,
-            ParticleEmitter::ParticleFactory factory
+            std::shared_ptr<ParticleEffect> effect = nullptr
         );
         void removeEmitter(const std::string& name);
         std::shared_ptr<ParticleEmitter> getEmitter(const std::string& name);
-        
+
+        // Emitters created afterwards derive their seed from this and their name,
+        // so a scene replays identically for a fixed seed
+        void setRandomSeed(ui32 seed) { m_randomSeed = seed; }
+        ui32 getRandomSeed() const { return m_randomSeed; }
+
 
         // Set blend mode for particles
         enum class BlendMode
@@ -53,33 +62,24 @@ namespace dx3d
         void setBlendMode(BlendMode mode) { m_blendMode = mode; }
 
     private:
-        ParticleSystem() = default;
-        ~ParticleSystem() = default;
+        // Device resources, defined with the D3D code in ParticleSystem.cpp
+        struct RenderResources;
+
+        ParticleSystem();
+        ~ParticleSystem();
         ParticleSystem(const ParticleSystem&) = delete;
         ParticleSystem& operator=(const ParticleSystem&) = delete;
 
         void createRenderingResources(GraphicsEngine& graphicsEngine);
-        void updateInstanceBuffer(DeviceContext& deviceContext, const std::vector<ParticleInstanceData>& instanceData);
+        void ensureInstanceCapacity(DeviceContext& deviceContext, ui32 instanceCount);
 
     private:
         std::unordered_map<std::string, std::shared_ptr<ParticleEmitter>> m_emitters;
+        std::vector<ParticleEmitter*> m_updateList;
+        ParticleInstanceLayout m_instanceLayout;
+        ui32 m_randomSeed = 0;
 
-        // Rendering resources
-        std::shared_ptr<VertexBuffer> m_quadVertexBuffer;
-        std::shared_ptr<IndexBuffer> m_quadIndexBuffer;
-        std::shared_ptr<PixelShader> m_pixelShader;
-        std::shared_ptr<ConstantBuffer> m_viewProjConstantBuffer;
-
-        // Raw shader pointers for particle rendering
-        Microsoft::WRL::ComPtr<ID3D11VertexShader> m_particleVertexShader;
-        Microsoft::WRL::ComPtr<ID3D11InputLayout> m_particleInputLayout;
-
-        // Instance buffer for instanced rendering
-        Microsoft::WRL::ComPtr<ID3D11Buffer> m_instanceBuffer;
-        ui32 m_instanceBufferCapacity;
-
-        // Texture for particles (future enhancement)
-        // std::shared_ptr<Texture2D> m_particleTexture;
+        std::unique_ptr<RenderResources> m_renderResources;
 
         BlendMode m_blendMode;
         bool m_initialized;
@@ -1,6 +1,7 @@
 #pragma once
 #include <DX3D/ECS/Entity.h>
 #include <DX3D/ECS/Components/PhysicsComponent.h>
+#include <DX3D/ECS/Components/TransformComponent.h>
 #include <reactphysics3d/reactphysics3d.h>
 #include <memory>
 
@@ -46,7 +47,7 @@ namespace dx3d
         PhysicsSystem& operator=(const PhysicsSystem&) = delete;
 
         void initializePhysicsBody(EntityID entity, PhysicsComponent& component);
-        void syncTransformFromPhysics(EntityID entity, const PhysicsComponent& component);
+        void syncTransformFromPhysics(const PhysicsComponent& component, TransformComponent& transformComp);
 
     private:
         rp3d::PhysicsCommon m_physicsCommon;
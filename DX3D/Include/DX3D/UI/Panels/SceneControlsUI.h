@@ -5,6 +5,7 @@ namespace dx3d
     class UIController;
     class SceneStateManager;
     class UndoRedoSystem;
+    struct FrameRenderStats;
 
     class SceneControlsUI
     {
@@ -12,7 +13,8 @@ namespace dx3d
         SceneControlsUI(
             UIController& controller,
             SceneStateManager& sceneStateManager,
-            UndoRedoSystem& undoRedoSystem
+            UndoRedoSystem& undoRedoSystem,
+            const FrameRenderStats& renderStats
         );
 
         void render();
@@ -21,5 +23,6 @@ namespace dx3d
         UIController& m_controller;
         SceneStateManager& m_sceneStateManager;
         UndoRedoSystem& m_undoRedoSystem;
+        const FrameRenderStats& m_renderStats;
     };
 }
\ No newline at end of file
@@ -19,6 +19,7 @@ namespace dx3d
     class InspectorUI;
     class DebugConsoleUI;
     class ViewportUI;
+    struct FrameRenderStats;
 
     class UIManager
     {
@@ -35,6 +36,7 @@ namespace dx3d
             std::function<std::vector<std::string>()> getSavedSceneFiles;
             std::function<void(const std::string&)> onLoadScene;
             std::vector<std::shared_ptr<LightObject>>& lights;
+            const FrameRenderStats& renderStats;
         };
 
         struct SpawnCallbacks
@@ -1,87 +1,176 @@
 #include <DX3D/Assets/AssetManager.h>
 #include <DX3D/Assets/ModelLoader.h>
-#include <thread>
-#include <atomic>
-#include <iostream>
+#include <DX3D/Assets/D3D11AssetUploader.h>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
 
 using namespace dx3d;
 
-std::shared_ptr<Model> AssetManager::loadModelSync(
-    const std::string& filePath,
-    const GraphicsResourceDesc& resourceDesc)
+namespace
 {
-    // Check cache first
+    std::shared_ptr<Model> createInstance(const std::shared_ptr<const ModelAsset>& asset)
     {
-        std::lock_guard<std::mutex> lock(m_cacheMutex);
-        auto it = m_modelCache.find(filePath);
-        if (it != m_modelCache.end())
+        auto model = std::make_shared<Model>();
+        model->setAsset(asset);
+        if (asset->filePath.empty())
         {
-            return it->second;
+            model->setName("DefaultCube");
         }
+        return model;
     }
+}
 
-    // Load model
-    auto model = ModelLoader::LoadModel(filePath, resourceDesc);
+void AssetManager::setAssetUploader(std::unique_ptr<AssetUploader> uploader, const AssetStreamerDesc& desc)
+{
+    std::lock_guard<std::mutex> lock(m_cacheMutex);
+    m_streamer.reset();
+    m_pendingLoads.clear();
+    m_uploader = std::move(uploader);
+    m_streamer = std::make_unique<AssetStreamer>(*m_uploader, desc);
+}
 
-    // Cache the model if loading was successful
-    if (model)
+std::shared_ptr<Model> AssetManager::loadModelSync(
+    const std::string& filePath,
+    const GraphicsResourceDesc& resourceDesc)
+{
+    auto asset = loadModelAsset(filePath, resourceDesc);
+    if (!asset)
     {
-        cacheModel(filePath, model);
+        asset = ModelLoader::GetDefaultModelAsset(resourceDesc);
     }
-
-    return model;
+    return createInstance(asset);
 }
 
 std::string AssetManager::loadModelAsync(
     const std::string& filePath,
-    const GraphicsResourceDesc& resourceDesc)
+    const GraphicsResourceDesc& resourceDesc,
+    float priority)
 {
-    // Check cache first
-    {
-        std::lock_guard<std::mutex> lock(m_cacheMutex);
-        auto it = m_modelCache.find(filePath);
-        if (it != m_modelCache.end())
-        {
-            // Return a completed task ID for cached model
-            std::string taskId = generateTaskId();
-            LoadingTask task;
-            task.progress = 100.0f;
-            task.isComplete = true;
-            task.hasError = false;
-            task.filePath = filePath;
-            // Create a completed future
-            std::promise<std::shared_ptr<Model>> promise;
-            promise.set_value(it->second);
-            task.future = promise.get_future();
-
-            {
-                std::lock_guard<std::mutex> taskLock(m_tasksMutex);
-                m_loadingTasks[taskId] = std::move(task);
-            }
-
-            return taskId;
-        }
-    }
+    return startLoad(filePath, &resourceDesc, priority);
+}
+
+std::string AssetManager::loadModelAsync(const std::string& filePath, float priority)
+{
+    return startLoad(filePath, nullptr, priority);
+}
 
+std::string AssetManager::startLoad(const std::string& filePath, const GraphicsResourceDesc* resourceDesc, float priority)
+{
     // Create task ID
     std::string taskId = generateTaskId();
 
-    // Create progress tracking
-    auto progressPtr = std::make_shared<std::atomic<float>>(0.0f);
-
-    // Start async loading
     LoadingTask task;
     task.filePath = filePath;
-    task.future = std::async(std::launch::async, loadModelWorker, filePath, resourceDesc, progressPtr);
+    task.priority = priority;
+
+    std::lock_guard<std::mutex> tasksLock(m_tasksMutex);
+    std::lock_guard<std::mutex> cacheLock(m_cacheMutex);
 
+    // Cached files complete straight away
+    auto cached = m_modelCache.find(filePath);
+    if (cached != m_modelCache.end())
     {
-        std::lock_guard<std::mutex> lock(m_tasksMutex);
+        task.model = createInstance(cached->second);
+        task.progress = 100.0f;
+        task.isComplete = true;
         m_loadingTasks[taskId] = std::move(task);
+        return taskId;
     }
 
+    addWaiter(filePath, resourceDesc, priority);
+    m_loadingTasks[taskId] = std::move(task);
+    applyTaskPriority(filePath);
     return taskId;
 }
 
+void AssetManager::setLoadingPriority(const std::string& taskId, float priority)
+{
+    std::lock_guard<std::mutex> tasksLock(m_tasksMutex);
+    auto it = m_loadingTasks.find(taskId);
+    if (it == m_loadingTasks.end() || it->second.isComplete)
+    {
+        return;
+    }
+
+    it->second.priority = priority;
+    std::lock_guard<std::mutex> cacheLock(m_cacheMutex);
+    applyTaskPriority(it->second.filePath);
+}
+
+void AssetManager::cancelLoading(const std::string& taskId)
+{
+    std::lock_guard<std::mutex> tasksLock(m_tasksMutex);
+    auto it = m_loadingTasks.find(taskId);
+    if (it == m_loadingTasks.end() || it->second.isComplete)
+    {
+        return;
+    }
+
+    LoadingTask& task = it->second;
+    task.hasError = true;
+    task.errorMessage = "Loading cancelled";
+    task.isComplete = true;
+
+    std::lock_guard<std::mutex> cacheLock(m_cacheMutex);
+    auto pending = m_pendingLoads.find(task.filePath);
+    if (pending == m_pendingLoads.end())
+    {
+        return;
+    }
+
+    if (--pending->second.waiterCount == 0)
+    {
+        m_streamer->cancel(pending->second.request);
+        retirePendingLoad(task.filePath);
+    }
+    else
+    {
+        applyTaskPriority(task.filePath);
+    }
+}
+
+std::shared_ptr<const ModelAsset> AssetManager::loadModelAsset(
+    const std::string& filePath,
+    const GraphicsResourceDesc& resourceDesc)
+{
+    return waitForLoad(filePath, &resourceDesc);
+}
+
+std::shared_ptr<const ModelAsset> AssetManager::loadModelAsset(const std::string& filePath)
+{
+    return waitForLoad(filePath, nullptr);
+}
+
+std::shared_ptr<const ModelAsset> AssetManager::waitForLoad(const std::string& filePath, const GraphicsResourceDesc* resourceDesc)
+{
+    AssetStreamer* streamer = nullptr;
+    AssetStreamer::RequestId request = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_cacheMutex);
+        auto cached = m_modelCache.find(filePath);
+        if (cached != m_modelCache.end())
+        {
+            return cached->second;
+        }
+
+        request = addWaiter(filePath, resourceDesc, 0.0f);
+        streamer = m_streamer.get();
+    }
+
+    // Joins a load already in flight as well, taking over its upload
+    auto asset = streamer->finish(request);
+
+    std::lock_guard<std::mutex> lock(m_cacheMutex);
+    auto pending = m_pendingLoads.find(filePath);
+    if (pending != m_pendingLoads.end() && pending->second.request == request)
+    {
+        --pending->second.waiterCount;
+        retirePendingLoad(filePath);
+    }
+    return asset;
+}
+
 bool AssetManager::isLoadingComplete(const std::string& taskId)
 {
     std::lock_guard<std::mutex> lock(m_tasksMutex);
@@ -110,7 +199,7 @@ std::shared_ptr<Model> AssetManager::getLoadedModel(const std::string& taskId)
     auto it = m_loadingTasks.find(taskId);
     if (it != m_loadingTasks.end() && it->second.isComplete && !it->second.hasError)
     {
-        return it->second.future.get();
+        return it->second.model;
     }
     return nullptr;
 }
@@ -139,6 +228,9 @@ std::string AssetManager::getLoadingError(const std::string& taskId)
 
 void AssetManager::cleanupTask(const std::string& taskId)
 {
+    // An unfinished task is cancelled first so its file stops loading if nothing else waits for it
+    cancelLoading(taskId);
+
     std::lock_guard<std::mutex> lock(m_tasksMutex);
     m_loadingTasks.erase(taskId);
 }
@@ -160,13 +252,7 @@ void AssetManager::cleanupCompletedTasks()
     }
 }
 
-void AssetManager::cacheModel(const std::string& filePath, std::shared_ptr<Model> model)
-{
-    std::lock_guard<std::mutex> lock(m_cacheMutex);
-    m_modelCache[filePath] = model;
-}
-
-std::shared_ptr<Model> AssetManager::getCachedModel(const std::string& filePath)
+std::shared_ptr<const ModelAsset> AssetManager::getCachedModel(const std::string& filePath)
 {
     std::lock_guard<std::mutex> lock(m_cacheMutex);
     auto it = m_modelCache.find(filePath);
@@ -179,54 +265,89 @@ bool AssetManager::isModelCached(const std::string& filePath)
     return m_modelCache.find(filePath) != m_modelCache.end();
 }
 
+size_t AssetManager::getCachedModelCount()
+{
+    std::lock_guard<std::mutex> lock(m_cacheMutex);
+    return m_modelCache.size();
+}
+
+void AssetManager::releaseUnusedModels()
+{
+    std::lock_guard<std::mutex> lock(m_cacheMutex);
+    auto it = m_modelCache.begin();
+    while (it != m_modelCache.end())
+    {
+        // The cache's own reference is the only one left
+        if (it->second.use_count() == 1)
+        {
+            it = m_modelCache.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
 void AssetManager::clearCache()
 {
     std::lock_guard<std::mutex> lock(m_cacheMutex);
     m_modelCache.clear();
 }
 
-void AssetManager::update()
+void AssetManager::update(float budgetMilliseconds)
 {
-    std::lock_guard<std::mutex> lock(m_tasksMutex);
+    // Uploads run without the locks so loads can be requested from other threads meanwhile
+    AssetStreamer* streamer = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_cacheMutex);
+        streamer = m_streamer.get();
+    }
+    if (!streamer)
+    {
+        return;
+    }
+    streamer->processUploads(budgetMilliseconds);
+
+    std::lock_guard<std::mutex> tasksLock(m_tasksMutex);
+    std::lock_guard<std::mutex> cacheLock(m_cacheMutex);
+
+    std::vector<std::string> pendingFiles;
+    for (const auto& pair : m_pendingLoads)
+    {
+        pendingFiles.push_back(pair.first);
+    }
+    for (const auto& filePath : pendingFiles)
+    {
+        retirePendingLoad(filePath);
+    }
 
     for (auto& pair : m_loadingTasks)
     {
         auto& task = pair.second;
+        if (task.isComplete)
+        {
+            continue;
+        }
 
-        if (!task.isComplete)
+        auto cached = m_modelCache.find(task.filePath);
+        auto pending = m_pendingLoads.find(task.filePath);
+        if (cached != m_modelCache.end())
         {
-            // Check if future is ready
-            if (task.future.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
-            {
-                try
-                {
-                    auto model = task.future.get();
-                    if (model)
-                    {
-                        // Cache the loaded model
-                        cacheModel(task.filePath, model);
-                        task.progress = 100.0f;
-                        task.isComplete = true;
-                    }
-                    else
-                    {
-                        task.hasError = true;
-                        task.errorMessage = "Failed to load model";
-                        task.isComplete = true;
-                    }
-                }
-                catch (const std::exception& e)
-                {
-                    task.hasError = true;
-                    task.errorMessage = e.what();
-                    task.isComplete = true;
-                }
-            }
-            else
-            {
-                // Update progress (simple increment for now)
-                task.progress = std::min(90.0f, task.progress + 10.0f);
-            }
+            task.model = createInstance(cached->second);
+            task.progress = 100.0f;
+            task.isComplete = true;
+        }
+        else if (pending != m_pendingLoads.end())
+        {
+            task.progress = m_streamer->getProgress(pending->second.request) * 100.0f;
+        }
+        else
+        {
+            // Retired without being cached
+            task.hasError = true;
+            task.errorMessage = "Failed to load model";
+            task.isComplete = true;
         }
     }
 }
@@ -236,21 +357,92 @@ std::string AssetManager::generateTaskId()
     return "task_" + std::to_string(m_taskCounter.fetch_add(1));
 }
 
-std::shared_ptr<Model> AssetManager::loadModelWorker(
+AssetStreamer& AssetManager::getStreamer(const GraphicsResourceDesc* resourceDesc)
+{
+    if (!m_streamer)
+    {
+        if (!resourceDesc)
+        {
+            throw std::runtime_error("AssetManager: loading without a device needs setAssetUploader() first");
+        }
+        m_uploader = std::make_unique<D3D11AssetUploader>(*resourceDesc);
+        m_streamer = std::make_unique<AssetStreamer>(*m_uploader);
+    }
+    return *m_streamer;
+}
+
+AssetStreamer::RequestId AssetManager::addWaiter(
     const std::string& filePath,
-    GraphicsResourceDesc resourceDesc,
-    std::shared_ptr<std::atomic<float>> progressPtr)
+    const GraphicsResourceDesc* resourceDesc,
+    float priority)
 {
-    try
+    AssetStreamer& streamer = getStreamer(resourceDesc);
+
+    auto pending = m_pendingLoads.find(filePath);
+    if (pending != m_pendingLoads.end())
     {
-        progressPtr->store(10.0f);
-        auto model = ModelLoader::LoadModel(filePath, resourceDesc);
-        progressPtr->store(100.0f);
-        return model;
+        // Nobody waits for a cancelled load that is still finishing a stage; start afresh
+        if (pending->second.waiterCount > 0)
+        {
+            ++pending->second.waiterCount;
+            return pending->second.request;
+        }
+        streamer.release(pending->second.request);
     }
-    catch (const std::exception& e)
+
+    PendingLoad load;
+    load.request = streamer.requestModel(filePath, priority);
+    load.waiterCount = 1;
+    m_pendingLoads[filePath] = load;
+    return load.request;
+}
+
+void AssetManager::retirePendingLoad(const std::string& filePath)
+{
+    auto pending = m_pendingLoads.find(filePath);
+    if (pending == m_pendingLoads.end())
     {
-        // Log error and return nullptr
-        return nullptr;
+        return;
     }
-}
\ No newline at end of file
+
+    AssetStreamer::RequestId request = pending->second.request;
+    StreamState state = m_streamer->getState(request);
+    if (state == StreamState::Complete)
+    {
+        m_modelCache[filePath] = m_streamer->getAsset(request);
+    }
+    else if (state != StreamState::Failed && state != StreamState::Cancelled)
+    {
+        return;
+    }
+
+    // Failures are not cached so a fixed file loads on the next request
+    m_streamer->release(request);
+    m_pendingLoads.erase(pending);
+}
+
+void AssetManager::applyTaskPriority(const std::string& filePath)
+{
+    auto pending = m_pendingLoads.find(filePath);
+    if (pending == m_pendingLoads.end())
+    {
+        return;
+    }
+
+    bool found = false;
+    float priority = 0.0f;
+    for (const auto& pair : m_loadingTasks)
+    {
+        const LoadingTask& task = pair.second;
+        if (!task.isComplete && task.filePath == filePath)
+        {
+            priority = found ? std::min(priority, task.priority) : task.priority;
+            found = true;
+        }
+    }
+
+    if (found)
+    {
+        m_streamer->setPriority(pending->second.request, priority);
+    }
+}
@@ -0,0 +1,375 @@
+#include <DX3D/Assets/AssetStreamer.h>
+#include <DX3D/Assets/ModelLoader.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <limits>
+
+using namespace dx3d;
+
+namespace
+{
+    // Share of a request's progress done once it is read, and once it is decoded; upload steps
+    // fill in the rest. A current cooked file is decoded as soon as it is read.
+    constexpr float READ_PROGRESS = 0.1f;
+    constexpr float DECODE_PROGRESS = 0.6f;
+
+    bool isFinished(StreamState state)
+    {
+        return state == StreamState::Complete || state == StreamState::Failed || state == StreamState::Cancelled;
+    }
+}
+
+struct AssetStreamer::Request
+{
+    RequestId id = 0;
+    std::string filePath;
+    float priority = 0.0f;
+    StreamState state = StreamState::Queued;
+    float progress = 0.0f;
+
+    // A thread is running one of its stages, which sees cancelRequested once it is done
+    bool isBusy = false;
+    bool cancelRequested = false;
+
+    std::shared_ptr<DecodedModel> model;
+    std::unique_ptr<ModelAssetBuilder> builder;
+    std::shared_ptr<const ModelAsset> asset;
+
+    // Lower priority first, then in the order requested
+    bool isBefore(const Request& other) const
+    {
+        return priority != other.priority ? priority < other.priority : id < other.id;
+    }
+};
+
+AssetStreamer::AssetStreamer(AssetUploader& uploader, const AssetStreamerDesc& desc)
+    : m_uploader(uploader), m_desc(desc)
+{
+    m_desc.workerCount = std::max(m_desc.workerCount, 1u);
+    m_desc.maxConcurrentReads = std::max(m_desc.maxConcurrentReads, 1u);
+    m_desc.maxConcurrentDecodes = std::max(m_desc.maxConcurrentDecodes, 1u);
+
+    m_workers.reserve(m_desc.workerCount);
+    for (ui32 i = 0; i < m_desc.workerCount; ++i)
+    {
+        m_workers.emplace_back([this]() { workerLoop(); });
+    }
+}
+
+AssetStreamer::~AssetStreamer()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+        for (auto& pair : m_requests)
+        {
+            Request& request = *pair.second;
+            if (request.isBusy)
+            {
+                request.cancelRequested = true;
+            }
+            else if (!isFinished(request.state))
+            {
+                retire(request, StreamState::Cancelled);
+            }
+        }
+    }
+    m_workAvailable.notify_all();
+    m_requestChanged.notify_all();
+
+    // Stages already running finish before their worker sees the stop
+    for (auto& worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+AssetStreamer::RequestId AssetStreamer::requestModel(const std::string& filePath, float priority)
+{
+    auto request = std::make_shared<Request>();
+    request->filePath = filePath;
+    request->priority = priority;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        request->id = m_nextRequest++;
+        m_requests[request->id] = request;
+    }
+    m_workAvailable.notify_one();
+    return request->id;
+}
+
+void AssetStreamer::setPriority(RequestId id, float priority)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (auto request = findRequest(id))
+    {
+        request->priority = priority;
+    }
+}
+
+void AssetStreamer::cancel(RequestId id)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto request = findRequest(id);
+    if (!request || isFinished(request->state))
+    {
+        return;
+    }
+
+    if (request->isBusy)
+    {
+        request->cancelRequested = true;
+    }
+    else
+    {
+        retire(*request, StreamState::Cancelled);
+        m_requestChanged.notify_all();
+    }
+}
+
+void AssetStreamer::release(RequestId id)
+{
+    cancel(id);
+
+    // A stage still running keeps its own reference to the request
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_requests.erase(id);
+}
+
+StreamState AssetStreamer::getState(RequestId id) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto request = findRequest(id);
+    return request ? request->state : StreamState::Cancelled;
+}
+
+float AssetStreamer::getProgress(RequestId id) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto request = findRequest(id);
+    return request ? request->progress : 0.0f;
+}
+
+std::shared_ptr<const ModelAsset> AssetStreamer::getAsset(RequestId id) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto request = findRequest(id);
+    return request ? request->asset : nullptr;
+}
+
+ui32 AssetStreamer::processUploads(float budgetMilliseconds)
+{
+    using Clock = std::chrono::steady_clock;
+    auto start = Clock::now();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    ui32 steps = 0;
+    while (auto request = pickUpload())
+    {
+        runUploadStep(lock, *request);
+        ++steps;
+
+        if (std::chrono::duration<float, std::milli>(Clock::now() - start).count() >= budgetMilliseconds)
+        {
+            break;
+        }
+    }
+    return steps;
+}
+
+std::shared_ptr<const ModelAsset> AssetStreamer::finish(RequestId id)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    auto request = findRequest(id);
+    if (!request)
+    {
+        return nullptr;
+    }
+
+    request->priority = -std::numeric_limits<float>::infinity();
+    m_workAvailable.notify_all();
+
+    while (!isFinished(request->state) && !m_stopping)
+    {
+        bool canUpload = request->state == StreamState::WaitingForUpload || request->state == StreamState::Uploading;
+        if (canUpload && !request->isBusy)
+        {
+            runUploadStep(lock, *request);
+        }
+        else
+        {
+            m_requestChanged.wait(lock);
+        }
+    }
+    return request->asset;
+}
+
+void AssetStreamer::workerLoop()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stopping)
+    {
+        auto request = pickWorkerStage();
+        if (!request)
+        {
+            m_workAvailable.wait(lock);
+            continue;
+        }
+        runWorkerStage(lock, *request);
+    }
+}
+
+void AssetStreamer::runWorkerStage(std::unique_lock<std::mutex>& lock, Request& request)
+{
+    bool reading = request.state == StreamState::Queued;
+    ui32& inFlight = reading ? m_readsInFlight : m_decodesInFlight;
+    ++inFlight;
+
+    request.state = reading ? StreamState::Reading : StreamState::Decoding;
+    request.isBusy = true;
+    if (reading)
+    {
+        request.model = std::make_shared<DecodedModel>();
+    }
+    std::shared_ptr<DecodedModel> model = request.model;
+    std::string filePath = request.filePath;
+    lock.unlock();
+
+    bool succeeded = false;
+    try
+    {
+        succeeded = reading ? ModelLoader::ReadModel(filePath, *model) : ModelLoader::DecodeModel(*model);
+    }
+    catch (const std::exception& e)
+    {
+        printf("Exception streaming model %s: %s\n", filePath.c_str(), e.what());
+    }
+
+    lock.lock();
+    --inFlight;
+    request.isBusy = false;
+    if (request.cancelRequested)
+    {
+        retire(request, StreamState::Cancelled);
+    }
+    else if (!succeeded)
+    {
+        retire(request, StreamState::Failed);
+    }
+    else if (model->isDecoded)
+    {
+        request.state = StreamState::WaitingForUpload;
+        request.progress = DECODE_PROGRESS;
+    }
+    else
+    {
+        request.state = StreamState::WaitingForDecode;
+        request.progress = READ_PROGRESS;
+    }
+
+    // The freed slot or the next stage may be for another worker
+    m_workAvailable.notify_all();
+    m_requestChanged.notify_all();
+}
+
+void AssetStreamer::runUploadStep(std::unique_lock<std::mutex>& lock, Request& request)
+{
+    if (!request.builder)
+    {
+        request.builder = std::make_unique<ModelAssetBuilder>(request.model, m_uploader);
+    }
+    request.state = StreamState::Uploading;
+    request.isBusy = true;
+    ModelAssetBuilder& builder = *request.builder;
+    lock.unlock();
+
+    bool succeeded = true;
+    bool complete = false;
+    try
+    {
+        complete = builder.step();
+    }
+    catch (const std::exception& e)
+    {
+        printf("Failed to upload model %s: %s\n", request.filePath.c_str(), e.what());
+        succeeded = false;
+    }
+    float uploadProgress = builder.getProgress();
+
+    lock.lock();
+    request.isBusy = false;
+    if (request.cancelRequested)
+    {
+        retire(request, StreamState::Cancelled);
+    }
+    else if (!succeeded)
+    {
+        retire(request, StreamState::Failed);
+    }
+    else if (complete)
+    {
+        request.asset = builder.getAsset();
+        retire(request, StreamState::Complete);
+    }
+    else
+    {
+        request.progress = DECODE_PROGRESS + (1.0f - DECODE_PROGRESS) * uploadProgress;
+    }
+    m_requestChanged.notify_all();
+}
+
+std::shared_ptr<AssetStreamer::Request> AssetStreamer::pickWorkerStage()
+{
+    bool canRead = m_readsInFlight < m_desc.maxConcurrentReads;
+    bool canDecode = m_decodesInFlight < m_desc.maxConcurrentDecodes;
+
+    std::shared_ptr<Request> best;
+    for (auto& pair : m_requests)
+    {
+        const Request& request = *pair.second;
+        bool ready = !request.isBusy &&
+            ((request.state == StreamState::Queued && canRead) ||
+             (request.state == StreamState::WaitingForDecode && canDecode));
+        if (ready && (!best || request.isBefore(*best)))
+        {
+            best = pair.second;
+        }
+    }
+    return best;
+}
+
+std::shared_ptr<AssetStreamer::Request> AssetStreamer::pickUpload()
+{
+    std::shared_ptr<Request> best;
+    for (auto& pair : m_requests)
+    {
+        const Request& request = *pair.second;
+        bool ready = !request.isBusy &&
+            (request.state == StreamState::WaitingForUpload || request.state == StreamState::Uploading);
+        if (ready && (!best || request.isBefore(*best)))
+        {
+            best = pair.second;
+        }
+    }
+    return best;
+}
+
+std::shared_ptr<AssetStreamer::Request> AssetStreamer::findRequest(RequestId id) const
+{
+    auto it = m_requests.find(id);
+    return (it != m_requests.end()) ? it->second : nullptr;
+}
+
+void AssetStreamer::retire(Request& request, StreamState state)
+{
+    request.state = state;
+    if (state == StreamState::Complete)
+    {
+        request.progress = 1.0f;
+    }
+
+    // The decoded geometry (or its cooked file's mapping) is only needed until it is uploaded
+    request.builder.reset();
+    request.model.reset();
+}
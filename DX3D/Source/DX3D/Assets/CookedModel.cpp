@@ -0,0 +1,326 @@
+#include <DX3D/Assets/CookedModel.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <type_traits>
+
+using namespace dx3d;
+
+namespace
+{
+    constexpr ui32 COOKED_MODEL_MAGIC = 0x4C444D58; // "XMDL"
+    constexpr ui64 BLOB_ALIGNMENT = 16;
+
+    struct FileHeader
+    {
+        ui32 magic;
+        ui32 version;
+        ui64 sourceHash;
+        ui32 vertexStride;
+        ui32 maxLods;
+        ui32 meshCount;
+        ui32 materialCount;
+        ui64 meshTableOffset;
+        ui64 materialTableOffset;
+        ui64 vertexDataOffset;
+        ui64 vertexDataSize;
+        ui64 indexDataOffset;
+        ui64 indexDataSize;
+        ui64 stringDataOffset;
+        ui64 stringDataSize;
+    };
+
+    struct MeshEntry
+    {
+        ui32 firstVertex;
+        ui32 vertexCount;
+        ui32 firstIndex;
+        ui32 indexCount;
+        ui32 materialIndex;
+        ui32 lodCount;
+        MeshLod lods[MAX_MESH_LODS];
+        float boundsMin[3];
+        float boundsMax[3];
+    };
+
+    struct StringRef
+    {
+        ui32 offset;
+        ui32 length;
+    };
+
+    struct MaterialEntry
+    {
+        StringRef name;
+        StringRef diffuseTexture;
+        float diffuseColor[4];
+        float ambientColor[4];
+        float specularColor[4];
+        float emissiveColor[4];
+        float specularPower;
+        float opacity;
+    };
+
+    static_assert(std::is_trivially_copyable_v<MeshLod> && std::is_trivially_copyable_v<Vertex>,
+        "cooked blobs are copied and mapped as raw bytes");
+
+    ui64 alignBlob(ui64 offset)
+    {
+        return (offset + BLOB_ALIGNMENT - 1) & ~(BLOB_ALIGNMENT - 1);
+    }
+
+    ui64 mixHash(ui64 value)
+    {
+        value ^= value >> 33;
+        value *= 0xFF51AFD7ED558CCDull;
+        value ^= value >> 33;
+        value *= 0xC4CEB9FE1A85EC53ull;
+        value ^= value >> 33;
+        return value;
+    }
+
+    void storeVector(float (&out)[4], const Vector4& value)
+    {
+        out[0] = value.x;
+        out[1] = value.y;
+        out[2] = value.z;
+        out[3] = value.w;
+    }
+
+    Vector4 loadVector(const float (&in)[4])
+    {
+        return Vector4(in[0], in[1], in[2], in[3]);
+    }
+
+    // Appends raw bytes at the next aligned offset and returns where they start
+    ui64 appendBlob(std::vector<char>& buffer, const void* data, size_t size)
+    {
+        ui64 offset = alignBlob(buffer.size());
+        buffer.resize(offset + size);
+        if (size > 0)
+            std::memcpy(buffer.data() + offset, data, size);
+        return offset;
+    }
+
+    bool isRangeInside(ui64 offset, ui64 size, ui64 fileSize)
+    {
+        return offset <= fileSize && size <= fileSize - offset;
+    }
+}
+
+ui64 dx3d::hashSourceData(const void* data, size_t size)
+{
+    // Word-at-a-time multiply-xorshift; only has to tell source revisions apart, not resist attacks
+    const char* bytes = static_cast<const char*>(data);
+    ui64 hash = 0x9E3779B97F4A7C15ull ^ size;
+
+    size_t i = 0;
+    for (; i + sizeof(ui64) <= size; i += sizeof(ui64))
+    {
+        ui64 word;
+        std::memcpy(&word, bytes + i, sizeof(word));
+        hash = (hash ^ mixHash(word)) * 0x100000001B3ull;
+    }
+
+    ui64 tail = 0;
+    std::memcpy(&tail, bytes + i, size - i);
+    return mixHash(hash ^ mixHash(tail));
+}
+
+std::string dx3d::getCookedModelPath(const std::string& sourcePath)
+{
+    return sourcePath + COOKED_MODEL_EXTENSION;
+}
+
+bool dx3d::writeCookedModel(const std::string& path, const ImportedModel& model, ui64 sourceHash)
+{
+    std::vector<MeshEntry> meshes;
+    std::vector<MaterialEntry> materials;
+    std::vector<Vertex> vertices;
+    std::vector<ui32> indices;
+    std::string strings;
+
+    auto addString = [&strings](const std::string& text)
+        {
+            StringRef ref{ static_cast<ui32>(strings.size()), static_cast<ui32>(text.size()) };
+            strings += text;
+            return ref;
+        };
+
+    for (const auto& mesh : model.meshes)
+    {
+        MeshEntry entry{};
+        entry.firstVertex = static_cast<ui32>(vertices.size());
+        entry.vertexCount = static_cast<ui32>(mesh.vertices.size());
+        entry.firstIndex = static_cast<ui32>(indices.size());
+        entry.indexCount = static_cast<ui32>(mesh.lodChain.indices.size());
+        entry.materialIndex = mesh.materialIndex;
+        entry.lodCount = static_cast<ui32>(std::min<size_t>(mesh.lodChain.lods.size(), MAX_MESH_LODS));
+        std::copy(mesh.lodChain.lods.begin(), mesh.lodChain.lods.begin() + entry.lodCount, entry.lods);
+        entry.boundsMin[0] = mesh.bounds.min.x;
+        entry.boundsMin[1] = mesh.bounds.min.y;
+        entry.boundsMin[2] = mesh.bounds.min.z;
+        entry.boundsMax[0] = mesh.bounds.max.x;
+        entry.boundsMax[1] = mesh.bounds.max.y;
+        entry.boundsMax[2] = mesh.bounds.max.z;
+        meshes.push_back(entry);
+
+        vertices.insert(vertices.end(), mesh.vertices.begin(), mesh.vertices.end());
+        indices.insert(indices.end(), mesh.lodChain.indices.begin(), mesh.lodChain.indices.end());
+    }
+
+    for (const auto& material : model.materials)
+    {
+        MaterialEntry entry{};
+        entry.name = addString(material.name);
+        entry.diffuseTexture = addString(material.diffuseTexture);
+        storeVector(entry.diffuseColor, material.diffuseColor);
+        storeVector(entry.ambientColor, material.ambientColor);
+        storeVector(entry.specularColor, material.specularColor);
+        storeVector(entry.emissiveColor, material.emissiveColor);
+        entry.specularPower = material.specularPower;
+        entry.opacity = material.opacity;
+        materials.push_back(entry);
+    }
+
+    FileHeader header{};
+    header.magic = COOKED_MODEL_MAGIC;
+    header.version = COOKED_MODEL_VERSION;
+    header.sourceHash = sourceHash;
+    header.vertexStride = sizeof(Vertex);
+    header.maxLods = MAX_MESH_LODS;
+    header.meshCount = static_cast<ui32>(meshes.size());
+    header.materialCount = static_cast<ui32>(materials.size());
+
+    std::vector<char> buffer(sizeof(FileHeader));
+    header.meshTableOffset = appendBlob(buffer, meshes.data(), meshes.size() * sizeof(MeshEntry));
+    header.materialTableOffset = appendBlob(buffer, materials.data(), materials.size() * sizeof(MaterialEntry));
+    header.vertexDataSize = vertices.size() * sizeof(Vertex);
+    header.vertexDataOffset = appendBlob(buffer, vertices.data(), header.vertexDataSize);
+    header.indexDataSize = indices.size() * sizeof(ui32);
+    header.indexDataOffset = appendBlob(buffer, indices.data(), header.indexDataSize);
+    header.stringDataSize = strings.size();
+    header.stringDataOffset = appendBlob(buffer, strings.data(), header.stringDataSize);
+    std::memcpy(buffer.data(), &header, sizeof(header));
+
+    std::string temporaryPath = path + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!file.write(buffer.data(), static_cast<std::streamsize>(buffer.size())))
+        {
+            printf("Failed to write cooked model: %s\n", temporaryPath.c_str());
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporaryPath, path, error);
+    if (error)
+    {
+        printf("Failed to replace cooked model %s: %s\n", path.c_str(), error.message().c_str());
+        std::filesystem::remove(temporaryPath, error);
+        return false;
+    }
+    return true;
+}
+
+bool CookedModel::open(const std::string& path, ui64 sourceHash)
+{
+    close();
+    if (!m_file.open(path) || m_file.getSize() < sizeof(FileHeader))
+    {
+        close();
+        return false;
+    }
+
+    const char* base = static_cast<const char*>(m_file.getData());
+    const ui64 fileSize = m_file.getSize();
+
+    FileHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    if (header.magic != COOKED_MODEL_MAGIC || header.version != COOKED_MODEL_VERSION ||
+        header.sourceHash != sourceHash || header.vertexStride != sizeof(Vertex) || header.maxLods != MAX_MESH_LODS ||
+        !isRangeInside(header.meshTableOffset, ui64(header.meshCount) * sizeof(MeshEntry), fileSize) ||
+        !isRangeInside(header.materialTableOffset, ui64(header.materialCount) * sizeof(MaterialEntry), fileSize) ||
+        !isRangeInside(header.vertexDataOffset, header.vertexDataSize, fileSize) ||
+        !isRangeInside(header.indexDataOffset, header.indexDataSize, fileSize) ||
+        !isRangeInside(header.stringDataOffset, header.stringDataSize, fileSize))
+    {
+        close();
+        return false;
+    }
+
+    const auto* meshEntries = reinterpret_cast<const MeshEntry*>(base + header.meshTableOffset);
+    const auto* materialEntries = reinterpret_cast<const MaterialEntry*>(base + header.materialTableOffset);
+    const auto* vertices = reinterpret_cast<const Vertex*>(base + header.vertexDataOffset);
+    const auto* indices = reinterpret_cast<const ui32*>(base + header.indexDataOffset);
+    const char* strings = base + header.stringDataOffset;
+    const ui64 vertexTotal = header.vertexDataSize / sizeof(Vertex);
+    const ui64 indexTotal = header.indexDataSize / sizeof(ui32);
+
+    auto getString = [strings, &header](const StringRef& ref, std::string& out)
+        {
+            if (!isRangeInside(ref.offset, ref.length, header.stringDataSize))
+                return false;
+            out.assign(strings + ref.offset, ref.length);
+            return true;
+        };
+
+    m_materials.resize(header.materialCount);
+    for (ui32 i = 0; i < header.materialCount; ++i)
+    {
+        const MaterialEntry& entry = materialEntries[i];
+        ImportedMaterial& material = m_materials[i];
+        if (!getString(entry.name, material.name) || !getString(entry.diffuseTexture, material.diffuseTexture))
+        {
+            close();
+            return false;
+        }
+        material.diffuseColor = loadVector(entry.diffuseColor);
+        material.ambientColor = loadVector(entry.ambientColor);
+        material.specularColor = loadVector(entry.specularColor);
+        material.emissiveColor = loadVector(entry.emissiveColor);
+        material.specularPower = entry.specularPower;
+        material.opacity = entry.opacity;
+    }
+
+    m_meshes.resize(header.meshCount);
+    for (ui32 i = 0; i < header.meshCount; ++i)
+    {
+        const MeshEntry& entry = meshEntries[i];
+        bool valid = ui64(entry.firstVertex) + entry.vertexCount <= vertexTotal &&
+            ui64(entry.firstIndex) + entry.indexCount <= indexTotal &&
+            entry.lodCount >= 1 && entry.lodCount <= MAX_MESH_LODS && entry.materialIndex < header.materialCount;
+        for (ui32 lod = 0; valid && lod < entry.lodCount; ++lod)
+        {
+            valid = ui64(entry.lods[lod].firstIndex) + entry.lods[lod].indexCount <= entry.indexCount;
+        }
+        if (!valid)
+        {
+            close();
+            return false;
+        }
+
+        MeshData& mesh = m_meshes[i];
+        mesh.vertices = vertices + entry.firstVertex;
+        mesh.vertexCount = entry.vertexCount;
+        mesh.indices = indices + entry.firstIndex;
+        mesh.indexCount = entry.indexCount;
+        mesh.lods = entry.lods;
+        mesh.lodCount = entry.lodCount;
+        mesh.materialIndex = entry.materialIndex;
+        mesh.bounds = AABB(Vector3(entry.boundsMin[0], entry.boundsMin[1], entry.boundsMin[2]),
+            Vector3(entry.boundsMax[0], entry.boundsMax[1], entry.boundsMax[2]));
+    }
+
+    return true;
+}
+
+void CookedModel::close()
+{
+    m_meshes.clear();
+    m_materials.clear();
+    m_file.close();
+}
@@ -0,0 +1,460 @@
+#include <DX3D/Assets/CookedTexture.h>
+#include <DX3D/Assets/CookedModel.h>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define DX3D_TEXTURE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+using namespace dx3d;
+
+namespace
+{
+    constexpr ui32 COOKED_TEXTURE_MAGIC = 0x58455458; // "XTEX"
+    constexpr ui64 BLOB_ALIGNMENT = 16;
+    constexpr ui32 MAX_MIPS = 32;
+
+    struct FileHeader
+    {
+        ui32 magic;
+        ui32 version;
+        ui64 sourceHash;
+        ui32 width;
+        ui32 height;
+        ui32 mipCount;
+        ui32 colorSpace;
+        ui64 mipTableOffset;
+    };
+
+    struct MipEntry
+    {
+        ui32 width;
+        ui32 height;
+        ui64 offset;
+        ui64 size;
+    };
+
+    // Last word of the file name before the extension, and words anywhere in it, that mark
+    // data textures
+    const char* const LINEAR_SUFFIXES[] = {
+        "n", "nrm", "norm", "normal", "h", "height", "s", "spec", "specular",
+        "r", "rough", "roughness", "m", "metal", "metallic", "ao", "mask", "disp" };
+    const char* const LINEAR_WORDS[] = { "normal", "height", "spec", "rough", "metal", "occlusion", "displace" };
+
+    ui64 alignBlob(ui64 offset)
+    {
+        return (offset + BLOB_ALIGNMENT - 1) & ~(BLOB_ALIGNMENT - 1);
+    }
+
+    bool isRangeInside(ui64 offset, ui64 size, ui64 fileSize)
+    {
+        return offset <= fileSize && size <= fileSize - offset;
+    }
+
+    // Conversions between 8-bit values and 16-bit linear light, in which mips are filtered
+    struct ColorTables
+    {
+        uint16_t srgbToLinear[256];
+        unsigned char linearToSrgb[65536];
+
+        ColorTables()
+        {
+            for (ui32 i = 0; i < 256; ++i)
+            {
+                double c = i / 255.0;
+                double linear = c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4);
+                srgbToLinear[i] = static_cast<uint16_t>(std::lround(linear * 65535.0));
+            }
+            for (ui32 i = 0; i < 65536; ++i)
+            {
+                double linear = i / 65535.0;
+                double c = linear <= 0.0031308 ? linear * 12.92 : 1.055 * std::pow(linear, 1.0 / 2.4) - 0.055;
+                linearToSrgb[i] = static_cast<unsigned char>(std::lround(std::clamp(c, 0.0, 1.0) * 255.0));
+            }
+        }
+
+        static const ColorTables& get()
+        {
+            static const ColorTables tables;
+            return tables;
+        }
+    };
+
+    // One row of 8-bit RGBA to 16-bit linear
+    void expandRow(const unsigned char* in, ui32 width, TextureColorSpace colorSpace, uint16_t* out)
+    {
+        ui32 count = width * 4;
+        if (colorSpace == TextureColorSpace::Srgb)
+        {
+            const uint16_t* table = ColorTables::get().srgbToLinear;
+            for (ui32 i = 0; i < count; i += 4)
+            {
+                out[i] = table[in[i]];
+                out[i + 1] = table[in[i + 1]];
+                out[i + 2] = table[in[i + 2]];
+                out[i + 3] = static_cast<uint16_t>(in[i + 3] * 257);
+            }
+            return;
+        }
+
+        ui32 i = 0;
+#if DX3D_TEXTURE_SSE2
+        // Interleaving a byte with itself multiplies it by 257
+        for (; i + 16 <= count; i += 16)
+        {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_unpacklo_epi8(bytes, bytes));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 8), _mm_unpackhi_epi8(bytes, bytes));
+        }
+#endif
+        for (; i < count; ++i)
+        {
+            out[i] = static_cast<uint16_t>(in[i] * 257);
+        }
+    }
+
+    // One row of 16-bit linear back to 8-bit RGBA
+    void compressRow(const uint16_t* in, ui32 width, TextureColorSpace colorSpace, unsigned char* out)
+    {
+        ui32 count = width * 4;
+        const unsigned char* table = ColorTables::get().linearToSrgb;
+        bool isSrgb = colorSpace == TextureColorSpace::Srgb;
+        for (ui32 i = 0; i < count; ++i)
+        {
+            bool isAlpha = (i & 3) == 3;
+            out[i] = isSrgb && !isAlpha ? table[in[i]] : static_cast<unsigned char>((in[i] * 255u + 32767u) / 65535u);
+        }
+    }
+
+    // 2x2 box filter of two 16-bit RGBA rows into one row of outWidth pixels. Only a source one
+    // pixel wide or high has to repeat its last column or row.
+    void reduceRows(const uint16_t* row0, const uint16_t* row1, ui32 inWidth, uint16_t* out, ui32 outWidth)
+    {
+        ui32 x = 0;
+#if DX3D_TEXTURE_SSE2
+        if (inWidth >= 2)
+        {
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i rounding = _mm_set1_epi32(2);
+            const __m128i bias32 = _mm_set1_epi32(32768);
+            const __m128i bias16 = _mm_set1_epi16(static_cast<short>(0x8000));
+
+            // Two output pixels from four input pixels of each row. The sums are narrowed with a
+            // signed pack, so they are biased into its range and back.
+            for (; x + 2 <= outWidth; x += 2)
+            {
+                __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x * 8));
+                __m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x * 8 + 8));
+                __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x * 8));
+                __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x * 8 + 8));
+
+                __m128i sum0 = _mm_add_epi32(
+                    _mm_add_epi32(_mm_unpacklo_epi16(a0, zero), _mm_unpackhi_epi16(a0, zero)),
+                    _mm_add_epi32(_mm_unpacklo_epi16(b0, zero), _mm_unpackhi_epi16(b0, zero)));
+                __m128i sum1 = _mm_add_epi32(
+                    _mm_add_epi32(_mm_unpacklo_epi16(a1, zero), _mm_unpackhi_epi16(a1, zero)),
+                    _mm_add_epi32(_mm_unpacklo_epi16(b1, zero), _mm_unpackhi_epi16(b1, zero)));
+
+                sum0 = _mm_sub_epi32(_mm_srli_epi32(_mm_add_epi32(sum0, rounding), 2), bias32);
+                sum1 = _mm_sub_epi32(_mm_srli_epi32(_mm_add_epi32(sum1, rounding), 2), bias32);
+                __m128i packed = _mm_xor_si128(_mm_packs_epi32(sum0, sum1), bias16);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 4), packed);
+            }
+        }
+#endif
+        for (; x < outWidth; ++x)
+        {
+            ui32 left = x * 2 * 4;
+            ui32 right = std::min(x * 2 + 1, inWidth - 1) * 4;
+            for (ui32 c = 0; c < 4; ++c)
+            {
+                ui32 sum = ui32(row0[left + c]) + row0[right + c] + row1[left + c] + row1[right + c];
+                out[x * 4 + c] = static_cast<uint16_t>((sum + 2) >> 2);
+            }
+        }
+    }
+
+    bool hasLinearName(const std::string& sourcePath)
+    {
+        std::string name = std::filesystem::path(sourcePath).stem().string();
+        std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+        size_t separator = name.find_last_of("_-");
+        if (separator != std::string::npos)
+        {
+            std::string suffix = name.substr(separator + 1);
+            for (const char* linear : LINEAR_SUFFIXES)
+            {
+                if (suffix == linear)
+                    return true;
+            }
+        }
+        for (const char* word : LINEAR_WORDS)
+        {
+            if (name.find(word) != std::string::npos)
+                return true;
+        }
+        return false;
+    }
+
+    void collectMips(TextureData& data)
+    {
+        data.mips.clear();
+        for (const auto& level : data.decoded)
+        {
+            data.mips.push_back(TextureMip{ level.width, level.height, level.pixels.data() });
+        }
+    }
+}
+
+TextureColorSpace dx3d::getTextureColorSpace(const std::string& sourcePath)
+{
+    return hasLinearName(sourcePath) ? TextureColorSpace::Linear : TextureColorSpace::Srgb;
+}
+
+std::string dx3d::getCookedTexturePath(const std::string& sourcePath)
+{
+    return sourcePath + COOKED_TEXTURE_EXTENSION;
+}
+
+std::vector<DecodedImage> dx3d::generateMipChain(DecodedImage&& image, TextureColorSpace colorSpace)
+{
+    std::vector<DecodedImage> mips;
+    mips.push_back(std::move(image));
+
+    // Each level is filtered from the one above it at 16 bits, and only rounded to 8 bits for
+    // storage, so the rounding does not build up down the chain
+    std::vector<uint16_t> above;
+    std::vector<uint16_t> level;
+    std::vector<uint16_t> baseRows;
+
+    ui32 width = mips[0].width;
+    ui32 height = mips[0].height;
+    while (width > 1 || height > 1)
+    {
+        ui32 nextWidth = std::max(width / 2, 1u);
+        ui32 nextHeight = std::max(height / 2, 1u);
+        bool isFirst = mips.size() == 1;
+
+        level.resize(size_t(nextWidth) * nextHeight * 4);
+        baseRows.resize(size_t(width) * 8);
+        for (ui32 y = 0; y < nextHeight; ++y)
+        {
+            ui32 y0 = y * 2;
+            ui32 y1 = std::min(y * 2 + 1, height - 1);
+            const uint16_t* row0 = nullptr;
+            const uint16_t* row1 = nullptr;
+            if (isFirst)
+            {
+                // The base is expanded two rows at a time rather than as a whole
+                const unsigned char* pixels = mips[0].pixels.data();
+                expandRow(pixels + size_t(y0) * width * 4, width, colorSpace, baseRows.data());
+                expandRow(pixels + size_t(y1) * width * 4, width, colorSpace, baseRows.data() + size_t(width) * 4);
+                row0 = baseRows.data();
+                row1 = baseRows.data() + size_t(width) * 4;
+            }
+            else
+            {
+                row0 = above.data() + size_t(y0) * width * 4;
+                row1 = above.data() + size_t(y1) * width * 4;
+            }
+            reduceRows(row0, row1, width, level.data() + size_t(y) * nextWidth * 4, nextWidth);
+        }
+
+        DecodedImage mip;
+        mip.width = nextWidth;
+        mip.height = nextHeight;
+        mip.pixels.resize(level.size());
+        for (ui32 y = 0; y < nextHeight; ++y)
+        {
+            size_t offset = size_t(y) * nextWidth * 4;
+            compressRow(level.data() + offset, nextWidth, colorSpace, mip.pixels.data() + offset);
+        }
+        mips.push_back(std::move(mip));
+
+        above.swap(level);
+        width = nextWidth;
+        height = nextHeight;
+    }
+    return mips;
+}
+
+bool dx3d::writeCookedTexture(const std::string& path, const std::vector<DecodedImage>& mips,
+    TextureColorSpace colorSpace, ui64 sourceHash)
+{
+    if (mips.empty() || mips.size() > MAX_MIPS)
+        return false;
+
+    FileHeader header{};
+    header.magic = COOKED_TEXTURE_MAGIC;
+    header.version = COOKED_TEXTURE_VERSION;
+    header.sourceHash = sourceHash;
+    header.width = mips[0].width;
+    header.height = mips[0].height;
+    header.mipCount = static_cast<ui32>(mips.size());
+    header.colorSpace = static_cast<ui32>(colorSpace);
+    header.mipTableOffset = alignBlob(sizeof(FileHeader));
+
+    std::vector<MipEntry> entries(mips.size());
+    ui64 offset = header.mipTableOffset + entries.size() * sizeof(MipEntry);
+    for (size_t i = 0; i < mips.size(); ++i)
+    {
+        offset = alignBlob(offset);
+        entries[i].width = mips[i].width;
+        entries[i].height = mips[i].height;
+        entries[i].offset = offset;
+        entries[i].size = mips[i].pixels.size();
+        offset += entries[i].size;
+    }
+
+    // Levels are streamed out one at a time rather than gathered into one buffer first
+    static const char PADDING[BLOB_ALIGNMENT] = {};
+    std::string temporaryPath = path + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        ui64 written = 0;
+        auto write = [&file, &written](const void* data, ui64 size)
+            {
+                file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+                written += size;
+            };
+
+        write(&header, sizeof(header));
+        write(PADDING, header.mipTableOffset - written);
+        write(entries.data(), entries.size() * sizeof(MipEntry));
+        for (size_t i = 0; i < mips.size(); ++i)
+        {
+            write(PADDING, entries[i].offset - written);
+            write(mips[i].pixels.data(), entries[i].size);
+        }
+
+        if (!file)
+        {
+            printf("Failed to write cooked texture: %s\n", temporaryPath.c_str());
+            file.close();
+            std::error_code error;
+            std::filesystem::remove(temporaryPath, error);
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporaryPath, path, error);
+    if (error)
+    {
+        printf("Failed to replace cooked texture %s: %s\n", path.c_str(), error.message().c_str());
+        std::filesystem::remove(temporaryPath, error);
+        return false;
+    }
+    return true;
+}
+
+bool CookedTexture::open(const std::string& path, ui64 sourceHash)
+{
+    close();
+    if (!m_file.open(path) || m_file.getSize() < sizeof(FileHeader))
+    {
+        close();
+        return false;
+    }
+
+    const char* base = static_cast<const char*>(m_file.getData());
+    const ui64 fileSize = m_file.getSize();
+
+    FileHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    if (header.magic != COOKED_TEXTURE_MAGIC || header.version != COOKED_TEXTURE_VERSION ||
+        header.sourceHash != sourceHash || header.mipCount == 0 || header.mipCount > MAX_MIPS ||
+        header.colorSpace > static_cast<ui32>(TextureColorSpace::Srgb) ||
+        !isRangeInside(header.mipTableOffset, ui64(header.mipCount) * sizeof(MipEntry), fileSize))
+    {
+        close();
+        return false;
+    }
+
+    // The chain has to be complete and every level where the table says, so a file cut short
+    // or from a different filter is cooked again rather than half uploaded
+    const auto* entries = reinterpret_cast<const MipEntry*>(base + header.mipTableOffset);
+    ui32 width = header.width;
+    ui32 height = header.height;
+    m_mips.resize(header.mipCount);
+    for (ui32 i = 0; i < header.mipCount; ++i)
+    {
+        const MipEntry& entry = entries[i];
+        bool isLast = i + 1 == header.mipCount;
+        bool valid = entry.width == width && entry.height == height && width > 0 && height > 0 &&
+            entry.size == ui64(width) * height * 4 && isRangeInside(entry.offset, entry.size, fileSize) &&
+            isLast == (width == 1 && height == 1);
+        if (!valid)
+        {
+            close();
+            return false;
+        }
+
+        m_mips[i] = TextureMip{ width, height, reinterpret_cast<const unsigned char*>(base + entry.offset) };
+        width = std::max(width / 2, 1u);
+        height = std::max(height / 2, 1u);
+    }
+
+    m_colorSpace = static_cast<TextureColorSpace>(header.colorSpace);
+    return true;
+}
+
+void CookedTexture::close()
+{
+    m_mips.clear();
+    m_file.close();
+}
+
+bool dx3d::loadTextureData(const std::string& sourcePath, TextureData& data, std::string& error)
+{
+    MappedFile source;
+    if (!source.open(sourcePath))
+    {
+        error = "Cannot open " + sourcePath;
+        return false;
+    }
+
+    // Cooked files are keyed by the source's contents, so editing the image re-cooks it
+    ui64 hash = hashSourceData(source.getData(), source.getSize());
+    std::string cookedPath = getCookedTexturePath(sourcePath);
+    if (data.cooked.open(cookedPath, hash))
+    {
+        data.mips.clear();
+        for (ui32 i = 0; i < data.cooked.getMipCount(); ++i)
+        {
+            data.mips.push_back(data.cooked.getMip(i));
+        }
+        data.colorSpace = data.cooked.getColorSpace();
+        data.isCooked = true;
+        return true;
+    }
+
+    DecodedImage image;
+    if (!decodeImage(source.getData(), source.getSize(), image, error))
+    {
+        std::string decoderError = error;
+        if (!decodePlatformImageFile(sourcePath, image, error))
+        {
+            error = decoderError;
+            return false;
+        }
+    }
+    source.close();
+
+    data.colorSpace = getTextureColorSpace(sourcePath);
+    data.decoded = generateMipChain(std::move(image), data.colorSpace);
+    data.isCooked = false;
+    collectMips(data);
+
+    writeCookedTexture(cookedPath, data.decoded, data.colorSpace, hash);
+    return true;
+}
@@ -0,0 +1,32 @@
+#include <DX3D/Assets/D3D11AssetUploader.h>
+#include <DX3D/Assets/ModelImporter.h>
+#include <DX3D/Graphics/Mesh.h>
+#include <DX3D/Graphics/Texture2D.h>
+#include <DX3D/Graphics/ResourceManager.h>
+
+using namespace dx3d;
+
+std::shared_ptr<Texture2D> D3D11AssetUploader::createTexture(const std::string& filePath)
+{
+    // Shared with textures loaded by name, and decoded off this thread
+    auto& resources = ResourceManager::getInstance();
+    if (resources.isInitialized())
+    {
+        return resources.loadTexture(filePath);
+    }
+
+    try
+    {
+        return std::make_shared<Texture2D>(filePath, m_desc);
+    }
+    catch (const std::exception&)
+    {
+        return nullptr;
+    }
+}
+
+void D3D11AssetUploader::createMeshResources(Mesh& mesh, const MeshData& data)
+{
+    mesh.createRenderingResources(data.vertices, data.vertexCount, data.indices, data.indexCount,
+        data.lods, data.lodCount, m_desc);
+}
@@ -0,0 +1,1731 @@
+#include <DX3D/Assets/ImageDecoder.h>
+#include <DX3D/Core/MappedFile.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+using namespace dx3d;
+
+namespace
+{
+    // Larger images are rejected before anything is allocated for them
+    constexpr ui64 MAX_IMAGE_PIXELS = 1ull << 28;
+
+    bool fail(std::string& error, const char* message)
+    {
+        error = message;
+        return false;
+    }
+
+    ui32 readBigEndian16(const unsigned char* p)
+    {
+        return (ui32(p[0]) << 8) | p[1];
+    }
+
+    ui32 readBigEndian32(const unsigned char* p)
+    {
+        return (ui32(p[0]) << 24) | (ui32(p[1]) << 16) | (ui32(p[2]) << 8) | p[3];
+    }
+
+    unsigned char clampByte(i32 value)
+    {
+        return static_cast<unsigned char>(std::clamp(value, 0, 255));
+    }
+
+    // ---------------------------------------------------------------------------------------
+    // zlib / DEFLATE (RFC 1950, 1951)
+
+    constexpr ui32 INFLATE_FAST_BITS = 10;
+
+    constexpr uint16_t LENGTH_BASE[29] = {
+        3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+        35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+    constexpr uint8_t LENGTH_EXTRA[29] = {
+        0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+        3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+    constexpr uint16_t DISTANCE_BASE[30] = {
+        1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+        257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+    constexpr uint8_t DISTANCE_EXTRA[30] = {
+        0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+        7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+    constexpr uint8_t CODE_LENGTH_ORDER[19] = {
+        16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+    // Canonical Huffman code as DEFLATE sends it, least significant bit first. Codes up to
+    // INFLATE_FAST_BITS long are looked up in one step; longer ones are walked a bit at a time.
+    struct InflateTable
+    {
+        uint16_t fast[1 << INFLATE_FAST_BITS]; // symbol << 4 | length, 0 for longer codes
+        uint16_t counts[16];                   // codes of each length
+        uint16_t symbols[288];                 // ordered by code
+    };
+
+    ui32 reverseBits(ui32 code, ui32 length)
+    {
+        ui32 reversed = 0;
+        for (ui32 i = 0; i < length; ++i)
+        {
+            reversed = (reversed << 1) | ((code >> i) & 1);
+        }
+        return reversed;
+    }
+
+    bool buildInflateTable(InflateTable& table, const uint8_t* lengths, ui32 count)
+    {
+        std::memset(table.counts, 0, sizeof(table.counts));
+        std::memset(table.fast, 0, sizeof(table.fast));
+        for (ui32 i = 0; i < count; ++i)
+        {
+            table.counts[lengths[i]]++;
+        }
+        table.counts[0] = 0;
+
+        // Over-subscribed sets cannot be decoded; incomplete ones are legal (a lone distance code)
+        i32 left = 1;
+        for (ui32 length = 1; length < 16; ++length)
+        {
+            left = (left << 1) - table.counts[length];
+            if (left < 0)
+                return false;
+        }
+
+        uint16_t offsets[16] = {};
+        for (ui32 length = 1; length < 15; ++length)
+        {
+            offsets[length + 1] = offsets[length] + table.counts[length];
+        }
+        for (ui32 i = 0; i < count; ++i)
+        {
+            if (lengths[i])
+                table.symbols[offsets[lengths[i]]++] = static_cast<uint16_t>(i);
+        }
+
+        ui32 code = 0;
+        ui32 index = 0;
+        for (ui32 length = 1; length <= INFLATE_FAST_BITS; ++length)
+        {
+            for (ui32 i = 0; i < table.counts[length]; ++i, ++code, ++index)
+            {
+                uint16_t entry = static_cast<uint16_t>(table.symbols[index] << 4 | length);
+                for (ui32 fill = reverseBits(code, length); fill < (1u << INFLATE_FAST_BITS); fill += 1u << length)
+                {
+                    table.fast[fill] = entry;
+                }
+            }
+            code <<= 1;
+        }
+        return true;
+    }
+
+    struct InflateBits
+    {
+        const unsigned char* next = nullptr;
+        const unsigned char* end = nullptr;
+        ui64 bits = 0;
+        ui32 count = 0;
+        ui32 padding = 0; // zero bytes supplied past the end
+
+        void refill()
+        {
+            while (count <= 56)
+            {
+                ui64 byte = 0;
+                if (next < end)
+                    byte = *next++;
+                else
+                    ++padding;
+                bits |= byte << count;
+                count += 8;
+            }
+        }
+
+        ui32 read(ui32 n)
+        {
+            if (count < n)
+                refill();
+            ui32 value = static_cast<ui32>(bits & ((1ull << n) - 1));
+            bits >>= n;
+            count -= n;
+            return value;
+        }
+
+        bool isOverrun() const
+        {
+            return ui64(padding) * 8 > count;
+        }
+    };
+
+    i32 decodeSymbol(InflateBits& in, const InflateTable& table)
+    {
+        if (in.count < 16)
+            in.refill();
+
+        ui32 entry = table.fast[in.bits & ((1u << INFLATE_FAST_BITS) - 1)];
+        if (entry)
+        {
+            ui32 length = entry & 15;
+            in.bits >>= length;
+            in.count -= length;
+            return static_cast<i32>(entry >> 4);
+        }
+
+        i32 code = 0;
+        i32 first = 0;
+        i32 index = 0;
+        for (ui32 length = 1; length < 16; ++length)
+        {
+            code |= static_cast<i32>(in.bits & 1);
+            in.bits >>= 1;
+            in.count--;
+
+            i32 count = table.counts[length];
+            if (code - first < count)
+                return table.symbols[index + code - first];
+            index += count;
+            first = (first + count) << 1;
+            code <<= 1;
+        }
+        return -1;
+    }
+
+    bool readDynamicTables(InflateBits& in, InflateTable& literals, InflateTable& distances, std::string& error)
+    {
+        ui32 literalCount = in.read(5) + 257;
+        ui32 distanceCount = in.read(5) + 1;
+        ui32 codeLengthCount = in.read(4) + 4;
+        if (literalCount > 286 || distanceCount > 30)
+            return fail(error, "PNG: bad DEFLATE table sizes");
+
+        uint8_t codeLengthLengths[19] = {};
+        for (ui32 i = 0; i < codeLengthCount; ++i)
+        {
+            codeLengthLengths[CODE_LENGTH_ORDER[i]] = static_cast<uint8_t>(in.read(3));
+        }
+        InflateTable codeLengths;
+        if (!buildInflateTable(codeLengths, codeLengthLengths, 19))
+            return fail(error, "PNG: bad DEFLATE code length code");
+
+        uint8_t lengths[286 + 30] = {};
+        ui32 total = literalCount + distanceCount;
+        for (ui32 i = 0; i < total;)
+        {
+            i32 symbol = decodeSymbol(in, codeLengths);
+            if (symbol < 0)
+                return fail(error, "PNG: bad DEFLATE code length");
+
+            if (symbol < 16)
+            {
+                lengths[i++] = static_cast<uint8_t>(symbol);
+                continue;
+            }
+
+            uint8_t repeated = 0;
+            ui32 repeat = 0;
+            if (symbol == 16)
+            {
+                if (i == 0)
+                    return fail(error, "PNG: DEFLATE repeat without a length");
+                repeated = lengths[i - 1];
+                repeat = 3 + in.read(2);
+            }
+            else if (symbol == 17)
+            {
+                repeat = 3 + in.read(3);
+            }
+            else
+            {
+                repeat = 11 + in.read(7);
+            }
+            if (i + repeat > total)
+                return fail(error, "PNG: DEFLATE code lengths overflow");
+            std::fill(lengths + i, lengths + i + repeat, repeated);
+            i += repeat;
+        }
+
+        if (lengths[256] == 0)
+            return fail(error, "PNG: DEFLATE block without an end code");
+        if (!buildInflateTable(literals, lengths, literalCount) ||
+            !buildInflateTable(distances, lengths + literalCount, distanceCount))
+            return fail(error, "PNG: bad DEFLATE code");
+        return true;
+    }
+
+    void buildFixedTables(InflateTable& literals, InflateTable& distances)
+    {
+        uint8_t lengths[288];
+        std::fill(lengths, lengths + 144, uint8_t(8));
+        std::fill(lengths + 144, lengths + 256, uint8_t(9));
+        std::fill(lengths + 256, lengths + 280, uint8_t(7));
+        std::fill(lengths + 280, lengths + 288, uint8_t(8));
+        buildInflateTable(literals, lengths, 288);
+
+        std::fill(lengths, lengths + 30, uint8_t(5));
+        buildInflateTable(distances, lengths, 30);
+    }
+
+    // Inflates a zlib stream into exactly expectedSize bytes
+    bool inflateZlib(const unsigned char* data, size_t size, std::vector<unsigned char>& out, size_t expectedSize, std::string& error)
+    {
+        if (size < 2 || (data[0] & 15) != 8 || ((data[0] << 8) | data[1]) % 31 != 0 || (data[1] & 32))
+            return fail(error, "PNG: bad zlib header");
+
+        InflateBits in;
+        in.next = data + 2;
+        in.end = data + size;
+
+        out.resize(expectedSize);
+        unsigned char* output = out.data();
+        size_t position = 0;
+
+        InflateTable literals;
+        InflateTable distances;
+        bool isLast = false;
+        while (!isLast)
+        {
+            isLast = in.read(1) != 0;
+            ui32 type = in.read(2);
+
+            if (type == 0)
+            {
+                // Stored: byte aligned, then the length and its complement
+                in.read(in.count & 7);
+                ui32 length = in.read(16);
+                ui32 complement = in.read(16);
+                if ((length ^ 0xFFFF) != complement)
+                    return fail(error, "PNG: bad stored DEFLATE block");
+                if (length > expectedSize - position)
+                    return fail(error, "PNG: more image data than expected");
+                for (ui32 i = 0; i < length; ++i)
+                {
+                    output[position++] = static_cast<unsigned char>(in.read(8));
+                }
+                if (in.isOverrun())
+                    return fail(error, "PNG: truncated image data");
+                continue;
+            }
+
+            if (type == 1)
+            {
+                buildFixedTables(literals, distances);
+            }
+            else if (type == 2)
+            {
+                if (!readDynamicTables(in, literals, distances, error))
+                    return false;
+            }
+            else
+            {
+                return fail(error, "PNG: bad DEFLATE block type");
+            }
+
+            while (true)
+            {
+                i32 symbol = decodeSymbol(in, literals);
+                if (symbol < 256)
+                {
+                    if (symbol < 0)
+                        return fail(error, "PNG: bad DEFLATE code");
+                    if (position == expectedSize)
+                        return fail(error, "PNG: more image data than expected");
+                    output[position++] = static_cast<unsigned char>(symbol);
+                    continue;
+                }
+                if (symbol == 256)
+                    break;
+
+                symbol -= 257;
+                if (symbol >= 29)
+                    return fail(error, "PNG: bad DEFLATE length");
+                ui32 length = LENGTH_BASE[symbol] + in.read(LENGTH_EXTRA[symbol]);
+
+                i32 distanceSymbol = decodeSymbol(in, distances);
+                if (distanceSymbol < 0 || distanceSymbol >= 30)
+                    return fail(error, "PNG: bad DEFLATE distance");
+                ui32 distance = DISTANCE_BASE[distanceSymbol] + in.read(DISTANCE_EXTRA[distanceSymbol]);
+
+                if (distance > position || length > expectedSize - position || in.isOverrun())
+                    return fail(error, "PNG: corrupt image data");
+
+                // Byte by byte: the source may overlap what is being written
+                unsigned char* target = output + position;
+                const unsigned char* source = target - distance;
+                for (ui32 i = 0; i < length; ++i)
+                {
+                    target[i] = source[i];
+                }
+                position += length;
+            }
+
+            if (in.isOverrun())
+                return fail(error, "PNG: truncated image data");
+        }
+
+        if (position != expectedSize)
+            return fail(error, "PNG: not enough image data");
+        return true;
+    }
+
+    // ---------------------------------------------------------------------------------------
+    // PNG
+
+    constexpr unsigned char PNG_SIGNATURE[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+
+    // Adam7 passes: first column and row, then the spacing of columns and rows
+    constexpr ui32 ADAM7[7][4] = {
+        { 0, 0, 8, 8 }, { 4, 0, 8, 8 }, { 0, 4, 4, 8 }, { 2, 0, 4, 4 },
+        { 0, 2, 2, 4 }, { 1, 0, 2, 2 }, { 0, 1, 1, 2 } };
+
+    struct PngInfo
+    {
+        ui32 width = 0;
+        ui32 height = 0;
+        ui32 bitDepth = 0;
+        ui32 colorType = 0;
+        ui32 channels = 0;
+        bool isInterlaced = false;
+
+        unsigned char palette[256][4] = {};
+        ui32 paletteSize = 0;
+
+        // Transparent colour of greyscale and truecolour images, at full sample precision
+        bool hasColorKey = false;
+        ui32 colorKey[3] = {};
+
+        ui32 getRowBytes(ui32 columns) const
+        {
+            return static_cast<ui32>((ui64(columns) * channels * bitDepth + 7) / 8);
+        }
+
+        ui32 getPixelBytes() const
+        {
+            return std::max(1u, channels * bitDepth / 8);
+        }
+    };
+
+    ui32 paeth(ui32 a, ui32 b, ui32 c)
+    {
+        i32 p = static_cast<i32>(a + b) - static_cast<i32>(c);
+        i32 pa = std::abs(p - static_cast<i32>(a));
+        i32 pb = std::abs(p - static_cast<i32>(b));
+        i32 pc = std::abs(p - static_cast<i32>(c));
+        if (pa <= pb && pa <= pc)
+            return a;
+        return pb <= pc ? b : c;
+    }
+
+    // Rows of a filter byte followed by rowBytes of data, unfiltered in place
+    bool unfilterRows(unsigned char* data, ui32 rowBytes, ui32 rows, ui32 pixelBytes, std::string& error)
+    {
+        const unsigned char* previous = nullptr;
+        for (ui32 y = 0; y < rows; ++y)
+        {
+            unsigned char* row = data + size_t(y) * (rowBytes + 1);
+            ui32 filter = row[0];
+            unsigned char* current = row + 1;
+
+            switch (filter)
+            {
+            case 0:
+                break;
+            case 1:
+                for (ui32 i = pixelBytes; i < rowBytes; ++i)
+                    current[i] = static_cast<unsigned char>(current[i] + current[i - pixelBytes]);
+                break;
+            case 2:
+                if (previous)
+                {
+                    for (ui32 i = 0; i < rowBytes; ++i)
+                        current[i] = static_cast<unsigned char>(current[i] + previous[i]);
+                }
+                break;
+            case 3:
+                for (ui32 i = 0; i < rowBytes; ++i)
+                {
+                    ui32 left = i >= pixelBytes ? current[i - pixelBytes] : 0;
+                    ui32 up = previous ? previous[i] : 0;
+                    current[i] = static_cast<unsigned char>(current[i] + ((left + up) >> 1));
+                }
+                break;
+            case 4:
+                for (ui32 i = 0; i < rowBytes; ++i)
+                {
+                    ui32 left = i >= pixelBytes ? current[i - pixelBytes] : 0;
+                    ui32 up = previous ? previous[i] : 0;
+                    ui32 upLeft = previous && i >= pixelBytes ? previous[i - pixelBytes] : 0;
+                    current[i] = static_cast<unsigned char>(current[i] + paeth(left, up, upLeft));
+                }
+                break;
+            default:
+                return fail(error, "PNG: bad row filter");
+            }
+            previous = current;
+        }
+        return true;
+    }
+
+    ui32 readSample(const unsigned char* row, ui32 index, ui32 bitDepth)
+    {
+        switch (bitDepth)
+        {
+        case 8:
+            return row[index];
+        case 16:
+            return readBigEndian16(row + index * 2);
+        default:
+        {
+            ui32 bit = index * bitDepth;
+            return (row[bit >> 3] >> (8 - bitDepth - (bit & 7))) & ((1u << bitDepth) - 1);
+        }
+        }
+    }
+
+    // An unfiltered row of width pixels to RGBA, writing every stride-th pixel of out
+    void expandPngRow(const PngInfo& png, const unsigned char* row, ui32 width, unsigned char* out, ui32 stride)
+    {
+        ui32 depth = png.bitDepth;
+        ui32 maxSample = (1u << depth) - 1;
+
+        // Greyscale below 8 bits is scaled up to the full range; palette indices are not
+        auto toByte = [depth, maxSample](ui32 sample)
+            {
+                return static_cast<unsigned char>(depth == 16 ? sample >> 8 : sample * 255 / maxSample);
+            };
+
+        for (ui32 x = 0; x < width; ++x, out += stride * 4)
+        {
+            switch (png.colorType)
+            {
+            case 0:
+            {
+                ui32 grey = readSample(row, x, depth);
+                out[0] = out[1] = out[2] = toByte(grey);
+                out[3] = png.hasColorKey && grey == png.colorKey[0] ? 0 : 255;
+                break;
+            }
+            case 2:
+            {
+                ui32 r = readSample(row, x * 3, depth);
+                ui32 g = readSample(row, x * 3 + 1, depth);
+                ui32 b = readSample(row, x * 3 + 2, depth);
+                out[0] = toByte(r);
+                out[1] = toByte(g);
+                out[2] = toByte(b);
+                out[3] = png.hasColorKey && r == png.colorKey[0] && g == png.colorKey[1] && b == png.colorKey[2] ? 0 : 255;
+                break;
+            }
+            case 3:
+            {
+                // Indices past the palette read as opaque black, as most decoders do
+                ui32 index = readSample(row, x, depth);
+                static const unsigned char BLACK[4] = { 0, 0, 0, 255 };
+                std::memcpy(out, index < png.paletteSize ? png.palette[index] : BLACK, 4);
+                break;
+            }
+            case 4:
+                out[0] = out[1] = out[2] = toByte(readSample(row, x * 2, depth));
+                out[3] = toByte(readSample(row, x * 2 + 1, depth));
+                break;
+            default:
+                for (ui32 c = 0; c < 4; ++c)
+                    out[c] = toByte(readSample(row, x * 4 + c, depth));
+                break;
+            }
+        }
+    }
+
+    bool readPngHeader(const unsigned char* chunk, ui32 length, PngInfo& png, std::string& error)
+    {
+        if (length < 13)
+            return fail(error, "PNG: bad IHDR");
+
+        png.width = readBigEndian32(chunk);
+        png.height = readBigEndian32(chunk + 4);
+        png.bitDepth = chunk[8];
+        png.colorType = chunk[9];
+        png.isInterlaced = chunk[12] == 1;
+        if (chunk[10] != 0 || chunk[11] != 0 || chunk[12] > 1)
+            return fail(error, "PNG: unknown compression, filter or interlace method");
+        if (png.width == 0 || png.height == 0 || ui64(png.width) * png.height > MAX_IMAGE_PIXELS)
+            return fail(error, "PNG: bad image size");
+
+        bool isValidDepth = false;
+        switch (png.colorType)
+        {
+        case 0:
+            png.channels = 1;
+            isValidDepth = png.bitDepth == 1 || png.bitDepth == 2 || png.bitDepth == 4 || png.bitDepth == 8 || png.bitDepth == 16;
+            break;
+        case 3:
+            png.channels = 1;
+            isValidDepth = png.bitDepth == 1 || png.bitDepth == 2 || png.bitDepth == 4 || png.bitDepth == 8;
+            break;
+        case 2:
+            png.channels = 3;
+            isValidDepth = png.bitDepth == 8 || png.bitDepth == 16;
+            break;
+        case 4:
+            png.channels = 2;
+            isValidDepth = png.bitDepth == 8 || png.bitDepth == 16;
+            break;
+        case 6:
+            png.channels = 4;
+            isValidDepth = png.bitDepth == 8 || png.bitDepth == 16;
+            break;
+        default:
+            break;
+        }
+        if (!isValidDepth)
+            return fail(error, "PNG: bad colour type or bit depth");
+        return true;
+    }
+
+    bool decodePng(const unsigned char* data, size_t size, DecodedImage& image, std::string& error)
+    {
+        PngInfo png;
+        bool hasHeader = false;
+        std::vector<unsigned char> compressed;
+
+        size_t position = sizeof(PNG_SIGNATURE);
+        while (position + 12 <= size)
+        {
+            ui32 length = readBigEndian32(data + position);
+            const unsigned char* type = data + position + 4;
+            const unsigned char* chunk = data + position + 8;
+            if (length > size - position - 12)
+                return fail(error, "PNG: truncated chunk");
+
+            if (std::memcmp(type, "IHDR", 4) == 0)
+            {
+                if (!readPngHeader(chunk, length, png, error))
+                    return false;
+                hasHeader = true;
+            }
+            else if (std::memcmp(type, "PLTE", 4) == 0)
+            {
+                png.paletteSize = std::min(length / 3, 256u);
+                for (ui32 i = 0; i < png.paletteSize; ++i)
+                {
+                    png.palette[i][0] = chunk[i * 3];
+                    png.palette[i][1] = chunk[i * 3 + 1];
+                    png.palette[i][2] = chunk[i * 3 + 2];
+                    png.palette[i][3] = 255;
+                }
+            }
+            else if (std::memcmp(type, "tRNS", 4) == 0)
+            {
+                if (png.colorType == 3)
+                {
+                    for (ui32 i = 0; i < std::min(length, 256u); ++i)
+                        png.palette[i][3] = chunk[i];
+                }
+                else if (png.colorType == 0 && length >= 2)
+                {
+                    png.hasColorKey = true;
+                    png.colorKey[0] = readBigEndian16(chunk);
+                }
+                else if (png.colorType == 2 && length >= 6)
+                {
+                    png.hasColorKey = true;
+                    for (ui32 c = 0; c < 3; ++c)
+                        png.colorKey[c] = readBigEndian16(chunk + c * 2);
+                }
+            }
+            else if (std::memcmp(type, "IDAT", 4) == 0)
+            {
+                compressed.insert(compressed.end(), chunk, chunk + length);
+            }
+            else if (std::memcmp(type, "IEND", 4) == 0)
+            {
+                break;
+            }
+
+            position += size_t(length) + 12;
+        }
+
+        if (!hasHeader || compressed.empty())
+            return fail(error, "PNG: missing IHDR or IDAT");
+        if (png.colorType == 3 && png.paletteSize == 0)
+            return fail(error, "PNG: missing palette");
+
+        // Passes with no pixels have no rows, not even filter bytes
+        ui32 passCount = png.isInterlaced ? 7 : 1;
+        ui32 passWidths[7] = {};
+        ui32 passHeights[7] = {};
+        size_t rawSize = 0;
+        for (ui32 pass = 0; pass < passCount; ++pass)
+        {
+            const ui32* layout = png.isInterlaced ? ADAM7[pass] : ADAM7[0];
+            passWidths[pass] = png.isInterlaced ? (png.width - std::min(png.width, layout[0]) + layout[2] - 1) / layout[2] : png.width;
+            passHeights[pass] = png.isInterlaced ? (png.height - std::min(png.height, layout[1]) + layout[3] - 1) / layout[3] : png.height;
+            if (passWidths[pass] && passHeights[pass])
+                rawSize += size_t(passHeights[pass]) * (png.getRowBytes(passWidths[pass]) + 1);
+        }
+
+        std::vector<unsigned char> raw;
+        if (!inflateZlib(compressed.data(), compressed.size(), raw, rawSize, error))
+            return false;
+
+        image.width = png.width;
+        image.height = png.height;
+        image.pixels.assign(size_t(png.width) * png.height * 4, 0);
+
+        unsigned char* passData = raw.data();
+        for (ui32 pass = 0; pass < passCount; ++pass)
+        {
+            ui32 width = passWidths[pass];
+            ui32 height = passHeights[pass];
+            if (!width || !height)
+                continue;
+
+            ui32 rowBytes = png.getRowBytes(width);
+            if (!unfilterRows(passData, rowBytes, height, png.getPixelBytes(), error))
+                return false;
+
+            const ui32* layout = png.isInterlaced ? ADAM7[pass] : nullptr;
+            for (ui32 y = 0; y < height; ++y)
+            {
+                const unsigned char* row = passData + size_t(y) * (rowBytes + 1) + 1;
+                ui32 targetY = layout ? layout[1] + y * layout[3] : y;
+                ui32 targetX = layout ? layout[0] : 0;
+                ui32 stride = layout ? layout[2] : 1;
+                expandPngRow(png, row, width, &image.pixels[(size_t(targetY) * png.width + targetX) * 4], stride);
+            }
+            passData += size_t(height) * (rowBytes + 1);
+        }
+        return true;
+    }
+
+    // ---------------------------------------------------------------------------------------
+    // JPEG (ITU T.81): baseline and progressive Huffman, 8-bit samples
+
+    constexpr ui32 JPEG_FAST_BITS = 9;
+
+    // Natural (row-major) position of each coefficient in zigzag order
+    constexpr uint8_t ZIGZAG[64] = {
+        0, 1, 8, 16, 9, 2, 3, 10, 17, 24, 32, 25, 18, 11, 4, 5,
+        12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13, 6, 7, 14, 21, 28,
+        35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+        58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63 };
+
+    // Canonical Huffman code sent most significant bit first
+    struct JpegHuffman
+    {
+        uint16_t fast[1 << JPEG_FAST_BITS]; // length << 8 | symbol, 0 for longer codes
+        i32 maxCode[17];                    // largest code of each length, -1 if there are none
+        i32 valueOffset[17];                // index into values of each length's codes, minus its first code
+        uint8_t values[256];
+        bool isDefined = false;
+    };
+
+    struct JpegBits
+    {
+        const unsigned char* next = nullptr;
+        const unsigned char* end = nullptr;
+        ui64 bits = 0; // left aligned
+        i32 count = 0;
+        bool isAtMarker = false;
+
+        // Stuffed zero bytes after 0xFF are dropped; at a marker the data reads as zeros
+        void ensure(i32 n)
+        {
+            if (count >= n)
+                return;
+            while (count <= 56)
+            {
+                ui32 byte = 0;
+                if (!isAtMarker && next < end)
+                {
+                    byte = *next;
+                    if (byte != 0xFF)
+                    {
+                        ++next;
+                    }
+                    else if (next + 1 < end && next[1] == 0)
+                    {
+                        next += 2;
+                    }
+                    else
+                    {
+                        isAtMarker = true;
+                        byte = 0;
+                    }
+                }
+                bits |= ui64(byte) << (56 - count);
+                count += 8;
+            }
+        }
+
+        ui32 read(i32 n)
+        {
+            if (n == 0)
+                return 0;
+            ensure(n);
+            ui32 value = static_cast<ui32>(bits >> (64 - n));
+            bits <<= n;
+            count -= n;
+            return value;
+        }
+
+        void reset()
+        {
+            bits = 0;
+            count = 0;
+            isAtMarker = false;
+        }
+    };
+
+    i32 extend(ui32 value, i32 bits)
+    {
+        return value < (1u << (bits - 1)) ? static_cast<i32>(value) - (1 << bits) + 1 : static_cast<i32>(value);
+    }
+
+    i32 decodeHuffman(JpegBits& in, const JpegHuffman& table)
+    {
+        in.ensure(16);
+        ui32 entry = table.fast[in.bits >> (64 - JPEG_FAST_BITS)];
+        if (entry)
+        {
+            i32 length = static_cast<i32>(entry >> 8);
+            in.bits <<= length;
+            in.count -= length;
+            return static_cast<i32>(entry & 255);
+        }
+
+        i32 code16 = static_cast<i32>(in.bits >> 48);
+        for (i32 length = JPEG_FAST_BITS + 1; length <= 16; ++length)
+        {
+            i32 code = code16 >> (16 - length);
+            if (code <= table.maxCode[length])
+            {
+                in.bits <<= length;
+                in.count -= length;
+                return table.values[table.valueOffset[length] + code];
+            }
+        }
+        return -1;
+    }
+
+    // Separable AAN inverse DCT (as libjpeg's jidctflt). The quantisation table it takes already
+    // holds the AAN scale factors and the final division by 8.
+    void inverseDct(const int16_t* coefficients, const float* quant, unsigned char* out, ui32 stride)
+    {
+        float workspace[64];
+        for (ui32 column = 0; column < 8; ++column)
+        {
+            const int16_t* in = coefficients + column;
+            const float* q = quant + column;
+            float* ws = workspace + column;
+
+            if (!(in[8] | in[16] | in[24] | in[32] | in[40] | in[48] | in[56]))
+            {
+                float dc = in[0] * q[0];
+                for (ui32 row = 0; row < 8; ++row)
+                    ws[row * 8] = dc;
+                continue;
+            }
+
+            float tmp0 = in[0] * q[0];
+            float tmp1 = in[16] * q[16];
+            float tmp2 = in[32] * q[32];
+            float tmp3 = in[48] * q[48];
+
+            float tmp10 = tmp0 + tmp2;
+            float tmp11 = tmp0 - tmp2;
+            float tmp13 = tmp1 + tmp3;
+            float tmp12 = (tmp1 - tmp3) * 1.414213562f - tmp13;
+
+            tmp0 = tmp10 + tmp13;
+            tmp3 = tmp10 - tmp13;
+            tmp1 = tmp11 + tmp12;
+            tmp2 = tmp11 - tmp12;
+
+            float tmp4 = in[8] * q[8];
+            float tmp5 = in[24] * q[24];
+            float tmp6 = in[40] * q[40];
+            float tmp7 = in[56] * q[56];
+
+            float z13 = tmp6 + tmp5;
+            float z10 = tmp6 - tmp5;
+            float z11 = tmp4 + tmp7;
+            float z12 = tmp4 - tmp7;
+
+            tmp7 = z11 + z13;
+            tmp11 = (z11 - z13) * 1.414213562f;
+            float z5 = (z10 + z12) * 1.847759065f;
+            tmp10 = z12 * 1.082392200f - z5;
+            tmp12 = z10 * -2.613125930f + z5;
+
+            tmp6 = tmp12 - tmp7;
+            tmp5 = tmp11 - tmp6;
+            tmp4 = tmp10 + tmp5;
+
+            ws[0] = tmp0 + tmp7;
+            ws[56] = tmp0 - tmp7;
+            ws[8] = tmp1 + tmp6;
+            ws[48] = tmp1 - tmp6;
+            ws[16] = tmp2 + tmp5;
+            ws[40] = tmp2 - tmp5;
+            ws[32] = tmp3 + tmp4;
+            ws[24] = tmp3 - tmp4;
+        }
+
+        for (ui32 row = 0; row < 8; ++row, out += stride)
+        {
+            const float* ws = workspace + row * 8;
+
+            float tmp10 = ws[0] + ws[4];
+            float tmp11 = ws[0] - ws[4];
+            float tmp13 = ws[2] + ws[6];
+            float tmp12 = (ws[2] - ws[6]) * 1.414213562f - tmp13;
+
+            float tmp0 = tmp10 + tmp13;
+            float tmp3 = tmp10 - tmp13;
+            float tmp1 = tmp11 + tmp12;
+            float tmp2 = tmp11 - tmp12;
+
+            float z13 = ws[5] + ws[3];
+            float z10 = ws[5] - ws[3];
+            float z11 = ws[1] + ws[7];
+            float z12 = ws[1] - ws[7];
+
+            float tmp7 = z11 + z13;
+            tmp11 = (z11 - z13) * 1.414213562f;
+            float z5 = (z10 + z12) * 1.847759065f;
+            tmp10 = z12 * 1.082392200f - z5;
+            tmp12 = z10 * -2.613125930f + z5;
+
+            float tmp6 = tmp12 - tmp7;
+            float tmp5 = tmp11 - tmp6;
+            float tmp4 = tmp10 + tmp5;
+
+            // Level shift back to unsigned, rounding to nearest
+            out[0] = clampByte(static_cast<i32>(tmp0 + tmp7 + 128.5f));
+            out[7] = clampByte(static_cast<i32>(tmp0 - tmp7 + 128.5f));
+            out[1] = clampByte(static_cast<i32>(tmp1 + tmp6 + 128.5f));
+            out[6] = clampByte(static_cast<i32>(tmp1 - tmp6 + 128.5f));
+            out[2] = clampByte(static_cast<i32>(tmp2 + tmp5 + 128.5f));
+            out[5] = clampByte(static_cast<i32>(tmp2 - tmp5 + 128.5f));
+            out[4] = clampByte(static_cast<i32>(tmp3 + tmp4 + 128.5f));
+            out[3] = clampByte(static_cast<i32>(tmp3 - tmp4 + 128.5f));
+        }
+    }
+
+    struct JpegComponent
+    {
+        ui32 id = 0;
+        ui32 h = 1;
+        ui32 v = 1;
+        ui32 quantTable = 0;
+        ui32 dcTable = 0;
+        ui32 acTable = 0;
+        i32 dcPredictor = 0;
+
+        // Size in samples, and in blocks both padded to whole MCUs and as a scan of this
+        // component alone covers them
+        ui32 width = 0;
+        ui32 height = 0;
+        ui32 blocksWide = 0;
+        ui32 blocksHigh = 0;
+        ui32 scanBlocksWide = 0;
+        ui32 scanBlocksHigh = 0;
+
+        std::vector<unsigned char> samples;  // blocksWide * 8 per row
+        std::vector<int16_t> coefficients;   // progressive only, 64 per block
+    };
+
+    class JpegDecoder
+    {
+    public:
+        bool decode(const unsigned char* data, size_t size, DecodedImage& image, std::string& error);
+
+    private:
+        bool readQuantTables(const unsigned char* p, ui32 length);
+        bool readHuffmanTables(const unsigned char* p, ui32 length);
+        bool readFrame(const unsigned char* p, ui32 length, bool isProgressive);
+        bool readScan(const unsigned char* header, ui32 length, const unsigned char*& data, const unsigned char* end);
+
+        bool decodeBlock(JpegBits& in, JpegComponent& component, ui32 blockX, ui32 blockY);
+        bool decodeBaselineBlock(JpegBits& in, JpegComponent& component, int16_t* coefficients);
+        bool decodeDcFirst(JpegBits& in, JpegComponent& component, int16_t* coefficients);
+        bool decodeAcFirst(JpegBits& in, JpegComponent& component, int16_t* coefficients);
+        bool decodeAcRefine(JpegBits& in, JpegComponent& component, int16_t* coefficients);
+        void restart(JpegBits& in);
+
+        void scaleQuantTable(ui32 table, float* scaled) const;
+        void finishProgressive();
+        void convert(DecodedImage& image) const;
+        void upsampleRow(const JpegComponent& component, ui32 y, std::vector<i32>& scratch, unsigned char* out) const;
+
+        bool fail(const char* message)
+        {
+            m_error = message;
+            return false;
+        }
+
+    private:
+        uint16_t m_quant[4][64] = {}; // natural order
+        float m_scaledQuant[4][64] = {}; // for inverseDct, refreshed at each baseline scan
+        JpegHuffman m_dcTables[4];
+        JpegHuffman m_acTables[4];
+
+        std::vector<JpegComponent> m_components;
+        ui32 m_width = 0;
+        ui32 m_height = 0;
+        ui32 m_maxH = 1;
+        ui32 m_maxV = 1;
+        ui32 m_mcusWide = 0;
+        ui32 m_mcusHigh = 0;
+        ui32 m_restartInterval = 0;
+        bool m_isProgressive = false;
+        i32 m_adobeTransform = -1;
+
+        // State of the scan being decoded
+        JpegComponent* m_scanComponents[4] = {};
+        ui32 m_scanComponentCount = 0;
+        ui32 m_spectralStart = 0;
+        ui32 m_spectralEnd = 63;
+        ui32 m_approximationHigh = 0;
+        ui32 m_approximationLow = 0;
+        ui32 m_eobRun = 0;
+
+        std::string m_error;
+    };
+
+    bool JpegDecoder::decode(const unsigned char* data, size_t size, DecodedImage& image, std::string& error)
+    {
+        const unsigned char* p = data + 2;
+        const unsigned char* end = data + size;
+        bool hasFrame = false;
+        bool hasScan = false;
+
+        while (p + 4 <= end)
+        {
+            if (p[0] != 0xFF)
+            {
+                ++p;
+                continue;
+            }
+            ui32 marker = p[1];
+            p += 2;
+
+            // Fill bytes, stuffed zeros left behind a scan and standalone markers
+            if (marker == 0xFF)
+            {
+                --p;
+                continue;
+            }
+            if (marker == 0x00 || marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7))
+                continue;
+            if (marker == 0xD9)
+                break;
+
+            ui32 length = readBigEndian16(p);
+            if (length < 2 || length > size_t(end - p))
+            {
+                error = "JPEG: truncated segment";
+                return false;
+            }
+            const unsigned char* segment = p + 2;
+            ui32 segmentLength = length - 2;
+
+            bool succeeded = true;
+            switch (marker)
+            {
+            case 0xC0:
+            case 0xC1:
+            case 0xC2:
+                if (hasFrame)
+                {
+                    succeeded = fail("JPEG: more than one frame");
+                    break;
+                }
+                succeeded = readFrame(segment, segmentLength, marker == 0xC2);
+                hasFrame = true;
+                break;
+            case 0xC3:
+            case 0xC5:
+            case 0xC6:
+            case 0xC7:
+            case 0xC9:
+            case 0xCA:
+            case 0xCB:
+            case 0xCD:
+            case 0xCE:
+            case 0xCF:
+                succeeded = fail("JPEG: lossless, hierarchical and arithmetic-coded files are not supported");
+                break;
+            case 0xC4:
+                succeeded = readHuffmanTables(segment, segmentLength);
+                break;
+            case 0xDB:
+                succeeded = readQuantTables(segment, segmentLength);
+                break;
+            case 0xDD:
+                if (segmentLength < 2)
+                    succeeded = fail("JPEG: bad DRI");
+                else
+                    m_restartInterval = readBigEndian16(segment);
+                break;
+            case 0xDA:
+                if (!hasFrame)
+                {
+                    succeeded = fail("JPEG: scan before frame");
+                    break;
+                }
+                p += length;
+                succeeded = readScan(segment, segmentLength, p, end);
+                hasScan = true;
+                if (!succeeded)
+                    break;
+                continue;
+            case 0xEE:
+                if (segmentLength >= 12 && std::memcmp(segment, "Adobe", 5) == 0)
+                    m_adobeTransform = segment[11];
+                break;
+            default:
+                break;
+            }
+
+            if (!succeeded)
+            {
+                error = m_error;
+                return false;
+            }
+            p += length;
+        }
+
+        if (!hasFrame || !hasScan)
+        {
+            error = "JPEG: no frame or scan";
+            return false;
+        }
+
+        if (m_isProgressive)
+            finishProgressive();
+        convert(image);
+        return true;
+    }
+
+    bool JpegDecoder::readQuantTables(const unsigned char* p, ui32 length)
+    {
+        while (length > 0)
+        {
+            ui32 precision = p[0] >> 4;
+            ui32 table = p[0] & 15;
+            ui32 entrySize = precision ? 2 : 1;
+            if (table > 3 || precision > 1 || length < 1 + 64 * entrySize)
+                return fail("JPEG: bad DQT");
+
+            for (ui32 k = 0; k < 64; ++k)
+            {
+                const unsigned char* entry = p + 1 + k * entrySize;
+                m_quant[table][ZIGZAG[k]] = static_cast<uint16_t>(precision ? readBigEndian16(entry) : entry[0]);
+            }
+            p += 1 + 64 * entrySize;
+            length -= 1 + 64 * entrySize;
+        }
+        return true;
+    }
+
+    bool JpegDecoder::readHuffmanTables(const unsigned char* p, ui32 length)
+    {
+        while (length > 0)
+        {
+            if (length < 17)
+                return fail("JPEG: bad DHT");
+            ui32 tableClass = p[0] >> 4;
+            ui32 index = p[0] & 15;
+            if (tableClass > 1 || index > 3)
+                return fail("JPEG: bad DHT");
+
+            ui32 counts[17] = {};
+            ui32 total = 0;
+            for (ui32 i = 1; i <= 16; ++i)
+            {
+                counts[i] = p[i];
+                total += counts[i];
+            }
+            if (total > 256 || length < 17 + total)
+                return fail("JPEG: bad DHT");
+
+            JpegHuffman& table = tableClass ? m_acTables[index] : m_dcTables[index];
+            std::memcpy(table.values, p + 17, total);
+            std::memset(table.fast, 0, sizeof(table.fast));
+
+            i32 code = 0;
+            i32 k = 0;
+            for (ui32 bits = 1; bits <= 16; ++bits)
+            {
+                table.valueOffset[bits] = k - code;
+                for (ui32 i = 0; i < counts[bits]; ++i, ++code, ++k)
+                {
+                    if (bits <= JPEG_FAST_BITS)
+                    {
+                        ui32 first = static_cast<ui32>(code) << (JPEG_FAST_BITS - bits);
+                        uint16_t entry = static_cast<uint16_t>(bits << 8 | table.values[k]);
+                        for (ui32 fill = 0; fill < (1u << (JPEG_FAST_BITS - bits)); ++fill)
+                            table.fast[first + fill] = entry;
+                    }
+                }
+                table.maxCode[bits] = counts[bits] ? code - 1 : -1;
+                if (code > (1 << bits))
+                    return fail("JPEG: bad Huffman table");
+                code <<= 1;
+            }
+            table.isDefined = true;
+
+            p += 17 + total;
+            length -= 17 + total;
+        }
+        return true;
+    }
+
+    bool JpegDecoder::readFrame(const unsigned char* p, ui32 length, bool isProgressive)
+    {
+        if (length < 6)
+            return fail("JPEG: bad SOF");
+        if (p[0] != 8)
+            return fail("JPEG: only 8-bit samples are supported");
+
+        m_isProgressive = isProgressive;
+        m_height = readBigEndian16(p + 1);
+        m_width = readBigEndian16(p + 3);
+        ui32 componentCount = p[5];
+        if (m_width == 0 || m_height == 0)
+            return fail("JPEG: bad image size");
+        if (componentCount != 1 && componentCount != 3)
+            return fail("JPEG: only greyscale and three-component files are supported");
+        if (length < 6 + componentCount * 3)
+            return fail("JPEG: bad SOF");
+
+        m_components.resize(componentCount);
+        for (ui32 i = 0; i < componentCount; ++i)
+        {
+            JpegComponent& component = m_components[i];
+            const unsigned char* entry = p + 6 + i * 3;
+            component.id = entry[0];
+            component.h = entry[1] >> 4;
+            component.v = entry[1] & 15;
+            component.quantTable = entry[2];
+            if (component.h < 1 || component.h > 4 || component.v < 1 || component.v > 4 || component.quantTable > 3)
+                return fail("JPEG: bad component");
+            m_maxH = std::max(m_maxH, component.h);
+            m_maxV = std::max(m_maxV, component.v);
+        }
+
+        m_mcusWide = (m_width + 8 * m_maxH - 1) / (8 * m_maxH);
+        m_mcusHigh = (m_height + 8 * m_maxV - 1) / (8 * m_maxV);
+        if (ui64(m_mcusWide) * m_mcusHigh * 64 * m_maxH * m_maxV > MAX_IMAGE_PIXELS)
+            return fail("JPEG: image too large");
+
+        for (auto& component : m_components)
+        {
+            component.width = (m_width * component.h + m_maxH - 1) / m_maxH;
+            component.height = (m_height * component.v + m_maxV - 1) / m_maxV;
+            component.blocksWide = m_mcusWide * component.h;
+            component.blocksHigh = m_mcusHigh * component.v;
+            component.scanBlocksWide = (component.width + 7) / 8;
+            component.scanBlocksHigh = (component.height + 7) / 8;
+            component.samples.assign(size_t(component.blocksWide) * component.blocksHigh * 64, 0);
+            if (m_isProgressive)
+                component.coefficients.assign(size_t(component.blocksWide) * component.blocksHigh * 64, 0);
+        }
+        return true;
+    }
+
+    bool JpegDecoder::readScan(const unsigned char* header, ui32 length, const unsigned char*& data, const unsigned char* end)
+    {
+        if (length < 1)
+            return fail("JPEG: bad SOS");
+        m_scanComponentCount = header[0];
+        if (m_scanComponentCount < 1 || m_scanComponentCount > 4 || length < 4 + m_scanComponentCount * 2)
+            return fail("JPEG: bad SOS");
+
+        for (ui32 i = 0; i < m_scanComponentCount; ++i)
+        {
+            const unsigned char* entry = header + 1 + i * 2;
+            JpegComponent* component = nullptr;
+            for (auto& candidate : m_components)
+            {
+                if (candidate.id == entry[0])
+                    component = &candidate;
+            }
+            if (!component)
+                return fail("JPEG: scan of an unknown component");
+            component->dcTable = entry[1] >> 4;
+            component->acTable = entry[1] & 15;
+            if (component->dcTable > 3 || component->acTable > 3)
+                return fail("JPEG: bad SOS");
+            component->dcPredictor = 0;
+            m_scanComponents[i] = component;
+        }
+
+        const unsigned char* selection = header + 1 + m_scanComponentCount * 2;
+        m_spectralStart = selection[0];
+        m_spectralEnd = selection[1];
+        m_approximationHigh = selection[2] >> 4;
+        m_approximationLow = selection[2] & 15;
+        m_eobRun = 0;
+
+        if (m_isProgressive)
+        {
+            bool isDcScan = m_spectralStart == 0;
+            if (m_spectralStart > 63 || m_spectralEnd > 63 || m_spectralStart > m_spectralEnd ||
+                (isDcScan && m_spectralEnd != 0) || (!isDcScan && m_scanComponentCount != 1) ||
+                m_approximationLow > 13)
+                return fail("JPEG: bad progressive scan");
+        }
+        else
+        {
+            m_spectralStart = 0;
+            m_spectralEnd = 63;
+            for (ui32 table = 0; table < 4; ++table)
+                scaleQuantTable(table, m_scaledQuant[table]);
+        }
+
+        JpegBits in;
+        in.next = data;
+        in.end = end;
+
+        // A scan of one component covers its own blocks one at a time; otherwise MCUs interleave
+        // every component's blocks
+        bool isInterleaved = m_scanComponentCount > 1;
+        ui32 unitsWide = isInterleaved ? m_mcusWide : m_scanComponents[0]->scanBlocksWide;
+        ui32 unitsHigh = isInterleaved ? m_mcusHigh : m_scanComponents[0]->scanBlocksHigh;
+        ui32 untilRestart = m_restartInterval;
+
+        for (ui32 unitY = 0; unitY < unitsHigh; ++unitY)
+        {
+            for (ui32 unitX = 0; unitX < unitsWide; ++unitX)
+            {
+                if (isInterleaved)
+                {
+                    for (ui32 i = 0; i < m_scanComponentCount; ++i)
+                    {
+                        JpegComponent& component = *m_scanComponents[i];
+                        for (ui32 y = 0; y < component.v; ++y)
+                        {
+                            for (ui32 x = 0; x < component.h; ++x)
+                            {
+                                if (!decodeBlock(in, component, unitX * component.h + x, unitY * component.v + y))
+                                    return false;
+                            }
+                        }
+                    }
+                }
+                else if (!decodeBlock(in, *m_scanComponents[0], unitX, unitY))
+                {
+                    return false;
+                }
+
+                bool isLastUnit = unitY + 1 == unitsHigh && unitX + 1 == unitsWide;
+                if (m_restartInterval && --untilRestart == 0 && !isLastUnit)
+                {
+                    restart(in);
+                    untilRestart = m_restartInterval;
+                }
+            }
+        }
+
+        data = in.next;
+        return true;
+    }
+
+    void JpegDecoder::restart(JpegBits& in)
+    {
+        // Skip whatever is left of the interval up to its RSTn marker
+        in.reset();
+        while (in.next + 1 < in.end && !(in.next[0] == 0xFF && in.next[1] >= 0xD0 && in.next[1] <= 0xD7))
+        {
+            ++in.next;
+        }
+        if (in.next + 1 < in.end)
+            in.next += 2;
+
+        for (ui32 i = 0; i < m_scanComponentCount; ++i)
+        {
+            m_scanComponents[i]->dcPredictor = 0;
+        }
+        m_eobRun = 0;
+    }
+
+    bool JpegDecoder::decodeBlock(JpegBits& in, JpegComponent& component, ui32 blockX, ui32 blockY)
+    {
+        if (!m_isProgressive)
+        {
+            int16_t coefficients[64];
+            if (!decodeBaselineBlock(in, component, coefficients))
+                return false;
+
+            ui32 stride = component.blocksWide * 8;
+            inverseDct(coefficients, m_scaledQuant[component.quantTable], &component.samples[size_t(blockY) * 8 * stride + blockX * 8], stride);
+            return true;
+        }
+
+        int16_t* coefficients = &component.coefficients[(size_t(blockY) * component.blocksWide + blockX) * 64];
+        if (m_spectralStart == 0)
+        {
+            if (m_approximationHigh == 0)
+                return decodeDcFirst(in, component, coefficients);
+            if (in.read(1))
+                coefficients[0] = static_cast<int16_t>(coefficients[0] | (1 << m_approximationLow));
+            return true;
+        }
+        return m_approximationHigh == 0 ? decodeAcFirst(in, component, coefficients) : decodeAcRefine(in, component, coefficients);
+    }
+
+    bool JpegDecoder::decodeBaselineBlock(JpegBits& in, JpegComponent& component, int16_t* coefficients)
+    {
+        const JpegHuffman& dc = m_dcTables[component.dcTable];
+        const JpegHuffman& ac = m_acTables[component.acTable];
+        if (!dc.isDefined || !ac.isDefined)
+            return fail("JPEG: scan uses an undefined Huffman table");
+
+        std::memset(coefficients, 0, 64 * sizeof(int16_t));
+
+        i32 bits = decodeHuffman(in, dc);
+        if (bits < 0 || bits > 11)
+            return fail("JPEG: bad DC code");
+        component.dcPredictor += bits ? extend(in.read(bits), bits) : 0;
+        coefficients[0] = static_cast<int16_t>(component.dcPredictor);
+
+        for (ui32 k = 1; k < 64;)
+        {
+            i32 symbol = decodeHuffman(in, ac);
+            if (symbol < 0)
+                return fail("JPEG: bad AC code");
+            ui32 run = static_cast<ui32>(symbol) >> 4;
+            i32 size = symbol & 15;
+            if (size == 0)
+            {
+                if (run != 15)
+                    break;
+                k += 16;
+                continue;
+            }
+            k += run;
+            if (k > 63)
+                return fail("JPEG: AC coefficients past the block");
+            coefficients[ZIGZAG[k++]] = static_cast<int16_t>(extend(in.read(size), size));
+        }
+        return true;
+    }
+
+    bool JpegDecoder::decodeDcFirst(JpegBits& in, JpegComponent& component, int16_t* coefficients)
+    {
+        const JpegHuffman& dc = m_dcTables[component.dcTable];
+        if (!dc.isDefined)
+            return fail("JPEG: scan uses an undefined Huffman table");
+
+        i32 bits = decodeHuffman(in, dc);
+        if (bits < 0 || bits > 11)
+            return fail("JPEG: bad DC code");
+        component.dcPredictor += bits ? extend(in.read(bits), bits) : 0;
+        coefficients[0] = static_cast<int16_t>(component.dcPredictor * (1 << m_approximationLow));
+        return true;
+    }
+
+    bool JpegDecoder::decodeAcFirst(JpegBits& in, JpegComponent& component, int16_t* coefficients)
+    {
+        if (m_eobRun)
+        {
+            --m_eobRun;
+            return true;
+        }
+
+        const JpegHuffman& ac = m_acTables[component.acTable];
+        if (!ac.isDefined)
+            return fail("JPEG: scan uses an undefined Huffman table");
+
+        for (ui32 k = m_spectralStart; k <= m_spectralEnd;)
+        {
+            i32 symbol = decodeHuffman(in, ac);
+            if (symbol < 0)
+                return fail("JPEG: bad AC code");
+            ui32 run = static_cast<ui32>(symbol) >> 4;
+            i32 size = symbol & 15;
+            if (size == 0)
+            {
+                if (run < 15)
+                {
+                    // End of band for this block and the next eobRun ones
+                    m_eobRun = (1u << run) - 1 + in.read(static_cast<i32>(run));
+                    break;
+                }
+                k += 16;
+                continue;
+            }
+            k += run;
+            if (k > 63)
+                return fail("JPEG: AC coefficients past the block");
+            coefficients[ZIGZAG[k++]] = static_cast<int16_t>(extend(in.read(size), size) * (1 << m_approximationLow));
+        }
+        return true;
+    }
+
+    bool JpegDecoder::decodeAcRefine(JpegBits& in, JpegComponent& component, int16_t* coefficients)
+    {
+        const i32 bit = 1 << m_approximationLow;
+
+        // Coefficients already non-zero get one correction bit each, in every block of the band
+        auto refine = [&in, bit](int16_t& coefficient)
+            {
+                if (in.read(1) && (coefficient & bit) == 0)
+                    coefficient = static_cast<int16_t>(coefficient >= 0 ? coefficient + bit : coefficient - bit);
+            };
+
+        ui32 k = m_spectralStart;
+        if (m_eobRun == 0)
+        {
+            const JpegHuffman& ac = m_acTables[component.acTable];
+            if (!ac.isDefined)
+                return fail("JPEG: scan uses an undefined Huffman table");
+
+            while (k <= m_spectralEnd)
+            {
+                i32 symbol = decodeHuffman(in, ac);
+                if (symbol < 0)
+                    return fail("JPEG: bad AC code");
+                ui32 run = static_cast<ui32>(symbol) >> 4;
+                i32 size = symbol & 15;
+                i32 value = 0;
+                if (size == 0)
+                {
+                    if (run < 15)
+                    {
+                        // The rest of this block is refined below as part of the run
+                        m_eobRun = (1u << run) + in.read(static_cast<i32>(run));
+                        break;
+                    }
+                }
+                else
+                {
+                    if (size != 1)
+                        return fail("JPEG: bad AC refinement");
+                    value = in.read(1) ? bit : -bit;
+                }
+
+                // Skip run zero coefficients, refining the non-zero ones passed on the way, then
+                // place the new one
+                while (k <= m_spectralEnd)
+                {
+                    int16_t& coefficient = coefficients[ZIGZAG[k++]];
+                    if (coefficient != 0)
+                    {
+                        refine(coefficient);
+                    }
+                    else if (run == 0)
+                    {
+                        coefficient = static_cast<int16_t>(value);
+                        break;
+                    }
+                    else
+                    {
+                        --run;
+                    }
+                }
+            }
+        }
+
+        if (m_eobRun > 0)
+        {
+            for (; k <= m_spectralEnd; ++k)
+            {
+                int16_t& coefficient = coefficients[ZIGZAG[k]];
+                if (coefficient != 0)
+                    refine(coefficient);
+            }
+            --m_eobRun;
+        }
+        return true;
+    }
+
+    void JpegDecoder::scaleQuantTable(ui32 table, float* scaled) const
+    {
+        // cos(k * pi / 16) * sqrt(2), with 1 for k = 0
+        static const float AAN_SCALES[8] = {
+            1.0f, 1.387039845f, 1.306562965f, 1.175875602f,
+            1.0f, 0.785694958f, 0.541196100f, 0.275899379f };
+
+        for (ui32 row = 0; row < 8; ++row)
+        {
+            for (ui32 column = 0; column < 8; ++column)
+            {
+                ui32 i = row * 8 + column;
+                scaled[i] = m_quant[table][i] * AAN_SCALES[row] * AAN_SCALES[column] * 0.125f;
+            }
+        }
+    }
+
+    void JpegDecoder::finishProgressive()
+    {
+        float quant[64];
+        for (auto& component : m_components)
+        {
+            scaleQuantTable(component.quantTable, quant);
+            ui32 stride = component.blocksWide * 8;
+            for (ui32 blockY = 0; blockY < component.blocksHigh; ++blockY)
+            {
+                for (ui32 blockX = 0; blockX < component.blocksWide; ++blockX)
+                {
+                    const int16_t* coefficients = &component.coefficients[(size_t(blockY) * component.blocksWide + blockX) * 64];
+                    inverseDct(coefficients, quant, &component.samples[size_t(blockY) * 8 * stride + blockX * 8], stride);
+                }
+            }
+            component.coefficients = std::vector<int16_t>();
+        }
+    }
+
+    // One row of a component at full image resolution. Components subsampled by two are
+    // interpolated between sample centres (libjpeg's "fancy" upsampling); other factors repeat samples.
+    void JpegDecoder::upsampleRow(const JpegComponent& component, ui32 y, std::vector<i32>& scratch, unsigned char* out) const
+    {
+        ui32 stride = component.blocksWide * 8;
+        ui32 factorX = m_maxH / component.h;
+        ui32 factorY = m_maxV / component.v;
+        bool isFancy = m_maxH % component.h == 0 && m_maxV % component.v == 0 && factorX <= 2 && factorY <= 2;
+
+        if (!isFancy)
+        {
+            const unsigned char* row = &component.samples[size_t(y * component.v / m_maxV) * stride];
+            for (ui32 x = 0; x < m_width; ++x)
+                out[x] = row[x * component.h / m_maxH];
+            return;
+        }
+
+        // Vertical pass into scratch at four times the sample scale
+        const unsigned char* nearRow = &component.samples[size_t(y / factorY) * stride];
+        scratch.resize(component.width);
+        if (factorY == 2)
+        {
+            ui32 nearY = y / 2;
+            ui32 farY = (y & 1) ? std::min(nearY + 1, component.height - 1) : (nearY ? nearY - 1 : 0);
+            const unsigned char* farRow = &component.samples[size_t(farY) * stride];
+            for (ui32 x = 0; x < component.width; ++x)
+                scratch[x] = 3 * nearRow[x] + farRow[x];
+        }
+        else
+        {
+            for (ui32 x = 0; x < component.width; ++x)
+                scratch[x] = 4 * nearRow[x];
+        }
+
+        if (factorX == 2)
+        {
+            for (ui32 x = 0; x < m_width; ++x)
+            {
+                ui32 nearX = x / 2;
+                ui32 farX = (x & 1) ? std::min(nearX + 1, component.width - 1) : (nearX ? nearX - 1 : 0);
+                out[x] = static_cast<unsigned char>((3 * scratch[nearX] + scratch[farX] + 8) >> 4);
+            }
+        }
+        else
+        {
+            for (ui32 x = 0; x < m_width; ++x)
+                out[x] = static_cast<unsigned char>((scratch[x] + 2) >> 2);
+        }
+    }
+
+    void JpegDecoder::convert(DecodedImage& image) const
+    {
+        image.width = m_width;
+        image.height = m_height;
+        image.pixels.resize(size_t(m_width) * m_height * 4);
+
+        if (m_components.size() == 1)
+        {
+            const JpegComponent& grey = m_components[0];
+            ui32 stride = grey.blocksWide * 8;
+            for (ui32 y = 0; y < m_height; ++y)
+            {
+                const unsigned char* row = &grey.samples[size_t(y) * stride];
+                unsigned char* out = &image.pixels[size_t(y) * m_width * 4];
+                for (ui32 x = 0; x < m_width; ++x, out += 4)
+                {
+                    out[0] = out[1] = out[2] = row[x];
+                    out[3] = 255;
+                }
+            }
+            return;
+        }
+
+        // Adobe's transform flag, or components named R, G and B, mark files stored as RGB
+        bool isRgb = m_adobeTransform == 0 ||
+            (m_components[0].id == 'R' && m_components[1].id == 'G' && m_components[2].id == 'B');
+
+        std::vector<unsigned char> rows[3];
+        std::vector<i32> scratch;
+        for (auto& row : rows)
+            row.resize(m_width);
+
+        for (ui32 y = 0; y < m_height; ++y)
+        {
+            for (ui32 c = 0; c < 3; ++c)
+                upsampleRow(m_components[c], y, scratch, rows[c].data());
+
+            unsigned char* out = &image.pixels[size_t(y) * m_width * 4];
+            for (ui32 x = 0; x < m_width; ++x, out += 4)
+            {
+                i32 luma = rows[0][x];
+                i32 cb = rows[1][x];
+                i32 cr = rows[2][x];
+                if (isRgb)
+                {
+                    out[0] = static_cast<unsigned char>(luma);
+                    out[1] = static_cast<unsigned char>(cb);
+                    out[2] = static_cast<unsigned char>(cr);
+                }
+                else
+                {
+                    // ITU-R BT.601 full range, in 16.16 fixed point
+                    cb -= 128;
+                    cr -= 128;
+                    out[0] = clampByte(luma + ((91881 * cr + 32768) >> 16));
+                    out[1] = clampByte(luma - ((22554 * cb + 46802 * cr - 32768) >> 16));
+                    out[2] = clampByte(luma + ((116130 * cb + 32768) >> 16));
+                }
+                out[3] = 255;
+            }
+        }
+    }
+}
+
+bool dx3d::decodeImage(const void* data, size_t size, DecodedImage& image, std::string& error)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    if (size >= sizeof(PNG_SIGNATURE) && std::memcmp(bytes, PNG_SIGNATURE, sizeof(PNG_SIGNATURE)) == 0)
+    {
+        return decodePng(bytes, size, image, error);
+    }
+    if (size >= 4 && bytes[0] == 0xFF && bytes[1] == 0xD8)
+    {
+        JpegDecoder decoder;
+        return decoder.decode(bytes, size, image, error);
+    }
+    return fail(error, "Unrecognised image format");
+}
+
+bool dx3d::decodeImageFile(const std::string& path, DecodedImage& image, std::string& error)
+{
+    MappedFile file;
+    if (!file.open(path))
+    {
+        error = "Cannot open " + path;
+        return false;
+    }
+    if (decodeImage(file.getData(), file.getSize(), image, error))
+    {
+        return true;
+    }
+
+    std::string decoderError = error;
+    if (decodePlatformImageFile(path, image, error))
+    {
+        return true;
+    }
+    error = decoderError;
+    return false;
+}
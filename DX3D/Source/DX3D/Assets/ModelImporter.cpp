@@ -0,0 +1,222 @@
+#include <DX3D/Assets/ModelImporter.h>
+#include <DX3D/Assets/ObjParser.h>
+#include <DX3D/Graphics/MeshOptimizer.h>
+#include <DX3D/Core/JobSystem.h>
+#include <chrono>
+#include <cstdio>
+#include <unordered_map>
+
+using namespace dx3d;
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Meshes of at least MIN_REPORTED_LOD_TRIANGLES that end up with fewer levels than this are
+    // reported, since they draw at full or near-full detail however far away they are. Smaller
+    // ones, like quads and boxes, have nothing to simplify.
+    constexpr size_t MIN_EXPECTED_MESH_LODS = 3;
+    constexpr ui32 MIN_REPORTED_LOD_TRIANGLES = 256;
+
+    // OBJ corners refer to separate position, normal and uv lists; corners with the same
+    // three indices are the same vertex
+    struct CornerKey
+    {
+        int position;
+        int normal;
+        int texCoord;
+
+        bool operator==(const CornerKey& other) const
+        {
+            return position == other.position && normal == other.normal && texCoord == other.texCoord;
+        }
+    };
+
+    struct CornerKeyHash
+    {
+        size_t operator()(const CornerKey& key) const
+        {
+            return static_cast<size_t>(key.position) * 73856093u ^ static_cast<size_t>(key.normal) * 19349663u ^
+                static_cast<size_t>(key.texCoord) * 83492791u;
+        }
+    };
+
+    void importShape(const tinyobj::attrib_t& attrib, const tinyobj::shape_t& shape, ImportedMesh& mesh)
+    {
+        std::vector<Vertex>& vertices = mesh.vertices;
+        std::vector<ui32> indices;
+        std::unordered_map<CornerKey, ui32, CornerKeyHash> cornerVertices;
+        cornerVertices.reserve(shape.mesh.indices.size());
+
+        size_t index_offset = 0;
+        for (size_t f = 0; f < shape.mesh.num_face_vertices.size(); f++) {
+            int fv = shape.mesh.num_face_vertices[f];
+
+            if (fv < 3) continue;
+
+            for (int v = 0; v < fv; v++) {
+                if (index_offset + v >= shape.mesh.indices.size()) {
+                    continue;
+                }
+
+                tinyobj::index_t idx = shape.mesh.indices[index_offset + v];
+
+                auto welded = cornerVertices.try_emplace(
+                    CornerKey{ idx.vertex_index, idx.normal_index, idx.texcoord_index }, static_cast<ui32>(vertices.size()));
+                indices.push_back(welded.first->second);
+                ++mesh.cornerCount;
+                if (!welded.second) {
+                    continue;
+                }
+
+                Vertex vertex;
+                vertex.color = Vector4(1.0f, 1.0f, 1.0f, 1.0f);
+                vertex.normal = Vector3(0.0f, 1.0f, 0.0f);
+                vertex.texCoord = Vector2(0.0f, 0.0f);
+
+                if (idx.vertex_index >= 0 && idx.vertex_index * 3 + 2 < attrib.vertices.size()) {
+                    vertex.position.x = attrib.vertices[3 * idx.vertex_index + 0];
+                    vertex.position.y = attrib.vertices[3 * idx.vertex_index + 1];
+                    vertex.position.z = attrib.vertices[3 * idx.vertex_index + 2];
+                }
+
+                if (idx.normal_index >= 0 && idx.normal_index * 3 + 2 < attrib.normals.size()) {
+                    vertex.normal.x = attrib.normals[3 * idx.normal_index + 0];
+                    vertex.normal.y = attrib.normals[3 * idx.normal_index + 1];
+                    vertex.normal.z = attrib.normals[3 * idx.normal_index + 2];
+                }
+
+                if (idx.texcoord_index >= 0 && idx.texcoord_index * 2 + 1 < attrib.texcoords.size()) {
+                    vertex.texCoord.x = attrib.texcoords[2 * idx.texcoord_index + 0];
+                    vertex.texCoord.y = 1.0f - attrib.texcoords[2 * idx.texcoord_index + 1];
+                }
+
+                vertices.push_back(vertex);
+            }
+            index_offset += fv;
+        }
+
+        if (vertices.empty() || indices.empty()) {
+            return;
+        }
+
+        auto& lodChain = mesh.lodChain;
+        lodChain = buildMeshLodChain(vertices, indices, MeshLodSettings());
+
+        // Every level is ordered for the post-transform cache on its own; the
+        // vertices then follow LOD 0's order, which also covers the coarser levels
+        ui32 vertexCount = static_cast<ui32>(vertices.size());
+        mesh.cacheMissRatioBefore = computeAverageCacheMissRatio(lodChain.indices.data(), lodChain.lods[0].indexCount, vertexCount);
+        for (const auto& lod : lodChain.lods) {
+            optimizeVertexCache(&lodChain.indices[lod.firstIndex], lod.indexCount, vertexCount);
+        }
+        optimizeVertexFetch(vertices, lodChain.indices);
+        mesh.cacheMissRatioAfter = computeAverageCacheMissRatio(lodChain.indices.data(), lodChain.lods[0].indexCount,
+            static_cast<ui32>(vertices.size()));
+
+        for (const auto& vertex : vertices) {
+            mesh.bounds.expand(vertex.position);
+        }
+
+        if (!shape.mesh.material_ids.empty() && shape.mesh.material_ids[0] >= 0) {
+            mesh.materialIndex = static_cast<ui32>(shape.mesh.material_ids[0]);
+        }
+    }
+}
+
+MeshData ImportedMesh::getData() const
+{
+    MeshData data;
+    data.vertices = vertices.data();
+    data.vertexCount = static_cast<ui32>(vertices.size());
+    data.indices = lodChain.indices.data();
+    data.indexCount = static_cast<ui32>(lodChain.indices.size());
+    data.lods = lodChain.lods.data();
+    data.lodCount = static_cast<ui32>(lodChain.lods.size());
+    data.materialIndex = materialIndex;
+    data.bounds = bounds;
+    return data;
+}
+
+bool dx3d::importOBJ(const std::string& path, ImportedModel& model)
+{
+    auto importStart = Clock::now();
+
+    ObjModel obj;
+    if (!parseOBJ(path, obj)) {
+        printf("Failed to parse OBJ file: %s\n", obj.error.c_str());
+        return false;
+    }
+
+    model.parseMilliseconds = std::chrono::duration<float, std::milli>(Clock::now() - importStart).count();
+
+    const auto& attrib = obj.attrib;
+    const auto& shapes = obj.shapes;
+    const auto& materials = obj.materials;
+
+    printf("Loaded %zu shapes, %zu materials\n", shapes.size(), materials.size());
+
+    if (shapes.empty()) {
+        printf("No shapes found in model file\n");
+        return false;
+    }
+
+    model.materials.clear();
+    for (const auto& mat : materials) {
+        ImportedMaterial material;
+        material.name = mat.name;
+        material.diffuseColor = Vector4(mat.diffuse[0], mat.diffuse[1], mat.diffuse[2], 1.0f);
+        material.ambientColor = Vector4(mat.ambient[0], mat.ambient[1], mat.ambient[2], 1.0f);
+        material.specularColor = Vector4(mat.specular[0], mat.specular[1], mat.specular[2], 1.0f);
+        material.emissiveColor = Vector4(mat.emission[0], mat.emission[1], mat.emission[2], 1.0f);
+        material.specularPower = mat.shininess;
+        material.opacity = mat.dissolve;
+        material.diffuseTexture = mat.diffuse_texname;
+        model.materials.push_back(material);
+    }
+
+    if (model.materials.empty()) {
+        model.materials.emplace_back();
+    }
+
+    // Shapes are independent, so their geometry and LOD chains are built in parallel
+    std::vector<ImportedMesh> meshes(shapes.size());
+    std::vector<std::string> errors(shapes.size());
+
+    auto geometryStart = Clock::now();
+    JobSystem::getInstance().parallelFor(static_cast<ui32>(shapes.size()), [&shapes, &attrib, &meshes, &errors](ui32 s)
+        {
+            try {
+                importShape(attrib, shapes[s], meshes[s]);
+            }
+            catch (const std::exception& e) {
+                errors[s] = e.what();
+            }
+        });
+    model.geometryMilliseconds = std::chrono::duration<float, std::milli>(Clock::now() - geometryStart).count();
+
+    model.meshes.clear();
+    for (size_t s = 0; s < shapes.size(); s++) {
+        if (!errors[s].empty()) {
+            printf("Error processing shape %zu: %s\n", s, errors[s].c_str());
+            continue;
+        }
+        if (meshes[s].vertices.empty() || meshes[s].lodChain.indices.empty()) {
+            continue;
+        }
+
+        // Meshes without a valid material fall back to the first one
+        if (meshes[s].materialIndex >= model.materials.size()) {
+            meshes[s].materialIndex = 0;
+        }
+
+        const auto& lods = meshes[s].lodChain.lods;
+        if (lods.size() < MIN_EXPECTED_MESH_LODS && lods[0].indexCount / 3 >= MIN_REPORTED_LOD_TRIANGLES) {
+            printf("Mesh %zu (%s): only %zu LODs within the error limit, %u triangles down to %u\n",
+                s, shapes[s].name.c_str(), lods.size(), lods[0].indexCount / 3, lods.back().indexCount / 3);
+        }
+        model.meshes.push_back(std::move(meshes[s]));
+    }
+
+    return true;
+}
@@ -2,14 +2,20 @@
 
 #include <DX3D/Assets/ModelLoader.h>
 #include <DX3D/Graphics/Texture2D.h>
+#include <DX3D/Assets/ModelImporter.h>
+#include <DX3D/Assets/CookedModel.h>
+#include <DX3D/Assets/D3D11AssetUploader.h>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
 #include <fstream>
-
-#define TINYOBJLOADER_IMPLEMENTATION
-#include <DX3D/Assets/tiny_obj_loader.h>
+#include <stdexcept>
 
 using namespace dx3d;
 
 std::unordered_map<std::string, std::shared_ptr<Material>> ModelLoader::s_materialCache;
+std::shared_ptr<const ModelAsset> ModelLoader::s_defaultAsset;
+std::mutex ModelLoader::s_defaultAssetMutex;
 
 std::string ModelLoader::getDirectory(const std::string& filePath) {
     size_t pos = filePath.find_last_of("/\\");
@@ -21,6 +27,11 @@ std::string ModelLoader::getDirectory(const std::string& filePath) {
 
 std::string ModelLoader::getAssetPath(const std::string& relativePath)
 {
+    // Files outside the asset folders, such as the tests' temporary models, come in absolute
+    if (std::filesystem::path(relativePath).is_absolute()) {
+        return relativePath;
+    }
+
     std::vector<std::string> possiblePaths = {
         "DX3D/Assets/Models/" + relativePath,
         "GDENG03-Engine/DX3D/Assets/Models/" + relativePath,
@@ -146,10 +157,14 @@ std::shared_ptr<Material> ModelLoader::loadMaterial(
     return material;
 }
 
-std::shared_ptr<Model> ModelLoader::createDefaultModel(const GraphicsResourceDesc& resourceDesc)
+std::shared_ptr<const ModelAsset> ModelLoader::GetDefaultModelAsset(const GraphicsResourceDesc& resourceDesc)
 {
-    auto model = std::make_shared<Model>();
-    model->setName("DefaultCube");
+    std::lock_guard<std::mutex> lock(s_defaultAssetMutex);
+    if (s_defaultAsset) {
+        return s_defaultAsset;
+    }
+
+    auto asset = std::make_shared<ModelAsset>();
 
     std::vector<Vertex> vertices = {
         { {-0.5f, -0.5f, -0.5f}, {1.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, -1.0f}, {0.0f, 1.0f} },
@@ -180,216 +195,295 @@ std::shared_ptr<Model> ModelLoader::createDefaultModel(const GraphicsResourceDes
         material->setDiffuseColor(Vector4(0.7f, 0.7f, 0.7f, 1.0f));
         mesh->setMaterial(material);
 
-        model->addMesh(mesh);
+        asset->meshes.push_back(mesh);
         printf("Created default cube model as fallback\n");
+        s_defaultAsset = asset;
     }
     catch (...) {
         printf("Failed to create default model - returning empty model\n");
     }
 
-    return model;
+    return asset;
 }
 
-std::shared_ptr<Model> ModelLoader::LoadModel(
+std::shared_ptr<const ModelAsset> ModelLoader::LoadModelAsset(
     const std::string& filePath,
     const GraphicsResourceDesc& resourceDesc)
 {
     try {
-        auto model = std::make_shared<Model>();
-
-        if (!loadOBJ(filePath, model, resourceDesc)) {
-            printf("Failed to load OBJ file: %s - creating default model\n", filePath.c_str());
-            return createDefaultModel(resourceDesc);
+        auto model = std::make_shared<DecodedModel>();
+        if (!ReadModel(filePath, *model) || !DecodeModel(*model)) {
+            printf("Failed to load OBJ file: %s\n", filePath.c_str());
+            return nullptr;
         }
 
-        model->setFilePath(filePath);
-        model->setName(filePath);
-        return model;
+        D3D11AssetUploader uploader(resourceDesc);
+        ModelAssetBuilder builder(model, uploader);
+        while (!builder.step()) {
+        }
+        return builder.getAsset();
     }
     catch (const std::exception& e) {
-        printf("Exception loading model %s: %s - creating default model\n", filePath.c_str(), e.what());
-        return createDefaultModel(resourceDesc);
+        printf("Exception loading model %s: %s\n", filePath.c_str(), e.what());
+        return nullptr;
     }
     catch (...) {
-        printf("Unknown error loading model %s - creating default model\n", filePath.c_str());
-        return createDefaultModel(resourceDesc);
+        printf("Unknown error loading model %s\n", filePath.c_str());
+        return nullptr;
     }
 }
 
-bool ModelLoader::loadOBJ(
+std::shared_ptr<Model> ModelLoader::LoadModel(
     const std::string& filePath,
-    std::shared_ptr<Model>& model,
     const GraphicsResourceDesc& resourceDesc)
+{
+    auto asset = LoadModelAsset(filePath, resourceDesc);
+    if (!asset) {
+        printf("Creating default model for %s\n", filePath.c_str());
+        asset = GetDefaultModelAsset(resourceDesc);
+    }
+
+    auto model = std::make_shared<Model>();
+    model->setAsset(asset);
+    if (asset->filePath.empty()) {
+        model->setName("DefaultCube");
+    }
+    return model;
+}
+
+bool ModelLoader::ReadModel(const std::string& filePath, DecodedModel& model)
 {
     try {
-        std::string fullPath = getAssetPath(filePath);
-        std::string baseDirectory = getDirectory(fullPath);
+        model.filePath = filePath;
+        model.fullPath = getAssetPath(filePath);
+        model.baseDirectory = getDirectory(model.fullPath);
 
-        std::ifstream testFile(fullPath);
-        if (!testFile.good()) {
-            printf("Failed to open file: %s\n", fullPath.c_str());
-            return false;
-        }
-        testFile.close();
+        printf("Loading model from: %s\n", model.fullPath.c_str());
 
-        printf("Loading model from: %s\n", fullPath.c_str());
+        using Clock = std::chrono::steady_clock;
+        auto readStart = Clock::now();
 
-        tinyobj::ObjReaderConfig config;
-        config.triangulate = true;
+        // Cooked files are keyed by the source's contents, so editing the OBJ re-cooks it
+        {
+            MappedFile source;
+            if (!source.open(model.fullPath)) {
+                printf("Failed to open file: %s\n", model.fullPath.c_str());
+                return false;
+            }
+            model.sourceHash = hashSourceData(source.getData(), source.getSize());
+        }
 
-        tinyobj::ObjReader reader;
+        std::string cookedPath = getCookedModelPath(model.fullPath);
+        if (model.cooked.open(cookedPath, model.sourceHash)) {
+            for (ui32 i = 0; i < model.cooked.getMeshCount(); ++i) {
+                model.meshes.push_back(model.cooked.getMeshData(i));
+            }
+            model.materials = model.cooked.getMaterials();
+            resolveTexturePaths(model);
+            model.isDecoded = true;
 
-        if (!reader.ParseFromFile(fullPath, config)) {
-            printf("TinyOBJ failed to parse file: %s\n", reader.Error().c_str());
-            return false;
+            printf("Loaded cooked model %s (%.1f KB) in %.1f ms\n", cookedPath.c_str(), model.cooked.getFileSize() / 1024.0,
+                std::chrono::duration<float, std::milli>(Clock::now() - readStart).count());
         }
+        return true;
+    }
+    catch (const std::exception& e) {
+        printf("Exception in ReadModel: %s\n", e.what());
+        return false;
+    }
+}
 
-        auto& attrib = reader.GetAttrib();
-        auto& shapes = reader.GetShapes();
-        auto& materials = reader.GetMaterials();
+bool ModelLoader::DecodeModel(DecodedModel& model)
+{
+    if (model.isDecoded) {
+        return true;
+    }
 
-        printf("Loaded %zu shapes, %zu materials\n", shapes.size(), materials.size());
+    try {
+        using Clock = std::chrono::steady_clock;
+        auto importStart = Clock::now();
 
-        if (shapes.empty()) {
-            printf("No shapes found in model file\n");
+        ImportedModel& imported = model.imported;
+        if (!importOBJ(model.fullPath, imported)) {
             return false;
         }
 
-        // Load materials properly
-        std::vector<std::shared_ptr<Material>> loadedMaterials;
-
-        for (const auto& mat : materials) {
-            try {
-                auto material = std::make_shared<Material>(mat.name);
-
-                // Set basic material properties from tinyobj data
-                material->setDiffuseColor(Vector4(mat.diffuse[0], mat.diffuse[1], mat.diffuse[2], 1.0f));
-                material->setAmbientColor(Vector4(mat.ambient[0], mat.ambient[1], mat.ambient[2], 1.0f));
-                material->setSpecularColor(Vector4(mat.specular[0], mat.specular[1], mat.specular[2], 1.0f));
-                material->setEmissiveColor(Vector4(mat.emission[0], mat.emission[1], mat.emission[2], 1.0f));
-                material->setSpecularPower(mat.shininess);
-                material->setOpacity(mat.dissolve);
+        std::string cookedPath = getCookedModelPath(model.fullPath);
+        if (writeCookedModel(cookedPath, imported, model.sourceHash)) {
+            printf("Cooked model to: %s\n", cookedPath.c_str());
+        }
 
-                // Try to load diffuse texture if specified
-                if (!mat.diffuse_texname.empty()) {
-                    std::vector<std::string> texturePaths = {
-                        baseDirectory + mat.diffuse_texname,
-                        baseDirectory + "../Textures/" + mat.diffuse_texname,
-                        "DX3D/Assets/Textures/" + mat.diffuse_texname,
-                        "DX3D/Assets/Models/Textures/" + mat.diffuse_texname
-                    };
+        for (const auto& mesh : imported.meshes) {
+            model.meshes.push_back(mesh.getData());
+        }
+        model.materials = imported.materials;
+        resolveTexturePaths(model);
+        model.isDecoded = true;
+
+        size_t cornerCount = 0;
+        size_t vertexCount = 0;
+        size_t indexCount = 0;
+        double lod0Triangles = 0.0;
+        double cacheMissesBefore = 0.0;
+        double cacheMissesAfter = 0.0;
+        for (const auto& mesh : imported.meshes) {
+            double triangles = mesh.lodChain.lods[0].indexCount / 3;
+            cornerCount += mesh.cornerCount;
+            vertexCount += mesh.vertices.size();
+            indexCount += mesh.lodChain.indices.size();
+            lod0Triangles += triangles;
+            cacheMissesBefore += mesh.cacheMissRatioBefore * triangles;
+            cacheMissesAfter += mesh.cacheMissRatioAfter * triangles;
+        }
+        lod0Triangles = std::max(lod0Triangles, 1.0);
+
+        // Before welding every corner had its own vertex and a trivial index
+        const double KB = 1.0 / 1024.0;
+        printf("Model memory: vertices %zu -> %zu (%.1f KB -> %.1f KB), indices %.1f KB -> %.1f KB (all LODs), ACMR %.2f -> %.2f\n",
+            cornerCount, vertexCount, cornerCount * sizeof(Vertex) * KB, vertexCount * sizeof(Vertex) * KB,
+            cornerCount * sizeof(ui32) * KB, indexCount * sizeof(ui32) * KB,
+            cacheMissesBefore / lod0Triangles, cacheMissesAfter / lod0Triangles);
+        printf("Import took %.1f ms (parse %.1f ms, geometry and LODs %.1f ms)\n",
+            std::chrono::duration<float, std::milli>(Clock::now() - importStart).count(),
+            imported.parseMilliseconds, imported.geometryMilliseconds);
+        return true;
+    }
+    catch (const std::exception& e) {
+        printf("Exception in DecodeModel: %s\n", e.what());
+        return false;
+    }
+}
 
-                    for (const auto& path : texturePaths) {
-                        try {
-                            auto texture = std::make_shared<Texture2D>(path, resourceDesc);
-                            material->setDiffuseTexture(texture);
-                            printf("Loaded texture for %s: %s\n", mat.name.c_str(), path.c_str());
-                            break;
-                        }
-                        catch (const std::exception& e) {
-                            continue; // Try next path
-                        }
-                    }
-                }
+void ModelLoader::resolveTexturePaths(DecodedModel& model)
+{
+    model.texturePaths.assign(model.materials.size(), std::string());
 
-                loadedMaterials.push_back(material);
-                printf("Loaded material: %s\n", mat.name.c_str());
-            }
-            catch (const std::exception& e) {
-                printf("Error loading material %s: %s\n", mat.name.c_str(), e.what());
-                // Create a default material
-                auto defaultMat = std::make_shared<Material>(mat.name);
-                defaultMat->setDiffuseColor(Vector4(0.7f, 0.7f, 0.7f, 1.0f));
-                loadedMaterials.push_back(defaultMat);
-            }
+    for (size_t m = 0; m < model.materials.size(); ++m) {
+        const std::string& texture = model.materials[m].diffuseTexture;
+        if (texture.empty()) {
+            continue;
         }
 
-        if (loadedMaterials.empty()) {
-            auto defaultMat = std::make_shared<Material>("Default");
-            defaultMat->setDiffuseColor(Vector4(0.7f, 0.7f, 0.7f, 1.0f));
-            loadedMaterials.push_back(defaultMat);
+        std::vector<std::string> texturePaths = {
+            model.baseDirectory + texture,
+            model.baseDirectory + "../Textures/" + texture,
+            "DX3D/Assets/Textures/" + texture,
+            "DX3D/Assets/Models/Textures/" + texture
+        };
+
+        for (const auto& path : texturePaths) {
+            std::ifstream test(path);
+            if (test.good()) {
+                model.texturePaths[m] = path;
+                break;
+            }
         }
+    }
+}
 
-        // Process shapes
-        for (size_t s = 0; s < shapes.size(); s++) {
-            try {
-                const auto& shape = shapes[s];
-                std::vector<Vertex> vertices;
-                std::vector<ui32> indices;
-
-                size_t index_offset = 0;
-                for (size_t f = 0; f < shape.mesh.num_face_vertices.size(); f++) {
-                    int fv = shape.mesh.num_face_vertices[f];
-
-                    if (fv < 3) continue;
+ModelAssetBuilder::ModelAssetBuilder(std::shared_ptr<const DecodedModel> model, AssetUploader& uploader)
+    : m_model(std::move(model)), m_uploader(uploader), m_asset(std::make_shared<ModelAsset>())
+{
+    m_asset->filePath = m_model->filePath;
+}
 
-                    for (int v = 0; v < fv; v++) {
-                        if (index_offset + v >= shape.mesh.indices.size()) {
-                            continue;
-                        }
+ui32 ModelAssetBuilder::getStepCount() const
+{
+    // Materials, the default one for files without any, meshes, then a last step that reports
+    return static_cast<ui32>(std::max<size_t>(m_model->materials.size(), 1) + m_model->meshes.size()) + 1;
+}
 
-                        tinyobj::index_t idx = shape.mesh.indices[index_offset + v];
+float ModelAssetBuilder::getProgress() const
+{
+    return static_cast<float>(m_nextStep) / getStepCount();
+}
 
-                        Vertex vertex;
-                        vertex.color = Vector4(1.0f, 1.0f, 1.0f, 1.0f);
-                        vertex.normal = Vector3(0.0f, 1.0f, 0.0f);
-                        vertex.texCoord = Vector2(0.0f, 0.0f);
+std::shared_ptr<const ModelAsset> ModelAssetBuilder::getAsset() const
+{
+    return isComplete() ? m_asset : nullptr;
+}
 
-                        if (idx.vertex_index >= 0 && idx.vertex_index * 3 + 2 < attrib.vertices.size()) {
-                            vertex.position.x = attrib.vertices[3 * idx.vertex_index + 0];
-                            vertex.position.y = attrib.vertices[3 * idx.vertex_index + 1];
-                            vertex.position.z = attrib.vertices[3 * idx.vertex_index + 2];
-                        }
+bool ModelAssetBuilder::step()
+{
+    if (isComplete()) {
+        return true;
+    }
 
-                        if (idx.normal_index >= 0 && idx.normal_index * 3 + 2 < attrib.normals.size()) {
-                            vertex.normal.x = attrib.normals[3 * idx.normal_index + 0];
-                            vertex.normal.y = attrib.normals[3 * idx.normal_index + 1];
-                            vertex.normal.z = attrib.normals[3 * idx.normal_index + 2];
-                        }
+    ui32 materialSteps = static_cast<ui32>(std::max<size_t>(m_model->materials.size(), 1));
+    ui32 step = m_nextStep++;
+    if (step < materialSteps) {
+        createMaterial(step);
+    }
+    else if (step < materialSteps + m_model->meshes.size()) {
+        createMesh(step - materialSteps);
+    }
+    else {
+        std::string lodText;
+        for (ui32 lod = 0; lod < MAX_MESH_LODS; ++lod) {
+            lodText += (lod ? " / " : "") + std::to_string(m_lodTriangles[lod]);
+        }
+        printf("Model triangles per LOD: %s\n", lodText.c_str());
+        printf("Model loaded successfully!\n");
+    }
 
-                        if (idx.texcoord_index >= 0 && idx.texcoord_index * 2 + 1 < attrib.texcoords.size()) {
-                            vertex.texCoord.x = attrib.texcoords[2 * idx.texcoord_index + 0];
-                            vertex.texCoord.y = 1.0f - attrib.texcoords[2 * idx.texcoord_index + 1];
-                        }
+    // An asset without meshes is no asset
+    if (isComplete() && m_asset->meshes.empty()) {
+        throw std::runtime_error("No meshes could be created for " + m_model->filePath);
+    }
+    return isComplete();
+}
 
-                        vertices.push_back(vertex);
-                        indices.push_back(static_cast<ui32>(indices.size()));
-                    }
-                    index_offset += fv;
-                }
+void ModelAssetBuilder::createMaterial(ui32 index)
+{
+    if (m_model->materials.empty()) {
+        auto defaultMat = std::make_shared<Material>("Default");
+        defaultMat->setDiffuseColor(Vector4(0.7f, 0.7f, 0.7f, 1.0f));
+        m_materials.push_back(defaultMat);
+        return;
+    }
 
-                if (!vertices.empty() && !indices.empty()) {
-                    auto mesh = std::make_shared<Mesh>("Mesh_" + std::to_string(s));
-                    mesh->createRenderingResources(vertices, indices, resourceDesc);
+    const ImportedMaterial& mat = m_model->materials[index];
+    auto material = std::make_shared<Material>(mat.name);
+    material->setDiffuseColor(mat.diffuseColor);
+    material->setAmbientColor(mat.ambientColor);
+    material->setSpecularColor(mat.specularColor);
+    material->setEmissiveColor(mat.emissiveColor);
+    material->setSpecularPower(mat.specularPower);
+    material->setOpacity(mat.opacity);
+
+    const std::string& texturePath = m_model->texturePaths[index];
+    if (!texturePath.empty()) {
+        if (auto texture = m_uploader.createTexture(texturePath)) {
+            material->setDiffuseTexture(texture);
+            printf("Loaded texture for %s: %s\n", mat.name.c_str(), texturePath.c_str());
+        }
+    }
 
-                    // Assign material if available
-                    if (!shape.mesh.material_ids.empty() && shape.mesh.material_ids[0] >= 0 &&
-                        shape.mesh.material_ids[0] < loadedMaterials.size()) {
-                        mesh->setMaterial(loadedMaterials[shape.mesh.material_ids[0]]);
-                    }
-                    else {
-                        mesh->setMaterial(loadedMaterials[0]);
-                    }
+    m_materials.push_back(material);
+    printf("Loaded material: %s\n", mat.name.c_str());
+}
 
-                    model->addMesh(mesh);
-                    printf("Created mesh %zu with %zu vertices\n", s, vertices.size());
-                }
-            }
-            catch (const std::exception& e) {
-                printf("Error processing shape %zu: %s\n", s, e.what());
-                continue;
-            }
+void ModelAssetBuilder::createMesh(ui32 index)
+{
+    try {
+        const MeshData& data = m_model->meshes[index];
+        auto mesh = std::make_shared<Mesh>("Mesh_" + std::to_string(index));
+        m_uploader.createMeshResources(*mesh, data);
+        mesh->setMaterial(m_materials[data.materialIndex < m_materials.size() ? data.materialIndex : 0]);
+
+        m_asset->meshes.push_back(mesh);
+
+        // Meshes with fewer levels keep drawing their last one further out
+        std::string lodText;
+        for (ui32 lod = 0; lod < MAX_MESH_LODS && data.lodCount > 0; ++lod) {
+            ui32 triangles = data.lods[std::min(lod, data.lodCount - 1)].indexCount / 3;
+            m_lodTriangles[lod] += triangles;
+            if (lod < data.lodCount)
+                lodText += (lod ? " / " : "") + std::to_string(triangles);
         }
-
-        printf("Model loaded successfully!\n");
-        return true;
+        printf("Created mesh %u with %u vertices, LOD triangles %s\n", index, data.vertexCount, lodText.c_str());
     }
     catch (const std::exception& e) {
-        printf("Exception in loadOBJ: %s\n", e.what());
-        return false;
+        printf("Error processing shape %u: %s\n", index, e.what());
     }
-    catch (...) {
-        printf("Unknown exception in loadOBJ\n");
-        return false;
-    }
-}
\ No newline at end of file
+}
@@ -0,0 +1,904 @@
+#include <DX3D/Assets/ObjParser.h>
+#include <DX3D/Core/JobSystem.h>
+#include <DX3D/Core/MappedFile.h>
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <string_view>
+
+#define TINYOBJLOADER_IMPLEMENTATION
+#include <DX3D/Assets/tiny_obj_loader.h>
+
+using namespace dx3d;
+
+namespace
+{
+    // Smaller files are not worth splitting
+    constexpr size_t MIN_CHUNK_SIZE = 256 * 1024;
+    constexpr ui32 CHUNKS_PER_THREAD = 4;
+
+    // A line that changes parser state, replayed in file order once every chunk is parsed.
+    // The counts say how much of the chunk came before it.
+    struct ObjEvent
+    {
+        std::string_view line;
+        ui32 faceCount;
+        ui32 vertexCount;
+        ui32 normalCount;
+        ui32 texCoordCount;
+    };
+
+    struct ObjChunk
+    {
+        const char* begin = nullptr;
+        const char* end = nullptr;
+
+        std::vector<float> vertices;
+        std::vector<float> normals;
+        std::vector<float> texCoords;
+        std::vector<float> colors;
+
+        // Face corners as written; relativeCorners lists the components given as negative
+        // indices, which resolve against the chunk's local counts until its offsets are known
+        std::vector<tinyobj::index_t> corners;
+        std::vector<ui32> faceStarts;
+        std::vector<ui32> relativeCorners; // corner * 3 + component
+        std::vector<ObjEvent> events;
+        std::string error;
+
+        // Offsets of this chunk's attributes in the merged arrays
+        ui32 vertexBase = 0;
+        ui32 normalBase = 0;
+        ui32 texCoordBase = 0;
+
+        // Triangulated faces; face f owns triangleCorners [triangleStarts[f], triangleStarts[f + 1])
+        std::vector<tinyobj::index_t> triangleCorners;
+        std::vector<ui32> triangleStarts;
+    };
+
+    bool isSpace(char c)
+    {
+        return c == ' ' || c == '\t';
+    }
+
+    bool isDigit(char c)
+    {
+        return static_cast<unsigned>(c - '0') < 10u;
+    }
+
+    const char* skipSpaces(const char* p, const char* end)
+    {
+        while (p < end && isSpace(*p))
+            ++p;
+        return p;
+    }
+
+    const char* findFieldEnd(const char* p, const char* end)
+    {
+        while (p < end && !isSpace(*p))
+            ++p;
+        return p;
+    }
+
+    bool startsWith(const char* p, const char* end, std::string_view keyword)
+    {
+        return static_cast<size_t>(end - p) > keyword.size() && std::string_view(p, keyword.size()) == keyword &&
+            isSpace(p[keyword.size()]);
+    }
+
+    // tinyobj's tryParseDouble: same grammar and arithmetic, for fields from_chars does not
+    // consume whole, so unusual numbers come out exactly as tinyobj reads them
+    bool parseDoubleLikeTinyObj(const char* s, const char* end, double& result)
+    {
+        if (s >= end)
+            return false;
+
+        double mantissa = 0.0;
+        int exponent = 0;
+        char sign = '+';
+        char exponentSign = '+';
+        const char* current = s;
+        int read = 0;
+        bool leadingDot = false;
+
+        if (*current == '+' || *current == '-')
+        {
+            sign = *current;
+            current++;
+            if (current != end && *current == '.')
+                leadingDot = true;
+        }
+        else if (*current == '.')
+        {
+            leadingDot = true;
+        }
+        else if (!isDigit(*current))
+        {
+            return false;
+        }
+
+        if (!leadingDot)
+        {
+            while (current != end && isDigit(*current))
+            {
+                mantissa *= 10;
+                mantissa += static_cast<int>(*current - '0');
+                current++;
+                read++;
+            }
+            if (read == 0)
+                return false;
+        }
+
+        if (current != end)
+        {
+            bool readExponent = false;
+            if (*current == '.')
+            {
+                static const double POWERS[] = { 1.0, 0.1, 0.01, 0.001, 0.0001, 0.00001, 0.000001, 0.0000001 };
+                const int powerCount = sizeof(POWERS) / sizeof(POWERS[0]);
+
+                current++;
+                read = 1;
+                while (current != end && isDigit(*current))
+                {
+                    mantissa += static_cast<int>(*current - '0') * (read < powerCount ? POWERS[read] : std::pow(10.0, -read));
+                    read++;
+                    current++;
+                }
+                readExponent = current != end;
+            }
+            else
+            {
+                readExponent = *current == 'e' || *current == 'E';
+            }
+
+            if (readExponent && (*current == 'e' || *current == 'E'))
+            {
+                current++;
+                if (current != end && (*current == '+' || *current == '-'))
+                {
+                    exponentSign = *current;
+                    current++;
+                }
+                else if (current == end || !isDigit(*current))
+                {
+                    return false;
+                }
+
+                read = 0;
+                while (current != end && isDigit(*current))
+                {
+                    exponent *= 10;
+                    exponent += static_cast<int>(*current - '0');
+                    current++;
+                    read++;
+                }
+                exponent *= (exponentSign == '+' ? 1 : -1);
+                if (read == 0)
+                    return false;
+            }
+        }
+
+        result = (sign == '+' ? 1 : -1) * (exponent ? std::ldexp(mantissa * std::pow(5.0, exponent), exponent) : mantissa);
+        return true;
+    }
+
+    bool parseDouble(const char* s, const char* end, double& result)
+    {
+        // from_chars takes no explicit plus and also reads inf and nan, which tinyobj does not
+        const char* number = s;
+        if (number < end && *number == '+')
+            ++number;
+        const char* digits = (number == s && number < end && *number == '-') ? number + 1 : number;
+        if (digits < end && (isDigit(*digits) || *digits == '.'))
+        {
+            auto [ptr, ec] = std::from_chars(number, end, result);
+            if (ec == std::errc() && ptr == end)
+                return true;
+        }
+        return parseDoubleLikeTinyObj(s, end, result);
+    }
+
+    // The next whitespace-separated field as a float; false (and out untouched) if it is not a number
+    bool tryParseReal(const char*& p, const char* end, float& out)
+    {
+        p = skipSpaces(p, end);
+        const char* fieldEnd = findFieldEnd(p, end);
+        double value;
+        bool parsed = parseDouble(p, fieldEnd, value);
+        if (parsed)
+            out = static_cast<float>(value);
+        p = fieldEnd;
+        return parsed;
+    }
+
+    float parseReal(const char*& p, const char* end, float defaultValue)
+    {
+        float value = defaultValue;
+        tryParseReal(p, end, value);
+        return value;
+    }
+
+    // atoi: leading whitespace, an optional sign and as many digits as follow
+    int parseInt(const char* p, const char* end)
+    {
+        while (p < end && (isSpace(*p) || *p == '\v' || *p == '\f'))
+            ++p;
+        bool negative = false;
+        if (p < end && (*p == '+' || *p == '-'))
+            negative = *p++ == '-';
+        int value = 0;
+        while (p < end && isDigit(*p))
+            value = value * 10 + (*p++ - '0');
+        return negative ? -value : value;
+    }
+
+    const char* skipIndex(const char* p, const char* end)
+    {
+        while (p < end && *p != '/' && !isSpace(*p))
+            ++p;
+        return p;
+    }
+
+    // OBJ indices are 1-based, negative ones count back from the current end and 0 is invalid
+    bool fixIndex(int index, int count, int& out, bool& relative)
+    {
+        if (index > 0)
+        {
+            out = index - 1;
+            return true;
+        }
+        if (index == 0)
+            return false;
+        out = count + index;
+        relative = true;
+        return true;
+    }
+
+    // One corner of an f, l or p line: v, v/vt, v//vn or v/vt/vn
+    bool parseTriple(const char*& p, const char* end, const int counts[3], tinyobj::index_t& out, bool relative[3])
+    {
+        out.vertex_index = -1;
+        out.normal_index = -1;
+        out.texcoord_index = -1;
+        relative[0] = relative[1] = relative[2] = false;
+
+        if (!fixIndex(parseInt(p, end), counts[0], out.vertex_index, relative[0]))
+            return false;
+
+        p = skipIndex(p, end);
+        if (p == end || *p != '/')
+            return true;
+        p++;
+
+        if (p < end && *p == '/')
+        {
+            p++;
+            if (!fixIndex(parseInt(p, end), counts[1], out.normal_index, relative[1]))
+                return false;
+            p = skipIndex(p, end);
+            return true;
+        }
+
+        if (!fixIndex(parseInt(p, end), counts[2], out.texcoord_index, relative[2]))
+            return false;
+
+        p = skipIndex(p, end);
+        if (p == end || *p != '/')
+            return true;
+        p++;
+
+        if (!fixIndex(parseInt(p, end), counts[1], out.normal_index, relative[1]))
+            return false;
+        p = skipIndex(p, end);
+        return true;
+    }
+
+    void parseLine(ObjChunk& chunk, const char* p, const char* end)
+    {
+        p = skipSpaces(p, end);
+        if (p == end || *p == '#')
+            return;
+
+        const ui32 vertexCount = static_cast<ui32>(chunk.vertices.size() / 3);
+        const ui32 normalCount = static_cast<ui32>(chunk.normals.size() / 3);
+        const ui32 texCoordCount = static_cast<ui32>(chunk.texCoords.size() / 2);
+
+        if (*p == 'v')
+        {
+            if (end - p > 1 && isSpace(p[1]))
+            {
+                p += 2;
+                float x = parseReal(p, end, 0.0f);
+                float y = parseReal(p, end, 0.0f);
+                float z = parseReal(p, end, 0.0f);
+                chunk.vertices.insert(chunk.vertices.end(), { x, y, z });
+
+                // Colours after the position are an extension; vertices without them are white
+                float r, g, b;
+                if (!(tryParseReal(p, end, r) && tryParseReal(p, end, g) && tryParseReal(p, end, b)))
+                    r = g = b = 1.0f;
+                chunk.colors.insert(chunk.colors.end(), { r, g, b });
+            }
+            else if (end - p > 2 && p[1] == 'n' && isSpace(p[2]))
+            {
+                p += 3;
+                float x = parseReal(p, end, 0.0f);
+                float y = parseReal(p, end, 0.0f);
+                float z = parseReal(p, end, 0.0f);
+                chunk.normals.insert(chunk.normals.end(), { x, y, z });
+            }
+            else if (end - p > 2 && p[1] == 't' && isSpace(p[2]))
+            {
+                p += 3;
+                float u = parseReal(p, end, 0.0f);
+                float v = parseReal(p, end, 0.0f);
+                chunk.texCoords.insert(chunk.texCoords.end(), { u, v });
+            }
+            return;
+        }
+
+        if (*p == 'f' && end - p > 1 && isSpace(p[1]))
+        {
+            p = skipSpaces(p + 2, end);
+
+            const int counts[3] = { static_cast<int>(vertexCount), static_cast<int>(normalCount), static_cast<int>(texCoordCount) };
+            chunk.faceStarts.push_back(static_cast<ui32>(chunk.corners.size()));
+            while (p < end)
+            {
+                tinyobj::index_t corner;
+                bool relative[3];
+                if (!parseTriple(p, end, counts, corner, relative))
+                {
+                    chunk.error = "Failed parse `f' line (e.g. zero value for face index)";
+                    return;
+                }
+
+                ui32 cornerIndex = static_cast<ui32>(chunk.corners.size());
+                for (ui32 k = 0; k < 3; ++k)
+                {
+                    if (relative[k])
+                        chunk.relativeCorners.push_back(cornerIndex * 3 + k);
+                }
+                chunk.corners.push_back(corner);
+                p = skipSpaces(p, end);
+            }
+            return;
+        }
+
+        if (startsWith(p, end, "usemtl") || startsWith(p, end, "mtllib") || ((*p == 'g' || *p == 'o' || *p == 's' ||
+            *p == 'l' || *p == 'p') && end - p > 1 && isSpace(p[1])))
+        {
+            chunk.events.push_back({ std::string_view(p, end - p), static_cast<ui32>(chunk.faceStarts.size()),
+                vertexCount, normalCount, texCoordCount });
+        }
+    }
+
+    void parseChunk(ObjChunk& chunk)
+    {
+        // Rough guesses from typical line lengths; the arrays grow past them if needed
+        size_t size = chunk.end - chunk.begin;
+        chunk.vertices.reserve(size / 40 * 3);
+        chunk.corners.reserve(size / 20);
+
+        const char* p = chunk.begin;
+        while (p < chunk.end && chunk.error.empty())
+        {
+            // tinyobj ends lines at \n, \r\n or a lone \r; the empty line after \r\n is skipped
+            const char* lineEnd = p;
+            while (lineEnd < chunk.end && *lineEnd != '\n' && *lineEnd != '\r')
+                ++lineEnd;
+
+            parseLine(chunk, p, lineEnd);
+            p = lineEnd + 1;
+        }
+        chunk.faceStarts.push_back(static_cast<ui32>(chunk.corners.size()));
+    }
+
+    // Point-in-polygon test by W. Randolph Franklin, as tinyobj uses for ear clipping
+    int pnpoly(int count, const float* xs, const float* ys, float x, float y)
+    {
+        int inside = 0;
+        for (int i = 0, j = count - 1; i < count; j = i++)
+        {
+            if (((ys[i] > y) != (ys[j] > y)) && (x < (xs[j] - xs[i]) * (y - ys[i]) / (ys[j] - ys[i]) + xs[i]))
+                inside = !inside;
+        }
+        return inside;
+    }
+
+    // tinyobj's ear clipping for polygons with more than three corners, kept operation for
+    // operation so the triangles and their order match
+    void triangulatePolygon(const tinyobj::index_t* face, size_t cornerCount, const std::vector<float>& v,
+        std::vector<tinyobj::index_t>& remaining, std::vector<tinyobj::index_t>& out)
+    {
+        size_t axes[2] = { 1, 2 };
+        for (size_t k = 0; k < cornerCount; ++k)
+        {
+            size_t vi0 = size_t(face[(k + 0) % cornerCount].vertex_index);
+            size_t vi1 = size_t(face[(k + 1) % cornerCount].vertex_index);
+            size_t vi2 = size_t(face[(k + 2) % cornerCount].vertex_index);
+            if (3 * vi0 + 2 >= v.size() || 3 * vi1 + 2 >= v.size() || 3 * vi2 + 2 >= v.size())
+                continue;
+
+            float e0x = v[vi1 * 3 + 0] - v[vi0 * 3 + 0];
+            float e0y = v[vi1 * 3 + 1] - v[vi0 * 3 + 1];
+            float e0z = v[vi1 * 3 + 2] - v[vi0 * 3 + 2];
+            float e1x = v[vi2 * 3 + 0] - v[vi1 * 3 + 0];
+            float e1y = v[vi2 * 3 + 1] - v[vi1 * 3 + 1];
+            float e1z = v[vi2 * 3 + 2] - v[vi1 * 3 + 2];
+            float cx = std::fabs(e0y * e1z - e0z * e1y);
+            float cy = std::fabs(e0z * e1x - e0x * e1z);
+            float cz = std::fabs(e0x * e1y - e0y * e1x);
+            const float epsilon = std::numeric_limits<float>::epsilon();
+            if (cx > epsilon || cy > epsilon || cz > epsilon)
+            {
+                if (!(cx > cy && cx > cz))
+                {
+                    axes[0] = 0;
+                    if (cz > cx && cz > cy)
+                        axes[1] = 1;
+                }
+                break;
+            }
+        }
+
+        float area = 0;
+        for (size_t k = 0; k < cornerCount; ++k)
+        {
+            size_t vi0 = size_t(face[(k + 0) % cornerCount].vertex_index);
+            size_t vi1 = size_t(face[(k + 1) % cornerCount].vertex_index);
+            if (vi0 * 3 + axes[0] >= v.size() || vi0 * 3 + axes[1] >= v.size() ||
+                vi1 * 3 + axes[0] >= v.size() || vi1 * 3 + axes[1] >= v.size())
+                continue;
+
+            float v0x = v[vi0 * 3 + axes[0]];
+            float v0y = v[vi0 * 3 + axes[1]];
+            float v1x = v[vi1 * 3 + axes[0]];
+            float v1y = v[vi1 * 3 + axes[1]];
+            area += (v0x * v1y - v0y * v1x) * 0.5f;
+        }
+
+        remaining.assign(face, face + cornerCount);
+        size_t guess = 0;
+        tinyobj::index_t corners[3];
+        float xs[3];
+        float ys[3];
+
+        // Iterations left without removing a corner before giving up on a degenerate polygon
+        size_t remainingIterations = cornerCount;
+        size_t previousRemaining = remaining.size();
+
+        while (remaining.size() > 3 && remainingIterations > 0)
+        {
+            size_t count = remaining.size();
+            if (guess >= count)
+                guess -= count;
+
+            if (previousRemaining != count)
+            {
+                previousRemaining = count;
+                remainingIterations = count;
+            }
+            else
+            {
+                remainingIterations--;
+            }
+
+            for (size_t k = 0; k < 3; k++)
+            {
+                corners[k] = remaining[(guess + k) % count];
+                size_t vi = size_t(corners[k].vertex_index);
+                if (vi * 3 + axes[0] >= v.size() || vi * 3 + axes[1] >= v.size())
+                {
+                    xs[k] = 0.0f;
+                    ys[k] = 0.0f;
+                }
+                else
+                {
+                    xs[k] = v[vi * 3 + axes[0]];
+                    ys[k] = v[vi * 3 + axes[1]];
+                }
+            }
+
+            // Reflex corner
+            float e0x = xs[1] - xs[0];
+            float e0y = ys[1] - ys[0];
+            float e1x = xs[2] - xs[1];
+            float e1y = ys[2] - ys[1];
+            float cross = e0x * e1y - e0y * e1x;
+            if (cross * area < 0.0f)
+            {
+                guess += 1;
+                continue;
+            }
+
+            // Another corner inside the candidate ear
+            bool overlap = false;
+            for (size_t other = 3; other < count; ++other)
+            {
+                size_t index = (guess + other) % count;
+                size_t ovi = size_t(remaining[index].vertex_index);
+                if (ovi * 3 + axes[0] >= v.size() || ovi * 3 + axes[1] >= v.size())
+                    continue;
+                if (pnpoly(3, xs, ys, v[ovi * 3 + axes[0]], v[ovi * 3 + axes[1]]))
+                {
+                    overlap = true;
+                    break;
+                }
+            }
+            if (overlap)
+            {
+                guess += 1;
+                continue;
+            }
+
+            out.insert(out.end(), { corners[0], corners[1], corners[2] });
+            remaining.erase(remaining.begin() + (guess + 1) % count);
+        }
+
+        if (remaining.size() == 3)
+            out.insert(out.end(), { remaining[0], remaining[1], remaining[2] });
+    }
+
+    void triangulateChunk(ObjChunk& chunk, const std::vector<float>& vertices)
+    {
+        ui32 faceCount = static_cast<ui32>(chunk.faceStarts.size() - 1);
+        chunk.triangleCorners.reserve(chunk.corners.size() * 3 / 2);
+        chunk.triangleStarts.resize(faceCount + 1);
+
+        std::vector<tinyobj::index_t> remaining;
+        for (ui32 f = 0; f < faceCount; ++f)
+        {
+            chunk.triangleStarts[f] = static_cast<ui32>(chunk.triangleCorners.size());
+            const tinyobj::index_t* face = &chunk.corners[chunk.faceStarts[f]];
+            size_t cornerCount = chunk.faceStarts[f + 1] - chunk.faceStarts[f];
+
+            if (cornerCount == 3)
+                chunk.triangleCorners.insert(chunk.triangleCorners.end(), face, face + 3);
+            else if (cornerCount > 3)
+                triangulatePolygon(face, cornerCount, vertices, remaining, chunk.triangleCorners);
+        }
+        chunk.triangleStarts[faceCount] = static_cast<ui32>(chunk.triangleCorners.size());
+    }
+
+    // Replays the state-changing lines in file order, building shapes the way tinyobj's LoadObj
+    // does. Faces land in the shape that is current when they are read, which is where tinyobj's
+    // next flush puts them too.
+    class ShapeBuilder
+    {
+    public:
+        ShapeBuilder(ObjModel& model, const std::string& materialDirectory)
+            : m_model(model)
+            , m_materialReader(materialDirectory)
+        {
+        }
+
+        void addFaces(const ObjChunk& chunk, ui32 firstFace, ui32 endFace)
+        {
+            if (endFace <= firstFace)
+                return;
+            m_pendingFaces = true;
+
+            auto& mesh = m_shape.mesh;
+            const ui32 first = chunk.triangleStarts[firstFace];
+            const ui32 last = chunk.triangleStarts[endFace];
+            const size_t triangleCount = (last - first) / 3;
+            mesh.indices.insert(mesh.indices.end(), chunk.triangleCorners.begin() + first, chunk.triangleCorners.begin() + last);
+            mesh.num_face_vertices.insert(mesh.num_face_vertices.end(), triangleCount, 3);
+            mesh.material_ids.insert(mesh.material_ids.end(), triangleCount, m_material);
+            mesh.smoothing_group_ids.insert(mesh.smoothing_group_ids.end(), triangleCount, m_smoothingGroup);
+        }
+
+        bool handleEvent(const ObjEvent& event, const int counts[3])
+        {
+            const std::string line(event.line);
+            const char* token = line.c_str();
+            const char* end = token + line.size();
+
+            if (line.compare(0, 6, "usemtl") == 0)
+            {
+                auto found = m_materialMap.find(line.substr(7));
+                int material = found != m_materialMap.end() ? found->second : -1;
+                if (material != m_material)
+                {
+                    flush();
+                    m_pendingFaces = false;
+                    m_material = material;
+                }
+            }
+            else if (line.compare(0, 6, "mtllib") == 0)
+            {
+                loadMaterials(line.substr(7));
+            }
+            else if (token[0] == 'g')
+            {
+                flush();
+                if (!m_shape.mesh.indices.empty())
+                    m_model.shapes.push_back(std::move(m_shape));
+                startShape();
+
+                std::vector<std::string> names;
+                const char* p = token;
+                while (p < end)
+                {
+                    p = skipSpaces(p, end);
+                    const char* nameEnd = findFieldEnd(p, end);
+                    names.emplace_back(p, nameEnd);
+                    p = skipSpaces(nameEnd, end);
+                }
+
+                // names[0] is the 'g' itself; several group names are joined with spaces
+                if (names.size() < 2)
+                    m_model.warning += "Empty group name.\n";
+                m_name.clear();
+                for (size_t i = 1; i < names.size(); ++i)
+                    m_name += (i > 1 ? " " : "") + names[i];
+            }
+            else if (token[0] == 'o')
+            {
+                if (flush())
+                    m_model.shapes.push_back(std::move(m_shape));
+                startShape();
+                m_name = line.substr(2);
+            }
+            else if (token[0] == 's')
+            {
+                const char* p = skipSpaces(token + 2, end);
+                if (p == end)
+                    return true;
+                if (end - p >= 3)
+                {
+                    // Only "off" is understood among longer values; others keep the current group
+                    if (p[0] == 'o' && p[1] == 'f' && p[2] == 'f')
+                        m_smoothingGroup = 0;
+                }
+                else
+                {
+                    int group = parseInt(p, end);
+                    m_smoothingGroup = group < 0 ? 0 : static_cast<unsigned int>(group);
+                }
+            }
+            else if (token[0] == 'l' || token[0] == 'p')
+            {
+                std::vector<tinyobj::index_t> corners;
+                const char* p = token + 2;
+                while (p < end)
+                {
+                    tinyobj::index_t corner;
+                    bool relative[3];
+                    if (!parseTriple(p, end, counts, corner, relative))
+                    {
+                        m_model.error += std::string("Failed parse `") + token[0] + "' line (e.g. zero value for vertex index)\n";
+                        return false;
+                    }
+                    corners.push_back(corner);
+                    p = skipSpaces(p, end);
+                }
+
+                if (token[0] == 'l')
+                    m_pendingLines.push_back(std::move(corners));
+                else
+                    m_pendingPoints.push_back(std::move(corners));
+            }
+            return true;
+        }
+
+        void finish()
+        {
+            if (flush() || !m_shape.mesh.indices.empty())
+                m_model.shapes.push_back(std::move(m_shape));
+        }
+
+    private:
+        // tinyobj's exportGroupsToShape for everything but the faces, which are already in
+        // place: names the shape and copies the pending lines and points. usemtl keeps the
+        // pending lines and points, so tinyobj exports them again at the next flush.
+        bool flush()
+        {
+            if (!m_pendingFaces && m_pendingLines.empty() && m_pendingPoints.empty())
+                return false;
+
+            m_shape.name = m_name;
+            for (const auto& line : m_pendingLines)
+            {
+                m_shape.lines.indices.insert(m_shape.lines.indices.end(), line.begin(), line.end());
+                m_shape.lines.num_line_vertices.push_back(static_cast<int>(line.size()));
+            }
+            for (const auto& points : m_pendingPoints)
+                m_shape.points.indices.insert(m_shape.points.indices.end(), points.begin(), points.end());
+            return true;
+        }
+
+        void startShape()
+        {
+            m_shape = tinyobj::shape_t();
+            m_pendingFaces = false;
+            m_pendingLines.clear();
+            m_pendingPoints.clear();
+        }
+
+        void loadMaterials(const std::string& fileNames)
+        {
+            // Split on single spaces like tinyobj, then use the first file that loads
+            std::vector<std::string> names;
+            std::stringstream stream(fileNames);
+            std::string name;
+            while (std::getline(stream, name, ' '))
+                names.push_back(name);
+
+            if (names.empty())
+            {
+                m_model.warning += "Looks like empty filename for mtllib. Use default material.\n";
+                return;
+            }
+
+            for (const auto& file : names)
+            {
+                std::string warning;
+                std::string error;
+                bool loaded = m_materialReader(file, &m_model.materials, &m_materialMap, &warning, &error);
+                m_model.warning += warning;
+                m_model.error += error;
+                if (loaded)
+                    return;
+            }
+            m_model.warning += "Failed to load material file(s). Use default material.\n";
+        }
+
+        ObjModel& m_model;
+        tinyobj::MaterialFileReader m_materialReader;
+        std::map<std::string, int> m_materialMap;
+
+        tinyobj::shape_t m_shape;
+        std::string m_name;
+        int m_material = -1;
+        unsigned int m_smoothingGroup = 0;
+
+        bool m_pendingFaces = false;
+        std::vector<std::vector<tinyobj::index_t>> m_pendingLines;
+        std::vector<std::vector<tinyobj::index_t>> m_pendingPoints;
+    };
+}
+
+bool dx3d::parseOBJ(const std::string& path, ObjModel& model)
+{
+    model = ObjModel();
+
+    MappedFile file;
+    if (!file.open(path))
+    {
+        // Empty files cannot be mapped but are valid, if useless, OBJ files
+        std::ifstream test(path);
+        if (!test.good())
+        {
+            model.error = "Cannot open file [" + path + "]\n";
+            return false;
+        }
+        return true;
+    }
+
+    // Materials are looked up next to the OBJ, with tinyobj's separator convention
+    std::string materialDirectory;
+    size_t separator = path.find_last_of("/\\");
+    if (separator != std::string::npos && separator > 0)
+    {
+#ifdef _WIN32
+        materialDirectory = path.substr(0, separator) + '\\';
+#else
+        materialDirectory = path.substr(0, separator) + '/';
+#endif
+    }
+
+    // Split into chunks that end after a line break
+    const char* data = static_cast<const char*>(file.getData());
+    const char* dataEnd = data + file.getSize();
+    const size_t size = file.getSize();
+
+    ui32 threadCount = JobSystem::getInstance().getWorkerCount() + 1;
+    ui32 chunkCount = static_cast<ui32>(std::clamp<size_t>(size / MIN_CHUNK_SIZE, 1, threadCount * CHUNKS_PER_THREAD));
+    std::vector<ObjChunk> chunks(chunkCount);
+
+    const char* chunkBegin = data;
+    for (ui32 i = 0; i < chunkCount; ++i)
+    {
+        const char* chunkEnd = dataEnd;
+        if (i + 1 < chunkCount)
+        {
+            chunkEnd = std::max(chunkBegin, data + size * (i + 1) / chunkCount);
+            while (chunkEnd < dataEnd && *chunkEnd != '\n' && *chunkEnd != '\r')
+                ++chunkEnd;
+            chunkEnd = std::min(chunkEnd + 1, dataEnd);
+        }
+        chunks[i].begin = chunkBegin;
+        chunks[i].end = chunkEnd;
+        chunkBegin = chunkEnd;
+    }
+
+    auto& jobs = JobSystem::getInstance();
+    jobs.parallelFor(chunkCount, [&chunks](ui32 i)
+        {
+            parseChunk(chunks[i]);
+        });
+
+    for (const auto& chunk : chunks)
+    {
+        if (!chunk.error.empty())
+        {
+            model.error = chunk.error + "\n";
+            return false;
+        }
+    }
+
+    // Prefix sums place each chunk's attributes in the merged arrays
+    size_t vertexFloats = 0;
+    size_t normalFloats = 0;
+    size_t texCoordFloats = 0;
+    for (auto& chunk : chunks)
+    {
+        chunk.vertexBase = static_cast<ui32>(vertexFloats / 3);
+        chunk.normalBase = static_cast<ui32>(normalFloats / 3);
+        chunk.texCoordBase = static_cast<ui32>(texCoordFloats / 2);
+        vertexFloats += chunk.vertices.size();
+        normalFloats += chunk.normals.size();
+        texCoordFloats += chunk.texCoords.size();
+    }
+
+    auto& attrib = model.attrib;
+    attrib.vertices.resize(vertexFloats);
+    attrib.colors.resize(vertexFloats);
+    attrib.normals.resize(normalFloats);
+    attrib.texcoords.resize(texCoordFloats);
+
+    jobs.parallelFor(chunkCount, [&chunks, &attrib](ui32 i)
+        {
+            ObjChunk& chunk = chunks[i];
+            std::copy(chunk.vertices.begin(), chunk.vertices.end(), attrib.vertices.begin() + size_t(chunk.vertexBase) * 3);
+            std::copy(chunk.colors.begin(), chunk.colors.end(), attrib.colors.begin() + size_t(chunk.vertexBase) * 3);
+            std::copy(chunk.normals.begin(), chunk.normals.end(), attrib.normals.begin() + size_t(chunk.normalBase) * 3);
+            std::copy(chunk.texCoords.begin(), chunk.texCoords.end(), attrib.texcoords.begin() + size_t(chunk.texCoordBase) * 2);
+
+            // Negative indices were resolved against the chunk's own counts
+            for (ui32 fixup : chunk.relativeCorners)
+            {
+                tinyobj::index_t& corner = chunk.corners[fixup / 3];
+                switch (fixup % 3)
+                {
+                case 0: corner.vertex_index += chunk.vertexBase; break;
+                case 1: corner.normal_index += chunk.normalBase; break;
+                default: corner.texcoord_index += chunk.texCoordBase; break;
+                }
+            }
+        });
+
+    // Ear clipping needs the merged positions, so it runs once they are in place
+    jobs.parallelFor(chunkCount, [&chunks, &attrib](ui32 i)
+        {
+            triangulateChunk(chunks[i], attrib.vertices);
+        });
+
+    ShapeBuilder builder(model, materialDirectory);
+    for (const auto& chunk : chunks)
+    {
+        ui32 face = 0;
+        for (const auto& event : chunk.events)
+        {
+            builder.addFaces(chunk, face, event.faceCount);
+            face = event.faceCount;
+
+            const int counts[3] = { static_cast<int>(chunk.vertexBase + event.vertexCount),
+                static_cast<int>(chunk.normalBase + event.normalCount), static_cast<int>(chunk.texCoordBase + event.texCoordCount) };
+            if (!builder.handleEvent(event, counts))
+                return false;
+        }
+        builder.addFaces(chunk, face, static_cast<ui32>(chunk.faceStarts.size() - 1));
+    }
+    builder.finish();
+
+    return true;
+}
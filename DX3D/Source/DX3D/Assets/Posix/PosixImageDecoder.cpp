@@ -0,0 +1,10 @@
+#include <DX3D/Assets/ImageDecoder.h>
+
+using namespace dx3d;
+
+// No system codec is assumed here, so only the formats decodeImage reads itself load
+bool dx3d::decodePlatformImageFile(const std::string& path, DecodedImage& image, std::string& error)
+{
+    error = "No platform image codec for: " + path;
+    return false;
+}
@@ -0,0 +1,68 @@
+#include <DX3D/Assets/RecordingAssetUploader.h>
+#include <DX3D/Assets/ModelImporter.h>
+#include <DX3D/Graphics/Mesh.h>
+#include <DX3D/Graphics/Texture2D.h>
+#include <chrono>
+#include <stdexcept>
+
+using namespace dx3d;
+
+std::shared_ptr<Texture2D> RecordingAssetUploader::createTexture(const std::string& filePath)
+{
+    UploadRecord upload;
+    upload.type = UploadType::Texture;
+    upload.name = filePath;
+    record(upload);
+    return nullptr;
+}
+
+void RecordingAssetUploader::createMeshResources(Mesh& mesh, const MeshData& data)
+{
+    UploadRecord upload;
+    upload.type = UploadType::Mesh;
+    upload.name = mesh.getName();
+    upload.vertexCount = data.vertexCount;
+    upload.indexCount = data.indexCount;
+    record(upload);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_failingMeshName.empty() && upload.name.find(m_failingMeshName) != std::string::npos)
+    {
+        throw std::runtime_error("Recorded mesh upload failure: " + upload.name);
+    }
+}
+
+void RecordingAssetUploader::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_records.clear();
+}
+
+std::vector<UploadRecord> RecordingAssetUploader::getRecords() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_records;
+}
+
+void RecordingAssetUploader::setFailingMeshName(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_failingMeshName = name;
+}
+
+void RecordingAssetUploader::record(const UploadRecord& upload)
+{
+    // Busy-wait rather than sleep: sleeps overshoot by a scheduler tick, which is longer than
+    // the budgets this is meant to exercise
+    if (m_millisecondsPerUpload > 0.0f)
+    {
+        using Clock = std::chrono::steady_clock;
+        auto end = Clock::now() + std::chrono::duration<float, std::milli>(m_millisecondsPerUpload);
+        while (Clock::now() < end)
+        {
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_records.push_back(upload);
+}
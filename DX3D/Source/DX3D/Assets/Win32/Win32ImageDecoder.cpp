@@ -0,0 +1,80 @@
+#include <DX3D/Assets/ImageDecoder.h>
+#include <Windows.h>
+#include <wincodec.h>
+#include <wrl.h>
+
+#pragma comment(lib, "windowscodecs.lib")
+
+using namespace dx3d;
+
+namespace
+{
+    // COM and a WIC factory for each thread that decodes, created on its first image. A thread
+    // that already joined another apartment keeps it and is not uninitialised here.
+    struct ThreadCodec
+    {
+        ThreadCodec()
+        {
+            HRESULT hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+            ownsCom = SUCCEEDED(hr);
+            if (FAILED(hr) && hr != RPC_E_CHANGED_MODE)
+                return;
+
+            CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&factory));
+        }
+
+        ~ThreadCodec()
+        {
+            factory.Reset();
+            if (ownsCom)
+                CoUninitialize();
+        }
+
+        Microsoft::WRL::ComPtr<IWICImagingFactory> factory;
+        bool ownsCom = false;
+    };
+}
+
+bool dx3d::decodePlatformImageFile(const std::string& path, DecodedImage& image, std::string& error)
+{
+    thread_local ThreadCodec codec;
+    if (!codec.factory)
+    {
+        error = "Failed to create WIC factory";
+        return false;
+    }
+
+    std::wstring widePath(path.begin(), path.end());
+    Microsoft::WRL::ComPtr<IWICBitmapDecoder> decoder;
+    if (FAILED(codec.factory->CreateDecoderFromFilename(widePath.c_str(), nullptr, GENERIC_READ,
+        WICDecodeMetadataCacheOnDemand, &decoder)))
+    {
+        error = "Failed to create decoder for: " + path;
+        return false;
+    }
+
+    Microsoft::WRL::ComPtr<IWICBitmapFrameDecode> frame;
+    Microsoft::WRL::ComPtr<IWICFormatConverter> converter;
+    if (FAILED(decoder->GetFrame(0, &frame)) ||
+        FAILED(codec.factory->CreateFormatConverter(&converter)) ||
+        FAILED(converter->Initialize(frame.Get(), GUID_WICPixelFormat32bppRGBA, WICBitmapDitherTypeNone,
+            nullptr, 0.0, WICBitmapPaletteTypeCustom)))
+    {
+        error = "Failed to convert image: " + path;
+        return false;
+    }
+
+    UINT width = 0;
+    UINT height = 0;
+    converter->GetSize(&width, &height);
+    UINT stride = width * 4;
+    image.width = width;
+    image.height = height;
+    image.pixels.resize(size_t(stride) * height);
+    if (FAILED(converter->CopyPixels(nullptr, stride, static_cast<UINT>(image.pixels.size()), image.pixels.data())))
+    {
+        error = "Failed to copy pixels: " + path;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,155 @@
+#include <DX3D/Core/JobSystem.h>
+#include <algorithm>
+
+using namespace dx3d;
+
+JobSystem::JobSystem()
+{
+    // Leave one hardware thread for the main thread, which also works on its own batches
+    ui32 hardwareThreads = std::thread::hardware_concurrency();
+    startWorkers(hardwareThreads > 1 ? hardwareThreads - 1 : 0);
+}
+
+JobSystem::~JobSystem()
+{
+    stopWorkers();
+}
+
+void JobSystem::setWorkerCount(ui32 count)
+{
+    stopWorkers();
+    startWorkers(count);
+}
+
+void JobSystem::parallelFor(ui32 count, const std::function<void(ui32)>& job)
+{
+    if (count == 0)
+        return;
+
+    if (count == 1 || m_workers.empty())
+    {
+        for (ui32 i = 0; i < count; ++i)
+        {
+            job(i);
+        }
+        return;
+    }
+
+    auto batch = std::make_shared<Batch>();
+    batch->job = &job;
+    batch->count = count;
+
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_queue.push_back(batch);
+    }
+    m_queueCondition.notify_all();
+
+    runBatch(*batch);
+
+    // Wait for indices other threads claimed before we ran out of work
+    {
+        std::unique_lock<std::mutex> lock(batch->mutex);
+        batch->done.wait(lock, [&batch]() { return batch->finished.load() == batch->count; });
+    }
+
+    // Workers drop exhausted batches lazily; make sure ours is gone before `job` goes out of scope
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        auto it = std::find(m_queue.begin(), m_queue.end(), batch);
+        if (it != m_queue.end())
+        {
+            m_queue.erase(it);
+        }
+    }
+
+    if (batch->error)
+    {
+        std::rethrow_exception(batch->error);
+    }
+}
+
+void JobSystem::startWorkers(ui32 count)
+{
+    m_stopping = false;
+    m_workers.reserve(count);
+    for (ui32 i = 0; i < count; ++i)
+    {
+        m_workers.emplace_back(&JobSystem::workerLoop, this);
+    }
+}
+
+void JobSystem::stopWorkers()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_stopping = true;
+    }
+    m_queueCondition.notify_all();
+
+    for (auto& worker : m_workers)
+    {
+        if (worker.joinable())
+        {
+            worker.join();
+        }
+    }
+    m_workers.clear();
+}
+
+void JobSystem::workerLoop()
+{
+    while (true)
+    {
+        std::shared_ptr<Batch> batch;
+        {
+            std::unique_lock<std::mutex> lock(m_queueMutex);
+            m_queueCondition.wait(lock, [this]() { return m_stopping || !m_queue.empty(); });
+
+            if (m_stopping)
+                return;
+
+            // Exhausted batches may still sit in the queue while their last indices run
+            while (!m_queue.empty() && m_queue.front()->next.load() >= m_queue.front()->count)
+            {
+                m_queue.pop_front();
+            }
+
+            if (m_queue.empty())
+                continue;
+
+            batch = m_queue.front();
+        }
+
+        runBatch(*batch);
+    }
+}
+
+void JobSystem::runBatch(Batch& batch)
+{
+    while (true)
+    {
+        ui32 index = batch.next.fetch_add(1);
+        if (index >= batch.count)
+            return;
+
+        try
+        {
+            (*batch.job)(index);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(batch.mutex);
+            if (!batch.error)
+            {
+                batch.error = std::current_exception();
+            }
+        }
+
+        if (batch.finished.fetch_add(1) + 1 == batch.count)
+        {
+            std::lock_guard<std::mutex> lock(batch.mutex);
+            batch.done.notify_all();
+        }
+    }
+}
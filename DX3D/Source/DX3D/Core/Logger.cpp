@@ -75,8 +75,12 @@ std::string dx3d::Logger::getCurrentTimestamp() const
 
 	// Create a tm struct to safely hold the time components
 	std::tm tm_buf;
-	// Use the thread-safe localtime_s instead of localtime
+	// Thread-safe localtime; the two runtimes take the arguments in opposite order
+#ifdef _WIN32
 	localtime_s(&tm_buf, &time_t);
+#else
+	localtime_r(&time_t, &tm_buf);
+#endif
 
 	std::stringstream ss;
 	// Pass the address of your local tm struct to std::put_time
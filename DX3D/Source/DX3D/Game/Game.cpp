@@ -11,6 +11,8 @@
 #include <DX3D/Graphics/VertexBuffer.h>
 #include <DX3D/Graphics/IndexBuffer.h>
 #include <DX3D/Graphics/ConstantBuffer.h>
+#include <DX3D/Graphics/D3D11RenderBackend.h>
+#include <DX3D/Core/JobSystem.h>
 #include <DX3D/Graphics/DepthBuffer.h>
 #include <DX3D/Graphics/RenderTexture.h>
 
@@ -20,7 +22,6 @@
 #include <DX3D/Graphics/Shaders/FogShader.h>
 #include <DX3D/Graphics/Shaders/ModelShader.h>
 #include <DX3D/Graphics/Shaders/ModelVertexShader.h>
-#include <DX3D/Graphics/Shaders/DepthShader.h>
 #include <DX3D/Graphics/ShadowMap.h>
 #include <DX3D/Math/Math.h>
 #include <DX3D/Game/ViewportManager.h>
@@ -37,6 +38,7 @@
 #include <DX3D/Graphics/Primitives/Cylinder.h>
 #include <DX3D/Graphics/Primitives/Model.h>
 #include <DX3D/Assets/ModelLoader.h>
+#include <DX3D/Assets/AssetManager.h>
 
 #include <DX3D/ECS/ComponentManager.h>
 #include <DX3D/ECS/Components/TransformComponent.h>
@@ -93,7 +95,8 @@ dx3d::Game::Game(const GameDesc& desc) :
      m_gameObjects,
      [this]() { return getSavedSceneFiles(); },  // Add this lambda
      [this](const std::string& filename) { loadScene(filename); },  // Add this lambda
-     m_lights
+     m_lights,
+     m_lastFrameRenderStats
     };
     m_uiManager = std::make_unique<UIManager>(uiDeps);
 
@@ -154,9 +157,12 @@ void dx3d::Game::createRenderingResources()
     m_cylinderIndexBuffer = Cylinder::CreateIndexBuffer(resourceDesc);
     m_capsuleVertexBuffer = Capsule::CreateVertexBuffer(resourceDesc);
     m_capsuleIndexBuffer = Capsule::CreateIndexBuffer(resourceDesc);
+    m_primitiveLods[static_cast<ui32>(RenderableType::Cube)].indexCount = Cube::GetIndexCount();
+    m_primitiveLods[static_cast<ui32>(RenderableType::Plane)].indexCount = Plane::GetIndexCount();
+    m_primitiveLods[static_cast<ui32>(RenderableType::Sphere)].indexCount = Sphere::GetIndexCount();
+    m_primitiveLods[static_cast<ui32>(RenderableType::Cylinder)].indexCount = Cylinder::GetIndexCount();
+    m_primitiveLods[static_cast<ui32>(RenderableType::Capsule)].indexCount = Capsule::GetIndexCount();
 
-    m_modelVertexShader = createModelVertexShader(resourceDesc);
-    m_modelPixelShader = std::make_shared<PixelShader>(resourceDesc, ModelShader::GetPixelShaderCode());
     m_rainbowVertexShader = std::make_shared<VertexShader>(resourceDesc, Rainbow3DShader::GetVertexShaderCode());
     m_rainbowPixelShader = std::make_shared<PixelShader>(resourceDesc, Rainbow3DShader::GetPixelShaderCode());
     m_whiteVertexShader = std::make_shared<VertexShader>(resourceDesc, WhiteShader::GetVertexShaderCode());
@@ -166,12 +172,7 @@ void dx3d::Game::createRenderingResources()
 
     m_fogConstantBuffer = std::make_shared<ConstantBuffer>(sizeof(FogShaderConstants), resourceDesc);
     m_materialConstantBuffer = std::make_shared<ConstantBuffer>(sizeof(FogMaterialConstants), resourceDesc);
-    m_modelMaterialConstantBuffer = std::make_shared<ConstantBuffer>(sizeof(ModelMaterialConstants), resourceDesc);
-    m_transformConstantBuffer = std::make_shared<ConstantBuffer>(sizeof(TransformationMatrices), resourceDesc);
-    m_lightConstantBuffer = std::make_shared<ConstantBuffer>(sizeof(LightConstantBuffer), resourceDesc);
 
-    m_lightTransformConstantBuffer = std::make_shared<ConstantBuffer>(sizeof(TransformationMatrices), resourceDesc);
-    m_depthVertexShader = std::make_shared<VertexShader>(resourceDesc, DepthShader::GetVertexShaderCode());
     m_shadowMap = std::make_shared<ShadowMap>(2048, 2048, resourceDesc);
 
     D3D11_SAMPLER_DESC samplerDesc = {};
@@ -186,6 +187,22 @@ void dx3d::Game::createRenderingResources()
     samplerDesc.BorderColor[3] = 1.0f;
     device->CreateSamplerState(&samplerDesc, &m_shadowSamplerState);
 
+    // Every record job has its own deferred context; the first backend compiles the shaders the rest share
+    for (ui32 i = 0; i < RENDER_RECORD_JOB_COUNT; ++i)
+    {
+        auto& view = m_recordJobs[i];
+        view.deviceContext = renderSystem.createDeferredContext();
+        if (i == 0)
+        {
+            view.renderBackend = std::make_unique<D3D11RenderBackend>(*view.deviceContext, resourceDesc);
+            view.renderBackend->setShadowMap(m_shadowMap.get(), m_shadowSamplerState);
+        }
+        else
+        {
+            view.renderBackend = std::make_unique<D3D11RenderBackend>(*view.deviceContext, *m_recordJobs[0].renderBackend, resourceDesc);
+        }
+    }
+
     const auto& windowSize = m_display->getSize();
     m_depthBuffer = std::make_shared<DepthBuffer>(
         windowSize.width,
@@ -425,6 +442,10 @@ void dx3d::Game::update()
 
     m_sceneCamera->update();
 
+    // Models loading in the background get their GPU resources within a slice of each frame
+    AssetManager::getInstance().update();
+    ResourceManager::getInstance().update();
+
     if (m_sceneStateManager->isPlayMode())
     {
         m_fpsController->update(m_deltaTime);
@@ -844,36 +865,35 @@ void dx3d::Game::updatePhysics(float deltaTime)
     }
 }
 
-void dx3d::Game::renderScene(SceneCamera& camera, const Matrix4x4& projMatrix, RenderTexture* renderTarget)
+void dx3d::Game::recordScene(RenderViewContext& view, const SceneViewDesc& desc)
 {
-    auto& renderSystem = m_graphicsEngine->getRenderSystem();
-    auto& deviceContext = renderSystem.getDeviceContext();
+    auto& deviceContext = *view.deviceContext;
     auto d3dContext = deviceContext.getDeviceContext();
 
-    LightConstantBuffer lcb;
-    //new
-    memset(&lcb, 0, sizeof(LightConstantBuffer));
-
-    Vector3 camPos = camera.getPosition();
-    lcb.camera_position = Vector4(camPos.x, camPos.y, camPos.z, 1.0f);
-    lcb.ambient_color = m_ambientColor;
-    lcb.num_lights = static_cast<UINT>(std::min((size_t)m_lights.size(), (size_t)MAX_LIGHTS_SUPPORTED));
-    lcb.shadow_casting_light_index = m_shadowCastingLightIndex;
-
-    for (int i = 0; i < lcb.num_lights; ++i)
+    ui32 viewportWidth = desc.renderTarget ? 640 : m_display->getSize().width;
+    ui32 viewportHeight = desc.renderTarget ? 480 : m_display->getSize().height;
+
+    // Point and spot lights only reach the pixels of the clusters they touch
+    auto& clusters = view.lightClusters;
+    const auto& clusterDesc = clusters.getDesc();
+    clusters.build(desc.viewMatrix, desc.projMatrix, desc.nearPlane, desc.farPlane,
+        m_frameLightBounds, m_lightConstants.num_directional_lights);
+    view.renderBackend->setClusteredLights(m_frameLights.data(), static_cast<ui32>(m_frameLights.size()), clusters);
+
+    LightConstantBuffer lcb = m_lightConstants;
+    lcb.camera_position = Vector4(desc.cameraPosition.x, desc.cameraPosition.y, desc.cameraPosition.z, 1.0f);
+    lcb.cluster_view_z = Vector4(desc.viewMatrix.m[0][2], desc.viewMatrix.m[1][2], desc.viewMatrix.m[2][2], desc.viewMatrix.m[3][2]);
+    lcb.cluster_scale = Vector4(static_cast<float>(clusterDesc.tilesX) / viewportWidth,
+        static_cast<float>(clusterDesc.tilesY) / viewportHeight, clusters.getSliceScale(), clusters.getSliceBias());
+    lcb.cluster_tiles_x = clusterDesc.tilesX;
+    lcb.cluster_tiles_y = clusterDesc.tilesY;
+    lcb.cluster_depth_slices = clusterDesc.depthSlices;
+    view.renderBackend->setSceneConstants(&lcb, sizeof(lcb));
+
+    if (desc.renderTarget)
     {
-        lcb.lights[i] = m_lights[i]->getLightData();
-    }
-    lcb.light_view = Matrix4x4::fromXMMatrix(DirectX::XMMatrixTranspose(m_lightViewMatrix.toXMMatrix()));
-    lcb.light_projection = Matrix4x4::fromXMMatrix(DirectX::XMMatrixTranspose(m_lightProjectionMatrix.toXMMatrix()));
-
-    m_lightConstantBuffer->update(deviceContext, &lcb);
-
-
-    if (renderTarget)
-    {
-        renderTarget->clear(deviceContext, 0.1f, 0.1f, 0.2f, 1.0f);
-        renderTarget->setAsRenderTarget(deviceContext);
+        desc.renderTarget->clear(deviceContext, 0.1f, 0.1f, 0.2f, 1.0f);
+        desc.renderTarget->setAsRenderTarget(deviceContext);
     }
     else
     {
@@ -883,190 +903,34 @@ void dx3d::Game::renderScene(SceneCamera& camera, const Matrix4x4& projMatrix, R
         deviceContext.setRenderTargetsWithDepth(swapChain, *m_depthBuffer);
     }
 
-    ui32 viewportWidth = renderTarget ? 640 : m_display->getSize().width;
-    ui32 viewportHeight = renderTarget ? 480 : m_display->getSize().height;
     deviceContext.setViewportSize(viewportWidth, viewportHeight);
 
-    ID3D11Buffer* transformCb = m_transformConstantBuffer->getBuffer();
-    d3dContext->VSSetConstantBuffers(0, 1, &transformCb);
     d3dContext->OMSetDepthStencilState(m_solidDepthState, 0);
 
-    bool isSceneView = (&camera == m_sceneCamera.get());
-
+    view.stats += recordSceneView(m_renderScene, view.state, *view.renderBackend, desc.viewMatrix, desc.projMatrix, desc.farPlane);
+}
 
+void dx3d::Game::recordShadowMap(RenderViewContext& view, ui32 cascadeIndex)
+{
+    if (m_shadowCastingLightIndex < 0 || cascadeIndex >= m_shadowCascadeCount)
+        return;
 
-    for (const auto& gameObject : m_gameObjects)
+    // The first cascade's commands execute first, so it clears the atlas for all of them
+    auto& deviceContext = *view.deviceContext;
+    if (cascadeIndex == 0)
     {
-        if (!gameObject->isEnabled())
-            continue;
-
-        bool isCamera = std::dynamic_pointer_cast<CameraObject>(gameObject) != nullptr;
-        if (!isSceneView && isCamera)
-            continue;
-
-        deviceContext.setVertexShader(m_modelVertexShader->getShader());
-        deviceContext.setPixelShader(m_modelPixelShader->getShader());
-        deviceContext.setInputLayout(m_modelVertexShader->getInputLayout());
-
-        ID3D11Buffer* modelMatCb = m_modelMaterialConstantBuffer->getBuffer();
-        d3dContext->PSSetConstantBuffers(1, 1, &modelMatCb);
-
-        ID3D11Buffer* lightCb = m_lightConstantBuffer->getBuffer();
-        d3dContext->PSSetConstantBuffers(2, 1, &lightCb);
-
-        ID3D11ShaderResourceView* shadowSRV = m_shadowMap->getShaderResourceView();
-        d3dContext->PSSetShaderResources(1, 1, &shadowSRV);
-        d3dContext->PSSetSamplers(1, 1, &m_shadowSamplerState);
-
-        bool bufferSet = false;
-        ui32 indexCount = 0;
-
-        if (auto cube = std::dynamic_pointer_cast<Cube>(gameObject))
-        {
-            deviceContext.setVertexBuffer(*m_cubeVertexBuffer);
-            deviceContext.setIndexBuffer(*m_cubeIndexBuffer);
-            indexCount = Cube::GetIndexCount();
-            bufferSet = true;
-        }
-        else if (auto plane = std::dynamic_pointer_cast<Plane>(gameObject))
-        {
-            deviceContext.setVertexBuffer(*m_planeVertexBuffer);
-            deviceContext.setIndexBuffer(*m_planeIndexBuffer);
-            indexCount = Plane::GetIndexCount();
-            bufferSet = true;
-        }
-        else if (auto sphere = std::dynamic_pointer_cast<Sphere>(gameObject))
-        {
-            deviceContext.setVertexBuffer(*m_sphereVertexBuffer);
-            deviceContext.setIndexBuffer(*m_sphereIndexBuffer);
-            indexCount = Sphere::GetIndexCount();
-            bufferSet = true;
-        }
-        else if (auto cylinder = std::dynamic_pointer_cast<Cylinder>(gameObject))
-        {
-            deviceContext.setVertexBuffer(*m_cylinderVertexBuffer);
-            deviceContext.setIndexBuffer(*m_cylinderIndexBuffer);
-            indexCount = Cylinder::GetIndexCount();
-            bufferSet = true;
-        }
-        else if (auto capsule = std::dynamic_pointer_cast<Capsule>(gameObject))
-        {
-            deviceContext.setVertexBuffer(*m_capsuleVertexBuffer);
-            deviceContext.setIndexBuffer(*m_capsuleIndexBuffer);
-            indexCount = Capsule::GetIndexCount();
-            bufferSet = true;
-        }
-
-        else if (auto model = std::dynamic_pointer_cast<Model>(gameObject))
-        {
-            // Handle Model rendering
-            if (model->isReadyForRendering())
-            {
-                // Switch to model shaders
-                deviceContext.setVertexShader(m_modelVertexShader->getShader());
-                deviceContext.setPixelShader(m_modelPixelShader->getShader());
-                deviceContext.setInputLayout(m_modelVertexShader->getInputLayout());
-
-                // Set up model material constant buffer
-                ModelMaterialConstants mmc = {};
-
-                // Render each mesh in the model
-                for (size_t meshIdx = 0; meshIdx < model->getMeshCount(); ++meshIdx)
-                {
-                    auto mesh = model->getMesh(meshIdx);
-                    if (!mesh || !mesh->isReadyForRendering())
-                        continue;
-
-                    // Set vertex and index buffers for this mesh
-                    deviceContext.setVertexBuffer(*mesh->getVertexBuffer());
-                    deviceContext.setIndexBuffer(*mesh->getIndexBuffer());
-
-                    // Set up material
-                    auto material = mesh->getMaterial();
-                    if (material)
-                    {
-                        mmc.diffuseColor = material->getDiffuseColor();
-                        mmc.ambientColor = material->getAmbientColor();
-                        mmc.specularColor = material->getSpecularColor();
-                        mmc.emissiveColor = material->getEmissiveColor();
-                        mmc.specularPower = material->getSpecularPower();
-                        mmc.opacity = material->getOpacity();
-                        mmc.hasTexture = material->hasDiffuseTexture();
-
-                        // Set texture if available
-                        if (material->hasDiffuseTexture())
-                        {
-                            auto texture = material->getDiffuseTexture();
-                            ID3D11ShaderResourceView* srv = texture->getShaderResourceView();
-                            ID3D11SamplerState* sampler = texture->getSamplerState();
-                            d3dContext->PSSetShaderResources(0, 1, &srv);
-                            d3dContext->PSSetSamplers(0, 1, &sampler);
-                        }
-                    }
-                    else
-                    {
-                        // Default material
-                        mmc.diffuseColor = Vector4(0.7f, 0.7f, 0.7f, 1.0f);
-                        mmc.ambientColor = Vector4(0.2f, 0.2f, 0.2f, 1.0f);
-                        mmc.specularColor = Vector4(1.0f, 1.0f, 1.0f, 1.0f);
-                        mmc.emissiveColor = Vector4(0.0f, 0.0f, 0.0f, 1.0f);
-                        mmc.specularPower = 32.0f;
-                        mmc.opacity = 1.0f;
-                        mmc.hasTexture = false;
-                    }
-
-                    // Update material constant buffer
-                    m_modelMaterialConstantBuffer->update(deviceContext, &mmc);
-                    ID3D11Buffer* materialCb = m_modelMaterialConstantBuffer->getBuffer();
-                    d3dContext->PSSetConstantBuffers(1, 1, &materialCb);
-
-                    // Set transformation matrix
-                    TransformationMatrices transformMatrices;
-                    transformMatrices.world = Matrix4x4::fromXMMatrix(DirectX::XMMatrixTranspose(gameObject->getWorldMatrix().toXMMatrix()));
-                    transformMatrices.view = Matrix4x4::fromXMMatrix(DirectX::XMMatrixTranspose(camera.getViewMatrix().toXMMatrix()));
-                    transformMatrices.projection = Matrix4x4::fromXMMatrix(DirectX::XMMatrixTranspose(projMatrix.toXMMatrix()));
-                    m_transformConstantBuffer->update(deviceContext, &transformMatrices);
-
-                    // Draw this mesh
-                    deviceContext.drawIndexed(mesh->getIndexCount(), 0, 0);
-                }
-
-                // Reset to fog shaders for other objects
-                deviceContext.setVertexShader(m_fogVertexShader->getShader());
-                deviceContext.setPixelShader(m_fogPixelShader->getShader());
-                deviceContext.setInputLayout(m_fogVertexShader->getInputLayout());
-                continue; // Skip the normal primitive rendering path
-            }
-        }
-
-        if (bufferSet)
-        {
-            // Setup material for this object (reads from ECS MaterialComponent)
-            setupMaterialForObject(gameObject, deviceContext);
-
-            // Set material constant buffer
-            ID3D11Buffer* materialCb = m_modelMaterialConstantBuffer->getBuffer();
-            d3dContext->PSSetConstantBuffers(1, 1, &materialCb);
-
-            TransformationMatrices transformMatrices;
-            transformMatrices.world = Matrix4x4::fromXMMatrix(DirectX::XMMatrixTranspose(gameObject->getWorldMatrix().toXMMatrix()));
-            transformMatrices.view = Matrix4x4::fromXMMatrix(DirectX::XMMatrixTranspose(camera.getViewMatrix().toXMMatrix()));
-            transformMatrices.projection = Matrix4x4::fromXMMatrix(DirectX::XMMatrixTranspose(projMatrix.toXMMatrix()));
-            m_transformConstantBuffer->update(deviceContext, &transformMatrices);
-
-            deviceContext.drawIndexed(indexCount, 0, 0);
-        }
+        m_shadowMap->clear(deviceContext);
     }
+    m_shadowMap->setAsRenderTarget(deviceContext);
 
-    ID3D11ShaderResourceView* nullSRV[1] = { nullptr };
-    d3dContext->PSSetShaderResources(1, 1, nullSRV);
+    // Each cascade draws into its own tile, and only the casters that reach into its box
+    const auto& cascade = m_shadowCascades[cascadeIndex];
+    m_shadowMap->setTileViewport(deviceContext, cascade.atlasRect);
+    view.stats += recordShadowCascade(m_renderScene, view.state, *view.renderBackend, cascade);
 }
 
-void dx3d::Game::renderShadowMapPass()
+void dx3d::Game::prepareLighting(const SceneViewDesc& shadowView, const SceneViewDesc* coveredView)
 {
-    auto& deviceContext = m_graphicsEngine->getRenderSystem().getDeviceContext();
-    auto d3dContext = deviceContext.getDeviceContext();
-
     m_shadowCastingLightIndex = -1;
     Light* shadowCastingLight = nullptr;
     std::shared_ptr<LightObject> shadowCastingObject = nullptr;
@@ -1090,32 +954,30 @@ void dx3d::Game::renderShadowMapPass()
         }
     }
 
-    if (!shadowCastingObject)
+    // Without a caster there are no cascades and the shadow view records nothing
+    m_shadowCascadeCount = 0;
+    if (shadowCastingObject)
     {
-        m_lightViewMatrix = Matrix4x4();
-        m_lightProjectionMatrix = Matrix4x4();
-        return;
+        shadowCastingLight = &shadowCastingObject->getLightData();
     }
 
-    shadowCastingLight = &shadowCastingObject->getLightData();
-
-    m_shadowMap->clear(deviceContext);
-    m_shadowMap->setAsRenderTarget(deviceContext);
-
-    deviceContext.setVertexShader(m_depthVertexShader->getShader());
-    d3dContext->PSSetShader(nullptr, nullptr, 0);
-    deviceContext.setInputLayout(m_depthVertexShader->getInputLayout());
-
-    Matrix4x4 lightView, lightProjection;
-
-    if (shadowCastingLight->type == LIGHT_TYPE_DIRECTIONAL)
+    if (shadowCastingLight && shadowCastingLight->type == LIGHT_TYPE_DIRECTIONAL)
     {
-        Vector3 lightPos = Vector3(0, 0, 0) - (shadowCastingLight->direction * 50.0f);
-        Vector3 target = Vector3(0, 0, 0);
-        lightView = Matrix4x4::CreateLookAtLH(lightPos, target, Vector3(0, 1, 0));
-        lightProjection = Matrix4x4::fromXMMatrix(DirectX::XMMatrixOrthographicLH(40.0f, 40.0f, 1.0f, 100.0f));
+        if (coveredView)
+        {
+            m_shadowCascadeCount = fitShadowCascades(shadowView.viewMatrix * shadowView.projMatrix,
+                shadowView.nearPlane, shadowView.farPlane, coveredView->viewMatrix * coveredView->projMatrix,
+                coveredView->nearPlane, coveredView->farPlane, shadowCastingLight->direction,
+                m_shadowMap->getWidth(), m_renderScene.getCasterBounds(), m_shadowCascadeSettings, m_shadowCascades);
+        }
+        else
+        {
+            m_shadowCascadeCount = fitShadowCascades(shadowView.viewMatrix * shadowView.projMatrix,
+                shadowView.nearPlane, shadowView.farPlane, shadowCastingLight->direction,
+                m_shadowMap->getWidth(), m_renderScene.getCasterBounds(), m_shadowCascadeSettings, m_shadowCascades);
+        }
     }
-    else if (shadowCastingLight->type == LIGHT_TYPE_SPOT)
+    else if (shadowCastingLight && shadowCastingLight->type == LIGHT_TYPE_SPOT)
     {
         // Get the world matrix of the light source itself
         Matrix4x4 world = shadowCastingObject->getWorldMatrix();
@@ -1143,17 +1005,22 @@ void dx3d::Game::renderShadowMapPass()
         Vector3 lightPos(world.m[3][0], world.m[3][1], world.m[3][2]);
         Vector3 target = lightPos + lightDir;
 
-        lightView = Matrix4x4::CreateLookAtLH(lightPos, target, up);
+        // A spot light's frustum is small enough for one perspective cascade over the whole map
+        ShadowCascade& cascade = m_shadowCascades[0];
+        cascade.view = Matrix4x4::CreateLookAtLH(lightPos, target, up);
 
         float fov_degrees = shadowCastingLight->spot_angle_outer * 2.0f;
         float fov_radians = DirectX::XMConvertToRadians(fov_degrees);
 
-        lightProjection = Matrix4x4::CreatePerspectiveFovLH(
+        cascade.projection = Matrix4x4::CreatePerspectiveFovLH(
             fov_radians, // Use the corrected value in radians
             1.0f,
             0.1f,
             shadowCastingLight->radius
         );
+        cascade.farPlane = shadowCastingLight->radius;
+        cascade.atlasRect = getCascadeAtlasRect(0, 1);
+        m_shadowCascadeCount = 1;
     }
     /*else if (shadowCastingLight->type == LIGHT_TYPE_SPOT)
     {
@@ -1169,68 +1036,148 @@ void dx3d::Game::renderShadowMapPass()
         lightProjection = Matrix4x4::CreatePerspectiveFovLH(shadowCastingLight->spot_angle_outer * 2.0f, 1.0f, 0.1f, shadowCastingLight->radius);
     }*/
 
-    // Store the calculated matrices for the main render pass
-    m_lightViewMatrix = lightView;
-    m_lightProjectionMatrix = lightProjection;
+    // Directional lights go first so the shader can loop over them without clusters; the
+    // shadow caster's index follows its light to the new position
+    m_frameLights.clear();
+    m_frameLightBounds.clear();
+    int frameShadowCastingIndex = -1;
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        for (int i = 0; i < static_cast<int>(m_lights.size()); ++i)
+        {
+            if (!m_lights[i])
+                continue;
+
+            const Light& light = m_lights[i]->getLightData();
+            if ((light.type == LIGHT_TYPE_DIRECTIONAL) != (pass == 0))
+                continue;
+
+            if (i == m_shadowCastingLightIndex)
+            {
+                frameShadowCastingIndex = static_cast<int>(m_frameLights.size());
+            }
+            m_frameLights.push_back(light);
+
+            if (light.type == LIGHT_TYPE_DIRECTIONAL)
+                continue;
+
+            if (light.type == LIGHT_TYPE_SPOT)
+            {
+                m_frameLightBounds.push_back(LightClusterGrid::getSpotLightBounds(
+                    light.position, light.direction, light.radius, light.spot_angle_outer));
+            }
+            else
+            {
+                m_frameLightBounds.push_back(BoundingSphere(light.position, light.radius));
+            }
+        }
+    }
+
+    // Everything but the camera position and clusters is the same for both scene views
+    memset(&m_lightConstants, 0, sizeof(LightConstantBuffer));
+    m_lightConstants.ambient_color = m_ambientColor;
+    m_lightConstants.num_directional_lights = static_cast<UINT>(m_frameLights.size() - m_frameLightBounds.size());
+    m_lightConstants.shadow_casting_light_index = frameShadowCastingIndex;
 
-    // Render all shadow-casting objects
+    m_lightConstants.shadow_cascade_count = m_shadowCascadeCount;
+    m_lightConstants.shadow_texel_size = 1.0f / m_shadowMap->getWidth();
+    for (ui32 i = 0; i < m_shadowCascadeCount; ++i)
+    {
+        m_lightConstants.shadow_view_projection[i] = Matrix4x4::fromXMMatrix(
+            DirectX::XMMatrixTranspose(m_shadowCascades[i].getViewProjection().toXMMatrix()));
+        m_lightConstants.shadow_atlas_rects[i] = m_shadowCascades[i].atlasRect;
+    }
+}
+
+void dx3d::Game::gatherRenderScene()
+{
+    m_renderScene.clear();
+    m_renderScene.reserve(static_cast<ui32>(m_gameObjects.size()));
+
+    auto& componentManager = ComponentManager::getInstance();
     for (const auto& gameObject : m_gameObjects)
     {
-        if (!gameObject || std::dynamic_pointer_cast<LightObject>(gameObject) || std::dynamic_pointer_cast<CameraObject>(gameObject)) {
+        // Keep indices aligned with m_gameObjects; null objects add an empty box, which CullingBounds never reports visible
+        if (!gameObject)
+        {
+            m_renderScene.addObject(AABB(), Matrix4x4(), false);
             continue;
         }
 
-        LightTransformMatrices ltm;
-        ltm.world = Matrix4x4::fromXMMatrix(DirectX::XMMatrixTranspose(gameObject->getWorldMatrix().toXMMatrix()));
-        ltm.light_view = Matrix4x4::fromXMMatrix(DirectX::XMMatrixTranspose(lightView.toXMMatrix()));
-        ltm.light_projection = Matrix4x4::fromXMMatrix(DirectX::XMMatrixTranspose(lightProjection.toXMMatrix()));
-        m_lightTransformConstantBuffer->update(deviceContext, &ltm);
-
-        ID3D11Buffer* lightTransformCb = m_lightTransformConstantBuffer->getBuffer();
-        d3dContext->VSSetConstantBuffers(0, 1, &lightTransformCb);
-
-        bool bufferSet = false;
-        ui32 indexCount = 0;
-        if (std::dynamic_pointer_cast<Cube>(gameObject)) {
-            deviceContext.setVertexBuffer(*m_cubeVertexBuffer);
-            deviceContext.setIndexBuffer(*m_cubeIndexBuffer);
-            indexCount = Cube::GetIndexCount();
-            bufferSet = true;
-        }
-        else if (std::dynamic_pointer_cast<Plane>(gameObject)) {
-            deviceContext.setVertexBuffer(*m_planeVertexBuffer);
-            deviceContext.setIndexBuffer(*m_planeIndexBuffer);
-            indexCount = Plane::GetIndexCount();
-            bufferSet = true;
-        }
-        else if (auto sphere = std::dynamic_pointer_cast<Sphere>(gameObject))
-        {
-            deviceContext.setVertexBuffer(*m_sphereVertexBuffer);
-            deviceContext.setIndexBuffer(*m_sphereIndexBuffer);
-            indexCount = Sphere::GetIndexCount();
-            bufferSet = true;
-        }
-        else if (auto cylinder = std::dynamic_pointer_cast<Cylinder>(gameObject))
-        {
-            deviceContext.setVertexBuffer(*m_cylinderVertexBuffer);
-            deviceContext.setIndexBuffer(*m_cylinderIndexBuffer);
-            indexCount = Cylinder::GetIndexCount();
-            bufferSet = true;
-        }
-        else if (auto capsule = std::dynamic_pointer_cast<Capsule>(gameObject))
+        // Lights and cameras have nothing to draw
+        RenderableType type = gameObject->getRenderableType();
+        bool isDrawn = gameObject->isEnabled() && type != RenderableType::None;
+        m_renderScene.addObject(gameObject->getWorldBounds(), gameObject->getWorldMatrix(), isDrawn);
+        if (!isDrawn)
+            continue;
+
+        if (type == RenderableType::Model)
         {
-            deviceContext.setVertexBuffer(*m_capsuleVertexBuffer);
-            deviceContext.setIndexBuffer(*m_capsuleIndexBuffer);
-            indexCount = Capsule::GetIndexCount();
-            bufferSet = true;
-        }
+            const auto* model = static_cast<const Model*>(gameObject.get());
+            if (!model->isReadyForRendering())
+                continue;
 
-        if (bufferSet) {
-            deviceContext.drawIndexed(indexCount, 0, 0);
+            for (const auto& mesh : model->getMeshes())
+            {
+                RenderSceneDraw draw;
+                draw.vertexBuffer = mesh->getVertexBuffer().get();
+                draw.indexBuffer = mesh->getIndexBuffer().get();
+                draw.lods = &mesh->getLod(0);
+                draw.lodCount = mesh->getLodCount();
+                draw.meshId = mesh->getSortId();
+                draw.material = mesh->getMaterial().get();
+                draw.texture = draw.material ? draw.material->getDiffuseTexture().get() : nullptr;
+                m_renderScene.addDraw(draw);
+            }
+            continue;
         }
+
+        RenderSceneDraw draw;
+        if (!getPrimitiveDraw(type, draw))
+            continue;
+
+        auto* materialComp = componentManager.getComponent<MaterialComponent>(gameObject->getEntity().getID());
+        draw.material = materialComp ? materialComp->material.get() : nullptr;
+        draw.texture = draw.material ? draw.material->getDiffuseTexture().get() : nullptr;
+        m_renderScene.addDraw(draw);
     }
 }
 
+bool dx3d::Game::getPrimitiveDraw(RenderableType type, RenderSceneDraw& draw) const
+{
+    switch (type)
+    {
+    case RenderableType::Cube:
+        draw.vertexBuffer = m_cubeVertexBuffer.get();
+        draw.indexBuffer = m_cubeIndexBuffer.get();
+        break;
+    case RenderableType::Plane:
+        draw.vertexBuffer = m_planeVertexBuffer.get();
+        draw.indexBuffer = m_planeIndexBuffer.get();
+        break;
+    case RenderableType::Sphere:
+        draw.vertexBuffer = m_sphereVertexBuffer.get();
+        draw.indexBuffer = m_sphereIndexBuffer.get();
+        break;
+    case RenderableType::Cylinder:
+        draw.vertexBuffer = m_cylinderVertexBuffer.get();
+        draw.indexBuffer = m_cylinderIndexBuffer.get();
+        break;
+    case RenderableType::Capsule:
+        draw.vertexBuffer = m_capsuleVertexBuffer.get();
+        draw.indexBuffer = m_capsuleIndexBuffer.get();
+        break;
+    default:
+        return false;
+    }
+
+    // Primitives have one level and take the sort ids below the first Mesh one
+    draw.lods = &m_primitiveLods[static_cast<ui32>(type)];
+    draw.lodCount = 1;
+    draw.meshId = static_cast<ui32>(type);
+    return true;
+}
+
 void dx3d::Game::PrintMatrix(const char* name, const Matrix4x4& mat) {
     printf("--- Matrix: %s ---\n", name);
     for (int i = 0; i < 4; ++i) {
@@ -1239,9 +1186,50 @@ void dx3d::Game::PrintMatrix(const char* name, const Matrix4x4& mat) {
     printf("-----------------------\n");
 }
 
+void dx3d::Game::recordViews(const SceneViewDesc& sceneView, const SceneViewDesc& gameView)
+{
+    using Clock = std::chrono::steady_clock;
+    auto recordStart = Clock::now();
+
+    // Jobs only read what render() gathered before this point, so each records on its own deferred context
+    JobSystem::getInstance().parallelFor(RENDER_RECORD_JOB_COUNT, [this, &sceneView, &gameView](ui32 index)
+        {
+            auto viewStart = Clock::now();
+            auto& view = m_recordJobs[index];
+            view.stats = RenderStats();
+            view.renderBackend->beginFrame();
+
+            switch (getRecordJobView(index))
+            {
+            case RenderViewType::Shadow: recordShadowMap(view, index); break;
+            case RenderViewType::Scene: recordScene(view, sceneView); break;
+            case RenderViewType::Game: recordScene(view, gameView); break;
+            default: break;
+            }
+
+            view.commandList = view.deviceContext->finishCommandList();
+            view.stats.cpuMilliseconds = std::chrono::duration<float, std::milli>(Clock::now() - viewStart).count();
+        });
+
+    // In job order, so the shadow map is complete before the scene views sample it
+    auto executeStart = Clock::now();
+    auto& deviceContext = m_graphicsEngine->getRenderSystem().getDeviceContext();
+    m_lastFrameRenderStats = FrameRenderStats();
+    for (ui32 i = 0; i < RENDER_RECORD_JOB_COUNT; ++i)
+    {
+        auto& view = m_recordJobs[i];
+        deviceContext.executeCommandList(view.commandList.Get());
+        view.commandList.Reset();
+        m_lastFrameRenderStats.views[static_cast<ui32>(getRecordJobView(i))] += view.stats;
+    }
+
+    m_lastFrameRenderStats.recordMilliseconds = std::chrono::duration<float, std::milli>(executeStart - recordStart).count();
+    m_lastFrameRenderStats.executeMilliseconds = std::chrono::duration<float, std::milli>(Clock::now() - executeStart).count();
+}
+
 void dx3d::Game::render()
 {
-    renderShadowMapPass();
+    gatherRenderScene();
 
     auto& renderSystem = m_graphicsEngine->getRenderSystem();
     auto& deviceContext = renderSystem.getDeviceContext();
@@ -1251,12 +1239,29 @@ void dx3d::Game::render()
     auto& gameViewport = m_viewportManager->getViewport(ViewportType::Game);
 
     float aspectRatio = static_cast<float>(sceneViewport.width) / static_cast<float>(sceneViewport.height);
-    Matrix4x4 sceneProjMatrix = Matrix4x4::CreatePerspectiveFovLH(1.0472f, aspectRatio, 0.1f, 100.0f);
-    renderScene(*m_sceneCamera, sceneProjMatrix, sceneViewport.renderTexture.get());
+    SceneViewDesc sceneView;
+    sceneView.viewMatrix = m_sceneCamera->getViewMatrix();
+    sceneView.projMatrix = Matrix4x4::CreatePerspectiveFovLH(1.0472f, aspectRatio, 0.1f, 100.0f);
+    sceneView.cameraPosition = m_sceneCamera->getPosition();
+    sceneView.nearPlane = 0.1f;
+    sceneView.farPlane = 100.0f;
+    sceneView.renderTarget = sceneViewport.renderTexture.get();
 
     aspectRatio = static_cast<float>(gameViewport.width) / static_cast<float>(gameViewport.height);
-    Matrix4x4 gameProjMatrix = m_gameCamera->getProjectionMatrix(aspectRatio);
-    renderScene(m_gameCamera->getCamera(), gameProjMatrix, gameViewport.renderTexture.get());
+    const auto& gameCamera = m_gameCamera->getCamera();
+    SceneViewDesc gameView;
+    gameView.viewMatrix = gameCamera.getViewMatrix();
+    gameView.projMatrix = m_gameCamera->getProjectionMatrix(aspectRatio);
+    gameView.cameraPosition = gameCamera.getPosition();
+    gameView.nearPlane = m_gameCamera->getNearPlane();
+    gameView.farPlane = m_gameCamera->getFarPlane();
+    gameView.renderTarget = gameViewport.renderTexture.get();
+
+    // Cascades follow the game camera while playing or paused. While editing they follow the editor
+    // camera, and the game view, which samples the same map, falls back to a last cascade widened over it.
+    bool isEditMode = m_sceneStateManager->isEditMode();
+    prepareLighting(isEditMode ? sceneView : gameView, isEditMode ? &gameView : nullptr);
+    recordViews(sceneView, gameView);
 
     deviceContext.clearRenderTargetColor(swapChain, 0.1f, 0.1f, 0.1f, 1.0f);
     deviceContext.clearDepthBuffer(*m_depthBuffer);
@@ -1511,70 +1516,6 @@ std::shared_ptr<dx3d::Texture2D> dx3d::Game::loadTexture(const std::string& file
     return ResourceManager::getInstance().loadTexture(fileName);
 }
 
-void dx3d::Game::setupMaterialForObject(std::shared_ptr<AGameObject> gameObject, DeviceContext& deviceContext)
-{
-    auto& componentManager = ComponentManager::getInstance();
-    auto* materialComp = componentManager.getComponent<MaterialComponent>(gameObject->getEntity().getID());
-
-    ModelMaterialConstants mmc;
-
-    // Set default values first
-    mmc.diffuseColor = Vector4(0.8f, 0.8f, 0.8f, 1.0f);
-    mmc.ambientColor = Vector4(0.2f, 0.2f, 0.2f, 1.0f);
-    mmc.specularColor = Vector4(1.0f, 1.0f, 1.0f, 1.0f);
-    mmc.emissiveColor = Vector4(0.0f, 0.0f, 0.0f, 1.0f);
-    mmc.specularPower = 32.0f;
-    mmc.opacity = 1.0f;
-    mmc.hasTexture = 0.0f;
-
-    // If object has a material, use its properties
-    if (materialComp && materialComp->material)
-    {
-        auto material = materialComp->material;
-
-        mmc.diffuseColor = material->getDiffuseColor();
-        mmc.ambientColor = material->getAmbientColor();
-        mmc.specularColor = material->getSpecularColor();
-        mmc.emissiveColor = material->getEmissiveColor();
-        mmc.specularPower = material->getSpecularPower();
-        mmc.opacity = material->getOpacity();
-
-        // Handle texture
-        if (material->hasDiffuseTexture())
-        {
-            auto texture = material->getDiffuseTexture();
-            mmc.hasTexture = 1.0f;
-
-            // Set texture in shader
-            auto d3dContext = deviceContext.getDeviceContext();
-            ID3D11ShaderResourceView* srv = texture->getShaderResourceView();
-            ID3D11SamplerState* sampler = texture->getSamplerState();
-            d3dContext->PSSetShaderResources(0, 1, &srv);
-            d3dContext->PSSetSamplers(0, 1, &sampler);
-        }
-        else
-        {
-            mmc.hasTexture = 0.0f;
-
-            // Clear texture binding
-            auto d3dContext = deviceContext.getDeviceContext();
-            ID3D11ShaderResourceView* nullSRV = nullptr;
-            d3dContext->PSSetShaderResources(0, 1, &nullSRV);
-        }
-    }
-    else
-    {
-        // Clear texture binding for objects without materials
-        auto d3dContext = deviceContext.getDeviceContext();
-        ID3D11ShaderResourceView* nullSRV = nullptr;
-        d3dContext->PSSetShaderResources(0, 1, &nullSRV);
-    }
-
-    // Update the material constant buffer
-    m_modelMaterialConstantBuffer->update(deviceContext, &mmc);
-}
-
-
 void dx3d::Game::clearTextureCache()
 {
     ResourceManager::getInstance().clearTextureCache();
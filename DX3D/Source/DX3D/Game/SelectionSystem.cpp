@@ -26,82 +26,113 @@ std::shared_ptr<AGameObject> SelectionSystem::pickObject(
     float mouseX, float mouseY,
     ui32 viewportWidth, ui32 viewportHeight)
 {
-    float ndcX = (2.0f * mouseX) / viewportWidth - 1.0f;
-    float ndcY = 1.0f - (2.0f * mouseY) / viewportHeight;
+    if (viewportWidth == 0 || viewportHeight == 0)
+        return nullptr;
 
-    XMVECTOR rayClip = XMVectorSet(ndcX, ndcY, -1.0f, 1.0f);
+    return raycast(objects, createPickRay(camera, mouseX, mouseY, viewportWidth, viewportHeight));
+}
 
-    float aspectRatio = static_cast<float>(viewportWidth) / viewportHeight;
-    XMMATRIX projMatrix = Matrix4x4::CreatePerspectiveFovLH(1.0472f, aspectRatio, 0.1f, 100.0f).toXMMatrix();
-    XMMATRIX invProj = XMMatrixInverse(nullptr, projMatrix);
+std::shared_ptr<AGameObject> SelectionSystem::raycast(
+    const std::vector<std::shared_ptr<AGameObject>>& objects,
+    const Ray& ray,
+    float* hitDistance)
+{
+    updateSceneBounds(objects);
 
-    XMVECTOR rayView = XMVector4Transform(rayClip, invProj);
-    rayView = XMVectorSet(XMVectorGetX(rayView), XMVectorGetY(rayView), -1.0f, 0.0f);
+    // The BVH only narrows the candidates; each one is then tested exactly in its own space
+    float closestT = std::numeric_limits<float>::max();
+    ui32 closestIndex = 0;
+    bool hit = m_sceneBVH.raycast(ray, closestT, [&](ui32 index, float& maxT) {
+        const auto& object = objects[index];
+        if (!object)
+            return false;
 
-    XMMATRIX invView = XMMatrixInverse(nullptr, camera.getViewMatrix().toXMMatrix());
-    XMVECTOR rayWorld = XMVector4Transform(rayView, invView);
-    XMVECTOR rayDir = XMVector3Normalize(rayWorld);
+        XMMATRIX inverseWorld = XMMatrixInverse(nullptr, object->getWorldMatrix().toXMMatrix());
+        Ray localRay = ray.transformed(Matrix4x4::fromXMMatrix(inverseWorld));
+        if (!object->intersectLocalRay(localRay, maxT))
+            return false;
 
-    Vector3 rayOrigin = camera.getPosition();
-    Vector3 rayDirection;
-    XMStoreFloat3(reinterpret_cast<XMFLOAT3*>(&rayDirection), rayDir);
+        closestIndex = index;
+        return true;
+        });
 
-    std::shared_ptr<AGameObject> closestObject = nullptr;
-    float closestT = std::numeric_limits<float>::max();
+    if (!hit)
+        return nullptr;
 
-    for (const auto& object : objects)
+    if (hitDistance)
     {
-        Vector3 objectPos = object->getPosition();
-        Vector3 aabbMin = objectPos - Vector3(0.5f, 0.5f, 0.5f);
-        Vector3 aabbMax = objectPos + Vector3(0.5f, 0.5f, 0.5f);
+        *hitDistance = closestT;
+    }
+    return objects[closestIndex];
+}
+
+void SelectionSystem::updateSceneBounds(const std::vector<std::shared_ptr<AGameObject>>& objects)
+{
+    bool sameObjects = objects.size() == m_trackedEntities.size();
+    for (size_t i = 0; sameObjects && i < objects.size(); ++i)
+    {
+        EntityID entity = objects[i] ? objects[i]->getEntity().getID() : INVALID_ENTITY;
+        sameObjects = entity == m_trackedEntities[i];
+    }
+
+    // Refits never change the topology, so once as many refits as objects have piled up the
+    // tree is likely loose enough that a fresh build pays for itself
+    if (!sameObjects || m_sceneBVH.getRefitCount() > objects.size())
+    {
+        rebuildSceneBounds(objects);
+        return;
+    }
 
-        float t;
-        if (rayIntersectsAABB(rayOrigin, rayDirection, aabbMin, aabbMax, t))
+    for (size_t i = 0; i < objects.size(); ++i)
+    {
+        if (!objects[i])
+            continue;
+
+        ui32 worldVersion = objects[i]->getWorldVersion();
+        if (worldVersion != m_trackedWorldVersions[i])
         {
-            if (t < closestT)
-            {
-                closestT = t;
-                closestObject = object;
-            }
+            m_sceneBVH.refit(static_cast<ui32>(i), objects[i]->getWorldBounds());
+            m_trackedWorldVersions[i] = worldVersion;
         }
     }
-
-    return closestObject;
 }
 
-bool SelectionSystem::rayIntersectsAABB(const Vector3& rayOrigin, const Vector3& rayDir,
-    const Vector3& aabbMin, const Vector3& aabbMax, float& t)
+void SelectionSystem::rebuildSceneBounds(const std::vector<std::shared_ptr<AGameObject>>& objects)
 {
-    float tmin = 0.0f;
-    float tmax = std::numeric_limits<float>::max();
+    std::vector<AABB> bounds(objects.size());
+    m_trackedEntities.resize(objects.size());
+    m_trackedWorldVersions.resize(objects.size());
 
-    for (int i = 0; i < 3; i++)
+    for (size_t i = 0; i < objects.size(); ++i)
     {
-        float origin = (i == 0) ? rayOrigin.x : (i == 1) ? rayOrigin.y : rayOrigin.z;
-        float dir = (i == 0) ? rayDir.x : (i == 1) ? rayDir.y : rayDir.z;
-        float min = (i == 0) ? aabbMin.x : (i == 1) ? aabbMin.y : aabbMin.z;
-        float max = (i == 0) ? aabbMax.x : (i == 1) ? aabbMax.y : aabbMax.z;
-
-        if (std::abs(dir) < 0.0001f)
+        const auto& object = objects[i];
+        m_trackedEntities[i] = object ? object->getEntity().getID() : INVALID_ENTITY;
+        m_trackedWorldVersions[i] = object ? object->getWorldVersion() : 0;
+        if (object)
         {
-            if (origin < min || origin > max)
-                return false;
+            bounds[i] = object->getWorldBounds();
         }
-        else
-        {
-            float t1 = (min - origin) / dir;
-            float t2 = (max - origin) / dir;
+    }
+
+    m_sceneBVH.build(bounds);
+}
 
-            if (t1 > t2) std::swap(t1, t2);
+Ray SelectionSystem::createPickRay(const SceneCamera& camera, float mouseX, float mouseY,
+    ui32 viewportWidth, ui32 viewportHeight)
+{
+    float ndcX = (2.0f * mouseX) / viewportWidth - 1.0f;
+    float ndcY = 1.0f - (2.0f * mouseY) / viewportHeight;
 
-            tmin = std::max(tmin, t1);
-            tmax = std::min(tmax, t2);
+    // Same projection the scene view renders with
+    float aspectRatio = static_cast<float>(viewportWidth) / viewportHeight;
+    XMMATRIX viewProjection = XMMatrixMultiply(
+        camera.getViewMatrix().toXMMatrix(),
+        Matrix4x4::CreatePerspectiveFovLH(1.0472f, aspectRatio, 0.1f, 100.0f).toXMMatrix());
+    XMMATRIX inverseViewProjection = XMMatrixInverse(nullptr, viewProjection);
 
-            if (tmin > tmax)
-                return false;
-        }
-    }
+    // Unproject the cursor on the near (z = 0) and far (z = 1) planes
+    XMVECTOR nearPoint = XMVector3TransformCoord(XMVectorSet(ndcX, ndcY, 0.0f, 1.0f), inverseViewProjection);
+    XMVECTOR farPoint = XMVector3TransformCoord(XMVectorSet(ndcX, ndcY, 1.0f, 1.0f), inverseViewProjection);
 
-    t = tmin;
-    return true;
-}
\ No newline at end of file
+    return Ray(camera.getPosition(), Vector3(XMVector3Normalize(XMVectorSubtract(farPoint, nearPoint))));
+}
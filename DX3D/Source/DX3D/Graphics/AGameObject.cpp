@@ -44,7 +44,9 @@ AGameObject::~AGameObject()
     {
         if (auto parent = m_parent.lock())
         {
-            parent->removeChild(shared_from_this());
+            // shared_from_this() throws once destruction has begun; our entry in the parent
+            // has already expired, and removeChild drops expired entries
+            parent->removeChild(nullptr);
         }
     }
 
@@ -52,7 +54,10 @@ AGameObject::~AGameObject()
     {
         if (auto child = weakChild.lock())
         {
+            // The child's world matrix still includes this object's transform
             child->m_parent.reset();
+            child->m_dirtyFlags |= WorldDirty | BoundsDirty;
+            child->updateChildrenTransforms();
         }
     }
 
@@ -149,19 +154,72 @@ Vector3 AGameObject::getWorldScale() const
     return worldScale;
 }
 
-Matrix4x4 AGameObject::getWorldMatrix() const
+const Matrix4x4& AGameObject::getLocalMatrix() const
 {
     const_cast<AGameObject*>(this)->syncTransformFromECS();
 
-    Matrix4x4 localMatrix = m_transform.getLocalMatrix();
+    if (m_dirtyFlags & LocalDirty)
+    {
+        m_localMatrix = m_transform.getLocalMatrix();
+        m_dirtyFlags &= ~LocalDirty;
+    }
+    return m_localMatrix;
+}
+
+const Matrix4x4& AGameObject::getWorldMatrix() const
+{
+    const Matrix4x4& localMatrix = getLocalMatrix();
 
-    if (hasParent())
+    if (auto parent = m_parent.lock())
     {
-        Matrix4x4 parentWorldMatrix = getParentWorldMatrix();
-        return localMatrix * parentWorldMatrix;
+        // The parent may have been moved by physics without pushing dirtiness down, so compare versions too
+        const Matrix4x4& parentWorldMatrix = parent->getWorldMatrix();
+        if ((m_dirtyFlags & WorldDirty) || parent->m_worldVersion != m_parentWorldVersion)
+        {
+            m_worldMatrix = localMatrix * parentWorldMatrix;
+            m_parentWorldVersion = parent->m_worldVersion;
+            m_worldIncludesParent = true;
+            m_dirtyFlags = (m_dirtyFlags & ~WorldDirty) | BoundsDirty;
+            ++m_worldVersion;
+        }
+    }
+    else if ((m_dirtyFlags & WorldDirty) || m_worldIncludesParent)
+    {
+        // Also rebuilt when the parent expired without telling us, e.g. destroyed while we were held elsewhere
+        m_worldMatrix = localMatrix;
+        m_worldIncludesParent = false;
+        m_dirtyFlags = (m_dirtyFlags & ~WorldDirty) | BoundsDirty;
+        ++m_worldVersion;
     }
 
-    return localMatrix;
+    return m_worldMatrix;
+}
+
+AABB AGameObject::getLocalBounds() const
+{
+    return AABB(Vector3(-0.5f, -0.5f, -0.5f), Vector3(0.5f, 0.5f, 0.5f));
+}
+
+bool AGameObject::intersectLocalRay(const Ray& localRay, float& maxT) const
+{
+    float t = 0.0f;
+    if (!intersectRayAABB(localRay, getInverseDirection(localRay), getLocalBounds(), maxT, t))
+        return false;
+
+    maxT = t;
+    return true;
+}
+
+const AABB& AGameObject::getWorldBounds() const
+{
+    const Matrix4x4& worldMatrix = getWorldMatrix();
+
+    if (m_dirtyFlags & BoundsDirty)
+    {
+        m_worldBounds = getLocalBounds().transformed(worldMatrix);
+        m_dirtyFlags &= ~BoundsDirty;
+    }
+    return m_worldBounds;
 }
 
 Matrix4x4 AGameObject::getParentWorldMatrix() const
@@ -215,6 +273,8 @@ void AGameObject::setParent(std::shared_ptr<AGameObject> parent)
     else
     {
         m_parent.reset();
+        m_dirtyFlags |= WorldDirty | BoundsDirty;
+        updateChildrenTransforms();
     }
 }
 
@@ -326,6 +386,11 @@ void AGameObject::updateChildrenTransforms()
     {
         if (auto child = weakChild.lock())
         {
+            // An already dirty child has not been rebuilt since, so neither has anything below it
+            if (child->m_dirtyFlags & WorldDirty)
+                continue;
+
+            child->m_dirtyFlags |= WorldDirty | BoundsDirty;
             child->updateChildrenTransforms();
         }
     }
@@ -515,11 +580,15 @@ void AGameObject::syncTransformFromECS()
     auto& componentManager = ComponentManager::getInstance();
     auto* transformComp = componentManager.getComponent<TransformComponent>(m_entity.getID());
 
-    if (transformComp)
+    if (transformComp && transformComp->version != m_transformVersion)
     {
         m_transform.position = transformComp->position;
         m_transform.rotation = transformComp->rotation;
         m_transform.scale = transformComp->scale;
+        m_transformVersion = transformComp->version;
+
+        m_dirtyFlags |= AllDirty;
+        updateChildrenTransforms();
     }
 }
 
@@ -528,11 +597,14 @@ void AGameObject::syncTransformToECS()
     auto& componentManager = ComponentManager::getInstance();
     auto* transformComp = componentManager.getComponent<TransformComponent>(m_entity.getID());
 
+    m_dirtyFlags |= AllDirty;
+
     if (transformComp)
     {
         transformComp->position = m_transform.position;
         transformComp->rotation = m_transform.rotation;
         transformComp->scale = m_transform.scale;
+        m_transformVersion = ++transformComp->version;
 
         if (hasPhysics())
         {
@@ -550,14 +622,13 @@ void AGameObject::syncTransformToECS()
 
 Matrix4x4 AGameObject::Transform::getLocalMatrix() const
 {
-    Matrix4x4 scaleMatrix = Matrix4x4::CreateScale(scale);
-    Matrix4x4 rotationX = Matrix4x4::CreateRotationX(rotation.x);
-    Matrix4x4 rotationY = Matrix4x4::CreateRotationY(rotation.y);
-    Matrix4x4 rotationZ = Matrix4x4::CreateRotationZ(rotation.z);
-    Matrix4x4 translationMatrix = Matrix4x4::CreateTranslation(position);
-
-    Matrix4x4 result = scaleMatrix * rotationZ * rotationY * rotationX * translationMatrix;
-    return result;
+    // Same S * Rz * Ry * Rx * T order as before, composed in registers instead of five Matrix4x4 round trips
+    XMMATRIX result = XMMatrixScaling(scale.x, scale.y, scale.z);
+    result = XMMatrixMultiply(result, XMMatrixRotationZ(rotation.z));
+    result = XMMatrixMultiply(result, XMMatrixRotationY(rotation.y));
+    result = XMMatrixMultiply(result, XMMatrixRotationX(rotation.x));
+    result = XMMatrixMultiply(result, XMMatrixTranslation(position.x, position.y, position.z));
+    return Matrix4x4::fromXMMatrix(result);
 }
 
 void AGameObject::setEnabled(bool enabled)
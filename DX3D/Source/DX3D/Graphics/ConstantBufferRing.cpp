@@ -0,0 +1,88 @@
+#include <DX3D/Graphics/ConstantBufferRing.h>
+#include <DX3D/Graphics/DeviceContext.h>
+#include <cstring>
+
+namespace
+{
+    // Offsets and sizes bound through *SetConstantBuffers1 must be multiples of 16 constants
+    constexpr dx3d::ui32 CONSTANT_RANGE_ALIGNMENT = 256;
+    constexpr dx3d::ui32 CONSTANT_SIZE = 16;
+}
+
+dx3d::ConstantBufferRing::ConstantBufferRing(ui32 sizeInBytes, const GraphicsResourceDesc& desc)
+    : GraphicsResource(desc),
+    m_size((sizeInBytes + CONSTANT_RANGE_ALIGNMENT - 1) & ~(CONSTANT_RANGE_ALIGNMENT - 1))
+{
+    D3D11_FEATURE_DATA_D3D11_OPTIONS options{};
+    if (FAILED(m_device.CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options))) ||
+        !options.ConstantBufferOffsetting)
+    {
+        DX3DLogErrorAndThrow("Constant buffer offsetting is not supported by this device");
+    }
+
+    // Without it every allocation discards, which still works because earlier draws keep the
+    // renamed copy they were recorded with
+    m_canMapNoOverwrite = options.MapNoOverwriteOnDynamicConstantBuffer;
+
+    D3D11_BUFFER_DESC bufferDesc = {};
+    bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+    bufferDesc.ByteWidth = m_size;
+    bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+    bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+    bufferDesc.MiscFlags = 0;
+
+    DX3DGraphicsLogErrorAndThrow(
+        m_device.CreateBuffer(&bufferDesc, nullptr, &m_buffer),
+        "Failed to create constant buffer ring"
+    );
+}
+
+dx3d::ConstantBufferRing::~ConstantBufferRing()
+{
+}
+
+dx3d::ConstantBufferRing::Allocation dx3d::ConstantBufferRing::allocate(DeviceContext& deviceContext, const void* data, ui32 size)
+{
+    ui32 alignedSize = (size + CONSTANT_RANGE_ALIGNMENT - 1) & ~(CONSTANT_RANGE_ALIGNMENT - 1);
+    if (alignedSize > m_size)
+    {
+        DX3DLogError("Constant data does not fit in the constant buffer ring");
+        return {};
+    }
+
+    bool discard = !m_canMapNoOverwrite;
+
+    // Start again from the front at the first allocation of a frame or when the tail is full
+    if (m_discardNext || m_offset + alignedSize > m_size)
+    {
+        m_offset = 0;
+        m_discardNext = false;
+        discard = true;
+    }
+
+    D3D11_MAPPED_SUBRESOURCE mappedResource{};
+    HRESULT hr = deviceContext.getDeviceContext()->Map(
+        m_buffer.Get(),
+        0,
+        discard ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE,
+        0,
+        &mappedResource
+    );
+
+    if (FAILED(hr))
+    {
+        DX3DLogError("Failed to map constant buffer ring");
+        return {};
+    }
+
+    std::memcpy(static_cast<unsigned char*>(mappedResource.pData) + m_offset, data, size);
+    deviceContext.getDeviceContext()->Unmap(m_buffer.Get(), 0);
+    ++m_frameMapCount;
+
+    Allocation allocation;
+    allocation.buffer = m_buffer.Get();
+    allocation.firstConstant = m_offset / CONSTANT_SIZE;
+    allocation.constantCount = alignedSize / CONSTANT_SIZE;
+    m_offset += alignedSize;
+    return allocation;
+}
@@ -0,0 +1,168 @@
+#include <DX3D/Graphics/D3D11RenderBackend.h>
+#include <DX3D/Graphics/DeviceContext.h>
+#include <DX3D/Graphics/InstanceBuffer.h>
+#include <DX3D/Graphics/StructuredBuffer.h>
+#include <DX3D/Graphics/LightClusterGrid.h>
+#include <DX3D/Graphics/Light.h>
+#include <DX3D/Graphics/VertexBuffer.h>
+#include <DX3D/Graphics/IndexBuffer.h>
+#include <DX3D/Graphics/ShadowMap.h>
+#include <DX3D/Graphics/Texture2D.h>
+#include <DX3D/Graphics/Shaders/ModelShader.h>
+#include <DX3D/Graphics/Shaders/ModelVertexShader.h>
+
+using namespace dx3d;
+
+namespace
+{
+    // Instances the stream starts with; it grows with the largest frame drawn
+    constexpr ui32 INITIAL_INSTANCE_CAPACITY = 4096;
+
+    // Scene and view constants of a frame take a few KB; the ring only wraps mid-frame past this
+    constexpr ui32 CONSTANT_RING_SIZE = 64 * 1024;
+
+    // Starting sizes of the light buffers; like the instance stream they grow on demand
+    constexpr ui32 INITIAL_LIGHT_CAPACITY = 256;
+    constexpr ui32 INITIAL_CLUSTER_LIGHT_INDEX_CAPACITY = 16 * 1024;
+}
+
+D3D11RenderBackend::D3D11RenderBackend(DeviceContext& deviceContext, const GraphicsResourceDesc& desc)
+    : m_deviceContext(deviceContext)
+{
+    m_modelVertexShader = createModelVertexShader(desc);
+    m_modelPixelShader = std::make_shared<PixelShader>(desc, ModelShader::GetPixelShaderCode());
+    m_depthVertexShader = createDepthVertexShader(desc);
+    m_constantRing = std::make_shared<ConstantBufferRing>(CONSTANT_RING_SIZE, desc);
+    m_instanceBuffer = std::make_shared<InstanceBuffer>(sizeof(ModelInstanceData), INITIAL_INSTANCE_CAPACITY, desc);
+    createLightBuffers(desc);
+}
+
+D3D11RenderBackend::D3D11RenderBackend(DeviceContext& deviceContext, const D3D11RenderBackend& shaderSource,
+    const GraphicsResourceDesc& desc)
+    : m_deviceContext(deviceContext),
+    m_modelVertexShader(shaderSource.m_modelVertexShader),
+    m_modelPixelShader(shaderSource.m_modelPixelShader),
+    m_depthVertexShader(shaderSource.m_depthVertexShader),
+    m_shadowMap(shaderSource.m_shadowMap),
+    m_shadowSampler(shaderSource.m_shadowSampler)
+{
+    m_constantRing = std::make_shared<ConstantBufferRing>(CONSTANT_RING_SIZE, desc);
+    m_instanceBuffer = std::make_shared<InstanceBuffer>(sizeof(ModelInstanceData), INITIAL_INSTANCE_CAPACITY, desc);
+    createLightBuffers(desc);
+}
+
+D3D11RenderBackend::~D3D11RenderBackend()
+{
+}
+
+void D3D11RenderBackend::createLightBuffers(const GraphicsResourceDesc& desc)
+{
+    const LightClusterGridDesc clusterDesc;
+    ui32 clusterCount = clusterDesc.tilesX * clusterDesc.tilesY * clusterDesc.depthSlices;
+
+    m_lightBuffer = std::make_shared<StructuredBuffer>(sizeof(Light), INITIAL_LIGHT_CAPACITY, desc);
+    m_clusterRangeBuffer = std::make_shared<StructuredBuffer>(sizeof(LightClusterGrid::ClusterRange), clusterCount, desc);
+    m_clusterLightIndexBuffer = std::make_shared<StructuredBuffer>(sizeof(ui32), INITIAL_CLUSTER_LIGHT_INDEX_CAPACITY, desc);
+}
+
+void D3D11RenderBackend::setShadowMap(const ShadowMap* shadowMap, ID3D11SamplerState* shadowSampler)
+{
+    m_shadowMap = shadowMap;
+    m_shadowSampler = shadowSampler;
+}
+
+void D3D11RenderBackend::setClusteredLights(const Light* lights, ui32 lightCount, const LightClusterGrid& clusters)
+{
+    const auto& ranges = clusters.getClusterRanges();
+    const auto& indices = clusters.getLightIndices();
+    m_lightBuffer->update(m_deviceContext, lights, lightCount);
+    m_clusterRangeBuffer->update(m_deviceContext, ranges.data(), static_cast<ui32>(ranges.size()));
+    m_clusterLightIndexBuffer->update(m_deviceContext, indices.data(), static_cast<ui32>(indices.size()));
+}
+
+void D3D11RenderBackend::beginFrame()
+{
+    m_constantRing->beginFrame();
+    m_instanceBuffer->beginFrame();
+}
+
+void D3D11RenderBackend::setSceneConstants(const void* data, ui32 size)
+{
+    m_sceneConstants = m_constantRing->allocate(m_deviceContext, data, size);
+}
+
+void D3D11RenderBackend::setViewConstants(const ModelViewConstants& constants)
+{
+    m_viewConstants = m_constantRing->allocate(m_deviceContext, &constants, sizeof(constants));
+}
+
+ModelInstanceData* D3D11RenderBackend::beginInstances(ui32 instanceCount)
+{
+    return static_cast<ModelInstanceData*>(m_instanceBuffer->map(m_deviceContext, instanceCount, m_firstInstance));
+}
+
+void D3D11RenderBackend::endInstances()
+{
+    m_instanceBuffer->unmap(m_deviceContext);
+}
+
+void D3D11RenderBackend::setShader(RenderShader shader)
+{
+    auto d3dContext = m_deviceContext.getDeviceContext();
+
+    if (shader == RenderShader::Depth)
+    {
+        m_deviceContext.setVertexShader(m_depthVertexShader->getShader());
+        d3dContext->PSSetShader(nullptr, nullptr, 0);
+        m_deviceContext.setInputLayout(m_depthVertexShader->getInputLayout());
+    }
+    else
+    {
+        m_deviceContext.setVertexShader(m_modelVertexShader->getShader());
+        m_deviceContext.setPixelShader(m_modelPixelShader->getShader());
+        m_deviceContext.setInputLayout(m_modelVertexShader->getInputLayout());
+
+        m_deviceContext.setPixelConstantBufferRange(2, m_sceneConstants.buffer,
+            m_sceneConstants.firstConstant, m_sceneConstants.constantCount);
+
+        ID3D11ShaderResourceView* shadowSRV = m_shadowMap ? m_shadowMap->getShaderResourceView() : nullptr;
+        d3dContext->PSSetShaderResources(1, 1, &shadowSRV);
+        d3dContext->PSSetSamplers(1, 1, &m_shadowSampler);
+
+        ID3D11ShaderResourceView* lightSRVs[] = {
+            m_lightBuffer->getShaderResourceView(),
+            m_clusterRangeBuffer->getShaderResourceView(),
+            m_clusterLightIndexBuffer->getShaderResourceView() };
+        d3dContext->PSSetShaderResources(2, 3, lightSRVs);
+    }
+
+    // Offsets change with every view, so the ranges are rebound along with the shader
+    m_deviceContext.setVertexConstantBufferRange(0, m_viewConstants.buffer,
+        m_viewConstants.firstConstant, m_viewConstants.constantCount);
+}
+
+void D3D11RenderBackend::setGeometry(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer)
+{
+    m_deviceContext.setVertexBuffers(vertexBuffer, *m_instanceBuffer);
+    m_deviceContext.setIndexBuffer(indexBuffer);
+}
+
+void D3D11RenderBackend::setTexture(const Texture2D* texture)
+{
+    auto d3dContext = m_deviceContext.getDeviceContext();
+
+    // Untextured batches clear the slot so no stale texture stays bound
+    ID3D11ShaderResourceView* srv = nullptr;
+    if (texture)
+    {
+        srv = texture->getShaderResourceView();
+        ID3D11SamplerState* sampler = texture->getSamplerState();
+        d3dContext->PSSetSamplers(0, 1, &sampler);
+    }
+    d3dContext->PSSetShaderResources(0, 1, &srv);
+}
+
+void D3D11RenderBackend::drawIndexedInstanced(ui32 indexCount, ui32 instanceCount, ui32 firstIndex, ui32 firstInstance)
+{
+    m_deviceContext.drawIndexedInstanced(indexCount, instanceCount, firstIndex, 0, m_firstInstance + firstInstance);
+}
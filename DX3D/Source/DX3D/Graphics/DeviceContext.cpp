@@ -2,12 +2,16 @@
 #include <DX3D/Graphics/SwapChain.h>
 #include <DX3D/Graphics/VertexBuffer.h>
 #include <DX3D/Graphics/IndexBuffer.h>
+#include <DX3D/Graphics/InstanceBuffer.h>
 #include <DX3D/Graphics/DepthBuffer.h>  // Add this include
 
 dx3d::DeviceContext::DeviceContext(const GraphicsResourceDesc& desc, ID3D11DeviceContext* deviceContext)
     : GraphicsResource(desc)
 {
     m_deviceContext = deviceContext;
+
+    // Only needed for offset constant buffer binding; null on runtimes older than 11.1
+    m_deviceContext.As(&m_deviceContext1);
 }
 
 dx3d::DeviceContext::~DeviceContext()
@@ -48,6 +52,14 @@ void dx3d::DeviceContext::setVertexBuffer(const VertexBuffer& vertexBuffer)
     m_deviceContext->IASetVertexBuffers(0, 1, &buffer, &stride, &offset);
 }
 
+void dx3d::DeviceContext::setVertexBuffers(const VertexBuffer& vertexBuffer, const InstanceBuffer& instanceBuffer)
+{
+    ID3D11Buffer* buffers[2] = { vertexBuffer.getBuffer(), instanceBuffer.getBuffer() };
+    UINT strides[2] = { sizeof(Vertex), instanceBuffer.getInstanceSize() };
+    UINT offsets[2] = { 0, 0 };
+    m_deviceContext->IASetVertexBuffers(0, 2, buffers, strides, offsets);
+}
+
 void dx3d::DeviceContext::setIndexBuffer(const IndexBuffer& indexBuffer)
 {
     m_deviceContext->IASetIndexBuffer(indexBuffer.getBuffer(), DXGI_FORMAT_R32_UINT, 0);
@@ -89,6 +101,20 @@ void dx3d::DeviceContext::setInputLayout(ID3D11InputLayout* inputLayout)
     }
 }
 
+void dx3d::DeviceContext::setVertexConstantBufferRange(ui32 slot, ID3D11Buffer* buffer, ui32 firstConstant, ui32 constantCount)
+{
+    if (m_deviceContext1) {
+        m_deviceContext1->VSSetConstantBuffers1(slot, 1, &buffer, &firstConstant, &constantCount);
+    }
+}
+
+void dx3d::DeviceContext::setPixelConstantBufferRange(ui32 slot, ID3D11Buffer* buffer, ui32 firstConstant, ui32 constantCount)
+{
+    if (m_deviceContext1) {
+        m_deviceContext1->PSSetConstantBuffers1(slot, 1, &buffer, &firstConstant, &constantCount);
+    }
+}
+
 void dx3d::DeviceContext::drawTriangleList(ui32 vertexCount, ui32 startVertexIndex)
 {
     m_deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
@@ -107,11 +133,33 @@ void dx3d::DeviceContext::drawIndexed(ui32 indexCount, ui32 startIndexLocation,
     m_deviceContext->DrawIndexed(indexCount, startIndexLocation, baseVertexLocation);
 }
 
+void dx3d::DeviceContext::drawIndexedInstanced(ui32 indexCount, ui32 instanceCount, ui32 startIndexLocation,
+    i32 baseVertexLocation, ui32 startInstanceLocation)
+{
+    m_deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    m_deviceContext->DrawIndexedInstanced(indexCount, instanceCount, startIndexLocation, baseVertexLocation, startInstanceLocation);
+}
+
 void dx3d::DeviceContext::present(SwapChain& swapChain)
 {
     swapChain.present();
 }
 
+Microsoft::WRL::ComPtr<ID3D11CommandList> dx3d::DeviceContext::finishCommandList()
+{
+    // State is not carried over: the next list starts from defaults, like a fresh deferred context
+    Microsoft::WRL::ComPtr<ID3D11CommandList> commandList;
+    DX3DGraphicsLogErrorAndThrow(m_deviceContext->FinishCommandList(FALSE, &commandList),
+        "FinishCommandList failed.");
+    return commandList;
+}
+
+void dx3d::DeviceContext::executeCommandList(ID3D11CommandList* commandList)
+{
+    // Leaves the immediate context in the default state; callers bind what they draw with next
+    m_deviceContext->ExecuteCommandList(commandList, FALSE);
+}
+
 ID3D11DeviceContext* dx3d::DeviceContext::getDeviceContext()
 {
     return m_deviceContext.Get();
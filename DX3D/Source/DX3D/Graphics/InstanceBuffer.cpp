@@ -0,0 +1,60 @@
+#include <DX3D/Graphics/InstanceBuffer.h>
+#include <DX3D/Graphics/DeviceContext.h>
+#include <algorithm>
+
+dx3d::InstanceBuffer::InstanceBuffer(ui32 instanceSize, ui32 instanceCapacity, const GraphicsResourceDesc& gDesc)
+    : GraphicsResource(gDesc),
+    m_instanceSize(instanceSize),
+    m_capacity(std::max(instanceCapacity, 1u))
+{
+    createBuffer();
+}
+
+void* dx3d::InstanceBuffer::map(DeviceContext& deviceContext, ui32 instanceCount, ui32& firstInstance)
+{
+    bool discard = m_discardNext || m_used + instanceCount > m_capacity;
+    if (discard)
+    {
+        m_used = 0;
+        m_discardNext = false;
+    }
+
+    // Draws already issued from the old buffer keep it alive, so replacing it mid-frame is safe
+    if (instanceCount > m_capacity)
+    {
+        m_capacity = std::max(instanceCount, m_capacity + m_capacity / 2);
+        m_buffer.Reset();
+        createBuffer();
+    }
+
+    D3D11_MAPPED_SUBRESOURCE mappedResource{};
+    HRESULT hr = deviceContext.getDeviceContext()->Map(m_buffer.Get(), 0,
+        discard ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE, 0, &mappedResource);
+    if (FAILED(hr))
+    {
+        DX3DLogError("Failed to map instance buffer");
+        return nullptr;
+    }
+
+    firstInstance = m_used;
+    m_used += instanceCount;
+    return static_cast<unsigned char*>(mappedResource.pData) + static_cast<size_t>(firstInstance) * m_instanceSize;
+}
+
+void dx3d::InstanceBuffer::unmap(DeviceContext& deviceContext)
+{
+    deviceContext.getDeviceContext()->Unmap(m_buffer.Get(), 0);
+}
+
+void dx3d::InstanceBuffer::createBuffer()
+{
+    D3D11_BUFFER_DESC bufferDesc = {};
+    bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+    bufferDesc.ByteWidth = m_instanceSize * m_capacity;
+    bufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+    bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+    bufferDesc.MiscFlags = 0;
+
+    DX3DGraphicsLogErrorAndThrow(m_device.CreateBuffer(&bufferDesc, nullptr, &m_buffer),
+        "Failed to create instance buffer.");
+}
@@ -0,0 +1,30 @@
+#include <DX3D/Graphics/InstanceData.h>
+#include <DX3D/Graphics/Material.h>
+
+dx3d::ModelMaterialConstants dx3d::makeMaterialConstants(const Material* material)
+{
+    ModelMaterialConstants mmc;
+
+    // Set default values first
+    mmc.diffuseColor = Vector4(0.8f, 0.8f, 0.8f, 1.0f);
+    mmc.ambientColor = Vector4(0.2f, 0.2f, 0.2f, 1.0f);
+    mmc.specularColor = Vector4(1.0f, 1.0f, 1.0f, 1.0f);
+    mmc.emissiveColor = Vector4(0.0f, 0.0f, 0.0f, 1.0f);
+    mmc.specularPower = 32.0f;
+    mmc.opacity = 1.0f;
+    mmc.hasTexture = 0.0f;
+    mmc.padding = 0.0f;
+
+    if (material)
+    {
+        mmc.diffuseColor = material->getDiffuseColor();
+        mmc.ambientColor = material->getAmbientColor();
+        mmc.specularColor = material->getSpecularColor();
+        mmc.emissiveColor = material->getEmissiveColor();
+        mmc.specularPower = material->getSpecularPower();
+        mmc.opacity = material->getOpacity();
+        mmc.hasTexture = material->hasDiffuseTexture() ? 1.0f : 0.0f;
+    }
+
+    return mmc;
+}
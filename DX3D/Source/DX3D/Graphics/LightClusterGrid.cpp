@@ -0,0 +1,341 @@
+#include <DX3D/Graphics/LightClusterGrid.h>
+#include <DX3D/Core/JobSystem.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace dx3d;
+using namespace DirectX;
+
+namespace
+{
+    // Lights transformed per job; small enough to spread 1k lights over a few workers
+    constexpr ui32 LIGHT_CHUNK_SIZE = 256;
+
+    XMVECTOR loadLanes(const std::vector<float>& values, ui32 index)
+    {
+        return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&values[index]));
+    }
+
+    // Squared distance from a point to a box given by its centre and half size; 0 inside
+    float distanceSquaredToBox(float x, float y, float z, float centerX, float centerY, float centerZ,
+        float extentX, float extentY, float extentZ)
+    {
+        float dx = std::max(std::fabs(x - centerX) - extentX, 0.0f);
+        float dy = std::max(std::fabs(y - centerY) - extentY, 0.0f);
+        float dz = std::max(std::fabs(z - centerZ) - extentZ, 0.0f);
+        return dx * dx + dy * dy + dz * dz;
+    }
+
+    ui32 toTile(float coord, ui32 tileCount)
+    {
+        float tile = std::floor(coord * tileCount);
+        return static_cast<ui32>(std::clamp(tile, 0.0f, static_cast<float>(tileCount - 1)));
+    }
+}
+
+LightClusterGrid::LightClusterGrid(const LightClusterGridDesc& desc)
+    : m_desc(desc)
+{
+    m_desc.tilesX = std::max(m_desc.tilesX, 1u);
+    m_desc.tilesY = std::max(m_desc.tilesY, 1u);
+    m_desc.depthSlices = std::max(m_desc.depthSlices, 1u);
+
+    m_sliceEntries.resize(m_desc.depthSlices);
+    m_sliceCounts.resize(m_desc.depthSlices);
+}
+
+ui32 LightClusterGrid::getDepthSlice(float viewDepth) const
+{
+    if (viewDepth <= m_nearPlane)
+        return 0;
+
+    float slice = std::floor(std::log(viewDepth) * m_sliceScale + m_sliceBias);
+    return static_cast<ui32>(std::clamp(slice, 0.0f, static_cast<float>(m_desc.depthSlices - 1)));
+}
+
+float LightClusterGrid::getSliceNear(ui32 slice) const
+{
+    if (slice >= m_desc.depthSlices)
+        return m_farPlane;
+    return m_nearPlane * std::pow(m_farPlane / m_nearPlane, static_cast<float>(slice) / m_desc.depthSlices);
+}
+
+BoundingSphere LightClusterGrid::getSpotLightBounds(const Vector3& position, const Vector3& direction, float range,
+    float halfAngle)
+{
+    constexpr float QUARTER_PI = 0.785398163f;
+    constexpr float HALF_PI = 1.570796327f;
+
+    // At 90 degrees and beyond the cone is no smaller than the point light
+    if (halfAngle >= HALF_PI)
+        return BoundingSphere(position, range);
+
+    Vector3 axis = Vector3::Normalize(direction);
+    float cosAngle = std::cos(halfAngle);
+
+    // Wide cones: the circle at the end of the cone bounds them. Narrow ones: the sphere
+    // through the apex and that circle, centred on the axis.
+    if (halfAngle > QUARTER_PI)
+        return BoundingSphere(position + axis * (range * cosAngle), range * std::sin(halfAngle));
+
+    float radius = range / (2.0f * cosAngle);
+    return BoundingSphere(position + axis * radius, radius);
+}
+
+void LightClusterGrid::build(const Matrix4x4& viewMatrix, const Matrix4x4& projMatrix, float nearPlane, float farPlane,
+    const std::vector<BoundingSphere>& lightBounds, ui32 firstLightIndex)
+{
+    updateClusterBounds(projMatrix, nearPlane, farPlane);
+    m_firstLightIndex = firstLightIndex;
+
+    auto& jobSystem = JobSystem::getInstance();
+
+    // Transform the lights and find the block of clusters each one can touch
+    computeLightExtents(viewMatrix, lightBounds);
+
+    // Slices share nothing, so each one tests its lights against its own clusters
+    jobSystem.parallelFor(m_desc.depthSlices, [this](ui32 slice)
+        {
+            binSlice(slice);
+        });
+
+    // Slices fill consecutive parts of the index list
+    std::vector<ui32> sliceOffsets(m_desc.depthSlices);
+    ui32 totalEntries = 0;
+    for (ui32 slice = 0; slice < m_desc.depthSlices; ++slice)
+    {
+        sliceOffsets[slice] = totalEntries;
+        totalEntries += static_cast<ui32>(m_sliceEntries[slice].size());
+    }
+
+    const ui32 clustersPerSlice = m_desc.tilesX * m_desc.tilesY;
+    m_clusterRanges.resize(getClusterCount());
+    m_lightIndices.resize(totalEntries);
+
+    jobSystem.parallelFor(m_desc.depthSlices, [this, &sliceOffsets, clustersPerSlice](ui32 slice)
+        {
+            // Counts become write cursors; entries arrive in light order, so every cluster's
+            // lights stay sorted by index
+            auto& counts = m_sliceCounts[slice];
+            ClusterRange* ranges = &m_clusterRanges[slice * clustersPerSlice];
+            ui32 offset = sliceOffsets[slice];
+            for (ui32 cluster = 0; cluster < clustersPerSlice; ++cluster)
+            {
+                ranges[cluster] = { offset, counts[cluster] };
+                counts[cluster] = offset;
+                offset += ranges[cluster].count;
+            }
+
+            for (const auto& entry : m_sliceEntries[slice])
+            {
+                m_lightIndices[counts[entry.cluster]++] = m_firstLightIndex + entry.light;
+            }
+        });
+}
+
+void LightClusterGrid::updateClusterBounds(const Matrix4x4& projMatrix, float nearPlane, float farPlane)
+{
+    if (m_boundsValid && nearPlane == m_boundsNear && farPlane == m_boundsFar &&
+        std::memcmp(&projMatrix, &m_boundsProjection, sizeof(Matrix4x4)) == 0)
+        return;
+
+    m_boundsProjection = projMatrix;
+    m_boundsNear = nearPlane;
+    m_boundsFar = farPlane;
+    m_boundsValid = true;
+
+    m_nearPlane = std::max(nearPlane, 1e-4f);
+    m_farPlane = std::max(farPlane, m_nearPlane * 1.001f);
+    m_sliceScale = m_desc.depthSlices / std::log(m_farPlane / m_nearPlane);
+    m_sliceBias = -std::log(m_nearPlane) * m_sliceScale;
+
+    ui32 clusterCount = getClusterCount();
+    for (auto* channel : { &m_clusterCenterX, &m_clusterCenterY, &m_clusterCenterZ,
+        &m_clusterExtentX, &m_clusterExtentY, &m_clusterExtentZ })
+    {
+        channel->resize(clusterCount);
+    }
+
+    // A point at view depth z and NDC x has view x = (ndcX - P[2][0]) * z / P[0][0]
+    const float scaleX = projMatrix.m[0][0];
+    const float scaleY = projMatrix.m[1][1];
+    const float offsetX = projMatrix.m[2][0];
+    const float offsetY = projMatrix.m[2][1];
+
+    for (ui32 slice = 0; slice < m_desc.depthSlices; ++slice)
+    {
+        float zNear = getSliceNear(slice);
+        float zFar = getSliceNear(slice + 1);
+
+        for (ui32 tileY = 0; tileY < m_desc.tilesY; ++tileY)
+        {
+            // Tile rows run top to bottom, NDC y bottom to top
+            float ndcTop = 1.0f - 2.0f * tileY / m_desc.tilesY;
+            float ndcBottom = 1.0f - 2.0f * (tileY + 1) / m_desc.tilesY;
+            float y[4] = {
+                (ndcTop - offsetY) * zNear / scaleY, (ndcTop - offsetY) * zFar / scaleY,
+                (ndcBottom - offsetY) * zNear / scaleY, (ndcBottom - offsetY) * zFar / scaleY };
+            float minY = std::min({ y[0], y[1], y[2], y[3] });
+            float maxY = std::max({ y[0], y[1], y[2], y[3] });
+
+            for (ui32 tileX = 0; tileX < m_desc.tilesX; ++tileX)
+            {
+                float ndcLeft = -1.0f + 2.0f * tileX / m_desc.tilesX;
+                float ndcRight = -1.0f + 2.0f * (tileX + 1) / m_desc.tilesX;
+                float x[4] = {
+                    (ndcLeft - offsetX) * zNear / scaleX, (ndcLeft - offsetX) * zFar / scaleX,
+                    (ndcRight - offsetX) * zNear / scaleX, (ndcRight - offsetX) * zFar / scaleX };
+                float minX = std::min({ x[0], x[1], x[2], x[3] });
+                float maxX = std::max({ x[0], x[1], x[2], x[3] });
+
+                ui32 cluster = getClusterIndex(tileX, tileY, slice);
+                m_clusterCenterX[cluster] = (minX + maxX) * 0.5f;
+                m_clusterCenterY[cluster] = (minY + maxY) * 0.5f;
+                m_clusterCenterZ[cluster] = (zNear + zFar) * 0.5f;
+                m_clusterExtentX[cluster] = (maxX - minX) * 0.5f;
+                m_clusterExtentY[cluster] = (maxY - minY) * 0.5f;
+                m_clusterExtentZ[cluster] = (zFar - zNear) * 0.5f;
+            }
+        }
+    }
+}
+
+void LightClusterGrid::computeLightExtents(const Matrix4x4& viewMatrix, const std::vector<BoundingSphere>& lightBounds)
+{
+    const ui32 lightCount = static_cast<ui32>(lightBounds.size());
+    for (auto* channel : { &m_lightX, &m_lightY, &m_lightZ, &m_lightRadius })
+    {
+        channel->resize(lightCount);
+    }
+    m_lightExtents.resize(lightCount);
+
+    const ui32 chunkCount = (lightCount + LIGHT_CHUNK_SIZE - 1) / LIGHT_CHUNK_SIZE;
+    JobSystem::getInstance().parallelFor(chunkCount, [this, &viewMatrix, &lightBounds, lightCount](ui32 chunk)
+        {
+            const Matrix4x4& v = viewMatrix;
+            const float scaleX = m_boundsProjection.m[0][0];
+            const float scaleY = m_boundsProjection.m[1][1];
+            const float offsetX = m_boundsProjection.m[2][0];
+            const float offsetY = m_boundsProjection.m[2][1];
+
+            ui32 end = std::min((chunk + 1) * LIGHT_CHUNK_SIZE, lightCount);
+            for (ui32 i = chunk * LIGHT_CHUNK_SIZE; i < end; ++i)
+            {
+                const Vector3& c = lightBounds[i].center;
+                float r = lightBounds[i].radius;
+                float x = c.x * v.m[0][0] + c.y * v.m[1][0] + c.z * v.m[2][0] + v.m[3][0];
+                float y = c.x * v.m[0][1] + c.y * v.m[1][1] + c.z * v.m[2][1] + v.m[3][1];
+                float z = c.x * v.m[0][2] + c.y * v.m[1][2] + c.z * v.m[2][2] + v.m[3][2];
+
+                m_lightX[i] = x;
+                m_lightY[i] = y;
+                m_lightZ[i] = z;
+                m_lightRadius[i] = r;
+
+                LightExtent& extent = m_lightExtents[i];
+                extent = LightExtent();
+                if (z + r < m_nearPlane || z - r > m_farPlane)
+                    continue;
+
+                // Pixels only exist beyond the near plane, so the box around the sphere can start
+                // there; x / z and y / z peak at the corners of that box
+                float zMin = std::max(z - r, m_nearPlane);
+                float zMax = std::min(z + r, m_farPlane);
+                float ndcX[4] = {
+                    (x - r) * scaleX / zMin + offsetX, (x - r) * scaleX / zMax + offsetX,
+                    (x + r) * scaleX / zMin + offsetX, (x + r) * scaleX / zMax + offsetX };
+                float ndcY[4] = {
+                    (y - r) * scaleY / zMin + offsetY, (y - r) * scaleY / zMax + offsetY,
+                    (y + r) * scaleY / zMin + offsetY, (y + r) * scaleY / zMax + offsetY };
+                float minX = std::min({ ndcX[0], ndcX[1], ndcX[2], ndcX[3] });
+                float maxX = std::max({ ndcX[0], ndcX[1], ndcX[2], ndcX[3] });
+                float minY = std::min({ ndcY[0], ndcY[1], ndcY[2], ndcY[3] });
+                float maxY = std::max({ ndcY[0], ndcY[1], ndcY[2], ndcY[3] });
+                if (maxX < -1.0f || minX > 1.0f || maxY < -1.0f || minY > 1.0f)
+                    continue;
+
+                extent.firstSlice = getDepthSlice(zMin);
+                extent.lastSlice = getDepthSlice(zMax);
+                extent.firstTileX = toTile((minX + 1.0f) * 0.5f, m_desc.tilesX);
+                extent.lastTileX = toTile((maxX + 1.0f) * 0.5f, m_desc.tilesX);
+                extent.firstTileY = toTile((1.0f - maxY) * 0.5f, m_desc.tilesY);
+                extent.lastTileY = toTile((1.0f - minY) * 0.5f, m_desc.tilesY);
+            }
+        });
+}
+
+void LightClusterGrid::binSlice(ui32 slice)
+{
+    auto& entries = m_sliceEntries[slice];
+    auto& counts = m_sliceCounts[slice];
+    entries.clear();
+    counts.assign(m_desc.tilesX * m_desc.tilesY, 0);
+
+    const ui32 sliceBase = slice * m_desc.tilesX * m_desc.tilesY;
+    const ui32 lightCount = static_cast<ui32>(m_lightExtents.size());
+
+    auto addEntry = [&entries, &counts](ui32 cluster, ui32 light)
+        {
+            entries.push_back({ cluster, light });
+            ++counts[cluster];
+        };
+
+    for (ui32 light = 0; light < lightCount; ++light)
+    {
+        const LightExtent& extent = m_lightExtents[light];
+        if (slice < extent.firstSlice || slice > extent.lastSlice)
+            continue;
+
+        const float x = m_lightX[light];
+        const float y = m_lightY[light];
+        const float z = m_lightZ[light];
+        const float radiusSquared = m_lightRadius[light] * m_lightRadius[light];
+
+        XMVECTOR lightX = XMVectorReplicate(x);
+        XMVECTOR lightY = XMVectorReplicate(y);
+        XMVECTOR lightZ = XMVectorReplicate(z);
+        XMVECTOR lightRadiusSquared = XMVectorReplicate(radiusSquared);
+
+        for (ui32 tileY = extent.firstTileY; tileY <= extent.lastTileY; ++tileY)
+        {
+            const ui32 rowCluster = tileY * m_desc.tilesX;
+
+            // Four clusters of the row per test
+            ui32 tileX = extent.firstTileX;
+            for (; tileX + 4 <= extent.lastTileX + 1; tileX += 4)
+            {
+                ui32 cluster = sliceBase + rowCluster + tileX;
+                XMVECTOR dx = XMVectorMax(XMVectorSubtract(
+                    XMVectorAbs(XMVectorSubtract(lightX, loadLanes(m_clusterCenterX, cluster))),
+                    loadLanes(m_clusterExtentX, cluster)), XMVectorZero());
+                XMVECTOR dy = XMVectorMax(XMVectorSubtract(
+                    XMVectorAbs(XMVectorSubtract(lightY, loadLanes(m_clusterCenterY, cluster))),
+                    loadLanes(m_clusterExtentY, cluster)), XMVectorZero());
+                XMVECTOR dz = XMVectorMax(XMVectorSubtract(
+                    XMVectorAbs(XMVectorSubtract(lightZ, loadLanes(m_clusterCenterZ, cluster))),
+                    loadLanes(m_clusterExtentZ, cluster)), XMVectorZero());
+                XMVECTOR distanceSquared = XMVectorMultiplyAdd(dz, dz, XMVectorMultiplyAdd(dy, dy, XMVectorMultiply(dx, dx)));
+
+                XMUINT4 inside;
+                XMStoreUInt4(&inside, XMVectorLessOrEqual(distanceSquared, lightRadiusSquared));
+                if (inside.x) addEntry(rowCluster + tileX, light);
+                if (inside.y) addEntry(rowCluster + tileX + 1, light);
+                if (inside.z) addEntry(rowCluster + tileX + 2, light);
+                if (inside.w) addEntry(rowCluster + tileX + 3, light);
+            }
+
+            for (; tileX <= extent.lastTileX; ++tileX)
+            {
+                ui32 cluster = sliceBase + rowCluster + tileX;
+                float distanceSquared = distanceSquaredToBox(x, y, z,
+                    m_clusterCenterX[cluster], m_clusterCenterY[cluster], m_clusterCenterZ[cluster],
+                    m_clusterExtentX[cluster], m_clusterExtentY[cluster], m_clusterExtentZ[cluster]);
+                if (distanceSquared <= radiusSquared)
+                {
+                    addEntry(rowCluster + tileX, light);
+                }
+            }
+        }
+    }
+}
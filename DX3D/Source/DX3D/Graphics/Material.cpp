@@ -1,7 +1,13 @@
 #include <DX3D/Graphics/Material.h>
+#include <atomic>
 
 using namespace dx3d;
 
+namespace
+{
+    std::atomic<ui32> s_nextMaterialSortId{ 1 };
+}
+
 Material::Material()
     : m_name("DefaultMaterial")
     , m_diffuseTexture(nullptr)
@@ -11,6 +17,7 @@ Material::Material()
     , m_emissiveColor(0.0f, 0.0f, 0.0f, 1.0f)   // Black (no emission)
     , m_specularPower(32.0f)
     , m_opacity(1.0f)
+    , m_sortId(s_nextMaterialSortId++)
 {
 }
 
@@ -23,5 +30,6 @@ Material::Material(const std::string& name)
     , m_emissiveColor(0.0f, 0.0f, 0.0f, 1.0f)
     , m_specularPower(32.0f)
     , m_opacity(1.0f)
+    , m_sortId(s_nextMaterialSortId++)
 {
 }
\ No newline at end of file
@@ -1,42 +1,84 @@
 #include <DX3D/Graphics/Mesh.h>
+#include <atomic>
 
 using namespace dx3d;
 
+namespace
+{
+    // Ids below this are left to the built-in primitive meshes
+    constexpr ui32 FIRST_MESH_SORT_ID = 16;
+
+    std::atomic<ui32> s_nextMeshSortId{ FIRST_MESH_SORT_ID };
+}
+
 Mesh::Mesh(const std::string& name)
     : m_name(name)
     , m_vertexBuffer(nullptr)
     , m_indexBuffer(nullptr)
     , m_material(std::make_shared<Material>())
     , m_indexCount(0)
+    , m_sortId(s_nextMeshSortId++)
+    , m_lods(1)
 {
 }
 
 void Mesh::createRenderingResources(
     const std::vector<Vertex>& vertices,
     const std::vector<ui32>& indices,
+    const GraphicsResourceDesc& resourceDesc,
+    const std::vector<MeshLod>& lods)
+{
+    createRenderingResources(
+        vertices.data(), static_cast<ui32>(vertices.size()),
+        indices.data(), static_cast<ui32>(indices.size()),
+        lods.data(), static_cast<ui32>(lods.size()),
+        resourceDesc
+    );
+}
+
+void Mesh::createRenderingResources(
+    const Vertex* vertices, ui32 vertexCount,
+    const ui32* indices, ui32 indexCount,
+    const MeshLod* lods, ui32 lodCount,
     const GraphicsResourceDesc& resourceDesc)
 {
-    if (vertices.empty() || indices.empty())
+    if (vertexCount == 0 || indexCount == 0)
     {
         return;
     }
 
     // Create vertex buffer
     m_vertexBuffer = std::make_shared<VertexBuffer>(
-        vertices.data(),
+        vertices,
         sizeof(Vertex),
-        static_cast<ui32>(vertices.size()),
+        vertexCount,
         resourceDesc
     );
 
     // Create index buffer
     m_indexBuffer = std::make_shared<IndexBuffer>(
-        indices.data(),
-        static_cast<ui32>(indices.size()),
+        indices,
+        indexCount,
         resourceDesc
     );
 
-    m_indexCount = static_cast<ui32>(indices.size());
+    m_lods.assign(lods, lods + lodCount);
+    if (m_lods.empty())
+    {
+        m_lods.push_back({ 0, indexCount, 0.0f });
+    }
+    m_indexCount = m_lods[0].indexCount;
+
+    m_bounds = AABB();
+    m_positions.resize(vertexCount);
+    for (ui32 i = 0; i < vertexCount; ++i)
+    {
+        m_bounds.expand(vertices[i].position);
+        m_positions[i] = vertices[i].position;
+    }
+
+    m_indices.assign(indices + m_lods[0].firstIndex, indices + m_lods[0].firstIndex + m_indexCount);
+    m_triangleBVH.clear();
 }
 
 bool Mesh::isReadyForRendering() const
@@ -45,4 +87,38 @@ bool Mesh::isReadyForRendering() const
         m_indexBuffer != nullptr &&
         m_material != nullptr &&
         m_indexCount > 0;
-}
\ No newline at end of file
+}
+
+bool Mesh::raycast(const Ray& ray, float& maxT) const
+{
+    ui32 triangleCount = static_cast<ui32>(m_indices.size() / 3);
+    if (triangleCount == 0)
+        return false;
+
+    if (m_triangleBVH.isEmpty())
+    {
+        std::vector<AABB> triangleBounds(triangleCount);
+        for (ui32 triangle = 0; triangle < triangleCount; ++triangle)
+        {
+            for (ui32 corner = 0; corner < 3; ++corner)
+            {
+                triangleBounds[triangle].expand(m_positions[m_indices[triangle * 3 + corner]]);
+            }
+        }
+        m_triangleBVH.build(triangleBounds);
+    }
+
+    return m_triangleBVH.raycast(ray, maxT, [this, &ray](ui32 triangle, float& closestT) {
+        float t = 0.0f;
+        if (!intersectRayTriangle(ray,
+            m_positions[m_indices[triangle * 3]],
+            m_positions[m_indices[triangle * 3 + 1]],
+            m_positions[m_indices[triangle * 3 + 2]], t) || t >= closestT)
+        {
+            return false;
+        }
+
+        closestT = t;
+        return true;
+        });
+}
@@ -0,0 +1,522 @@
+#include <DX3D/Graphics/MeshLod.h>
+#include <DX3D/Math/Bounds.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+
+using namespace dx3d;
+
+namespace
+{
+    // Open edges (leaves, window frames, cut geometry) get a plane quadric this much stronger
+    // than the faces, so the outline survives
+    constexpr double BORDER_WEIGHT = 10.0;
+
+    // A collapse may not turn any remaining triangle by more than about 80 degrees
+    constexpr double MIN_NORMAL_DOT = 0.2;
+
+    // A level is only kept if it drops at least this share of the previous level's triangles
+    constexpr float MIN_LEVEL_REDUCTION = 0.1f;
+
+    struct Vector3d
+    {
+        double x = 0.0, y = 0.0, z = 0.0;
+
+        Vector3d() = default;
+        Vector3d(double x, double y, double z) : x(x), y(y), z(z) {}
+        explicit Vector3d(const Vector3& v) : x(v.x), y(v.y), z(v.z) {}
+
+        Vector3d operator-(const Vector3d& o) const { return Vector3d(x - o.x, y - o.y, z - o.z); }
+        double dot(const Vector3d& o) const { return x * o.x + y * o.y + z * o.z; }
+        Vector3d cross(const Vector3d& o) const { return Vector3d(y * o.z - z * o.y, z * o.x - x * o.z, x * o.y - y * o.x); }
+        double length() const { return std::sqrt(dot(*this)); }
+    };
+
+    // Symmetric 4x4 plane quadric (upper triangle) plus the total weight of its planes, so
+    // evaluate() returns a weighted mean squared distance in mesh units
+    struct Quadric
+    {
+        double a2 = 0, ab = 0, ac = 0, ad = 0, b2 = 0, bc = 0, bd = 0, c2 = 0, cd = 0, d2 = 0;
+        double weight = 0;
+
+        static Quadric fromPlane(const Vector3d& normal, double d, double planeWeight)
+        {
+            Quadric q;
+            q.a2 = normal.x * normal.x * planeWeight;
+            q.ab = normal.x * normal.y * planeWeight;
+            q.ac = normal.x * normal.z * planeWeight;
+            q.ad = normal.x * d * planeWeight;
+            q.b2 = normal.y * normal.y * planeWeight;
+            q.bc = normal.y * normal.z * planeWeight;
+            q.bd = normal.y * d * planeWeight;
+            q.c2 = normal.z * normal.z * planeWeight;
+            q.cd = normal.z * d * planeWeight;
+            q.d2 = d * d * planeWeight;
+            q.weight = planeWeight;
+            return q;
+        }
+
+        Quadric& operator+=(const Quadric& o)
+        {
+            a2 += o.a2; ab += o.ab; ac += o.ac; ad += o.ad; b2 += o.b2;
+            bc += o.bc; bd += o.bd; c2 += o.c2; cd += o.cd; d2 += o.d2;
+            weight += o.weight;
+            return *this;
+        }
+
+        double evaluate(const Vector3d& p) const
+        {
+            double error = a2 * p.x * p.x + 2.0 * ab * p.x * p.y + 2.0 * ac * p.x * p.z + 2.0 * ad * p.x +
+                b2 * p.y * p.y + 2.0 * bc * p.y * p.z + 2.0 * bd * p.y +
+                c2 * p.z * p.z + 2.0 * cd * p.z + d2;
+            return weight > 0.0 ? std::max(error, 0.0) / weight : 0.0;
+        }
+    };
+
+    struct PositionKey
+    {
+        ui32 bits[3];
+        bool operator==(const PositionKey& o) const { return std::memcmp(bits, o.bits, sizeof(bits)) == 0; }
+    };
+
+    struct PositionKeyHash
+    {
+        size_t operator()(const PositionKey& key) const
+        {
+            return (key.bits[0] * 73856093u) ^ (key.bits[1] * 19349663u) ^ (key.bits[2] * 83492791u);
+        }
+    };
+
+    // Moving vertex `from` onto its neighbour `to`; versions detect entries made stale by later collapses
+    struct Collapse
+    {
+        double cost;
+        ui32 from;
+        ui32 to;
+        ui32 fromVersion;
+        ui32 toVersion;
+
+        bool operator>(const Collapse& o) const { return cost > o.cost; }
+    };
+
+    class QuadricSimplifier
+    {
+    public:
+        QuadricSimplifier(const std::vector<Vertex>& vertices, const std::vector<ui32>& indices);
+
+        // Collapses the cheapest edges until at most targetTriangles remain or the next collapse
+        // would cost more than maxCost. Returns the largest cost accepted so far.
+        double simplify(ui32 targetTriangles, double maxCost);
+
+        ui32 getTriangleCount() const { return m_liveTriangles; }
+        void appendIndices(std::vector<ui32>& indices) const;
+
+    private:
+        void pushEdge(ui32 a, ui32 b);
+        bool isCollapseValid(ui32 from, ui32 to);
+        void collapse(ui32 from, ui32 to);
+        void gatherNeighbours(ui32 vertex, std::vector<ui32>& neighbours) const;
+        ui32 pickWedge(ui32 position, ui32 sourceVertex) const;
+
+    private:
+        const std::vector<Vertex>& m_vertices;
+
+        // Welded positions and, per position, the source vertices (wedges) sitting on it
+        std::vector<Vector3d> m_positions;
+        std::vector<ui32> m_wedgeStart;
+        std::vector<ui32> m_wedges;
+
+        // Triangles by welded position, and the source vertex each corner draws with
+        std::vector<ui32> m_triangles;
+        std::vector<ui32> m_corners;
+        std::vector<char> m_triangleAlive;
+        ui32 m_liveTriangles = 0;
+
+        std::vector<std::vector<ui32>> m_positionTriangles;
+        std::vector<Quadric> m_quadrics;
+        std::vector<ui32> m_versions;
+        std::vector<char> m_removed;
+
+        std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> m_queue;
+        double m_maxAcceptedCost = 0.0;
+
+        // Scratch for the link condition test
+        std::vector<ui32> m_neighboursA;
+        std::vector<ui32> m_neighboursB;
+    };
+
+    QuadricSimplifier::QuadricSimplifier(const std::vector<Vertex>& vertices, const std::vector<ui32>& indices)
+        : m_vertices(vertices)
+    {
+        // Weld by exact position, so faces that only share corners through duplicated vertices
+        // (separate normals or uvs) still form one connected surface
+        std::unordered_map<PositionKey, ui32, PositionKeyHash> positionIds;
+        positionIds.reserve(vertices.size());
+        std::vector<ui32> vertexPositions(vertices.size());
+        for (ui32 i = 0; i < static_cast<ui32>(vertices.size()); ++i)
+        {
+            PositionKey key;
+            std::memcpy(key.bits, &vertices[i].position, sizeof(key.bits));
+            auto result = positionIds.emplace(key, static_cast<ui32>(m_positions.size()));
+            if (result.second)
+            {
+                m_positions.push_back(Vector3d(vertices[i].position));
+            }
+            vertexPositions[i] = result.first->second;
+        }
+
+        const ui32 positionCount = static_cast<ui32>(m_positions.size());
+        m_wedgeStart.assign(positionCount + 1, 0);
+        for (ui32 position : vertexPositions)
+        {
+            ++m_wedgeStart[position + 1];
+        }
+        for (ui32 i = 0; i < positionCount; ++i)
+        {
+            m_wedgeStart[i + 1] += m_wedgeStart[i];
+        }
+        m_wedges.resize(vertices.size());
+        std::vector<ui32> cursor(m_wedgeStart.begin(), m_wedgeStart.end() - 1);
+        for (ui32 i = 0; i < static_cast<ui32>(vertices.size()); ++i)
+        {
+            m_wedges[cursor[vertexPositions[i]]++] = i;
+        }
+
+        // Triangles collapsed to a line or point in position space carry no area and are dropped
+        for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            ui32 a = vertexPositions[indices[i]];
+            ui32 b = vertexPositions[indices[i + 1]];
+            ui32 c = vertexPositions[indices[i + 2]];
+            if (a == b || b == c || a == c)
+                continue;
+
+            m_triangles.insert(m_triangles.end(), { a, b, c });
+            m_corners.insert(m_corners.end(), { indices[i], indices[i + 1], indices[i + 2] });
+        }
+
+        const ui32 triangleCount = static_cast<ui32>(m_triangles.size() / 3);
+        m_triangleAlive.assign(triangleCount, 1);
+        m_liveTriangles = triangleCount;
+
+        m_positionTriangles.resize(positionCount);
+        m_quadrics.resize(positionCount);
+        m_versions.assign(positionCount, 0);
+        m_removed.assign(positionCount, 0);
+
+        // Area-weighted face planes, and for every edge how many faces use it and one of them
+        struct EdgeUse
+        {
+            ui32 count;
+            ui32 triangle;
+        };
+        std::unordered_map<ui64, EdgeUse> edges;
+        edges.reserve(m_triangles.size());
+
+        for (ui32 t = 0; t < triangleCount; ++t)
+        {
+            const ui32* corners = &m_triangles[t * 3];
+            Vector3d normal = (m_positions[corners[1]] - m_positions[corners[0]]).cross(m_positions[corners[2]] - m_positions[corners[0]]);
+            double length = normal.length();
+            if (length > 0.0)
+            {
+                normal = Vector3d(normal.x / length, normal.y / length, normal.z / length);
+                Quadric quadric = Quadric::fromPlane(normal, -normal.dot(m_positions[corners[0]]), length * 0.5);
+                for (ui32 k = 0; k < 3; ++k)
+                {
+                    m_quadrics[corners[k]] += quadric;
+                }
+            }
+
+            for (ui32 k = 0; k < 3; ++k)
+            {
+                m_positionTriangles[corners[k]].push_back(t);
+
+                ui32 a = std::min(corners[k], corners[(k + 1) % 3]);
+                ui32 b = std::max(corners[k], corners[(k + 1) % 3]);
+                auto& use = edges.try_emplace(static_cast<ui64>(a) << 32 | b, EdgeUse{ 0, t }).first->second;
+                ++use.count;
+            }
+        }
+
+        for (const auto& [key, use] : edges)
+        {
+            ui32 a = static_cast<ui32>(key >> 32);
+            ui32 b = static_cast<ui32>(key & 0xFFFFFFFFu);
+
+            if (use.count == 1)
+            {
+                // Plane through the border edge, perpendicular to its face
+                const ui32* corners = &m_triangles[use.triangle * 3];
+                Vector3d faceNormal = (m_positions[corners[1]] - m_positions[corners[0]]).cross(m_positions[corners[2]] - m_positions[corners[0]]);
+                Vector3d edge = m_positions[b] - m_positions[a];
+                Vector3d normal = edge.cross(faceNormal);
+                double length = normal.length();
+                if (length > 0.0)
+                {
+                    normal = Vector3d(normal.x / length, normal.y / length, normal.z / length);
+                    Quadric quadric = Quadric::fromPlane(normal, -normal.dot(m_positions[a]), BORDER_WEIGHT * edge.dot(edge));
+                    m_quadrics[a] += quadric;
+                    m_quadrics[b] += quadric;
+                }
+            }
+        }
+
+        for (const auto& entry : edges)
+        {
+            pushEdge(static_cast<ui32>(entry.first >> 32), static_cast<ui32>(entry.first & 0xFFFFFFFFu));
+        }
+    }
+
+    void QuadricSimplifier::pushEdge(ui32 a, ui32 b)
+    {
+        Quadric quadric = m_quadrics[a];
+        quadric += m_quadrics[b];
+
+        // Keep whichever endpoint fits both neighbourhoods better
+        double costAToB = quadric.evaluate(m_positions[b]);
+        double costBToA = quadric.evaluate(m_positions[a]);
+        if (costAToB <= costBToA)
+            m_queue.push({ costAToB, a, b, m_versions[a], m_versions[b] });
+        else
+            m_queue.push({ costBToA, b, a, m_versions[b], m_versions[a] });
+    }
+
+    void QuadricSimplifier::gatherNeighbours(ui32 vertex, std::vector<ui32>& neighbours) const
+    {
+        neighbours.clear();
+        for (ui32 t : m_positionTriangles[vertex])
+        {
+            if (!m_triangleAlive[t])
+                continue;
+            for (ui32 k = 0; k < 3; ++k)
+            {
+                if (m_triangles[t * 3 + k] != vertex)
+                    neighbours.push_back(m_triangles[t * 3 + k]);
+            }
+        }
+        std::sort(neighbours.begin(), neighbours.end());
+        neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+    }
+
+    bool QuadricSimplifier::isCollapseValid(ui32 from, ui32 to)
+    {
+        // Link condition: an edge shared by two faces has exactly two common neighbours (one on a
+        // border); more would pinch the surface into a non-manifold fin
+        gatherNeighbours(from, m_neighboursA);
+        gatherNeighbours(to, m_neighboursB);
+        ui32 shared = 0;
+        for (size_t i = 0, j = 0; i < m_neighboursA.size() && j < m_neighboursB.size();)
+        {
+            if (m_neighboursA[i] < m_neighboursB[j]) ++i;
+            else if (m_neighboursB[j] < m_neighboursA[i]) ++j;
+            else { ++shared; ++i; ++j; }
+        }
+        if (shared > 2)
+            return false;
+
+        // No remaining face around `from` may flip or collapse to a sliver
+        const Vector3d& target = m_positions[to];
+        for (ui32 t : m_positionTriangles[from])
+        {
+            if (!m_triangleAlive[t])
+                continue;
+
+            const ui32* corners = &m_triangles[t * 3];
+            if (corners[0] == to || corners[1] == to || corners[2] == to)
+                continue;
+
+            Vector3d before[3];
+            Vector3d after[3];
+            for (ui32 k = 0; k < 3; ++k)
+            {
+                before[k] = m_positions[corners[k]];
+                after[k] = corners[k] == from ? target : before[k];
+            }
+
+            Vector3d normalBefore = (before[1] - before[0]).cross(before[2] - before[0]);
+            Vector3d normalAfter = (after[1] - after[0]).cross(after[2] - after[0]);
+            double lengths = normalBefore.length() * normalAfter.length();
+            if (lengths <= 0.0 || normalBefore.dot(normalAfter) < MIN_NORMAL_DOT * lengths)
+                return false;
+        }
+        return true;
+    }
+
+    ui32 QuadricSimplifier::pickWedge(ui32 position, ui32 sourceVertex) const
+    {
+        // The vertex on the new position whose normal is closest keeps shading (and usually uvs) continuous
+        const Vector3& normal = m_vertices[sourceVertex].normal;
+        ui32 best = m_wedges[m_wedgeStart[position]];
+        float bestDot = -2.0f;
+        for (ui32 i = m_wedgeStart[position]; i < m_wedgeStart[position + 1]; ++i)
+        {
+            float d = Vector3::Dot(normal, m_vertices[m_wedges[i]].normal);
+            if (d > bestDot)
+            {
+                bestDot = d;
+                best = m_wedges[i];
+            }
+        }
+        return best;
+    }
+
+    void QuadricSimplifier::collapse(ui32 from, ui32 to)
+    {
+        auto& toTriangles = m_positionTriangles[to];
+        for (ui32 t : m_positionTriangles[from])
+        {
+            if (!m_triangleAlive[t])
+                continue;
+
+            ui32* corners = &m_triangles[t * 3];
+            if (corners[0] == to || corners[1] == to || corners[2] == to)
+            {
+                m_triangleAlive[t] = 0;
+                --m_liveTriangles;
+                continue;
+            }
+
+            for (ui32 k = 0; k < 3; ++k)
+            {
+                if (corners[k] == from)
+                {
+                    corners[k] = to;
+                    m_corners[t * 3 + k] = pickWedge(to, m_corners[t * 3 + k]);
+                }
+            }
+            toTriangles.push_back(t);
+        }
+
+        m_positionTriangles[from].clear();
+        m_positionTriangles[from].shrink_to_fit();
+        m_removed[from] = 1;
+        m_quadrics[to] += m_quadrics[from];
+        ++m_versions[from];
+        ++m_versions[to];
+
+        toTriangles.erase(std::remove_if(toTriangles.begin(), toTriangles.end(),
+            [this](ui32 t) { return !m_triangleAlive[t]; }), toTriangles.end());
+
+        // Every edge around the merged vertex changed cost
+        gatherNeighbours(to, m_neighboursA);
+        for (ui32 neighbour : m_neighboursA)
+        {
+            pushEdge(to, neighbour);
+        }
+    }
+
+    double QuadricSimplifier::simplify(ui32 targetTriangles, double maxCost)
+    {
+        while (m_liveTriangles > targetTriangles && !m_queue.empty())
+        {
+            Collapse candidate = m_queue.top();
+            if (candidate.cost > maxCost)
+                break;
+            m_queue.pop();
+
+            if (m_removed[candidate.from] || m_removed[candidate.to] ||
+                candidate.fromVersion != m_versions[candidate.from] || candidate.toVersion != m_versions[candidate.to])
+                continue;
+
+            if (!isCollapseValid(candidate.from, candidate.to))
+                continue;
+
+            collapse(candidate.from, candidate.to);
+            m_maxAcceptedCost = std::max(m_maxAcceptedCost, candidate.cost);
+        }
+        return m_maxAcceptedCost;
+    }
+
+    void QuadricSimplifier::appendIndices(std::vector<ui32>& indices) const
+    {
+        indices.reserve(indices.size() + m_liveTriangles * 3);
+        for (ui32 t = 0; t < static_cast<ui32>(m_triangleAlive.size()); ++t)
+        {
+            if (m_triangleAlive[t])
+                indices.insert(indices.end(), { m_corners[t * 3], m_corners[t * 3 + 1], m_corners[t * 3 + 2] });
+        }
+    }
+}
+
+MeshLodChain dx3d::buildMeshLodChain(const std::vector<Vertex>& vertices, const std::vector<ui32>& indices,
+    const MeshLodSettings& settings)
+{
+    MeshLodChain chain;
+    chain.indices = indices;
+    chain.lods.push_back({ 0, static_cast<ui32>(indices.size()), 0.0f });
+
+    ui32 lodCount = std::clamp(settings.lodCount, 1u, MAX_MESH_LODS);
+    if (lodCount == 1 || indices.size() < 3)
+        return chain;
+
+    AABB bounds;
+    for (const auto& vertex : vertices)
+    {
+        bounds.expand(vertex.position);
+    }
+    Vector3 extents = bounds.getExtents();
+    double maxError = settings.maxError * 2.0 * std::sqrt(Vector3::Dot(extents, extents));
+    double maxCost = maxError * maxError;
+
+    QuadricSimplifier simplifier(vertices, indices);
+    ui32 previousTriangles = simplifier.getTriangleCount();
+
+    for (ui32 level = 1; level < lodCount; ++level)
+    {
+        ui32 target = static_cast<ui32>(previousTriangles * settings.reduction);
+        double cost = simplifier.simplify(target, maxCost);
+
+        ui32 triangles = simplifier.getTriangleCount();
+        if (triangles == 0 || triangles > previousTriangles * (1.0f - MIN_LEVEL_REDUCTION))
+            break;
+
+        MeshLod lod;
+        lod.firstIndex = static_cast<ui32>(chain.indices.size());
+        lod.indexCount = triangles * 3;
+        lod.error = static_cast<float>(std::sqrt(cost));
+        simplifier.appendIndices(chain.indices);
+        chain.lods.push_back(lod);
+
+        previousTriangles = triangles;
+    }
+
+    return chain;
+}
+
+float dx3d::getProjectedScreenSize(float radius, float viewDepth, const Matrix4x4& projection)
+{
+    // Perspective projections copy view depth into w; dividing by it shrinks distant objects
+    bool isPerspective = projection.m[2][3] != 0.0f;
+    float size = radius * projection.m[1][1];
+    return isPerspective ? size / std::max(viewDepth, 1e-4f) : size;
+}
+
+ui32 dx3d::selectMeshLod(float screenSize, ui32 lodCount, ui32 currentLod)
+{
+    if (lodCount <= 1)
+        return 0;
+
+    ui32 target = 0;
+    while (target + 1 < lodCount && screenSize < MESH_LOD_SCREEN_SIZES[target])
+    {
+        ++target;
+    }
+
+    if (currentLod >= lodCount)
+        return target;
+
+    // Step towards the new level only as far as the size clears each threshold by the margin
+    while (target > currentLod && screenSize >= MESH_LOD_SCREEN_SIZES[target - 1] * (1.0f - MESH_LOD_HYSTERESIS))
+    {
+        --target;
+    }
+    while (target < currentLod && screenSize <= MESH_LOD_SCREEN_SIZES[target] * (1.0f + MESH_LOD_HYSTERESIS))
+    {
+        ++target;
+    }
+    return target;
+}
@@ -0,0 +1,159 @@
+#include <DX3D/Graphics/MeshOptimizer.h>
+#include <algorithm>
+
+using namespace dx3d;
+
+namespace
+{
+    constexpr ui32 INVALID_VERTEX = ~0u;
+}
+
+void dx3d::optimizeVertexCache(ui32* indices, ui32 indexCount, ui32 vertexCount, ui32 cacheSize)
+{
+    const ui32 triangleCount = indexCount / 3;
+    if (triangleCount == 0 || vertexCount == 0)
+        return;
+
+    // Triangles around each vertex, and how many of them are still to be emitted
+    std::vector<ui32> liveTriangles(vertexCount, 0);
+    for (ui32 i = 0; i < triangleCount * 3; ++i)
+    {
+        ++liveTriangles[indices[i]];
+    }
+
+    std::vector<ui32> adjacencyStart(vertexCount + 1, 0);
+    for (ui32 v = 0; v < vertexCount; ++v)
+    {
+        adjacencyStart[v + 1] = adjacencyStart[v] + liveTriangles[v];
+    }
+
+    std::vector<ui32> adjacency(triangleCount * 3);
+    std::vector<ui32> cursor(adjacencyStart.begin(), adjacencyStart.end() - 1);
+    for (ui32 i = 0; i < triangleCount * 3; ++i)
+    {
+        adjacency[cursor[indices[i]]++] = i / 3;
+    }
+
+    // A vertex is in the cache while fewer than cacheSize vertices entered after it
+    std::vector<ui32> cacheTime(vertexCount, 0);
+    ui32 timeStamp = cacheSize + 1;
+
+    std::vector<char> emitted(triangleCount, 0);
+    std::vector<ui32> deadEnd;
+    std::vector<ui32> candidates;
+    std::vector<ui32> output;
+    output.reserve(triangleCount * 3);
+
+    ui32 fanningVertex = 0;
+    ui32 nextInputVertex = 1;
+
+    while (fanningVertex != INVALID_VERTEX)
+    {
+        candidates.clear();
+
+        // Emit every remaining triangle around the fanning vertex
+        for (ui32 a = adjacencyStart[fanningVertex]; a < adjacencyStart[fanningVertex + 1]; ++a)
+        {
+            ui32 triangle = adjacency[a];
+            if (emitted[triangle])
+                continue;
+            emitted[triangle] = 1;
+
+            for (ui32 k = 0; k < 3; ++k)
+            {
+                ui32 vertex = indices[triangle * 3 + k];
+                output.push_back(vertex);
+                deadEnd.push_back(vertex);
+                candidates.push_back(vertex);
+                --liveTriangles[vertex];
+
+                if (timeStamp - cacheTime[vertex] > cacheSize)
+                {
+                    cacheTime[vertex] = timeStamp++;
+                }
+            }
+        }
+
+        // Next fan: the candidate that stays in the cache for all its remaining triangles and
+        // entered it earliest, so its fan uses the cache before the vertex is evicted
+        fanningVertex = INVALID_VERTEX;
+        int bestPriority = -1;
+        for (ui32 vertex : candidates)
+        {
+            if (liveTriangles[vertex] == 0)
+                continue;
+
+            int priority = 0;
+            if (timeStamp - cacheTime[vertex] + 2 * liveTriangles[vertex] <= cacheSize)
+            {
+                priority = static_cast<int>(timeStamp - cacheTime[vertex]);
+            }
+            if (priority > bestPriority)
+            {
+                bestPriority = priority;
+                fanningVertex = vertex;
+            }
+        }
+
+        if (fanningVertex != INVALID_VERTEX)
+            continue;
+
+        // Dead end: back up to a recently used vertex with triangles left, then to input order
+        while (!deadEnd.empty() && fanningVertex == INVALID_VERTEX)
+        {
+            ui32 vertex = deadEnd.back();
+            deadEnd.pop_back();
+            if (liveTriangles[vertex] > 0)
+                fanningVertex = vertex;
+        }
+
+        while (nextInputVertex < vertexCount && fanningVertex == INVALID_VERTEX)
+        {
+            if (liveTriangles[nextInputVertex] > 0)
+                fanningVertex = nextInputVertex;
+            ++nextInputVertex;
+        }
+    }
+
+    std::copy(output.begin(), output.end(), indices);
+}
+
+void dx3d::optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<ui32>& indices)
+{
+    std::vector<ui32> remap(vertices.size(), INVALID_VERTEX);
+    std::vector<Vertex> ordered;
+    ordered.reserve(vertices.size());
+
+    for (ui32& index : indices)
+    {
+        if (remap[index] == INVALID_VERTEX)
+        {
+            remap[index] = static_cast<ui32>(ordered.size());
+            ordered.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+
+    vertices.swap(ordered);
+}
+
+float dx3d::computeAverageCacheMissRatio(const ui32* indices, ui32 indexCount, ui32 vertexCount, ui32 cacheSize)
+{
+    const ui32 triangleCount = indexCount / 3;
+    if (triangleCount == 0)
+        return 0.0f;
+
+    // FIFO: a vertex is cached while fewer than cacheSize misses happened since its own
+    std::vector<ui32> missTime(vertexCount, 0);
+    ui32 misses = 0;
+    for (ui32 i = 0; i < triangleCount * 3; ++i)
+    {
+        ui32 vertex = indices[i];
+        if (missTime[vertex] == 0 || misses + 1 - missTime[vertex] > cacheSize)
+        {
+            ++misses;
+            missTime[vertex] = misses;
+        }
+    }
+    return static_cast<float>(misses) / triangleCount;
+}
@@ -1,7 +1,7 @@
 // In Model.cpp - Add the missing implementation
 
 #include <DX3D/Graphics/Primitives/Model.h>
-#include <DX3D/Assets/ModelLoader.h>
+#include <DX3D/Assets/AssetManager.h>
 #include <algorithm>
 
 using namespace dx3d;
@@ -15,11 +15,12 @@ Model::Model(const Vector3& position, const Vector3& rotation, const Vector3& sc
 {
 }
 
-void Model::addMesh(std::shared_ptr<Mesh> mesh)
+void Model::addMesh(std::shared_ptr<const Mesh> mesh)
 {
     if (mesh)
     {
         m_meshes.push_back(mesh);
+        invalidateBounds();
     }
 }
 
@@ -29,15 +30,17 @@ void Model::removeMesh(size_t index)
     {
         auto meshName = m_meshes[index]->getName();
         m_meshes.erase(m_meshes.begin() + index);
+        invalidateBounds();
     }
 }
 
 void Model::clearMeshes()
 {
     m_meshes.clear();
+    invalidateBounds();
 }
 
-std::shared_ptr<Mesh> Model::getMesh(size_t index) const
+std::shared_ptr<const Mesh> Model::getMesh(size_t index) const
 {
     if (index < m_meshes.size())
     {
@@ -46,6 +49,20 @@ std::shared_ptr<Mesh> Model::getMesh(size_t index) const
     return nullptr;
 }
 
+void Model::setAsset(std::shared_ptr<const ModelAsset> asset)
+{
+    m_asset = std::move(asset);
+    m_meshes.clear();
+    if (m_asset)
+    {
+        m_meshes = m_asset->meshes;
+        m_filePath = m_asset->filePath;
+        if (!m_asset->filePath.empty())
+            m_name = m_asset->filePath;
+    }
+    invalidateBounds();
+}
+
 bool Model::isReadyForRendering() const
 {
     if (m_meshes.empty())
@@ -53,7 +70,7 @@ bool Model::isReadyForRendering() const
 
     // Check if all meshes are ready for rendering
     return std::all_of(m_meshes.begin(), m_meshes.end(),
-        [](const std::shared_ptr<Mesh>& mesh) {
+        [](const std::shared_ptr<const Mesh>& mesh) {
             return mesh && mesh->isReadyForRendering();
         });
 }
@@ -66,6 +83,38 @@ void Model::update(float deltaTime)
     // Add any model-specific update logic here if needed
 }
 
+AABB Model::getLocalBounds() const
+{
+    AABB bounds;
+    for (const auto& mesh : m_meshes)
+    {
+        if (mesh)
+        {
+            bounds.expand(mesh->getBounds());
+        }
+    }
+
+    // Nothing loaded yet: fall back to the default unit box
+    return bounds.isValid() ? bounds : AGameObject::getLocalBounds();
+}
+
+bool Model::intersectLocalRay(const Ray& localRay, float& maxT) const
+{
+    // Nothing loaded yet: pick against the placeholder box like any other object
+    if (m_meshes.empty())
+        return AGameObject::intersectLocalRay(localRay, maxT);
+
+    bool hit = false;
+    for (const auto& mesh : m_meshes)
+    {
+        if (mesh && mesh->raycast(localRay, maxT))
+        {
+            hit = true;
+        }
+    }
+    return hit;
+}
+
 CollisionShapeType Model::getCollisionShapeType() const
 {
    
@@ -76,5 +125,5 @@ std::shared_ptr<Model> Model::LoadFromFile(
     const std::string& filePath,
     const GraphicsResourceDesc& resourceDesc)
 {
-    return ModelLoader::LoadModel(filePath, resourceDesc);
+    return AssetManager::getInstance().loadModelSync(filePath, resourceDesc);
 }
\ No newline at end of file
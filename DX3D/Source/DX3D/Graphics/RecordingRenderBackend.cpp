@@ -0,0 +1,123 @@
+#include <DX3D/Graphics/RecordingRenderBackend.h>
+#include <algorithm>
+#include <sstream>
+
+using namespace dx3d;
+
+void RecordingRenderBackend::beginFrame()
+{
+    record(RenderCommandType::BeginFrame);
+}
+
+void RecordingRenderBackend::setSceneConstants(const void* data, ui32 size)
+{
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    m_sceneConstants.assign(bytes, bytes + size);
+    record(RenderCommandType::SetSceneConstants, nullptr, size);
+}
+
+void RecordingRenderBackend::setViewConstants(const ModelViewConstants& constants)
+{
+    m_viewConstants = constants;
+    record(RenderCommandType::SetViewConstants);
+}
+
+ModelInstanceData* RecordingRenderBackend::beginInstances(ui32 instanceCount)
+{
+    m_instances.resize(instanceCount);
+    return m_instances.data();
+}
+
+void RecordingRenderBackend::setShader(RenderShader shader)
+{
+    record(RenderCommandType::SetShader, nullptr, static_cast<ui32>(shader));
+}
+
+void RecordingRenderBackend::setGeometry(const VertexBuffer& vertexBuffer, const IndexBuffer&)
+{
+    record(RenderCommandType::SetGeometry, &vertexBuffer);
+}
+
+void RecordingRenderBackend::setTexture(const Texture2D* texture)
+{
+    record(RenderCommandType::SetTexture, texture);
+}
+
+void RecordingRenderBackend::drawIndexedInstanced(ui32 indexCount, ui32 instanceCount, ui32 firstIndex, ui32 firstInstance)
+{
+    record(RenderCommandType::DrawIndexedInstanced, nullptr, indexCount, instanceCount, firstInstance, firstIndex);
+}
+
+void RecordingRenderBackend::clear()
+{
+    m_commands.clear();
+    m_instances.clear();
+    m_sceneConstants.clear();
+    m_viewConstants = ModelViewConstants{};
+}
+
+void RecordingRenderBackend::record(RenderCommandType type, const void* resource, ui32 arg0, ui32 arg1, ui32 arg2, ui32 arg3)
+{
+    if (!m_recordCommands)
+        return;
+
+    RenderCommand command;
+    command.type = type;
+    command.resource = resource;
+    command.args[0] = arg0;
+    command.args[1] = arg1;
+    command.args[2] = arg2;
+    command.args[3] = arg3;
+    m_commands.push_back(command);
+}
+
+std::string RecordingRenderBackend::toString() const
+{
+    std::vector<const void*> geometry;
+    std::vector<const void*> textures;
+    auto resourceId = [](std::vector<const void*>& seen, const void* resource) {
+        auto it = std::find(seen.begin(), seen.end(), resource);
+        if (it != seen.end())
+            return static_cast<size_t>(it - seen.begin());
+        seen.push_back(resource);
+        return seen.size() - 1;
+        };
+
+    std::ostringstream stream;
+    for (const auto& command : m_commands)
+    {
+        switch (command.type)
+        {
+        case RenderCommandType::BeginFrame:
+            stream << "BeginFrame\n";
+            break;
+        case RenderCommandType::SetSceneConstants:
+            stream << "SetSceneConstants bytes=" << command.args[0] << "\n";
+            break;
+        case RenderCommandType::SetViewConstants:
+            stream << "SetViewConstants\n";
+            break;
+        case RenderCommandType::SetShader:
+            stream << "SetShader " << (command.args[0] == static_cast<ui32>(RenderShader::Depth) ? "Depth" : "Model") << "\n";
+            break;
+        case RenderCommandType::SetGeometry:
+            stream << "SetGeometry mesh" << resourceId(geometry, command.resource) << "\n";
+            break;
+        case RenderCommandType::SetTexture:
+            if (command.resource)
+                stream << "SetTexture texture" << resourceId(textures, command.resource) << "\n";
+            else
+                stream << "SetTexture none\n";
+            break;
+        case RenderCommandType::DrawIndexedInstanced:
+            // Only draws starting past index 0 (coarser mesh LODs) print where they start
+            stream << "DrawIndexedInstanced indices=" << command.args[0] << " instances=" << command.args[1]
+                << " first=" << command.args[2];
+            if (command.args[3])
+                stream << " firstIndex=" << command.args[3];
+            stream << "\n";
+            break;
+        }
+    }
+    return stream.str();
+}
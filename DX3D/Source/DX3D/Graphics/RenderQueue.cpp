@@ -0,0 +1,204 @@
+#include <DX3D/Graphics/RenderQueue.h>
+#include <DX3D/Graphics/RenderBackend.h>
+#include <algorithm>
+
+using namespace dx3d;
+
+namespace
+{
+    constexpr ui32 RADIX_BITS = 8;
+    constexpr ui32 RADIX_BUCKETS = 1u << RADIX_BITS;
+    constexpr ui32 RADIX_PASSES = 64 / RADIX_BITS;
+
+    // Below this a comparison sort beats clearing and walking the histograms
+    constexpr size_t RADIX_MIN_PACKETS = 256;
+}
+
+ui64 RenderQueue::makeSortKey(RenderPass pass, RenderShader shader, ui32 meshId, ui32 materialId, float depth01)
+{
+    constexpr ui32 DEPTH_MAX = (1u << DEPTH_BITS) - 1;
+    float clampedDepth = std::clamp(depth01, 0.0f, 1.0f);
+    ui64 depth = static_cast<ui64>(clampedDepth * DEPTH_MAX);
+
+    return (static_cast<ui64>(pass) & 0xF) << 60 |
+        (static_cast<ui64>(shader) & 0xFF) << 52 |
+        (static_cast<ui64>(meshId) & 0xFFFF) << 36 |
+        (static_cast<ui64>(materialId) & 0xFFFF) << DEPTH_BITS |
+        depth;
+}
+
+void RenderQueue::sort()
+{
+    size_t count = m_packets.size();
+    if (count < RADIX_MIN_PACKETS)
+    {
+        std::stable_sort(m_packets.begin(), m_packets.end(),
+            [](const DrawPacket& a, const DrawPacket& b) { return a.sortKey < b.sortKey; });
+        return;
+    }
+
+    // Sort compact (key, index) pairs and move the packets once at the end
+    m_sortEntries.resize(count);
+    m_sortScratch.resize(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        m_sortEntries[i] = { m_packets[i].sortKey, static_cast<ui32>(i) };
+    }
+
+    // One read pass builds the histograms for every byte
+    std::vector<ui32> histograms(RADIX_PASSES * RADIX_BUCKETS, 0);
+    for (const auto& entry : m_sortEntries)
+    {
+        for (ui32 pass = 0; pass < RADIX_PASSES; ++pass)
+        {
+            ++histograms[pass * RADIX_BUCKETS + ((entry.key >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1))];
+        }
+    }
+
+    std::vector<SortEntry>* source = &m_sortEntries;
+    std::vector<SortEntry>* destination = &m_sortScratch;
+
+    for (ui32 pass = 0; pass < RADIX_PASSES; ++pass)
+    {
+        ui32* histogram = &histograms[pass * RADIX_BUCKETS];
+
+        // All keys share this byte (typical for the pass and shader bits): nothing to reorder
+        ui32 firstKeyBucket = static_cast<ui32>(((*source)[0].key >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1));
+        if (histogram[firstKeyBucket] == count)
+            continue;
+
+        ui32 offset = 0;
+        for (ui32 bucket = 0; bucket < RADIX_BUCKETS; ++bucket)
+        {
+            ui32 bucketCount = histogram[bucket];
+            histogram[bucket] = offset;
+            offset += bucketCount;
+        }
+
+        for (const auto& entry : *source)
+        {
+            ui32 bucket = static_cast<ui32>((entry.key >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1));
+            (*destination)[histogram[bucket]++] = entry;
+        }
+
+        std::swap(source, destination);
+    }
+
+    m_scratch.resize(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        m_scratch[i] = m_packets[(*source)[i].index];
+    }
+    m_packets.swap(m_scratch);
+}
+
+void RenderQueue::buildBatches()
+{
+    m_batches.clear();
+
+    ui32 count = size();
+    for (ui32 i = 0; i < count; ++i)
+    {
+        if (!m_batches.empty() && canShareBatch(m_packets[m_batches.back().firstPacket], m_packets[i]))
+        {
+            ++m_batches.back().instanceCount;
+            continue;
+        }
+
+        m_batches.push_back({ i, 1 });
+    }
+}
+
+bool RenderQueue::canShareBatch(const DrawPacket& a, const DrawPacket& b)
+{
+    // Materials may differ: their constants travel with each instance, only the texture is shared
+    return a.shader == b.shader &&
+        a.vertexBuffer == b.vertexBuffer &&
+        a.indexBuffer == b.indexBuffer &&
+        a.firstIndex == b.firstIndex &&
+        a.indexCount == b.indexCount &&
+        a.texture == b.texture;
+}
+
+RenderStats RenderQueue::submit(RenderBackend& backend, const std::vector<Matrix4x4>& worldMatrices,
+    const Matrix4x4& viewMatrix, const Matrix4x4& projMatrix) const
+{
+    RenderStats stats;
+    if (m_packets.empty())
+        return stats;
+
+    // The view and projection are the same for every instance, so transpose them once
+    ModelViewConstants viewConstants;
+    viewConstants.view = Matrix4x4::fromXMMatrix(DirectX::XMMatrixTranspose(viewMatrix.toXMMatrix()));
+    viewConstants.projection = Matrix4x4::fromXMMatrix(DirectX::XMMatrixTranspose(projMatrix.toXMMatrix()));
+    backend.setViewConstants(viewConstants);
+
+    // A batch's instances start at its first packet
+    ModelInstanceData* instances = backend.beginInstances(size());
+    if (!instances)
+        return stats;
+
+    const Material* constantsMaterial = nullptr;
+    ModelMaterialConstants materialConstants = makeMaterialConstants(nullptr);
+    for (size_t i = 0; i < m_packets.size(); ++i)
+    {
+        const auto& packet = m_packets[i];
+        instances[i].world = worldMatrices[packet.objectIndex];
+
+        // The depth shader only reads the world matrix
+        if (packet.shader == RenderShader::Depth)
+            continue;
+
+        // Packets are sorted by material, so the constants rarely need rebuilding
+        if (packet.material != constantsMaterial)
+        {
+            materialConstants = makeMaterialConstants(packet.material);
+            constantsMaterial = packet.material;
+        }
+        instances[i].material = materialConstants;
+    }
+    backend.endInstances();
+
+    // Batches arrive sorted by state, so only bind what differs from the previous batch
+    RenderShader currentShader = RenderShader::Count;
+    const VertexBuffer* currentVertexBuffer = nullptr;
+    const IndexBuffer* currentIndexBuffer = nullptr;
+    const Texture2D* currentTexture = nullptr;
+    bool textureBound = false;
+
+    for (const auto& batch : m_batches)
+    {
+        const auto& packet = m_packets[batch.firstPacket];
+
+        if (packet.shader != currentShader)
+        {
+            backend.setShader(packet.shader);
+            currentShader = packet.shader;
+            textureBound = false;
+            ++stats.shaderChanges;
+        }
+
+        if (packet.vertexBuffer != currentVertexBuffer || packet.indexBuffer != currentIndexBuffer)
+        {
+            backend.setGeometry(*packet.vertexBuffer, *packet.indexBuffer);
+            currentVertexBuffer = packet.vertexBuffer;
+            currentIndexBuffer = packet.indexBuffer;
+            ++stats.meshChanges;
+        }
+
+        if (currentShader == RenderShader::Model && (!textureBound || packet.texture != currentTexture))
+        {
+            backend.setTexture(packet.texture);
+            currentTexture = packet.texture;
+            textureBound = true;
+            ++stats.materialChanges;
+        }
+
+        backend.drawIndexedInstanced(packet.indexCount, batch.instanceCount, packet.firstIndex, batch.firstPacket);
+        ++stats.drawCalls;
+        stats.instances += batch.instanceCount;
+        stats.triangles += packet.indexCount / 3 * batch.instanceCount;
+    }
+
+    return stats;
+}
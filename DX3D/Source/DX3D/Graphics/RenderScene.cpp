@@ -0,0 +1,120 @@
+#include <DX3D/Graphics/RenderScene.h>
+#include <DX3D/Graphics/Material.h>
+#include <DX3D/Graphics/ShadowCascades.h>
+#include <algorithm>
+
+using namespace dx3d;
+
+void RenderScene::clear()
+{
+    m_bounds.clear();
+    m_worldMatrices.clear();
+    m_casterBounds = AABB();
+    m_draws.clear();
+    m_firstDraw.assign(1, 0);
+}
+
+void RenderScene::reserve(ui32 objectCount)
+{
+    m_bounds.reserve(objectCount);
+    m_worldMatrices.reserve(objectCount);
+    m_firstDraw.reserve(objectCount + 1);
+}
+
+void RenderScene::addObject(const AABB& worldBounds, const Matrix4x4& worldMatrix, bool castsShadow)
+{
+    m_bounds.add(worldBounds);
+    m_worldMatrices.push_back(worldMatrix);
+    m_firstDraw.push_back(m_firstDraw.back());
+    if (castsShadow)
+    {
+        m_casterBounds.expand(worldBounds);
+    }
+}
+
+void RenderScene::addDraw(const RenderSceneDraw& draw)
+{
+    m_draws.push_back(draw);
+    ++m_firstDraw.back();
+}
+
+void dx3d::buildRenderQueue(const RenderScene& scene, RenderViewState& view, RenderPass pass,
+    const Matrix4x4& viewMatrix, const Matrix4x4& projMatrix, float farPlane)
+{
+    auto& renderQueue = view.renderQueue;
+    renderQueue.clear();
+    renderQueue.reserve(static_cast<ui32>(view.visibleObjects.size()));
+
+    const CullingBounds& bounds = scene.getBounds();
+    bool isShadowPass = pass == RenderPass::Shadow;
+    RenderShader shader = isShadowPass ? RenderShader::Depth : RenderShader::Model;
+    float inverseFarPlane = farPlane > 0.0f ? 1.0f / farPlane : 0.0f;
+
+    if (!isShadowPass)
+    {
+        view.objectLods.resize(scene.getObjectCount(), MAX_MESH_LODS);
+    }
+
+    for (ui32 objectIndex : view.visibleObjects)
+    {
+        ui32 drawCount = scene.getDrawCount(objectIndex);
+        if (drawCount == 0)
+            continue;
+
+        // View-space z of the bounds centre; sorting on it draws front to back
+        Vector3 center(bounds.centerX[objectIndex], bounds.centerY[objectIndex], bounds.centerZ[objectIndex]);
+        float viewDepth = center.x * viewMatrix.m[0][2] + center.y * viewMatrix.m[1][2] + center.z * viewMatrix.m[2][2] + viewMatrix.m[3][2];
+        float depth01 = viewDepth * inverseFarPlane;
+
+        // One level for the whole object, from how large its bounds appear
+        float screenSize = getProjectedScreenSize(bounds.radius[objectIndex], viewDepth, projMatrix);
+        ui32 lod = selectMeshLod(screenSize, MAX_MESH_LODS, isShadowPass ? MAX_MESH_LODS : view.objectLods[objectIndex]);
+        if (!isShadowPass)
+        {
+            view.objectLods[objectIndex] = lod;
+        }
+
+        DrawPacket packet;
+        packet.shader = shader;
+        packet.objectIndex = objectIndex;
+
+        const RenderSceneDraw* draws = scene.getDraws(objectIndex);
+        for (ui32 i = 0; i < drawCount; ++i)
+        {
+            const RenderSceneDraw& draw = draws[i];
+            ui32 meshLodIndex = std::min(lod, draw.lodCount - 1);
+            packet.vertexBuffer = draw.vertexBuffer;
+            packet.indexBuffer = draw.indexBuffer;
+            packet.firstIndex = draw.lods[meshLodIndex].firstIndex;
+            packet.indexCount = draw.lods[meshLodIndex].indexCount;
+            packet.material = isShadowPass ? nullptr : draw.material;
+            packet.texture = isShadowPass ? nullptr : draw.texture;
+
+            // Levels of a mesh get neighbouring ids so each level's instances sort together
+            packet.sortKey = RenderQueue::makeSortKey(pass, shader, draw.meshId * MAX_MESH_LODS + meshLodIndex,
+                packet.material ? packet.material->getSortId() : 0, depth01);
+            renderQueue.push(packet);
+        }
+    }
+
+    renderQueue.sort();
+    renderQueue.buildBatches();
+}
+
+RenderStats dx3d::recordSceneView(const RenderScene& scene, RenderViewState& view, RenderBackend& backend,
+    const Matrix4x4& viewMatrix, const Matrix4x4& projMatrix, float farPlane)
+{
+    view.visibleObjects.clear();
+    cullBoxes(Frustum::fromViewProjection(viewMatrix * projMatrix), scene.getBounds(), view.visibleObjects);
+    buildRenderQueue(scene, view, RenderPass::Opaque, viewMatrix, projMatrix, farPlane);
+    return view.renderQueue.submit(backend, scene.getWorldMatrices(), viewMatrix, projMatrix);
+}
+
+RenderStats dx3d::recordShadowCascade(const RenderScene& scene, RenderViewState& view, RenderBackend& backend,
+    const ShadowCascade& cascade)
+{
+    view.visibleObjects.clear();
+    cullShadowCasters(cascade, scene.getBounds(), view.visibleObjects);
+    buildRenderQueue(scene, view, RenderPass::Shadow, cascade.view, cascade.projection, cascade.farPlane);
+    return view.renderQueue.submit(backend, scene.getWorldMatrices(), cascade.view, cascade.projection);
+}
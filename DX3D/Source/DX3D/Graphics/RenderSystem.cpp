@@ -46,6 +46,15 @@ void dx3d::RenderSystem::initializeDeviceContext()
     );
 }
 
+DeviceContextPtr dx3d::RenderSystem::createDeferredContext() const
+{
+    Microsoft::WRL::ComPtr<ID3D11DeviceContext> deferredContext;
+    DX3DGraphicsLogErrorAndThrow(m_d3dDevice->CreateDeferredContext(0, &deferredContext),
+        "CreateDeferredContext failed.");
+
+    return std::make_shared<DeviceContext>(getGraphicsResourceDesc(), deferredContext.Get());
+}
+
 SwapChainPtr dx3d::RenderSystem::createSwapChain(const SwapChainDesc& desc) const
 {
     return std::make_shared<SwapChain>(desc, getGraphicsResourceDesc());
@@ -26,6 +26,9 @@ namespace dx3d
 
         DeviceContext& getDeviceContext() const noexcept;
 
+        // Context for recording command lists on another thread; execute them on getDeviceContext()
+        DeviceContextPtr createDeferredContext() const;
+
     private:
         void initializeDeviceContext();
 
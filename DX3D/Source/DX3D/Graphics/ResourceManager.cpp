@@ -1,9 +1,24 @@
 #include <DX3D/Graphics/ResourceManager.h>
+#include <DX3D/Assets/CookedTexture.h>
 #include <filesystem>
 #include <algorithm>
+#include <chrono>
+#include <cstdio>
 
 using namespace dx3d;
 
+namespace
+{
+    // Cache key of a found texture file. The same file reached through different search paths or
+    // ".." segments gets one key, so it loads (and cooks) once.
+    std::string getTextureKey(const std::string& fullPath)
+    {
+        std::error_code error;
+        std::filesystem::path canonicalPath = std::filesystem::weakly_canonical(fullPath, error);
+        return error ? fullPath : canonicalPath.string();
+    }
+}
+
 // Static member definition
 const std::vector<std::string> ResourceManager::s_texturePaths = {
     "DX3D/Assets/Textures/",
@@ -25,10 +40,21 @@ void ResourceManager::initialize(const GraphicsResourceDesc& resourceDesc)
 
     m_resourceDesc = std::make_unique<GraphicsResourceDesc>(resourceDesc); 
     m_initialized = true;
+    startWorkers();
+}
+
+// Defined here, where TextureData is complete, for the unique_ptr inside TextureJob
+ResourceManager::ResourceManager() = default;
+
+ResourceManager::~ResourceManager()
+{
+    stopWorkers();
 }
 
 void ResourceManager::shutdown()
 {
+    stopWorkers();
+
     std::lock_guard<std::mutex> lock(m_textureMutex);
 
     //DX3DLogInfo(("ResourceManager shutdown - clearing " + std::to_string(m_textureCache.size()) + " cached textures").c_str());
@@ -44,46 +70,62 @@ std::shared_ptr<Texture2D> ResourceManager::loadTexture(const std::string& fileN
         return nullptr;
     }
 
-    if (!m_initialized)
+    if (fileName.empty())
     {
-        //DX3DLogError("ResourceManager not initialized - cannot load texture");
+        //DX3DLogError("Cannot load texture with empty filename");
         return nullptr;
     }
 
-    if (fileName.empty())
+    // Searching the disk and creating the placeholder happen outside the lock, so loads of
+    // other files are not held up behind them
+    std::string fullPath = findTexturePath(fileName);
+    if (fullPath.empty())
     {
-        //DX3DLogError("Cannot load texture with empty filename");
+        //DX3DLogError(("Texture file not found: " + fileName).c_str());
         return nullptr;
     }
 
-    std::lock_guard<std::mutex> lock(m_textureMutex);
-
     // Check if texture is already cached
-    auto it = m_textureCache.find(fileName);
-    if (it != m_textureCache.end())
+    std::string key = getTextureKey(fullPath);
     {
-        //DX3DLogInfo(("Using cached texture: " + fileName).c_str());
-        return it->second;
+        std::lock_guard<std::mutex> lock(m_textureMutex);
+        auto it = m_textureCache.find(key);
+        if (it != m_textureCache.end())
+        {
+            //DX3DLogInfo(("Using cached texture: " + fileName).c_str());
+            return it->second;
+        }
     }
 
-    // Find the texture file
-    std::string fullPath = findTexturePath(fileName);
-    if (fullPath.empty())
+    std::shared_ptr<Texture2D> placeholder;
+    try
+    {
+        placeholder = std::make_shared<Texture2D>(fullPath, nullptr, *m_resourceDesc);
+    }
+    catch (const std::exception&)
     {
-        //DX3DLogError(("Texture file not found: " + fileName).c_str());
         return nullptr;
     }
 
-    try
+    // Another thread may have requested the same file meanwhile; the first one in wins
     {
-        auto texture = std::make_shared<Texture2D>(fullPath, *m_resourceDesc); // Add dereference
-        m_textureCache[fileName] = texture;
-        return texture;
+        std::lock_guard<std::mutex> lock(m_textureMutex);
+        auto inserted = m_textureCache.emplace(key, placeholder);
+        if (!inserted.second)
+        {
+            return inserted.first->second;
+        }
     }
-    catch (const std::exception& e)
+
     {
-        return nullptr;
+        std::lock_guard<std::mutex> lock(m_jobMutex);
+        TextureJob job;
+        job.texture = placeholder;
+        job.fullPath = std::move(fullPath);
+        m_decodeQueue.push_back(std::move(job));
     }
+    m_jobAvailable.notify_one();
+    return placeholder;
 }
 
 std::shared_ptr<Texture2D> ResourceManager::getTexture(const std::string& fileName) const
@@ -91,19 +133,19 @@ std::shared_ptr<Texture2D> ResourceManager::getTexture(const std::string& fileNa
     if (!m_initialized)
         return nullptr;
 
+    std::string fullPath = findTexturePath(fileName);
+    if (fullPath.empty())
+        return nullptr;
+
     std::lock_guard<std::mutex> lock(m_textureMutex);
 
-    auto it = m_textureCache.find(fileName);
+    auto it = m_textureCache.find(getTextureKey(fullPath));
     return (it != m_textureCache.end()) ? it->second : nullptr;
 }
 
 bool ResourceManager::isTextureLoaded(const std::string& fileName) const
 {
-    if (!m_initialized)
-        return false;
-
-    std::lock_guard<std::mutex> lock(m_textureMutex);
-    return m_textureCache.find(fileName) != m_textureCache.end();
+    return getTexture(fileName) != nullptr;
 }
 
 std::shared_ptr<Material> ResourceManager::createMaterial(const std::string& name)
@@ -112,8 +154,77 @@ std::shared_ptr<Material> ResourceManager::createMaterial(const std::string& nam
     return std::make_shared<Material>(materialName);
 }
 
+void ResourceManager::update(float budgetMilliseconds)
+{
+    using Clock = std::chrono::steady_clock;
+    auto start = Clock::now();
+
+    while (true)
+    {
+        TextureJob job;
+        {
+            std::lock_guard<std::mutex> lock(m_jobMutex);
+            if (m_uploadQueue.empty())
+            {
+                return;
+            }
+            job = std::move(m_uploadQueue.front());
+            m_uploadQueue.pop_front();
+        }
+
+        uploadJob(job);
+
+        if (std::chrono::duration<float, std::milli>(Clock::now() - start).count() >= budgetMilliseconds)
+        {
+            return;
+        }
+    }
+}
+
+void ResourceManager::finishLoading()
+{
+    while (true)
+    {
+        TextureJob job;
+        {
+            std::unique_lock<std::mutex> lock(m_jobMutex);
+            m_jobLoaded.wait(lock, [this]()
+                {
+                    return !m_uploadQueue.empty() || (m_decodeQueue.empty() && m_decodingCount == 0) || m_workers.empty();
+                });
+            if (m_uploadQueue.empty())
+            {
+                return;
+            }
+            job = std::move(m_uploadQueue.front());
+            m_uploadQueue.pop_front();
+        }
+
+        uploadJob(job);
+    }
+}
+
+size_t ResourceManager::getPendingTextureCount() const
+{
+    std::lock_guard<std::mutex> lock(m_jobMutex);
+    return m_decodeQueue.size() + m_decodingCount + m_uploadQueue.size();
+}
+
+size_t ResourceManager::getTextureCount() const
+{
+    std::lock_guard<std::mutex> lock(m_textureMutex);
+    return m_textureCache.size();
+}
+
 void ResourceManager::clearTextureCache()
 {
+    // Textures not decoded yet stay placeholders for whoever still holds them
+    {
+        std::lock_guard<std::mutex> lock(m_jobMutex);
+        m_decodeQueue.clear();
+        m_uploadQueue.clear();
+    }
+
     std::lock_guard<std::mutex> lock(m_textureMutex);
 
     //DX3DLogInfo(("Clearing texture cache - removing " + std::to_string(m_textureCache.size()) + " textures").c_str());
@@ -122,9 +233,15 @@ void ResourceManager::clearTextureCache()
 
 void ResourceManager::removeTexture(const std::string& fileName)
 {
+    std::string fullPath = findTexturePath(fileName);
+    if (fullPath.empty())
+    {
+        return;
+    }
+
     std::lock_guard<std::mutex> lock(m_textureMutex);
 
-    auto it = m_textureCache.find(fileName);
+    auto it = m_textureCache.find(getTextureKey(fullPath));
     if (it != m_textureCache.end())
     {
         m_textureCache.erase(it);
@@ -185,4 +302,105 @@ std::string ResourceManager::findTexturePath(const std::string& fileName) const
     }
 
     return ""; // File not found
+}
+
+void ResourceManager::startWorkers()
+{
+    std::lock_guard<std::mutex> lock(m_jobMutex);
+    if (!m_workers.empty())
+    {
+        return;
+    }
+
+    // The main thread uploads and renders; every other core decodes
+    ui32 cores = std::thread::hardware_concurrency();
+    ui32 workerCount = cores > 1 ? cores - 1 : 1;
+
+    m_stopping = false;
+    m_workers.reserve(workerCount);
+    for (ui32 i = 0; i < workerCount; ++i)
+    {
+        m_workers.emplace_back([this]() { workerLoop(); });
+    }
+}
+
+void ResourceManager::stopWorkers()
+{
+    std::vector<std::thread> workers;
+    {
+        std::lock_guard<std::mutex> lock(m_jobMutex);
+        m_stopping = true;
+        m_decodeQueue.clear();
+        m_uploadQueue.clear();
+        workers.swap(m_workers);
+    }
+    m_jobAvailable.notify_all();
+    m_jobLoaded.notify_all();
+
+    // Files already decoding finish first
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+
+    std::lock_guard<std::mutex> lock(m_jobMutex);
+    m_uploadQueue.clear();
+}
+
+void ResourceManager::workerLoop()
+{
+    std::unique_lock<std::mutex> lock(m_jobMutex);
+    while (true)
+    {
+        m_jobAvailable.wait(lock, [this]() { return m_stopping || !m_decodeQueue.empty(); });
+        if (m_stopping)
+        {
+            return;
+        }
+
+        TextureJob job = std::move(m_decodeQueue.front());
+        m_decodeQueue.pop_front();
+        ++m_decodingCount;
+        lock.unlock();
+
+        // Textures dropped from the cache while queued, and held by nobody else, are skipped
+        if (job.texture.use_count() > 1)
+        {
+            auto data = std::make_unique<TextureData>();
+            if (loadTextureData(job.fullPath, *data, job.error))
+            {
+                job.data = std::move(data);
+            }
+        }
+
+        lock.lock();
+        --m_decodingCount;
+        if (!m_stopping)
+        {
+            m_uploadQueue.push_back(std::move(job));
+        }
+        m_jobLoaded.notify_all();
+    }
+}
+
+void ResourceManager::uploadJob(TextureJob& job)
+{
+    if (!job.data)
+    {
+        if (!job.error.empty())
+        {
+            printf("Failed to load texture %s: %s\n", job.fullPath.c_str(), job.error.c_str());
+        }
+        return;
+    }
+
+    try
+    {
+        const auto& mips = job.data->mips;
+        job.texture->upload(mips.data(), static_cast<ui32>(mips.size()));
+    }
+    catch (const std::exception& e)
+    {
+        printf("Failed to upload texture %s: %s\n", job.fullPath.c_str(), e.what());
+    }
 }
\ No newline at end of file
@@ -1,8 +1,51 @@
 #include "DX3D/Graphics/Shaders/ModelVertexShader.h"  
 #include <DX3D/Graphics/Vertex.h>
 #include <DX3D/Graphics/Shaders/ModelShader.h>  
+#include <DX3D/Graphics/Shaders/DepthShader.h>
+#include <cstddef>
+
+using namespace dx3d;
+
+namespace
+{
+    constexpr UINT WORLD_OFFSET = offsetof(ModelInstanceData, world);
+    constexpr UINT MATERIAL_OFFSET = offsetof(ModelInstanceData, material);
+
+    const D3D11_INPUT_ELEMENT_DESC MODEL_INSTANCED_LAYOUT[] = {
+        { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+        { "COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 12, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+        { "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 28, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+        { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 40, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+
+        { "WORLD", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, WORLD_OFFSET, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+        { "WORLD", 1, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, WORLD_OFFSET + 16, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+        { "WORLD", 2, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, WORLD_OFFSET + 32, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+        { "WORLD", 3, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, WORLD_OFFSET + 48, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+        { "MATERIAL", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, MATERIAL_OFFSET, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+        { "MATERIAL", 1, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, MATERIAL_OFFSET + 16, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+        { "MATERIAL", 2, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, MATERIAL_OFFSET + 32, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+        { "MATERIAL", 3, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, MATERIAL_OFFSET + 48, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+        { "MATERIAL", 4, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, MATERIAL_OFFSET + 64, D3D11_INPUT_PER_INSTANCE_DATA, 1 }
+    };
+
+    const D3D11_INPUT_ELEMENT_DESC DEPTH_INSTANCED_LAYOUT[] = {
+        { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+
+        { "WORLD", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, WORLD_OFFSET, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+        { "WORLD", 1, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, WORLD_OFFSET + 16, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+        { "WORLD", 2, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, WORLD_OFFSET + 32, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+        { "WORLD", 3, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, WORLD_OFFSET + 48, D3D11_INPUT_PER_INSTANCE_DATA, 1 }
+    };
+}
 
 std::shared_ptr<dx3d::VertexShader> dx3d::createModelVertexShader(const GraphicsResourceDesc& desc)
 {
-    return std::make_shared<VertexShader>(desc, ModelShader::GetVertexShaderCode());
+    return std::make_shared<VertexShader>(desc, ModelShader::GetVertexShaderCode(),
+        MODEL_INSTANCED_LAYOUT, static_cast<ui32>(ARRAYSIZE(MODEL_INSTANCED_LAYOUT)));
+}
+
+std::shared_ptr<dx3d::VertexShader> dx3d::createDepthVertexShader(const GraphicsResourceDesc& desc)
+{
+    return std::make_shared<VertexShader>(desc, DepthShader::GetVertexShaderCode(),
+        DEPTH_INSTANCED_LAYOUT, static_cast<ui32>(ARRAYSIZE(DEPTH_INSTANCED_LAYOUT)));
 }
\ No newline at end of file
@@ -43,7 +43,24 @@ Microsoft::WRL::ComPtr<ID3DBlob> dx3d::Shader::compileShader(
 }
 
 
+namespace
+{
+    // Vertex layout shared by every shader drawing dx3d::Vertex
+    const D3D11_INPUT_ELEMENT_DESC DEFAULT_VERTEX_LAYOUT[] = {
+        { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+        { "COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 12, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+        { "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 28, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+        { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 40, D3D11_INPUT_PER_VERTEX_DATA, 0 }
+    };
+}
+
 dx3d::VertexShader::VertexShader(const GraphicsResourceDesc& desc, const char* shaderCode)
+    : VertexShader(desc, shaderCode, DEFAULT_VERTEX_LAYOUT, ARRAYSIZE(DEFAULT_VERTEX_LAYOUT))
+{
+}
+
+dx3d::VertexShader::VertexShader(const GraphicsResourceDesc& desc, const char* shaderCode,
+    const D3D11_INPUT_ELEMENT_DESC* layout, ui32 layoutElementCount)
     : Shader(desc)
 {
     try {
@@ -63,19 +80,10 @@ dx3d::VertexShader::VertexShader(const GraphicsResourceDesc& desc, const char* s
         );
         DX3DLogInfo("Vertex shader created successfully.");
 
-        // Define input layout - UPDATED to include all 4 fields
-        D3D11_INPUT_ELEMENT_DESC layout[] = {
-            { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-            { "COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 12, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-            { "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 28, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-            { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 40, D3D11_INPUT_PER_VERTEX_DATA, 0 }
-        };
-
-        // Create input layout - UPDATED element count to 4
         DX3DGraphicsLogErrorAndThrow(
             m_device.CreateInputLayout(
                 layout,
-                4,  // Changed from 2 to 4
+                layoutElementCount,
                 m_blob->GetBufferPointer(),
                 m_blob->GetBufferSize(),
                 &m_inputLayout
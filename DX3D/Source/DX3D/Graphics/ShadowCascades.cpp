@@ -0,0 +1,175 @@
+#include <DX3D/Graphics/ShadowCascades.h>
+#include <algorithm>
+#include <cmath>
+
+using namespace dx3d;
+using namespace DirectX;
+
+namespace
+{
+    // Cascade radii are rounded up to this step so float noise in the slice corners never
+    // changes a cascade's size (and with it the texel grid) from one frame to the next
+    constexpr float RADIUS_QUANTUM = 1.0f / 16.0f;
+
+    Vector3 transformPoint(const Vector3& point, FXMMATRIX matrix)
+    {
+        return Vector3(XMVector3TransformCoord(XMVectorSet(point.x, point.y, point.z, 1.0f), matrix));
+    }
+
+    Vector3 lerp(const Vector3& a, const Vector3& b, float t)
+    {
+        return a + (b - a) * t;
+    }
+}
+
+void dx3d::computeCascadeSplits(float nearPlane, float farPlane, ui32 cascadeCount, float lambda, float* splits)
+{
+    splits[0] = nearPlane;
+    splits[cascadeCount] = farPlane;
+
+    for (ui32 i = 1; i < cascadeCount; ++i)
+    {
+        float fraction = static_cast<float>(i) / cascadeCount;
+        float logSplit = nearPlane * std::pow(farPlane / nearPlane, fraction);
+        float uniformSplit = nearPlane + (farPlane - nearPlane) * fraction;
+        splits[i] = lambda * logSplit + (1.0f - lambda) * uniformSplit;
+    }
+}
+
+Vector4 dx3d::getCascadeAtlasRect(ui32 cascade, ui32 cascadeCount)
+{
+    if (cascadeCount <= 1)
+        return Vector4(1.0f, 1.0f, 0.0f, 0.0f);
+
+    return Vector4(0.5f, 0.5f, (cascade % 2) * 0.5f, (cascade / 2) * 0.5f);
+}
+
+void dx3d::getFrustumSliceCorners(const Matrix4x4& cameraViewProjection, float nearPlane, float farPlane,
+    float splitNear, float splitFar, Vector3 corners[8])
+{
+    static const float ndcCorners[4][2] = { { -1.0f, -1.0f }, { 1.0f, -1.0f }, { 1.0f, 1.0f }, { -1.0f, 1.0f } };
+
+    XMMATRIX inverseViewProjection = XMMatrixInverse(nullptr, cameraViewProjection.toXMMatrix());
+
+    // View depth grows linearly along each corner edge, so the slice corners are plain lerps
+    // between the near and far plane corners
+    float depthRange = farPlane - nearPlane;
+    float nearT = depthRange > 0.0f ? (splitNear - nearPlane) / depthRange : 0.0f;
+    float farT = depthRange > 0.0f ? (splitFar - nearPlane) / depthRange : 1.0f;
+
+    for (ui32 i = 0; i < 4; ++i)
+    {
+        Vector3 nearCorner = transformPoint(Vector3(ndcCorners[i][0], ndcCorners[i][1], 0.0f), inverseViewProjection);
+        Vector3 farCorner = transformPoint(Vector3(ndcCorners[i][0], ndcCorners[i][1], 1.0f), inverseViewProjection);
+        corners[i] = lerp(nearCorner, farCorner, nearT);
+        corners[i + 4] = lerp(nearCorner, farCorner, farT);
+    }
+}
+
+Matrix4x4 dx3d::createShadowLightView(const Vector3& lightDirection)
+{
+    Vector3 direction = Vector3::Normalize(lightDirection);
+    Vector3 up = std::fabs(direction.y) > 0.99f ? Vector3(0.0f, 0.0f, 1.0f) : Vector3(0.0f, 1.0f, 0.0f);
+    return Matrix4x4::CreateLookAtLH(Vector3(), direction, up);
+}
+
+ShadowCascade dx3d::fitShadowCascade(const Vector3* corners, ui32 cornerCount, const Matrix4x4& lightView,
+    ui32 resolution, const AABB& casterBounds)
+{
+    Vector3 center;
+    for (ui32 i = 0; i < cornerCount; ++i)
+    {
+        center += corners[i];
+    }
+    center *= 1.0f / std::max(cornerCount, 1u);
+
+    float radius = 0.0f;
+    for (ui32 i = 0; i < cornerCount; ++i)
+    {
+        Vector3 offset = corners[i] - center;
+        radius = std::max(radius, std::sqrt(Vector3::Dot(offset, offset)));
+    }
+    radius = std::ceil(radius / RADIUS_QUANTUM) * RADIUS_QUANTUM;
+
+    // Moving the box in whole texels keeps every texel sampling the same world positions
+    Vector3 lightCenter = transformPoint(center, lightView.toXMMatrix());
+    float texelSize = 2.0f * radius / std::max(resolution, 1u);
+    float snappedX = std::floor(lightCenter.x / texelSize) * texelSize;
+    float snappedY = std::floor(lightCenter.y / texelSize) * texelSize;
+
+    float nearZ = lightCenter.z - radius;
+    float farZ = lightCenter.z + radius;
+    AABB lightCasterBounds = casterBounds.transformed(lightView);
+    if (lightCasterBounds.isValid())
+    {
+        nearZ = std::min(nearZ, lightCasterBounds.min.z);
+    }
+
+    // Shifting the view along the light direction moves the near plane to depth 0 without
+    // touching the x/y texel grid
+    ShadowCascade cascade;
+    cascade.view = lightView * Matrix4x4::CreateTranslation(Vector3(0.0f, 0.0f, -nearZ));
+    cascade.farPlane = farZ - nearZ;
+    cascade.projection = Matrix4x4::fromXMMatrix(XMMatrixOrthographicOffCenterLH(
+        snappedX - radius, snappedX + radius, snappedY - radius, snappedY + radius, 0.0f, cascade.farPlane));
+    return cascade;
+}
+
+ui32 dx3d::fitShadowCascades(const Matrix4x4& cameraViewProjection, float nearPlane, float farPlane,
+    const Vector3& lightDirection, ui32 mapResolution, const AABB& casterBounds,
+    const ShadowCascadeSettings& settings, ShadowCascade* cascades)
+{
+    ui32 cascadeCount = std::clamp(settings.cascadeCount, 1u, MAX_SHADOW_CASCADES);
+    float shadowFar = std::max(std::min(farPlane, settings.maxShadowDistance), nearPlane);
+
+    float splits[MAX_SHADOW_CASCADES + 1];
+    computeCascadeSplits(nearPlane, shadowFar, cascadeCount, settings.splitLambda, splits);
+
+    Matrix4x4 lightView = createShadowLightView(lightDirection);
+    for (ui32 i = 0; i < cascadeCount; ++i)
+    {
+        Vector3 corners[8];
+        getFrustumSliceCorners(cameraViewProjection, nearPlane, farPlane, splits[i], splits[i + 1], corners);
+
+        Vector4 atlasRect = getCascadeAtlasRect(i, cascadeCount);
+        ui32 tileResolution = static_cast<ui32>(mapResolution * atlasRect.x);
+
+        cascades[i] = fitShadowCascade(corners, 8, lightView, tileResolution, casterBounds);
+        cascades[i].atlasRect = atlasRect;
+        cascades[i].splitNear = splits[i];
+        cascades[i].splitFar = splits[i + 1];
+    }
+
+    return cascadeCount;
+}
+
+ui32 dx3d::fitShadowCascades(const Matrix4x4& cameraViewProjection, float nearPlane, float farPlane,
+    const Matrix4x4& coveredViewProjection, float coveredNearPlane, float coveredFarPlane,
+    const Vector3& lightDirection, ui32 mapResolution, const AABB& casterBounds,
+    const ShadowCascadeSettings& settings, ShadowCascade* cascades)
+{
+    ui32 cascadeCount = fitShadowCascades(cameraViewProjection, nearPlane, farPlane, lightDirection,
+        mapResolution, casterBounds, settings, cascades);
+
+    // The last cascade's own slice plus everything the covered camera can see shadows in
+    ShadowCascade& last = cascades[cascadeCount - 1];
+    Vector3 corners[16];
+    getFrustumSliceCorners(cameraViewProjection, nearPlane, farPlane, last.splitNear, last.splitFar, corners);
+    float coveredShadowFar = std::max(std::min(coveredFarPlane, settings.maxShadowDistance), coveredNearPlane);
+    getFrustumSliceCorners(coveredViewProjection, coveredNearPlane, coveredFarPlane, coveredNearPlane, coveredShadowFar, corners + 8);
+
+    ShadowCascade widened = fitShadowCascade(corners, 16, createShadowLightView(lightDirection),
+        static_cast<ui32>(mapResolution * last.atlasRect.x), casterBounds);
+    widened.atlasRect = last.atlasRect;
+    widened.splitNear = last.splitNear;
+    widened.splitFar = last.splitFar;
+    last = widened;
+    return cascadeCount;
+}
+
+void dx3d::cullShadowCasters(const ShadowCascade& cascade, const CullingBounds& bounds, std::vector<ui32>& visible)
+{
+    // The box's near plane already reaches back to the furthest caster, so a plain frustum test
+    // keeps everything that can throw a shadow into the cascade
+    cullBoxes(Frustum::fromViewProjection(cascade.getViewProjection()), bounds, visible);
+}
@@ -66,4 +66,14 @@ void dx3d::ShadowMap::setAsRenderTarget(DeviceContext& deviceContext)
     auto d3dContext = deviceContext.getDeviceContext();
     d3dContext->OMSetRenderTargets(0, nullptr, m_depthStencilView.Get());
     d3dContext->RSSetViewports(1, &m_viewport);
+}
+
+void dx3d::ShadowMap::setTileViewport(DeviceContext& deviceContext, const Vector4& atlasRect)
+{
+    D3D11_VIEWPORT viewport = m_viewport;
+    viewport.TopLeftX = atlasRect.z * m_width;
+    viewport.TopLeftY = atlasRect.w * m_height;
+    viewport.Width = atlasRect.x * m_width;
+    viewport.Height = atlasRect.y * m_height;
+    deviceContext.getDeviceContext()->RSSetViewports(1, &viewport);
 }
\ No newline at end of file
@@ -0,0 +1,61 @@
+#include <DX3D/Graphics/StructuredBuffer.h>
+#include <DX3D/Graphics/DeviceContext.h>
+#include <algorithm>
+#include <cstring>
+
+dx3d::StructuredBuffer::StructuredBuffer(ui32 elementSize, ui32 elementCapacity, const GraphicsResourceDesc& gDesc)
+    : GraphicsResource(gDesc),
+    m_elementSize(elementSize),
+    m_capacity(std::max(elementCapacity, 1u))
+{
+    createBuffer();
+}
+
+void dx3d::StructuredBuffer::update(DeviceContext& deviceContext, const void* data, ui32 elementCount)
+{
+    // Views bound earlier keep the old buffer alive, so it can be replaced at any time
+    if (elementCount > m_capacity)
+    {
+        m_capacity = std::max(elementCount, m_capacity + m_capacity / 2);
+        m_shaderResourceView.Reset();
+        m_buffer.Reset();
+        createBuffer();
+    }
+
+    D3D11_MAPPED_SUBRESOURCE mappedResource{};
+    HRESULT hr = deviceContext.getDeviceContext()->Map(m_buffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+    if (FAILED(hr))
+    {
+        DX3DLogError("Failed to map structured buffer");
+        return;
+    }
+
+    if (elementCount > 0)
+    {
+        std::memcpy(mappedResource.pData, data, static_cast<size_t>(elementCount) * m_elementSize);
+    }
+    deviceContext.getDeviceContext()->Unmap(m_buffer.Get(), 0);
+}
+
+void dx3d::StructuredBuffer::createBuffer()
+{
+    D3D11_BUFFER_DESC bufferDesc = {};
+    bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+    bufferDesc.ByteWidth = m_elementSize * m_capacity;
+    bufferDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+    bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+    bufferDesc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+    bufferDesc.StructureByteStride = m_elementSize;
+
+    DX3DGraphicsLogErrorAndThrow(m_device.CreateBuffer(&bufferDesc, nullptr, &m_buffer),
+        "Failed to create structured buffer.");
+
+    D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Format = DXGI_FORMAT_UNKNOWN;
+    srvDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+    srvDesc.Buffer.FirstElement = 0;
+    srvDesc.Buffer.NumElements = m_capacity;
+
+    DX3DGraphicsLogErrorAndThrow(m_device.CreateShaderResourceView(m_buffer.Get(), &srvDesc, &m_shaderResourceView),
+        "Failed to create structured buffer view.");
+}
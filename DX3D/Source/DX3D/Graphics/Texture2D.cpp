@@ -1,8 +1,7 @@
 #include <DX3D/Graphics/Texture2D.h>
-#include <wincodec.h>
+#include <DX3D/Assets/CookedTexture.h>
 #include <filesystem>
-
-#pragma comment(lib, "windowscodecs.lib")
+#include <vector>
 
 using namespace dx3d;
 
@@ -13,6 +12,20 @@ Texture2D::Texture2D(const std::string& filePath, const GraphicsResourceDesc& de
     createSamplerState();
 }
 
+Texture2D::Texture2D(const std::string& filePath, const DecodedImage* image, const GraphicsResourceDesc& desc)
+    : GraphicsResource(desc), m_filePath(filePath), m_width(0), m_height(0)
+{
+    if (image)
+    {
+        upload(*image);
+    }
+    else
+    {
+        createPlaceholder();
+    }
+    createSamplerState();
+}
+
 Texture2D::~Texture2D()
 {
 }
@@ -23,151 +36,82 @@ void Texture2D::loadFromFile(const std::string& filePath)
     if (!std::filesystem::exists(filePath))
     {
         DX3DLogError(("Texture file not found: " + filePath).c_str());
-        // Create a 1x1 white texture as fallback
-        m_width = 1;
-        m_height = 1;
-
-        D3D11_TEXTURE2D_DESC textureDesc = {};
-        textureDesc.Width = 1;
-        textureDesc.Height = 1;
-        textureDesc.MipLevels = 1;
-        textureDesc.ArraySize = 1;
-        textureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-        textureDesc.SampleDesc.Count = 1;
-        textureDesc.Usage = D3D11_USAGE_DEFAULT;
-        textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
-
-        uint32_t whitePixel = 0xFFFFFFFF;
-        D3D11_SUBRESOURCE_DATA initData = {};
-        initData.pSysMem = &whitePixel;
-        initData.SysMemPitch = 4;
-
-        DX3DGraphicsLogErrorAndThrow(
-            m_device.CreateTexture2D(&textureDesc, &initData, &m_texture),
-            "Failed to create fallback texture"
-        );
-
-        DX3DGraphicsLogErrorAndThrow(
-            m_device.CreateShaderResourceView(m_texture.Get(), nullptr, &m_shaderResourceView),
-            "Failed to create fallback shader resource view"
-        );
-        return;
-    }
-
-    // Initialize COM
-    HRESULT hr = CoInitialize(nullptr);
-
-    // Create WIC factory
-    Microsoft::WRL::ComPtr<IWICImagingFactory> wicFactory;
-    hr = CoCreateInstance(
-        CLSID_WICImagingFactory,
-        nullptr,
-        CLSCTX_INPROC_SERVER,
-        IID_PPV_ARGS(&wicFactory)
-    );
-
-    if (FAILED(hr))
-    {
-        DX3DLogError("Failed to create WIC factory");
-        return;
-    }
-
-    // Convert string to wide string for WIC
-    std::wstring wideFilePath(filePath.begin(), filePath.end());
-
-    // Create decoder
-    Microsoft::WRL::ComPtr<IWICBitmapDecoder> decoder;
-    hr = wicFactory->CreateDecoderFromFilename(
-        wideFilePath.c_str(),
-        nullptr,
-        GENERIC_READ,
-        WICDecodeMetadataCacheOnLoad,
-        &decoder
-    );
-
-    if (FAILED(hr))
-    {
-        DX3DLogError(("Failed to create decoder for: " + filePath).c_str());
-        return;
-    }
-
-    // Get first frame
-    Microsoft::WRL::ComPtr<IWICBitmapFrameDecode> frame;
-    hr = decoder->GetFrame(0, &frame);
-    if (FAILED(hr))
-    {
-        DX3DLogError("Failed to get frame from image");
-        return;
-    }
-
-    // Convert to RGBA format
-    Microsoft::WRL::ComPtr<IWICFormatConverter> converter;
-    hr = wicFactory->CreateFormatConverter(&converter);
-    if (FAILED(hr))
-    {
-        DX3DLogError("Failed to create format converter");
+        createPlaceholder();
         return;
     }
 
-    hr = converter->Initialize(
-        frame.Get(),
-        GUID_WICPixelFormat32bppRGBA,
-        WICBitmapDitherTypeNone,
-        nullptr,
-        0.0,
-        WICBitmapPaletteTypeCustom
-    );
-
-    if (FAILED(hr))
+    TextureData data;
+    std::string error;
+    if (!loadTextureData(filePath, data, error))
     {
-        DX3DLogError("Failed to initialize format converter");
+        DX3DLogError(error.c_str());
+        createPlaceholder();
         return;
     }
 
-    // Get image dimensions
-    converter->GetSize(&m_width, &m_height);
-
-    // Calculate stride and total size
-    UINT stride = m_width * 4; // 4 bytes per pixel (RGBA)
-    UINT imageSize = stride * m_height;
+    upload(data.mips.data(), static_cast<ui32>(data.mips.size()));
+    DX3DLogInfo(("Texture loaded successfully: " + filePath).c_str());
+}
 
-    // Allocate buffer and copy pixel data
-    std::vector<uint8_t> pixels(imageSize);
-    hr = converter->CopyPixels(nullptr, stride, imageSize, pixels.data());
-    if (FAILED(hr))
-    {
-        DX3DLogError("Failed to copy pixels");
-        return;
-    }
+void Texture2D::upload(const DecodedImage& image)
+{
+    TextureMip mip{ image.width, image.height, image.pixels.data() };
+    upload(&mip, 1);
+}
 
-    // Create D3D11 texture
+void Texture2D::upload(const TextureMip* mips, ui32 mipCount)
+{
+    // sRGB textures keep a UNORM format: shading works on the stored values as they are, and
+    // only the mip filter is done in linear light
     D3D11_TEXTURE2D_DESC textureDesc = {};
-    textureDesc.Width = m_width;
-    textureDesc.Height = m_height;
-    textureDesc.MipLevels = 1;
+    textureDesc.Width = mips[0].width;
+    textureDesc.Height = mips[0].height;
+    textureDesc.MipLevels = mipCount;
     textureDesc.ArraySize = 1;
     textureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
     textureDesc.SampleDesc.Count = 1;
-    textureDesc.Usage = D3D11_USAGE_DEFAULT;
+    textureDesc.Usage = D3D11_USAGE_IMMUTABLE;
     textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
 
-    D3D11_SUBRESOURCE_DATA initData = {};
-    initData.pSysMem = pixels.data();
-    initData.SysMemPitch = stride;
+    // Every level straight from where it was decoded or mapped
+    std::vector<D3D11_SUBRESOURCE_DATA> initData(mipCount);
+    for (ui32 i = 0; i < mipCount; ++i)
+    {
+        initData[i].pSysMem = mips[i].pixels;
+        initData[i].SysMemPitch = mips[i].width * 4;
+    }
 
+    // Built aside so a failure leaves the previous contents in place
+    Microsoft::WRL::ComPtr<ID3D11Texture2D> texture;
+    Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> shaderResourceView;
     DX3DGraphicsLogErrorAndThrow(
-        m_device.CreateTexture2D(&textureDesc, &initData, &m_texture),
-        ("Failed to create texture for: " + filePath).c_str()
+        m_device.CreateTexture2D(&textureDesc, initData.data(), &texture),
+        ("Failed to create texture for: " + m_filePath).c_str()
     );
 
     // Create shader resource view
     DX3DGraphicsLogErrorAndThrow(
-        m_device.CreateShaderResourceView(m_texture.Get(), nullptr, &m_shaderResourceView),
-        ("Failed to create shader resource view for: " + filePath).c_str()
+        m_device.CreateShaderResourceView(texture.Get(), nullptr, &shaderResourceView),
+        ("Failed to create shader resource view for: " + m_filePath).c_str()
     );
 
-    DX3DLogInfo(("Texture loaded successfully: " + filePath).c_str());
-    CoUninitialize();
+    m_texture = std::move(texture);
+    m_shaderResourceView = std::move(shaderResourceView);
+    m_width = mips[0].width;
+    m_height = mips[0].height;
+    m_mipCount = mipCount;
+    m_isPlaceholder = false;
+}
+
+void Texture2D::createPlaceholder()
+{
+    // 1x1 white, which leaves a material's colour unchanged
+    DecodedImage white;
+    white.width = 1;
+    white.height = 1;
+    white.pixels.assign(4, 255);
+    upload(white);
+    m_isPlaceholder = true;
 }
 
 void Texture2D::createSamplerState()
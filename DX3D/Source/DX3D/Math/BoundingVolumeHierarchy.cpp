@@ -0,0 +1,242 @@
+#include <DX3D/Math/BoundingVolumeHierarchy.h>
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+using namespace dx3d;
+
+namespace
+{
+    constexpr ui32 SAH_BIN_COUNT = 12;
+
+    // Past this depth the SAH is swapped for median splits, which halve the item count per
+    // level and so keep the tree within MAX_DEPTH for any 32-bit item count
+    constexpr ui32 MAX_SAH_DEPTH = BoundingVolumeHierarchy::MAX_DEPTH - 32;
+
+    float axisValue(const Vector3& v, ui32 axis)
+    {
+        return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+    }
+
+    float surfaceArea(const AABB& box)
+    {
+        if (!box.isValid())
+            return 0.0f;
+
+        Vector3 size = box.max - box.min;
+        return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+
+    bool sameBounds(const AABB& a, const AABB& b)
+    {
+        return a.min.x == b.min.x && a.min.y == b.min.y && a.min.z == b.min.z &&
+            a.max.x == b.max.x && a.max.y == b.max.y && a.max.z == b.max.z;
+    }
+}
+
+void BoundingVolumeHierarchy::build(const std::vector<AABB>& itemBounds)
+{
+    clear();
+
+    ui32 count = static_cast<ui32>(itemBounds.size());
+    if (count == 0)
+        return;
+
+    m_itemBounds = itemBounds;
+    m_items.resize(count);
+    std::iota(m_items.begin(), m_items.end(), 0u);
+    m_itemLeaf.assign(count, 0);
+
+    std::vector<Vector3> centroids(count);
+    for (ui32 i = 0; i < count; ++i)
+    {
+        centroids[i] = m_itemBounds[i].isValid() ? m_itemBounds[i].getCenter() : Vector3();
+    }
+
+    // A binary tree with at least one item per leaf never needs more than 2n - 1 nodes, so
+    // references into m_nodes stay valid while subdividing
+    m_nodes.reserve(static_cast<size_t>(count) * 2 - 1);
+
+    Node root;
+    root.firstChildOrItem = 0;
+    root.itemCount = count;
+    root.bounds = computeLeafBounds(root);
+    m_nodes.push_back(root);
+
+    subdivide(0, centroids, 0);
+}
+
+void BoundingVolumeHierarchy::clear()
+{
+    m_nodes.clear();
+    m_items.clear();
+    m_itemLeaf.clear();
+    m_itemBounds.clear();
+    m_refitCount = 0;
+}
+
+void BoundingVolumeHierarchy::refit(ui32 item, const AABB& bounds)
+{
+    if (item >= m_itemBounds.size())
+        return;
+
+    m_itemBounds[item] = bounds;
+    ++m_refitCount;
+
+    ui32 nodeIndex = m_itemLeaf[item];
+    AABB leafBounds = computeLeafBounds(m_nodes[nodeIndex]);
+    if (sameBounds(leafBounds, m_nodes[nodeIndex].bounds))
+        return;
+    m_nodes[nodeIndex].bounds = leafBounds;
+
+    // Stop as soon as an ancestor's box comes out unchanged; nothing above it can change either
+    for (ui32 parent = m_nodes[nodeIndex].parent; parent != INVALID_NODE; parent = m_nodes[parent].parent)
+    {
+        ui32 first = m_nodes[parent].firstChildOrItem;
+        AABB merged = m_nodes[first].bounds;
+        merged.expand(m_nodes[first + 1].bounds);
+
+        if (sameBounds(merged, m_nodes[parent].bounds))
+            break;
+        m_nodes[parent].bounds = merged;
+    }
+}
+
+void BoundingVolumeHierarchy::subdivide(ui32 nodeIndex, const std::vector<Vector3>& centroids, ui32 depth)
+{
+    Node& node = m_nodes[nodeIndex];
+    ui32 first = node.firstChildOrItem;
+    ui32 count = node.itemCount;
+
+    if (count <= MAX_LEAF_ITEMS || depth >= MAX_DEPTH)
+    {
+        for (ui32 i = first; i < first + count; ++i)
+        {
+            m_itemLeaf[m_items[i]] = nodeIndex;
+        }
+        return;
+    }
+
+    AABB centroidBounds;
+    for (ui32 i = first; i < first + count; ++i)
+    {
+        centroidBounds.expand(centroids[m_items[i]]);
+    }
+
+    auto begin = m_items.begin() + first;
+    auto end = begin + count;
+    ui32 leftCount = 0;
+
+    if (depth < MAX_SAH_DEPTH)
+    {
+        // Binned SAH: bin centroids along each axis and sweep the bins for the cheapest split plane
+        float bestCost = std::numeric_limits<float>::max();
+        ui32 bestAxis = 0;
+        ui32 bestSplit = 0;
+
+        for (ui32 axis = 0; axis < 3; ++axis)
+        {
+            float axisMin = axisValue(centroidBounds.min, axis);
+            float axisExtent = axisValue(centroidBounds.max, axis) - axisMin;
+            if (axisExtent <= 0.0f)
+                continue;
+
+            AABB binBounds[SAH_BIN_COUNT];
+            ui32 binCounts[SAH_BIN_COUNT] = {};
+            float binScale = SAH_BIN_COUNT / axisExtent;
+
+            for (ui32 i = first; i < first + count; ++i)
+            {
+                ui32 item = m_items[i];
+                ui32 bin = std::min(SAH_BIN_COUNT - 1, static_cast<ui32>((axisValue(centroids[item], axis) - axisMin) * binScale));
+                binBounds[bin].expand(m_itemBounds[item]);
+                ++binCounts[bin];
+            }
+
+            float rightArea[SAH_BIN_COUNT] = {};
+            ui32 rightCount[SAH_BIN_COUNT] = {};
+            AABB accumulated;
+            ui32 accumulatedCount = 0;
+            for (ui32 bin = SAH_BIN_COUNT - 1; bin > 0; --bin)
+            {
+                accumulated.expand(binBounds[bin]);
+                accumulatedCount += binCounts[bin];
+                rightArea[bin] = surfaceArea(accumulated);
+                rightCount[bin] = accumulatedCount;
+            }
+
+            accumulated = AABB();
+            accumulatedCount = 0;
+            for (ui32 split = 1; split < SAH_BIN_COUNT; ++split)
+            {
+                accumulated.expand(binBounds[split - 1]);
+                accumulatedCount += binCounts[split - 1];
+                if (accumulatedCount == 0 || rightCount[split] == 0)
+                    continue;
+
+                float cost = surfaceArea(accumulated) * accumulatedCount + rightArea[split] * rightCount[split];
+                if (cost < bestCost)
+                {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestSplit = split;
+                }
+            }
+        }
+
+        if (bestSplit > 0)
+        {
+            float axisMin = axisValue(centroidBounds.min, bestAxis);
+            float binScale = SAH_BIN_COUNT / (axisValue(centroidBounds.max, bestAxis) - axisMin);
+            auto middle = std::partition(begin, end, [&](ui32 item) {
+                ui32 bin = std::min(SAH_BIN_COUNT - 1, static_cast<ui32>((axisValue(centroids[item], bestAxis) - axisMin) * binScale));
+                return bin < bestSplit;
+                });
+            leftCount = static_cast<ui32>(middle - begin);
+        }
+    }
+
+    // Coincident centroids, no useful plane, or too deep: split at the median of the widest axis
+    if (leftCount == 0 || leftCount == count)
+    {
+        Vector3 extent = centroidBounds.max - centroidBounds.min;
+        ui32 axis = (extent.x >= extent.y && extent.x >= extent.z) ? 0 : (extent.y >= extent.z ? 1 : 2);
+        leftCount = count / 2;
+        std::nth_element(begin, begin + leftCount, end, [&](ui32 a, ui32 b) {
+            return axisValue(centroids[a], axis) < axisValue(centroids[b], axis);
+            });
+    }
+
+    ui32 leftIndex = static_cast<ui32>(m_nodes.size());
+
+    Node left;
+    left.firstChildOrItem = first;
+    left.itemCount = leftCount;
+    left.parent = nodeIndex;
+    left.bounds = computeLeafBounds(left);
+
+    Node right;
+    right.firstChildOrItem = first + leftCount;
+    right.itemCount = count - leftCount;
+    right.parent = nodeIndex;
+    right.bounds = computeLeafBounds(right);
+
+    m_nodes.push_back(left);
+    m_nodes.push_back(right);
+
+    node.firstChildOrItem = leftIndex;
+    node.itemCount = 0;
+
+    subdivide(leftIndex, centroids, depth + 1);
+    subdivide(leftIndex + 1, centroids, depth + 1);
+}
+
+AABB BoundingVolumeHierarchy::computeLeafBounds(const Node& node) const
+{
+    AABB bounds;
+    for (ui32 i = node.firstChildOrItem; i < node.firstChildOrItem + node.itemCount; ++i)
+    {
+        bounds.expand(m_itemBounds[m_items[i]]);
+    }
+    return bounds;
+}
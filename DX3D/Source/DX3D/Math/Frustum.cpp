@@ -0,0 +1,227 @@
+#include <DX3D/Math/Frustum.h>
+
+using namespace dx3d;
+using namespace DirectX;
+
+namespace
+{
+    // Where empty boxes are stored: a point no finite frustum reaches, small enough that
+    // multiplying it by a zero plane component still gives zero rather than NaN
+    constexpr float UNREACHABLE_COORDINATE = 1e30f;
+
+    Vector4 toPlane(FXMVECTOR plane)
+    {
+        XMFLOAT4 result;
+        XMStoreFloat4(&result, XMPlaneNormalize(plane));
+        return Vector4(result.x, result.y, result.z, result.w);
+    }
+
+    // Planes splatted across all four lanes, plus the absolute normals used for box reach
+    struct SplatPlanes
+    {
+        XMVECTOR x[Frustum::PlaneCount];
+        XMVECTOR y[Frustum::PlaneCount];
+        XMVECTOR z[Frustum::PlaneCount];
+        XMVECTOR w[Frustum::PlaneCount];
+        XMVECTOR absX[Frustum::PlaneCount];
+        XMVECTOR absY[Frustum::PlaneCount];
+        XMVECTOR absZ[Frustum::PlaneCount];
+
+        explicit SplatPlanes(const Frustum& frustum)
+        {
+            for (ui32 p = 0; p < Frustum::PlaneCount; ++p)
+            {
+                const Vector4& plane = frustum.planes[p];
+                x[p] = XMVectorReplicate(plane.x);
+                y[p] = XMVectorReplicate(plane.y);
+                z[p] = XMVectorReplicate(plane.z);
+                w[p] = XMVectorReplicate(plane.w);
+                absX[p] = XMVectorAbs(x[p]);
+                absY[p] = XMVectorAbs(y[p]);
+                absZ[p] = XMVectorAbs(z[p]);
+            }
+        }
+    };
+
+    XMVECTOR loadLanes(const std::vector<float>& values, ui32 index)
+    {
+        return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&values[index]));
+    }
+
+    void appendVisibleLanes(FXMVECTOR outside, ui32 first, std::vector<ui32>& visible)
+    {
+        XMUINT4 mask;
+        XMStoreUInt4(&mask, outside);
+        if (!mask.x) visible.push_back(first);
+        if (!mask.y) visible.push_back(first + 1);
+        if (!mask.z) visible.push_back(first + 2);
+        if (!mask.w) visible.push_back(first + 3);
+    }
+}
+
+Frustum Frustum::fromViewProjection(const Matrix4x4& viewProjection)
+{
+    // Row-vector convention (clip = v * M): each plane is a sum of columns of M, which
+    // are the rows of the transpose (Gribb/Hartmann)
+    XMMATRIX columns = XMMatrixTranspose(viewProjection.toXMMatrix());
+
+    Frustum frustum;
+    frustum.planes[Left] = toPlane(XMVectorAdd(columns.r[3], columns.r[0]));
+    frustum.planes[Right] = toPlane(XMVectorSubtract(columns.r[3], columns.r[0]));
+    frustum.planes[Bottom] = toPlane(XMVectorAdd(columns.r[3], columns.r[1]));
+    frustum.planes[Top] = toPlane(XMVectorSubtract(columns.r[3], columns.r[1]));
+    frustum.planes[Near] = toPlane(columns.r[2]);
+    frustum.planes[Far] = toPlane(XMVectorSubtract(columns.r[3], columns.r[2]));
+    return frustum;
+}
+
+bool Frustum::intersects(const AABB& box) const
+{
+    if (!box.isValid())
+        return false;
+
+    Vector3 center = box.getCenter();
+    Vector3 extents = box.getExtents();
+
+    for (const Vector4& plane : planes)
+    {
+        float distance = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w;
+        float reach = extents.x * std::fabs(plane.x) + extents.y * std::fabs(plane.y) + extents.z * std::fabs(plane.z);
+        if (distance + reach < 0.0f)
+            return false;
+    }
+    return true;
+}
+
+bool Frustum::intersects(const BoundingSphere& sphere) const
+{
+    for (const Vector4& plane : planes)
+    {
+        float distance = plane.x * sphere.center.x + plane.y * sphere.center.y + plane.z * sphere.center.z + plane.w;
+        if (distance + sphere.radius < 0.0f)
+            return false;
+    }
+    return true;
+}
+
+void CullingBounds::clear()
+{
+    for (auto* channel : { &centerX, &centerY, &centerZ, &extentX, &extentY, &extentZ, &radius })
+    {
+        channel->clear();
+    }
+}
+
+void CullingBounds::reserve(ui32 count)
+{
+    for (auto* channel : { &centerX, &centerY, &centerZ, &extentX, &extentY, &extentZ, &radius })
+    {
+        channel->reserve(count);
+    }
+}
+
+void CullingBounds::add(const AABB& box)
+{
+    // An empty box keeps its index but must never be visible. Its own extents are -inf,
+    // which turn into NaN against axis-aligned planes and pass every test.
+    if (!box.isValid())
+    {
+        add(BoundingSphere(Vector3(UNREACHABLE_COORDINATE, UNREACHABLE_COORDINATE, UNREACHABLE_COORDINATE), 0.0f));
+        return;
+    }
+
+    Vector3 center = box.getCenter();
+    Vector3 extents = box.getExtents();
+
+    centerX.push_back(center.x);
+    centerY.push_back(center.y);
+    centerZ.push_back(center.z);
+    extentX.push_back(extents.x);
+    extentY.push_back(extents.y);
+    extentZ.push_back(extents.z);
+    radius.push_back(std::sqrt(Vector3::Dot(extents, extents)));
+}
+
+void CullingBounds::add(const BoundingSphere& sphere)
+{
+    centerX.push_back(sphere.center.x);
+    centerY.push_back(sphere.center.y);
+    centerZ.push_back(sphere.center.z);
+    extentX.push_back(sphere.radius);
+    extentY.push_back(sphere.radius);
+    extentZ.push_back(sphere.radius);
+    radius.push_back(sphere.radius);
+}
+
+void dx3d::cullBoxes(const Frustum& frustum, const CullingBounds& bounds, std::vector<ui32>& visible)
+{
+    const ui32 count = bounds.size();
+    const SplatPlanes planes(frustum);
+
+    ui32 i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        XMVECTOR centerX = loadLanes(bounds.centerX, i);
+        XMVECTOR centerY = loadLanes(bounds.centerY, i);
+        XMVECTOR centerZ = loadLanes(bounds.centerZ, i);
+        XMVECTOR extentX = loadLanes(bounds.extentX, i);
+        XMVECTOR extentY = loadLanes(bounds.extentY, i);
+        XMVECTOR extentZ = loadLanes(bounds.extentZ, i);
+
+        XMVECTOR outside = XMVectorFalseInt();
+        for (ui32 p = 0; p < Frustum::PlaneCount; ++p)
+        {
+            XMVECTOR distance = XMVectorMultiplyAdd(centerZ, planes.z[p],
+                XMVectorMultiplyAdd(centerY, planes.y[p], XMVectorMultiplyAdd(centerX, planes.x[p], planes.w[p])));
+            XMVECTOR reach = XMVectorMultiplyAdd(extentZ, planes.absZ[p],
+                XMVectorMultiplyAdd(extentY, planes.absY[p], XMVectorMultiply(extentX, planes.absX[p])));
+            outside = XMVectorOrInt(outside, XMVectorLess(XMVectorAdd(distance, reach), XMVectorZero()));
+        }
+
+        appendVisibleLanes(outside, i, visible);
+    }
+
+    for (; i < count; ++i)
+    {
+        Vector3 center(bounds.centerX[i], bounds.centerY[i], bounds.centerZ[i]);
+        Vector3 extents(bounds.extentX[i], bounds.extentY[i], bounds.extentZ[i]);
+        if (frustum.intersects(AABB(center - extents, center + extents)))
+        {
+            visible.push_back(i);
+        }
+    }
+}
+
+void dx3d::cullSpheres(const Frustum& frustum, const CullingBounds& bounds, std::vector<ui32>& visible)
+{
+    const ui32 count = bounds.size();
+    const SplatPlanes planes(frustum);
+
+    ui32 i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        XMVECTOR centerX = loadLanes(bounds.centerX, i);
+        XMVECTOR centerY = loadLanes(bounds.centerY, i);
+        XMVECTOR centerZ = loadLanes(bounds.centerZ, i);
+        XMVECTOR radius = loadLanes(bounds.radius, i);
+
+        XMVECTOR outside = XMVectorFalseInt();
+        for (ui32 p = 0; p < Frustum::PlaneCount; ++p)
+        {
+            XMVECTOR distance = XMVectorMultiplyAdd(centerZ, planes.z[p],
+                XMVectorMultiplyAdd(centerY, planes.y[p], XMVectorMultiplyAdd(centerX, planes.x[p], planes.w[p])));
+            outside = XMVectorOrInt(outside, XMVectorLess(XMVectorAdd(distance, radius), XMVectorZero()));
+        }
+
+        appendVisibleLanes(outside, i, visible);
+    }
+
+    for (; i < count; ++i)
+    {
+        BoundingSphere sphere(Vector3(bounds.centerX[i], bounds.centerY[i], bounds.centerZ[i]), bounds.radius[i]);
+        if (frustum.intersects(sphere))
+        {
+            visible.push_back(i);
+        }
+    }
+}
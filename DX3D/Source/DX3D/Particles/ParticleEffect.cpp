@@ -0,0 +1,18 @@
+#include <DX3D/Particles/ParticleEffect.h>
+#include <DX3D/Particles/ParticleKernels.h>
+
+using namespace dx3d;
+
+void ParticleEffect::initialize(ParticlePool& pool, ui32 first, ui32 count, ParticleRandom& random)
+{
+    for (ui32 i = first; i < first + count; ++i)
+    {
+        pool.rotation[i] = 0.0f;
+        pool.rotationSpeed[i] = 0.0f;
+    }
+}
+
+void ParticleEffect::update(ParticlePool& pool, ui32 begin, ui32 end, const Vector3& acceleration, float deltaTime)
+{
+    getParticleKernels().integrateBallistic(pool, begin, end, acceleration, deltaTime);
+}
@@ -1,74 +1,33 @@
 ﻿#include <DX3D/Particles/ParticleEffects/SnowParticle.h>
-#include <cmath>
-#include <random>
+#include <DX3D/Particles/ParticleKernels.h>
 
 using namespace dx3d;
 
-SnowParticle::SnowParticle()
-    : Particle()
-    , m_swayAmount(0.5f)
-    , m_swaySpeed(2.0f)
-    , m_swayPhase(0.0f)
-    , m_fallSpeedMultiplier(1.0f)
+void SnowParticleEffect::initialize(ParticlePool& pool, ui32 first, ui32 count, ParticleRandom& random)
 {
-}
-
-void SnowParticle::initialize(const Vector3& position, const Vector3& velocity)
-{
-    Particle::initialize(position, velocity);
-
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    static std::uniform_real_distribution<float> dist(0.0f, 1.0f);
-
-    m_swayAmount = 0.3f + dist(gen) * 0.4f; 
-    m_swaySpeed = 1.5f + dist(gen) * 2.0f;  
-    m_swayPhase = dist(gen) * 6.28318530718f;
-    m_fallSpeedMultiplier = 0.5f + dist(gen) * 0.5f; 
-    m_rotation = dist(gen) * 6.28318530718f;
-    m_rotationSpeed = (dist(gen) - 0.5f) * 2.0f; 
-    m_velocity.y *= m_fallSpeedMultiplier;
-}
-
-bool SnowParticle::update(float deltaTime)
-{
-    if (!m_alive)
-        return false;
-
-    m_age += deltaTime;
+    float* swayAmount = pool.effectData[SwayAmount].data();
+    float* swaySpeed = pool.effectData[SwaySpeed].data();
+    float* swayPhase = pool.effectData[SwayPhase].data();
+    float* fallMultiplier = pool.effectData[FallSpeedMultiplier].data();
 
-    if (m_age >= m_lifetime)
+    for (ui32 i = first; i < first + count; ++i)
     {
-        m_alive = false;
-        return false;
+        swayAmount[i] = 0.3f + random.nextFloat() * 0.4f;
+        swaySpeed[i] = 1.5f + random.nextFloat() * 2.0f;
+        swayPhase[i] = random.nextFloat() * 6.28318530718f;
+        fallMultiplier[i] = 0.5f + random.nextFloat() * 0.5f;
+        pool.rotation[i] = random.nextFloat() * 6.28318530718f;
+        pool.rotationSpeed[i] = (random.nextFloat() - 0.5f) * 2.0f;
+        pool.velocityY[i] *= fallMultiplier[i];
     }
+}
 
-    m_swayPhase += m_swaySpeed * deltaTime;
-
-    float swayX = std::sin(m_swayPhase) * m_swayAmount;
-    float swayZ = std::cos(m_swayPhase * 0.7f) * m_swayAmount * 0.5f;
-
-    Vector3 swayVelocity = m_velocity;
-    swayVelocity.x += swayX;
-    swayVelocity.z += swayZ;
-
-    m_position += swayVelocity * deltaTime;
-    m_velocity += m_acceleration * deltaTime * m_fallSpeedMultiplier;
-    m_rotation += m_rotationSpeed * deltaTime;
-
-    const float twoPi = 6.28318530718f;
-    if (m_rotation > twoPi)
-        m_rotation -= twoPi;
-    else if (m_rotation < 0.0f)
-        m_rotation += twoPi;
-
-    float sizeVariation = 0.9f + 0.1f * std::sin(m_age * 10.0f);
-    m_size = m_size * sizeVariation;
-
-    return true;
+void SnowParticleEffect::update(ParticlePool& pool, ui32 begin, ui32 end, const Vector3& acceleration, float deltaTime)
+{
+    getParticleKernels().integrateSnow(pool, begin, end, acceleration, deltaTime);
 }
 
-std::unique_ptr<Particle> dx3d::createSnowParticle()
+std::shared_ptr<ParticleEffect> dx3d::createSnowParticleEffect()
 {
-    return std::make_unique<SnowParticle>();
-}
\ No newline at end of file
+    return std::make_shared<SnowParticleEffect>();
+}
@@ -1,23 +1,46 @@
 #include <DX3D/Particles/ParticleEmitter.h>
-#include <DX3D/Game/SceneCamera.h>
-#include <random>
+#include <DX3D/Particles/ParticleKernels.h>
+#include <DX3D/Core/JobSystem.h>
 #include <algorithm>
 
 using namespace dx3d;
 
-ParticleEmitter::ParticleEmitter(const EmitterConfig& config, ParticleFactory factory)
+namespace
+{
+    // Calls func(chunkIndex, begin, end) for fixed-size chunks of [first, first + count).
+    // Chunk boundaries depend only on the range, never on the worker count.
+    template<typename Func>
+    void forEachChunk(ui32 first, ui32 count, Func&& func)
+    {
+        const ui32 chunkCount = (count + ParticleEmitter::CHUNK_SIZE - 1) / ParticleEmitter::CHUNK_SIZE;
+        auto runChunk = [&](ui32 chunk)
+        {
+            ui32 begin = first + chunk * ParticleEmitter::CHUNK_SIZE;
+            ui32 end = std::min(begin + ParticleEmitter::CHUNK_SIZE, first + count);
+            func(chunk, begin, end);
+        };
+
+        if (chunkCount == 1)
+        {
+            runChunk(0);
+        }
+        else
+        {
+            JobSystem::getInstance().parallelFor(chunkCount, runChunk);
+        }
+    }
+}
+
+ParticleEmitter::ParticleEmitter(const EmitterConfig& config, std::shared_ptr<ParticleEffect> effect, ui32 seed)
     : m_config(config)
-    , m_particleFactory(factory)
-    , m_activeParticleCount(0)
+    , m_effect(effect ? std::move(effect) : std::make_shared<ParticleEffect>())
     , m_emissionAccumulator(0.0f)
     , m_active(true)
+    , m_seed(seed)
+    , m_spawnBatch(0)
 {
     // Pre-allocate particle pool
-    m_particles.reserve(config.maxParticles);
-    for (ui32 i = 0; i < config.maxParticles; ++i)
-    {
-        m_particles.push_back(m_particleFactory());
-    }
+    m_pool.allocate(config.maxParticles);
 }
 
 ParticleEmitter::~ParticleEmitter()
@@ -26,32 +49,15 @@ ParticleEmitter::~ParticleEmitter()
 
 void ParticleEmitter::update(float deltaTime)
 {
-    // Update existing particles
-    m_activeParticleCount = 0;
-    for (auto& particle : m_particles)
+    // Age particles and drop the expired ones before integrating the survivors
+    killExpiredParticles(deltaTime);
+
+    if (m_pool.aliveCount > 0)
     {
-        if (particle->isAlive())
-        {
-            if (particle->update(deltaTime))
+        forEachChunk(0, m_pool.aliveCount, [this, deltaTime](ui32, ui32 begin, ui32 end)
             {
-                m_activeParticleCount++;
-
-                // Update particle properties based on age
-                float lifeRatio = particle->getAge() / particle->getLifetime();
-
-                // Interpolate color
-                Vector4 color;
-                color.x = m_config.startColor.x + (m_config.endColor.x - m_config.startColor.x) * lifeRatio;
-                color.y = m_config.startColor.y + (m_config.endColor.y - m_config.startColor.y) * lifeRatio;
-                color.z = m_config.startColor.z + (m_config.endColor.z - m_config.startColor.z) * lifeRatio;
-                color.w = m_config.startColor.w + (m_config.endColor.w - m_config.startColor.w) * lifeRatio;
-                particle->setColor(color);
-
-                // Interpolate size
-                float size = m_config.startSize + (m_config.endSize - m_config.startSize) * lifeRatio;
-                particle->setSize(size);
-            }
-        }
+                integrate(begin, end, deltaTime);
+            });
     }
 
     // Spawn new particles if emitter is active
@@ -59,79 +65,131 @@ void ParticleEmitter::update(float deltaTime)
     {
         m_emissionAccumulator += m_config.emissionRate * deltaTime;
 
-        while (m_emissionAccumulator >= 1.0f && m_activeParticleCount < m_config.maxParticles)
+        // Whole particles owed this frame are spawned as one batch; if the pool is full
+        // the remainder stays in the accumulator, as before
+        if (m_emissionAccumulator >= 1.0f)
         {
-            spawnParticle();
-            m_emissionAccumulator -= 1.0f;
+            ui32 spawned = spawnParticles(static_cast<ui32>(m_emissionAccumulator));
+            m_emissionAccumulator -= static_cast<float>(spawned);
         }
     }
 }
 
-void ParticleEmitter::fillInstanceData(std::vector<ParticleInstanceData>& instanceData, const SceneCamera& camera)
+ui32 ParticleEmitter::writeInstanceData(std::span<ParticleInstanceData> destination) const
 {
-    for (const auto& particle : m_particles)
-    {
-        if (particle->isAlive())
-        {
-            ParticleInstanceData data;
-            data.position = particle->getPosition();
-            data.size = particle->getSize();
-            data.color = particle->getColor();
-            data.rotation = particle->getRotation();
+    const ui32 count = std::min(m_pool.aliveCount, static_cast<ui32>(destination.size()));
 
-            instanceData.push_back(data);
-        }
+    for (ui32 i = 0; i < count; ++i)
+    {
+        // Build the whole instance and store it in one go; the destination is usually
+        // write-combined memory, where partial or scattered writes are expensive
+        ParticleInstanceData data;
+        data.position = m_pool.getPosition(i);
+        data.size = m_pool.size[i];
+        data.color = m_pool.getColor(i);
+        data.rotation = m_pool.rotation[i];
+        data._padding[0] = data._padding[1] = data._padding[2] = 0.0f;
+
+        destination[i] = data;
     }
+
+    return count;
 }
 
 void ParticleEmitter::reset()
 {
-    for (auto& particle : m_particles)
-    {
-        particle->reset();
-    }
-    m_activeParticleCount = 0;
+    m_pool.clear();
     m_emissionAccumulator = 0.0f;
+    m_spawnBatch = 0;
+}
+
+ui32 ParticleEmitter::emitBurst(ui32 count)
+{
+    return spawnParticles(count);
 }
 
-void ParticleEmitter::spawnParticle()
+void ParticleEmitter::killExpiredParticles(float deltaTime)
 {
-    // Find an inactive particle to reuse
-    for (auto& particle : m_particles)
+    ui32 i = 0;
+    while (i < m_pool.aliveCount)
     {
-        if (!particle->isAlive())
+        m_pool.age[i] += deltaTime;
+
+        if (m_pool.age[i] >= m_pool.lifetime[i])
         {
-            // Initialize with randomized parameters
-            Vector3 position = randomizeVector(m_config.position, m_config.positionVariance);
-            Vector3 velocity = randomizeVector(m_config.velocity, m_config.velocityVariance);
+            // The last live particle moves into slot i; it has not been aged yet
+            // this frame, so stay on the same index
+            m_pool.kill(i);
+            continue;
+        }
 
-            particle->initialize(position, velocity);
-            particle->setAcceleration(m_config.acceleration);
-            particle->setColor(m_config.startColor);
-            particle->setSize(m_config.startSize);
+        ++i;
+    }
+}
 
-            float lifetime = m_config.lifetime + randomFloat(-m_config.lifetimeVariance, m_config.lifetimeVariance);
-            particle->setLifetime(std::max(0.1f, lifetime));
+void ParticleEmitter::integrate(ui32 begin, ui32 end, float deltaTime)
+{
+    m_effect->update(m_pool, begin, end, m_config.acceleration, deltaTime);
 
-            m_activeParticleCount++;
-            break;
-        }
-    }
+    // Update particle properties based on age
+    getParticleKernels().applyLifetimeGradients(m_pool, begin, end,
+        m_config.startColor, m_config.endColor, m_config.startSize, m_config.endSize);
 }
 
-Vector3 ParticleEmitter::randomizeVector(const Vector3& base, const Vector3& variance)
+ui32 ParticleEmitter::spawnParticles(ui32 count)
 {
-    return Vector3(
-        base.x + randomFloat(-variance.x, variance.x),
-        base.y + randomFloat(-variance.y, variance.y),
-        base.z + randomFloat(-variance.z, variance.z)
-    );
+    // Live particles are packed at the front of the pool, so new ones always take the
+    // slots right after aliveCount; no search for a free slot is needed
+    count = std::min(count, m_pool.capacity() - m_pool.aliveCount);
+    if (count == 0)
+        return 0;
+
+    const ui32 first = m_pool.emplace(count);
+    const std::uint64_t batchSeed = (static_cast<std::uint64_t>(m_seed) << 32) | m_spawnBatch++;
+
+    forEachChunk(first, count, [this, batchSeed](ui32 chunk, ui32 begin, ui32 end)
+        {
+            ParticleRandom random(batchSeed, chunk);
+            initializeParticles(begin, end, random);
+        });
+
+    return count;
+}
+
+void ParticleEmitter::initializeParticles(ui32 begin, ui32 end, ParticleRandom& random)
+{
+    // Initialize with randomized parameters
+    for (ui32 i = begin; i < end; ++i)
+    {
+        Vector3 position = randomizeVector(random, m_config.position, m_config.positionVariance);
+        Vector3 velocity = randomizeVector(random, m_config.velocity, m_config.velocityVariance);
+        float lifetime = m_config.lifetime + random.range(-m_config.lifetimeVariance, m_config.lifetimeVariance);
+
+        m_pool.positionX[i] = position.x;
+        m_pool.positionY[i] = position.y;
+        m_pool.positionZ[i] = position.z;
+        m_pool.velocityX[i] = velocity.x;
+        m_pool.velocityY[i] = velocity.y;
+        m_pool.velocityZ[i] = velocity.z;
+        m_pool.lifetime[i] = std::max(0.1f, lifetime);
+    }
+
+    // Attributes shared by the whole batch
+    std::fill(m_pool.colorR.begin() + begin, m_pool.colorR.begin() + end, m_config.startColor.x);
+    std::fill(m_pool.colorG.begin() + begin, m_pool.colorG.begin() + end, m_config.startColor.y);
+    std::fill(m_pool.colorB.begin() + begin, m_pool.colorB.begin() + end, m_config.startColor.z);
+    std::fill(m_pool.colorA.begin() + begin, m_pool.colorA.begin() + end, m_config.startColor.w);
+    std::fill(m_pool.size.begin() + begin, m_pool.size.begin() + end, m_config.startSize);
+    std::fill(m_pool.age.begin() + begin, m_pool.age.begin() + end, 0.0f);
+
+    m_effect->initialize(m_pool, begin, end - begin, random);
 }
 
-float ParticleEmitter::randomFloat(float min, float max)
+Vector3 ParticleEmitter::randomizeVector(ParticleRandom& random, const Vector3& base, const Vector3& variance)
 {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    std::uniform_real_distribution<float> dist(min, max);
-    return dist(gen);
+    // Separate statements: argument evaluation order would otherwise decide which axis gets which draw
+    float x = base.x + random.range(-variance.x, variance.x);
+    float y = base.y + random.range(-variance.y, variance.y);
+    float z = base.z + random.range(-variance.z, variance.z);
+    return Vector3(x, y, z);
 }
@@ -0,0 +1,31 @@
+#include <DX3D/Particles/ParticleInstanceLayout.h>
+#include <DX3D/Core/JobSystem.h>
+#include <algorithm>
+
+using namespace dx3d;
+
+void ParticleInstanceLayout::clear()
+{
+    m_emitters.clear();
+    m_offsets.assign(1, 0);
+}
+
+void ParticleInstanceLayout::add(const ParticleEmitter& emitter)
+{
+    m_emitters.push_back(&emitter);
+    m_offsets.push_back(m_offsets.back() + emitter.getActiveParticleCount());
+}
+
+ui32 ParticleInstanceLayout::write(std::span<ParticleInstanceData> destination) const
+{
+    const ui32 total = std::min(getInstanceCount(), static_cast<ui32>(destination.size()));
+
+    JobSystem::getInstance().parallelFor(getEmitterCount(), [this, destination, total](ui32 index)
+        {
+            ui32 begin = std::min(m_offsets[index], total);
+            ui32 end = std::min(m_offsets[index + 1], total);
+            m_emitters[index]->writeInstanceData(destination.subspan(begin, end - begin));
+        });
+
+    return total;
+}
@@ -0,0 +1,396 @@
+#include <DX3D/Particles/ParticleKernels.h>
+#include <DX3D/Particles/ParticleEffects/SnowParticle.h>
+#include <cmath>
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define DX3D_PARTICLES_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// MSVC exposes AVX2 intrinsics without /arch:AVX2; other compilers need the target enabled
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define DX3D_PARTICLES_AVX2 1
+#include <immintrin.h>
+#include <intrin.h>
+#elif defined(__AVX2__)
+#define DX3D_PARTICLES_AVX2 1
+#include <immintrin.h>
+#endif
+
+using namespace dx3d;
+
+namespace
+{
+    constexpr float TWO_PI = 6.28318530718f;
+    constexpr float HALF_PI = 1.57079632679f;
+    constexpr float INV_PI = 0.318309886184f;
+
+    // π split in two so x - q*π keeps its precision for the phases snow accumulates
+    constexpr float PI_HI = 3.140625f;
+    constexpr float PI_LO = 9.67653589793e-4f;
+
+    // Odd Taylor terms of sin on [-π/2, π/2]; within 2e-7 of std::sin over the phases particles reach
+    constexpr float SIN_C3 = -1.0f / 6.0f;
+    constexpr float SIN_C5 = 1.0f / 120.0f;
+    constexpr float SIN_C7 = -1.0f / 5040.0f;
+    constexpr float SIN_C9 = 1.0f / 362880.0f;
+    constexpr float SIN_C11 = -1.0f / 39916800.0f;
+
+    // Each Ops type exposes the same operations for one register width; the kernels
+    // below are written once against that interface and instantiated per level.
+    struct ScalarOps
+    {
+        using Vec = float;
+        static constexpr ui32 WIDTH = 1;
+
+        static Vec load(const float* p) { return *p; }
+        static void store(float* p, Vec v) { *p = v; }
+        static Vec set(float v) { return v; }
+        static Vec add(Vec a, Vec b) { return a + b; }
+        static Vec sub(Vec a, Vec b) { return a - b; }
+        static Vec mul(Vec a, Vec b) { return a * b; }
+        static Vec div(Vec a, Vec b) { return a / b; }
+
+        static Vec wrapAngle(Vec r)
+        {
+            r -= (r > TWO_PI) ? TWO_PI : 0.0f;
+            r += (r < 0.0f) ? TWO_PI : 0.0f;
+            return r;
+        }
+
+        static Vec sin(Vec x)
+        {
+            // Round-to-nearest-even, same as cvtps2dq in the SIMD paths
+            long q = std::lrintf(x * INV_PI);
+            float qf = static_cast<float>(q);
+            float r = (x - qf * PI_HI) - qf * PI_LO;
+            float r2 = r * r;
+            float p = SIN_C3 + r2 * (SIN_C5 + r2 * (SIN_C7 + r2 * (SIN_C9 + r2 * SIN_C11)));
+            float s = r + (r * r2) * p;
+            return (q & 1) ? -s : s;
+        }
+
+        static Vec cos(Vec x) { return sin(x + HALF_PI); }
+        static void finish() {}
+    };
+
+#if DX3D_PARTICLES_SSE2
+    struct SSE2Ops
+    {
+        using Vec = __m128;
+        static constexpr ui32 WIDTH = 4;
+
+        static Vec load(const float* p) { return _mm_loadu_ps(p); }
+        static void store(float* p, Vec v) { _mm_storeu_ps(p, v); }
+        static Vec set(float v) { return _mm_set1_ps(v); }
+        static Vec add(Vec a, Vec b) { return _mm_add_ps(a, b); }
+        static Vec sub(Vec a, Vec b) { return _mm_sub_ps(a, b); }
+        static Vec mul(Vec a, Vec b) { return _mm_mul_ps(a, b); }
+        static Vec div(Vec a, Vec b) { return _mm_div_ps(a, b); }
+
+        static Vec wrapAngle(Vec r)
+        {
+            const Vec twoPi = _mm_set1_ps(TWO_PI);
+            r = _mm_sub_ps(r, _mm_and_ps(_mm_cmpgt_ps(r, twoPi), twoPi));
+            r = _mm_add_ps(r, _mm_and_ps(_mm_cmplt_ps(r, _mm_setzero_ps()), twoPi));
+            return r;
+        }
+
+        static Vec sin(Vec x)
+        {
+            __m128i q = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(INV_PI)));
+            Vec qf = _mm_cvtepi32_ps(q);
+            Vec r = _mm_sub_ps(_mm_sub_ps(x, _mm_mul_ps(qf, _mm_set1_ps(PI_HI))), _mm_mul_ps(qf, _mm_set1_ps(PI_LO)));
+            Vec r2 = _mm_mul_ps(r, r);
+            Vec p = _mm_add_ps(_mm_set1_ps(SIN_C9), _mm_mul_ps(r2, _mm_set1_ps(SIN_C11)));
+            p = _mm_add_ps(_mm_set1_ps(SIN_C7), _mm_mul_ps(r2, p));
+            p = _mm_add_ps(_mm_set1_ps(SIN_C5), _mm_mul_ps(r2, p));
+            p = _mm_add_ps(_mm_set1_ps(SIN_C3), _mm_mul_ps(r2, p));
+            Vec s = _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(r, r2), p));
+            // Odd multiples of π flip the sign: move bit 0 of q into the sign bit
+            Vec sign = _mm_castsi128_ps(_mm_slli_epi32(q, 31));
+            return _mm_xor_ps(s, sign);
+        }
+
+        static Vec cos(Vec x) { return sin(_mm_add_ps(x, _mm_set1_ps(HALF_PI))); }
+        static void finish() {}
+    };
+#endif
+
+#if DX3D_PARTICLES_AVX2
+    struct AVX2Ops
+    {
+        using Vec = __m256;
+        static constexpr ui32 WIDTH = 8;
+
+        static Vec load(const float* p) { return _mm256_loadu_ps(p); }
+        static void store(float* p, Vec v) { _mm256_storeu_ps(p, v); }
+        static Vec set(float v) { return _mm256_set1_ps(v); }
+        static Vec add(Vec a, Vec b) { return _mm256_add_ps(a, b); }
+        static Vec sub(Vec a, Vec b) { return _mm256_sub_ps(a, b); }
+        static Vec mul(Vec a, Vec b) { return _mm256_mul_ps(a, b); }
+        static Vec div(Vec a, Vec b) { return _mm256_div_ps(a, b); }
+
+        static Vec wrapAngle(Vec r)
+        {
+            const Vec twoPi = _mm256_set1_ps(TWO_PI);
+            r = _mm256_sub_ps(r, _mm256_and_ps(_mm256_cmp_ps(r, twoPi, _CMP_GT_OQ), twoPi));
+            r = _mm256_add_ps(r, _mm256_and_ps(_mm256_cmp_ps(r, _mm256_setzero_ps(), _CMP_LT_OQ), twoPi));
+            return r;
+        }
+
+        static Vec sin(Vec x)
+        {
+            __m256i q = _mm256_cvtps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(INV_PI)));
+            Vec qf = _mm256_cvtepi32_ps(q);
+            Vec r = _mm256_sub_ps(_mm256_sub_ps(x, _mm256_mul_ps(qf, _mm256_set1_ps(PI_HI))), _mm256_mul_ps(qf, _mm256_set1_ps(PI_LO)));
+            Vec r2 = _mm256_mul_ps(r, r);
+            Vec p = _mm256_add_ps(_mm256_set1_ps(SIN_C9), _mm256_mul_ps(r2, _mm256_set1_ps(SIN_C11)));
+            p = _mm256_add_ps(_mm256_set1_ps(SIN_C7), _mm256_mul_ps(r2, p));
+            p = _mm256_add_ps(_mm256_set1_ps(SIN_C5), _mm256_mul_ps(r2, p));
+            p = _mm256_add_ps(_mm256_set1_ps(SIN_C3), _mm256_mul_ps(r2, p));
+            Vec s = _mm256_add_ps(r, _mm256_mul_ps(_mm256_mul_ps(r, r2), p));
+            Vec sign = _mm256_castsi256_ps(_mm256_slli_epi32(q, 31));
+            return _mm256_xor_ps(s, sign);
+        }
+
+        static Vec cos(Vec x) { return sin(_mm256_add_ps(x, _mm256_set1_ps(HALF_PI))); }
+
+        // Avoid AVX/SSE transition stalls in the code that runs after the kernel
+        static void finish() { _mm256_zeroupper(); }
+    };
+#endif
+
+    template<typename Ops>
+    ui32 ballisticRange(ParticlePool& pool, ui32 i, ui32 end, const Vector3& acceleration, float deltaTime)
+    {
+        using Vec = typename Ops::Vec;
+        const Vec dt = Ops::set(deltaTime);
+        const Vec accelX = Ops::set(acceleration.x * deltaTime);
+        const Vec accelY = Ops::set(acceleration.y * deltaTime);
+        const Vec accelZ = Ops::set(acceleration.z * deltaTime);
+
+        for (; i + Ops::WIDTH <= end; i += Ops::WIDTH)
+        {
+            Vec vx = Ops::add(Ops::load(&pool.velocityX[i]), accelX);
+            Vec vy = Ops::add(Ops::load(&pool.velocityY[i]), accelY);
+            Vec vz = Ops::add(Ops::load(&pool.velocityZ[i]), accelZ);
+            Ops::store(&pool.velocityX[i], vx);
+            Ops::store(&pool.velocityY[i], vy);
+            Ops::store(&pool.velocityZ[i], vz);
+
+            Ops::store(&pool.positionX[i], Ops::add(Ops::load(&pool.positionX[i]), Ops::mul(vx, dt)));
+            Ops::store(&pool.positionY[i], Ops::add(Ops::load(&pool.positionY[i]), Ops::mul(vy, dt)));
+            Ops::store(&pool.positionZ[i], Ops::add(Ops::load(&pool.positionZ[i]), Ops::mul(vz, dt)));
+
+            Vec rotation = Ops::add(Ops::load(&pool.rotation[i]), Ops::mul(Ops::load(&pool.rotationSpeed[i]), dt));
+            Ops::store(&pool.rotation[i], Ops::wrapAngle(rotation));
+        }
+
+        return i;
+    }
+
+    template<typename Ops>
+    ui32 snowRange(ParticlePool& pool, ui32 i, ui32 end, const Vector3& acceleration, float deltaTime)
+    {
+        using Vec = typename Ops::Vec;
+        const float* swayAmount = pool.effectData[SnowParticleEffect::SwayAmount].data();
+        const float* swaySpeed = pool.effectData[SnowParticleEffect::SwaySpeed].data();
+        float* swayPhase = pool.effectData[SnowParticleEffect::SwayPhase].data();
+        const float* fallMultiplier = pool.effectData[SnowParticleEffect::FallSpeedMultiplier].data();
+
+        const Vec dt = Ops::set(deltaTime);
+        const Vec accelX = Ops::set(acceleration.x);
+        const Vec accelY = Ops::set(acceleration.y);
+        const Vec accelZ = Ops::set(acceleration.z);
+        const Vec zSwayFrequency = Ops::set(0.7f);
+        const Vec half = Ops::set(0.5f);
+
+        for (; i + Ops::WIDTH <= end; i += Ops::WIDTH)
+        {
+            Vec phase = Ops::add(Ops::load(&swayPhase[i]), Ops::mul(Ops::load(&swaySpeed[i]), dt));
+            Ops::store(&swayPhase[i], phase);
+
+            Vec amount = Ops::load(&swayAmount[i]);
+            Vec swayX = Ops::mul(Ops::sin(phase), amount);
+            Vec swayZ = Ops::mul(Ops::mul(Ops::cos(Ops::mul(phase, zSwayFrequency)), amount), half);
+
+            Vec vx = Ops::load(&pool.velocityX[i]);
+            Vec vy = Ops::load(&pool.velocityY[i]);
+            Vec vz = Ops::load(&pool.velocityZ[i]);
+
+            Ops::store(&pool.positionX[i], Ops::add(Ops::load(&pool.positionX[i]), Ops::mul(Ops::add(vx, swayX), dt)));
+            Ops::store(&pool.positionY[i], Ops::add(Ops::load(&pool.positionY[i]), Ops::mul(vy, dt)));
+            Ops::store(&pool.positionZ[i], Ops::add(Ops::load(&pool.positionZ[i]), Ops::mul(Ops::add(vz, swayZ), dt)));
+
+            Vec fallStep = Ops::mul(dt, Ops::load(&fallMultiplier[i]));
+            Ops::store(&pool.velocityX[i], Ops::add(vx, Ops::mul(accelX, fallStep)));
+            Ops::store(&pool.velocityY[i], Ops::add(vy, Ops::mul(accelY, fallStep)));
+            Ops::store(&pool.velocityZ[i], Ops::add(vz, Ops::mul(accelZ, fallStep)));
+
+            Vec rotation = Ops::add(Ops::load(&pool.rotation[i]), Ops::mul(Ops::load(&pool.rotationSpeed[i]), dt));
+            Ops::store(&pool.rotation[i], Ops::wrapAngle(rotation));
+        }
+
+        return i;
+    }
+
+    struct GradientParams
+    {
+        Vector4 startColor;
+        Vector4 colorDelta;
+        float startSize;
+        float sizeDelta;
+    };
+
+    template<typename Ops>
+    ui32 gradientRange(ParticlePool& pool, ui32 i, ui32 end, const GradientParams& params)
+    {
+        using Vec = typename Ops::Vec;
+        const Vec startR = Ops::set(params.startColor.x), deltaR = Ops::set(params.colorDelta.x);
+        const Vec startG = Ops::set(params.startColor.y), deltaG = Ops::set(params.colorDelta.y);
+        const Vec startB = Ops::set(params.startColor.z), deltaB = Ops::set(params.colorDelta.z);
+        const Vec startA = Ops::set(params.startColor.w), deltaA = Ops::set(params.colorDelta.w);
+        const Vec startSize = Ops::set(params.startSize), deltaSize = Ops::set(params.sizeDelta);
+
+        for (; i + Ops::WIDTH <= end; i += Ops::WIDTH)
+        {
+            Vec lifeRatio = Ops::div(Ops::load(&pool.age[i]), Ops::load(&pool.lifetime[i]));
+
+            Ops::store(&pool.colorR[i], Ops::add(startR, Ops::mul(deltaR, lifeRatio)));
+            Ops::store(&pool.colorG[i], Ops::add(startG, Ops::mul(deltaG, lifeRatio)));
+            Ops::store(&pool.colorB[i], Ops::add(startB, Ops::mul(deltaB, lifeRatio)));
+            Ops::store(&pool.colorA[i], Ops::add(startA, Ops::mul(deltaA, lifeRatio)));
+            Ops::store(&pool.size[i], Ops::add(startSize, Ops::mul(deltaSize, lifeRatio)));
+        }
+
+        return i;
+    }
+
+    // Full-width blocks with Ops, then the remainder one particle at a time
+    template<typename Ops>
+    void integrateBallistic(ParticlePool& pool, ui32 begin, ui32 end, const Vector3& acceleration, float deltaTime)
+    {
+        ui32 i = ballisticRange<Ops>(pool, begin, end, acceleration, deltaTime);
+        Ops::finish();
+        ballisticRange<ScalarOps>(pool, i, end, acceleration, deltaTime);
+    }
+
+    template<typename Ops>
+    void integrateSnow(ParticlePool& pool, ui32 begin, ui32 end, const Vector3& acceleration, float deltaTime)
+    {
+        ui32 i = snowRange<Ops>(pool, begin, end, acceleration, deltaTime);
+        Ops::finish();
+        snowRange<ScalarOps>(pool, i, end, acceleration, deltaTime);
+    }
+
+    template<typename Ops>
+    void applyLifetimeGradients(ParticlePool& pool, ui32 begin, ui32 end,
+        const Vector4& startColor, const Vector4& endColor, float startSize, float endSize)
+    {
+        GradientParams params;
+        params.startColor = startColor;
+        params.colorDelta = Vector4(
+            endColor.x - startColor.x,
+            endColor.y - startColor.y,
+            endColor.z - startColor.z,
+            endColor.w - startColor.w);
+        params.startSize = startSize;
+        params.sizeDelta = endSize - startSize;
+
+        ui32 i = gradientRange<Ops>(pool, begin, end, params);
+        Ops::finish();
+        gradientRange<ScalarOps>(pool, i, end, params);
+    }
+
+    template<typename Ops>
+    ParticleKernelTable makeKernelTable(ParticleSimdLevel level)
+    {
+        return ParticleKernelTable{
+            level,
+            &integrateBallistic<Ops>,
+            &integrateSnow<Ops>,
+            &applyLifetimeGradients<Ops>
+        };
+    }
+
+    ParticleSimdLevel detectSimdLevel()
+    {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        int info[4] = {};
+        __cpuid(info, 0);
+        const int maxLeaf = info[0];
+
+        __cpuid(info, 1);
+        const bool sse2 = (info[3] & (1 << 26)) != 0;
+        const bool osxsave = (info[2] & (1 << 27)) != 0;
+        const bool avx = (info[2] & (1 << 28)) != 0;
+
+        bool avx2 = false;
+        if (maxLeaf >= 7 && osxsave && avx)
+        {
+            // The OS must also save the YMM registers on context switch
+            const unsigned long long xcr0 = _xgetbv(0);
+            if ((xcr0 & 0x6) == 0x6)
+            {
+                __cpuidex(info, 7, 0);
+                avx2 = (info[1] & (1 << 5)) != 0;
+            }
+        }
+
+        if (avx2)
+            return ParticleSimdLevel::AVX2;
+        if (sse2)
+            return ParticleSimdLevel::SSE2;
+        return ParticleSimdLevel::Scalar;
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+            return ParticleSimdLevel::AVX2;
+        if (__builtin_cpu_supports("sse2"))
+            return ParticleSimdLevel::SSE2;
+        return ParticleSimdLevel::Scalar;
+#else
+        return ParticleSimdLevel::Scalar;
+#endif
+    }
+}
+
+ParticleSimdLevel dx3d::getSupportedParticleSimdLevel()
+{
+    static const ParticleSimdLevel s_level = detectSimdLevel();
+    return s_level;
+}
+
+const ParticleKernelTable& dx3d::getParticleKernels()
+{
+    static const ParticleKernelTable& s_kernels = getParticleKernels(getSupportedParticleSimdLevel());
+    return s_kernels;
+}
+
+const ParticleKernelTable& dx3d::getParticleKernels(ParticleSimdLevel level)
+{
+    static const ParticleKernelTable s_scalar = makeKernelTable<ScalarOps>(ParticleSimdLevel::Scalar);
+#if DX3D_PARTICLES_SSE2
+    static const ParticleKernelTable s_sse2 = makeKernelTable<SSE2Ops>(ParticleSimdLevel::SSE2);
+#endif
+#if DX3D_PARTICLES_AVX2
+    static const ParticleKernelTable s_avx2 = makeKernelTable<AVX2Ops>(ParticleSimdLevel::AVX2);
+#endif
+
+    const ParticleSimdLevel supported = getSupportedParticleSimdLevel();
+    if (level > supported)
+    {
+        level = supported;
+    }
+
+#if DX3D_PARTICLES_AVX2
+    if (level == ParticleSimdLevel::AVX2)
+        return s_avx2;
+#endif
+#if DX3D_PARTICLES_SSE2
+    if (level != ParticleSimdLevel::Scalar)
+        return s_sse2;
+#endif
+    return s_scalar;
+}
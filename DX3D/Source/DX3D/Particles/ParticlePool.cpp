@@ -0,0 +1,60 @@
+#include <DX3D/Particles/ParticlePool.h>
+#include <algorithm>
+
+using namespace dx3d;
+
+void ParticlePool::allocate(ui32 capacity)
+{
+    for (auto* channel : { &positionX, &positionY, &positionZ,
+                           &velocityX, &velocityY, &velocityZ,
+                           &colorR, &colorG, &colorB, &colorA,
+                           &size, &rotation, &rotationSpeed, &age, &lifetime })
+    {
+        channel->assign(capacity, 0.0f);
+    }
+
+    for (auto& channel : effectData)
+    {
+        channel.assign(capacity, 0.0f);
+    }
+
+    aliveCount = std::min(aliveCount, capacity);
+}
+
+ui32 ParticlePool::emplace(ui32 count)
+{
+    ui32 first = aliveCount;
+    aliveCount = std::min(aliveCount + count, capacity());
+    return first;
+}
+
+void ParticlePool::kill(ui32 index)
+{
+    ui32 last = aliveCount - 1;
+
+    if (index != last)
+    {
+        positionX[index] = positionX[last];
+        positionY[index] = positionY[last];
+        positionZ[index] = positionZ[last];
+        velocityX[index] = velocityX[last];
+        velocityY[index] = velocityY[last];
+        velocityZ[index] = velocityZ[last];
+        colorR[index] = colorR[last];
+        colorG[index] = colorG[last];
+        colorB[index] = colorB[last];
+        colorA[index] = colorA[last];
+        size[index] = size[last];
+        rotation[index] = rotation[last];
+        rotationSpeed[index] = rotationSpeed[last];
+        age[index] = age[last];
+        lifetime[index] = lifetime[last];
+
+        for (auto& channel : effectData)
+        {
+            channel[index] = channel[last];
+        }
+    }
+
+    --aliveCount;
+}
@@ -3,15 +3,38 @@
 #include <DX3D/Graphics/GraphicsEngine.h>
 #include <DX3D/Graphics/RenderSystem.h>
 #include <DX3D/Graphics/DeviceContext.h>
+#include <DX3D/Graphics/VertexBuffer.h>
+#include <DX3D/Graphics/IndexBuffer.h>
+#include <DX3D/Graphics/ConstantBuffer.h>
+#include <DX3D/Graphics/Shaders/Shaders.h>
 #include <DX3D/Graphics/Shaders/ParticleShader.h>
 #include <DX3D/Game/SceneCamera.h>
+#include <DX3D/Core/JobSystem.h>
 #include <d3d11.h>
 #include <d3dcompiler.h>
+#include <wrl.h>
+#include <algorithm>
 
 #pragma comment(lib, "d3dcompiler.lib")
 
 using namespace dx3d;
 
+struct ParticleSystem::RenderResources
+{
+    std::shared_ptr<VertexBuffer> quadVertexBuffer;
+    std::shared_ptr<IndexBuffer> quadIndexBuffer;
+    std::shared_ptr<PixelShader> pixelShader;
+    std::shared_ptr<ConstantBuffer> viewProjConstantBuffer;
+
+    // Raw shader pointers for particle rendering
+    Microsoft::WRL::ComPtr<ID3D11VertexShader> particleVertexShader;
+    Microsoft::WRL::ComPtr<ID3D11InputLayout> particleInputLayout;
+
+    // Instance buffer for instanced rendering
+    Microsoft::WRL::ComPtr<ID3D11Buffer> instanceBuffer;
+    ui32 instanceBufferCapacity = 0;
+};
+
 // Constant buffer structure for view/projection matrices and camera vectors
 struct ParticleConstantBuffer
 {
@@ -23,6 +46,21 @@ struct ParticleConstantBuffer
     float _pad1;
 };
 
+// FNV-1a; std::hash<std::string> is not guaranteed to be stable across standard libraries
+static ui32 hashEmitterName(const std::string& name)
+{
+    ui32 hash = 2166136261u;
+    for (char c : name)
+    {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+ParticleSystem::ParticleSystem() = default;
+ParticleSystem::~ParticleSystem() = default;
+
 void ParticleSystem::initialize(GraphicsEngine& graphicsEngine)
 {
     if (m_initialized)
@@ -36,29 +74,26 @@ void ParticleSystem::initialize(GraphicsEngine& graphicsEngine)
 
 void ParticleSystem::shutdown()
 {
+    m_instanceLayout.clear();
     m_emitters.clear();
-    m_quadVertexBuffer.reset();
-    m_quadIndexBuffer.reset();
-    m_pixelShader.reset();
-    m_viewProjConstantBuffer.reset();
-    m_particleVertexShader.Reset();
-    m_particleInputLayout.Reset();
-    m_instanceBuffer.Reset();
+    m_renderResources.reset();
     m_initialized = false;
 }
 
 std::shared_ptr<ParticleEmitter> ParticleSystem::createEmitter(
     const std::string& name,
     const ParticleEmitter::EmitterConfig& config,
-    ParticleEmitter::ParticleFactory factory)
+    std::shared_ptr<ParticleEffect> effect)
 {
-    auto emitter = std::make_shared<ParticleEmitter>(config, factory);
+    auto emitter = std::make_shared<ParticleEmitter>(config, std::move(effect), m_randomSeed ^ hashEmitterName(name));
     m_emitters[name] = emitter;
     return emitter;
 }
 
 void ParticleSystem::removeEmitter(const std::string& name)
 {
+    // The layout may still point at the emitter until the next frame rebuilds it
+    m_instanceLayout.clear();
     m_emitters.erase(name);
 }
 
@@ -70,10 +105,17 @@ std::shared_ptr<ParticleEmitter> ParticleSystem::getEmitter(const std::string& n
 
 void ParticleSystem::update(float deltaTime)
 {
+    // Emitters share no state, so the order they are updated in does not matter
+    m_updateList.clear();
     for (auto& pair : m_emitters)
     {
-        pair.second->update(deltaTime);
+        m_updateList.push_back(pair.second.get());
     }
+
+    JobSystem::getInstance().parallelFor(static_cast<ui32>(m_updateList.size()), [this, deltaTime](ui32 index)
+        {
+            m_updateList[index]->update(deltaTime);
+        });
 }
 
 void ParticleSystem::render(DeviceContext& deviceContext, const SceneCamera& camera, const Matrix4x4& projectionMatrix)
@@ -81,26 +123,29 @@ void ParticleSystem::render(DeviceContext& deviceContext, const SceneCamera& cam
     if (!m_initialized)
         return;
 
-    // Collect all particle instance data
-    std::vector<ParticleInstanceData> allParticles;
-    for (const auto& pair : m_emitters)
-    {
-        pair.second->fillInstanceData(allParticles, camera);
-    }
-
-    if (allParticles.empty())
+    ui32 instanceCount = buildInstanceLayout().getInstanceCount();
+    if (instanceCount == 0)
         return;
 
-    // Update instance buffer
-    updateInstanceBuffer(deviceContext, allParticles);
+    ensureInstanceCapacity(deviceContext, instanceCount);
+    RenderResources& resources = *m_renderResources;
 
-    // Set up rendering state
+    // Emitters write straight into the mapped instance buffer; no intermediate copy
     auto d3dContext = deviceContext.getDeviceContext();
+    D3D11_MAPPED_SUBRESOURCE mappedResource{};
+    HRESULT hr = d3dContext->Map(resources.instanceBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+    if (FAILED(hr))
+        return;
+
+    instanceCount = writeInstanceData(std::span<ParticleInstanceData>(
+        static_cast<ParticleInstanceData*>(mappedResource.pData), instanceCount));
+    d3dContext->Unmap(resources.instanceBuffer.Get(), 0);
 
+    // Set up rendering state
     // Set shaders using raw pointers
-    d3dContext->VSSetShader(m_particleVertexShader.Get(), nullptr, 0);
-    deviceContext.setPixelShader(m_pixelShader->getShader());
-    d3dContext->IASetInputLayout(m_particleInputLayout.Get());
+    d3dContext->VSSetShader(resources.particleVertexShader.Get(), nullptr, 0);
+    deviceContext.setPixelShader(resources.pixelShader->getShader());
+    d3dContext->IASetInputLayout(resources.particleInputLayout.Get());
 
     // Update constant buffer with camera data
     ParticleConstantBuffer cbData;
@@ -109,27 +154,39 @@ void ParticleSystem::render(DeviceContext& deviceContext, const SceneCamera& cam
     cbData.cameraRight = camera.getRight();
     cbData.cameraUp = camera.getUp();
 
-    m_viewProjConstantBuffer->update(deviceContext, &cbData);
-    ID3D11Buffer* cb = m_viewProjConstantBuffer->getBuffer();
+    resources.viewProjConstantBuffer->update(deviceContext, &cbData);
+    ID3D11Buffer* cb = resources.viewProjConstantBuffer->getBuffer();
     d3dContext->VSSetConstantBuffers(0, 1, &cb);
 
     // Set vertex buffer (quad) and instance buffer
-    ID3D11Buffer* buffers[2] = { m_quadVertexBuffer->getBuffer(), m_instanceBuffer.Get() };
+    ID3D11Buffer* buffers[2] = { resources.quadVertexBuffer->getBuffer(), resources.instanceBuffer.Get() };
     UINT strides[2] = { sizeof(Vertex), sizeof(ParticleInstanceData) };
     UINT offsets[2] = { 0, 0 };
     d3dContext->IASetVertexBuffers(0, 2, buffers, strides, offsets);
 
     // Set index buffer
-    deviceContext.setIndexBuffer(*m_quadIndexBuffer);
+    deviceContext.setIndexBuffer(*resources.quadIndexBuffer);
 
     // Draw all particles with instancing
-    d3dContext->DrawIndexedInstanced(6, static_cast<UINT>(allParticles.size()), 0, 0, 0);
+    d3dContext->DrawIndexedInstanced(6, instanceCount, 0, 0, 0);
+}
+
+const ParticleInstanceLayout& ParticleSystem::buildInstanceLayout()
+{
+    m_instanceLayout.clear();
+    for (const auto& pair : m_emitters)
+    {
+        m_instanceLayout.add(*pair.second);
+    }
+    return m_instanceLayout;
 }
 
 void ParticleSystem::createRenderingResources(GraphicsEngine& graphicsEngine)
 {
     auto& renderSystem = graphicsEngine.getRenderSystem();
     auto resourceDesc = renderSystem.getGraphicsResourceDesc();
+    m_renderResources = std::make_unique<RenderResources>();
+    RenderResources& resources = *m_renderResources;
 
     // Create a simple quad for particles (centered at origin)
     Vertex quadVertices[] = {
@@ -139,7 +196,7 @@ void ParticleSystem::createRenderingResources(GraphicsEngine& graphicsEngine)
         { {-0.5f,  0.5f, 0.0f}, {0.0f, 0.0f, 0.0f, 0.0f} }  // Top-left with UV
     };
 
-    m_quadVertexBuffer = std::make_shared<VertexBuffer>(
+    resources.quadVertexBuffer = std::make_shared<VertexBuffer>(
         quadVertices,
         sizeof(Vertex),
         4,
@@ -147,7 +204,7 @@ void ParticleSystem::createRenderingResources(GraphicsEngine& graphicsEngine)
     );
 
     ui32 quadIndices[] = { 0, 2, 1, 0, 3, 2 }; // Corrected for CCW winding
-    m_quadIndexBuffer = std::make_shared<IndexBuffer>(
+    resources.quadIndexBuffer = std::make_shared<IndexBuffer>(
         quadIndices,
         6,
         resourceDesc
@@ -221,28 +278,28 @@ void ParticleSystem::createRenderingResources(GraphicsEngine& graphicsEngine)
     }
 
     // Store the raw pointers for rendering
-    m_particleVertexShader = vertexShader;
-    m_particleInputLayout = inputLayout;
+    resources.particleVertexShader = vertexShader;
+    resources.particleInputLayout = inputLayout;
 
     // Create pixel shader normally
     // FIX: Pass constructor arguments directly to std::make_shared
-    m_pixelShader = std::make_shared<PixelShader>(resourceDesc, ParticleShader::GetPixelShaderCode());
+    resources.pixelShader = std::make_shared<PixelShader>(resourceDesc, ParticleShader::GetPixelShaderCode());
 
     // Create constant buffer for view/projection matrices
-    m_viewProjConstantBuffer = std::make_shared<ConstantBuffer>(
+    resources.viewProjConstantBuffer = std::make_shared<ConstantBuffer>(
         sizeof(ParticleConstantBuffer),
         resourceDesc
     );
 
     // Create initial instance buffer
-    m_instanceBufferCapacity = 10000;
+    resources.instanceBufferCapacity = 10000;
     D3D11_BUFFER_DESC bufferDesc = {};
     bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-    bufferDesc.ByteWidth = m_instanceBufferCapacity * sizeof(ParticleInstanceData);
+    bufferDesc.ByteWidth = resources.instanceBufferCapacity * sizeof(ParticleInstanceData);
     bufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
     bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
 
-    hr = device->CreateBuffer(&bufferDesc, nullptr, &m_instanceBuffer);
+    hr = device->CreateBuffer(&bufferDesc, nullptr, &resources.instanceBuffer);
     if (FAILED(hr))
     {
         throw std::runtime_error("Failed to create particle instance buffer");
@@ -255,22 +312,23 @@ void ParticleSystem::createRenderingResources(GraphicsEngine& graphicsEngine)
     }
 }
 
-void ParticleSystem::updateInstanceBuffer(DeviceContext& deviceContext, const std::vector<ParticleInstanceData>& instanceData)
+void ParticleSystem::ensureInstanceCapacity(DeviceContext& deviceContext, ui32 instanceCount)
 {
     auto d3dContext = deviceContext.getDeviceContext();
+    RenderResources& resources = *m_renderResources;
 
     // Resize buffer if needed
-    if (instanceData.size() > m_instanceBufferCapacity)
+    if (instanceCount > resources.instanceBufferCapacity)
     {
-        m_instanceBufferCapacity = static_cast<ui32>(instanceData.size() * 1.5f); // Grow by 50%
+        resources.instanceBufferCapacity = static_cast<ui32>(instanceCount * 1.5f); // Grow by 50%
 
         D3D11_BUFFER_DESC bufferDesc = {};
         bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-        bufferDesc.ByteWidth = m_instanceBufferCapacity * sizeof(ParticleInstanceData);
+        bufferDesc.ByteWidth = resources.instanceBufferCapacity * sizeof(ParticleInstanceData);
         bufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
         bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
 
-        m_instanceBuffer.Reset();
+        resources.instanceBuffer.Reset();
 
         // FIX: Properly get the ID3D11Device pointer.
         ID3D11Device* device = nullptr;
@@ -279,7 +337,7 @@ void ParticleSystem::updateInstanceBuffer(DeviceContext& deviceContext, const st
         // Check if the device was successfully obtained before using it.
         if (device)
         {
-            HRESULT hr = device->CreateBuffer(&bufferDesc, nullptr, &m_instanceBuffer);
+            HRESULT hr = device->CreateBuffer(&bufferDesc, nullptr, &resources.instanceBuffer);
 
             // FIX: Release the device pointer after it's been used to avoid a memory leak.
             device->Release();
@@ -294,13 +352,4 @@ void ParticleSystem::updateInstanceBuffer(DeviceContext& deviceContext, const st
             throw std::runtime_error("Failed to get D3D11Device from context");
         }
     }
-
-    // Update buffer data
-    D3D11_MAPPED_SUBRESOURCE mappedResource{};
-    HRESULT hr = d3dContext->Map(m_instanceBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
-    if (SUCCEEDED(hr))
-    {
-        memcpy(mappedResource.pData, instanceData.data(), instanceData.size() * sizeof(ParticleInstanceData));
-        d3dContext->Unmap(m_instanceBuffer.Get(), 0);
-    }
-}
\ No newline at end of file
+}
@@ -144,23 +144,14 @@ void PhysicsSystem::update(float deltaTime)
     // Sync transforms from physics to ECS
     auto& componentManager = ComponentManager::getInstance();
 
-    auto* physicsArray = componentManager.getComponentArray<PhysicsComponent>();
-
-
-    if (physicsArray)
-    {
-        // FIX: Use range-based for loop with non-const references
-        for (auto& pair : *physicsArray)
+    componentManager.view<PhysicsComponent, TransformComponent>().each(
+        [this](const PhysicsComponent& physicsComp, TransformComponent& transformComp)
         {
-            EntityID entity = pair.first;
-            const PhysicsComponent& physicsComp = pair.second;
-
             if (physicsComp.rigidBody && physicsComp.bodyType == PhysicsBodyType::Dynamic)
             {
-                syncTransformFromPhysics(entity, physicsComp);
+                syncTransformFromPhysics(physicsComp, transformComp);
             }
-        }
-    }
+        });
 }
 
 void PhysicsSystem::initializePhysicsBody(EntityID entity, PhysicsComponent& component)
@@ -231,23 +222,26 @@ void PhysicsSystem::initializePhysicsBody(EntityID entity, PhysicsComponent& com
     component.isInitialized = true;
 }
 
-void PhysicsSystem::syncTransformFromPhysics(EntityID entity, const PhysicsComponent& component)
+void PhysicsSystem::syncTransformFromPhysics(const PhysicsComponent& component, TransformComponent& transformComp)
 {
     if (!component.rigidBody)
         return;
 
-    auto& componentManager = ComponentManager::getInstance();
-    auto* transformComp = componentManager.getComponent<TransformComponent>(entity);
-
-    if (!transformComp)
-        return;
-
     // Get physics transform
     const rp3d::Transform& physicsTransform = component.rigidBody->getTransform();
 
+    Vector3 position = fromReactVector(physicsTransform.getPosition());
+    Vector3 rotation = fromReactQuaternion(physicsTransform.getOrientation());
+
+    // Sleeping or resting bodies leave the version alone so their cached matrices stay valid
+    if (position.x == transformComp.position.x && position.y == transformComp.position.y && position.z == transformComp.position.z &&
+        rotation.x == transformComp.rotation.x && rotation.y == transformComp.rotation.y && rotation.z == transformComp.rotation.z)
+        return;
+
     // Update transform component
-    transformComp->position = fromReactVector(physicsTransform.getPosition());
-    transformComp->rotation = fromReactQuaternion(physicsTransform.getOrientation());
+    transformComp.position = position;
+    transformComp.rotation = rotation;
+    ++transformComp.version;
 
     // Scale is not affected by physics
 }
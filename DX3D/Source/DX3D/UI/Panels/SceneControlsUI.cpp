@@ -3,6 +3,7 @@
 #include <DX3D/Scene/SceneStateManager.h>
 #include <DX3D/Game/UndoRedoSystem.h>
 #include <DX3D/Core/Logger.h>
+#include <DX3D/Graphics/RenderView.h>
 #include <imgui.h>
 
 using namespace dx3d;
@@ -10,17 +11,19 @@ using namespace dx3d;
 SceneControlsUI::SceneControlsUI(
     UIController& controller,
     SceneStateManager& sceneStateManager,
-    UndoRedoSystem& undoRedoSystem)
+    UndoRedoSystem& undoRedoSystem,
+    const FrameRenderStats& renderStats)
     : m_controller(controller)
     , m_sceneStateManager(sceneStateManager)
     , m_undoRedoSystem(undoRedoSystem)
+    , m_renderStats(renderStats)
 {
 }
 
 void SceneControlsUI::render()
 {
     ImGui::SetNextWindowPos(ImVec2(ImGui::GetIO().DisplaySize.x * 0.5f, 20));
-    ImGui::SetNextWindowSize(ImVec2(ImGui::GetIO().DisplaySize.x * 0.5f, 100));
+    ImGui::SetNextWindowSize(ImVec2(ImGui::GetIO().DisplaySize.x * 0.5f, 120));
     ImGui::Begin("Scene Controls", nullptr, ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoCollapse);
 
     const char* stateText = "";
@@ -32,6 +35,18 @@ void SceneControlsUI::render()
     }
 
     ImGui::Text("Current State: %s", stateText);
+    ImGui::SameLine();
+    RenderStats total = m_renderStats.getTotal();
+    ImGui::Text("| Draw Calls: %u (%u instances) | Triangles: %u | State Changes: %u",
+        total.drawCalls, total.instances, total.triangles, total.getStateChanges());
+
+    // Per-view recording runs in parallel, so the views' times add up to more than the record time
+    ImGui::Text("Record: %.2f ms | Execute: %.2f ms", m_renderStats.recordMilliseconds, m_renderStats.executeMilliseconds);
+    for (ui32 i = 0; i < RENDER_VIEW_COUNT; ++i)
+    {
+        ImGui::SameLine();
+        ImGui::Text("| %s: %.2f ms", getRenderViewName(static_cast<RenderViewType>(i)), m_renderStats.views[i].cpuMilliseconds);
+    }
     ImGui::Separator();
 
     bool isPlaying = m_sceneStateManager.isPlayMode();
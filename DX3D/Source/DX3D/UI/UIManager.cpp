@@ -33,7 +33,8 @@ UIManager::UIManager(const Dependencies& deps)
     m_sceneControls = std::make_unique<SceneControlsUI>(
         *m_controller,
         deps.sceneStateManager,
-        deps.undoRedoSystem
+        deps.undoRedoSystem,
+        deps.renderStats
     );
 
     m_sceneOutliner = std::make_unique<SceneOutlinerUI>(
@@ -0,0 +1,291 @@
+#include "TestFramework.h"
+#include <DX3D/Assets/AssetManager.h>
+#include <DX3D/Assets/AssetStreamer.h>
+#include <DX3D/Assets/RecordingAssetUploader.h>
+#include <DX3D/ECS/ComponentManager.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <thread>
+
+using namespace dx3d;
+
+// Streaming runs against a RecordingAssetUploader, so models load their CPU data and materials
+// and every device call shows up in order in its records. Model files are written to the test
+// directory; each mesh of a test model is a grid with its own size, so a record's vertex count
+// tells which model and mesh it came from.
+
+namespace
+{
+    constexpr auto STATE_TIMEOUT = std::chrono::seconds(30);
+
+    // OBJ file with one object per entry of gridSizes, each a flat grid of gridSize x gridSize quads
+    std::string writeGridModel(const std::string& name, const std::vector<ui32>& gridSizes)
+    {
+        std::filesystem::path path = getTestTempDirectory() / (name + ".obj");
+        std::ofstream file(path);
+        ui32 vertexBase = 1;
+        for (size_t object = 0; object < gridSizes.size(); ++object)
+        {
+            ui32 gridSize = gridSizes[object];
+            file << "o " << name << "_part" << object << "\n";
+            for (ui32 y = 0; y <= gridSize; ++y)
+            {
+                for (ui32 x = 0; x <= gridSize; ++x)
+                {
+                    file << "v " << x << " " << object * 2 << " " << y << "\n";
+                }
+            }
+            for (ui32 y = 0; y < gridSize; ++y)
+            {
+                for (ui32 x = 0; x < gridSize; ++x)
+                {
+                    ui32 corner = vertexBase + y * (gridSize + 1) + x;
+                    file << "f " << corner << " " << corner + gridSize + 1 << " " << corner + gridSize + 2 << " " << corner + 1 << "\n";
+                }
+            }
+            vertexBase += (gridSize + 1) * (gridSize + 1);
+        }
+        return path.string();
+    }
+
+    bool isFinished(StreamState state)
+    {
+        return state == StreamState::Complete || state == StreamState::Failed || state == StreamState::Cancelled;
+    }
+
+    // Waits for the workers to bring a request to a state; false on timeout
+    template<typename Predicate>
+    bool waitForState(const AssetStreamer& streamer, AssetStreamer::RequestId request, Predicate predicate)
+    {
+        auto end = std::chrono::steady_clock::now() + STATE_TIMEOUT;
+        while (!predicate(streamer.getState(request)))
+        {
+            if (std::chrono::steady_clock::now() > end)
+                return false;
+            std::this_thread::yield();
+        }
+        return true;
+    }
+
+    bool waitForUpload(const AssetStreamer& streamer, AssetStreamer::RequestId request)
+    {
+        return waitForState(streamer, request, [](StreamState state) { return state == StreamState::WaitingForUpload || isFinished(state); })
+            && streamer.getState(request) == StreamState::WaitingForUpload;
+    }
+
+    std::vector<UploadRecord> getMeshRecords(const RecordingAssetUploader& uploader)
+    {
+        std::vector<UploadRecord> meshes;
+        for (const UploadRecord& record : uploader.getRecords())
+        {
+            if (record.type == UploadType::Mesh)
+                meshes.push_back(record);
+        }
+        return meshes;
+    }
+
+    // Uploads follow the priorities at upload time, and all of a model's steps run before the next model's
+    void testUploadsFollowPriority(TestContext& context)
+    {
+        RecordingAssetUploader uploader;
+        AssetStreamer streamer(uploader);
+
+        // Model i has two meshes of grid size 2 + i, so vertex counts grow with i
+        const float priorities[] = { 3.0f, 1.0f, 4.0f, 2.0f };
+        std::vector<AssetStreamer::RequestId> requests;
+        for (ui32 i = 0; i < 4; ++i)
+        {
+            std::string path = writeGridModel("priority" + std::to_string(i), { 2 + i, 2 + i });
+            requests.push_back(streamer.requestModel(path, priorities[i]));
+        }
+        for (AssetStreamer::RequestId request : requests)
+        {
+            DX3DCheck(context, waitForUpload(streamer, request));
+        }
+
+        // Re-ordering while waiting moves model 2 from last to first
+        streamer.setPriority(requests[2], 0.0f);
+        while (streamer.processUploads(1000.0f) > 0)
+        {
+        }
+
+        const std::vector<UploadRecord> meshes = getMeshRecords(uploader);
+        DX3DCheck(context, meshes.size() == 8);
+        if (meshes.size() != 8)
+            return;
+
+        std::vector<ui32> vertexCounts;
+        for (ui32 i = 0; i < 4; ++i)
+        {
+            DX3DCheck(context, meshes[2 * i].vertexCount == meshes[2 * i + 1].vertexCount);
+            vertexCounts.push_back(meshes[2 * i].vertexCount);
+        }
+        std::vector<ui32> sortedCounts = vertexCounts;
+        std::sort(sortedCounts.begin(), sortedCounts.end());
+
+        const ui32 expectedOrder[] = { 2, 1, 3, 0 };
+        for (ui32 i = 0; i < 4; ++i)
+        {
+            DX3DCheck(context, vertexCounts[i] == sortedCounts[expectedOrder[i]]);
+        }
+        for (AssetStreamer::RequestId request : requests)
+        {
+            DX3DCheck(context, streamer.getState(request) == StreamState::Complete);
+            DX3DCheck(context, streamer.getProgress(request) == 1.0f);
+        }
+    }
+
+    // A stage that is running when its request is cancelled finishes, and nothing runs after it
+    void testCancelDuringStage(TestContext& context)
+    {
+        RecordingAssetUploader uploader;
+        AssetStreamerDesc desc;
+        desc.workerCount = 1;
+        AssetStreamer streamer(uploader, desc);
+
+        // Large enough that reading and decoding take a while
+        const std::string largePath = writeGridModel("cancelLarge", { 60 });
+        const std::string smallPath = writeGridModel("cancelSmall", { 2, 3, 4, 5 });
+
+        AssetStreamer::RequestId large = streamer.requestModel(largePath);
+        bool caughtRunning = waitForState(streamer, large, [](StreamState state)
+            {
+                return state == StreamState::Reading || state == StreamState::Decoding || isFinished(state) || state == StreamState::WaitingForUpload;
+            });
+        StreamState stateAtCancel = streamer.getState(large);
+        streamer.cancel(large);
+        DX3DCheck(context, caughtRunning);
+        DX3DCheck(context, stateAtCancel == StreamState::Reading || stateAtCancel == StreamState::Decoding);
+
+        // The single worker has to finish the cancelled stage before it can read this one
+        AssetStreamer::RequestId small = streamer.requestModel(smallPath);
+        DX3DCheck(context, waitForUpload(streamer, small));
+        DX3DCheck(context, streamer.getState(large) == StreamState::Cancelled);
+        DX3DCheck(context, streamer.getAsset(large) == nullptr);
+
+        // Cancelling between upload steps stops the rest of the model's uploads
+        DX3DCheck(context, streamer.processUploads(0.0f) == 1);
+        DX3DCheck(context, streamer.getState(small) == StreamState::Uploading);
+        size_t recordsAtCancel = uploader.getRecords().size();
+        streamer.cancel(small);
+        DX3DCheck(context, streamer.getState(small) == StreamState::Cancelled);
+        DX3DCheck(context, streamer.processUploads(1000.0f) == 0);
+        DX3DCheck(context, uploader.getRecords().size() == recordsAtCancel);
+        DX3DCheck(context, getMeshRecords(uploader).size() <= 1);
+        DX3DCheck(context, streamer.getAsset(small) == nullptr);
+
+        // Unknown requests read as cancelled
+        streamer.release(large);
+        DX3DCheck(context, streamer.getState(large) == StreamState::Cancelled);
+    }
+
+    // Each call stops once its budget is spent, but always makes progress
+    void testUploadBudget(TestContext& context)
+    {
+        constexpr float MILLISECONDS_PER_UPLOAD = 2.0f;
+        constexpr float BUDGET_MILLISECONDS = 5.0f;
+
+        RecordingAssetUploader uploader(MILLISECONDS_PER_UPLOAD);
+        AssetStreamer streamer(uploader);
+        AssetStreamer::RequestId request = streamer.requestModel(writeGridModel("budget", { 2, 3, 4, 5, 6, 7 }));
+        DX3DCheck(context, waitForUpload(streamer, request));
+
+        // Mesh uploads cost MILLISECONDS_PER_UPLOAD each, so a frame fits as many as overrun the
+        // budget by at most one; the material steps in between cost next to nothing
+        const size_t uploadsPerBudget = static_cast<size_t>(BUDGET_MILLISECONDS / MILLISECONDS_PER_UPLOAD) + 1;
+        ui32 frames = 0;
+        size_t uploads = 0;
+        float lastProgress = streamer.getProgress(request);
+        while (!isFinished(streamer.getState(request)) && frames < 100)
+        {
+            DX3DCheck(context, streamer.processUploads(BUDGET_MILLISECONDS) >= 1);
+            DX3DCheck(context, streamer.getProgress(request) > lastProgress);
+            lastProgress = streamer.getProgress(request);
+
+            size_t frameUploads = getMeshRecords(uploader).size() - uploads;
+            DX3DCheck(context, frameUploads <= uploadsPerBudget);
+            uploads += frameUploads;
+            ++frames;
+        }
+        DX3DCheck(context, streamer.getState(request) == StreamState::Complete);
+        DX3DCheck(context, uploads == 6);
+        DX3DCheck(context, frames >= (uploads + uploadsPerBudget - 1) / uploadsPerBudget);
+
+        // Nothing waiting, nothing run
+        DX3DCheck(context, streamer.processUploads(BUDGET_MILLISECONDS) == 0);
+    }
+
+    // Several loads of one file share one stream, and only cancelling every one of them stops it
+    void testAssetManagerJoinsLoadsInFlight(TestContext& context)
+    {
+        auto& componentManager = ComponentManager::getInstance();
+        componentManager.registerComponent<TransformComponent>();
+        componentManager.registerComponent<PhysicsComponent>();
+        componentManager.registerComponent<MaterialComponent>();
+
+        auto uploader = std::make_unique<RecordingAssetUploader>();
+        RecordingAssetUploader& recorder = *uploader;
+        AssetManager& assets = AssetManager::getInstance();
+        assets.clearCache();
+        assets.setAssetUploader(std::move(uploader));
+
+        const std::string sharedPath = writeGridModel("joined", { 2, 3, 4 });
+        std::string firstTask = assets.loadModelAsync(sharedPath, 5.0f);
+        std::string secondTask = assets.loadModelAsync(sharedPath, 1.0f);
+
+        // A synchronous load from another thread joins the stream and uploads it there
+        std::shared_ptr<const ModelAsset> syncAsset;
+        std::thread loader([&]() { syncAsset = assets.loadModelAsset(sharedPath); });
+        loader.join();
+
+        for (ui32 frame = 0; frame < 100 && !(assets.isLoadingComplete(firstTask) && assets.isLoadingComplete(secondTask)); ++frame)
+        {
+            assets.update(1000.0f);
+        }
+        std::shared_ptr<Model> firstModel = assets.getLoadedModel(firstTask);
+        std::shared_ptr<Model> secondModel = assets.getLoadedModel(secondTask);
+        DX3DCheck(context, syncAsset && syncAsset->meshes.size() == 3);
+        DX3DCheck(context, firstModel && firstModel->getAsset() == syncAsset);
+        DX3DCheck(context, secondModel && secondModel->getAsset() == syncAsset);
+        DX3DCheck(context, getMeshRecords(recorder).size() == 3);
+        DX3DCheck(context, assets.isModelCached(sharedPath));
+
+        // Cancelling one of two tasks leaves the load running for the other
+        const std::string cancelledPath = writeGridModel("joinedCancel", { 5, 6 });
+        std::string keptTask = assets.loadModelAsync(cancelledPath, 0.0f);
+        std::string droppedTask = assets.loadModelAsync(cancelledPath, 0.0f);
+        assets.cancelLoading(droppedTask);
+        for (ui32 frame = 0; frame < 1000 && !assets.isLoadingComplete(keptTask); ++frame)
+        {
+            assets.update(1000.0f);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        DX3DCheck(context, assets.hasLoadingError(droppedTask));
+        DX3DCheck(context, !assets.hasLoadingError(keptTask) && assets.getLoadedModel(keptTask) != nullptr);
+        DX3DCheck(context, getMeshRecords(recorder).size() == 5);
+
+        // Cancelling the only task drops the load, and nothing is cached
+        const std::string abandonedPath = writeGridModel("joinedAbandoned", { 7 });
+        std::string abandonedTask = assets.loadModelAsync(abandonedPath, 0.0f);
+        assets.cancelLoading(abandonedTask);
+        for (ui32 frame = 0; frame < 10; ++frame)
+        {
+            assets.update(1000.0f);
+        }
+        DX3DCheck(context, !assets.isModelCached(abandonedPath));
+
+        firstModel.reset();
+        secondModel.reset();
+        for (const std::string& task : { firstTask, secondTask, keptTask, droppedTask, abandonedTask })
+        {
+            assets.cleanupTask(task);
+        }
+        assets.clearCache();
+    }
+
+    const TestRegistration s_priority("Assets: uploads follow request priority", TestKind::Test, &testUploadsFollowPriority);
+    const TestRegistration s_cancel("Assets: cancelling a request during a stage", TestKind::Test, &testCancelDuringStage);
+    const TestRegistration s_budget("Assets: uploads keep to their budget", TestKind::Test, &testUploadBudget);
+    const TestRegistration s_join("Assets: AssetManager joins loads in flight", TestKind::Test, &testAssetManagerJoinsLoadsInFlight);
+}
@@ -0,0 +1,191 @@
+#include "TestFramework.h"
+#include <DX3D/Math/BoundingVolumeHierarchy.h>
+#include <cstdio>
+#include <limits>
+#include <random>
+
+using namespace dx3d;
+
+namespace
+{
+    constexpr ui32 BENCHMARK_RUNS = 5;
+    constexpr double PICK_BUDGET_MILLISECONDS = 1.0;
+
+    struct RayHit
+    {
+        i32 item = -1;
+        float distance = std::numeric_limits<float>::max();
+    };
+
+    // Boxes of mixed sizes spread over a flat area, like objects on a level
+    std::vector<AABB> createSceneBounds(ui32 count, float halfWidth, std::mt19937& random)
+    {
+        std::uniform_real_distribution<float> coordinate(-halfWidth, halfWidth);
+        std::uniform_real_distribution<float> size(0.2f, 3.0f);
+        std::vector<AABB> bounds(count);
+        for (AABB& box : bounds)
+        {
+            Vector3 center(coordinate(random), coordinate(random) * 0.2f, coordinate(random));
+            Vector3 extents(size(random), size(random), size(random));
+            box = AABB(center - extents, center + extents);
+        }
+        return bounds;
+    }
+
+    // Rays from above the scene looking down at an angle, as mouse picks from an editor camera do
+    Ray createPickRay(float halfWidth, std::mt19937& random)
+    {
+        std::uniform_real_distribution<float> coordinate(-halfWidth, halfWidth);
+        Vector3 origin(coordinate(random), 50.0f, coordinate(random));
+        Vector3 direction = Vector3::Normalize(Vector3(coordinate(random), -0.4f * halfWidth, coordinate(random)));
+        return Ray(origin, direction);
+    }
+
+    RayHit raycastBruteForce(const std::vector<AABB>& bounds, const Ray& ray)
+    {
+        RayHit hit;
+        for (ui32 i = 0; i < bounds.size(); ++i)
+        {
+            float distance = 0.0f;
+            if (intersectRayAABB(ray, bounds[i], distance) && distance < hit.distance)
+            {
+                hit.item = static_cast<i32>(i);
+                hit.distance = distance;
+            }
+        }
+        return hit;
+    }
+
+    // Items count as hit where the ray enters their box, so the BVH must find the same nearest box
+    RayHit raycastHierarchy(const BoundingVolumeHierarchy& bvh, const std::vector<AABB>& bounds, const Ray& ray)
+    {
+        RayHit hit;
+        const Vector3 inverseDirection = getInverseDirection(ray);
+        bvh.raycast(ray, hit.distance, [&](ui32 item, float& maxT)
+            {
+                float distance = 0.0f;
+                if (!intersectRayAABB(ray, inverseDirection, bounds[item], maxT, distance) || distance >= maxT)
+                    return false;
+
+                maxT = distance;
+                hit.item = static_cast<i32>(item);
+                return true;
+            });
+        return hit;
+    }
+
+    bool isSameHit(const RayHit& a, const RayHit& b)
+    {
+        // Boxes entered at exactly the same distance may come back in either order
+        return a.item == b.item || (a.item >= 0 && b.item >= 0 && a.distance == b.distance);
+    }
+
+    void testRaycastMatchesBruteForce(TestContext& context)
+    {
+        constexpr ui32 ITEM_COUNT = 5000;
+        constexpr ui32 RAY_COUNT = 400;
+        constexpr ui32 REFITS_PER_ROUND = 250;
+        constexpr float HALF_WIDTH = 150.0f;
+
+        std::mt19937 random(1);
+        std::vector<AABB> bounds = createSceneBounds(ITEM_COUNT, HALF_WIDTH, random);
+        BoundingVolumeHierarchy bvh;
+        float maxT = std::numeric_limits<float>::max();
+        DX3DCheck(context, !bvh.raycast(createPickRay(HALF_WIDTH, random), maxT, [](ui32, float&) { return true; }));
+
+        bvh.build(bounds);
+        DX3DCheck(context, bvh.getItemCount() == ITEM_COUNT);
+
+        // Rays against the fresh tree, then again after each round of moving items by up to a few units
+        std::uniform_real_distribution<float> offset(-5.0f, 5.0f);
+        ui32 mismatches = 0;
+        ui32 hits = 0;
+        for (ui32 round = 0; round < 3; ++round)
+        {
+            if (round > 0)
+            {
+                for (ui32 i = 0; i < REFITS_PER_ROUND; ++i)
+                {
+                    ui32 item = random() % ITEM_COUNT;
+                    Vector3 move(offset(random), offset(random), offset(random));
+                    bounds[item] = AABB(bounds[item].min + move, bounds[item].max + move);
+                    bvh.refit(item, bounds[item]);
+                }
+            }
+
+            for (ui32 i = 0; i < RAY_COUNT; ++i)
+            {
+                Ray ray = createPickRay(HALF_WIDTH, random);
+                RayHit expected = raycastBruteForce(bounds, ray);
+                RayHit actual = raycastHierarchy(bvh, bounds, ray);
+                if (!isSameHit(expected, actual))
+                    ++mismatches;
+                if (expected.item >= 0)
+                    ++hits;
+            }
+        }
+        DX3DCheck(context, bvh.getRefitCount() == 2 * REFITS_PER_ROUND);
+        DX3DCheck(context, hits > RAY_COUNT);
+        DX3DCheck(context, mismatches == 0);
+
+        // A ray that misses everything
+        Ray up(Vector3(0.0f, 1000.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f));
+        DX3DCheck(context, raycastHierarchy(bvh, bounds, up).item == -1);
+    }
+
+    void benchmarkPicking(TestContext& context)
+    {
+        constexpr ui32 ITEM_COUNT = 50000;
+        constexpr ui32 RAY_COUNT = 1000;
+        constexpr ui32 REFIT_COUNT = 500;
+        constexpr float HALF_WIDTH = 500.0f;
+
+        std::mt19937 random(2);
+        std::vector<AABB> bounds = createSceneBounds(ITEM_COUNT, HALF_WIDTH, random);
+        std::vector<Ray> rays;
+        for (ui32 i = 0; i < RAY_COUNT; ++i)
+        {
+            rays.push_back(createPickRay(HALF_WIDTH, random));
+        }
+
+        BoundingVolumeHierarchy bvh;
+        double buildMilliseconds = measureMilliseconds(BENCHMARK_RUNS, [&]() { bvh.build(bounds); });
+
+        std::uniform_real_distribution<float> offset(-1.0f, 1.0f);
+        double refitMilliseconds = measureMilliseconds(BENCHMARK_RUNS, [&]()
+            {
+                for (ui32 i = 0; i < REFIT_COUNT; ++i)
+                {
+                    ui32 item = (i * 7919) % ITEM_COUNT;
+                    Vector3 move(offset(random), 0.0f, offset(random));
+                    bounds[item] = AABB(bounds[item].min + move, bounds[item].max + move);
+                    bvh.refit(item, bounds[item]);
+                }
+            });
+
+        long long checksum = 0;
+        double pickMilliseconds = measureMilliseconds(BENCHMARK_RUNS, [&]()
+            {
+                for (const Ray& ray : rays)
+                {
+                    checksum += raycastHierarchy(bvh, bounds, ray).item;
+                }
+            }) / RAY_COUNT;
+        double bruteForceMilliseconds = measureMilliseconds(1, [&]()
+            {
+                for (ui32 i = 0; i < RAY_COUNT; i += 10)
+                {
+                    checksum -= raycastBruteForce(bounds, rays[i]).item;
+                }
+            }) / (RAY_COUNT / 10);
+
+        context.reportTiming("build, 50k objects", buildMilliseconds);
+        context.reportTiming("refit 500 moved objects", refitMilliseconds);
+        context.reportTiming("pick through the BVH, per ray", pickMilliseconds, PICK_BUDGET_MILLISECONDS);
+        context.reportTiming("pick by testing every object, per ray", bruteForceMilliseconds);
+        printf("    (checksum %lld)\n", checksum);
+    }
+
+    const TestRegistration s_raycast("BVH: raycasts match brute force, before and after refits", TestKind::Test, &testRaycastMatchesBruteForce);
+    const TestRegistration s_pickBenchmark("BVH: picking among 50k objects", TestKind::Benchmark, &benchmarkPicking);
+}
@@ -0,0 +1,137 @@
+#include "TestFramework.h"
+#include "TestFixtures.h"
+#include <DX3D/Math/Frustum.h>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+using namespace dx3d;
+
+namespace
+{
+    constexpr ui32 BENCHMARK_RUNS = 5;
+
+    // Camera at z = -10 looking down +z, so several frustum planes have zero components
+    Frustum createCameraFrustum()
+    {
+        return Frustum::fromViewProjection(createTestCamera(Vector3(0.0f, 0.0f, -10.0f), Vector3()).viewProjection);
+    }
+
+    // Unit boxes scattered around the camera, most of them outside the frustum
+    std::vector<AABB> createRandomBoxes(ui32 count, ui32 seed)
+    {
+        std::mt19937 random(seed);
+        std::uniform_real_distribution<float> coordinate(-120.0f, 120.0f);
+        std::vector<AABB> boxes;
+        boxes.reserve(count);
+        for (ui32 i = 0; i < count; ++i)
+        {
+            Vector3 center(coordinate(random), coordinate(random), coordinate(random));
+            boxes.emplace_back(center - Vector3(1.0f, 1.0f, 1.0f), center + Vector3(1.0f, 1.0f, 1.0f));
+        }
+        return boxes;
+    }
+
+    // The SIMD loops must agree with the scalar tests, including for the tail that is not a multiple of four
+    void testCullingMatchesScalar(TestContext& context)
+    {
+        const Frustum frustum = createCameraFrustum();
+        const std::vector<AABB> boxes = createRandomBoxes(1003, 3);
+
+        CullingBounds bounds;
+        for (const AABB& box : boxes)
+        {
+            bounds.add(box);
+        }
+
+        std::vector<ui32> visibleBoxes;
+        std::vector<ui32> visibleSpheres;
+        cullBoxes(frustum, bounds, visibleBoxes);
+        cullSpheres(frustum, bounds, visibleSpheres);
+
+        std::vector<ui32> expectedBoxes;
+        std::vector<ui32> expectedSpheres;
+        for (ui32 i = 0; i < boxes.size(); ++i)
+        {
+            if (frustum.intersects(boxes[i]))
+                expectedBoxes.push_back(i);
+            if (frustum.intersects(BoundingSphere::fromAABB(boxes[i])))
+                expectedSpheres.push_back(i);
+        }
+        DX3DCheck(context, !expectedBoxes.empty());
+        DX3DCheck(context, visibleBoxes == expectedBoxes);
+        DX3DCheck(context, visibleSpheres == expectedSpheres);
+
+        DX3DCheck(context, frustum.intersects(AABB(Vector3(-0.1f, -0.1f, -0.1f), Vector3(0.1f, 0.1f, 0.1f))));
+        DX3DCheck(context, !frustum.intersects(AABB(Vector3(-0.1f, -0.1f, -20.1f), Vector3(0.1f, 0.1f, -19.9f))));
+        DX3DCheck(context, !frustum.intersects(AABB(Vector3(0.0f, 0.0f, 200.0f), Vector3(1.0f, 1.0f, 201.0f))));
+    }
+
+    // Game adds an empty box for null objects to keep indices aligned; none may come back visible
+    void testEmptyBoundsAreCulled(TestContext& context)
+    {
+        const Frustum frustum = createCameraFrustum();
+        const AABB visibleBox(Vector3(-0.5f, -0.5f, -0.5f), Vector3(0.5f, 0.5f, 0.5f));
+        DX3DCheck(context, !frustum.intersects(AABB()));
+
+        // Empty boxes both inside a block of four and in the scalar tail
+        CullingBounds bounds;
+        std::vector<ui32> expected;
+        for (ui32 i = 0; i < 7; ++i)
+        {
+            bool empty = (i == 1 || i == 2 || i == 5);
+            bounds.add(empty ? AABB() : visibleBox);
+            if (!empty)
+                expected.push_back(i);
+        }
+
+        std::vector<ui32> visibleBoxes;
+        std::vector<ui32> visibleSpheres;
+        cullBoxes(frustum, bounds, visibleBoxes);
+        cullSpheres(frustum, bounds, visibleSpheres);
+        DX3DCheck(context, visibleBoxes == expected);
+        DX3DCheck(context, visibleSpheres == expected);
+
+        // The stored values stay finite, so LOD selection reading the radius is safe too
+        DX3DCheck(context, std::isfinite(bounds.centerX[1]) && std::isfinite(bounds.extentX[1]) && std::isfinite(bounds.radius[1]));
+    }
+
+    void benchmarkCulling(TestContext& context)
+    {
+        constexpr ui32 BOUNDS_COUNT = 100000;
+
+        const Frustum frustum = createCameraFrustum();
+        CullingBounds bounds;
+        bounds.reserve(BOUNDS_COUNT);
+        for (const AABB& box : createRandomBoxes(BOUNDS_COUNT, 5))
+        {
+            bounds.add(box);
+        }
+
+        std::vector<ui32> visible;
+        visible.reserve(BOUNDS_COUNT);
+        double boxMilliseconds = measureMilliseconds(BENCHMARK_RUNS, [&]()
+            {
+                visible.clear();
+                cullBoxes(frustum, bounds, visible);
+            });
+        size_t visibleBoxes = visible.size();
+
+        double sphereMilliseconds = measureMilliseconds(BENCHMARK_RUNS, [&]()
+            {
+                visible.clear();
+                cullSpheres(frustum, bounds, visible);
+            });
+        DX3DCheck(context, visibleBoxes > 0 && visibleBoxes < BOUNDS_COUNT);
+
+        char label[96];
+        snprintf(label, sizeof(label), "100k boxes, one view (%zu visible)", visibleBoxes);
+        context.reportTiming(label, boxMilliseconds);
+        snprintf(label, sizeof(label), "100k spheres, one view (%zu visible)", visible.size());
+        context.reportTiming(label, sphereMilliseconds);
+    }
+
+    const TestRegistration s_cullingMatchesScalar("Culling: SIMD culling matches the scalar tests", TestKind::Test, &testCullingMatchesScalar);
+    const TestRegistration s_emptyBounds("Culling: empty bounds are never visible", TestKind::Test, &testEmptyBoundsAreCulled);
+    const TestRegistration s_cullingBenchmark("Culling: 100k bounds per view", TestKind::Benchmark, &benchmarkCulling);
+}
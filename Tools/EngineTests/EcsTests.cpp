@@ -0,0 +1,190 @@
+#include "TestFramework.h"
+#include <DX3D/ECS/ComponentManager.h>
+#include <DX3D/ECS/Components/TransformComponent.h>
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <unordered_map>
+
+using namespace dx3d;
+
+namespace
+{
+    constexpr ui32 BENCHMARK_RUNS = 5;
+
+    struct Health
+    {
+        float value = 0.0f;
+    };
+
+    // The hash map storage ComponentArray replaced, kept for comparison
+    template<typename T>
+    class MapComponentArray
+    {
+    public:
+        void addComponent(EntityID entity, T component) { m_components[entity] = std::move(component); }
+        void removeComponent(EntityID entity) { m_components.erase(entity); }
+
+        T* getComponent(EntityID entity)
+        {
+            auto it = m_components.find(entity);
+            return (it != m_components.end()) ? &it->second : nullptr;
+        }
+
+        auto begin() { return m_components.begin(); }
+        auto end() { return m_components.end(); }
+
+    private:
+        std::unordered_map<EntityID, T> m_components;
+    };
+
+    void testSparseSet(TestContext& context)
+    {
+        ComponentArray<Health> array;
+        for (EntityID entity = 1; entity <= 5; ++entity)
+        {
+            array.addComponent(entity, { static_cast<float>(entity) });
+        }
+        DX3DCheck(context, array.size() == 5);
+        DX3DCheck(context, !array.hasComponent(0));
+        DX3DCheck(context, !array.hasComponent(100));
+        DX3DCheck(context, array.getComponent(100) == nullptr);
+
+        // Adding again replaces the component in place
+        array.addComponent(3, { 30.0f });
+        DX3DCheck(context, array.size() == 5);
+        DX3DCheck(context, array.getComponent(3)->value == 30.0f);
+
+        // Removal moves the last entry into the hole and keeps every other entity reachable
+        array.removeComponent(2);
+        array.removeComponent(2);
+        array.removeComponent(42);
+        DX3DCheck(context, array.size() == 4);
+        DX3DCheck(context, !array.hasComponent(2));
+        DX3DCheck(context, array.getComponent(5)->value == 5.0f);
+        DX3DCheck(context, array.getComponent(1)->value == 1.0f);
+
+        // Iteration walks the dense entries, each once
+        float sum = 0.0f;
+        ui32 count = 0;
+        for (const auto& [entity, health] : array)
+        {
+            DX3DCheck(context, array.getComponent(entity) == &health);
+            sum += health.value;
+            ++count;
+        }
+        DX3DCheck(context, count == 4);
+        DX3DCheck(context, sum == 1.0f + 30.0f + 4.0f + 5.0f);
+
+        array.removeComponent(1);
+        array.removeComponent(3);
+        array.removeComponent(4);
+        array.removeComponent(5);
+        DX3DCheck(context, array.empty());
+        DX3DCheck(context, array.begin() == array.end());
+    }
+
+    void testComponentManager(TestContext& context)
+    {
+        ComponentManager& manager = ComponentManager::getInstance();
+        manager.registerComponent<Health>();
+
+        const EntityID first = 101;
+        const EntityID second = 102;
+        manager.addComponent(first, Health{ 1.0f });
+        manager.addComponent(second, Health{ 2.0f });
+        DX3DCheck(context, manager.hasComponent<Health>(first));
+        DX3DCheck(context, manager.getComponent<Health>(second)->value == 2.0f);
+
+        manager.removeEntity(first);
+        DX3DCheck(context, !manager.hasComponent<Health>(first));
+        DX3DCheck(context, manager.getComponent<Health>(second)->value == 2.0f);
+
+        manager.removeEntity(second);
+        DX3DCheck(context, manager.getComponentArray<Health>()->empty());
+    }
+
+    // Adds, looks up in random order, iterates and removes half of `count` transforms
+    template<typename Array>
+    void runStorageBenchmark(TestContext& context, const char* storageName, ui32 count,
+        const std::vector<EntityID>& lookupOrder, double& checksum)
+    {
+        char label[96];
+        double addMilliseconds = 1e30;
+        double getMilliseconds = 1e30;
+        double iterateMilliseconds = 1e30;
+        double removeMilliseconds = 1e30;
+        for (ui32 run = 0; run < BENCHMARK_RUNS; ++run)
+        {
+            Array array;
+            TransformComponent transform;
+            addMilliseconds = std::min(addMilliseconds, measureMilliseconds(1, [&]()
+                {
+                    for (EntityID entity = 1; entity <= count; ++entity)
+                    {
+                        transform.position.x = static_cast<float>(entity);
+                        array.addComponent(entity, transform);
+                    }
+                }));
+
+            // Whole numbers, so the sum is exact in any iteration order
+            double sum = 0.0;
+            getMilliseconds = std::min(getMilliseconds, measureMilliseconds(1, [&]()
+                {
+                    for (EntityID entity : lookupOrder)
+                    {
+                        sum += array.getComponent(entity)->position.x;
+                    }
+                }));
+
+            iterateMilliseconds = std::min(iterateMilliseconds, measureMilliseconds(1, [&]()
+                {
+                    for (auto& entry : array)
+                    {
+                        entry.second.position.y += entry.second.position.x;
+                        sum += entry.second.position.y;
+                    }
+                }));
+
+            removeMilliseconds = std::min(removeMilliseconds, measureMilliseconds(1, [&]()
+                {
+                    for (ui32 i = 0; i < count / 2; ++i)
+                    {
+                        array.removeComponent(lookupOrder[i]);
+                    }
+                }));
+            checksum = sum;
+        }
+
+        snprintf(label, sizeof(label), "%-10s %6u add", storageName, count);
+        context.reportTiming(label, addMilliseconds);
+        snprintf(label, sizeof(label), "%-10s %6u get (random order)", storageName, count);
+        context.reportTiming(label, getMilliseconds);
+        snprintf(label, sizeof(label), "%-10s %6u iterate", storageName, count);
+        context.reportTiming(label, iterateMilliseconds);
+        snprintf(label, sizeof(label), "%-10s %6u remove half", storageName, count);
+        context.reportTiming(label, removeMilliseconds);
+    }
+
+    void benchmarkComponentStorage(TestContext& context)
+    {
+        std::mt19937 random(1);
+        for (ui32 count : { 1000u, 10000u, 100000u })
+        {
+            std::vector<EntityID> lookupOrder(count);
+            std::iota(lookupOrder.begin(), lookupOrder.end(), 1u);
+            std::shuffle(lookupOrder.begin(), lookupOrder.end(), random);
+
+            double sparseChecksum = 0.0;
+            double mapChecksum = 0.0;
+            runStorageBenchmark<ComponentArray<TransformComponent>>(context, "sparse set", count, lookupOrder, sparseChecksum);
+            runStorageBenchmark<MapComponentArray<TransformComponent>>(context, "hash map", count, lookupOrder, mapChecksum);
+            DX3DCheck(context, sparseChecksum == mapChecksum);
+        }
+    }
+
+    const TestRegistration s_sparseSet("ECS: sparse set storage", TestKind::Test, &testSparseSet);
+    const TestRegistration s_componentManager("ECS: component manager", TestKind::Test, &testComponentManager);
+    const TestRegistration s_storageBenchmark("ECS: sparse set against hash map, 1k to 100k", TestKind::Benchmark, &benchmarkComponentStorage);
+}
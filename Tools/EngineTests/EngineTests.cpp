@@ -0,0 +1,87 @@
+// Headless tests and benchmarks of engine systems that run without a window or device.
+// By default every test runs and the exit code reports whether all passed. With --benchmark the
+// benchmarks run instead; build Release for meaningful numbers, where frame budgets are enforced
+// unless the CI variable is set.
+// Arguments that are not options select the cases whose names contain them.
+
+#include "TestFramework.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace dx3d;
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    bool matchesFilters(const char* name, const std::vector<std::string>& filters)
+    {
+        if (filters.empty())
+            return true;
+
+        for (const auto& filter : filters)
+        {
+            if (std::strstr(name, filter.c_str()))
+                return true;
+        }
+        return false;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    TestKind kind = TestKind::Test;
+    std::vector<std::string> filters;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--benchmark") == 0)
+        {
+            kind = TestKind::Benchmark;
+        }
+        else if (std::strcmp(argv[i], "--update-golden") == 0)
+        {
+            setUpdateGoldenFiles(true);
+        }
+        else if (std::strcmp(argv[i], "--help") == 0)
+        {
+            printf("Usage: EngineTests [--benchmark] [--update-golden] [name filter]...\n");
+            return EXIT_SUCCESS;
+        }
+        else
+        {
+            filters.push_back(argv[i]);
+        }
+    }
+
+    ui32 runCount = 0;
+    ui32 failedCount = 0;
+    for (const auto& testCase : getTestCases())
+    {
+        if (testCase.kind != kind || !matchesFilters(testCase.name, filters))
+            continue;
+
+        printf("%s\n", testCase.name);
+        TestContext context;
+        auto start = Clock::now();
+        testCase.function(context);
+        float milliseconds = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+
+        ++runCount;
+        if (context.getFailureCount() > 0)
+        {
+            ++failedCount;
+            printf("  FAILED (%u checks, %.1f ms)\n", context.getFailureCount(), milliseconds);
+        }
+        else
+        {
+            printf("  passed (%.1f ms)\n", milliseconds);
+        }
+    }
+
+    printf("%u of %u %s passed\n", runCount - failedCount, runCount, kind == TestKind::Benchmark ? "benchmarks" : "tests");
+    return (failedCount == 0 && runCount > 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include <DX3D/Core/Core.h>
+
+namespace dx3d
+{
+    // Stand-ins for device resources in draw packets. RenderQueue and RecordingRenderBackend only
+    // compare and record these pointers, never read through them, so distinct addresses are enough.
+    template<typename Resource>
+    const Resource* getFakeResource(ui32 id)
+    {
+        static constexpr ui32 MAX_FAKE_RESOURCES = 1024;
+        static unsigned char s_storage[MAX_FAKE_RESOURCES];
+        return reinterpret_cast<const Resource*>(&s_storage[id % MAX_FAKE_RESOURCES]);
+    }
+}
@@ -0,0 +1,162 @@
+#include "TestFramework.h"
+#include <DX3D/ECS/ComponentManager.h>
+#include <DX3D/Graphics/Primitives/AGameObject.h>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+
+using namespace dx3d;
+
+// AGameObject caches its local and world matrices and world bounds, and getWorldVersion() changes
+// each time the world matrix is rebuilt. These cases check the cache against the transform it
+// stands for: moves reach the children, a destroyed parent no longer counts, and reading an
+// unmoved object rebuilds nothing. AGameObject pulls in the renderer and physics, so this only
+// builds in EngineTests.vcxproj.
+
+namespace
+{
+    constexpr float POSITION_TOLERANCE = 1e-4f;
+
+    // The base class with its unit-cube bounds; no mesh, no device
+    class TestGameObject : public AGameObject
+    {
+    public:
+        explicit TestGameObject(const Vector3& position) : AGameObject(position) {}
+
+    protected:
+        CollisionShapeType getCollisionShapeType() const override { return CollisionShapeType::Box; }
+    };
+
+    // Fresh component arrays, as Game registers them at startup
+    void registerGameObjectComponents()
+    {
+        auto& componentManager = ComponentManager::getInstance();
+        componentManager.registerComponent<TransformComponent>();
+        componentManager.registerComponent<PhysicsComponent>();
+        componentManager.registerComponent<MaterialComponent>();
+    }
+
+    bool isNear(const Vector3& a, const Vector3& b)
+    {
+        return std::fabs(a.x - b.x) <= POSITION_TOLERANCE && std::fabs(a.y - b.y) <= POSITION_TOLERANCE &&
+            std::fabs(a.z - b.z) <= POSITION_TOLERANCE;
+    }
+
+    Vector3 getTranslation(const Matrix4x4& matrix)
+    {
+        return Vector3(matrix.m[3][0], matrix.m[3][1], matrix.m[3][2]);
+    }
+
+    // The object's world matrix and bounds sit at worldPosition with the unit cube around it
+    bool checkWorldPosition(TestContext& context, const char* what, const AGameObject& object, const Vector3& worldPosition)
+    {
+        const AABB& bounds = object.getWorldBounds();
+        Vector3 half(0.5f, 0.5f, 0.5f);
+        bool isPlaced = isNear(getTranslation(object.getWorldMatrix()), worldPosition) &&
+            isNear(bounds.min, worldPosition - half) && isNear(bounds.max, worldPosition + half);
+        if (!DX3DCheck(context, isPlaced))
+        {
+            Vector3 translation = getTranslation(object.getWorldMatrix());
+            printf("    %s: world at (%g, %g, %g), expected (%g, %g, %g)\n", what,
+                translation.x, translation.y, translation.z, worldPosition.x, worldPosition.y, worldPosition.z);
+        }
+        return isPlaced;
+    }
+
+    // Parent at (5, 0, 0) with the child one unit along x from it
+    void createParentAndChild(std::shared_ptr<TestGameObject>& parent, std::shared_ptr<TestGameObject>& child)
+    {
+        parent = std::make_shared<TestGameObject>(Vector3(5.0f, 0.0f, 0.0f));
+        child = std::make_shared<TestGameObject>(Vector3(6.0f, 0.0f, 0.0f));
+        child->setParent(parent);
+    }
+
+    void testMovingParentMovesChild(TestContext& context)
+    {
+        registerGameObjectComponents();
+        std::shared_ptr<TestGameObject> parent, child;
+        createParentAndChild(parent, child);
+        DX3DCheck(context, isNear(child->getLocalPosition(), Vector3(1.0f, 0.0f, 0.0f)));
+        checkWorldPosition(context, "child after setParent", *child, Vector3(6.0f, 0.0f, 0.0f));
+
+        ui32 childVersion = child->getWorldVersion();
+        parent->setPosition(Vector3(10.0f, 2.0f, 0.0f));
+        checkWorldPosition(context, "child after setPosition", *child, Vector3(11.0f, 2.0f, 0.0f));
+        DX3DCheck(context, child->getWorldVersion() != childVersion);
+
+        // A grandchild follows two levels down, and through translate as well as setPosition
+        auto grandchild = std::make_shared<TestGameObject>(Vector3(11.0f, 2.0f, 3.0f));
+        grandchild->setParent(child);
+        parent->translate(Vector3(0.0f, -2.0f, 0.0f));
+        checkWorldPosition(context, "grandchild after translate", *grandchild, Vector3(11.0f, 0.0f, 3.0f));
+
+        // Scaling the parent scales the child's offset and its bounds
+        parent->setPosition(Vector3(0.0f, 0.0f, 0.0f));
+        parent->setScale(Vector3(2.0f, 2.0f, 2.0f));
+        DX3DCheck(context, isNear(getTranslation(child->getWorldMatrix()), Vector3(2.0f, 0.0f, 0.0f)));
+        DX3DCheck(context, isNear(child->getWorldBounds().min, Vector3(1.0f, -1.0f, -1.0f)));
+        DX3DCheck(context, isNear(child->getWorldBounds().max, Vector3(3.0f, 1.0f, 1.0f)));
+    }
+
+    void testDestroyedParentReleasesChild(TestContext& context)
+    {
+        registerGameObjectComponents();
+        std::shared_ptr<TestGameObject> parent, child;
+        createParentAndChild(parent, child);
+        auto grandchild = std::make_shared<TestGameObject>(Vector3(6.0f, 0.0f, 2.0f));
+        grandchild->setParent(child);
+        checkWorldPosition(context, "grandchild with parent", *grandchild, Vector3(6.0f, 0.0f, 2.0f));
+
+        ui32 childVersion = child->getWorldVersion();
+        ui32 grandchildVersion = grandchild->getWorldVersion();
+        parent.reset();
+
+        // The child keeps its local transform, which is now its world transform
+        DX3DCheck(context, !child->hasParent());
+        checkWorldPosition(context, "orphaned child", *child, Vector3(1.0f, 0.0f, 0.0f));
+        checkWorldPosition(context, "grandchild of orphaned child", *grandchild, Vector3(1.0f, 0.0f, 2.0f));
+        DX3DCheck(context, child->getWorldVersion() != childVersion);
+        DX3DCheck(context, grandchild->getWorldVersion() != grandchildVersion);
+    }
+
+    void testUnmovedObjectsAreNotRebuilt(TestContext& context)
+    {
+        registerGameObjectComponents();
+        std::shared_ptr<TestGameObject> parent, child;
+        createParentAndChild(parent, child);
+        auto other = std::make_shared<TestGameObject>(Vector3(-3.0f, 0.0f, 0.0f));
+
+        ui32 parentVersion = parent->getWorldVersion();
+        ui32 childVersion = child->getWorldVersion();
+        ui32 otherVersion = other->getWorldVersion();
+
+        // Reading again, matrices and bounds alike, is served from the cache
+        for (ui32 i = 0; i < 3; ++i)
+        {
+            parent->getWorldMatrix();
+            child->getWorldBounds();
+            other->getWorldPosition();
+        }
+        DX3DCheck(context, parent->getWorldVersion() == parentVersion);
+        DX3DCheck(context, child->getWorldVersion() == childVersion);
+        DX3DCheck(context, other->getWorldVersion() == otherVersion);
+
+        // Moving the child rebuilds neither its parent nor an unrelated object
+        child->setPosition(Vector3(0.0f, 1.0f, 0.0f));
+        checkWorldPosition(context, "moved child", *child, Vector3(5.0f, 1.0f, 0.0f));
+        DX3DCheck(context, child->getWorldVersion() != childVersion);
+        DX3DCheck(context, parent->getWorldVersion() == parentVersion);
+        DX3DCheck(context, other->getWorldVersion() == otherVersion);
+
+        // Moving the unrelated object leaves the family alone
+        childVersion = child->getWorldVersion();
+        other->setPosition(Vector3(-4.0f, 0.0f, 0.0f));
+        checkWorldPosition(context, "moved other", *other, Vector3(-4.0f, 0.0f, 0.0f));
+        DX3DCheck(context, parent->getWorldVersion() == parentVersion);
+        DX3DCheck(context, child->getWorldVersion() == childVersion);
+    }
+
+    const TestRegistration s_movingParent("Game objects: moving the parent moves the child's matrix and bounds", TestKind::Test, &testMovingParentMovesChild);
+    const TestRegistration s_destroyedParent("Game objects: a destroyed parent's children rebuild without it", TestKind::Test, &testDestroyedParentReleasesChild);
+    const TestRegistration s_unmoved("Game objects: unmoved objects keep their cached world matrix", TestKind::Test, &testUnmovedObjectsAreNotRebuilt);
+}
@@ -0,0 +1,717 @@
+#include "TestFramework.h"
+#include <DX3D/Assets/ImageDecoder.h>
+#include <DX3D/Particles/ParticleRandom.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#if defined(DX3D_HAS_REFERENCE_CODECS)
+#include <csetjmp>
+#include <png.h>
+#include <jpeglib.h>
+#endif
+
+using namespace dx3d;
+
+namespace
+{
+    constexpr ui32 BENCHMARK_RUNS = 3;
+
+    // Mutations of each input in the corruption test; enough to reach every chunk and marker
+    // handler of the small inputs many times over
+    constexpr ui32 CORRUPTION_ITERATIONS = 300;
+
+    // libjpeg's islow IDCT and fancy upsampling round differently from decodeImage's, so JPEGs
+    // are compared by PSNR (the bundled ones measure 52-77 dB); PNGs are lossless and must match exactly
+    constexpr double MIN_JPEG_PSNR = 48.0;
+
+    std::vector<unsigned char> readFile(const std::filesystem::path& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        return std::vector<unsigned char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    // Every .png and .jpg under Assets/Textures, in a fixed order
+    std::vector<std::filesystem::path> getBundledTextures()
+    {
+        std::vector<std::filesystem::path> paths;
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(getAssetDirectory() / "Textures"))
+        {
+            std::string extension = entry.path().extension().string();
+            if (entry.is_regular_file() && (extension == ".png" || extension == ".jpg"))
+                paths.push_back(entry.path());
+        }
+        std::sort(paths.begin(), paths.end());
+        return paths;
+    }
+
+    std::string getTextureName(const std::filesystem::path& path)
+    {
+        return path.lexically_relative(getAssetDirectory() / "Textures").generic_string();
+    }
+
+    // ---------------------------------------------------------------------------------------
+    // A PNG encoder for the generated images: every row filter, Adam7 and stored DEFLATE blocks
+
+    struct PngSource
+    {
+        ui32 width = 0;
+        ui32 height = 0;
+        ui32 bitDepth = 8;
+        ui32 colorType = 6;
+        bool isInterlaced = false;
+        std::vector<ui32> samples;            // width * height * channels, at full sample precision
+        std::vector<unsigned char> palette;   // RGB triples
+        std::vector<unsigned char> transparency; // the tRNS chunk as stored
+
+        ui32 getChannels() const
+        {
+            switch (colorType)
+            {
+            case 2: return 3;
+            case 4: return 2;
+            case 6: return 4;
+            default: return 1;
+            }
+        }
+    };
+
+    // Start x, start y, step x, step y of each pass
+    constexpr ui32 ADAM7[7][4] = {
+        { 0, 0, 8, 8 }, { 4, 0, 8, 8 }, { 0, 4, 4, 8 }, { 2, 0, 4, 4 }, { 0, 2, 2, 4 }, { 1, 0, 2, 2 }, { 0, 1, 1, 2 } };
+
+    ui32 crc32(const unsigned char* data, size_t size, ui32 crc = 0)
+    {
+        crc = ~crc;
+        for (size_t i = 0; i < size; ++i)
+        {
+            crc ^= data[i];
+            for (ui32 bit = 0; bit < 8; ++bit)
+                crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+        }
+        return ~crc;
+    }
+
+    void appendBigEndian32(std::vector<unsigned char>& bytes, ui32 value)
+    {
+        bytes.push_back(static_cast<unsigned char>(value >> 24));
+        bytes.push_back(static_cast<unsigned char>(value >> 16));
+        bytes.push_back(static_cast<unsigned char>(value >> 8));
+        bytes.push_back(static_cast<unsigned char>(value));
+    }
+
+    void appendChunk(std::vector<unsigned char>& png, const char* type, const std::vector<unsigned char>& data)
+    {
+        appendBigEndian32(png, static_cast<ui32>(data.size()));
+        size_t start = png.size();
+        png.insert(png.end(), type, type + 4);
+        png.insert(png.end(), data.begin(), data.end());
+        appendBigEndian32(png, crc32(png.data() + start, png.size() - start));
+    }
+
+    // zlib stream of stored blocks
+    std::vector<unsigned char> storeZlib(const std::vector<unsigned char>& data)
+    {
+        std::vector<unsigned char> stream = { 0x78, 0x01 };
+        size_t position = 0;
+        do
+        {
+            size_t length = std::min<size_t>(data.size() - position, 65535);
+            bool isFinal = position + length == data.size();
+            stream.push_back(isFinal ? 1 : 0);
+            stream.push_back(static_cast<unsigned char>(length));
+            stream.push_back(static_cast<unsigned char>(length >> 8));
+            stream.push_back(static_cast<unsigned char>(~length));
+            stream.push_back(static_cast<unsigned char>(~length >> 8));
+            stream.insert(stream.end(), data.begin() + position, data.begin() + position + length);
+            position += length;
+        } while (position < data.size());
+
+        ui32 a = 1;
+        ui32 b = 0;
+        for (unsigned char byte : data)
+        {
+            a = (a + byte) % 65521;
+            b = (b + a) % 65521;
+        }
+        appendBigEndian32(stream, (b << 16) | a);
+        return stream;
+    }
+
+    ui32 paeth(i32 a, i32 b, i32 c)
+    {
+        i32 p = a + b - c;
+        i32 pa = std::abs(p - a);
+        i32 pb = std::abs(p - b);
+        i32 pc = std::abs(p - c);
+        if (pa <= pb && pa <= pc)
+            return a;
+        return pb <= pc ? b : c;
+    }
+
+    // Packs the pixels of one pass into rows, each with the filter picked by its row index,
+    // so all five filters appear next to each other
+    void appendPass(const PngSource& source, ui32 startX, ui32 startY, ui32 stepX, ui32 stepY, std::vector<unsigned char>& raw)
+    {
+        const ui32 channels = source.getChannels();
+        const ui32 width = startX < source.width ? (source.width - startX + stepX - 1) / stepX : 0;
+        const ui32 height = startY < source.height ? (source.height - startY + stepY - 1) / stepY : 0;
+        if (!width || !height)
+            return;
+
+        const ui32 rowBytes = (width * channels * source.bitDepth + 7) / 8;
+        const ui32 pixelBytes = std::max(1u, channels * source.bitDepth / 8);
+        std::vector<unsigned char> previous(rowBytes, 0);
+        std::vector<unsigned char> row(rowBytes);
+
+        for (ui32 y = 0; y < height; ++y)
+        {
+            std::fill(row.begin(), row.end(), 0);
+            const ui32* pixels = &source.samples[size_t(startY + y * stepY) * source.width * channels];
+            for (ui32 x = 0; x < width; ++x)
+            {
+                for (ui32 c = 0; c < channels; ++c)
+                {
+                    ui32 sample = pixels[(startX + x * stepX) * channels + c];
+                    ui32 index = x * channels + c;
+                    if (source.bitDepth == 16)
+                    {
+                        row[index * 2] = static_cast<unsigned char>(sample >> 8);
+                        row[index * 2 + 1] = static_cast<unsigned char>(sample);
+                    }
+                    else
+                    {
+                        ui32 bit = index * source.bitDepth;
+                        row[bit >> 3] |= static_cast<unsigned char>(sample << (8 - source.bitDepth - (bit & 7)));
+                    }
+                }
+            }
+
+            ui32 filter = y % 5;
+            raw.push_back(static_cast<unsigned char>(filter));
+            for (ui32 i = 0; i < rowBytes; ++i)
+            {
+                i32 left = i >= pixelBytes ? row[i - pixelBytes] : 0;
+                i32 up = y > 0 ? previous[i] : 0;
+                i32 upLeft = y > 0 && i >= pixelBytes ? previous[i - pixelBytes] : 0;
+                i32 predicted = 0;
+                switch (filter)
+                {
+                case 1: predicted = left; break;
+                case 2: predicted = up; break;
+                case 3: predicted = (left + up) >> 1; break;
+                case 4: predicted = paeth(left, up, upLeft); break;
+                default: break;
+                }
+                raw.push_back(static_cast<unsigned char>(row[i] - predicted));
+            }
+            previous = row;
+        }
+    }
+
+    std::vector<unsigned char> encodePng(const PngSource& source)
+    {
+        std::vector<unsigned char> raw;
+        if (source.isInterlaced)
+        {
+            for (const auto& pass : ADAM7)
+                appendPass(source, pass[0], pass[1], pass[2], pass[3], raw);
+        }
+        else
+        {
+            appendPass(source, 0, 0, 1, 1, raw);
+        }
+
+        std::vector<unsigned char> png = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+        std::vector<unsigned char> header;
+        appendBigEndian32(header, source.width);
+        appendBigEndian32(header, source.height);
+        header.insert(header.end(), { static_cast<unsigned char>(source.bitDepth), static_cast<unsigned char>(source.colorType),
+            0, 0, static_cast<unsigned char>(source.isInterlaced ? 1 : 0) });
+        appendChunk(png, "IHDR", header);
+        if (!source.palette.empty())
+            appendChunk(png, "PLTE", source.palette);
+        if (!source.transparency.empty())
+            appendChunk(png, "tRNS", source.transparency);
+
+        // Split over two IDAT chunks, which the decoder has to join
+        std::vector<unsigned char> compressed = storeZlib(raw);
+        size_t half = compressed.size() / 2;
+        appendChunk(png, "IDAT", std::vector<unsigned char>(compressed.begin(), compressed.begin() + half));
+        appendChunk(png, "IDAT", std::vector<unsigned char>(compressed.begin() + half, compressed.end()));
+        appendChunk(png, "IEND", {});
+        return png;
+    }
+
+    // What the pixels of source should decode to, following the PNG specification's conversions
+    std::vector<unsigned char> getExpectedPixels(const PngSource& source)
+    {
+        const ui32 channels = source.getChannels();
+        const ui32 maxSample = (1u << source.bitDepth) - 1;
+        auto toByte = [&](ui32 sample)
+            {
+                return static_cast<unsigned char>(source.bitDepth == 16 ? sample >> 8 : sample * 255 / maxSample);
+            };
+        auto readKey = [&](ui32 c)
+            {
+                return (ui32(source.transparency[c * 2]) << 8) | source.transparency[c * 2 + 1];
+            };
+
+        std::vector<unsigned char> pixels;
+        for (size_t i = 0; i < size_t(source.width) * source.height; ++i)
+        {
+            const ui32* sample = &source.samples[i * channels];
+            switch (source.colorType)
+            {
+            case 0:
+                pixels.insert(pixels.end(), { toByte(sample[0]), toByte(sample[0]), toByte(sample[0]),
+                    static_cast<unsigned char>(!source.transparency.empty() && sample[0] == readKey(0) ? 0 : 255) });
+                break;
+            case 2:
+            {
+                bool isKey = !source.transparency.empty() && sample[0] == readKey(0) && sample[1] == readKey(1) && sample[2] == readKey(2);
+                pixels.insert(pixels.end(), { toByte(sample[0]), toByte(sample[1]), toByte(sample[2]),
+                    static_cast<unsigned char>(isKey ? 0 : 255) });
+                break;
+            }
+            case 3:
+                pixels.insert(pixels.end(), { source.palette[sample[0] * 3], source.palette[sample[0] * 3 + 1], source.palette[sample[0] * 3 + 2],
+                    static_cast<unsigned char>(sample[0] < source.transparency.size() ? source.transparency[sample[0]] : 255) });
+                break;
+            case 4:
+                pixels.insert(pixels.end(), { toByte(sample[0]), toByte(sample[0]), toByte(sample[0]), toByte(sample[1]) });
+                break;
+            default:
+                pixels.insert(pixels.end(), { toByte(sample[0]), toByte(sample[1]), toByte(sample[2]), toByte(sample[3]) });
+                break;
+            }
+        }
+        return pixels;
+    }
+
+    // Random samples, with every eighth pixel set to the tRNS colour key when there is one
+    PngSource createPngSource(ui32 width, ui32 height, ui32 colorType, ui32 bitDepth, bool isInterlaced, ui32 seed)
+    {
+        PngSource source;
+        source.width = width;
+        source.height = height;
+        source.colorType = colorType;
+        source.bitDepth = bitDepth;
+        source.isInterlaced = isInterlaced;
+
+        ParticleRandom random(seed);
+        const ui32 maxSample = (1u << bitDepth) - 1;
+        ui32 paletteSize = std::min(maxSample + 1, 200u);
+        for (size_t i = 0; i < size_t(width) * height * source.getChannels(); ++i)
+        {
+            ui32 limit = colorType == 3 ? paletteSize - 1 : maxSample;
+            source.samples.push_back(std::min(limit, static_cast<ui32>(random.range(0.0f, 1.0f) * (limit + 1))));
+        }
+
+        if (colorType == 3)
+        {
+            for (ui32 i = 0; i < paletteSize * 3; ++i)
+                source.palette.push_back(static_cast<unsigned char>(random.range(0.0f, 255.0f)));
+            // Shorter than the palette: the rest stay opaque
+            for (ui32 i = 0; i < paletteSize / 2; ++i)
+                source.transparency.push_back(static_cast<unsigned char>(random.range(0.0f, 255.0f)));
+        }
+        else if (colorType == 0 || colorType == 2)
+        {
+            const ui32 keyChannels = source.getChannels();
+            for (ui32 c = 0; c < keyChannels; ++c)
+            {
+                ui32 key = maxSample / 3 + c;
+                source.transparency.push_back(static_cast<unsigned char>(key >> 8));
+                source.transparency.push_back(static_cast<unsigned char>(key));
+            }
+            for (size_t i = 0; i < size_t(width) * height; i += 8)
+            {
+                for (ui32 c = 0; c < keyChannels; ++c)
+                    source.samples[i * keyChannels + c] = maxSample / 3 + c;
+            }
+        }
+        return source;
+    }
+
+    // Every colour type at every bit depth it allows, plain and interlaced, at a size where
+    // each Adam7 pass has pixels and at one where some passes are empty
+    void testGeneratedPngs(TestContext& context)
+    {
+        struct Format
+        {
+            ui32 colorType;
+            ui32 bitDepth;
+        };
+        const Format formats[] = {
+            { 0, 1 }, { 0, 2 }, { 0, 4 }, { 0, 8 }, { 0, 16 },
+            { 2, 8 }, { 2, 16 },
+            { 3, 1 }, { 3, 2 }, { 3, 4 }, { 3, 8 },
+            { 4, 8 }, { 4, 16 },
+            { 6, 8 }, { 6, 16 } };
+        const ui32 sizes[][2] = { { 37, 19 }, { 3, 2 } };
+
+        ui32 seed = 1;
+        for (const Format& format : formats)
+        {
+            for (const auto& size : sizes)
+            {
+                for (bool isInterlaced : { false, true })
+                {
+                    PngSource source = createPngSource(size[0], size[1], format.colorType, format.bitDepth, isInterlaced, seed++);
+                    std::vector<unsigned char> png = encodePng(source);
+
+                    DecodedImage image;
+                    std::string error;
+                    bool isDecoded = decodeImage(png.data(), png.size(), image, error);
+                    if (!DX3DCheck(context, isDecoded))
+                    {
+                        printf("    colour type %u, %u bits, %ux%u%s: %s\n", format.colorType, format.bitDepth, size[0], size[1],
+                            isInterlaced ? " interlaced" : "", error.c_str());
+                        continue;
+                    }
+                    DX3DCheck(context, image.width == size[0] && image.height == size[1]);
+                    if (!DX3DCheck(context, image.pixels == getExpectedPixels(source)))
+                    {
+                        printf("    colour type %u, %u bits, %ux%u%s decoded to the wrong pixels\n", format.colorType, format.bitDepth,
+                            size[0], size[1], isInterlaced ? " interlaced" : "");
+                    }
+                }
+            }
+        }
+    }
+
+    // ---------------------------------------------------------------------------------------
+    // Corrupt input
+
+    // Either a failure with a reason, or an image whose pixels fill its size exactly
+    bool isCleanResult(bool isDecoded, const DecodedImage& image, const std::string& error)
+    {
+        if (!isDecoded)
+            return !error.empty();
+        return image.width > 0 && image.height > 0 && image.pixels.size() == size_t(image.width) * image.height * 4;
+    }
+
+    // Truncations, bit flips, overwritten runs and repeated spans: the decoder must reject or
+    // decode each without reading or writing outside its buffers. Run the sanitizer build
+    // (DX3D_SANITIZE) to have overruns reported instead of passing silently.
+    void testCorruptImagesFailCleanly(TestContext& context)
+    {
+        std::vector<std::vector<unsigned char>> inputs = {
+            encodePng(createPngSource(33, 17, 6, 8, true, 101)),
+            encodePng(createPngSource(20, 9, 3, 4, false, 102)),
+            encodePng(createPngSource(14, 11, 0, 16, true, 103)),
+            readFile(getAssetDirectory() / "Textures" / "UI" / "ammo.png"),
+            readFile(getAssetDirectory() / "Textures" / "spaceship.jpg"),
+            readFile(getAssetDirectory() / "Textures" / "wood.jpg") };
+
+        ui32 rejectedCount = 0;
+        ParticleRandom random(2024);
+        for (const auto& input : inputs)
+        {
+            if (!DX3DCheck(context, input.size() > 64))
+                continue;
+
+            for (ui32 iteration = 0; iteration < CORRUPTION_ITERATIONS; ++iteration)
+            {
+                std::vector<unsigned char> data = input;
+                auto pick = [&](size_t limit)
+                    {
+                        return std::min(limit - 1, static_cast<size_t>(random.range(0.0f, 1.0f) * limit));
+                    };
+
+                switch (iteration % 4)
+                {
+                case 0:
+                    data.resize(pick(data.size()));
+                    break;
+                case 1:
+                    for (ui32 flip = 0; flip <= iteration % 7; ++flip)
+                        data[pick(data.size())] ^= static_cast<unsigned char>(1u << pick(8));
+                    break;
+                case 2:
+                {
+                    size_t start = pick(data.size());
+                    size_t end = std::min(data.size(), start + 1 + pick(16));
+                    for (size_t i = start; i < end; ++i)
+                        data[i] = static_cast<unsigned char>(pick(256));
+                    break;
+                }
+                default:
+                {
+                    size_t start = pick(data.size());
+                    size_t length = std::min(data.size() - start, 1 + pick(64));
+                    std::vector<unsigned char> span(data.begin() + start, data.begin() + start + length);
+                    data.insert(data.begin() + pick(data.size()), span.begin(), span.end());
+                    break;
+                }
+                }
+
+                DecodedImage image;
+                std::string error;
+                bool isDecoded = decodeImage(data.data(), data.size(), image, error);
+                rejectedCount += isDecoded ? 0 : 1;
+                DX3DCheck(context, isCleanResult(isDecoded, image, error));
+            }
+        }
+
+        // Most mutations have to be caught, or the decoder is not looking
+        DX3DCheck(context, rejectedCount > inputs.size() * CORRUPTION_ITERATIONS / 4);
+
+        // Nothing to decode, a lone signature, and a header too large to allocate for
+        const unsigned char signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+        DecodedImage image;
+        std::string error;
+        DX3DCheck(context, !decodeImage(signature, 0, image, error) && !error.empty());
+        DX3DCheck(context, !decodeImage(signature, sizeof(signature), image, error) && !error.empty());
+
+        PngSource huge = createPngSource(1, 1, 6, 8, false, 104);
+        std::vector<unsigned char> png = encodePng(huge);
+        const unsigned char hugeSize[] = { 0x00, 0x10, 0x00, 0x00 };
+        std::copy(std::begin(hugeSize), std::end(hugeSize), png.begin() + 16); // IHDR width
+        std::copy(std::begin(hugeSize), std::end(hugeSize), png.begin() + 20); // IHDR height
+        DX3DCheck(context, !decodeImage(png.data(), png.size(), image, error) && !error.empty());
+    }
+
+    // ---------------------------------------------------------------------------------------
+    // Bundled textures
+
+    // Each bundled texture decodes, with the size and alpha recorded in the golden file
+    void testBundledTexturesDecode(TestContext& context)
+    {
+        std::string text;
+        for (const auto& path : getBundledTextures())
+        {
+            DecodedImage image;
+            std::string error;
+            bool isDecoded = decodeImageFile(path.string(), image, error);
+            if (!DX3DCheck(context, isDecoded))
+            {
+                printf("    %s: %s\n", getTextureName(path).c_str(), error.c_str());
+                continue;
+            }
+            DX3DCheck(context, isCleanResult(isDecoded, image, error));
+
+            bool isOpaque = true;
+            for (size_t i = 3; i < image.pixels.size(); i += 4)
+                isOpaque = isOpaque && image.pixels[i] == 255;
+
+            char line[160];
+            snprintf(line, sizeof(line), "%s %ux%u %s\n", getTextureName(path).c_str(), image.width, image.height,
+                isOpaque ? "opaque" : "alpha");
+            text += line;
+        }
+        DX3DCheckGolden(context, "BundledTextures.txt", text);
+    }
+
+#if defined(DX3D_HAS_REFERENCE_CODECS)
+    struct PngReadState
+    {
+        const std::vector<unsigned char>* data;
+        size_t position;
+    };
+
+    void readPngData(png_structp png, png_bytep out, png_size_t length)
+    {
+        auto* state = static_cast<PngReadState*>(png_get_io_ptr(png));
+        if (length > state->data->size() - state->position)
+            png_error(png, "read past the end");
+        std::memcpy(out, state->data->data() + state->position, length);
+        state->position += length;
+    }
+
+    // libpng set up to convert as decodeImage does: palettes, low bit depths and colour keys
+    // expanded, 16-bit samples cut to their high byte, everything as RGBA
+    bool decodeWithLibpng(const std::vector<unsigned char>& data, DecodedImage& image)
+    {
+        png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+        png_infop info = png_create_info_struct(png);
+        PngReadState state = { &data, 0 };
+        std::vector<png_bytep> rows;
+        if (setjmp(png_jmpbuf(png)))
+        {
+            png_destroy_read_struct(&png, &info, nullptr);
+            return false;
+        }
+
+        png_set_read_fn(png, &state, &readPngData);
+        png_read_info(png, info);
+        png_set_expand(png);
+        png_set_strip_16(png);
+        png_set_gray_to_rgb(png);
+        png_set_add_alpha(png, 0xFF, PNG_FILLER_AFTER);
+        png_set_interlace_handling(png);
+        png_read_update_info(png, info);
+
+        image.width = png_get_image_width(png, info);
+        image.height = png_get_image_height(png, info);
+        image.pixels.resize(size_t(image.width) * image.height * 4);
+        for (ui32 y = 0; y < image.height; ++y)
+            rows.push_back(&image.pixels[size_t(y) * image.width * 4]);
+        png_read_image(png, rows.data());
+        png_read_end(png, nullptr);
+        png_destroy_read_struct(&png, &info, nullptr);
+        return true;
+    }
+
+    bool decodeWithLibjpeg(const std::vector<unsigned char>& data, DecodedImage& image)
+    {
+        jpeg_decompress_struct decompress{};
+        jpeg_error_mgr errors{};
+        decompress.err = jpeg_std_error(&errors);
+        jpeg_create_decompress(&decompress);
+        jpeg_mem_src(&decompress, data.data(), static_cast<unsigned long>(data.size()));
+        if (jpeg_read_header(&decompress, TRUE) != JPEG_HEADER_OK)
+        {
+            jpeg_destroy_decompress(&decompress);
+            return false;
+        }
+        jpeg_start_decompress(&decompress);
+
+        image.width = decompress.output_width;
+        image.height = decompress.output_height;
+        image.pixels.assign(size_t(image.width) * image.height * 4, 255);
+        const ui32 components = decompress.output_components;
+        std::vector<unsigned char> row(size_t(image.width) * components);
+        while (decompress.output_scanline < decompress.output_height)
+        {
+            unsigned char* out = &image.pixels[size_t(decompress.output_scanline) * image.width * 4];
+            JSAMPROW rows[] = { row.data() };
+            jpeg_read_scanlines(&decompress, rows, 1);
+            for (ui32 x = 0; x < image.width; ++x)
+            {
+                for (ui32 c = 0; c < 3; ++c)
+                    out[x * 4 + c] = row[x * components + (components == 1 ? 0 : c)];
+            }
+        }
+
+        jpeg_finish_decompress(&decompress);
+        jpeg_destroy_decompress(&decompress);
+        return true;
+    }
+
+    double getPsnr(const std::vector<unsigned char>& a, const std::vector<unsigned char>& b)
+    {
+        double squaredError = 0.0;
+        for (size_t i = 0; i < a.size(); ++i)
+        {
+            double difference = double(a[i]) - double(b[i]);
+            squaredError += difference * difference;
+        }
+        if (squaredError == 0.0)
+            return 1e9;
+        return 10.0 * std::log10(255.0 * 255.0 * a.size() / squaredError);
+    }
+
+    // The generated PNGs and the bundled textures against libpng and libjpeg, where CMake found them
+    void testImagesMatchReferenceCodecs(TestContext& context)
+    {
+        ui32 seed = 201;
+        for (ui32 colorType : { 0u, 2u, 3u, 4u, 6u })
+        {
+            for (ui32 bitDepth : { 1u, 2u, 4u, 8u, 16u })
+            {
+                bool isValid = colorType == 0 || (colorType == 3 ? bitDepth <= 8 : bitDepth >= 8);
+                if (!isValid)
+                    continue;
+
+                std::vector<unsigned char> png = encodePng(createPngSource(29, 13, colorType, bitDepth, seed % 2 == 0, seed));
+                ++seed;
+                DecodedImage image;
+                DecodedImage reference;
+                std::string error;
+                if (!DX3DCheck(context, decodeImage(png.data(), png.size(), image, error) && decodeWithLibpng(png, reference)) ||
+                    !DX3DCheck(context, image.pixels == reference.pixels))
+                {
+                    printf("    colour type %u, %u bits differs from libpng\n", colorType, bitDepth);
+                }
+            }
+        }
+
+        for (const auto& path : getBundledTextures())
+        {
+            std::vector<unsigned char> data = readFile(path);
+            bool isPng = path.extension() == ".png";
+
+            DecodedImage image;
+            DecodedImage reference;
+            std::string error;
+            if (!DX3DCheck(context, decodeImage(data.data(), data.size(), image, error)) ||
+                !DX3DCheck(context, isPng ? decodeWithLibpng(data, reference) : decodeWithLibjpeg(data, reference)) ||
+                !DX3DCheck(context, image.width == reference.width && image.height == reference.height))
+            {
+                printf("    %s\n", getTextureName(path).c_str());
+                continue;
+            }
+
+            double psnr = getPsnr(image.pixels, reference.pixels);
+            bool isMatch = isPng ? image.pixels == reference.pixels : psnr >= MIN_JPEG_PSNR;
+            if (!DX3DCheck(context, isMatch))
+            {
+                printf("    %s: %.1f dB against %s\n", getTextureName(path).c_str(), psnr, isPng ? "libpng" : "libjpeg");
+            }
+        }
+    }
+#endif
+
+    // Every bundled texture through decodeImageFile on one thread, the way the streamer's workers
+    // read them. The page cache cannot be dropped from here, so "first" is the first read in the
+    // process, cold unless the files were read just before; "warm" is the best of the later runs.
+    void benchmarkBundledTextureLoad(TestContext& context)
+    {
+        const auto paths = getBundledTextures();
+        ui64 fileBytes = 0;
+        ui64 pixelCount = 0;
+        double slowestMilliseconds = 0.0;
+        std::string slowestName;
+
+        double firstMilliseconds = 0.0;
+        for (const auto& path : paths)
+        {
+            DecodedImage image;
+            std::string error;
+            double milliseconds = measureMilliseconds(1, [&]()
+                {
+                    DX3DCheck(context, decodeImageFile(path.string(), image, error));
+                });
+            firstMilliseconds += milliseconds;
+            fileBytes += std::filesystem::file_size(path);
+            pixelCount += ui64(image.width) * image.height;
+            if (milliseconds > slowestMilliseconds)
+            {
+                slowestMilliseconds = milliseconds;
+                slowestName = getTextureName(path);
+            }
+        }
+
+        double warmMilliseconds = measureMilliseconds(BENCHMARK_RUNS, [&]()
+            {
+                for (const auto& path : paths)
+                {
+                    DecodedImage image;
+                    std::string error;
+                    decodeImageFile(path.string(), image, error);
+                }
+            });
+
+        char label[160];
+        snprintf(label, sizeof(label), "%zu textures, %.1f MB of files, %.1f M pixels, first load", paths.size(),
+            fileBytes / (1024.0 * 1024.0), pixelCount / 1e6);
+        context.reportTiming(label, firstMilliseconds);
+        snprintf(label, sizeof(label), "warm, %.1f M pixels/s", pixelCount / (warmMilliseconds * 1000.0));
+        context.reportTiming(label, warmMilliseconds);
+        snprintf(label, sizeof(label), "slowest first load: %s", slowestName.c_str());
+        context.reportTiming(label, slowestMilliseconds);
+    }
+
+    const TestRegistration s_generatedPngs("Images: generated PNGs of every colour type and bit depth", TestKind::Test, &testGeneratedPngs);
+    const TestRegistration s_corruptImages("Images: corrupt PNGs and JPEGs fail cleanly", TestKind::Test, &testCorruptImagesFailCleanly);
+    const TestRegistration s_bundledTextures("Images: bundled textures decode", TestKind::Test, &testBundledTexturesDecode);
+#if defined(DX3D_HAS_REFERENCE_CODECS)
+    const TestRegistration s_referenceCodecs("Images: decoded pixels match libpng and libjpeg", TestKind::Test, &testImagesMatchReferenceCodecs);
+#endif
+    const TestRegistration s_loadBenchmark("Images: first and warm load of every bundled texture", TestKind::Benchmark, &benchmarkBundledTextureLoad);
+}
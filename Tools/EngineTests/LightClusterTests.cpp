@@ -0,0 +1,129 @@
+#include "TestFramework.h"
+#include "TestFixtures.h"
+#include <DX3D/Core/JobSystem.h>
+#include <DX3D/Graphics/LightClusterGrid.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+using namespace dx3d;
+using namespace DirectX;
+
+namespace
+{
+    constexpr ui32 BENCHMARK_RUNS = 5;
+    // Light 0 is the directional light in Game's buffer, so binned lights start at 1
+    constexpr ui32 FIRST_LIGHT_INDEX = 1;
+
+    TestCamera createCamera()
+    {
+        return createTestCamera(Vector3(3.0f, 5.0f, -20.0f));
+    }
+
+    // Point lights with every third one a spot light, spread over an area around the camera
+    std::vector<BoundingSphere> createLightBounds(ui32 count, float halfWidth, ui32 seed)
+    {
+        std::mt19937 random(seed);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        std::vector<BoundingSphere> bounds;
+        bounds.reserve(count);
+        for (ui32 i = 0; i < count; ++i)
+        {
+            Vector3 position(unit(random) * halfWidth, unit(random) * 10.0f + 5.0f, unit(random) * halfWidth);
+            if (i % 3 == 0)
+            {
+                Vector3 direction = Vector3::Normalize(Vector3(unit(random), -1.0f, unit(random)));
+                bounds.push_back(LightClusterGrid::getSpotLightBounds(position, direction, 4.0f + 3.0f * unit(random), 0.5f + 0.4f * unit(random)));
+            }
+            else
+            {
+                bounds.emplace_back(position, 3.0f + 2.0f * unit(random));
+            }
+        }
+        return bounds;
+    }
+
+    // Every point inside a light must fall in a cluster that lists it, or the shader drops the light there
+    void testClustersListEveryLightTheyTouch(TestContext& context)
+    {
+        constexpr ui32 LIGHT_COUNT = 1000;
+        constexpr ui32 SAMPLE_COUNT = 20000;
+
+        const TestCamera camera = createCamera();
+        const std::vector<BoundingSphere> lights = createLightBounds(LIGHT_COUNT, 60.0f, 7);
+        LightClusterGrid grid;
+        grid.build(camera.view, camera.projection, TEST_NEAR_PLANE, TEST_FAR_PLANE, lights, FIRST_LIGHT_INDEX);
+
+        const LightClusterGridDesc& desc = grid.getDesc();
+        const XMMATRIX inverseView = XMMatrixInverse(nullptr, camera.view.toXMMatrix());
+        std::mt19937 random(11);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        ui32 checkedPoints = 0;
+        ui32 missingLights = 0;
+        for (ui32 sample = 0; sample < SAMPLE_COUNT; ++sample)
+        {
+            // A random pixel at a random depth, spread evenly over the logarithmic slices
+            float ndcX = unit(random);
+            float ndcY = unit(random);
+            float viewDepth = TEST_NEAR_PLANE * std::pow(TEST_FAR_PLANE / TEST_NEAR_PLANE, (unit(random) + 1.0f) * 0.5f);
+            Vector3 viewPosition(ndcX * viewDepth / camera.projection.m[0][0], ndcY * viewDepth / camera.projection.m[1][1], viewDepth);
+            Vector3 worldPosition(XMVector3TransformCoord(XMVectorSet(viewPosition.x, viewPosition.y, viewPosition.z, 1.0f), inverseView));
+
+            ui32 tileX = std::min(static_cast<ui32>((ndcX + 1.0f) * 0.5f * desc.tilesX), desc.tilesX - 1);
+            ui32 tileY = std::min(static_cast<ui32>((1.0f - ndcY) * 0.5f * desc.tilesY), desc.tilesY - 1);
+            const LightClusterGrid::ClusterRange& range = grid.getClusterRanges()[grid.getClusterIndex(tileX, tileY, grid.getDepthSlice(viewDepth))];
+            const ui32* first = grid.getLightIndices().data() + range.offset;
+            const ui32* last = first + range.count;
+
+            for (ui32 light = 0; light < LIGHT_COUNT; ++light)
+            {
+                // Stay clear of the sphere's surface, where float noise decides either way
+                Vector3 offset = worldPosition - lights[light].center;
+                if (Vector3::Dot(offset, offset) > lights[light].radius * lights[light].radius * 0.999f)
+                    continue;
+
+                ++checkedPoints;
+                if (std::find(first, last, light + FIRST_LIGHT_INDEX) == last)
+                    ++missingLights;
+            }
+        }
+        DX3DCheck(context, checkedPoints > 100);
+        DX3DCheck(context, missingLights == 0);
+    }
+
+    // Binning cost per frame with the jobs on the calling thread and spread over the workers
+    void benchmarkBinning(TestContext& context)
+    {
+        const TestCamera camera = createCamera();
+        JobSystem& jobs = JobSystem::getInstance();
+        const ui32 workerCount = jobs.getWorkerCount();
+
+        for (ui32 lightCount : { 1000u, 10000u })
+        {
+            const std::vector<BoundingSphere> lights = createLightBounds(lightCount, 60.0f, 7);
+            LightClusterGrid grid;
+
+            for (ui32 workers : { 0u, workerCount })
+            {
+                jobs.setWorkerCount(workers);
+                double milliseconds = measureMilliseconds(BENCHMARK_RUNS, [&]()
+                    {
+                        grid.build(camera.view, camera.projection, TEST_NEAR_PLANE, TEST_FAR_PLANE, lights, FIRST_LIGHT_INDEX);
+                    });
+
+                char label[96];
+                snprintf(label, sizeof(label), "%uk lights, %u workers (%zu cluster entries)",
+                    lightCount / 1000, workers, grid.getLightIndices().size());
+                context.reportTiming(label, milliseconds);
+                if (workerCount == 0)
+                    break;
+            }
+            DX3DCheck(context, !grid.getLightIndices().empty());
+        }
+        jobs.setWorkerCount(workerCount);
+    }
+
+    const TestRegistration s_conservative("Lights: clusters list every light they touch", TestKind::Test, &testClustersListEveryLightTheyTouch);
+    const TestRegistration s_binningBenchmark("Lights: binning 1k and 10k point and spot lights", TestKind::Benchmark, &benchmarkBinning);
+}
@@ -0,0 +1,278 @@
+#include "TestFramework.h"
+#include <DX3D/Assets/ModelImporter.h>
+#include <DX3D/Graphics/MeshLod.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+using namespace dx3d;
+
+namespace
+{
+    // Far enough inside a threshold's margin not to depend on how its product rounds
+    constexpr float MARGIN_EPSILON = 1e-3f;
+
+    // Twice the area of a face, squared, below which its winding is rounding noise
+    constexpr float MIN_FACE_AREA_SQUARED = 1e-12f;
+
+    // Cosine of the angle between a face and its corners' surface normals past which it is flipped
+    constexpr float FLIPPED_FACE_DOT = -0.5f;
+
+    struct TestMesh
+    {
+        const char* name;
+        std::vector<Vertex> vertices;
+        std::vector<ui32> indices;
+    };
+
+    // Unit UV sphere around the origin, wound counter-clockwise seen from outside, with
+    // normals pointing out
+    TestMesh createSphere(ui32 rings, ui32 segments)
+    {
+        TestMesh mesh{ "sphere" };
+        for (ui32 ring = 0; ring <= rings; ++ring)
+        {
+            float theta = 3.14159265f * ring / rings;
+            for (ui32 segment = 0; segment <= segments; ++segment)
+            {
+                float phi = 6.28318531f * segment / segments;
+                Vector3 position(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+                mesh.vertices.emplace_back(position, Vector4(1.0f, 1.0f, 1.0f, 1.0f), position,
+                    Vector2(static_cast<float>(segment) / segments, static_cast<float>(ring) / rings));
+            }
+        }
+        for (ui32 ring = 0; ring < rings; ++ring)
+        {
+            for (ui32 segment = 0; segment < segments; ++segment)
+            {
+                ui32 a = ring * (segments + 1) + segment;
+                ui32 b = a + segments + 1;
+                mesh.indices.insert(mesh.indices.end(), { a, a + 1, b, a + 1, b + 1, b });
+            }
+        }
+        return mesh;
+    }
+
+    // Gently rolling heightfield over the xz plane, facing up
+    TestMesh createTerrain(ui32 size)
+    {
+        TestMesh mesh{ "terrain" };
+        for (ui32 z = 0; z <= size; ++z)
+        {
+            for (ui32 x = 0; x <= size; ++x)
+            {
+                float height = 0.4f * std::sin(x * 0.2f) * std::cos(z * 0.15f);
+                mesh.vertices.emplace_back(Vector3(static_cast<float>(x), height, static_cast<float>(z)),
+                    Vector4(1.0f, 1.0f, 1.0f, 1.0f), Vector3(0.0f, 1.0f, 0.0f), Vector2(0.0f, 0.0f));
+            }
+        }
+        for (ui32 z = 0; z < size; ++z)
+        {
+            for (ui32 x = 0; x < size; ++x)
+            {
+                ui32 a = z * (size + 1) + x;
+                ui32 b = a + size + 1;
+                mesh.indices.insert(mesh.indices.end(), { a, b, a + 1, a + 1, b, b + 1 });
+            }
+        }
+        return mesh;
+    }
+
+    Vector3 getFaceNormal(const std::vector<Vertex>& vertices, const ui32* triangle)
+    {
+        const Vector3& a = vertices[triangle[0]].position;
+        return Vector3::Cross(vertices[triangle[1]].position - a, vertices[triangle[2]].position - a);
+    }
+
+    // Levels lie back to back in the index buffer, each smaller than the one before and indexing
+    // only existing vertices
+    bool checkLevelsShrink(TestContext& context, const char* name, const MeshLodChain& chain, ui32 vertexCount)
+    {
+        bool isValid = DX3DCheck(context, !chain.lods.empty() && chain.lods.size() <= MAX_MESH_LODS);
+        ui32 nextIndex = 0;
+        for (size_t level = 0; isValid && level < chain.lods.size(); ++level)
+        {
+            const MeshLod& lod = chain.lods[level];
+            isValid = DX3DCheck(context, lod.firstIndex == nextIndex && lod.indexCount % 3 == 0 && lod.indexCount > 0) &&
+                DX3DCheck(context, lod.firstIndex + lod.indexCount <= chain.indices.size()) &&
+                DX3DCheck(context, level == 0 || lod.indexCount < chain.lods[level - 1].indexCount);
+            for (ui32 i = 0; isValid && i < lod.indexCount; ++i)
+            {
+                isValid = DX3DCheck(context, chain.indices[lod.firstIndex + i] < vertexCount);
+            }
+            nextIndex = lod.firstIndex + lod.indexCount;
+        }
+        isValid = isValid && DX3DCheck(context, nextIndex == chain.indices.size());
+        if (!isValid)
+        {
+            printf("    %s: bad level layout\n", name);
+        }
+        return isValid;
+    }
+
+    // Area-weighted normal of LOD 0's faces around each vertex, normalised: the surface every
+    // level approximates
+    std::vector<Vector3> getSurfaceNormals(const std::vector<Vertex>& vertices, const MeshLodChain& chain)
+    {
+        std::vector<Vector3> normals(vertices.size(), Vector3(0.0f, 0.0f, 0.0f));
+        for (ui32 i = 0; i < chain.lods[0].indexCount; i += 3)
+        {
+            const ui32* triangle = &chain.indices[i];
+            Vector3 normal = getFaceNormal(vertices, triangle);
+            for (ui32 corner = 0; corner < 3; ++corner)
+                normals[triangle[corner]] += normal;
+        }
+        // By hand: Vector3::Normalize zeroes the short normals of small models like the bunny
+        for (Vector3& normal : normals)
+        {
+            float length = std::sqrt(Vector3::Dot(normal, normal));
+            if (length > 0.0f)
+                normal *= 1.0f / length;
+        }
+        return normals;
+    }
+
+    // A face of a simplified level must still face the way the surface does at its corners. A
+    // face bridging a crease or saddle can sit well off its corners' normals, so only one turned
+    // more than FLIPPED_FACE_DOT away, as a folded-over face is, counts. Faces too thin to have
+    // a direction, like the sphere's at its poles, do not count either.
+    ui32 countFlippedFaces(const std::vector<Vertex>& vertices, const std::vector<Vector3>& surfaceNormals,
+        const MeshLodChain& chain, const MeshLod& lod)
+    {
+        ui32 flipped = 0;
+        for (ui32 i = 0; i < lod.indexCount; i += 3)
+        {
+            const ui32* triangle = &chain.indices[lod.firstIndex + i];
+            Vector3 normal = getFaceNormal(vertices, triangle);
+            Vector3 cornerNormals = surfaceNormals[triangle[0]] + surfaceNormals[triangle[1]] + surfaceNormals[triangle[2]];
+            float lengths = std::sqrt(Vector3::Dot(normal, normal) * Vector3::Dot(cornerNormals, cornerNormals));
+            if (Vector3::Dot(normal, normal) > MIN_FACE_AREA_SQUARED && Vector3::Dot(normal, cornerNormals) < FLIPPED_FACE_DOT * lengths)
+                ++flipped;
+        }
+        return flipped;
+    }
+
+    void testGeneratedMeshLevels(TestContext& context)
+    {
+        for (const TestMesh& mesh : { createSphere(48, 96), createTerrain(64) })
+        {
+            MeshLodChain chain = buildMeshLodChain(mesh.vertices, mesh.indices, MeshLodSettings());
+            checkLevelsShrink(context, mesh.name, chain, static_cast<ui32>(mesh.vertices.size()));
+
+            // Both are smooth and dense, so the default settings should reach every level
+            if (!DX3DCheck(context, chain.lods.size() == MeshLodSettings().lodCount))
+            {
+                printf("    %s: %zu levels\n", mesh.name, chain.lods.size());
+            }
+
+            const std::vector<Vector3> surfaceNormals = getSurfaceNormals(mesh.vertices, chain);
+            for (size_t level = 0; level < chain.lods.size(); ++level)
+            {
+                ui32 flipped = countFlippedFaces(mesh.vertices, surfaceNormals, chain, chain.lods[level]);
+                if (!DX3DCheck(context, flipped == 0))
+                {
+                    printf("    %s LOD %zu: %u of %u faces flipped\n", mesh.name, level, flipped, chain.lods[level].indexCount / 3);
+                }
+            }
+
+            // The check itself has to see a face turned over; the largest, so it is not a sliver
+            MeshLodChain folded = chain;
+            ui32 largest = folded.lods[1].firstIndex;
+            for (ui32 i = largest; i < folded.lods[1].firstIndex + folded.lods[1].indexCount; i += 3)
+            {
+                Vector3 normal = getFaceNormal(mesh.vertices, &folded.indices[i]);
+                Vector3 largestNormal = getFaceNormal(mesh.vertices, &folded.indices[largest]);
+                if (Vector3::Dot(normal, normal) > Vector3::Dot(largestNormal, largestNormal))
+                    largest = i;
+            }
+            std::swap(folded.indices[largest], folded.indices[largest + 1]);
+            DX3DCheck(context, countFlippedFaces(mesh.vertices, surfaceNormals, folded, folded.lods[1]) == 1);
+        }
+
+        // Nothing to collapse without giving up the shape: LOD 0 only, which importOBJ reports
+        TestMesh tetrahedron{ "tetrahedron" };
+        for (const Vector3& position : { Vector3(0, 0, 0), Vector3(1, 0, 0), Vector3(0, 1, 0), Vector3(0, 0, 1) })
+        {
+            tetrahedron.vertices.emplace_back(position, Vector4(1.0f, 1.0f, 1.0f, 1.0f));
+        }
+        tetrahedron.indices = { 0, 2, 1, 0, 1, 3, 0, 3, 2, 1, 2, 3 };
+        MeshLodChain chain = buildMeshLodChain(tetrahedron.vertices, tetrahedron.indices, MeshLodSettings());
+        checkLevelsShrink(context, tetrahedron.name, chain, 4);
+        DX3DCheck(context, chain.lods.size() == 1);
+    }
+
+    // The importer's chains for bundled models
+    void testBundledMeshLevels(TestContext& context)
+    {
+        for (const char* fileName : { "suzanne.obj", "bunnynew.obj", "teapot.obj" })
+        {
+            ImportedModel model;
+            if (!DX3DCheck(context, importOBJ((getAssetDirectory() / "Models" / fileName).string(), model)))
+                continue;
+
+            for (const ImportedMesh& mesh : model.meshes)
+            {
+                if (!checkLevelsShrink(context, fileName, mesh.lodChain, static_cast<ui32>(mesh.vertices.size())))
+                    continue;
+
+                const std::vector<Vector3> surfaceNormals = getSurfaceNormals(mesh.vertices, mesh.lodChain);
+                for (size_t level = 0; level < mesh.lodChain.lods.size(); ++level)
+                {
+                    ui32 flipped = countFlippedFaces(mesh.vertices, surfaceNormals, mesh.lodChain, mesh.lodChain.lods[level]);
+                    if (!DX3DCheck(context, flipped == 0))
+                    {
+                        printf("    %s LOD %zu: %u of %u faces flipped\n", fileName, level, flipped, mesh.lodChain.lods[level].indexCount / 3);
+                    }
+                }
+            }
+        }
+    }
+
+    // Around each threshold: without a current level the size alone decides; with one, the
+    // level holds until the size is MESH_LOD_HYSTERESIS past the threshold, from either side
+    void testLodHysteresis(TestContext& context)
+    {
+        for (ui32 i = 0; i + 1 < MAX_MESH_LODS; ++i)
+        {
+            const float threshold = MESH_LOD_SCREEN_SIZES[i];
+            const float lower = threshold * (1.0f - MESH_LOD_HYSTERESIS);
+            const float upper = threshold * (1.0f + MESH_LOD_HYSTERESIS);
+
+            DX3DCheck(context, selectMeshLod(threshold * (1.0f + MARGIN_EPSILON), MAX_MESH_LODS) == i);
+            DX3DCheck(context, selectMeshLod(threshold * (1.0f - MARGIN_EPSILON), MAX_MESH_LODS) == i + 1);
+
+            // Shrinking from level i: held inside the margin, switched just past it
+            DX3DCheck(context, selectMeshLod(threshold * (1.0f - MARGIN_EPSILON), MAX_MESH_LODS, i) == i);
+            DX3DCheck(context, selectMeshLod(lower * (1.0f + MARGIN_EPSILON), MAX_MESH_LODS, i) == i);
+            DX3DCheck(context, selectMeshLod(lower * (1.0f - MARGIN_EPSILON), MAX_MESH_LODS, i) == i + 1);
+
+            // Growing from level i + 1: the same margin on the other side
+            DX3DCheck(context, selectMeshLod(threshold * (1.0f + MARGIN_EPSILON), MAX_MESH_LODS, i + 1) == i + 1);
+            DX3DCheck(context, selectMeshLod(upper * (1.0f - MARGIN_EPSILON), MAX_MESH_LODS, i + 1) == i + 1);
+            DX3DCheck(context, selectMeshLod(upper * (1.0f + MARGIN_EPSILON), MAX_MESH_LODS, i + 1) == i);
+        }
+
+        // Large jumps still land on the right level in one step, and never past the mesh's levels
+        DX3DCheck(context, selectMeshLod(0.001f, MAX_MESH_LODS, 0) == MAX_MESH_LODS - 1);
+        DX3DCheck(context, selectMeshLod(2.0f, MAX_MESH_LODS, MAX_MESH_LODS - 1) == 0);
+        DX3DCheck(context, selectMeshLod(0.001f, 2) == 1);
+        DX3DCheck(context, selectMeshLod(0.001f, 2, 1) == 1);
+        DX3DCheck(context, selectMeshLod(0.001f, 1, 0) == 0);
+
+        // An object wobbling across a threshold inside the margin keeps its level
+        ui32 lod = selectMeshLod(MESH_LOD_SCREEN_SIZES[1] * 1.05f, MAX_MESH_LODS);
+        ui32 changes = 0;
+        for (ui32 frame = 0; frame < 100; ++frame)
+        {
+            float wobble = (frame % 2 == 0 ? 0.95f : 1.05f);
+            ui32 next = selectMeshLod(MESH_LOD_SCREEN_SIZES[1] * wobble, MAX_MESH_LODS, lod);
+            changes += next != lod ? 1 : 0;
+            lod = next;
+        }
+        DX3DCheck(context, changes == 0 && lod == 1);
+    }
+
+    const TestRegistration s_generatedLevels("Mesh LOD: generated meshes shrink per level without flipped faces", TestKind::Test, &testGeneratedMeshLevels);
+    const TestRegistration s_bundledLevels("Mesh LOD: bundled models shrink per level without flipped faces", TestKind::Test, &testBundledMeshLevels);
+    const TestRegistration s_hysteresis("Mesh LOD: selection holds within the hysteresis margin", TestKind::Test, &testLodHysteresis);
+}
@@ -0,0 +1,181 @@
+#include "TestFramework.h"
+#include <DX3D/Assets/ModelImporter.h>
+#include <DX3D/Graphics/MeshOptimizer.h>
+#include <DX3D/Particles/ParticleRandom.h>
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+
+using namespace dx3d;
+
+namespace
+{
+    constexpr ui32 GRID_SIZE = 64;
+
+    // An ordering this close to the grid's best case counts as optimised
+    constexpr float MAX_OPTIMIZED_GRID_ACMR = 0.8f;
+
+    // A triangle by the vertices it draws, rotated to start at its smallest corner so the
+    // winding is kept but not where the corners start
+    using TriangleKey = std::array<float, 3 * sizeof(Vertex) / sizeof(float)>;
+
+    std::vector<TriangleKey> getTriangleSet(const std::vector<Vertex>& vertices, const ui32* indices, ui32 indexCount)
+    {
+        static_assert(sizeof(Vertex) % sizeof(float) == 0, "Vertex is compared as floats");
+        constexpr size_t VERTEX_FLOATS = sizeof(Vertex) / sizeof(float);
+
+        std::vector<TriangleKey> triangles(indexCount / 3);
+        for (ui32 t = 0; t < indexCount / 3; ++t)
+        {
+            std::array<const Vertex*, 3> corners = { &vertices[indices[t * 3]], &vertices[indices[t * 3 + 1]], &vertices[indices[t * 3 + 2]] };
+            auto isLess = [](const Vertex* a, const Vertex* b)
+                {
+                    return std::memcmp(a, b, sizeof(Vertex)) < 0;
+                };
+            std::rotate(corners.begin(), std::min_element(corners.begin(), corners.end(), isLess), corners.end());
+            for (ui32 k = 0; k < 3; ++k)
+                std::memcpy(&triangles[t][k * VERTEX_FLOATS], corners[k], sizeof(Vertex));
+        }
+        std::sort(triangles.begin(), triangles.end());
+        return triangles;
+    }
+
+    // Shuffles the triangles and the vertex order, the way an exporter that knows nothing of the
+    // cache may write them
+    void shuffleMesh(std::vector<Vertex>& vertices, std::vector<ui32>& indices, ui32 seed)
+    {
+        ParticleRandom random(seed);
+        auto pick = [&random](size_t count)
+            {
+                return std::min(count - 1, static_cast<size_t>(random.range(0.0f, 1.0f) * count));
+            };
+
+        for (size_t t = indices.size() / 3; t > 1; --t)
+        {
+            size_t other = pick(t);
+            for (ui32 k = 0; k < 3; ++k)
+                std::swap(indices[(t - 1) * 3 + k], indices[other * 3 + k]);
+        }
+
+        std::vector<ui32> order(vertices.size());
+        for (ui32 i = 0; i < order.size(); ++i)
+            order[i] = i;
+        for (size_t i = order.size(); i > 1; --i)
+            std::swap(order[i - 1], order[pick(i)]);
+
+        std::vector<Vertex> shuffled(vertices.size());
+        std::vector<ui32> newIndex(vertices.size());
+        for (ui32 i = 0; i < order.size(); ++i)
+        {
+            shuffled[i] = vertices[order[i]];
+            newIndex[order[i]] = i;
+        }
+        for (ui32& index : indices)
+            index = newIndex[index];
+        vertices = std::move(shuffled);
+    }
+
+    // The importer's order: cache, then fetch. The triangles must be the same set, the average
+    // cache miss ratio must drop, and the vertices must come out in first-use order.
+    void checkOptimizeMesh(TestContext& context, const char* name, std::vector<Vertex> vertices, std::vector<ui32> indices,
+        float maxOptimizedAcmr)
+    {
+        const auto before = getTriangleSet(vertices, indices.data(), static_cast<ui32>(indices.size()));
+        const float acmrBefore = computeAverageCacheMissRatio(indices.data(), static_cast<ui32>(indices.size()), static_cast<ui32>(vertices.size()));
+
+        optimizeVertexCache(indices.data(), static_cast<ui32>(indices.size()), static_cast<ui32>(vertices.size()));
+        optimizeVertexFetch(vertices, indices);
+        const float acmrAfter = computeAverageCacheMissRatio(indices.data(), static_cast<ui32>(indices.size()), static_cast<ui32>(vertices.size()));
+
+        DX3DCheck(context, getTriangleSet(vertices, indices.data(), static_cast<ui32>(indices.size())) == before);
+        if (!DX3DCheck(context, acmrAfter < acmrBefore && acmrAfter <= maxOptimizedAcmr))
+        {
+            printf("    %s: ACMR %.3f -> %.3f\n", name, acmrBefore, acmrAfter);
+        }
+
+        ui32 nextVertex = 0;
+        for (ui32 index : indices)
+        {
+            if (index == nextVertex)
+                ++nextVertex;
+            else if (!DX3DCheck(context, index < nextVertex))
+                break;
+        }
+        DX3DCheck(context, nextVertex == vertices.size());
+    }
+
+    void testOptimizeGrid(TestContext& context)
+    {
+        std::vector<Vertex> vertices;
+        std::vector<ui32> indices;
+        for (ui32 y = 0; y <= GRID_SIZE; ++y)
+        {
+            for (ui32 x = 0; x <= GRID_SIZE; ++x)
+            {
+                vertices.emplace_back(Vector3(static_cast<float>(x), 0.0f, static_cast<float>(y)), Vector4(1.0f, 1.0f, 1.0f, 1.0f),
+                    Vector3(0.0f, 1.0f, 0.0f), Vector2(static_cast<float>(x) / GRID_SIZE, static_cast<float>(y) / GRID_SIZE));
+            }
+        }
+        for (ui32 y = 0; y < GRID_SIZE; ++y)
+        {
+            for (ui32 x = 0; x < GRID_SIZE; ++x)
+            {
+                ui32 a = y * (GRID_SIZE + 1) + x;
+                ui32 b = a + GRID_SIZE + 1;
+                indices.insert(indices.end(), { a, b, a + 1, a + 1, b, b + 1 });
+            }
+        }
+
+        // Row order already reuses the row above once per quad; the optimiser still has to beat it
+        checkOptimizeMesh(context, "grid in row order", vertices, indices, MAX_OPTIMIZED_GRID_ACMR);
+        shuffleMesh(vertices, indices, 5);
+        checkOptimizeMesh(context, "shuffled grid", vertices, indices, MAX_OPTIMIZED_GRID_ACMR);
+    }
+
+    // Smooth bundled models as the importer leaves them, and again after shuffling that result.
+    // Flat-shaded ones like the teapot and suzanne share almost no vertices between faces, so no
+    // order can save them misses.
+    void testOptimizeBundledModels(TestContext& context)
+    {
+        for (const char* fileName : { "bunnynew.obj", "statue.obj" })
+        {
+            ImportedModel model;
+            if (!DX3DCheck(context, importOBJ((getAssetDirectory() / "Models" / fileName).string(), model)))
+                continue;
+
+            for (const ImportedMesh& mesh : model.meshes)
+            {
+                if (!DX3DCheck(context, mesh.cacheMissRatioAfter < mesh.cacheMissRatioBefore))
+                {
+                    printf("    %s import: ACMR %.3f -> %.3f\n", fileName, mesh.cacheMissRatioBefore, mesh.cacheMissRatioAfter);
+                }
+
+                std::vector<Vertex> vertices = mesh.vertices;
+                std::vector<ui32> indices(mesh.lodChain.indices.begin(), mesh.lodChain.indices.begin() + mesh.lodChain.lods[0].indexCount);
+                shuffleMesh(vertices, indices, 6);
+                checkOptimizeMesh(context, fileName, vertices, indices, mesh.cacheMissRatioAfter * 1.05f);
+            }
+        }
+    }
+
+    // The importer orders each LOD's range on its own; the ranges around it must not move
+    void testOptimizeLeavesOtherRangesAlone(TestContext& context)
+    {
+        std::vector<ui32> indices = { 0, 1, 2, 2, 1, 3, 4, 5, 6, 6, 5, 7, 5, 8, 7, 8, 9, 7, 0, 2, 4 };
+        const std::vector<ui32> original = indices;
+        optimizeVertexCache(indices.data() + 6, 12, 10);
+
+        DX3DCheck(context, std::equal(indices.begin(), indices.begin() + 6, original.begin()));
+        DX3DCheck(context, std::equal(indices.begin() + 18, indices.end(), original.begin() + 18));
+
+        std::vector<Vertex> vertices(10);
+        for (ui32 i = 0; i < 10; ++i)
+            vertices[i].position = Vector3(static_cast<float>(i), 0.0f, 0.0f);
+        DX3DCheck(context, getTriangleSet(vertices, indices.data() + 6, 12) == getTriangleSet(vertices, original.data() + 6, 12));
+    }
+
+    const TestRegistration s_grid("Mesh optimizer: grid keeps its triangles with fewer cache misses", TestKind::Test, &testOptimizeGrid);
+    const TestRegistration s_bundled("Mesh optimizer: bundled models keep their triangles with fewer cache misses", TestKind::Test, &testOptimizeBundledModels);
+    const TestRegistration s_ranges("Mesh optimizer: ordering a range leaves the rest of the buffer alone", TestKind::Test, &testOptimizeLeavesOtherRangesAlone);
+}
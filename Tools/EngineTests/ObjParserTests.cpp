@@ -0,0 +1,250 @@
+#include "TestFramework.h"
+#include <DX3D/Assets/ObjParser.h>
+#include <DX3D/Core/JobSystem.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+using namespace dx3d;
+
+namespace
+{
+    template <typename T>
+    bool isSameData(const std::vector<T>& a, const std::vector<T>& b)
+    {
+        return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0);
+    }
+
+    bool isSameIndices(const std::vector<tinyobj::index_t>& a, const std::vector<tinyobj::index_t>& b)
+    {
+        return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](const tinyobj::index_t& x, const tinyobj::index_t& y)
+            {
+                return x.vertex_index == y.vertex_index && x.normal_index == y.normal_index && x.texcoord_index == y.texcoord_index;
+            });
+    }
+
+    // The first part of everything the importer reads where parseOBJ and tinyobj disagree, bit
+    // for bit, or an empty string when they match
+    std::string findParseDifference(const tinyobj::ObjReader& reader, const ObjModel& model)
+    {
+        const auto& attrib = reader.GetAttrib();
+        if (!isSameData(attrib.vertices, model.attrib.vertices))
+            return "vertices";
+        if (!isSameData(attrib.normals, model.attrib.normals))
+            return "normals";
+        if (!isSameData(attrib.texcoords, model.attrib.texcoords))
+            return "texcoords";
+        if (!isSameData(attrib.colors, model.attrib.colors))
+            return "colors";
+
+        const auto& shapes = reader.GetShapes();
+        if (shapes.size() != model.shapes.size())
+            return "shape count";
+        for (size_t i = 0; i < shapes.size(); ++i)
+        {
+            const auto& a = shapes[i];
+            const auto& b = model.shapes[i];
+            std::string shape = "shape " + std::to_string(i) + " ";
+            if (a.name != b.name)
+                return shape + "name";
+            if (!isSameIndices(a.mesh.indices, b.mesh.indices) || !isSameData(a.mesh.num_face_vertices, b.mesh.num_face_vertices))
+                return shape + "faces";
+            if (!isSameData(a.mesh.material_ids, b.mesh.material_ids))
+                return shape + "material ids";
+            if (!isSameData(a.mesh.smoothing_group_ids, b.mesh.smoothing_group_ids))
+                return shape + "smoothing groups";
+            if (!isSameIndices(a.lines.indices, b.lines.indices) || !isSameData(a.lines.num_line_vertices, b.lines.num_line_vertices))
+                return shape + "lines";
+            if (!isSameIndices(a.points.indices, b.points.indices))
+                return shape + "points";
+        }
+
+        const auto& materials = reader.GetMaterials();
+        if (materials.size() != model.materials.size())
+            return "material count";
+        for (size_t i = 0; i < materials.size(); ++i)
+        {
+            if (materials[i].name != model.materials[i].name)
+                return "material " + std::to_string(i) + " name";
+        }
+        return {};
+    }
+
+    // Parses path with tinyobj and with parseOBJ inline and on several workers, so large files
+    // split into several chunks even on one core
+    bool checkMatchesTinyObj(TestContext& context, const std::string& path, ObjModel& model)
+    {
+        tinyobj::ObjReader reader;
+        bool isReferenceParsed = reader.ParseFromFile(path, tinyobj::ObjReaderConfig());
+
+        JobSystem& jobs = JobSystem::getInstance();
+        const ui32 workerCount = jobs.getWorkerCount();
+        bool isMatch = true;
+        for (ui32 workers : { 0u, std::max(workerCount, 3u) })
+        {
+            jobs.setWorkerCount(workers);
+            model = ObjModel();
+            bool isParsed = parseOBJ(path, model);
+            std::string difference = isParsed == isReferenceParsed ? findParseDifference(reader, model) : "result";
+            if (!DX3DCheck(context, difference.empty()))
+            {
+                printf("    %s on %u workers: %s differs from tinyobj\n",
+                    std::filesystem::path(path).filename().string().c_str(), workers, difference.c_str());
+                isMatch = false;
+            }
+        }
+        jobs.setWorkerCount(workerCount);
+        return isMatch;
+    }
+
+    std::string writeTestFile(const std::string& name, const std::string& text)
+    {
+        std::filesystem::path path = getTestTempDirectory() / name;
+        std::ofstream file(path, std::ios::binary);
+        file << text;
+        return path.string();
+    }
+
+    // Triangles of the whole model, as vertex index triples
+    std::vector<int> getTriangleVertices(const ObjModel& model)
+    {
+        std::vector<int> vertices;
+        for (const auto& shape : model.shapes)
+        {
+            for (const auto& index : shape.mesh.indices)
+                vertices.push_back(index.vertex_index);
+        }
+        return vertices;
+    }
+
+    void testBundledModelsMatchTinyObj(TestContext& context)
+    {
+        std::vector<std::filesystem::path> paths;
+        for (const auto& entry : std::filesystem::directory_iterator(getAssetDirectory() / "Models"))
+        {
+            if (entry.path().extension() == ".obj")
+                paths.push_back(entry.path());
+        }
+        std::sort(paths.begin(), paths.end());
+        DX3DCheck(context, paths.size() >= 10);
+
+        for (const auto& path : paths)
+        {
+            ObjModel model;
+            checkMatchesTinyObj(context, path.string(), model);
+            DX3DCheck(context, !model.shapes.empty());
+        }
+    }
+
+    // A cube whose lines end in CRLF, LF and lone CR, with a comment and a blank line in CRLF
+    void testLineEndings(TestContext& context)
+    {
+        std::string text =
+            "# cube\r\n\r\n"
+            "v -1 -1 -1\r\nv 1 -1 -1\nv 1 1 -1\rv -1 1 -1\r\n"
+            "v -1 -1 1\nv 1 -1 1\r\nv 1 1 1\rv -1 1 1\n"
+            "vn 0 0 -1\r\nvt 0 0\r\n"
+            "o cube\r\n"
+            "f 1//1 2//1 3//1 4//1\r\nf 5 8 7 6\nf 1 5 6 2\rf 2 6 7 3\r\nf 3 7 8 4\nf 5 1 4 8";
+
+        ObjModel model;
+        checkMatchesTinyObj(context, writeTestFile("line_endings.obj", text), model);
+        DX3DCheck(context, model.attrib.vertices.size() == 8 * 3);
+        DX3DCheck(context, model.shapes.size() == 1 && model.shapes[0].name == "cube");
+        DX3DCheck(context, getTriangleVertices(model).size() == 6 * 2 * 3);
+    }
+
+    // Triangle to octagon, convex and concave, each triangulated into size - 2 triangles
+    void testPolygons(TestContext& context)
+    {
+        std::string text =
+            "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+            "v 2 0 0\nv 3 0 0\nv 3.5 1 0\nv 2.5 2 0\nv 1.5 1 0\n"
+            "v 4 0 0\nv 6 0 0\nv 6 2 0\nv 5.5 0.5 0\nv 5 2 0\nv 4.5 0.5 0\nv 4 2 0\nv 4.2 1 0\n"
+            "g polygons\n"
+            "f 1 2 3\n"
+            "f 1 2 3 4\n"
+            "f 5 6 7 8 9\n"
+            "f 10 11 12 13 14 15 16 17\n";
+
+        ObjModel model;
+        checkMatchesTinyObj(context, writeTestFile("polygons.obj", text), model);
+        if (!DX3DCheck(context, model.shapes.size() == 1))
+            return;
+
+        const auto& mesh = model.shapes[0].mesh;
+        DX3DCheck(context, mesh.num_face_vertices.size() == 1 + 2 + 3 + 6);
+        DX3DCheck(context, std::all_of(mesh.num_face_vertices.begin(), mesh.num_face_vertices.end(), [](unsigned int count)
+            {
+                return count == 3;
+            }));
+    }
+
+    // Negative indices count back from the last attribute defined before the face, mixed with
+    // positive ones and across all three components
+    void testNegativeIndices(TestContext& context)
+    {
+        std::string text =
+            "v 0 0 0\nv 1 0 0\nv 1 1 0\nvt 0 0\nvt 1 0\nvt 1 1\nvn 0 0 1\n"
+            "f -3/-3/-1 -2/-2/-1 -1/-1/-1\n"
+            "v 0 1 0\nvt 0 1\n"
+            "f 1/1 -2/-2 -1/-1\n"
+            "f -4 2 -1\n";
+
+        ObjModel model;
+        checkMatchesTinyObj(context, writeTestFile("negative_indices.obj", text), model);
+        DX3DCheck(context, getTriangleVertices(model) == std::vector<int>({ 0, 1, 2, 0, 2, 3, 0, 1, 3 }));
+        if (DX3DCheck(context, model.shapes.size() == 1 && model.shapes[0].mesh.indices.size() == 9))
+        {
+            const auto& indices = model.shapes[0].mesh.indices;
+            DX3DCheck(context, indices[0].texcoord_index == 0 && indices[2].texcoord_index == 2 && indices[2].normal_index == 0);
+            DX3DCheck(context, indices[4].texcoord_index == 2 && indices[5].texcoord_index == 3);
+        }
+    }
+
+    // All of the above over a file large enough to split into chunks, so each case also lands on
+    // chunk boundaries: negative indices reaching into earlier chunks, and groups, materials and
+    // smoothing groups that change part way through
+    void testEdgeCasesAcrossChunks(TestContext& context)
+    {
+        std::string text = "mtllib missing.mtl\n";
+        const char* lineEndings[] = { "\n", "\r\n", "\r" };
+        for (ui32 block = 0; block < 6000; ++block)
+        {
+            const char* end = lineEndings[block % 3];
+            float x = static_cast<float>(block);
+            char line[160];
+            snprintf(line, sizeof(line), "v %g 0 0%sv %g 1 0%sv %g 1 1.5e-1%sv %g -0 1%sv %.7g 0.5 2%s",
+                x, end, x + 1.0f, end, x + 1.0f, end, x, end, x + 0.5f, end);
+            text += line;
+            if (block % 500 == 0)
+            {
+                snprintf(line, sizeof(line), "g group%u%susemtl material%u%ss %u%s", block / 500, end, block % 3, end, block % 4, end);
+                text += line;
+            }
+
+            // Pentagon by negative indices, then one of its triangles by positive ones
+            snprintf(line, sizeof(line), "f -5 -4 -3 -2 -1%sf %u %u %u%s", end, block * 5 + 1, block * 5 + 2, block * 5 + 3, end);
+            text += line;
+            if (block > 0 && block % 97 == 0)
+            {
+                // Back into the previous block, which may sit in the previous chunk
+                text += std::string("f -7 -6 -1") + end;
+            }
+        }
+
+        ObjModel model;
+        std::string path = writeTestFile("edge_cases_across_chunks.obj", text);
+        DX3DCheck(context, std::filesystem::file_size(path) > 512 * 1024);
+        checkMatchesTinyObj(context, path, model);
+        DX3DCheck(context, model.attrib.vertices.size() == 6000 * 5 * 3);
+        DX3DCheck(context, model.shapes.size() == 12);
+    }
+
+    const TestRegistration s_bundledModels("OBJ: bundled models parse like tinyobj", TestKind::Test, &testBundledModelsMatchTinyObj);
+    const TestRegistration s_lineEndings("OBJ: CRLF, LF and lone CR line endings", TestKind::Test, &testLineEndings);
+    const TestRegistration s_polygons("OBJ: n-gons triangulate like tinyobj", TestKind::Test, &testPolygons);
+    const TestRegistration s_negativeIndices("OBJ: negative indices", TestKind::Test, &testNegativeIndices);
+    const TestRegistration s_acrossChunks("OBJ: edge cases across chunk boundaries", TestKind::Test, &testEdgeCasesAcrossChunks);
+}
@@ -0,0 +1,439 @@
+#include "TestFramework.h"
+#include <DX3D/Core/JobSystem.h>
+#include <DX3D/Particles/ParticleEmitter.h>
+#include <DX3D/Particles/ParticleInstanceLayout.h>
+#include <DX3D/Particles/ParticleEffects/SnowParticle.h>
+#include <DX3D/Particles/ParticleKernels.h>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+using namespace dx3d;
+
+namespace
+{
+    constexpr ui32 BENCHMARK_RUNS = 5;
+    constexpr float FRAME_DELTA = 1.0f / 60.0f;
+    constexpr double FRAME_BUDGET_MILLISECONDS = 1000.0 / 60.0;
+
+    // The kernels promise bit-identical results across levels
+    constexpr ui32 MAX_KERNEL_ULP_DIFFERENCE = 0;
+
+    const ParticleSimdLevel SIMD_LEVELS[] = { ParticleSimdLevel::Scalar, ParticleSimdLevel::SSE2, ParticleSimdLevel::AVX2 };
+
+    const char* getSimdLevelName(ParticleSimdLevel level)
+    {
+        switch (level)
+        {
+        case ParticleSimdLevel::SSE2: return "SSE2";
+        case ParticleSimdLevel::AVX2: return "AVX2";
+        default: return "scalar";
+        }
+    }
+
+    // Distance between two floats in units in the last place
+    ui32 getUlpDifference(float a, float b)
+    {
+        i32 aBits;
+        i32 bBits;
+        std::memcpy(&aBits, &a, sizeof(aBits));
+        std::memcpy(&bBits, &b, sizeof(bBits));
+
+        // Map the sign-magnitude encoding onto a monotonic integer line
+        if (aBits < 0)
+            aBits = static_cast<i32>(0x80000000u - static_cast<ui32>(aBits));
+        if (bBits < 0)
+            bBits = static_cast<i32>(0x80000000u - static_cast<ui32>(bBits));
+        return static_cast<ui32>(std::abs(static_cast<long long>(aBits) - bBits));
+    }
+
+    // Every channel of every live particle, in a fixed order
+    std::vector<const std::vector<float>*> getPoolChannels(const ParticlePool& pool)
+    {
+        std::vector<const std::vector<float>*> channels = {
+            &pool.positionX, &pool.positionY, &pool.positionZ,
+            &pool.velocityX, &pool.velocityY, &pool.velocityZ,
+            &pool.colorR, &pool.colorG, &pool.colorB, &pool.colorA,
+            &pool.size, &pool.rotation, &pool.rotationSpeed, &pool.age, &pool.lifetime };
+        for (const auto& channel : pool.effectData)
+        {
+            channels.push_back(&channel);
+        }
+        return channels;
+    }
+
+    // Snow-like particles part way through their lives, with phases large enough to exercise the sin range reduction
+    void fillKernelTestPool(ParticlePool& pool, ui32 count)
+    {
+        pool.allocate(count);
+        pool.emplace(count);
+
+        ParticleRandom random(7);
+        for (ui32 i = 0; i < count; ++i)
+        {
+            pool.positionX[i] = random.range(-20.0f, 20.0f);
+            pool.positionY[i] = random.range(0.0f, 10.0f);
+            pool.positionZ[i] = random.range(-20.0f, 20.0f);
+            pool.velocityX[i] = random.range(-0.5f, 0.5f);
+            pool.velocityY[i] = random.range(-2.5f, -0.5f);
+            pool.velocityZ[i] = random.range(-0.5f, 0.5f);
+            pool.rotation[i] = random.range(0.0f, 6.2f);
+            pool.rotationSpeed[i] = random.range(-1.0f, 1.0f);
+            pool.lifetime[i] = random.range(6.0f, 10.0f);
+            pool.age[i] = random.range(0.0f, pool.lifetime[i]);
+            pool.effectData[SnowParticleEffect::SwayAmount][i] = random.range(0.3f, 0.7f);
+            pool.effectData[SnowParticleEffect::SwaySpeed][i] = random.range(1.5f, 3.5f);
+            pool.effectData[SnowParticleEffect::SwayPhase][i] = random.range(-100.0f, 100.0f);
+            pool.effectData[SnowParticleEffect::FallSpeedMultiplier][i] = random.range(0.5f, 1.0f);
+        }
+    }
+
+    void runKernels(const ParticleKernelTable& kernels, ParticlePool& pool, ui32 begin, ui32 end, ui32 steps)
+    {
+        const Vector3 acceleration(0.0f, -0.5f, 0.0f);
+        for (ui32 step = 0; step < steps; ++step)
+        {
+            kernels.integrateBallistic(pool, begin, end, acceleration, FRAME_DELTA);
+            kernels.integrateSnow(pool, begin, end, acceleration, FRAME_DELTA);
+            kernels.applyLifetimeGradients(pool, begin, end,
+                Vector4(1.0f, 1.0f, 1.0f, 0.8f), Vector4(0.9f, 0.9f, 1.0f, 0.0f), 0.2f, 0.1f);
+        }
+    }
+
+    // Runs every level over the same pool and compares each channel with the scalar result.
+    // The range starts and ends off the SIMD width, so the scalar tails are covered too.
+    void testKernelLevelsAgree(TestContext& context)
+    {
+        constexpr ui32 PARTICLE_COUNT = 1037;
+        constexpr ui32 BEGIN = 3;
+        constexpr ui32 STEPS = 120;
+
+        ParticlePool reference;
+        fillKernelTestPool(reference, PARTICLE_COUNT);
+        const ParticlePool initial = reference;
+        runKernels(getParticleKernels(ParticleSimdLevel::Scalar), reference, BEGIN, PARTICLE_COUNT, STEPS);
+        const auto referenceChannels = getPoolChannels(reference);
+
+        for (ParticleSimdLevel level : { ParticleSimdLevel::SSE2, ParticleSimdLevel::AVX2 })
+        {
+            const ParticleKernelTable& kernels = getParticleKernels(level);
+            if (kernels.level != level)
+            {
+                printf("    %s not supported by this CPU, skipped\n", getSimdLevelName(level));
+                continue;
+            }
+
+            ParticlePool pool = initial;
+            runKernels(kernels, pool, BEGIN, PARTICLE_COUNT, STEPS);
+
+            ui32 maxDifference = 0;
+            const auto channels = getPoolChannels(pool);
+            for (size_t channel = 0; channel < channels.size(); ++channel)
+            {
+                for (ui32 i = 0; i < PARTICLE_COUNT; ++i)
+                {
+                    maxDifference = std::max(maxDifference, getUlpDifference((*channels[channel])[i], (*referenceChannels[channel])[i]));
+                }
+            }
+            printf("    %s: at most %u ULP from scalar\n", getSimdLevelName(level), maxDifference);
+            DX3DCheck(context, maxDifference <= MAX_KERNEL_ULP_DIFFERENCE);
+        }
+
+        // Particles before the range are left alone
+        for (ui32 i = 0; i < BEGIN; ++i)
+        {
+            DX3DCheck(context, reference.positionY[i] == initial.positionY[i]);
+        }
+    }
+
+    // Particles per second through each kernel on one thread, per level
+    void benchmarkKernelThroughput(TestContext& context)
+    {
+        constexpr ui32 PARTICLE_COUNT = 1000000;
+
+        ParticlePool initial;
+        fillKernelTestPool(initial, PARTICLE_COUNT);
+        const Vector3 acceleration(0.0f, -0.5f, 0.0f);
+
+        for (ParticleSimdLevel level : SIMD_LEVELS)
+        {
+            const ParticleKernelTable& kernels = getParticleKernels(level);
+            if (kernels.level != level)
+                continue;
+
+            ParticlePool pool = initial;
+            struct Kernel
+            {
+                const char* name;
+                double milliseconds;
+            };
+            const Kernel results[] = {
+                { "integrateBallistic", measureMilliseconds(BENCHMARK_RUNS, [&]()
+                    {
+                        kernels.integrateBallistic(pool, 0, PARTICLE_COUNT, acceleration, FRAME_DELTA);
+                    }) },
+                { "integrateSnow", measureMilliseconds(BENCHMARK_RUNS, [&]()
+                    {
+                        kernels.integrateSnow(pool, 0, PARTICLE_COUNT, acceleration, FRAME_DELTA);
+                    }) },
+                { "applyLifetimeGradients", measureMilliseconds(BENCHMARK_RUNS, [&]()
+                    {
+                        kernels.applyLifetimeGradients(pool, 0, PARTICLE_COUNT,
+                            Vector4(1.0f, 1.0f, 1.0f, 0.8f), Vector4(0.9f, 0.9f, 1.0f, 0.0f), 0.2f, 0.1f);
+                    }) } };
+
+            for (const auto& result : results)
+            {
+                char label[96];
+                snprintf(label, sizeof(label), "%-6s %-22s %7.1f M particles/s", getSimdLevelName(level), result.name,
+                    PARTICLE_COUNT / (result.milliseconds * 1000.0));
+                context.reportTiming(label, result.milliseconds);
+            }
+        }
+    }
+
+    // Game's default SnowConfig with a larger pool
+    ParticleEmitter::EmitterConfig createSnowConfig(ui32 maxParticles)
+    {
+        ParticleEmitter::EmitterConfig config;
+        config.position = Vector3(0.0f, 10.0f, 0.0f);
+        config.positionVariance = Vector3(20.0f, 0.0f, 20.0f);
+        config.velocity = Vector3(0.0f, -2.0f, 0.0f);
+        config.velocityVariance = Vector3(0.5f, 0.5f, 0.5f);
+        config.acceleration = Vector3(0.0f, -0.5f, 0.0f);
+        config.startColor = Vector4(1.0f, 1.0f, 1.0f, 0.8f);
+        config.endColor = Vector4(0.9f, 0.9f, 1.0f, 0.0f);
+        config.startSize = 0.2f;
+        config.endSize = 0.1f;
+        config.lifetime = 8.0f;
+        config.lifetimeVariance = 2.0f;
+        config.emissionRate = 50.0f;
+        config.maxParticles = maxParticles;
+        return config;
+    }
+
+    // Live particles of every channel of a set of emitters, as raw bytes
+    std::vector<unsigned char> capturePools(const std::vector<ParticleEmitter>& emitters)
+    {
+        std::vector<unsigned char> bytes;
+        for (const ParticleEmitter& emitter : emitters)
+        {
+            const ParticlePool& pool = emitter.getPool();
+            const auto* count = reinterpret_cast<const unsigned char*>(&pool.aliveCount);
+            bytes.insert(bytes.end(), count, count + sizeof(pool.aliveCount));
+            for (const std::vector<float>* channel : getPoolChannels(pool))
+            {
+                const auto* data = reinterpret_cast<const unsigned char*>(channel->data());
+                bytes.insert(bytes.end(), data, data + pool.aliveCount * sizeof(float));
+            }
+        }
+        return bytes;
+    }
+
+    // Seeded snow and ballistic emitters, two of them spanning several chunks, through bursts,
+    // continuous emission, expiry and a reset. Returns the pools after the first run and after
+    // the run following the reset.
+    std::vector<unsigned char> runEmitterSet(ui32 workers, std::vector<unsigned char>& afterReset)
+    {
+        JobSystem::getInstance().setWorkerCount(workers);
+
+        ParticleEmitter::EmitterConfig ballistic = createSnowConfig(2 * ParticleEmitter::CHUNK_SIZE + 517);
+        ballistic.acceleration = Vector3(0.0f, -9.81f, 0.0f);
+        ballistic.velocity = Vector3(0.0f, 5.0f, 0.0f);
+        ballistic.lifetime = 0.8f;
+        ballistic.lifetimeVariance = 0.5f;
+        ballistic.emissionRate = 20000.0f;
+
+        std::vector<ParticleEmitter> emitters;
+        emitters.emplace_back(createSnowConfig(3 * ParticleEmitter::CHUNK_SIZE + 123), createSnowParticleEffect(), 11);
+        emitters.emplace_back(ballistic, nullptr, 12);
+        emitters.emplace_back(createSnowConfig(500), createSnowParticleEffect(), 13);
+
+        auto run = [&]()
+            {
+                for (ParticleEmitter& emitter : emitters)
+                {
+                    emitter.emitBurst(2 * ParticleEmitter::CHUNK_SIZE + 99);
+                }
+                for (ui32 frame = 0; frame < 90; ++frame)
+                {
+                    for (ParticleEmitter& emitter : emitters)
+                    {
+                        emitter.update(FRAME_DELTA);
+                    }
+                }
+            };
+
+        run();
+        std::vector<unsigned char> bytes = capturePools(emitters);
+        for (ParticleEmitter& emitter : emitters)
+        {
+            emitter.reset();
+        }
+        run();
+        afterReset = capturePools(emitters);
+        return bytes;
+    }
+
+    // Chunks are seeded and split by index, never by thread, so the pools must match byte for
+    // byte whether the chunks ran inline, on one worker or spread over several
+    void testEmittersMatchAcrossWorkerCounts(TestContext& context)
+    {
+        JobSystem& jobs = JobSystem::getInstance();
+        const ui32 workerCount = jobs.getWorkerCount();
+
+        std::vector<unsigned char> referenceAfterReset;
+        const std::vector<unsigned char> reference = runEmitterSet(0, referenceAfterReset);
+        DX3DCheck(context, reference.size() > 3 * ParticleEmitter::CHUNK_SIZE * sizeof(float));
+
+        for (ui32 workers : { 1u, std::max(workerCount, 3u) })
+        {
+            std::vector<unsigned char> afterReset;
+            const std::vector<unsigned char> bytes = runEmitterSet(workers, afterReset);
+            DX3DCheck(context, bytes == reference);
+            DX3DCheck(context, afterReset == referenceAfterReset);
+        }
+
+        // A reset restarts the spawn batches, so the run after it repeats the first one
+        DX3DCheck(context, referenceAfterReset == reference);
+        jobs.setWorkerCount(workerCount);
+    }
+
+    // Whether every instance of the emitter's slice holds its particle, in pool order
+    bool instancesMatchPool(const ParticleInstanceData* instances, ui32 count, const ParticlePool& pool)
+    {
+        for (ui32 i = 0; i < count; ++i)
+        {
+            const ParticleInstanceData& instance = instances[i];
+            Vector3 position = pool.getPosition(i);
+            Vector4 color = pool.getColor(i);
+            if (instance.position.x != position.x || instance.position.y != position.y || instance.position.z != position.z ||
+                instance.color.x != color.x || instance.color.y != color.y || instance.color.z != color.z || instance.color.w != color.w ||
+                instance.size != pool.size[i] || instance.rotation != pool.rotation[i])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Lays out emitters of known counts, one of them empty and one spanning several chunks, and
+    // writes them into a plain array: each lands at the sum of the counts before it, and a short
+    // destination cuts the last ones off instead of overrunning
+    void testInstanceLayoutWritesAtPrefixSums(TestContext& context)
+    {
+        JobSystem& jobs = JobSystem::getInstance();
+        const ui32 workerCount = jobs.getWorkerCount();
+        jobs.setWorkerCount(std::max(workerCount, 3u));
+
+        const ui32 bursts[] = { 100, 0, 2 * ParticleEmitter::CHUNK_SIZE + 7, 33 };
+        std::vector<ParticleEmitter> emitters;
+        for (ui32 i = 0; i < 4; ++i)
+        {
+            emitters.emplace_back(createSnowConfig(3 * ParticleEmitter::CHUNK_SIZE), createSnowParticleEffect(), 21 + i);
+            emitters.back().emitBurst(bursts[i]);
+            emitters.back().update(FRAME_DELTA);
+        }
+
+        ParticleInstanceLayout layout;
+        for (const ParticleEmitter& emitter : emitters)
+        {
+            layout.add(emitter);
+        }
+
+        ui32 offset = 0;
+        DX3DCheck(context, layout.getEmitterCount() == 4);
+        for (ui32 i = 0; i < 4; ++i)
+        {
+            DX3DCheck(context, layout.getOffset(i) == offset);
+            offset += emitters[i].getActiveParticleCount();
+        }
+        DX3DCheck(context, layout.getOffset(4) == offset);
+        DX3DCheck(context, layout.getInstanceCount() == offset);
+        DX3DCheck(context, offset > 2 * ParticleEmitter::CHUNK_SIZE);
+
+        // One spare instance past the end, which must be left alone
+        ParticleInstanceData sentinel{};
+        sentinel.size = -1.0f;
+        std::vector<ParticleInstanceData> instances(offset + 1, sentinel);
+        DX3DCheck(context, layout.write(instances) == offset);
+        for (ui32 i = 0; i < 4; ++i)
+        {
+            DX3DCheck(context, instancesMatchPool(instances.data() + layout.getOffset(i),
+                emitters[i].getActiveParticleCount(), emitters[i].getPool()));
+        }
+        DX3DCheck(context, instances[offset].size == -1.0f);
+
+        // Cut inside the third emitter: the first two are whole, the third is partial, the last gets nothing
+        const ui32 shortCount = layout.getOffset(2) + 5;
+        std::vector<ParticleInstanceData> shortInstances(shortCount + 1, sentinel);
+        DX3DCheck(context, layout.write(std::span<ParticleInstanceData>(shortInstances.data(), shortCount)) == shortCount);
+        DX3DCheck(context, instancesMatchPool(shortInstances.data(), emitters[0].getActiveParticleCount(), emitters[0].getPool()));
+        DX3DCheck(context, instancesMatchPool(shortInstances.data() + layout.getOffset(2), 5, emitters[2].getPool()));
+        DX3DCheck(context, shortInstances[shortCount].size == -1.0f);
+
+        layout.clear();
+        DX3DCheck(context, layout.getEmitterCount() == 0 && layout.getInstanceCount() == 0);
+        jobs.setWorkerCount(workerCount);
+    }
+
+    // One frame of a full pool of a million snow particles, with the job system reduced to the calling thread
+    void benchmarkSnowUpdate(TestContext& context)
+    {
+        constexpr ui32 PARTICLE_COUNT = 1000000;
+
+        JobSystem& jobs = JobSystem::getInstance();
+        const ui32 workerCount = jobs.getWorkerCount();
+        jobs.setWorkerCount(0);
+
+        ParticleEmitter emitter(createSnowConfig(PARTICLE_COUNT), createSnowParticleEffect(), 1);
+        DX3DCheck(context, emitter.emitBurst(PARTICLE_COUNT) == PARTICLE_COUNT);
+
+        // Lifetimes are at least 6 s, so every particle is still alive after these frames
+        double milliseconds = measureMilliseconds(BENCHMARK_RUNS, [&]()
+            {
+                emitter.update(FRAME_DELTA);
+            });
+        DX3DCheck(context, emitter.getActiveParticleCount() == PARTICLE_COUNT);
+
+        jobs.setWorkerCount(workerCount);
+        context.reportTiming("1M snow particles, one frame on one core", milliseconds, FRAME_BUDGET_MILLISECONDS);
+    }
+
+    // Cost of spawning a fixed burst into pools of growing capacity, each already full up to the burst.
+    // Spawning takes the slots after aliveCount, so the cost should not grow with the pool.
+    void benchmarkSpawnCost(TestContext& context)
+    {
+        constexpr ui32 BURST_SIZE = 1000;
+
+        for (ui32 maxParticles : { 1000u, 10000u, 100000u, 1000000u })
+        {
+            ParticleEmitter emitter(createSnowConfig(maxParticles), createSnowParticleEffect(), 1);
+            ui32 prefill = maxParticles - BURST_SIZE;
+
+            double milliseconds = 1e30;
+            for (ui32 run = 0; run < BENCHMARK_RUNS; ++run)
+            {
+                emitter.reset();
+                emitter.emitBurst(prefill);
+                milliseconds = std::min(milliseconds, measureMilliseconds(1, [&]()
+                    {
+                        DX3DCheck(context, emitter.emitBurst(BURST_SIZE) == BURST_SIZE);
+                    }));
+            }
+            DX3DCheck(context, emitter.getActiveParticleCount() == maxParticles);
+
+            char label[96];
+            snprintf(label, sizeof(label), "burst of %u into %7u max particles, %5.1f ns each",
+                BURST_SIZE, maxParticles, milliseconds * 1e6 / BURST_SIZE);
+            context.reportTiming(label, milliseconds);
+        }
+    }
+
+    const TestRegistration s_kernelLevels("Particles: kernel levels match the scalar kernels", TestKind::Test, &testKernelLevelsAgree);
+    const TestRegistration s_instanceLayout("Particles: instance layout writes each emitter at its prefix sum", TestKind::Test, &testInstanceLayoutWritesAtPrefixSums);
+    const TestRegistration s_workerCounts("Particles: emitters match at 0, 1 and N workers", TestKind::Test, &testEmittersMatchAcrossWorkerCounts);
+    const TestRegistration s_kernelBenchmark("Particles: kernel throughput per SIMD level", TestKind::Benchmark, &benchmarkKernelThroughput);
+    const TestRegistration s_spawnBenchmark("Particles: spawn cost from 1k to 1M max particles", TestKind::Benchmark, &benchmarkSpawnCost);
+    const TestRegistration s_snowUpdateBenchmark("Particles: 1M snow particles in a 60 Hz frame on one core", TestKind::Benchmark, &benchmarkSnowUpdate);
+}
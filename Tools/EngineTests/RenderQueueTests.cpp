@@ -0,0 +1,279 @@
+#include "TestFramework.h"
+#include "FakeRenderResources.h"
+#include <DX3D/Graphics/Material.h>
+#include <DX3D/Graphics/RecordingRenderBackend.h>
+#include <DX3D/Graphics/RenderQueue.h>
+#include <algorithm>
+#include <cstdio>
+#include <random>
+
+using namespace dx3d;
+
+namespace
+{
+    constexpr ui32 BENCHMARK_RUNS = 5;
+
+    // Packets over 64 meshes and 256 materials at random depths, the way a scene view fills the queue
+    void fillQueue(RenderQueue& queue, ui32 count, std::mt19937& random)
+    {
+        queue.clear();
+        queue.reserve(count);
+        for (ui32 i = 0; i < count; ++i)
+        {
+            ui32 mesh = random() % 64;
+            ui32 material = random() % 256;
+
+            DrawPacket packet;
+            packet.objectIndex = i;
+            packet.vertexBuffer = getFakeResource<VertexBuffer>(mesh);
+            packet.indexBuffer = getFakeResource<IndexBuffer>(mesh);
+            packet.indexCount = 36;
+            packet.texture = getFakeResource<Texture2D>(material % 16);
+            packet.sortKey = RenderQueue::makeSortKey(RenderPass::Opaque, RenderShader::Model,
+                mesh, material, static_cast<float>(random() % 100000) / 100000.0f);
+            queue.push(packet);
+        }
+    }
+
+    // Small queues and large ones take different paths through sort(); both must be stable
+    void testSortMatchesStableSort(TestContext& context)
+    {
+        std::mt19937 random(3);
+        for (ui32 count : { 0u, 1u, 10u, 300u, 10007u })
+        {
+            RenderQueue queue;
+            fillQueue(queue, count, random);
+            std::vector<DrawPacket> expected = queue.getPackets();
+            std::stable_sort(expected.begin(), expected.end(),
+                [](const DrawPacket& a, const DrawPacket& b) { return a.sortKey < b.sortKey; });
+
+            queue.sort();
+            bool sameOrder = queue.size() == count;
+            for (ui32 i = 0; sameOrder && i < count; ++i)
+            {
+                sameOrder = queue.getPackets()[i].sortKey == expected[i].sortKey &&
+                    queue.getPackets()[i].objectIndex == expected[i].objectIndex;
+            }
+            DX3DCheck(context, sameOrder);
+        }
+    }
+
+    void testSortKeyLayout(TestContext& context)
+    {
+        // Pass dominates shader, which dominates mesh, then material, then depth
+        ui64 shadow = RenderQueue::makeSortKey(RenderPass::Shadow, RenderShader::Model, 65535, 65535, 1.0f);
+        ui64 opaque = RenderQueue::makeSortKey(RenderPass::Opaque, RenderShader::Depth, 0, 0, 0.0f);
+        DX3DCheck(context, shadow < opaque);
+        DX3DCheck(context, RenderQueue::makeSortKey(RenderPass::Opaque, RenderShader::Model, 1, 0, 0.0f) >
+            RenderQueue::makeSortKey(RenderPass::Opaque, RenderShader::Model, 0, 65535, 1.0f));
+        DX3DCheck(context, RenderQueue::makeSortKey(RenderPass::Opaque, RenderShader::Model, 1, 2, 0.0f) >
+            RenderQueue::makeSortKey(RenderPass::Opaque, RenderShader::Model, 1, 1, 1.0f));
+
+        // Nearer first, and depths outside [0, 1] clamp rather than spill into the material bits
+        DX3DCheck(context, RenderQueue::makeSortKey(RenderPass::Opaque, RenderShader::Model, 1, 1, 0.25f) <
+            RenderQueue::makeSortKey(RenderPass::Opaque, RenderShader::Model, 1, 1, 0.5f));
+        DX3DCheck(context, RenderQueue::makeSortKey(RenderPass::Opaque, RenderShader::Model, 1, 1, 2.0f) <
+            RenderQueue::makeSortKey(RenderPass::Opaque, RenderShader::Model, 1, 2, 0.0f));
+        DX3DCheck(context, RenderQueue::makeSortKey(RenderPass::Opaque, RenderShader::Model, 1, 1, -1.0f) ==
+            RenderQueue::makeSortKey(RenderPass::Opaque, RenderShader::Model, 1, 1, 0.0f));
+    }
+
+    DrawPacket makeModelPacket(ui32 mesh, ui32 texture, const Material& material, ui32 objectIndex, ui32 firstIndex = 0)
+    {
+        DrawPacket packet;
+        packet.shader = RenderShader::Model;
+        packet.vertexBuffer = getFakeResource<VertexBuffer>(mesh);
+        packet.indexBuffer = getFakeResource<IndexBuffer>(mesh);
+        packet.firstIndex = firstIndex;
+        packet.indexCount = 36;
+        packet.material = &material;
+        packet.texture = getFakeResource<Texture2D>(texture);
+        packet.objectIndex = objectIndex;
+        packet.sortKey = RenderQueue::makeSortKey(RenderPass::Opaque, RenderShader::Model, mesh, material.getSortId(), 0.5f);
+        return packet;
+    }
+
+    // Object i sits at x = i, so an instance's world matrix tells which object it drew
+    std::vector<Matrix4x4> createWorldMatrices(ui32 count)
+    {
+        std::vector<Matrix4x4> worldMatrices;
+        for (ui32 i = 0; i < count; ++i)
+        {
+            worldMatrices.push_back(Matrix4x4::CreateTranslation(Vector3(static_cast<float>(i), 0.0f, 0.0f)));
+        }
+        return worldMatrices;
+    }
+
+    RenderStats submitQueue(RenderQueue& queue, const std::vector<Matrix4x4>& worldMatrices, RecordingRenderBackend& backend)
+    {
+        queue.sort();
+        queue.buildBatches();
+        return queue.submit(backend, worldMatrices, Matrix4x4(), Matrix4x4());
+    }
+
+    void testTextureSplitsBatch(TestContext& context)
+    {
+        Material material;
+        RenderQueue queue;
+        queue.push(makeModelPacket(1, 1, material, 0));
+        queue.push(makeModelPacket(1, 2, material, 1));
+        queue.push(makeModelPacket(1, 1, material, 2));
+        DX3DCheck(context, !RenderQueue::canShareBatch(queue.getPackets()[0], queue.getPackets()[1]));
+        DX3DCheck(context, RenderQueue::canShareBatch(queue.getPackets()[0], queue.getPackets()[2]));
+
+        // Equal keys keep their order, so the second texture sits between the two halves of the first
+        RecordingRenderBackend backend;
+        RenderStats stats = submitQueue(queue, createWorldMatrices(3), backend);
+        DX3DCheck(context, stats.drawCalls == 3);
+        DX3DCheck(context, stats.meshChanges == 1);
+        DX3DCheck(context, stats.materialChanges == 3);
+        DX3DCheck(context, backend.toString() ==
+            "SetViewConstants\n"
+            "SetShader Model\n"
+            "SetGeometry mesh0\n"
+            "SetTexture texture0\n"
+            "DrawIndexedInstanced indices=36 instances=1 first=0\n"
+            "SetTexture texture1\n"
+            "DrawIndexedInstanced indices=36 instances=1 first=1\n"
+            "SetTexture texture0\n"
+            "DrawIndexedInstanced indices=36 instances=1 first=2\n");
+    }
+
+    void testMaterialConstantsShareBatch(TestContext& context)
+    {
+        // Materials that only differ in constants travel per instance, so they still share one draw
+        Material red;
+        Material blue;
+        red.setDiffuseColor(Vector4(1.0f, 0.0f, 0.0f, 1.0f));
+        blue.setDiffuseColor(Vector4(0.0f, 0.0f, 1.0f, 1.0f));
+
+        RenderQueue queue;
+        queue.push(makeModelPacket(1, 1, red, 0));
+        queue.push(makeModelPacket(1, 1, blue, 1));
+
+        RecordingRenderBackend backend;
+        RenderStats stats = submitQueue(queue, createWorldMatrices(2), backend);
+        DX3DCheck(context, stats.drawCalls == 1);
+        DX3DCheck(context, stats.instances == 2);
+        DX3DCheck(context, backend.getInstances().size() == 2);
+        for (ui32 i = 0; i < 2; ++i)
+        {
+            const Material* material = queue.getPackets()[i].material;
+            DX3DCheck(context, backend.getInstances()[i].material.diffuseColor.x == material->getDiffuseColor().x);
+            DX3DCheck(context, backend.getInstances()[i].material.diffuseColor.z == material->getDiffuseColor().z);
+        }
+    }
+
+    void testFirstIndexSplitsBatch(TestContext& context)
+    {
+        // Two LODs of one mesh share its buffers but start at different indices
+        Material material;
+        RenderQueue queue;
+        queue.push(makeModelPacket(1, 1, material, 0, 0));
+        queue.push(makeModelPacket(1, 1, material, 1, 36));
+        DX3DCheck(context, !RenderQueue::canShareBatch(queue.getPackets()[0], queue.getPackets()[1]));
+
+        RecordingRenderBackend backend;
+        RenderStats stats = submitQueue(queue, createWorldMatrices(2), backend);
+        DX3DCheck(context, stats.drawCalls == 2);
+        DX3DCheck(context, stats.meshChanges == 1);
+        DX3DCheck(context, stats.materialChanges == 1);
+        DX3DCheck(context, backend.toString() ==
+            "SetViewConstants\n"
+            "SetShader Model\n"
+            "SetGeometry mesh0\n"
+            "SetTexture texture0\n"
+            "DrawIndexedInstanced indices=36 instances=1 first=0\n"
+            "DrawIndexedInstanced indices=36 instances=1 first=1 firstIndex=36\n");
+    }
+
+    // Instance i of a batch must be packet firstPacket + i, in sorted order, with that packet's object and material
+    void testInstanceOrder(TestContext& context)
+    {
+        constexpr ui32 OBJECT_COUNT = 300;
+
+        std::vector<Material> materials(4);
+        for (ui32 i = 0; i < materials.size(); ++i)
+        {
+            materials[i].setDiffuseColor(Vector4(static_cast<float>(i), 0.0f, 0.0f, 1.0f));
+        }
+
+        // Objects pushed in a scrambled order over three meshes, two textures and four materials
+        RenderQueue queue;
+        for (ui32 i = 0; i < OBJECT_COUNT; ++i)
+        {
+            ui32 object = (i * 97) % OBJECT_COUNT;
+            queue.push(makeModelPacket(object % 3, object % 2, materials[object % 4], object));
+        }
+
+        RecordingRenderBackend backend;
+        std::vector<Matrix4x4> worldMatrices = createWorldMatrices(OBJECT_COUNT);
+        RenderStats stats = submitQueue(queue, worldMatrices, backend);
+        DX3DCheck(context, stats.instances == OBJECT_COUNT);
+        // The key orders by mesh then material, and here the texture follows the material, so every
+        // (mesh, material) run is one draw
+        DX3DCheck(context, stats.drawCalls == 3 * 4);
+
+        const auto& instances = backend.getInstances();
+        bool instancesMatch = instances.size() == OBJECT_COUNT;
+        for (ui32 i = 0; instancesMatch && i < OBJECT_COUNT; ++i)
+        {
+            const DrawPacket& packet = queue.getPackets()[i];
+            instancesMatch = instances[i].world.m[3][0] == static_cast<float>(packet.objectIndex) &&
+                instances[i].material.diffuseColor.x == packet.material->getDiffuseColor().x;
+        }
+        DX3DCheck(context, instancesMatch);
+
+        // Each draw covers exactly its batch's packets, and all of them can share it
+        ui32 nextInstance = 0;
+        for (const RenderCommand& command : backend.getCommands())
+        {
+            if (command.type != RenderCommandType::DrawIndexedInstanced)
+                continue;
+
+            ui32 instanceCount = command.args[1];
+            ui32 firstInstance = command.args[2];
+            DX3DCheck(context, firstInstance == nextInstance);
+            for (ui32 i = firstInstance + 1; i < firstInstance + instanceCount; ++i)
+            {
+                DX3DCheck(context, RenderQueue::canShareBatch(queue.getPackets()[firstInstance], queue.getPackets()[i]));
+            }
+            nextInstance = firstInstance + instanceCount;
+        }
+        DX3DCheck(context, nextInstance == OBJECT_COUNT);
+    }
+
+    void benchmarkBuildAndSort(TestContext& context)
+    {
+        constexpr ui32 PACKET_COUNT = 100000;
+
+        std::mt19937 random(4);
+        RenderQueue queue;
+        double buildMilliseconds = 1e30;
+        double sortMilliseconds = 1e30;
+        double batchMilliseconds = 1e30;
+        for (ui32 run = 0; run < BENCHMARK_RUNS; ++run)
+        {
+            buildMilliseconds = std::min(buildMilliseconds, measureMilliseconds(1, [&]() { fillQueue(queue, PACKET_COUNT, random); }));
+            sortMilliseconds = std::min(sortMilliseconds, measureMilliseconds(1, [&]() { queue.sort(); }));
+            batchMilliseconds = std::min(batchMilliseconds, measureMilliseconds(1, [&]() { queue.buildBatches(); }));
+        }
+        DX3DCheck(context, std::is_sorted(queue.getPackets().begin(), queue.getPackets().end(),
+            [](const DrawPacket& a, const DrawPacket& b) { return a.sortKey < b.sortKey; }));
+
+        char label[96];
+        context.reportTiming("build 100k packets", buildMilliseconds);
+        context.reportTiming("radix sort 100k packets", sortMilliseconds);
+        snprintf(label, sizeof(label), "build batches (%zu batches)", queue.getBatches().size());
+        context.reportTiming(label, batchMilliseconds);
+        context.reportTiming("build and sort, total", buildMilliseconds + sortMilliseconds + batchMilliseconds);
+    }
+
+    const TestRegistration s_sort("RenderQueue: sort matches a stable sort by key", TestKind::Test, &testSortMatchesStableSort);
+    const TestRegistration s_sortKey("RenderQueue: sort key field order", TestKind::Test, &testSortKeyLayout);
+    const TestRegistration s_textureSplits("RenderQueue: a different texture splits a batch", TestKind::Test, &testTextureSplitsBatch);
+    const TestRegistration s_materialShares("RenderQueue: different material constants share a batch", TestKind::Test, &testMaterialConstantsShareBatch);
+    const TestRegistration s_firstIndexSplits("RenderQueue: a different first index splits a batch", TestKind::Test, &testFirstIndexSplitsBatch);
+    const TestRegistration s_instanceOrder("RenderQueue: instances follow the sorted packets", TestKind::Test, &testInstanceOrder);
+    const TestRegistration s_buildAndSort("RenderQueue: build and sort 100k packets", TestKind::Benchmark, &benchmarkBuildAndSort);
+}
@@ -0,0 +1,375 @@
+#include "TestFramework.h"
+#include "FakeRenderResources.h"
+#include "TestFixtures.h"
+#include <DX3D/Core/JobSystem.h>
+#include <DX3D/Graphics/Material.h>
+#include <DX3D/Graphics/MeshLod.h>
+#include <DX3D/Graphics/RecordingRenderBackend.h>
+#include <DX3D/Graphics/RenderQueue.h>
+#include <DX3D/Graphics/RenderScene.h>
+#include <DX3D/Graphics/RenderView.h>
+#include <DX3D/Graphics/ShadowCascades.h>
+#include <cstdio>
+#include <string>
+
+using namespace dx3d;
+
+// The scene and shadow views record through the functions Game::recordScene and
+// Game::recordShadowMap call: culling, one packet per mesh with a LOD picked from screen size,
+// key sort, batching and submission. Game needs a window and device for its objects, so the scene
+// here is plain data and the commands go to a RecordingRenderBackend. Golden files hold the
+// expected command streams; run with --update-golden after an intended change and review the diff.
+
+namespace
+{
+    constexpr ui32 BENCHMARK_RUNS = 5;
+    constexpr ui32 SHADOW_MAP_RESOLUTION = 2048;
+
+    // Geometry shared by objects: one index range per LOD
+    struct TestMesh
+    {
+        std::vector<MeshLod> lods;
+    };
+
+    struct TestObject
+    {
+        bool present = true; // false for the null slots Game keeps in m_gameObjects
+        Vector3 position;
+        Vector3 scale = Vector3(1.0f, 1.0f, 1.0f);
+        ui32 mesh = 0;
+        ui32 texture = 0;
+        ui32 material = 0;
+    };
+
+    struct TestScene
+    {
+        std::vector<TestMesh> meshes;
+        std::vector<Material> materials;
+        std::vector<TestObject> objects;
+        RenderScene renderScene; // per frame, as Game::gatherRenderScene produces it
+    };
+
+    void gatherRenderScene(TestScene& scene)
+    {
+        scene.renderScene.clear();
+        scene.renderScene.reserve(static_cast<ui32>(scene.objects.size()));
+
+        const AABB localBounds(Vector3(-0.5f, -0.5f, -0.5f), Vector3(0.5f, 0.5f, 0.5f));
+        for (const TestObject& object : scene.objects)
+        {
+            if (!object.present)
+            {
+                scene.renderScene.addObject(AABB(), Matrix4x4(), false);
+                continue;
+            }
+
+            Matrix4x4 world = Matrix4x4::CreateScale(object.scale) * Matrix4x4::CreateTranslation(object.position);
+            scene.renderScene.addObject(localBounds.transformed(world), world, true);
+
+            const TestMesh& mesh = scene.meshes[object.mesh];
+            RenderSceneDraw draw;
+            draw.vertexBuffer = getFakeResource<VertexBuffer>(object.mesh);
+            draw.indexBuffer = getFakeResource<IndexBuffer>(object.mesh);
+            draw.lods = mesh.lods.data();
+            draw.lodCount = static_cast<ui32>(mesh.lods.size());
+            draw.meshId = object.mesh;
+            draw.material = &scene.materials[object.material];
+            draw.texture = getFakeResource<Texture2D>(object.texture);
+            scene.renderScene.addDraw(draw);
+        }
+    }
+
+    void appendObjectOrder(const RenderQueue& queue, std::string& text)
+    {
+        text += "objects:";
+        for (const DrawPacket& packet : queue.getPackets())
+        {
+            text += " " + std::to_string(packet.objectIndex);
+        }
+        text += "\n";
+    }
+
+    void appendStats(const RenderStats& stats, std::string& text)
+    {
+        char line[160];
+        snprintf(line, sizeof(line), "draws=%u instances=%u triangles=%u shaderChanges=%u meshChanges=%u materialChanges=%u\n",
+            stats.drawCalls, stats.instances, stats.triangles, stats.shaderChanges, stats.meshChanges, stats.materialChanges);
+        text += line;
+    }
+
+    RenderStats recordCameraView(const TestScene& scene, const TestCamera& camera, RenderBackend& backend,
+        RenderViewState& view, std::string* text)
+    {
+        RenderStats stats = recordSceneView(scene.renderScene, view, backend, camera.view, camera.projection, TEST_FAR_PLANE);
+        if (text)
+        {
+            appendObjectOrder(view.renderQueue, *text);
+        }
+        return stats;
+    }
+
+    // Game::prepareLighting fits the cascades, then Game::recordShadowMap records each one
+    RenderStats recordShadowView(const TestScene& scene, const TestCamera& camera, const Vector3& lightDirection,
+        RenderBackend& backend, RenderViewState& view, std::string* text)
+    {
+        ShadowCascade cascades[MAX_SHADOW_CASCADES];
+        ui32 cascadeCount = fitShadowCascades(camera.viewProjection, TEST_NEAR_PLANE, TEST_FAR_PLANE, lightDirection,
+            SHADOW_MAP_RESOLUTION, scene.renderScene.getCasterBounds(), ShadowCascadeSettings(), cascades);
+
+        RenderStats stats;
+        for (ui32 i = 0; i < cascadeCount; ++i)
+        {
+            stats += recordShadowCascade(scene.renderScene, view, backend, cascades[i]);
+            if (text)
+            {
+                *text += "cascade " + std::to_string(i) + " ";
+                appendObjectOrder(view.renderQueue, *text);
+            }
+        }
+        return stats;
+    }
+
+    TestCamera createCamera()
+    {
+        return createTestCamera(Vector3(0.0f, 6.0f, -20.0f), Vector3(0.0f, 0.0f, 10.0f));
+    }
+
+    // The game view, from above and to the side of the scene camera
+    TestCamera createGameCamera()
+    {
+        return createTestCamera(Vector3(40.0f, 20.0f, -30.0f), Vector3(0.0f, 0.0f, 40.0f));
+    }
+
+    // Meshes: 0 ground plane, 1 cube, 2 sphere, 3 model with four LODs
+    void addTestMeshes(TestScene& scene)
+    {
+        scene.meshes.push_back({ { { 0, 6 } } });
+        scene.meshes.push_back({ { { 0, 36 } } });
+        scene.meshes.push_back({ { { 0, 960 } } });
+        scene.meshes.push_back({ { { 0, 3000 }, { 3000, 1500 }, { 4500, 750 }, { 5250, 375 } } });
+    }
+
+    // A ground plane, a row of cubes and spheres with two textures and three materials, copies
+    // of one model at distances that select different LODs, and objects the camera cannot see
+    TestScene createTestScene()
+    {
+        TestScene scene;
+        addTestMeshes(scene);
+        scene.materials.resize(3);
+
+        auto add = [&](const Vector3& position, const Vector3& scale, ui32 mesh, ui32 texture, ui32 material)
+            {
+                TestObject object;
+                object.position = position;
+                object.scale = scale;
+                object.mesh = mesh;
+                object.texture = texture;
+                object.material = material;
+                scene.objects.push_back(object);
+            };
+
+        add(Vector3(0.0f, -0.05f, 20.0f), Vector3(60.0f, 0.1f, 60.0f), 0, 0, 0);
+        scene.objects.push_back(TestObject());
+        scene.objects.back().present = false;
+
+        for (ui32 i = 0; i < 8; ++i)
+        {
+            float x = -10.5f + 3.0f * i;
+            add(Vector3(x, 0.5f, 2.0f + 1.5f * i), Vector3(1.0f, 1.0f, 1.0f), 1 + (i % 2), 1 + (i % 3 == 0), i % 3);
+        }
+
+        const float modelDistances[] = { -12.0f, 0.0f, 15.0f, 40.0f };
+        for (float distance : modelDistances)
+        {
+            add(Vector3(-6.0f, 2.0f, distance), Vector3(4.0f, 4.0f, 4.0f), 3, 2, 1);
+        }
+
+        // Behind the camera, and far off to the side
+        add(Vector3(0.0f, 0.5f, -40.0f), Vector3(1.0f, 1.0f, 1.0f), 1, 1, 0);
+        add(Vector3(90.0f, 0.5f, 10.0f), Vector3(1.0f, 1.0f, 1.0f), 1, 1, 0);
+
+        gatherRenderScene(scene);
+        return scene;
+    }
+
+    void testSceneViewCommands(TestContext& context)
+    {
+        TestScene scene = createTestScene();
+        RecordingRenderBackend backend;
+        RenderViewState view;
+
+        std::string text;
+        backend.beginFrame();
+        RenderStats stats = recordCameraView(scene, createCamera(), backend, view, &text);
+        appendStats(stats, text);
+        text += backend.toString();
+        DX3DCheckGolden(context, "SceneView.txt", text);
+
+        // Culled and null objects never reach the queue
+        for (const DrawPacket& packet : view.renderQueue.getPackets())
+        {
+            DX3DCheck(context, scene.objects[packet.objectIndex].present);
+            DX3DCheck(context, packet.objectIndex < scene.objects.size() - 2);
+        }
+    }
+
+    void testShadowViewCommands(TestContext& context)
+    {
+        TestScene scene = createTestScene();
+        RecordingRenderBackend backend;
+        RenderViewState view;
+
+        std::string text;
+        backend.beginFrame();
+        RenderStats stats = recordShadowView(scene, createCamera(), getTestLightDirection(), backend, view, &text);
+        appendStats(stats, text);
+        text += backend.toString();
+        DX3DCheckGolden(context, "ShadowView.txt", text);
+
+        // The depth shader binds no textures
+        for (const RenderCommand& command : backend.getCommands())
+        {
+            DX3DCheck(context, command.type != RenderCommandType::SetTexture);
+        }
+    }
+
+    // A 100 x 100 grid of the test meshes, so most of it is culled by the camera and the near cascades
+    TestScene createLargeScene()
+    {
+        TestScene scene;
+        addTestMeshes(scene);
+        scene.materials.resize(8);
+
+        for (ui32 z = 0; z < 100; ++z)
+        {
+            for (ui32 x = 0; x < 100; ++x)
+            {
+                TestObject object;
+                object.position = Vector3(-150.0f + 3.0f * x, 0.5f, -20.0f + 3.0f * z);
+                object.mesh = 1 + (x + z) % 3;
+                object.texture = (x * 7 + z) % 4;
+                object.material = (x + z * 3) % 8;
+                scene.objects.push_back(object);
+            }
+        }
+
+        gatherRenderScene(scene);
+        return scene;
+    }
+
+    // Frame cost of the views without a device: the null backend drops commands, the recording one keeps them
+    void benchmarkRecordViews(TestContext& context)
+    {
+        TestScene scene = createLargeScene();
+        const TestCamera camera = createCamera();
+        RenderViewState view;
+        RenderStats sceneStats;
+        RenderStats shadowStats;
+
+        for (bool recordCommands : { false, true })
+        {
+            RecordingRenderBackend backend(recordCommands);
+            double sceneMilliseconds = measureMilliseconds(BENCHMARK_RUNS, [&]()
+                {
+                    backend.clear();
+                    sceneStats = recordCameraView(scene, camera, backend, view, nullptr);
+                });
+            double shadowMilliseconds = measureMilliseconds(BENCHMARK_RUNS, [&]()
+                {
+                    backend.clear();
+                    shadowStats = recordShadowView(scene, camera, getTestLightDirection(), backend, view, nullptr);
+                });
+
+            const char* backendName = recordCommands ? "recording backend" : "null backend";
+            char label[96];
+            snprintf(label, sizeof(label), "scene view, %s (%u draws)", backendName, sceneStats.drawCalls);
+            context.reportTiming(label, sceneMilliseconds);
+            snprintf(label, sizeof(label), "shadow view, %s (%u draws)", backendName, shadowStats.drawCalls);
+            context.reportTiming(label, shadowMilliseconds);
+        }
+        DX3DCheck(context, sceneStats.instances > 0 && sceneStats.instances < scene.objects.size());
+    }
+
+    // A whole frame as Game::recordViews records it: one job per shadow cascade plus the scene and
+    // game views, each with its own backend, over one to four threads. The command streams must not
+    // depend on how the jobs were spread.
+    void benchmarkRecordJobs(TestContext& context)
+    {
+        TestScene scene = createLargeScene();
+        const TestCamera sceneCamera = createCamera();
+        const TestCamera gameCamera = createGameCamera();
+        ShadowCascade cascades[MAX_SHADOW_CASCADES];
+        ui32 cascadeCount = fitShadowCascades(sceneCamera.viewProjection, TEST_NEAR_PLANE, TEST_FAR_PLANE, getTestLightDirection(),
+            SHADOW_MAP_RESOLUTION, scene.renderScene.getCasterBounds(), ShadowCascadeSettings(), cascades);
+
+        RecordingRenderBackend backends[RENDER_RECORD_JOB_COUNT];
+        RenderViewState views[RENDER_RECORD_JOB_COUNT];
+        RenderStats stats[RENDER_RECORD_JOB_COUNT];
+        auto recordJob = [&](ui32 job)
+            {
+                backends[job].clear();
+                stats[job] = RenderStats();
+                switch (getRecordJobView(job))
+                {
+                case RenderViewType::Shadow:
+                    if (job < cascadeCount)
+                    {
+                        stats[job] = recordShadowCascade(scene.renderScene, views[job], backends[job], cascades[job]);
+                    }
+                    break;
+                case RenderViewType::Scene: stats[job] = recordCameraView(scene, sceneCamera, backends[job], views[job], nullptr); break;
+                case RenderViewType::Game: stats[job] = recordCameraView(scene, gameCamera, backends[job], views[job], nullptr); break;
+                default: break;
+                }
+            };
+        auto getCommands = [&]()
+            {
+                std::string text;
+                for (const RecordingRenderBackend& backend : backends)
+                {
+                    text += backend.toString();
+                }
+                return text;
+            };
+
+        JobSystem& jobs = JobSystem::getInstance();
+        const ui32 workerCount = jobs.getWorkerCount();
+        std::string inlineCommands;
+        for (ui32 workers = 0; workers < 4; ++workers)
+        {
+            jobs.setWorkerCount(workers);
+            double milliseconds = measureMilliseconds(BENCHMARK_RUNS, [&]()
+                {
+                    jobs.parallelFor(RENDER_RECORD_JOB_COUNT, recordJob);
+                });
+
+            FrameRenderStats frame;
+            for (ui32 job = 0; job < RENDER_RECORD_JOB_COUNT; ++job)
+            {
+                frame.views[static_cast<ui32>(getRecordJobView(job))] += stats[job];
+            }
+
+            char label[128];
+            snprintf(label, sizeof(label), "%u jobs, %u workers (shadow %u, scene %u, game %u draws)", RENDER_RECORD_JOB_COUNT, workers,
+                frame.getView(RenderViewType::Shadow).drawCalls, frame.getView(RenderViewType::Scene).drawCalls,
+                frame.getView(RenderViewType::Game).drawCalls);
+            context.reportTiming(label, milliseconds);
+
+            if (workers == 0)
+            {
+                inlineCommands = getCommands();
+                DX3DCheck(context, frame.getView(RenderViewType::Shadow).drawCalls > 0 && frame.getView(RenderViewType::Game).drawCalls > 0);
+            }
+            else
+            {
+                DX3DCheck(context, getCommands() == inlineCommands);
+            }
+        }
+        jobs.setWorkerCount(workerCount);
+    }
+
+    const TestRegistration s_sceneView("Render: scene view command stream", TestKind::Test, &testSceneViewCommands);
+    const TestRegistration s_shadowView("Render: shadow view command stream", TestKind::Test, &testShadowViewCommands);
+    const TestRegistration s_recordBenchmark("Render: record views of a 10k-object scene", TestKind::Benchmark, &benchmarkRecordViews);
+    const TestRegistration s_recordJobsBenchmark("Render: record frame jobs of a 10k-object scene on 1-4 threads", TestKind::Benchmark, &benchmarkRecordJobs);
+}
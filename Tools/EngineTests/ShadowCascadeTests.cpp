@@ -0,0 +1,267 @@
+#include "TestFramework.h"
+#include "TestFixtures.h"
+#include <DX3D/Graphics/ShadowCascades.h>
+#include <algorithm>
+#include <cmath>
+
+using namespace dx3d;
+using namespace DirectX;
+
+namespace
+{
+    constexpr ui32 SHADOW_MAP_RESOLUTION = 2048;
+
+    Vector3 transformPoint(const Vector3& point, const Matrix4x4& matrix)
+    {
+        return Vector3(XMVector3TransformCoord(XMVectorSet(point.x, point.y, point.z, 1.0f), matrix.toXMMatrix()));
+    }
+
+    ui32 fitCascades(const TestCamera& camera, const AABB& casterBounds, ShadowCascade* cascades)
+    {
+        return fitShadowCascades(camera.viewProjection, TEST_NEAR_PLANE, TEST_FAR_PLANE, getTestLightDirection(),
+            SHADOW_MAP_RESOLUTION, casterBounds, ShadowCascadeSettings(), cascades);
+    }
+
+    // Light-space centre and half width of a cascade's box, from its off-centre orthographic projection
+    float getCascadeCenterX(const ShadowCascade& cascade) { return -cascade.projection.m[3][0] / cascade.projection.m[0][0]; }
+    float getCascadeCenterY(const ShadowCascade& cascade) { return -cascade.projection.m[3][1] / cascade.projection.m[1][1]; }
+    float getCascadeRadius(const ShadowCascade& cascade) { return 1.0f / cascade.projection.m[0][0]; }
+
+    float getTexelSize(const ShadowCascade& cascade)
+    {
+        return 2.0f * getCascadeRadius(cascade) / (SHADOW_MAP_RESOLUTION * cascade.atlasRect.x);
+    }
+
+    bool isWholeNumber(float value, float tolerance)
+    {
+        return std::fabs(value - std::round(value)) <= tolerance;
+    }
+
+    void testCascadeSplits(TestContext& context)
+    {
+        float splits[MAX_SHADOW_CASCADES + 1];
+
+        // lambda 0 is uniform, lambda 1 keeps a constant ratio between neighbouring splits
+        computeCascadeSplits(1.0f, 81.0f, 4, 0.0f, splits);
+        for (ui32 i = 0; i <= 4; ++i)
+        {
+            DX3DCheck(context, std::fabs(splits[i] - (1.0f + 20.0f * i)) < 1e-4f);
+        }
+        computeCascadeSplits(1.0f, 81.0f, 4, 1.0f, splits);
+        for (ui32 i = 0; i <= 4; ++i)
+        {
+            DX3DCheck(context, std::fabs(splits[i] - std::pow(3.0f, static_cast<float>(i))) < 1e-3f);
+        }
+
+        // Blends lie between the two and still start and end on the planes
+        computeCascadeSplits(TEST_NEAR_PLANE, 60.0f, 4, 0.75f, splits);
+        DX3DCheck(context, splits[0] == TEST_NEAR_PLANE && splits[4] == 60.0f);
+        for (ui32 i = 1; i < 4; ++i)
+        {
+            float fraction = i / 4.0f;
+            float logSplit = TEST_NEAR_PLANE * std::pow(60.0f / TEST_NEAR_PLANE, fraction);
+            float uniformSplit = TEST_NEAR_PLANE + (60.0f - TEST_NEAR_PLANE) * fraction;
+            DX3DCheck(context, splits[i] > splits[i - 1]);
+            DX3DCheck(context, splits[i] > logSplit && splits[i] < uniformSplit);
+        }
+
+        // Cascades stop at the shadow distance rather than the camera's far plane
+        ShadowCascade cascades[MAX_SHADOW_CASCADES];
+        TestCamera camera = createTestCamera(Vector3(0.0f, 5.0f, 0.0f));
+        DX3DCheck(context, fitCascades(camera, AABB(), cascades) == 4);
+        DX3DCheck(context, cascades[0].splitNear == TEST_NEAR_PLANE);
+        DX3DCheck(context, cascades[3].splitFar == ShadowCascadeSettings().maxShadowDistance);
+        for (ui32 i = 1; i < 4; ++i)
+        {
+            DX3DCheck(context, cascades[i].splitNear == cascades[i - 1].splitFar);
+            DX3DCheck(context, getCascadeRadius(cascades[i]) > getCascadeRadius(cascades[i - 1]));
+        }
+
+        ShadowCascadeSettings settings;
+        settings.cascadeCount = 9;
+        DX3DCheck(context, fitShadowCascades(camera.viewProjection, TEST_NEAR_PLANE, TEST_FAR_PLANE, getTestLightDirection(),
+            SHADOW_MAP_RESOLUTION, AABB(), settings, cascades) == MAX_SHADOW_CASCADES);
+        settings.cascadeCount = 0;
+        DX3DCheck(context, fitShadowCascades(camera.viewProjection, TEST_NEAR_PLANE, TEST_FAR_PLANE, getTestLightDirection(),
+            SHADOW_MAP_RESOLUTION, AABB(), settings, cascades) == 1);
+        DX3DCheck(context, cascades[0].atlasRect.x == 1.0f);
+    }
+
+    // Moving the camera by less than a texel may only move a cascade by whole texels, so a fixed
+    // point in the world keeps landing on the same spot inside its shadow map texel
+    void testSnappingIsStableUnderSubTexelMotion(TestContext& context)
+    {
+        constexpr ui32 STEP_COUNT = 40;
+
+        const AABB casterBounds(Vector3(-50.0f, -1.0f, -50.0f), Vector3(50.0f, 20.0f, 50.0f));
+        const Vector3 worldPoint(1.3f, 0.0f, 12.7f);
+        const Vector3 startEye(0.37f, 5.0f, -3.11f);
+
+        ShadowCascade firstCascades[MAX_SHADOW_CASCADES];
+        ui32 cascadeCount = fitCascades(createTestCamera(startEye), casterBounds, firstCascades);
+        float stepSize = 0.3f * getTexelSize(firstCascades[0]);
+
+        ShadowCascade previous[MAX_SHADOW_CASCADES];
+        std::copy(firstCascades, firstCascades + cascadeCount, previous);
+        ui32 cascadeMoves = 0;
+        for (ui32 step = 1; step <= STEP_COUNT; ++step)
+        {
+            ShadowCascade cascades[MAX_SHADOW_CASCADES];
+            fitCascades(createTestCamera(startEye + Vector3(1.0f, 0.2f, 0.6f) * (stepSize * step)), casterBounds, cascades);
+
+            for (ui32 i = 0; i < cascadeCount; ++i)
+            {
+                float texelSize = getTexelSize(cascades[i]);
+                DX3DCheck(context, getCascadeRadius(cascades[i]) == getCascadeRadius(previous[i]));
+                DX3DCheck(context, isWholeNumber(getCascadeCenterX(cascades[i]) / texelSize, 1e-3f));
+                DX3DCheck(context, isWholeNumber(getCascadeCenterY(cascades[i]) / texelSize, 1e-3f));
+
+                float moveX = (getCascadeCenterX(cascades[i]) - getCascadeCenterX(previous[i])) / texelSize;
+                float moveY = (getCascadeCenterY(cascades[i]) - getCascadeCenterY(previous[i])) / texelSize;
+                DX3DCheck(context, std::fabs(moveX) < 1.01f && std::fabs(moveY) < 1.01f);
+                if (std::fabs(moveX) > 0.5f || std::fabs(moveY) > 0.5f)
+                    ++cascadeMoves;
+
+                // Texel coordinates of the point differ by whole texels between any two frames
+                float tileResolution = SHADOW_MAP_RESOLUTION * cascades[i].atlasRect.x;
+                Vector3 first = transformPoint(worldPoint, firstCascades[i].getViewProjection());
+                Vector3 current = transformPoint(worldPoint, cascades[i].getViewProjection());
+                DX3DCheck(context, isWholeNumber((current.x - first.x) * 0.5f * tileResolution, 1e-2f));
+                DX3DCheck(context, isWholeNumber((current.y - first.y) * 0.5f * tileResolution, 1e-2f));
+            }
+            std::copy(cascades, cascades + cascadeCount, previous);
+        }
+
+        // The camera covered over ten texels of the first cascade, so the snapping did get exercised
+        DX3DCheck(context, cascadeMoves > 0);
+    }
+
+    // Casters between the light and a cascade cast into it even when they sit outside the
+    // cascade's sphere, or behind the camera's near plane where the camera itself culls them
+    void testCastersBehindTheNearPlaneAreKept(TestContext& context)
+    {
+        const TestCamera camera = createTestCamera(Vector3(0.0f, 5.0f, 0.0f));
+        const Vector3 lightDirection = getTestLightDirection();
+
+        // A point on the ground inside the first cascade's slice
+        Vector3 corners[8];
+        getFrustumSliceCorners(camera.viewProjection, TEST_NEAR_PLANE, TEST_FAR_PLANE, TEST_NEAR_PLANE, 2.0f, corners);
+        Vector3 shadowedPoint;
+        for (const Vector3& corner : corners)
+        {
+            shadowedPoint += corner;
+        }
+        shadowedPoint *= 1.0f / 8.0f;
+
+        // Up the light ray from that point: one caster close above it, one far enough back that
+        // the camera's view depth is negative, and one off to the side that shadows nothing here
+        const Vector3 nearCaster = shadowedPoint - lightDirection * 3.0f;
+        const Vector3 farCaster = shadowedPoint - lightDirection * 40.0f;
+        const Vector3 sideCaster = shadowedPoint + Vector3(80.0f, 0.0f, 0.0f);
+        DX3DCheck(context, transformPoint(farCaster, camera.view).z < TEST_NEAR_PLANE);
+
+        CullingBounds bounds;
+        AABB casterBounds;
+        for (const Vector3& caster : { nearCaster, farCaster, sideCaster })
+        {
+            AABB box(caster - Vector3(0.5f, 0.5f, 0.5f), caster + Vector3(0.5f, 0.5f, 0.5f));
+            bounds.add(box);
+            casterBounds.expand(box);
+        }
+
+        std::vector<ui32> visible;
+        cullBoxes(Frustum::fromViewProjection(camera.viewProjection), bounds, visible);
+        DX3DCheck(context, std::find(visible.begin(), visible.end(), 1u) == visible.end());
+
+        ShadowCascade cascades[MAX_SHADOW_CASCADES];
+        fitCascades(camera, casterBounds, cascades);
+        visible.clear();
+        cullShadowCasters(cascades[0], bounds, visible);
+        DX3DCheck(context, visible == std::vector<ui32>({ 0, 1 }));
+
+        // Every corner of the far caster lands in front of the cascade's near plane
+        for (ui32 corner = 0; corner < 8; ++corner)
+        {
+            Vector3 offset((corner & 1) ? 0.5f : -0.5f, (corner & 2) ? 0.5f : -0.5f, (corner & 4) ? 0.5f : -0.5f);
+            DX3DCheck(context, transformPoint(farCaster + offset, cascades[0].view).z >= -1e-3f);
+        }
+        DX3DCheck(context, getCascadeRadius(cascades[0]) < 40.0f);
+    }
+
+    // True where the shader's sampleShadow would find the point in one of the cascades
+    bool isInAnyCascade(const Vector3& point, const ShadowCascade* cascades, ui32 cascadeCount)
+    {
+        for (ui32 i = 0; i < cascadeCount; ++i)
+        {
+            Vector3 ndc = transformPoint(point, cascades[i].getViewProjection());
+            if (std::fabs(ndc.x) <= 1.0f && std::fabs(ndc.y) <= 1.0f && ndc.z >= 0.0f && ndc.z <= 1.0f)
+                return true;
+        }
+        return false;
+    }
+
+    // Counts points spread through a camera's frustum up to the shadow distance that no cascade holds
+    ui32 countUncoveredPoints(const TestCamera& camera, const ShadowCascade* cascades, ui32 cascadeCount)
+    {
+        constexpr ui32 STEPS = 8;
+
+        Vector3 corners[8];
+        getFrustumSliceCorners(camera.viewProjection, TEST_NEAR_PLANE, TEST_FAR_PLANE, TEST_NEAR_PLANE,
+            ShadowCascadeSettings().maxShadowDistance, corners);
+
+        ui32 uncovered = 0;
+        for (ui32 z = 0; z <= STEPS; ++z)
+        {
+            for (ui32 y = 0; y <= STEPS; ++y)
+            {
+                for (ui32 x = 0; x <= STEPS; ++x)
+                {
+                    float u = static_cast<float>(x) / STEPS;
+                    float v = static_cast<float>(y) / STEPS;
+                    float w = static_cast<float>(z) / STEPS;
+                    Vector3 nearPoint = (corners[0] * (1.0f - u) + corners[1] * u) * (1.0f - v) + (corners[3] * (1.0f - u) + corners[2] * u) * v;
+                    Vector3 farPoint = (corners[4] * (1.0f - u) + corners[5] * u) * (1.0f - v) + (corners[7] * (1.0f - u) + corners[6] * u) * v;
+                    if (!isInAnyCascade(nearPoint * (1.0f - w) + farPoint * w, cascades, cascadeCount))
+                        ++uncovered;
+                }
+            }
+        }
+        return uncovered;
+    }
+
+    // While editing, the cascades follow the editor camera but the game view samples the same map:
+    // the widened last cascade has to hold all of the game camera's shadowed range, and the sharper
+    // cascades stay fitted to the editor camera alone
+    void testLastCascadeCoversSecondCamera(TestContext& context)
+    {
+        const TestCamera editorCamera = createTestCamera(Vector3(0.0f, 5.0f, 0.0f));
+        const TestCamera gameCamera = createTestCamera(Vector3(40.0f, 3.0f, 30.0f), Vector3(80.0f, 0.0f, -10.0f));
+        const AABB casterBounds(Vector3(-100.0f, -1.0f, -100.0f), Vector3(100.0f, 20.0f, 100.0f));
+
+        ShadowCascade editorCascades[MAX_SHADOW_CASCADES];
+        ui32 cascadeCount = fitCascades(editorCamera, casterBounds, editorCascades);
+        DX3DCheck(context, countUncoveredPoints(gameCamera, editorCascades, cascadeCount) > 0);
+
+        ShadowCascade cascades[MAX_SHADOW_CASCADES];
+        DX3DCheck(context, fitShadowCascades(editorCamera.viewProjection, TEST_NEAR_PLANE, TEST_FAR_PLANE,
+            gameCamera.viewProjection, TEST_NEAR_PLANE, TEST_FAR_PLANE, getTestLightDirection(), SHADOW_MAP_RESOLUTION,
+            casterBounds, ShadowCascadeSettings(), cascades) == cascadeCount);
+        DX3DCheck(context, countUncoveredPoints(gameCamera, cascades, cascadeCount) == 0);
+        DX3DCheck(context, countUncoveredPoints(editorCamera, cascades, cascadeCount) == 0);
+
+        for (ui32 i = 0; i + 1 < cascadeCount; ++i)
+        {
+            DX3DCheck(context, getCascadeRadius(cascades[i]) == getCascadeRadius(editorCascades[i]));
+            DX3DCheck(context, getCascadeCenterX(cascades[i]) == getCascadeCenterX(editorCascades[i]));
+        }
+        const ShadowCascade& last = cascades[cascadeCount - 1];
+        DX3DCheck(context, getCascadeRadius(last) > getCascadeRadius(editorCascades[cascadeCount - 1]));
+        DX3DCheck(context, last.atlasRect.z == editorCascades[cascadeCount - 1].atlasRect.z);
+        DX3DCheck(context, isWholeNumber(getCascadeCenterX(last) / getTexelSize(last), 1e-3f));
+    }
+
+    const TestRegistration s_splits("Shadows: cascade splits", TestKind::Test, &testCascadeSplits);
+    const TestRegistration s_snapping("Shadows: cascades only move in whole texels", TestKind::Test, &testSnappingIsStableUnderSubTexelMotion);
+    const TestRegistration s_nearCasters("Shadows: casters behind the near plane are kept", TestKind::Test, &testCastersBehindTheNearPlaneAreKept);
+    const TestRegistration s_secondCamera("Shadows: last cascade covers a second camera", TestKind::Test, &testLastCascadeCoversSecondCamera);
+}
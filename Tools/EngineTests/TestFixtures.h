@@ -0,0 +1,42 @@
+#pragma once
+#include <DX3D/Core/Core.h>
+#include <DX3D/Math/Math.h>
+
+namespace dx3d
+{
+    // Camera and light shared by the culling, shadow, light cluster and render scene tests
+    constexpr float TEST_FIELD_OF_VIEW = 1.0472f;
+    constexpr float TEST_ASPECT_RATIO = 16.0f / 9.0f;
+    constexpr float TEST_NEAR_PLANE = 0.1f;
+    constexpr float TEST_FAR_PLANE = 100.0f;
+
+    struct TestCamera
+    {
+        Vector3 eye;
+        Matrix4x4 view;
+        Matrix4x4 projection;
+        Matrix4x4 viewProjection;
+    };
+
+    inline TestCamera createTestCamera(const Vector3& eye, const Vector3& target)
+    {
+        TestCamera camera;
+        camera.eye = eye;
+        camera.view = Matrix4x4::CreateLookAtLH(eye, target, Vector3(0.0f, 1.0f, 0.0f));
+        camera.projection = Matrix4x4::CreatePerspectiveFovLH(TEST_FIELD_OF_VIEW, TEST_ASPECT_RATIO, TEST_NEAR_PLANE, TEST_FAR_PLANE);
+        camera.viewProjection = camera.view * camera.projection;
+        return camera;
+    }
+
+    // Looking ahead and slightly right and down
+    inline TestCamera createTestCamera(const Vector3& eye)
+    {
+        return createTestCamera(eye, eye + Vector3(0.2f, -0.1f, 1.0f));
+    }
+
+    // The sun: mostly down, slanted so shadows have some length
+    inline Vector3 getTestLightDirection()
+    {
+        return Vector3::Normalize(Vector3(0.3f, -1.0f, 0.4f));
+    }
+}
@@ -0,0 +1,159 @@
+#include "TestFramework.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+using namespace dx3d;
+
+namespace
+{
+    bool s_updateGoldenFiles = false;
+
+    std::vector<TestCase>& getMutableTestCases()
+    {
+        static std::vector<TestCase> s_cases;
+        return s_cases;
+    }
+
+    // Golden files live next to the test sources, so they are found from any working directory
+    std::filesystem::path getGoldenPath(const std::string& fileName)
+    {
+        return std::filesystem::path(__FILE__).parent_path() / "Golden" / fileName;
+    }
+
+    // Shared CI runners are too noisy to hold a frame budget to; timings there are only reported
+    bool isRunningOnCI()
+    {
+#ifdef _MSC_VER
+        char* value = nullptr;
+        size_t length = 0;
+        bool isSet = _dupenv_s(&value, &length, "CI") == 0 && value != nullptr;
+        free(value);
+        return isSet;
+#else
+        return std::getenv("CI") != nullptr;
+#endif
+    }
+
+    std::string stripCarriageReturns(std::string text)
+    {
+        text.erase(std::remove(text.begin(), text.end(), '\r'), text.end());
+        return text;
+    }
+
+    std::vector<std::string> splitLines(const std::string& text)
+    {
+        std::vector<std::string> lines;
+        std::istringstream stream(text);
+        std::string line;
+        while (std::getline(stream, line))
+        {
+            lines.push_back(line);
+        }
+        return lines;
+    }
+}
+
+bool TestContext::check(bool condition, const char* expression, const char* file, int line)
+{
+    if (!condition)
+    {
+        printf("    %s(%d): check failed: %s\n", file, line, expression);
+        ++m_failureCount;
+    }
+    return condition;
+}
+
+void TestContext::reportTiming(const char* what, double milliseconds, double budgetMilliseconds)
+{
+    if (budgetMilliseconds <= 0.0)
+    {
+        printf("    %-48s %10.3f ms\n", what, milliseconds);
+        return;
+    }
+
+    bool withinBudget = milliseconds <= budgetMilliseconds;
+    printf("    %-48s %10.3f ms (budget %.3f ms%s)\n", what, milliseconds, budgetMilliseconds,
+        withinBudget ? "" : ", OVER");
+#ifdef NDEBUG
+    if (!withinBudget && !isRunningOnCI())
+    {
+        ++m_failureCount;
+    }
+#endif
+}
+
+bool TestContext::checkGoldenText(const std::string& fileName, const std::string& text, const char* file, int line)
+{
+    std::filesystem::path path = getGoldenPath(fileName);
+    if (s_updateGoldenFiles)
+    {
+        std::filesystem::create_directories(path.parent_path());
+        std::ofstream output(path, std::ios::binary);
+        output << text;
+        printf("    updated %s\n", path.string().c_str());
+        return check(static_cast<bool>(output), "golden file written", file, line);
+    }
+
+    std::ifstream input(path, std::ios::binary);
+    if (!input)
+    {
+        printf("    %s(%d): missing golden file %s (run with --update-golden to create it)\n", file, line, path.string().c_str());
+        ++m_failureCount;
+        return false;
+    }
+
+    std::stringstream expected;
+    expected << input.rdbuf();
+    std::vector<std::string> expectedLines = splitLines(stripCarriageReturns(expected.str()));
+    std::vector<std::string> actualLines = splitLines(stripCarriageReturns(text));
+    if (expectedLines == actualLines)
+        return true;
+
+    // The first difference is usually enough to see what changed
+    size_t lineIndex = 0;
+    while (lineIndex < expectedLines.size() && lineIndex < actualLines.size() && expectedLines[lineIndex] == actualLines[lineIndex])
+    {
+        ++lineIndex;
+    }
+    printf("    %s(%d): output differs from %s at line %zu\n", file, line, fileName.c_str(), lineIndex + 1);
+    printf("      expected: %s\n", lineIndex < expectedLines.size() ? expectedLines[lineIndex].c_str() : "<end of file>");
+    printf("      actual:   %s\n", lineIndex < actualLines.size() ? actualLines[lineIndex].c_str() : "<end of output>");
+    ++m_failureCount;
+    return false;
+}
+
+TestRegistration::TestRegistration(const char* name, TestKind kind, TestFunction function)
+{
+    getMutableTestCases().push_back({ name, kind, function });
+}
+
+const std::vector<TestCase>& dx3d::getTestCases()
+{
+    return getMutableTestCases();
+}
+
+void dx3d::setUpdateGoldenFiles(bool update)
+{
+    s_updateGoldenFiles = update;
+}
+
+std::filesystem::path dx3d::getTestTempDirectory()
+{
+    static const std::filesystem::path s_directory = []()
+        {
+            std::filesystem::path directory = std::filesystem::temp_directory_path() / "DX3DEngineTests";
+            std::error_code error;
+            std::filesystem::remove_all(directory, error);
+            std::filesystem::create_directories(directory);
+            return directory;
+        }();
+    return s_directory;
+}
+
+std::filesystem::path dx3d::getAssetDirectory()
+{
+    // Found from the test sources like the golden files, not from the working directory
+    return (std::filesystem::path(__FILE__).parent_path() / ".." / ".." / "DX3D" / "Assets").lexically_normal();
+}
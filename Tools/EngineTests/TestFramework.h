@@ -0,0 +1,81 @@
+#pragma once
+#include <DX3D/Core/Core.h>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace dx3d
+{
+    enum class TestKind
+    {
+        Test,       // always run; failing checks fail the run
+        Benchmark   // run with --benchmark; prints timings and checks budgets in optimised builds
+    };
+
+    // Checks made by one test or benchmark
+    class TestContext
+    {
+    public:
+        // Records a failure when condition is false and returns condition, so callers can stop early
+        bool check(bool condition, const char* expression, const char* file, int line);
+
+        // Prints a timing. Over budgetMilliseconds (if not 0) fails the run in optimised builds only,
+        // since debug timings say nothing about the frame budget, and never when the CI variable is set.
+        void reportTiming(const char* what, double milliseconds, double budgetMilliseconds = 0.0);
+
+        // Compares text against Golden/<fileName>, or rewrites that file when run with --update-golden.
+        // Line endings are ignored.
+        bool checkGoldenText(const std::string& fileName, const std::string& text, const char* file, int line);
+
+        ui32 getFailureCount() const { return m_failureCount; }
+
+    private:
+        ui32 m_failureCount = 0;
+    };
+
+    using TestFunction = void (*)(TestContext& context);
+
+    struct TestCase
+    {
+        const char* name;
+        TestKind kind;
+        TestFunction function;
+    };
+
+    // Adds a case at static initialisation; declare one per case at namespace scope of its test file
+    struct TestRegistration
+    {
+        TestRegistration(const char* name, TestKind kind, TestFunction function);
+    };
+
+    const std::vector<TestCase>& getTestCases();
+
+    // Set from the command line before any case runs
+    void setUpdateGoldenFiles(bool update);
+
+    // Directory for files tests write, emptied before the run
+    std::filesystem::path getTestTempDirectory();
+
+    // DX3D/Assets of the source tree, for tests that read the bundled textures and models
+    std::filesystem::path getAssetDirectory();
+
+    // Best of `runs` timings of function(), in milliseconds
+    template<typename Function>
+    double measureMilliseconds(ui32 runs, Function&& function)
+    {
+        using Clock = std::chrono::steady_clock;
+        double best = 1e30;
+        for (ui32 run = 0; run < runs; ++run)
+        {
+            auto start = Clock::now();
+            function();
+            best = std::min(best, std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+        }
+        return best;
+    }
+}
+
+#define DX3DCheck(context, condition) (context).check((condition), #condition, __FILE__, __LINE__)
+#define DX3DCheckGolden(context, fileName, text) (context).checkGoldenText((fileName), (text), __FILE__, __LINE__)
@@ -0,0 +1,232 @@
+// Offline cooker: imports OBJ files and writes the cooked models the engine maps at load time.
+// With --benchmark it also times the OBJ import against loading the cooked file, and the
+// parallel OBJ parser against tinyobj, checking that both produce the same data.
+
+#include <DX3D/Assets/CookedModel.h>
+#include <DX3D/Assets/ModelImporter.h>
+#include <DX3D/Assets/ObjParser.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+using namespace dx3d;
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr int BENCHMARK_RUNS = 5;
+
+    float getMilliseconds(Clock::time_point start)
+    {
+        return std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+    }
+
+    bool hashSource(const std::string& path, ui64& hash)
+    {
+        MappedFile source;
+        if (!source.open(path))
+            return false;
+        hash = hashSourceData(source.getData(), source.getSize());
+        return true;
+    }
+
+    template <typename T>
+    bool isSameData(const std::vector<T>& a, const std::vector<T>& b)
+    {
+        return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0);
+    }
+
+    bool isSameIndices(const std::vector<tinyobj::index_t>& a, const std::vector<tinyobj::index_t>& b)
+    {
+        return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](const tinyobj::index_t& x, const tinyobj::index_t& y)
+            {
+                return x.vertex_index == y.vertex_index && x.normal_index == y.normal_index && x.texcoord_index == y.texcoord_index;
+            });
+    }
+
+    // Bitwise comparison of everything the importer reads
+    bool isSameParse(const tinyobj::ObjReader& reader, const ObjModel& model)
+    {
+        const auto& attrib = reader.GetAttrib();
+        if (!isSameData(attrib.vertices, model.attrib.vertices) || !isSameData(attrib.normals, model.attrib.normals) ||
+            !isSameData(attrib.texcoords, model.attrib.texcoords) || !isSameData(attrib.colors, model.attrib.colors))
+            return false;
+
+        const auto& shapes = reader.GetShapes();
+        if (shapes.size() != model.shapes.size() || reader.GetMaterials().size() != model.materials.size())
+            return false;
+
+        for (size_t i = 0; i < shapes.size(); ++i)
+        {
+            const auto& a = shapes[i];
+            const auto& b = model.shapes[i];
+            if (a.name != b.name || !isSameIndices(a.mesh.indices, b.mesh.indices) ||
+                !isSameData(a.mesh.num_face_vertices, b.mesh.num_face_vertices) || !isSameData(a.mesh.material_ids, b.mesh.material_ids) ||
+                !isSameData(a.mesh.smoothing_group_ids, b.mesh.smoothing_group_ids) || !isSameIndices(a.lines.indices, b.lines.indices) ||
+                !isSameData(a.lines.num_line_vertices, b.lines.num_line_vertices) || !isSameIndices(a.points.indices, b.points.indices))
+                return false;
+        }
+
+        for (size_t i = 0; i < model.materials.size(); ++i)
+        {
+            if (reader.GetMaterials()[i].name != model.materials[i].name)
+                return false;
+        }
+        return true;
+    }
+
+    // Best of several runs of tinyobj and the parallel parser on the same file; false if their output differs
+    bool runParserBenchmark(const std::string& sourcePath)
+    {
+        float tinyObjMilliseconds = 1e30f;
+        float parallelMilliseconds = 1e30f;
+        bool same = true;
+
+        for (int run = 0; run < BENCHMARK_RUNS; ++run)
+        {
+            auto start = Clock::now();
+            tinyobj::ObjReader reader;
+            bool tinyObjParsed = reader.ParseFromFile(sourcePath, tinyobj::ObjReaderConfig());
+            tinyObjMilliseconds = std::min(tinyObjMilliseconds, getMilliseconds(start));
+
+            start = Clock::now();
+            ObjModel model;
+            bool parsed = parseOBJ(sourcePath, model);
+            parallelMilliseconds = std::min(parallelMilliseconds, getMilliseconds(start));
+
+            same = same && tinyObjParsed == parsed && isSameParse(reader, model);
+        }
+
+        double megabytes = std::filesystem::file_size(sourcePath) / (1024.0 * 1024.0);
+        printf("  parser (best of %d): tinyobj %.2f ms (%.1f MB/s), parallel %.2f ms (%.1f MB/s), %s\n",
+            BENCHMARK_RUNS, tinyObjMilliseconds, megabytes * 1000.0 / tinyObjMilliseconds,
+            parallelMilliseconds, megabytes * 1000.0 / std::max(parallelMilliseconds, 1e-3f), same ? "identical output" : "OUTPUT DIFFERS");
+        return same;
+    }
+
+    // Best of several runs of both load paths, from the point the loader has a file name to the
+    // point it would hand geometry to the device. Uploads are stood in for by a copy of every
+    // vertex and index, which is what the driver does with the initial data.
+    void runBenchmark(const std::string& sourcePath, const std::string& cookedPath)
+    {
+        float importMilliseconds = 1e30f;
+        float cookedMilliseconds = 1e30f;
+        std::vector<char> staging;
+
+        for (int run = 0; run < BENCHMARK_RUNS; ++run)
+        {
+            auto start = Clock::now();
+            ui64 hash = 0;
+            ImportedModel model;
+            if (!hashSource(sourcePath, hash) || !importOBJ(sourcePath, model))
+                return;
+            for (const auto& mesh : model.meshes)
+            {
+                MeshData data = mesh.getData();
+                staging.assign(reinterpret_cast<const char*>(data.vertices), reinterpret_cast<const char*>(data.vertices + data.vertexCount));
+                staging.assign(reinterpret_cast<const char*>(data.indices), reinterpret_cast<const char*>(data.indices + data.indexCount));
+            }
+            importMilliseconds = std::min(importMilliseconds, getMilliseconds(start));
+
+            start = Clock::now();
+            CookedModel cooked;
+            if (!hashSource(sourcePath, hash) || !cooked.open(cookedPath, hash))
+            {
+                printf("  benchmark: cooked file did not open\n");
+                return;
+            }
+            for (ui32 i = 0; i < cooked.getMeshCount(); ++i)
+            {
+                const MeshData& data = cooked.getMeshData(i);
+                staging.assign(reinterpret_cast<const char*>(data.vertices), reinterpret_cast<const char*>(data.vertices + data.vertexCount));
+                staging.assign(reinterpret_cast<const char*>(data.indices), reinterpret_cast<const char*>(data.indices + data.indexCount));
+            }
+            cookedMilliseconds = std::min(cookedMilliseconds, getMilliseconds(start));
+        }
+
+        printf("  benchmark (best of %d): OBJ import %.2f ms, cooked %.2f ms, %.1fx faster\n",
+            BENCHMARK_RUNS, importMilliseconds, cookedMilliseconds, importMilliseconds / std::max(cookedMilliseconds, 1e-3f));
+    }
+
+    bool cookModel(const std::string& sourcePath, bool benchmark)
+    {
+        printf("Cooking %s\n", sourcePath.c_str());
+
+        auto start = Clock::now();
+        ui64 hash = 0;
+        if (!hashSource(sourcePath, hash))
+        {
+            printf("  could not open source\n");
+            return false;
+        }
+
+        ImportedModel model;
+        if (!importOBJ(sourcePath, model))
+            return false;
+
+        std::string cookedPath = getCookedModelPath(sourcePath);
+        if (!writeCookedModel(cookedPath, model, hash))
+            return false;
+
+        size_t vertexCount = 0;
+        size_t indexCount = 0;
+        for (const auto& mesh : model.meshes)
+        {
+            vertexCount += mesh.vertices.size();
+            indexCount += mesh.lodChain.indices.size();
+        }
+
+        CookedModel cooked;
+        if (!cooked.open(cookedPath, hash))
+        {
+            printf("  written file failed to validate: %s\n", cookedPath.c_str());
+            return false;
+        }
+        printf("  %zu meshes, %zu vertices, %zu indices (all LODs) -> %s (%.1f KB) in %.1f ms\n",
+            model.meshes.size(), vertexCount, indexCount, cookedPath.c_str(), cooked.getFileSize() / 1024.0, getMilliseconds(start));
+        cooked.close();
+
+        bool identical = true;
+        if (benchmark)
+        {
+            identical = runParserBenchmark(sourcePath);
+            runBenchmark(sourcePath, cookedPath);
+        }
+        return identical;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    bool benchmark = false;
+    std::vector<std::string> sources;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--benchmark") == 0)
+            benchmark = true;
+        else
+            sources.push_back(argv[i]);
+    }
+
+    if (sources.empty())
+    {
+        printf("Usage: ModelCooker [--benchmark] <model.obj>...\n");
+        printf("Writes <model.obj>%s next to each source.\n", COOKED_MODEL_EXTENSION);
+        return EXIT_FAILURE;
+    }
+
+    int failures = 0;
+    for (const auto& source : sources)
+    {
+        if (!cookModel(source, benchmark))
+            ++failures;
+    }
+
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
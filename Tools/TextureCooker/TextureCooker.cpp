@@ -0,0 +1,239 @@
+// Offline cooker: decodes PNG and JPEG textures, builds their mip chains and writes the cooked
+// files the engine maps at load time. Directories are searched recursively. Files are cooked in
+// parallel. With --benchmark it also times a cold load of every file three ways: decoding the
+// source alone as the engine used to, decoding and building mips, and mapping the cooked file.
+
+#include <DX3D/Assets/CookedModel.h>
+#include <DX3D/Assets/CookedTexture.h>
+#include <DX3D/Core/JobSystem.h>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+using namespace dx3d;
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr int BENCHMARK_RUNS = 3;
+
+    struct CookResult
+    {
+        bool succeeded = false;
+        std::string message;
+    };
+
+    float getMilliseconds(Clock::time_point start)
+    {
+        return std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+    }
+
+    bool isImageFile(const std::filesystem::path& path)
+    {
+        std::string extension = path.extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return extension == ".png" || extension == ".jpg" || extension == ".jpeg";
+    }
+
+    void addSources(const std::string& argument, std::vector<std::string>& sources)
+    {
+        std::error_code error;
+        if (!std::filesystem::is_directory(argument, error))
+        {
+            sources.push_back(argument);
+            return;
+        }
+
+        std::vector<std::string> found;
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(argument, error))
+        {
+            if (entry.is_regular_file() && isImageFile(entry.path()))
+                found.push_back(entry.path().string());
+        }
+        std::sort(found.begin(), found.end());
+        sources.insert(sources.end(), found.begin(), found.end());
+    }
+
+    const char* getColorSpaceName(TextureColorSpace colorSpace)
+    {
+        return colorSpace == TextureColorSpace::Srgb ? "sRGB" : "linear";
+    }
+
+    // Cooks one file; colorSpaceOverride is null to go by the file name as the engine does
+    CookResult cookTexture(const std::string& sourcePath, const TextureColorSpace* colorSpaceOverride)
+    {
+        CookResult result;
+        char line[512];
+
+        auto start = Clock::now();
+        MappedFile source;
+        if (!source.open(sourcePath))
+        {
+            result.message = "  could not open " + sourcePath + "\n";
+            return result;
+        }
+        ui64 hash = hashSourceData(source.getData(), source.getSize());
+
+        DecodedImage image;
+        std::string error;
+        if (!decodeImage(source.getData(), source.getSize(), image, error) &&
+            !decodePlatformImageFile(sourcePath, image, error))
+        {
+            result.message = "  " + sourcePath + ": " + error + "\n";
+            return result;
+        }
+        source.close();
+
+        TextureColorSpace colorSpace = colorSpaceOverride ? *colorSpaceOverride : getTextureColorSpace(sourcePath);
+        ui32 width = image.width;
+        ui32 height = image.height;
+        std::vector<DecodedImage> mips = generateMipChain(std::move(image), colorSpace);
+
+        std::string cookedPath = getCookedTexturePath(sourcePath);
+        CookedTexture cooked;
+        if (!writeCookedTexture(cookedPath, mips, colorSpace, hash) || !cooked.open(cookedPath, hash))
+        {
+            result.message = "  failed to write or validate " + cookedPath + "\n";
+            return result;
+        }
+
+        snprintf(line, sizeof(line), "  %s: %ux%u %s, %u mips -> %.1f KB in %.1f ms\n", sourcePath.c_str(), width, height,
+            getColorSpaceName(colorSpace), cooked.getMipCount(), cooked.getFileSize() / 1024.0, getMilliseconds(start));
+        result.message = line;
+        result.succeeded = true;
+        return result;
+    }
+
+    // Best of several cold loads of every file, from its name to pixels ready for the device.
+    // Cooked loads touch every page of every mip, which is what the upload does.
+    void runBenchmark(const std::vector<std::string>& sources)
+    {
+        JobSystem& jobs = JobSystem::getInstance();
+        std::atomic<ui64> checksum{ 0 };
+
+        auto decodeSource = [&](ui32 i)
+            {
+                DecodedImage image;
+                std::string error;
+                if (decodeImageFile(sources[i], image, error))
+                    checksum += image.pixels[0];
+            };
+        auto decodeWithMips = [&](ui32 i)
+            {
+                DecodedImage image;
+                std::string error;
+                if (decodeImageFile(sources[i], image, error))
+                    checksum += generateMipChain(std::move(image), getTextureColorSpace(sources[i])).back().pixels[0];
+            };
+        auto mapCooked = [&](ui32 i)
+            {
+                TextureData data;
+                std::string error;
+                if (!loadTextureData(sources[i], data, error))
+                    return;
+                ui64 sum = 0;
+                for (const auto& mip : data.mips)
+                {
+                    size_t size = size_t(mip.width) * mip.height * 4;
+                    for (size_t offset = 0; offset < size; offset += 4096)
+                        sum += mip.pixels[offset];
+                }
+                checksum += sum;
+            };
+
+        struct Path
+        {
+            const char* name;
+            std::function<void(ui32)> load;
+        };
+        const Path paths[] = {
+            { "decode source, base level only", decodeSource },
+            { "decode source and build mips", decodeWithMips },
+            { "map cooked file, all mips", mapCooked } };
+
+        ui32 count = static_cast<ui32>(sources.size());
+        printf("Benchmark, %u files (best of %d), serial and on %u workers plus the calling thread:\n",
+            count, BENCHMARK_RUNS, jobs.getWorkerCount());
+        for (const auto& path : paths)
+        {
+            float serialMilliseconds = 1e30f;
+            float parallelMilliseconds = 1e30f;
+            for (int run = 0; run < BENCHMARK_RUNS; ++run)
+            {
+                auto start = Clock::now();
+                for (ui32 i = 0; i < count; ++i)
+                    path.load(i);
+                serialMilliseconds = std::min(serialMilliseconds, getMilliseconds(start));
+
+                start = Clock::now();
+                jobs.parallelFor(count, path.load);
+                parallelMilliseconds = std::min(parallelMilliseconds, getMilliseconds(start));
+            }
+            printf("  %-32s serial %8.1f ms, parallel %8.1f ms\n", path.name, serialMilliseconds, parallelMilliseconds);
+        }
+        printf("  (checksum %llu)\n", static_cast<unsigned long long>(checksum.load()));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    bool benchmark = false;
+    bool hasOverride = false;
+    TextureColorSpace colorSpaceOverride = TextureColorSpace::Srgb;
+    std::vector<std::string> sources;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--benchmark") == 0)
+        {
+            benchmark = true;
+        }
+        else if (std::strcmp(argv[i], "--srgb") == 0 || std::strcmp(argv[i], "--linear") == 0)
+        {
+            hasOverride = true;
+            colorSpaceOverride = argv[i][2] == 's' ? TextureColorSpace::Srgb : TextureColorSpace::Linear;
+        }
+        else
+        {
+            addSources(argv[i], sources);
+        }
+    }
+
+    if (sources.empty())
+    {
+        printf("Usage: TextureCooker [--benchmark] [--srgb | --linear] <image or directory>...\n");
+        printf("Writes <image>%s next to each PNG and JPEG. Without --srgb or --linear the colour space\n", COOKED_TEXTURE_EXTENSION);
+        printf("comes from the file name, as when the engine cooks a texture on first load.\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("Cooking %zu textures\n", sources.size());
+    auto start = Clock::now();
+    std::vector<CookResult> results(sources.size());
+    JobSystem::getInstance().parallelFor(static_cast<ui32>(sources.size()), [&](ui32 i)
+        {
+            results[i] = cookTexture(sources[i], hasOverride ? &colorSpaceOverride : nullptr);
+        });
+
+    int failures = 0;
+    for (const auto& result : results)
+    {
+        printf("%s", result.message.c_str());
+        if (!result.succeeded)
+            ++failures;
+    }
+    printf("Cooked %zu of %zu in %.1f ms\n", sources.size() - failures, sources.size(), getMilliseconds(start));
+
+    if (benchmark)
+        runBenchmark(sources);
+
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}